@@ -0,0 +1,99 @@
+"""
+Columnar SPH snapshot reader for Python.
+
+Reads .sphc columnar files produced by the SPH simulation code. Each
+field is stored as one contiguous block with an index header giving its
+offset, so selected columns can be seek-read without touching the rest
+of the file.
+
+File format:
+- Header (96 bytes):
+  - magic_number (uint32): 0x53504803 ("SPH\x03")
+  - version (uint32): format version (currently 1)
+  - dimension (uint32): spatial dimension (1, 2, or 3)
+  - particle_count (uint32): number of particles
+  - time (float64): simulation time
+  - length_factor (float64): unit conversion for length
+  - time_factor (float64): unit conversion for time
+  - mass_factor (float64): unit conversion for mass
+  - length_unit (16 bytes), time_unit (16 bytes), mass_unit (16 bytes)
+- column_count (uint32)
+- Index (36 bytes per column):
+  - name (16 bytes, zero-padded)
+  - dtype (uint32): 0 = float64, 1 = int32
+  - offset (uint64): byte offset from file start
+  - size (uint64): byte size of the column block
+- Column blocks, one contiguous array per field
+"""
+
+import struct
+from pathlib import Path
+from typing import Dict, List, Optional
+
+import numpy as np
+
+MAGIC_NUMBER = 0x53504803  # "SPH\x03"
+HEADER_SIZE = 96
+
+
+class ColumnarSnapshotReader:
+    """Read columnar SPH snapshot files (.sphc format)"""
+
+    def __init__(self, filename: str):
+        self.filename = Path(filename)
+        if not self.filename.exists():
+            raise FileNotFoundError(f"Columnar snapshot not found: {filename}")
+
+        with open(self.filename, "rb") as f:
+            header = f.read(HEADER_SIZE)
+            (magic, self.version, self.dimension, self.particle_count) = struct.unpack(
+                "<4I", header[:16]
+            )
+            if magic != MAGIC_NUMBER:
+                raise ValueError(
+                    f"Not a columnar snapshot (magic 0x{magic:08x}): {filename}"
+                )
+            (
+                self.time,
+                self.length_factor,
+                self.time_factor,
+                self.mass_factor,
+            ) = struct.unpack("<4d", header[16:48])
+            self.length_unit = header[48:64].rstrip(b"\0").decode()
+            self.time_unit = header[64:80].rstrip(b"\0").decode()
+            self.mass_unit = header[80:96].rstrip(b"\0").decode()
+
+            (column_count,) = struct.unpack("<I", f.read(4))
+            self.index: Dict[str, tuple] = {}
+            for _ in range(column_count):
+                entry = f.read(36)
+                name = entry[:16].rstrip(b"\0").decode()
+                dtype_code, offset, size = struct.unpack("<IQQ", entry[16:36])
+                self.index[name] = (dtype_code, offset, size)
+
+    @property
+    def columns(self) -> List[str]:
+        """Column names in file order."""
+        return list(self.index.keys())
+
+    def read_column(self, name: str) -> np.ndarray:
+        """Seek to one column block and read only it."""
+        if name not in self.index:
+            raise KeyError(f"No column '{name}' in {self.filename}; "
+                           f"available: {self.columns}")
+        dtype_code, offset, size = self.index[name]
+        dtype = np.float64 if dtype_code == 0 else np.int32
+        with open(self.filename, "rb") as f:
+            f.seek(offset)
+            return np.frombuffer(f.read(size), dtype=dtype)
+
+    def read_columns(self, names: Optional[List[str]] = None) -> Dict[str, np.ndarray]:
+        """Read the named columns (all of them when names is None)."""
+        if names is None:
+            names = self.columns
+        return {name: self.read_column(name) for name in names}
+
+
+def read_columns(filename: str, names: Optional[List[str]] = None) -> Dict[str, np.ndarray]:
+    """Convenience wrapper: read selected columns from one .sphc file."""
+    return ColumnarSnapshotReader(filename).read_columns(names)
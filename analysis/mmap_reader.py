@@ -0,0 +1,206 @@
+"""
+Zero-copy memory-mapped readers for SPH binary outputs.
+
+The .sph binary snapshots, .sphc columnar snapshots and .chk checkpoint
+files all store each field as one contiguous block, so NumPy can map
+them straight from the page cache instead of parsing: every array below
+is an np.memmap view into the file, created in O(1) regardless of
+particle count. Slicing or reducing a view reads only the pages it
+touches; call np.array(view) if an owned copy is needed (e.g. before
+the file is deleted or to mutate the data).
+
+Checkpoint particle sections are mapped as a structured array following
+the v5 compact record of include/utilities/checkpoint_data.hpp
+(pos, vel, mass, dens, ene, sml, alpha, target_rho, id, flags).
+v4 checkpoints dumped the raw in-memory SPHParticle, whose layout is
+compiler-dependent; those still load through CheckpointManager on the
+C++ side but are not mappable here.
+"""
+
+import json
+import struct
+from pathlib import Path
+from typing import Dict, List, Optional
+
+import numpy as np
+
+try:
+    from .binary_reader import BinarySnapshotReader, BinarySnapshotHeader
+    from .columnar_reader import ColumnarSnapshotReader
+except ImportError:
+    from binary_reader import BinarySnapshotReader, BinarySnapshotHeader
+    from columnar_reader import ColumnarSnapshotReader
+
+CHECKPOINT_MAGIC = b"SPHCHKPT"
+CHECKPOINT_HEADER_SIZE = 512
+CHECKPOINT_COMPACT_VERSION = 5
+
+
+def map_binary_snapshot(filename: str):
+    """
+    Map a .sph binary snapshot as zero-copy NumPy views.
+
+    Returns:
+        Tuple of (header, data_dict) with the same keys and shapes as
+        BinarySnapshotReader.read(), but each array is an np.memmap
+        view instead of a parsed copy.
+    """
+    reader = BinarySnapshotReader(filename)
+    with open(reader.filename, "rb") as f:
+        header = reader._read_header(f)
+    if header.magic_number != BinarySnapshotReader.MAGIC_NUMBER:
+        raise ValueError(f"Invalid magic number: {hex(header.magic_number)}")
+    if header.version != 1:
+        raise ValueError(f"Unsupported version: {header.version}")
+
+    n = header.particle_count
+    dim = header.dimension
+    offset = BinarySnapshotReader.HEADER_SIZE
+
+    data: Dict[str, np.ndarray] = {}
+
+    def map_block(name, dtype, shape):
+        nonlocal offset
+        view = np.memmap(reader.filename, dtype=dtype, mode="r",
+                         offset=offset, shape=shape)
+        offset += view.nbytes
+        data[name] = view
+
+    map_block("pos", "f8", (n, dim))
+    map_block("vel", "f8", (n, dim))
+    map_block("acc", "f8", (n, dim))
+    for name in ("mass", "dens", "pres", "ene", "sml",
+                 "alpha", "gradh", "shock_sensor"):
+        map_block(name, "f8", (n,))
+    for name in ("id", "neighbor", "ene_floored"):
+        map_block(name, "i4", (n,))
+
+    data["time"] = header.time
+    return header, data
+
+
+def map_columnar_snapshot(filename: str,
+                          names: Optional[List[str]] = None) -> Dict[str, np.ndarray]:
+    """
+    Map selected columns of a .sphc columnar snapshot (all when names
+    is None). The column index gives each block's offset directly, so
+    only the mapped columns' pages are ever read.
+    """
+    reader = ColumnarSnapshotReader(filename)
+    if names is None:
+        names = reader.columns
+    data: Dict[str, np.ndarray] = {}
+    for name in names:
+        if name not in reader.index:
+            raise KeyError(f"No column '{name}' in {filename}; "
+                           f"available: {reader.columns}")
+        dtype_code, offset, size = reader.index[name]
+        dtype = np.float64 if dtype_code == 0 else np.int32
+        count = size // np.dtype(dtype).itemsize
+        data[name] = np.memmap(reader.filename, dtype=dtype, mode="r",
+                               offset=offset, shape=(count,))
+    return data
+
+
+def _checkpoint_particle_dtype(dim: int) -> np.dtype:
+    """Structured dtype matching CompactCheckpointParticle for one DIM."""
+    return np.dtype([
+        ("pos", "f8", (dim,)),
+        ("vel", "f8", (dim,)),
+        ("mass", "f8"),
+        ("dens", "f8"),
+        ("ene", "f8"),
+        ("sml", "f8"),
+        ("alpha", "f8"),
+        ("target_rho", "f8"),
+        ("id", "i4"),
+        ("is_point_mass", "u1"),
+        ("is_wall", "u1"),
+        ("is_active", "u1"),
+        ("reserved", "u1"),
+    ])
+
+
+def map_checkpoint_particles(filename: str):
+    """
+    Map the particle section of a .chk checkpoint file.
+
+    Returns:
+        Tuple of (info, particles) where info is a dict with the header
+        fields (time, dt, step, dimension, sph_type, simulation_name,
+        params) and particles is a structured np.memmap with one record
+        per particle. Field access (particles["pos"], particles["ene"])
+        is zero-copy.
+    """
+    path = Path(filename)
+    if not path.exists():
+        raise FileNotFoundError(f"Checkpoint not found: {filename}")
+
+    with open(path, "rb") as f:
+        header = f.read(CHECKPOINT_HEADER_SIZE)
+        if header[:8] != CHECKPOINT_MAGIC:
+            raise ValueError(f"Not a full checkpoint (magic {header[:8]!r}): "
+                             f"{filename}")
+        (version,) = struct.unpack("<I", header[8:12])
+        if version != CHECKPOINT_COMPACT_VERSION:
+            raise ValueError(
+                f"Checkpoint format v{version} predates the compact particle "
+                f"record and cannot be mapped; re-save it with the current "
+                f"code or load it through CheckpointManager")
+        (dimension,) = struct.unpack("<i", header[12:16])
+        simulation_name = header[80:208].rstrip(b"\0").decode()
+        sph_type = header[208:272].rstrip(b"\0").decode()
+        time, dt = struct.unpack("<2d", header[272:288])
+        step, particle_count, params_size = struct.unpack("<3q", header[288:312])
+
+        # The parameters section repeats its size as a leading int64,
+        # mirroring how CheckpointManager writes it
+        f.seek(CHECKPOINT_HEADER_SIZE)
+        (json_size,) = struct.unpack("<q", f.read(8))
+        params = json.loads(f.read(json_size).decode())
+
+    particle_offset = CHECKPOINT_HEADER_SIZE + 8 + params_size
+    particles = np.memmap(path, dtype=_checkpoint_particle_dtype(dimension),
+                          mode="r", offset=particle_offset,
+                          shape=(particle_count,))
+
+    info = {
+        "time": time,
+        "dt": dt,
+        "step": step,
+        "dimension": dimension,
+        "sph_type": sph_type,
+        "simulation_name": simulation_name,
+        "params": params,
+    }
+    return info, particles
+
+
+if __name__ == "__main__":
+    import sys
+
+    if len(sys.argv) < 2:
+        print("Usage: python mmap_reader.py <snapshot.sph | snapshot.sphc | checkpoint.chk>")
+        sys.exit(1)
+
+    path = Path(sys.argv[1])
+    if path.suffix == ".sph":
+        header, data = map_binary_snapshot(path)
+        print(f"Mapped binary snapshot: {path}")
+        print(f"  Particles: {header.particle_count}, time: {header.time:.6f}")
+    elif path.suffix == ".sphc":
+        data = map_columnar_snapshot(path)
+        print(f"Mapped columnar snapshot: {path}")
+    elif path.suffix == ".chk":
+        info, particles = map_checkpoint_particles(path)
+        print(f"Mapped checkpoint: {path}")
+        print(f"  Particles: {len(particles)}, time: {info['time']:.6f}, "
+              f"step: {info['step']}")
+        data = {name: particles[name] for name in particles.dtype.names}
+    else:
+        print(f"ERROR: Unrecognized extension: {path.suffix}")
+        sys.exit(1)
+
+    for key, arr in data.items():
+        if isinstance(arr, np.ndarray):
+            print(f"  {key:15s}: shape={str(arr.shape):12s} dtype={arr.dtype}")
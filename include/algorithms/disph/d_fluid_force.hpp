@@ -9,6 +9,12 @@ namespace disph
 
 class FluidForce : public sph::FluidForce {
     real m_gamma;
+
+    // pair-once variant used when symmetrizeFluidForce is set
+    void calculation_symmetric(std::shared_ptr<Simulation> sim);
+
+    // gather loop streaming the precomputed PairList geometry (pairList)
+    void calculation_pairs(std::shared_ptr<Simulation> sim);
 public:
     void initialize(std::shared_ptr<SPHParameters> param) override;
     void calculation(std::shared_ptr<Simulation> sim) override;
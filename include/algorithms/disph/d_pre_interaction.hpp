@@ -12,7 +12,7 @@ namespace sph
             real newton_raphson(
                 const SPHParticle &p_i,
                 const std::vector<SPHParticle> &particles,
-                const std::vector<int> &neighbor_list,
+                const int *neighbor_list,
                 const int n_neighbor,
                 const Periodic *periodic,
                 const KernelFunction *kernel) override;
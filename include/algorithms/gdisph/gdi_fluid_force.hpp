@@ -2,7 +2,7 @@
 #pragma once
 
 #include "modules/fluid_force.hpp"
-#include <functional>
+#include "algorithms/grad_arrays.hpp"
 
 namespace sph
 {
@@ -11,17 +11,40 @@ namespace sph
 
         /// GodnouvFluidForce implements GDISPH with a Godunov-type Riemann solver (HLL)
         /// for GDISPH Case 1, without artificial viscosity, consistent with the paper's formulation.
+        /// Pair states are gathered per particle and solved in one vectorized
+        /// HLL sweep (see algorithms/hll_batch.hpp).
         class FluidForce : public sph::FluidForce
         {
         private:
             bool m_is_2nd_order;               // Flag for second-order reconstruction (not used in this version)
             real m_gamma;                      // Adiabatic index
             bool m_use_balsara_switch = false; // Disabled for GDISPH Case 1 (no artificial viscosity)
-            // Solver function: takes left and right states (velocity, density, pressure, sound speed)
-            // and computes pstar and vstar
-            std::function<void(const real[], const real[], real &pstar, real &vstar)> m_solver;
+            GradArrayHandles m_grad_handles;   // MUSCL gradient arrays, bound on first use
 
-            void hll_solver(); // Sets up the HLL Riemann solver
+            // Region-partitioned execution (shockRegionSwitch): particles are
+            // bucketed by shockMode each step, the Riemann loop runs only
+            // over the shock bucket and smooth-flow particles take the
+            // inviscid loop below. Buckets are rebuilt per step.
+            bool m_region_switch = false;
+            real m_shock_mach;
+            std::vector<int> m_smooth_idx;
+            std::vector<int> m_shock_idx;
+
+            // Update shockMode from the previous step's shockSensor (and the
+            // switch_to_no_shock_region override) and fill the two buckets.
+            void partition_by_mode(std::shared_ptr<Simulation> sim);
+
+            // Riemann (HLL) loop; iterates the subset when given, otherwise
+            // every particle.
+            void calculation_riemann(std::shared_ptr<Simulation> sim, const std::vector<int> *subset);
+
+            // Smooth-region loop: the inviscid DISPH-like force only, no
+            // MUSCL reconstruction and no Riemann solves in the pair body.
+            void calculation_smooth(std::shared_ptr<Simulation> sim);
+
+            // Pair-once variant used when symmetrizeFluidForce is set; one
+            // Riemann solve (and MUSCL reconstruction) serves both particles.
+            void calculation_symmetric(std::shared_ptr<Simulation> sim);
 
         public:
             void initialize(std::shared_ptr<SPHParameters> param) override;
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include "core/simulation.hpp"
+
+namespace sph
+{
+
+    // Cached handles for the MUSCL gradient arrays the solver registers for
+    // GSPH/GDISPH runs. The arrays are added after module initialize(), so
+    // modules call resolve() at the top of calculation(); it binds the
+    // handles on the first call and is a no-op afterwards, keeping the
+    // string lookups out of the per-step path (see Simulation handle API).
+    struct GradArrayHandles
+    {
+        int grad_d = -1;
+        int grad_p = -1;
+        int grad_v[DIM];
+
+        void resolve(Simulation &sim)
+        {
+            if (grad_d >= 0)
+            {
+                return;
+            }
+            grad_d = sim.get_vector_array_handle("grad_density");
+            grad_p = sim.get_vector_array_handle("grad_pressure");
+            for (int d = 0; d < DIM; ++d)
+            {
+                grad_v[d] = sim.get_vector_array_handle("grad_velocity_" + std::to_string(d));
+            }
+        }
+    };
+
+}
@@ -1,7 +1,7 @@
 #pragma once
 
-#include <functional>
 #include "modules/fluid_force.hpp"
+#include "algorithms/grad_arrays.hpp"
 
 namespace sph
 {
@@ -11,14 +11,10 @@ namespace sph
         class FluidForce : public sph::FluidForce
         {
             bool m_is_2nd_order;
+            GradArrayHandles m_grad_handles;
             real m_gamma;
             bool m_forceCorrection; // Option to switch force correction on (true) or off (false)
 
-            // (velocity, density, pressure, sound speed)
-            std::function<void(const real[], const real[], real &pstar, real &vstar)> m_solver;
-
-            void hll_solver();
-
         public:
             void initialize(std::shared_ptr<SPHParameters> param) override;
             void calculation(std::shared_ptr<Simulation> sim) override;
@@ -1,6 +1,7 @@
 // gsph/g_pre_interaction.hpp
 #pragma once
 #include "modules/pre_interaction.hpp"
+#include "algorithms/grad_arrays.hpp"
 
 namespace sph
 {
@@ -10,6 +11,7 @@ namespace sph
         class PreInteraction : public sph::PreInteraction
         {
             bool m_is_2nd_order;
+            GradArrayHandles m_grad_handles;
 
         public:
             void initialize(std::shared_ptr<SPHParameters> param) override;
@@ -17,7 +19,7 @@ namespace sph
             real newton_raphson(
                 const SPHParticle &p_i,
                 const std::vector<SPHParticle> &particles,
-                const std::vector<int> &neighbor_list,
+                const int *neighbor_list,
                 const int n_neighbor,
                 const Periodic *periodic,
                 const KernelFunction *kernel) override;
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sph
+{
+    class Simulation;
+    class OutputWriter;
+
+    /**
+     * @brief Background snapshot writer
+     *
+     * Formatting and writing a large snapshot stalls the integration loop for
+     * seconds. enqueue() stages a copy of the simulation (the particle vector
+     * is deep-copied, so the solver may keep integrating) and a single worker
+     * thread runs the output writers against the staged copy. If more than
+     * m_max_pending snapshots pile up, enqueue() blocks until the writer
+     * catches up, bounding the extra memory to a few particle arrays.
+     */
+    class AsyncOutputManager
+    {
+        struct Job
+        {
+            std::shared_ptr<Simulation> staged;
+            std::vector<std::shared_ptr<OutputWriter>> writers;
+        };
+
+        std::deque<Job> m_jobs;
+        std::mutex m_mutex;
+        std::condition_variable m_cv_push; // signals the worker
+        std::condition_variable m_cv_pop;  // signals blocked producers / flush
+        std::thread m_worker;
+        std::size_t m_max_pending;
+        bool m_stop;
+        bool m_busy; // worker is writing a dequeued job
+
+        void worker_loop();
+
+    public:
+        explicit AsyncOutputManager(const std::size_t max_pending = 2);
+        ~AsyncOutputManager();
+
+        /// Stage a snapshot and return; blocks only when the queue is full.
+        void enqueue(std::shared_ptr<Simulation> sim,
+                     const std::vector<std::shared_ptr<OutputWriter>> &writers);
+
+        /// Wait until all queued snapshots are on disk.
+        void flush();
+
+        /// Drop queued snapshots without writing them. Used by the
+        /// preemption fast flush, where the remaining seconds belong to the
+        /// checkpoint; a job already being written still completes.
+        void discard_pending();
+    };
+}
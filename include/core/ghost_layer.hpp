@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "utilities/vector_type.hpp"
+
+namespace sph
+{
+
+    struct SPHParameters;
+    class Simulation;
+
+    /**
+     * @brief Ghost-image layer for periodic boundaries (periodicGhosts key)
+     *
+     * Replicates every particle within one kernel-support margin of a
+     * periodic face as an image particle shifted by the box period (faces,
+     * edges and corners). With the images in the tree, Periodic::calc_r_ij
+     * degrades to the plain r_i - r_j subtraction: the minimum-image
+     * branching runs once per boundary particle per step, here, instead of
+     * once per neighbor pair in every loop.
+     *
+     * The images follow the MPI halo lifecycle: appended before the tree
+     * build (build), re-copied from their sources once PreInteraction has
+     * produced densities, pressures and smoothing lengths (refresh), and
+     * removed after the corrector (drop). They are marked inactive so the
+     * force loops treat them as sources only, and they get id == index like
+     * every other particle. Because the images change the array every step,
+     * the Verlet tree reuse is off in this mode.
+     */
+    class GhostLayer
+    {
+        bool m_enabled = false;
+        vec_t m_min;
+        vec_t m_max;
+        vec_t m_range;
+        real m_skin_factor = 0.0;
+        int m_real_num = 0;
+        std::vector<int> m_source;  // real index each image copies
+        std::vector<vec_t> m_shift; // periodic offset applied to its position
+
+    public:
+        void initialize(std::shared_ptr<SPHParameters> param);
+        bool enabled() const { return m_enabled; }
+
+        /// Append the image particles; call before make_tree.
+        void build(std::shared_ptr<Simulation> sim);
+
+        /// Overwrite the images with their sources' current field values
+        /// (positions re-shifted); call after PreInteraction.
+        void refresh(std::shared_ptr<Simulation> sim);
+
+        /// Remove the images appended by build.
+        void drop(std::shared_ptr<Simulation> sim);
+    };
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "utilities/defines.hpp"
+
+namespace sph
+{
+
+    struct SPHParameters;
+    class Simulation;
+
+    /**
+     * @brief OpenMP target offload engine for the SPH pair loops
+     *
+     * Runs the dominant per-step pair loops — the fixed-h density summation
+     * (PreInteraction) and the standard-SPH momentum/energy loop (FluidForce)
+     * — as `omp target teams` kernels. The hot SPHParticle fields are
+     * flattened into plain real arrays together with the CSR neighbor index
+     * and kept allocated on the device across steps; each step only refreshes
+     * them with `target update` and copies the kernel outputs (dens/pres/
+     * gradh/sml resp. acc/dene) back, so snapshot and checkpoint writes never
+     * touch the device.
+     *
+     * The engine covers the paths whose inner loop is pure arithmetic over
+     * the cached index: cubic-spline kernel, no artificial conductivity, no
+     * Newton-Raphson smoothing-length iteration and no pair-once scatter.
+     * Each entry point returns false when the current step falls outside
+     * that envelope (or the neighbor cache is not built), and the caller
+     * runs its host loop instead. Self-gravity stays on the host: the
+     * interaction lists come from a pointer-chasing tree walk that does not
+     * map to a device kernel, and the flat force loops they feed already
+     * vectorize there.
+     *
+     * Built only with -DUSE_GPU_OFFLOAD=ON and enabled per run with the
+     * gpuOffload config key; without either, every method is a no-op and
+     * the code compiles without an offload-capable toolchain.
+     */
+    class GpuOffload
+    {
+        bool m_active = false;  // built with offload, requested, device found
+
+        // run constants captured at initialize()
+        int m_kd;               // effective kernel dimension (2.5D maps to 2)
+        real m_sigma;           // cubic-spline normalization for m_kd
+        real m_gamma;
+        int m_neighbor_number;
+        bool m_periodic;
+        real m_range[DIM];      // periodic box lengths (unused otherwise)
+
+        // flattened host mirrors of the device arrays (vec_t -> DIM reals)
+        int m_capacity = 0;       // device allocation, in particles
+        int m_index_capacity = 0; // device allocation of the CSR index
+        std::vector<real> m_pos, m_vel;
+        std::vector<real> m_mass, m_dens, m_pres, m_sml, m_sound;
+        std::vector<real> m_gradh, m_alpha, m_balsara;
+        std::vector<unsigned char> m_point_mass, m_is_active;
+        std::vector<int> m_offsets, m_indices;
+        std::vector<real> m_acc, m_dene;       // force outputs
+        std::vector<int> m_neighbor_count;     // density output
+
+        void ensure_capacity(const int particle_num, const int index_num);
+        void release_device();
+
+        // Refresh the device arrays from the SoA view and the neighbor cache.
+        // Returns false when this step cannot run on the device.
+        bool upload(Simulation &sim);
+
+    public:
+        ~GpuOffload();
+
+        void initialize(std::shared_ptr<SPHParameters> param);
+        bool active() const { return m_active; }
+
+        /// Offloaded PreInteraction sweep for the plain fixed-h path:
+        /// density, pressure, grad-h term, neighbor count and the global
+        /// h/v_sig minimum. The caller still runs tree->set_kernel().
+        bool density(Simulation &sim);
+
+        /// Offloaded standard-SPH momentum/energy loop (gather form, no
+        /// artificial conductivity); writes acc and dene.
+        bool fluid_force(Simulation &sim);
+    };
+
+}
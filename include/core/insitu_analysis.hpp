@@ -0,0 +1,73 @@
+#pragma once
+
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utilities/defines.hpp"
+
+namespace sph
+{
+
+    class Simulation;
+    struct SPHParameters;
+
+    /**
+     * @brief In-situ reduction passes run on the live particle state
+     *
+     * Post-processing full snapshots for a handful of scalar diagnostics
+     * forces a high snapshot cadence. Instead, registered reduction passes
+     * run in parallel over the particles right after each step and append
+     * compact rows to per-quantity CSV files under {run_dir}/insitu/, so the
+     * snapshot interval can be chosen for restart/visualization needs alone.
+     *
+     * Built-in passes: "energies" (kinetic/thermal/potential totals),
+     * "center_of_mass" (center of mass and total momentum), "radial_profile"
+     * (binned density/pressure about the center of mass) and "shock_front"
+     * (extent and population of the shock-mode region). The insituAnalysis
+     * config key enables the stage, insituPasses selects a subset,
+     * insituInterval sets the sampling interval in simulation time
+     * (0 = every step) and insituProfileBins the profile resolution.
+     * Additional passes can be registered before the run starts.
+     */
+    class InSituAnalysis
+    {
+    public:
+        /// A pass appends one or more CSV rows for the current state.
+        using PassFn = std::function<void(Simulation &sim, const real time, std::ofstream &out)>;
+
+        void initialize(std::shared_ptr<SPHParameters> param, const std::string &run_dir);
+        bool enabled() const { return m_enabled; }
+
+        /// Register a custom pass (before the run starts); the header row is
+        /// written once when the pass first appends to its file.
+        void register_pass(const std::string &name, const std::string &header, PassFn fn);
+
+        /// Run every due pass on the current state (called after correct()).
+        void sample(Simulation &sim);
+
+    private:
+        struct Pass
+        {
+            std::string name;
+            std::string header;
+            PassFn fn;
+            std::ofstream out;
+            bool selected = true;
+        };
+
+        void register_builtin_passes();
+        void apply_selection(const std::vector<std::string> &names);
+
+        bool m_enabled = false;
+        real m_interval = 0.0;
+        real m_next_time = 0.0;
+        bool m_sampled_once = false;
+        int m_profile_bins = 64;
+        std::string m_directory;
+        std::vector<std::unique_ptr<Pass>> m_passes;
+    };
+
+}
@@ -8,6 +8,22 @@
 namespace sph
 {
 
+    /**
+     * @brief Asynchronous logger behind WRITE_LOG
+     *
+     * Each WRITE_LOG statement formats into its own Logger instance (so
+     * producers never contend while building the message) and the destructor
+     * hands the finished line to a bounded queue drained by a background
+     * thread. The integration loop therefore never blocks on disk or
+     * terminal I/O; when the queue is full the producer waits, bounding
+     * memory. Before open() is called lines go straight to stdout, which
+     * keeps unit tests and early startup working without a worker thread.
+     *
+     * High-frequency per-step messages can be demoted centrally with
+     * set_sample_interval(n): every WRITE_LOG call site (keyed by
+     * file:line, captured by the macro) then emits only every n-th
+     * occurrence, without touching the call sites themselves.
+     */
     class Logger
     {
         static std::string dir_name;
@@ -16,15 +32,19 @@ namespace sph
 
         std::ostringstream m_msg;
         bool m_log_only;
+        bool m_drop; // sampled out at construction; operator<< is a no-op
+
+        static void submit(const std::string &msg, const bool log_only);
+        static bool sampled_out(const char *site_file, const int site_line);
 
     public:
-        Logger(bool log_only = false) : m_log_only(log_only) {}
+        Logger(bool log_only = false, const char *site_file = nullptr, int site_line = 0)
+            : m_log_only(log_only), m_drop(sampled_out(site_file, site_line)) {}
         ~Logger()
         {
-            log_io << m_msg.str() << std::endl;
-            if (!m_log_only)
+            if (!m_drop)
             {
-                std::cout << m_msg.str() << std::endl;
+                submit(m_msg.str(), m_log_only);
             }
         }
 
@@ -33,15 +53,24 @@ namespace sph
         static std::string get_dir_name() { return dir_name; }
         static bool is_open() { return open_flag; }
 
+        /// Block until every queued line is on disk.
+        static void flush();
+
+        /// Emit each call site only every n-th occurrence (1 = log everything).
+        static void set_sample_interval(const int interval);
+
         template <typename T>
         Logger &operator<<(const T &msg)
         {
-            m_msg << msg;
+            if (!m_drop)
+            {
+                m_msg << msg;
+            }
             return *this;
         }
     };
 
-#define WRITE_LOG sph::Logger()
-#define WRITE_LOG_ONLY sph::Logger(true)
+#define WRITE_LOG sph::Logger(false, __FILE__, __LINE__)
+#define WRITE_LOG_ONLY sph::Logger(true, __FILE__, __LINE__)
 
-}
\ No newline at end of file
+}
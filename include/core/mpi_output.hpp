@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "core/output_format.hpp"
+
+namespace sph
+{
+
+    class CheckpointManager;
+    class Simulation;
+    struct SPHParameters;
+
+    /**
+     * @brief MPI-IO collective container writer for decomposed runs
+     *
+     * Per-rank snapshot trees recreate the small-file metadata problem the
+     * container format exists to avoid, just at rank-count scale. This
+     * writer lands every snapshot of a decomposed run in one shared .sphar
+     * container instead: the ranks agree on the global particle count and
+     * the per-column offsets up front (the frame layout depends only on the
+     * count and the column selection, both identical everywhere), rank 0
+     * writes the file header, frame header and column index, and every rank
+     * writes its contiguous column slices at its precomputed offsets with
+     * MPI_File_write_at_all — no gather through rank 0, no rank-serialized
+     * stream. The result is byte-identical to a single-process container of
+     * the concatenated ranks, so the readers need no changes; the sidecar
+     * .idx is appended by rank 0 only.
+     *
+     * The ranks' run directories differ (timestamped run ids), so the
+     * container path is rank 0's, broadcast on first use. Every rank must
+     * write the same snapshots in the same order; the time-driven snapshot
+     * cadence guarantees that because the timestep is globally reduced.
+     * SimulationRun::create_writer selects this writer only for the
+     * container format of a decomposed run; without USE_MPI it is never
+     * constructed.
+     */
+    class CollectiveContainerWriter : public OutputWriter
+    {
+    public:
+        using OutputWriter::OutputWriter;
+
+        void write_staged(const SnapshotStage& stage) override;
+        std::string get_extension() const override { return ".sphar"; }
+        std::string get_format_name() const override { return "CollectiveContainer"; }
+
+    private:
+        /// First use: broadcast rank 0's container path, write the file
+        /// header when the container is fresh, agree on the append offset.
+        bool open_collective();
+
+        bool m_opened = false;
+        std::string m_path;        // shared container path (rank 0's tree)
+        std::ofstream m_index_out; // sidecar index, rank 0 only
+        uint64_t m_offset = 0;     // end-of-container offset, tracked by all ranks
+    };
+
+    /**
+     * @brief Single-file collective checkpoint for decomposed runs
+     *
+     * Writes one checkpoint file for the whole decomposed run in the
+     * fast-flush schema: rank 0's header + parameter preamble is broadcast,
+     * each rank packs its own particle records and writes them at its
+     * precomputed row offset with MPI_File_write_at_all. The file is
+     * byte-identical to a single-process save of the concatenated ranks,
+     * so load_checkpoint reads and validates it unchanged — which also
+     * means any rank count (including one) can resume from it, since the
+     * resume path restores the full particle set before decompose() keeps
+     * each rank's slab.
+     *
+     * The chunked checksum is merged rather than recomputed serially: the
+     * image bytes are repartitioned from the row decomposition onto the
+     * fixed 8 MiB hash-chunk boundaries (one MPI_Alltoallv), each rank
+     * hashes its chunk range in parallel, and rank 0 hashes the gathered
+     * chunk digests — the same digest-of-digests the serial v4 scheme
+     * produces, bit for bit.
+     *
+     * Without USE_MPI (or on one rank) save() falls through to the regular
+     * CheckpointManager::save_checkpoint.
+     */
+    class CollectiveCheckpoint
+    {
+    public:
+        static void save(CheckpointManager& manager,
+                         const std::string& filepath,
+                         const Simulation& sim,
+                         const SPHParameters& params);
+    };
+
+} // namespace sph
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+namespace sph
+{
+
+    // Per-step neighbor-list cache shared across modules.
+    //
+    // The tree is rebuilt once per step, but PreInteraction, FluidForce and
+    // the shock detection each used to redo a full neighbor search per
+    // particle. Instead, the solver builds this flat CSR-style index once per
+    // step (after PreInteraction has finalized the smoothing lengths and
+    // propagated them into the tree via set_kernel()), and downstream modules
+    // read their lists from it. make_tree() invalidates the cache, so a stale
+    // index can never outlive the tree it was built from.
+    //
+    // The lists are gather-scatter lists (is_ij = true), i.e. they contain
+    // every j with r_ij < max(h_i, h_j), which is what the symmetric force
+    // loops need; modules that only want r_ij < h_i filter in their own loop,
+    // as they already do today.
+    class NeighborCache
+    {
+        std::vector<int> m_offsets; // size particle_num + 1
+        std::vector<int> m_indices; // concatenated neighbor lists
+        bool m_valid = false;
+
+    public:
+        bool is_valid() const { return m_valid; }
+        void invalidate() { m_valid = false; }
+
+        int neighbor_count(const int i) const { return m_offsets[i + 1] - m_offsets[i]; }
+        const int *neighbors(const int i) const { return m_indices.data() + m_offsets[i]; }
+
+        // Flat CSR entry index of particle i's first neighbor; first(num) is
+        // the total entry count. Used to address per-entry side arrays such
+        // as the PairList geometry.
+        int first(const int i) const { return m_offsets[i]; }
+
+        // Flatten per-particle lists into the CSR index and mark it valid.
+        void assign(const std::vector<std::vector<int>> &lists);
+
+        // Raw CSR views and their inverse, for the warm-restart checkpoint
+        // path: a saved index is adopted wholesale (after make_tree(), which
+        // invalidates) instead of re-searching every particle on resume.
+        const std::vector<int> &offsets() const { return m_offsets; }
+        const std::vector<int> &indices() const { return m_indices; }
+        void adopt(std::vector<int> &&offsets, std::vector<int> &&indices)
+        {
+            m_offsets = std::move(offsets);
+            m_indices = std::move(indices);
+            m_valid = true;
+        }
+    };
+
+} // namespace sph
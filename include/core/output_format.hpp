@@ -3,6 +3,8 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <cstdint>
+#include <fstream>
 #include "utilities/defines.hpp"
 
 namespace sph
@@ -19,9 +21,121 @@ namespace sph
         CSV,           // Plain text CSV (current format, human-readable)
         BINARY,        // Binary format (highly compressed, fast I/O)
         HDF5,          // HDF5 format (compressed, industry standard)
-        NUMPY          // NumPy .npz format (Python-friendly, compressed)
+        NUMPY,         // NumPy .npz format (Python-friendly, compressed)
+        COMPRESSED,    // gzip-compressed column-wise binary (Boost.Iostreams)
+        COLUMNAR,      // uncompressed columnar binary with an index header
+        CONTAINER      // single append-only container file per run (framed snapshots)
     };
 
+    /**
+     * @brief Storage precision for the visualization-grade binary columns
+     *
+     * Applies to vel/acc/alpha/gradh/shockSensor in the binary writer;
+     * positions, the thermodynamic state and checkpoints always stay full
+     * precision. Q16 is linear quantization to uint16 with a per-column
+     * offset+scale stored in the snapshot header.
+     */
+    enum class ColumnPrecision
+    {
+        F64,
+        F32,
+        F16,
+        Q16
+    };
+
+    /// Parse a binaryPrecision config value ("f64", "f32", "f16", "q16").
+    ColumnPrecision parse_column_precision(const std::string& precision_str);
+
+    /**
+     * @brief Streaming statistics of one staged column
+     *
+     * Gathered while the snapshot stages, so run triage can read min, max,
+     * mean, L2 norm and the NaN/Inf counts from the small metadata sidecar
+     * instead of scanning a multi-GB snapshot. The moments are taken over
+     * the finite entries only (in output units, like the snapshot itself);
+     * the NaN/Inf counters double as an early-warning surface — staging
+     * logs a warning the moment they go non-zero.
+     */
+    struct ColumnStats
+    {
+        double min = 0.0;
+        double max = 0.0;
+        double mean = 0.0;
+        double l2 = 0.0;       ///< L2 norm, sqrt(sum of squares)
+        int64_t nan_count = 0;
+        int64_t inf_count = 0;
+    };
+
+    /**
+     * @brief Shared unit-converted columnar staging buffer for snapshots
+     *
+     * build() runs one parallel pass over the particle array applying the
+     * unit conversion factors; every enabled writer then consumes the same
+     * columns (possibly concurrently on separate threads), so adding a
+     * second output format no longer repeats the conversion walk.
+     */
+    struct SnapshotStage
+    {
+        int num = 0;
+        double time = 0.0; // unit-converted simulation time
+
+        std::vector<double> pos[DIM];
+        std::vector<double> vel[DIM];
+        std::vector<double> acc[DIM];
+        std::vector<double> mass, dens, pres, ene, sml;
+        std::vector<double> alpha, gradh, shockSensor;
+        std::vector<int32_t> id, neighbor, ene_floored;
+
+        // Per-column statistics in file order, filled by build() right
+        // after the conversion pass while the columns are still hot
+        std::vector<std::pair<std::string, ColumnStats>> stats;
+
+        // non-const Simulation because the accessors are non-const
+        void build(Simulation& sim, const UnitSystem& units);
+    };
+
+    /**
+     * @brief Byte layout of the columnar snapshot formats, shared helpers
+     *
+     * The in-process columnar and container writers and the MPI collective
+     * container writer (core/mpi_output.hpp) must produce byte-identical
+     * images, so the column catalogue and the header serialization live
+     * here instead of being private to one writer. append_header takes the
+     * row count separately from the stage because a collectively written
+     * frame indexes the global particle count while each rank's stage only
+     * holds its own slice.
+     */
+    namespace columnar_layout
+    {
+        struct Column
+        {
+            std::string name;   ///< <= 15 characters (index entry limit)
+            uint32_t dtype;     ///< 0 = float64, 1 = int32
+            const void* data;   ///< the staged column data
+        };
+
+        /// Element byte size of a dtype code.
+        size_t elem_size(uint32_t dtype);
+
+        /// The columns of a stage in file order, filtered by the writer's
+        /// column selection (empty = all; "pos" selects every axis).
+        std::vector<Column> catalogue(const SnapshotStage& stage,
+                                      const std::vector<std::string>& selection);
+
+        /// Append the fixed .sphc header and column index for `num` rows.
+        void append_header(std::vector<char>& image,
+                           const std::vector<Column>& columns,
+                           uint64_t num, double time, const UnitSystem& units);
+
+        /// Append the .sphar container file header (written once, before
+        /// any frame).
+        void append_container_header(std::vector<char>& image, const UnitSystem& units);
+
+        /// Append one .sphar frame header (precedes the frame payload).
+        void append_frame_header(std::vector<char>& image, uint64_t payload_size,
+                                 double time, uint64_t particle_count);
+    }
+
     /**
      * @brief Base class for output writers
      */
@@ -31,19 +145,33 @@ namespace sph
         std::string m_directory;
         int m_snapshot_count;
         const UnitSystem& m_units;
+        std::vector<std::string> m_columns; // empty = every column
+
+        /// True when the selection is empty or lists the column (or its
+        /// vector group, e.g. "pos" for "pos_x").
+        bool column_enabled(const std::string& name) const;
 
     public:
         OutputWriter(const std::string& dir, int count, const UnitSystem& units)
             : m_directory(dir), m_snapshot_count(count), m_units(units) {}
-        
+
         virtual ~OutputWriter() = default;
-        
+
         /**
          * @brief Write particle snapshot to file
          * @param sim Simulation object containing particle data
+         *
+         * Convenience wrapper that stages for this writer alone; callers
+         * with several writers should build one SnapshotStage and hand it
+         * to write_staged on each of them.
          */
-        virtual void write_snapshot(std::shared_ptr<Simulation> sim) = 0;
-        
+        void write_snapshot(std::shared_ptr<Simulation> sim);
+
+        /**
+         * @brief Serialize a pre-staged, unit-converted snapshot
+         */
+        virtual void write_staged(const SnapshotStage& stage) = 0;
+
         /**
          * @brief Get file extension for this format
          */
@@ -56,6 +184,20 @@ namespace sph
         
         int get_snapshot_count() const { return m_snapshot_count; }
         void increment_count() { ++m_snapshot_count; }
+
+        /**
+         * @brief Select the columns this writer emits (outputColumns key)
+         *
+         * Empty (the default) keeps the full schema. Entries are column
+         * names; the vector groups "pos", "vel" and "acc" select every
+         * axis. The CSV, columnar and container writers honor the
+         * selection (their layouts are self-describing); the fixed-layout
+         * binary and compressed writers ignore it.
+         */
+        void set_columns(const std::vector<std::string>& columns) { m_columns = columns; }
+
+        /// Unit system shared by every writer of a run (used to stage once)
+        const UnitSystem& units() const { return m_units; }
     };
 
     /**
@@ -65,8 +207,8 @@ namespace sph
     {
     public:
         using OutputWriter::OutputWriter;
-        
-        void write_snapshot(std::shared_ptr<Simulation> sim) override;
+
+        void write_staged(const SnapshotStage& stage) override;
         std::string get_extension() const override { return ".csv"; }
         std::string get_format_name() const override { return "CSV"; }
     };
@@ -77,18 +219,33 @@ namespace sph
      * - Header: magic number, version, dimension, particle count, time, units
      * - Data: raw binary particle array
      */
+    /**
+     * With a reduced precision set (binaryPrecision config key), the file is
+     * written as version 2: the header gains a uint32 precision code
+     * (1 = f32, 2 = f16, 3 = q16) after the unit names, and for q16 a table
+     * of (offset, scale) doubles — one pair per reduced column, in field
+     * order vel[DIM], acc[DIM], alpha, gradh, shockSensor — precedes the
+     * particle block. Reduced columns store value = offset + scale * q with
+     * q the stored uint16. The default ("f64") keeps the version 1 layout
+     * byte for byte.
+     */
     class BinaryOutputWriter : public OutputWriter
     {
     public:
         using OutputWriter::OutputWriter;
-        
-        void write_snapshot(std::shared_ptr<Simulation> sim) override;
+
+        void write_staged(const SnapshotStage& stage) override;
         std::string get_extension() const override { return ".sph"; }
         std::string get_format_name() const override { return "Binary"; }
-        
+
+        void set_reduced_precision(const ColumnPrecision precision) { m_reduced = precision; }
+
     private:
         static constexpr uint32_t MAGIC_NUMBER = 0x53504801; // "SPH\x01"
         static constexpr uint32_t VERSION = 1;
+        static constexpr uint32_t VERSION_REDUCED = 2;
+
+        ColumnPrecision m_reduced = ColumnPrecision::F64;
     };
 
     /**
@@ -99,12 +256,105 @@ namespace sph
     {
     public:
         using OutputWriter::OutputWriter;
-        
-        void write_snapshot(std::shared_ptr<Simulation> sim) override;
+
+        void write_staged(const SnapshotStage& stage) override;
         std::string get_extension() const override { return ".npz"; }
         std::string get_format_name() const override { return "NumPy"; }
     };
 
+    /**
+     * @brief Compressed output writer (gzip via Boost.Iostreams)
+     *
+     * The whole file is one gzip stream. Inside it the layout mirrors the
+     * binary header (magic, version, dimension, count, time, unit factors
+     * and names) followed by the particle fields column by column: each
+     * field is written as one contiguous array of all particles, so the
+     * slowly varying doubles compress far better than interleaved rows.
+     * Decompress with gzip and read the same header/columns back.
+     *
+     * Compression happens inside write_snapshot, so with asyncOutput it
+     * runs on the writer thread and never blocks the integration loop.
+     */
+    class CompressedOutputWriter : public OutputWriter
+    {
+    public:
+        using OutputWriter::OutputWriter;
+
+        void write_staged(const SnapshotStage& stage) override;
+        std::string get_extension() const override { return ".sphz"; }
+        std::string get_format_name() const override { return "Compressed"; }
+
+    private:
+        static constexpr uint32_t MAGIC_NUMBER = 0x53504802; // "SPH\x02"
+        static constexpr uint32_t VERSION = 1;
+    };
+
+    /**
+     * @brief Columnar binary output writer (.sphc)
+     *
+     * One contiguous block per field with an index header, so analysis
+     * tools can seek-read just the columns they need instead of touching
+     * every byte of every record. Layout:
+     * - fixed header, same fields as the binary format (magic, version,
+     *   dimension, particle count, time, unit factors and names)
+     * - column count (uint32), then one index entry per column:
+     *   name (16 bytes, zero-padded), dtype (uint32: 0 = float64,
+     *   1 = int32), offset from file start (uint64), byte size (uint64)
+     * - the column blocks, each staged in memory and written with a
+     *   single write()
+     */
+    class ColumnarOutputWriter : public OutputWriter
+    {
+    public:
+        using OutputWriter::OutputWriter;
+
+        void write_staged(const SnapshotStage& stage) override;
+        std::string get_extension() const override { return ".sphc"; }
+        std::string get_format_name() const override { return "Columnar"; }
+
+    private:
+        static constexpr uint32_t MAGIC_NUMBER = 0x53504803; // "SPH\x03"
+        static constexpr uint32_t VERSION = 1;
+    };
+
+    /**
+     * @brief Append-store container writer (.sphar)
+     *
+     * One append-only file per run instead of one file per snapshot:
+     * 10k-snapshot runs create tens of thousands of small files whose
+     * creation and metadata operations dominate write time on parallel
+     * scratch filesystems. The container starts with a file header (magic,
+     * version, dimension, unit factors and names) and then grows by framed
+     * snapshots only:
+     * - frame magic (uint32), payload size (uint64), time (double),
+     *   particle count (uint32)
+     * - payload: a complete columnar snapshot, byte-identical to a .sphc
+     *   file (see ColumnarOutputWriter), so column random access works
+     *   inside a frame too
+     * A sidecar "<file>.idx" receives one text row per frame
+     * (frame, offset, size, time, particles), giving readers random access
+     * by time; the container itself can also be walked sequentially from
+     * the frame headers alone. Both files are opened once and only ever
+     * appended to.
+     */
+    class ContainerOutputWriter : public OutputWriter
+    {
+    public:
+        using OutputWriter::OutputWriter;
+
+        void write_staged(const SnapshotStage& stage) override;
+        std::string get_extension() const override { return ".sphar"; }
+        std::string get_format_name() const override { return "Container"; }
+
+    private:
+        /// Open (and header-initialize when new) the container and sidecar.
+        bool open_container();
+
+        std::ofstream m_out;       // append-only container stream
+        std::ofstream m_index_out; // append-only sidecar index
+        uint64_t m_offset = 0;     // current end-of-container offset
+    };
+
     /**
      * @brief Factory function to create appropriate output writer
      */
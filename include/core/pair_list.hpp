@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+
+#include "utilities/vector_type.hpp"
+
+namespace sph
+{
+
+    class ParticleSoA;
+    class NeighborCache;
+    class Periodic;
+    class KernelFunction;
+
+    // Per-step interaction-pair geometry shared across modules.
+    //
+    // The neighbor cache already fixes *which* pairs interact; every module
+    // then still re-derived the pair geometry — periodic separation, distance
+    // and the two kernel gradients — in its own loop. This stage computes
+    // that once per step, right after the smoothing lengths are final, into
+    // flat arrays aligned entry-for-entry with the cache's CSR index
+    // ("neighbor list once, physics many times"). The fluid-force loops and
+    // detect_shocks then stream through the precomputed entries.
+    //
+    // Entries outside the interaction cut (r >= max(h_i, h_j), or r == 0 for
+    // coincident particles) store zeroed gradients; consumers keep their
+    // usual cut test on the stored distance, so the semantics match the
+    // direct evaluation exactly. Enabled with the pairList config key;
+    // invalidated with the neighbor cache by make_tree() and rebuilt every
+    // step because positions move even while Verlet mode reuses the lists.
+    class PairList
+    {
+        std::vector<vec_t> m_r_ij;
+        std::vector<real> m_r;
+        std::vector<vec_t> m_dw_i;
+        std::vector<vec_t> m_dw_j;
+        bool m_valid = false;
+
+    public:
+        bool is_valid() const { return m_valid; }
+        void invalidate() { m_valid = false; }
+
+        // Heap bytes across the entry arrays, for the memory accounting.
+        std::size_t footprint_bytes() const
+        {
+            return m_r_ij.capacity() * sizeof(vec_t) + m_r.capacity() * sizeof(real) +
+                   m_dw_i.capacity() * sizeof(vec_t) + m_dw_j.capacity() * sizeof(vec_t);
+        }
+
+        // Entry accessors; e is the flat CSR entry index
+        // (NeighborCache::first(i) + n).
+        const vec_t &r_ij(const int e) const { return m_r_ij[e]; }
+        real r(const int e) const { return m_r[e]; }
+        const vec_t &dw_i(const int e) const { return m_dw_i[e]; }
+        const vec_t &dw_j(const int e) const { return m_dw_j[e]; }
+
+        // Recompute every entry from the current positions and smoothing
+        // lengths; requires a valid cache.
+        void build(const ParticleSoA &soa, const NeighborCache &cache, const int particle_num,
+                   const Periodic *periodic, const KernelFunction *kernel);
+    };
+
+} // namespace sph
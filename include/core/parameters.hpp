@@ -2,6 +2,7 @@
 
 #include "utilities/defines.hpp"
 #include <string>
+#include <vector>
 
 namespace sph
 {
@@ -21,12 +22,27 @@ namespace sph
         UNKNOWN,
     };
 
+    enum struct ExternalPotentialType
+    {
+        POINT_MASS,
+        PLUMMER,
+        NFW,
+    };
+
     // ADDED: HeatingCooling
     struct HeatingCooling
     {
         bool is_valid = false;
         real heating_rate = 0.0;
         real cooling_rate = 0.0;
+
+        // Sub-cycled implicit integration (coolingSubcycle config key): the
+        // source term gets its own inner backward-Euler iterations inside the
+        // per-particle sweep, each capped at `subcycle_tol` relative energy
+        // change, so short cooling times stop forcing tiny global timesteps.
+        bool subcycle = false;
+        real subcycle_tol = 0.1; // max |du|/u per inner step
+        int max_subcycles = 64;  // safety cap on inner iterations per step
     };
 
     struct SPHParameters
@@ -48,6 +64,11 @@ namespace sph
             real force;
             real ene;
 
+            // dt controller (see TimeStep): growth cap per step and the
+            // interval/safety pair for the amortized standalone reduction
+            real dt_growth_limit = 1.25;
+            int dt_reduction_interval = 8;
+            real dt_stale_safety = 0.9;
         } cfl;
 
         struct ArtificialViscosity
@@ -70,6 +91,10 @@ namespace sph
         {
             int max_level;
             int leaf_particle_num;
+            bool use_cell_list = false; // uniform linked-cell engine instead of the BH tree
+            bool refit = false;         // refit node moments between full rebuilds
+            int refit_interval = 8;     // full rebuilds at least this often
+            bool auto_tune = false;     // sweep leaf_particle_num during the first steps (see TreeTuner)
         } tree;
 
         struct Physics
@@ -80,13 +105,134 @@ namespace sph
 
         KernelType kernel;
 
+        // Tabulated kernel evaluation (see kernel/tabulated_kernel.hpp):
+        // w/dw/dhw looked up from shared L1-resident interpolation tables
+        // instead of the branchy piecewise polynomials
+        bool tabulated_kernel = false;
+
         bool iterative_sml;
 
+        // Verlet/skin-radius neighbor-list mode: searches use an inflated
+        // radius and the tree + neighbor cache are reused across steps until
+        // the accumulated displacement exceeds half the skin.
+        struct Verlet
+        {
+            bool is_valid = false;
+            real skin_factor = 0.2; // skin radius as a fraction of the max smoothing length
+        } verlet;
+
+        // Space-filling-curve reordering: every `interval` steps the particle
+        // array is permuted into Morton order so neighbor loops stream through
+        // nearly-contiguous memory.
+        struct Reorder
+        {
+            bool is_valid = false;
+            int interval = 50;
+        } reorder;
+
+        // Block (hierarchical) timesteps: particles are sorted into
+        // power-of-two bins of the global dt and only particles at their bin
+        // boundary get their forces recomputed each step.
+        struct BlockTimesteps
+        {
+            bool is_valid = false;
+            int max_bins = 8;
+        } block_timesteps;
+
+        // Symmetrized pair evaluation: the fluid-force loops visit each i-j
+        // pair once and scatter the +/- contribution to both particles via
+        // per-thread buffers (PairAccumulator), halving the pair work.
+        bool symmetrize_force = false;
+
+        // Warm-started smoothing-length iteration: each particle persists its
+        // converged h and dh/dt (from the velocity divergence), predicts h at
+        // the next step, and skips the Newton-Raphson loop entirely while the
+        // predicted relative change stays below the iteration tolerance.
+        bool warm_start_sml = false;
+
+        // Shared pair-geometry stream (pairList config key): after the
+        // smoothing lengths are final, the periodic separation, distance and
+        // kernel gradients of every cached pair are computed once per step
+        // and the force loops and shock detection stream through them.
+        bool pair_list = false;
+
+        // GPU offload (gpuOffload config key): run the plain density and
+        // standard-SPH force pair loops as OpenMP target kernels with the
+        // flattened particle arrays resident on the device. Needs a build
+        // with -DUSE_GPU_OFFLOAD=ON; otherwise the key is accepted but the
+        // host loops run as before.
+        bool gpu_offload = false;
+
+        // NUMA placement (numaFirstTouch/numaPinThreads config keys):
+        // re-place the particle vector (and SoA mirrors) with parallel
+        // first-touch matching the loop partition, and pin the threads so
+        // the partition-to-socket mapping stays fixed.
+        struct Numa
+        {
+            bool first_touch = false;
+            bool pin_threads = false; // defaults to first_touch when unset
+        } numa;
+
+        // Transparent hugepages (hugePages config key): madvise the big
+        // long-lived arrays — particle vector, tree node pools, SoA/CSR
+        // mirrors — to 2 MiB pages to cut dTLB misses (see HugePages).
+        struct HugePages
+        {
+            bool enabled = false;
+        } huge_pages;
+
+        // Runtime-selectable OpenMP scheduling for the hot module loops
+        // (ompSchedule/ompChunk config keys): "static", "dynamic", "guided",
+        // or "auto" to time candidates per loop and lock in the fastest.
+        struct OmpSchedule
+        {
+            std::string kind = "static";
+            int chunk = 0; // 0 = library default chunking
+        } omp_schedule;
+
+        // Incremental shock detection: particles whose density/pressure have
+        // drifted less than this relative threshold since their last full
+        // evaluation (and whose neighbor count is unchanged) keep their
+        // previous shockSensor. 0 = full re-evaluation every step.
+        real shock_refresh_threshold = 0.0;
+
+        // Adaptive particle refinement (adaptiveRefinement config key):
+        // every interval-th step, particles whose shockSensor is at or above
+        // split_threshold are replaced by 2*DIM mass-conserving children and
+        // quiescent neighbor pairs below merge_threshold are merged (see
+        // utilities/particle_refinement.hpp). The mass factors bound the
+        // cascade as multiples of the median initial fluid mass.
+        struct Refinement
+        {
+            bool is_valid = false;
+            real split_threshold = 1.5; // shockSensor at or above this splits
+            real merge_threshold = 0.5; // both partners below this may merge
+            int interval = 10;          // steps between refinement passes
+            real min_mass_factor = 0.2; // lower mass bound / median IC mass
+            real max_mass_factor = 2.0; // upper mass bound / median IC mass
+        } refinement;
+
+        // Escaped-material culling (cullRadius config key): every
+        // interval-th step, fluid particles farther than radius from the
+        // origin are removed and the array compacted (see
+        // utilities/particle_culling.hpp).
+        struct Culling
+        {
+            bool is_valid = false;
+            real radius = 0.0;
+            int interval = 50; // steps between culling scans
+        } culling;
+
         struct Periodic
         {
             bool is_valid;
             real range_max[DIM];
             real range_min[DIM];
+
+            // periodicGhosts config key: replicate boundary particles as
+            // shifted image particles each step so pair separations are
+            // plain differences (no per-pair minimum-image branching).
+            bool use_ghosts = false;
         } periodic;
 
         struct Gravity
@@ -94,8 +240,31 @@ namespace sph
             bool is_valid;
             real constant;
             real theta;
+            bool dual_tree = false; // group (leaf-cell) tree walk instead of per-particle
+            // Multi-rate mode (gravityInterval config key): the field evolves
+            // on orbital timescales while dt is sound-crossing limited, so the
+            // full tree solve runs every `interval` steps and the steps in
+            // between reuse it (held, or linearly extrapolated).
+            int interval = 1;
+            bool extrapolate = true;
         } gravity;
 
+        // Analytic external potential (useExternalPotential config key): a
+        // closed-form background acceleration — point mass, Plummer or NFW
+        // on a prescribed straight-line trajectory — applied per particle
+        // in the gravity slot (see utilities/external_potential.hpp), so
+        // non-self-gravitating runs can leave useGravity off.
+        struct ExternalPotential
+        {
+            bool is_valid = false;
+            ExternalPotentialType profile = ExternalPotentialType::POINT_MASS;
+            real constant = 1.0;       // G (the shared "G" config key)
+            real mass = 0.0;           // total mass; for NFW, 4 pi rho_s r_s^3
+            real scale = 0.0;          // Plummer radius / NFW scale radius
+            real center[DIM] = {};     // trajectory position at t = 0
+            real velocity[DIM] = {};   // prescribed drift
+        } external_potential;
+
         struct GSPH
         {
             bool is_2nd_order;
@@ -103,6 +272,16 @@ namespace sph
 
         } gsph;
 
+        struct GDISPH
+        {
+            // Region-partitioned execution (shockRegionSwitch): bucket
+            // particles by shock mode each step and run the Riemann machinery
+            // only over the shock bucket; smooth-flow particles get the
+            // inviscid DISPH-like loop.
+            bool region_switch = false;
+            real mach_threshold = 1.1; // shockSensor (Mach estimate) at or above this marks shock mode
+        } gdisph;
+
         // ADDED: For Heating & Cooling
         HeatingCooling heating_cooling;
         real boundary_radius;
@@ -140,8 +319,61 @@ namespace sph
             int max_keep = 3;                  // Maximum number of checkpoints to keep
             bool on_interrupt = true;          // Save checkpoint on SIGINT
             std::string directory = "checkpoints";  // Directory for checkpoint files
+            bool delta = false;                // Keyframe + delta chains (checkpointDelta)
+            int keyframe_interval = 10;        // Every Nth checkpoint is a full keyframe
+            real delta_tolerance = 0.0;        // Relative change kept from the keyframe (0 = lossless)
         } checkpointing;
 
+        // In-situ analysis (insituAnalysis config key): reduction passes run
+        // over the live particle state after each step, appending compact
+        // rows to per-quantity files instead of relying on full snapshots.
+        struct InSitu
+        {
+            bool enabled = false;
+            real interval = 0.0;             // simulation time between samples; 0 = every step
+            int profile_bins = 64;           // radial-profile resolution
+            std::vector<std::string> passes; // insituPasses subset; empty = all
+        } insitu;
+
+        // Activity-adaptive output cadence (adaptiveOutput config key): the
+        // snapshot interval shrinks toward min_interval during rapid
+        // evolution and stretches toward max_interval when nothing happens.
+        // Activity is judged from metrics the step already produces: the
+        // maximum shockSensor, the global dt relative to its running
+        // maximum, and the kinetic-energy change since the last snapshot.
+        struct AdaptiveOutput
+        {
+            bool is_valid = false;
+            real min_interval = 0.0; // outputTimeMin; default time.output / 8
+            real max_interval = 0.0; // outputTimeMax; default time.output * 8
+        } adaptive_output;
+
+        // Snapshot selection: restrict the regular snapshots to a region of
+        // interest (box or sphere in simulation coordinates) and/or thin them
+        // with a level-of-detail stride writing every k-th particle of the
+        // (Morton-ordered, see Reorder) array. Every full_interval-th
+        // snapshot is still a complete dump; checkpoints always are.
+        struct SnapshotSelection
+        {
+            bool roi_box = false;    // snapshotRoiMin/snapshotRoiMax
+            bool roi_sphere = false; // snapshotRoiCenter + snapshotRoiRadius
+            real roi_min[DIM];
+            real roi_max[DIM];
+            real roi_center[DIM];
+            real roi_radius = 0.0;
+            int lod_stride = 1;    // snapshotLodStride; 1 = every particle
+            int full_interval = 0; // snapshotFullInterval; 0 = never
+        } snapshot;
+
+        // Out-of-core mode (outOfCore config key): file-backed storage for
+        // the large derived arrays so runs near the memory limit degrade to
+        // streaming against the scratch file instead of OOMing.
+        struct OutOfCore
+        {
+            bool enabled = false;
+            std::string directory; // outOfCoreDirectory; empty = {run_dir}/scratch
+        } out_of_core;
+
         real impact_parameter;
         real initial_velocity;
         real point_mass;
@@ -5,22 +5,26 @@
 namespace sph
 {
 
+    // Field layout is split into a hot block and a cold block. The hot block
+    // holds everything the per-neighbor force loops and the tree search read
+    // (pos/vel/mass/dens/pres/sml/sound/gradh plus the AV state), packed at
+    // the front of the record so the AoS paths touch the leading cache lines
+    // only; neighbor-side reads additionally go through the compact
+    // ParticleSoA view. Integrator state and the cold diagnostic fields
+    // (shock detector, relaxation targets, output-only scalars) trail at the
+    // end and never enter the pair loops.
     class SPHParticle
     {
     public:
-        vec_t pos;       // position
-        vec_t vel;       // velocity
-        vec_t vel_p;     // velocity at t + dt/2
-        vec_t acc;       // acceleration
-        real mass;       // mass
-        real dens;       // mass density
-        real pres;       // pressure
-        real ene;        // internal energy
-        int ene_floored; // Flag: 1 if energy floored, 0 otherwise
-        real ene_p;      // internal energy at t + dt/2
-        real dene;       // du/dt
-        real sml;        // smoothing length
-        real sound;      // sound speed
+        // --- hot block: read per neighbor interaction ---
+        vec_t pos;  // position
+        vec_t vel;  // velocity
+        real mass;  // mass
+        real dens;  // mass density
+        real pres;  // pressure
+        real ene;   // internal energy
+        real sml;   // smoothing length
+        real sound; // sound speed
 
         real balsara; // balsara switch
         real alpha;   // AV coefficient
@@ -29,31 +33,49 @@ namespace sph
         real volume; // volume element V = m/ρ (for DISPH/GDISPH)
         real q; // smoothed internal energy density (for DISPH/GDISPH): q = Σ_j (m_j*u_j)*W_ij
 
-        real phi = 0.0;             // potential
         bool is_point_mass = false; // Flag to indicate if particle is fixed
+        bool is_wall = false; // <<-- flag indicating a wall particle
+        bool is_active = true; // forces recomputed this step (always true for a global dt)
+
+        // --- integrator state: written per step, not read per neighbor ---
+        vec_t vel_p; // velocity at t + dt/2
+        vec_t acc;   // acceleration
+        real ene_p;  // internal energy at t + dt/2
+        real dene;   // du/dt
+        real h_dot;  // dh/dt from div(v) (warm-started smoothing-length iteration)
 
         int id;
         int neighbor;
-        SPHParticle *next = nullptr;
-        bool is_wall = false; // <<-- flag indicating a wall particle
+        int dt_bin; // power-of-two timestep bin (block timesteps, 0 = base dt)
+
+        // --- cold block: diagnostics and output-only fields ---
+        real h_per_v_sig; // per-particle Courant value h / v_sig_max from the
+                          // last pre-interaction sweep (block-timestep input)
+        real phi = 0.0;  // potential
+        int ene_floored; // Flag: 1 if energy floored, 0 otherwise
 
         real shockSensor; // dimensionless measure of compression
         int shockMode;    // 1 = currently in shock mode, 0 = not
         int oldShockMode;
+        real shock_ref_dens;    // state at the last full shock-detection pass
+        real shock_ref_pres;    // (incremental mode skips particles that have
+        int shock_ref_neighbor; //  barely moved away from this reference)
         bool switch_to_no_shock_region = false; // True if DISPH will be used
         real target_rho;
-        
+
         // Constructor with default initialization to prevent uninitialized members
-        SPHParticle() 
-            : pos{}, vel{}, vel_p{}, acc{},
+        SPHParticle()
+            : pos{}, vel{},
               mass(0.0), dens(0.0), pres(0.0), ene(0.0),
-              ene_floored(0), ene_p(0.0), dene(0.0),
               sml(0.1),  // CRITICAL: Default smoothing length (prevents NaN/inf)
               sound(0.0), balsara(0.0), alpha(2.0),
               gradh(1.0), volume(0.0), q(0.0),
-              phi(0.0), is_point_mass(false),
-              id(0), neighbor(0), next(nullptr), is_wall(false),
+              is_point_mass(false), is_wall(false), is_active(true),
+              vel_p{}, acc{}, ene_p(0.0), dene(0.0), h_dot(0.0),
+              id(0), neighbor(0), dt_bin(0),
+              h_per_v_sig(0.0), phi(0.0), ene_floored(0),
               shockSensor(0.0), shockMode(0), oldShockMode(0),
+              shock_ref_dens(0.0), shock_ref_pres(0.0), shock_ref_neighbor(-1),
               switch_to_no_shock_region(false), target_rho(0.0)
         {}
     };;
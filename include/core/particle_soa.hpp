@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "utilities/vector_type.hpp"
+#include "utilities/mapped_arena.hpp"
+
+namespace sph
+{
+
+    class SPHParticle;
+
+    // Structure-of-arrays mirror of the hot SPHParticle fields.
+    //
+    // SPHParticle is a ~200-byte record, but the per-neighbor force loops only
+    // touch a handful of fields (pos/vel/mass/dens/pres/sml/...). Streaming the
+    // full struct through cache dominates step time at large particle counts,
+    // so modules load this compact view once per calculation() and read their
+    // neighbor data from the contiguous per-field arrays instead.
+    //
+    // The std::vector<SPHParticle> owned by Simulation remains the canonical
+    // store (and the compatibility view handed to plugins); this class is a
+    // derived, read-mostly snapshot refreshed via load_from().
+    //
+    // In the out-of-core mode (outOfCore config key) the arrays are carved
+    // from one file-backed MappedArena instead of heap vectors: the kernel
+    // then writes cold blocks back to the scratch file under memory pressure
+    // and reads them ahead again during the Morton-ordered sweeps, so large
+    // runs degrade to streaming instead of getting OOM-killed.
+    class ParticleSoA
+    {
+    public:
+        // The subset of the std::vector interface the force loops use; backed
+        // by an owned heap vector normally, or attached to an arena block in
+        // the out-of-core mode.
+        template <typename T>
+        class Array
+        {
+            std::vector<T> m_heap;
+            T *m_data = nullptr;
+            std::size_t m_size = 0;
+
+        public:
+            T &operator[](const int i) { return m_data[i]; }
+            const T &operator[](const int i) const { return m_data[i]; }
+            std::size_t size() const { return m_size; }
+            std::size_t footprint_bytes() const { return m_heap.capacity() * sizeof(T); }
+
+            void resize(const int n);
+            void attach(T *data, const int n);
+        };
+
+        Array<vec_t> pos;
+        Array<vec_t> vel;
+        Array<real> mass;
+        Array<real> dens;
+        Array<real> pres;
+        Array<real> ene;
+        Array<real> sml;
+        Array<real> sound;
+        Array<real> gradh;
+        Array<real> alpha;
+        Array<real> balsara;
+        Array<unsigned char> is_point_mass;
+        Array<unsigned char> is_wall;
+        Array<unsigned char> is_active;
+
+        int size() const { return static_cast<int>(mass.size()); }
+
+        // Heap bytes across all arrays (zero per attached array in the
+        // out-of-core mode, where the arena owns the storage).
+        std::size_t footprint_bytes() const
+        {
+            return pos.footprint_bytes() + vel.footprint_bytes() + mass.footprint_bytes() +
+                   dens.footprint_bytes() + pres.footprint_bytes() + ene.footprint_bytes() +
+                   sml.footprint_bytes() + sound.footprint_bytes() + gradh.footprint_bytes() +
+                   alpha.footprint_bytes() + balsara.footprint_bytes() +
+                   is_point_mass.footprint_bytes() + is_wall.footprint_bytes() +
+                   is_active.footprint_bytes();
+        }
+
+        void resize(const int particle_num);
+
+        // Refresh every array from the canonical AoS store.
+        void load_from(const std::vector<SPHParticle> &particles, const int particle_num);
+
+        // Switch to file-backed storage; takes effect on the next resize.
+        void enable_out_of_core(const std::string &backing_file);
+
+    private:
+        bool m_out_of_core = false;
+        std::string m_backing_file;
+        MappedArena m_arena;
+    };
+
+} // namespace sph
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+#include "core/particle.hpp"
+
+namespace sph
+{
+
+    // Zero-copy view over a contiguous range of particles (a C++14 stand-in
+    // for std::span<SPHParticle>). Plugins and IC modifiers transform the
+    // simulation's particles through this view instead of receiving the
+    // vector itself, so in-place edits never involve a replacement vector.
+    //
+    // Appending through ParticleAppender may reallocate the underlying
+    // storage; re-acquire the span afterwards rather than holding one
+    // across appends.
+    class ParticleSpan
+    {
+        SPHParticle *m_data;
+        int m_size;
+
+    public:
+        ParticleSpan(SPHParticle *data, const int size) : m_data(data), m_size(size) {}
+
+        int size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        SPHParticle &operator[](const int i) const { return m_data[i]; }
+        SPHParticle *begin() const { return m_data; }
+        SPHParticle *end() const { return m_data + m_size; }
+    };
+
+    // In-place appender over the simulation's particle storage: new
+    // particles are default-constructed directly in the vector and filled
+    // through the returned reference, so adding particles during IC setup
+    // never builds a whole second vector next to the live one (which
+    // doubled peak memory on the largest runs).
+    class ParticleAppender
+    {
+        std::vector<SPHParticle> &m_particles;
+
+    public:
+        explicit ParticleAppender(std::vector<SPHParticle> &particles)
+            : m_particles(particles) {}
+
+        // Pre-size the storage for n more particles: one allocation, and
+        // spans stay valid across the subsequent appends up to n.
+        void reserve(const int n)
+        {
+            m_particles.reserve(m_particles.size() + n);
+        }
+
+        SPHParticle &append()
+        {
+            m_particles.emplace_back();
+            return m_particles.back();
+        }
+
+        int size() const { return static_cast<int>(m_particles.size()); }
+    };
+
+}
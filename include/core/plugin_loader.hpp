@@ -28,9 +28,15 @@ public:
      * @return Pointer to the loaded plugin
      */
     SimulationPlugin* load(const std::string& plugin_path) {
+        // Same library already loaded (e.g. sweep mode running many configs
+        // in one process): reuse the handle instead of a dlclose/dlopen pair.
+        if (m_handle && plugin_path == m_plugin_path) {
+            return m_plugin;
+        }
+
         // Unload any existing plugin
         unload();
-        
+
         // Load the shared library
         m_handle = dlopen(plugin_path.c_str(), RTLD_LAZY);
         if (!m_handle) {
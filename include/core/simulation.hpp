@@ -1,10 +1,16 @@
 #pragma once
 
 #include <memory>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 
 #include "core/particle.hpp"
+#include "core/particle_span.hpp"
+#include "core/particle_soa.hpp"
+#include "core/neighbor_cache.hpp"
+#include "core/pair_list.hpp"
+#include "core/gpu_offload.hpp"
 #include "utilities/initial_conditions_modifier.hpp"
 #include "core/logger.hpp"
 namespace sph
@@ -13,14 +19,16 @@ namespace sph
     struct SPHParameters;
     class KernelFunction;
     class Periodic;
-    class BHTree;
-
-#define ADD_MEMBER(type, name)                \
-public:                                       \
-    void set_##name(type v) { m_##name = v; } \
-    type &get_##name() { return m_##name; }   \
-                                              \
-private:                                      \
+    class NeighborSearcher;
+    class StepTimer;
+
+#define ADD_MEMBER(type, name)                                  \
+public:                                                         \
+    void set_##name(const type &v) { m_##name = v; }            \
+    void set_##name(type &&v) { m_##name = std::move(v); }      \
+    type &get_##name() { return m_##name; }                     \
+                                                                \
+private:                                                        \
     type m_##name
 
     class Simulation
@@ -30,30 +38,163 @@ private:                                      \
         ADD_MEMBER(real, time);
         ADD_MEMBER(real, dt);
         ADD_MEMBER(real, h_per_v_sig);
+        // Timestep minima fused into the force sweep (see FluidForce): valid
+        // only while no later module has rewritten acc or ene this step.
+        ADD_MEMBER(accum_t, dt_force_min);
+        ADD_MEMBER(accum_t, dt_ene_min);
+        ADD_MEMBER(bool, dt_minima_valid);
         ADD_MEMBER(std::shared_ptr<KernelFunction>, kernel);
         ADD_MEMBER(std::shared_ptr<Periodic>, periodic);
-        ADD_MEMBER(std::shared_ptr<BHTree>, tree);
+        ADD_MEMBER(std::shared_ptr<NeighborSearcher>, tree);
 
-        std::unordered_map<std::string, std::vector<real>> additional_scalar_array;
-        std::unordered_map<std::string, std::vector<vec_t>> additional_vector_array;
+        // Additional per-particle arrays (e.g. the MUSCL gradients) live in a
+        // dense registry indexed by handle; the maps only translate names to
+        // handles. Arrays are registered during setup and never removed, so a
+        // resolved handle stays valid for the whole run.
+        std::unordered_map<std::string, int> additional_scalar_index;
+        std::unordered_map<std::string, int> additional_vector_index;
+        std::vector<std::vector<real>> additional_scalar_arrays;
+        std::vector<std::vector<vec_t>> additional_vector_arrays;
         std::shared_ptr<InitialConditionsModifier> initial_conditions_modifier;
+        ParticleSoA particle_soa;
+        NeighborCache neighbor_cache;
+        PairList pair_list;
+
+        // Partitioned particle-index lists by type (see update_type_partition)
+        std::vector<int> m_sph_ids;   // fluid + wall: everything the SPH sweeps touch
+        std::vector<int> m_fluid_ids; // time-integrated particles
+        std::vector<int> m_wall_ids;
+        std::vector<int> m_point_mass_ids;
+        int m_partition_num = -1; // particle count the lists were built for
+        bool m_partition_dirty = true;
+        void update_type_partition();
+        GpuOffload gpu_offload;
+        StepTimer *step_timer = nullptr;
+        int m_cache_neighbor_number;
+        bool m_use_pair_list;
 
     public:
         Simulation(std::shared_ptr<SPHParameters> param);
         void update_time();
         void make_tree();
+
+        // Refresh the SoA view from the canonical particle vector. Hot modules
+        // call this at the top of calculation() and then iterate the arrays.
+        void sync_particle_soa()
+        {
+            particle_soa.load_from(m_particles, m_particle_num);
+        }
+
+        const ParticleSoA &get_particle_soa() const { return particle_soa; }
+
+        // Out-of-core mode: back the derived particle arrays with files in
+        // the run's scratch directory (see ParticleSoA::enable_out_of_core).
+        void enable_out_of_core(const std::string &scratch_dir)
+        {
+            particle_soa.enable_out_of_core(scratch_dir + "/particle_soa.bin");
+        }
+
+        // Build the shared per-step neighbor-list cache (CSR index over all
+        // particles, is_ij = true). Called once per step by the solver after
+        // PreInteraction has finalized the smoothing lengths; invalidated by
+        // make_tree().
+        void build_neighbor_cache();
+        const NeighborCache &get_neighbor_cache() const { return neighbor_cache; }
+
+        // Warm restart: adopt a neighbor-cache CSR image saved in a
+        // checkpoint. Must follow make_tree(), which invalidates the cache.
+        void adopt_neighbor_cache(std::vector<int> &&offsets, std::vector<int> &&indices)
+        {
+            neighbor_cache.adopt(std::move(offsets), std::move(indices));
+        }
+
+        // Rebuild the shared pair-geometry stream over the cache's CSR index
+        // (pairList config key; no-op when disabled or without a cache).
+        // Called once per step after the smoothing lengths are final.
+        void build_pair_list();
+        const PairList &get_pair_list() const { return pair_list; }
+
+        // Refresh this object's rows in the MemoryFootprint registry; the
+        // tree pool and the per-thread scratch account at their own
+        // allocation sites. Called by the solver at startup and per snapshot.
+        void account_memory() const;
+
+        // Optional OpenMP target offload engine for the density and force
+        // pair loops (gpuOffload config key); inert unless built with
+        // -DUSE_GPU_OFFLOAD=ON and a device is present.
+        GpuOffload &get_gpu_offload() { return gpu_offload; }
+
+        // Solver's per-step timing log, so modules can record sub-phases
+        // (e.g. the GDISPH per-mode loops); null when timing is off.
+        void set_step_timer(StepTimer *timer) { step_timer = timer; }
+        StepTimer *get_step_timer() const { return step_timer; }
+
+        // Permute the particle array into Morton order and remap ids to the
+        // new indices. The tree must be rebuilt afterwards.
+        void reorder_particles();
+
+        // Partitioned index lists by particle type, so hot loops iterate
+        // their range branch-free: sph_ids (fluid + wall) for the density
+        // and force sweeps, fluid_ids for time integration, walls and point
+        // masses in their own small loops. Rebuilt lazily when the particle
+        // count changes or after reorder_particles(); call
+        // invalidate_type_partition() after changing type flags in place.
+        const std::vector<int> &sph_ids() { update_type_partition(); return m_sph_ids; }
+        const std::vector<int> &fluid_ids() { update_type_partition(); return m_fluid_ids; }
+        const std::vector<int> &wall_ids() { update_type_partition(); return m_wall_ids; }
+        const std::vector<int> &point_mass_ids() { update_type_partition(); return m_point_mass_ids; }
+        void invalidate_type_partition() { m_partition_dirty = true; }
+
+        // Zero-copy IC setup (see particle_span.hpp): plugins and modifiers
+        // view and append particles directly in the simulation's storage,
+        // then finalize_particles() refreshes the count and type partition.
+        ParticleSpan particle_span() { return ParticleSpan(m_particles.data(), m_particle_num); }
+        ParticleAppender particle_appender() { return ParticleAppender(m_particles); }
+        void finalize_particles()
+        {
+            m_particle_num = static_cast<int>(m_particles.size());
+            invalidate_type_partition();
+        }
+
         void add_scalar_array(const std::vector<std::string> &names);
         void add_vector_array(const std::vector<std::string> &names);
+
+        // True when any module or plugin registered per-particle arrays.
+        // Passes that permute, compact or append particles must then remap
+        // the registry alongside (see gather_additional_arrays), or the
+        // columns end up attached to the wrong particles.
+        bool has_additional_arrays() const
+        {
+            return !additional_scalar_arrays.empty() || !additional_vector_arrays.empty();
+        }
+
+        // Remap every registered array onto a new particle ordering: entry i
+        // becomes the value held at source[i] in the old ordering, and the
+        // arrays take source.size() as their new length. Appended particles
+        // (refinement children) list their parent's old index and inherit
+        // its values, like the particle fields they are copied from.
+        void gather_additional_arrays(const std::vector<int> &source);
         std::vector<real> &get_scalar_array(const std::string &name);
         std::vector<vec_t> &get_vector_array(const std::string &name);
-        std::unordered_map<std::string, std::vector<real>> &get_scalar_map()
+
+        // Handle API: modules resolve the name once (throws on a missing
+        // array, like the by-name getters) and then index the dense registry
+        // directly in the hot path, with no string hashing.
+        int get_scalar_array_handle(const std::string &name);
+        int get_vector_array_handle(const std::string &name);
+
+        // Registered array names in handle order, so the checkpoint writer
+        // can enumerate the registry without knowing which modules ran.
+        std::vector<std::string> scalar_array_names() const;
+        std::vector<std::string> vector_array_names() const;
+        std::vector<real> &scalar_array(const int handle)
         {
-            return additional_scalar_array;
+            return additional_scalar_arrays[handle];
         }
 
-        std::unordered_map<std::string, std::vector<vec_t>> &get_vector_map()
+        std::vector<vec_t> &vector_array(const int handle)
         {
-            return additional_vector_array;
+            return additional_vector_arrays[handle];
         }
         void set_initial_conditions_modifier(std::shared_ptr<InitialConditionsModifier> mod)
         {
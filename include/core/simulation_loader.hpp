@@ -28,16 +28,20 @@ public:
      * @param name_or_path Either a sample name ("shock_tube") or plugin path ("../simulations/shock_tube/build/shock_tube_plugin.dylib")
      * @param sim The simulation object to populate
      * @param params The SPH parameters
+     * @param create_particles Run the sample's create function; false skips
+     *                         particle generation (IC cache hit) while still
+     *                         resolving the simulation name and source files
      * @return true if successfully loaded and initialized
      */
     bool load_and_initialize(const std::string& name_or_path,
                             std::shared_ptr<Simulation> sim,
-                            std::shared_ptr<SPHParameters> params) {
+                            std::shared_ptr<SPHParameters> params,
+                            bool create_particles = true) {
         // Check if it's a plugin path (ends with .dylib or .so)
         if (is_plugin_path(name_or_path)) {
-            return load_from_plugin(name_or_path, sim, params);
+            return load_from_plugin(name_or_path, sim, params, create_particles);
         } else {
-            return load_from_registry(name_or_path, sim, params);
+            return load_from_registry(name_or_path, sim, params, create_particles);
         }
     }
     
@@ -77,36 +81,43 @@ private:
     
     bool load_from_plugin(const std::string& plugin_path,
                          std::shared_ptr<Simulation> sim,
-                         std::shared_ptr<SPHParameters> params) {
+                         std::shared_ptr<SPHParameters> params,
+                         bool create_particles) {
         try {
             auto* plugin = m_plugin_loader.load(plugin_path);
             if (!plugin) {
                 return false;
             }
-            
+
             m_simulation_name = plugin->get_name();
             m_source_files = plugin->get_source_files();
-            
+
             std::cout << "\n=== Loaded Plugin ===" << std::endl;
             std::cout << "Name: " << plugin->get_name() << std::endl;
             std::cout << "Description: " << plugin->get_description() << std::endl;
             std::cout << "Version: " << plugin->get_version() << std::endl;
             std::cout << "=====================\n" << std::endl;
-            
-            plugin->initialize(sim, params);
+
+            if (create_particles) {
+                plugin->initialize(sim, params);
+            }
             return true;
         } catch (const std::exception& e) {
             std::cerr << "Error loading plugin: " << e.what() << std::endl;
             return false;
         }
     }
-    
+
     bool load_from_registry(const std::string& sample_name,
                            std::shared_ptr<Simulation> sim,
-                           std::shared_ptr<SPHParameters> params) {
+                           std::shared_ptr<SPHParameters> params,
+                           bool create_particles) {
         m_simulation_name = sample_name;
         m_source_files = SampleRegistry::instance().get_source_files(sample_name);
-        
+
+        if (!create_particles) {
+            return true;
+        }
         return SampleRegistry::instance().create_sample(sample_name, sim, params);
     }
     
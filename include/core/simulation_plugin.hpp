@@ -34,9 +34,20 @@ public:
     
     /**
      * @brief Initialize the simulation with particles
-     * 
+     *
      * This is the main function that sets up initial conditions.
-     * 
+     *
+     * Prefer constructing particles in place in the simulation's storage
+     * over building a local vector and copying it in (which doubles peak
+     * memory during IC setup of the largest runs):
+     *
+     *   auto append = sim->particle_appender();
+     *   append.reserve(n);
+     *   for (...) { SPHParticle& p = append.append(); p.pos[0] = ...; }
+     *   sim->finalize_particles();
+     *
+     * Existing particles can be transformed through sim->particle_span().
+     *
      * @param sim The simulation object to populate
      * @param params The SPH parameters
      */
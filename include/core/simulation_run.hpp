@@ -2,8 +2,10 @@
 
 #include <string>
 #include <memory>
+#include <map>
 #include <vector>
 #include <chrono>
+#include <thread>
 #include "utilities/defines.hpp"
 #include "core/output_format.hpp"
 
@@ -51,10 +53,19 @@ namespace sph
             
             std::vector<OutputFormat> output_formats = {OutputFormat::CSV};
             std::vector<std::string> source_files;  // NEW: Paths to source files to save
+
+            // Storage precision for the visualization-grade binary columns
+            // (binaryPrecision config key: "f64", "f32", "f16" or "q16")
+            std::string binary_precision = "f64";
+
+            // Per-writer column selection (outputColumns config key),
+            // keyed by the format directory name ("csv", "columnar", ...);
+            // formats without an entry keep the full schema
+            std::map<std::string, std::vector<std::string>> output_columns;
         };
 
         explicit SimulationRun(const Config& config);
-        ~SimulationRun() = default;
+        ~SimulationRun();  // joins the background source-archiving thread
 
         // Directory access
         std::string get_run_directory() const { return m_run_directory; }
@@ -69,7 +80,12 @@ namespace sph
                                      const UnitSystem& units);
         void save_config(const std::string& config_json);
         void save_metadata(const std::string& metadata_json);
-        void save_source_files();  // NEW: Save source code files
+        // Source-code capture. save_source_files() only launches a
+        // background thread: the actual copy (minutes on an NFS-mounted
+        // simulations directory) overlaps the start of integration, and the
+        // archive is deduplicated by a content-state hash so each unique
+        // source state is copied once and hard-linked into later runs.
+        void save_source_files();
 
         // Output writer creation
         std::unique_ptr<OutputWriter> create_writer(OutputFormat format, 
@@ -88,6 +104,11 @@ namespace sph
         void create_directory_structure();
         void create_latest_symlink();
         void create_directories(const std::string& path);
+
+        // Body of the background source capture (see save_source_files)
+        void archive_source_files();
+        std::string source_state_hash() const;
+        std::thread m_source_thread;
     };
 
     /**
@@ -130,6 +151,9 @@ namespace sph
             int neighbor_number;
             bool use_balsara;
             bool use_time_dependent_av;
+            // multi-rate gravity (gravityInterval): 1 means every step
+            int gravity_interval = 1;
+            bool gravity_extrapolate = false;
         };
 
         struct OutputInfo
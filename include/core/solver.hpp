@@ -1,14 +1,25 @@
 #pragma once
+#include <fstream>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 #include "utilities/unit_system.hpp"
 #include "utilities/checkpoint_manager.hpp"
+#include "utilities/step_timer.hpp"
+#include "utilities/tree_tuner.hpp"
+#include "utilities/perf_counters.hpp"
 #include "modules/module.hpp"
 #include "relaxation/lane_emden_relaxation.hpp"
 #include "core/simulation_run.hpp"
 #include "core/output_format.hpp"
+#include "core/async_output.hpp"
 #include "core/simulation_loader.hpp"
+#include "core/mpi_domain.hpp"
+#include "core/ghost_layer.hpp"
+#include "utilities/particle_refinement.hpp"
+#include "utilities/particle_culling.hpp"
+#include "core/insitu_analysis.hpp"
 
 namespace sph
 {
@@ -31,12 +42,59 @@ namespace sph
         void parseJsonOverrides();
 
         void initialize();
+
+        // Built-in strong-scaling harness (--scaling-threads=1,2,4,...):
+        // initializes once, integrates a fixed number of steps per thread
+        // count from the same snapshot, and logs speedup, efficiency and the
+        // per-module breakdown from the timing instrumentation.
+        void run_scaling();
+
+        // Parameter-sweep orchestrator (--sweep=list.txt): runs every config
+        // listed in the file back-to-back in this process, so the loaded
+        // plugin, the OpenMP thread pool and the IC cache are shared across
+        // the whole sweep. Each configuration still gets its own
+        // SimulationRun directory.
+        void run_sweep();
+
+        // The main time loop plus the end-of-run reporting; run() and the
+        // sweep orchestrator call this after initialize().
+        void run_simulation_loop();
+
         void integrate();
         void predict();
         void correct();
-        
+
+        // Drift/kick loops templated over the (run-constant) 2.5D and
+        // periodic flags so the z-clamp and the boundary wrap cost nothing
+        // in runs that do not use them (see predict()/correct()).
+        template <bool TwoAndHalf, bool PeriodicWrap>
+        void predict_impl();
+        template <bool TwoAndHalf>
+        void correct_impl();
+        void update_verlet_skin();
+
+        // ROI/LOD snapshot selection (snapshotRoi*/snapshotLod* config
+        // keys): returns a reduced copy of the live simulation for the
+        // writers, or the live simulation itself when selection is off or a
+        // periodic full dump is due.
+        std::shared_ptr<Simulation> snapshot_view();
+
+        // Activity-adaptive output cadence (adaptiveOutput config key):
+        // returns the interval to the next snapshot, shrunk toward
+        // outputTimeMin when the flow is active (shocks present, dt well
+        // below its running maximum, kinetic energy changing fast) and
+        // stretched toward outputTimeMax when it is quiescent.
+        real next_output_interval();
+
+        // Conserved-quantity monitor (energyTime cadence): deterministic
+        // parallel reductions of total energy, linear and angular momentum,
+        // appended to energy.dat in the run directory so validation runs do
+        // not need a high snapshot cadence just to check conservation.
+        void write_conserved_quantities(real t);
+
+
         // Checkpoint/resume functionality
-        void restore_from_checkpoint(const CheckpointData& data);
+        void restore_from_checkpoint(CheckpointData& data);
         
         std::shared_ptr<SPHParameters> m_param;
         std::unique_ptr<SimulationRun> m_simulation_run;
@@ -59,9 +117,102 @@ namespace sph
 
         UnitSystem m_unit;
         std::string m_output_dir;
+
+        // Count of regular snapshots written (drives snapshotFullInterval)
+        int m_snapshot_index = 0;
+
+        // Adaptive-cadence state (see next_output_interval)
+        real m_dt_max_seen = 0.0;
+        real m_last_snapshot_ekin = -1.0;
+
+        // Conserved-quantity series (see write_conserved_quantities)
+        std::ofstream m_energy_out;
+
+        // Verlet neighbor-list state (see SPHParameters::Verlet)
+        real m_verlet_skin = 0.0;
+        int m_step_count = 0;
+        real m_verlet_travel = 0.0;
         
         // Checkpoint manager for pause/resume functionality
         std::unique_ptr<CheckpointManager> m_checkpoint_manager;
+
+        // Background snapshot writer (asyncOutput config key)
+        std::unique_ptr<AsyncOutputManager> m_async_output;
+
+        // MPI slab decomposition; null in single-rank runs
+        std::unique_ptr<DomainDecomposition> m_domain;
+
+        // Periodic ghost-image layer (periodicGhosts config key)
+        GhostLayer m_ghost;
+
+        // Adaptive particle splitting/merging (adaptiveRefinement config key)
+        ParticleRefinement m_refinement;
+
+        // Escaped-material culling (cullRadius config key)
+        ParticleCulling m_culling;
+
+        // In-situ reduction passes (insituAnalysis config key)
+        InSituAnalysis m_insitu;
+
+        // Append the gzip column-wise writer (compressedOutput config key)
+        bool m_compressed_output = false;
+
+        // Append the seek-readable columnar writer (columnarOutput config key)
+        bool m_columnar_output = false;
+
+        // Append the single-file container writer (containerOutput config
+        // key); collective MPI-IO on a decomposed run
+        bool m_container_output = false;
+
+        // Reduced-precision binary columns (binaryPrecision config key)
+        std::string m_binary_precision = "f64";
+
+        // Per-writer column selection (outputColumns config key), keyed by
+        // format name; formats without an entry keep the full schema
+        std::map<std::string, std::vector<std::string>> m_output_columns;
+
+        // Run gravity concurrently with the fluid force (taskParallel key)
+        bool m_task_parallel = false;
+
+        // Per-step OpenMP team sizing (teamAutoSize config key): every
+        // module's parallel loop runs on a team matched to the particle
+        // count, down to a single thread on small steps where fork/join
+        // overhead would dominate. m_team_max_threads caps the growth at
+        // the configured thread budget.
+        bool m_team_auto_size = false;
+        int m_team_particles_per_thread = 2000;
+        int m_team_max_threads = 0;
+
+        // Leaf-size sweep over the first steps (treeAutoTune config key)
+        TreeTuner m_tree_tuner;
+        bool m_tree_retune = false; // force a full rebuild after a switch
+
+        // Initial-conditions cache (icCache config key): the generated (and
+        // relaxation-seeded) particle state is stored in checkpoint format
+        // keyed by a hash of the resolved config + sample + DIM, so repeated
+        // sweeps with identical ICs skip the sample's create function
+        bool m_ic_cache = false;
+        std::string m_ic_cache_config;  // canonical resolved JSON fed into the key
+
+        // Per-module timing log (timingLog config key)
+        StepTimer m_step_timer;
+        bool m_timing_requested = false;
+
+        // Per-particle cost histograms (costInstrumentation config key)
+        bool m_cost_requested = false;
+
+        // Hardware counters for the hot kernels (USE_PERF_COUNTERS builds;
+        // enabled alongside the timing log, no-op otherwise)
+        PerfCounters m_perf_counters;
+
+        // Scaling harness state (--scaling-threads / --scaling-steps)
+        bool m_scaling_mode = false;
+        std::vector<int> m_scaling_threads;
+        int m_scaling_steps = 10;
+
+        // Sweep orchestrator state (--sweep=list.txt)
+        bool m_sweep_mode = false;
+        std::string m_sweep_list_file;
     };
 
 } // namespace sph
@@ -30,78 +30,85 @@ namespace sph
                    pow6(term) * (6.0 + (70.0 / 3.0) * q);
         }
 
-        // 1D Gaussian Kernel for the vertical (z) direction.
-        inline real W1D(const real z, const real h_z)
-        {
-            return 1.0 / (std::sqrt(2.0 * M_PI) * h_z) * std::exp(-0.5 * (z * z) / (h_z * h_z));
-        }
-
-        inline real dW1D_dz(const real z, const real h_z)
-        {
-            real W1 = W1D(z, h_z);
-            return -(z / (h_z * h_z)) * W1;
-        }
-
+#if DIM == 3
         // The product anisotropic kernel: W(x,y,z; h_xy, h_z) = W2D(r_xy; h_xy) * W1D(z; h_z)
-        class AnisotropicKernel : public KernelFunction
+        //
+        // The vertical scale h_z is fixed per run, so its reciprocals and the
+        // Gaussian normalization are precomputed at construction. Each call
+        // takes one reciprocal of the (per-particle) planar scale h_xy and
+        // forms everything else with multiplies; the planar support test uses
+        // the squared metric q_xy^2 = (x^2 + y^2) / h_xy^2 so out-of-support
+        // pairs skip the sqrt and the exponential entirely.
+        class AnisotropicKernel final : public KernelFunction
         {
         public:
             explicit AnisotropicKernel(real hz) : m_hz(hz)
             {
                 if (hz <= 0)
                     throw std::invalid_argument("h_z must be positive");
+                m_hz_inv = 1.0 / hz;
+                m_hz_inv2 = m_hz_inv * m_hz_inv;
+                m_w1d_norm = m_hz_inv / std::sqrt(2.0 * M_PI);
+            }
+
+            // 1D Gaussian kernel for the vertical (z) direction.
+            real W1D(const real z) const
+            {
+                return m_w1d_norm * std::exp(-0.5 * (z * z) * m_hz_inv2);
+            }
+
+            real dW1D_dz(const real z) const
+            {
+                return -(z * m_hz_inv2) * W1D(z);
             }
 
             // Compute the anisotropic kernel value.
             real wAniso(const vec_t &rij, const real h_xy) const
             {
-                if (h_xy <= 0)
-                    throw std::invalid_argument("h_xy must be positive");
-                real r_xy = std::sqrt(rij[0] * rij[0] + rij[1] * rij[1]);
-                real q_xy = r_xy / h_xy;
-                const real sigma_2d = 9.0 / M_PI; // Normalization for 2D Wendland C4
-                return (sigma_2d / (h_xy * h_xy)) * W2D(q_xy) * W1D(rij[2], m_hz);
+                const real h_inv = 1.0 / h_xy;
+                const real h_inv2 = h_inv * h_inv;
+                const real q2_xy = (rij[0] * rij[0] + rij[1] * rij[1]) * h_inv2;
+                if (q2_xy >= 1.0)
+                    return 0.0;
+                return (sigma_2d * h_inv2) * W2D(std::sqrt(q2_xy)) * W1D(rij[2]);
             }
 
             // Compute the gradient for the anisotropic kernel.
             vec_t dwAniso(const vec_t &rij, const real h_xy) const
             {
-                if (h_xy <= 0)
-                    throw std::invalid_argument("h_xy must be positive");
-                real x = rij[0], y = rij[1], z = rij[2];
-                real r_xy = std::sqrt(x * x + y * y);
-                real q_xy = r_xy / h_xy;
-                real dW2D_dr = 0.0;
-                const real sigma_2d = 9.0 / M_PI;
-                if (q_xy < 1.0)
-                {
-                    dW2D_dr = sigma_2d * dW2D_dq(q_xy) / (h_xy * h_xy * h_xy);
-                }
-                vec_t grad_xy = {0.0, 0.0, 0.0};
+                const real x = rij[0], y = rij[1], z = rij[2];
+                const real h_inv = 1.0 / h_xy;
+                const real h_inv2 = h_inv * h_inv;
+                const real q2_xy = (x * x + y * y) * h_inv2;
+                if (q2_xy >= 1.0)
+                    return vec_t{0.0, 0.0, 0.0};
+                const real r_xy = std::sqrt(x * x + y * y);
+                const real q_xy = r_xy * h_inv;
+                const real W1 = W1D(z);
+                const real W2 = sigma_2d * h_inv2 * W2D(q_xy);
+                vec_t grad = {0.0, 0.0, W2 * dW1D_dz(z)};
                 if (r_xy > 1e-8)
                 {
-                    grad_xy[0] = dW2D_dr * (x / r_xy);
-                    grad_xy[1] = dW2D_dr * (y / r_xy);
+                    // dW2D/dr * W1 / r_xy, shared by both planar components
+                    const real planar = sigma_2d * dW2D_dq(q_xy) * h_inv2 * h_inv * W1 / r_xy;
+                    grad[0] = planar * x;
+                    grad[1] = planar * y;
                 }
-                real W1 = W1D(z, m_hz);
-                real dW1_dz = dW1D_dz(z, m_hz);
-                real W2 = sigma_2d * W2D(q_xy) / (h_xy * h_xy);
-                vec_t grad = {grad_xy[0] * W1, grad_xy[1] * W1, W2 * dW1_dz};
                 return grad;
             }
 
             // Finite-difference approximation for derivative with respect to h_xy.
             real dhwAniso(const vec_t &rij, const real h_xy) const
             {
-                if (h_xy <= 0)
-                    throw std::invalid_argument("h_xy must be positive");
                 const real delta = 1e-6 * h_xy;
                 real wPlus = wAniso(rij, h_xy + delta);
                 real wMinus = wAniso(rij, h_xy - delta);
                 return (wPlus - wMinus) / (2.0 * delta);
             }
 
-            // For the standard isotropic interface.
+            // For the standard isotropic interface. The scalar value/dhw forms
+            // cannot be expressed without the vertical offset; loop bodies on
+            // this kernel must use the *Aniso entry points.
             real w(const real r, const real h) const override
             {
                 throw std::runtime_error("Isotropic w(r, h) not applicable for anisotropic kernel; use wAniso");
@@ -117,22 +124,26 @@ namespace sph
                 throw std::runtime_error("Isotropic dhw(r, h) not applicable for anisotropic kernel; use dhwAniso");
             }
 
-            // Dimensionless kernel profile W(q)
-            real W(const real q) const override
+            // Dimensionless planar kernel profile W(q) and its derivative.
+            real W(const real q) const
             {
-                // Delegate to W2D for consistency, as W(q) is used in anisotropic computations
                 return W2D(q);
             }
 
-            // Derivative of W w.r.t. q
-            real dW_dq(const real q) const override
+            real dW_dq(const real q) const
             {
                 return dW2D_dq(q);
             }
 
         private:
+            static constexpr real sigma_2d = 9.0 / M_PI; // Normalization for 2D Wendland C4
+
             real m_hz;
+            real m_hz_inv;
+            real m_hz_inv2;
+            real m_w1d_norm; // 1 / (sqrt(2 pi) h_z)
         };
+#endif
 
     } // namespace Anisotropic
-} // namespace sph
\ No newline at end of file
+} // namespace sph
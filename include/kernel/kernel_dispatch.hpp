@@ -0,0 +1,50 @@
+/* ================================
+ * kernel_dispatch.hpp
+ * ================================ */
+#pragma once
+
+#include "kernel/kernel_function.hpp"
+#include "kernel/cubic_spline.hpp"
+#include "kernel/wendland_kernel.hpp"
+#include "kernel/tabulated_kernel.hpp"
+#include "kernel/anisotropic_kernel.hpp"
+
+namespace sph
+{
+
+    // Invoke func with the kernel downcast to its concrete (final) type.
+    //
+    // The per-pair force loops call kernel->w/dw/dhw billions of times per
+    // run; going through the virtual KernelFunction interface blocks inlining
+    // and vectorization. Hot modules template their loop body over the kernel
+    // type and select the instantiation here, once per calculation() call.
+    // Unknown kernel types (e.g. from plugins) fall back to the virtual
+    // interface unchanged.
+    template <typename Func>
+    inline void kernel_dispatch(const KernelFunction *kernel, Func &&func)
+    {
+        if (auto *cubic = dynamic_cast<const Spline::Cubic *>(kernel))
+        {
+            func(*cubic);
+        }
+        else if (auto *wendland = dynamic_cast<const Wendland::C4Kernel *>(kernel))
+        {
+            func(*wendland);
+        }
+        else if (auto *tabulated = dynamic_cast<const Tabulated *>(kernel))
+        {
+            func(*tabulated);
+        }
+#if DIM == 3
+        else if (auto *aniso = dynamic_cast<const Anisotropic::AnisotropicKernel *>(kernel))
+        {
+            func(*aniso);
+        }
+#endif
+        else
+        {
+            func(*kernel);
+        }
+    }
+
+} // namespace sph
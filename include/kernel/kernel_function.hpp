@@ -38,5 +38,36 @@ namespace sph
         virtual vec_t dw(const vec_t &rij, const real r, const real h) const = 0; // grad W(r,h)
         virtual real dhw(const real r, const real h) const = 0;                   // dW(r,h)/dh
         virtual ~KernelFunction() = default;
+
+        // Batch forms over one particle's contiguous neighbor distances:
+        // out[k] = f(r[k], h) for k < n. One virtual call replaces n of
+        // them, and the concrete kernels override these with omp simd
+        // loops whose normalization is hoisted out, so the density sweep
+        // can actually use the vector units. dw_c_batch produces the
+        // scalar gradient factor c with grad W = rij * c (zero beyond the
+        // support, finite at r = 0).
+        virtual void w_batch(const real *r, const real h, real *out, const int n) const
+        {
+            for (int k = 0; k < n; ++k)
+            {
+                out[k] = w(r[k], h);
+            }
+        }
+        virtual void dhw_batch(const real *r, const real h, real *out, const int n) const
+        {
+            for (int k = 0; k < n; ++k)
+            {
+                out[k] = dhw(r[k], h);
+            }
+        }
+        virtual void dw_c_batch(const real *r, const real h, real *out, const int n) const
+        {
+            vec_t rij(0.0);
+            for (int k = 0; k < n; ++k)
+            {
+                rij[0] = r[k];
+                out[k] = r[k] > 0.0 ? dw(rij, r[k], h)[0] / r[k] : 0.0;
+            }
+        }
     };
 }
\ No newline at end of file
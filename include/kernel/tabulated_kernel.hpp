@@ -0,0 +1,135 @@
+/* ================================
+ * tabulated_kernel.hpp
+ * ================================ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "utilities/defines.hpp"
+#include "kernel_function.hpp"
+#include "utilities/vector_type.hpp"
+
+namespace sph
+{
+
+    /**
+     * @brief Tabulated kernel evaluation (tabulatedKernel config key)
+     *
+     * The polynomial kernels branch per call on the piecewise support and in
+     * newton_raphson every pair additionally needs dhw. Both kernels are
+     * scale-invariant with support r <= h, so W, the gradient factor and
+     * dW/dh reduce to one-dimensional shape functions of q = r/h times a
+     * power of h:
+     *
+     *     W(r,h)      = A(q) / h^kd
+     *     grad W      = rij * C(q) / h^(kd+2)
+     *     dW/dh(r,h)  = D(q) / h^(kd+1)
+     *
+     * The constructor samples the wrapped kernel at h = 1 into three linear-
+     * interpolation tables (1025 entries each, ~24 KB total — sized to stay
+     * L1-resident and shared read-only by all threads). Lookup replaces the
+     * piecewise branches with one clamp and one fused interpolation, which
+     * is what makes the Wendland path profitable; table error at this
+     * resolution is ~1e-6 relative, far below the SPH discretization error.
+     */
+    class Tabulated final : public KernelFunction
+    {
+        static constexpr int table_size = 1024; // intervals; 3*(N+1)*8 B ~ 24 KB
+
+        std::shared_ptr<KernelFunction> m_base; // keeps the sampled kernel alive
+        std::vector<real> m_w;   // A(q)
+        std::vector<real> m_c;   // C(q): grad W = rij * C / h^(kd+2)
+        std::vector<real> m_dhw; // D(q)
+        int m_kd;
+
+        real lookup(const std::vector<real> &table, const real q) const
+        {
+            if (q >= 1.0)
+            {
+                return 0.0;
+            }
+            const real u = q * table_size;
+            const int i = static_cast<int>(u);
+            const real frac = u - i;
+            return table[i] + frac * (table[i + 1] - table[i]);
+        }
+
+    public:
+        Tabulated(std::shared_ptr<KernelFunction> base, const bool is2p5)
+            : m_base(std::move(base)),
+              m_w(table_size + 1),
+              m_c(table_size + 1),
+              m_dhw(table_size + 1),
+              m_kd(kernelDim(is2p5))
+        {
+            // Sample at h = 1, where the h powers drop out. The gradient
+            // factor C(q) comes from dw along one axis: dw((q,0),q,1) =
+            // (q,0) * C(q), so C(q) = dw[0] / q; C(0) is its q->0 limit,
+            // taken from the first interior sample.
+            for (int i = 0; i <= table_size; ++i)
+            {
+                const real q = static_cast<real>(i) / table_size;
+                m_w[i] = m_base->w(q, 1.0);
+                m_dhw[i] = m_base->dhw(q, 1.0);
+                if (i > 0)
+                {
+                    vec_t rij(0.0);
+                    rij[0] = q;
+                    m_c[i] = m_base->dw(rij, q, 1.0)[0] / q;
+                }
+            }
+            m_c[0] = m_c[1];
+        }
+
+        virtual real w(const real r, const real h) const override
+        {
+            return lookup(m_w, r / h) / powh_dim(h, m_kd);
+        }
+
+        virtual vec_t dw(const vec_t &rij, const real r, const real h) const override
+        {
+            const real c = lookup(m_c, r / h) / (powh_dim(h, m_kd) * h * h);
+            return rij * c;
+        }
+
+        virtual real dhw(const real r, const real h) const override
+        {
+            return lookup(m_dhw, r / h) / (powh_dim(h, m_kd) * h);
+        }
+
+        // Batch forms. The table reads are gathers, so these do not carry an
+        // omp simd pragma; the win over the scalar interface is one virtual
+        // call per neighbor list and the h powers hoisted out of the loop.
+        virtual void w_batch(const real *r, const real h, real *out, const int n) const override
+        {
+            const real norm = 1.0 / powh_dim(h, m_kd);
+            const real h_inv = 1.0 / h;
+            for (int k = 0; k < n; ++k)
+            {
+                out[k] = norm * lookup(m_w, r[k] * h_inv);
+            }
+        }
+
+        virtual void dhw_batch(const real *r, const real h, real *out, const int n) const override
+        {
+            const real norm = 1.0 / (powh_dim(h, m_kd) * h);
+            const real h_inv = 1.0 / h;
+            for (int k = 0; k < n; ++k)
+            {
+                out[k] = norm * lookup(m_dhw, r[k] * h_inv);
+            }
+        }
+
+        virtual void dw_c_batch(const real *r, const real h, real *out, const int n) const override
+        {
+            const real norm = 1.0 / (powh_dim(h, m_kd) * h * h);
+            const real h_inv = 1.0 / h;
+            for (int k = 0; k < n; ++k)
+            {
+                out[k] = norm * lookup(m_c, r[k] * h_inv);
+            }
+        }
+    };
+
+}
@@ -14,7 +14,7 @@ namespace sph
         // Wendland C4 Kernel (Dehnen & Aly 2012)
         // This kernel is defined for DIM==1, 2, or 3.
         // In 2.5D mode (m_is2p5==true), we use an effective kernel dimension of 2.
-        class C4Kernel : public KernelFunction
+        class C4Kernel final : public KernelFunction
         {
         private:
             // When true, hydrodynamics are computed as if in 2D.
@@ -105,6 +105,74 @@ namespace sph
                        pow5(0.5 * (1.0 - q + std::abs(1.0 - q))) *
                        (3.0 * kd + 15.0 * kd * q + (-56.0 + 17.0 * kd) * q * q - 35.0 * (8.0 + kd) * q * q * q);
             }
+
+            // Batch forms. The pow5/pow6(max(0, 1-q)) factor is already zero
+            // beyond the support, so the early-return branches of the scalar
+            // versions disappear and the loops are branch-free; sigma and the
+            // h powers are hoisted out.
+            virtual void w_batch(const real *r, const real h, real *out, const int n) const override
+            {
+                const int kd = kernelDim(m_is2p5);
+                real sigma = 0.0;
+                if (kd == 1)
+                    sigma = 27.0 / 16.0;
+                else if (kd == 2)
+                    sigma = 9.0 / M_PI;
+                else
+                    sigma = 495.0 / (32.0 * M_PI);
+                const real norm = sigma / powh_dim(h, kd);
+                const real h_inv = 1.0 / h;
+#pragma omp simd
+                for (int k = 0; k < n; ++k)
+                {
+                    const real q = r[k] * h_inv;
+                    out[k] = norm * pow6(0.5 * (1.0 - q + std::abs(1.0 - q))) *
+                             (1.0 + 6.0 * q + (35.0 / 3.0) * q * q);
+                }
+            }
+
+            virtual void dhw_batch(const real *r, const real h, real *out, const int n) const override
+            {
+                const int kd = kernelDim(m_is2p5);
+                real sigma = 0.0;
+                if (kd == 1)
+                    sigma = 27.0 / 16.0;
+                else if (kd == 2)
+                    sigma = 9.0 / M_PI;
+                else
+                    sigma = 495.0 / (32.0 * M_PI);
+                const real norm = -sigma / (powh_dim(h, kd) * h * 3.0);
+                const real h_inv = 1.0 / h;
+#pragma omp simd
+                for (int k = 0; k < n; ++k)
+                {
+                    const real q = r[k] * h_inv;
+                    out[k] = norm * pow5(0.5 * (1.0 - q + std::abs(1.0 - q))) *
+                             (3.0 * kd + 15.0 * kd * q + (-56.0 + 17.0 * kd) * q * q - 35.0 * (8.0 + kd) * q * q * q);
+                }
+            }
+
+            virtual void dw_c_batch(const real *r, const real h, real *out, const int n) const override
+            {
+                const int kd = kernelDim(m_is2p5);
+                real sigma = 0.0;
+                if (kd == 1)
+                    sigma = 27.0 / 16.0;
+                else if (kd == 2)
+                    sigma = 9.0 / M_PI;
+                else
+                    sigma = 495.0 / (32.0 * M_PI);
+                const real norm = -56.0 / 3.0 * sigma / (powh_dim(h, kd) * h * h);
+                const real h_inv = 1.0 / h;
+#pragma omp simd
+                for (int k = 0; k < n; ++k)
+                {
+                    const real q = r[k] * h_inv;
+                    // c stays finite at r = 0 (no 1/r here), and rij * c
+                    // vanishes there, matching the scalar dw() special case
+                    out[k] = norm * pow5(0.5 * (1.0 - q + std::abs(1.0 - q))) * (1.0 + 5.0 * q);
+                }
+            }
         };
 
     } // namespace Wendland
@@ -2,12 +2,26 @@
 
 #include "modules/module.hpp"
 #include "utilities/vector_type.hpp"
+#include "core/particle_soa.hpp"
+#include "utilities/pair_accumulator.hpp"
+#include "utilities/openmp.hpp"
 
 namespace sph
 {
 class SPHParticle;
 class Periodic;
 
+// Per-pair geometry computed once at the top of the pair body and shared by
+// the pressure, viscosity, and conductivity terms, so none of them repeats
+// the distance/velocity-difference work (the overloads below read it).
+struct PairGeometry {
+    vec_t r_ij;
+    real  r;
+    real  r_inv;
+    vec_t v_ij;
+    real  vr; // inner_product(v_ij, r_ij)
+};
+
 class FluidForce : public Module {
 protected:
     int  m_neighbor_number;
@@ -15,9 +29,45 @@ protected:
     real m_alpha_ac;
     bool m_use_gravity;
 
+    // symmetrized pair loop (symmetrizeFluidForce): evaluate each i-j pair
+    // once and scatter the reaction through per-thread buffers
+    bool m_symmetrize;
+    PairAccumulator m_pair_accum;
+
+    // CFL coefficients for the fused timestep reduction: the force and
+    // energy criteria are reduced in the tail of the sweep (per-thread
+    // minima merged once) so TimeStep skips its own pass over N particles.
+    real m_c_force;
+    real m_c_ene;
+    void reduce_dt_candidates(const SPHParticle & p_i, omp_accum & dt_force, omp_accum & dt_ene) const;
+
     real artificial_viscosity(const SPHParticle & p_i, const SPHParticle & p_j, const vec_t & r_ij);
     real artificial_conductivity(const SPHParticle & p_i, const SPHParticle & p_j, const vec_t & r_ij, const vec_t & dw_ij);
 
+    // SoA variants used by the hot per-pair loops
+    real artificial_viscosity(const ParticleSoA & soa, const int i, const int j, const vec_t & r_ij);
+    real artificial_conductivity(const ParticleSoA & soa, const int i, const int j, const vec_t & r_ij, const vec_t & dw_ij);
+
+    // Cached-geometry variants: no sqrt or v_ij recomputation per term
+    real artificial_viscosity(const ParticleSoA & soa, const int i, const int j, const PairGeometry & geom);
+    real artificial_conductivity(const ParticleSoA & soa, const int i, const int j, const PairGeometry & geom, const vec_t & dw_ij);
+
+    // Pair loop templated over the concrete kernel type (see kernel_dispatch)
+    // and over the conductivity flag, so the per-pair body carries no dead
+    // branch when AC is off. m_use_ac is fixed at initialize(), so the
+    // instantiation is picked once per calculation() call.
+    template <bool UseAC, class Kernel>
+    void calculation_impl(std::shared_ptr<Simulation> sim, const Kernel & kernel);
+
+    // Pair-once variant used when m_symmetrize is set
+    template <bool UseAC, class Kernel>
+    void calculation_symmetric_impl(std::shared_ptr<Simulation> sim, const Kernel & kernel);
+
+    // Gather loop streaming the precomputed PairList geometry (pairList
+    // config key); no kernel evaluations left in the pair body.
+    template <bool UseAC>
+    void calculation_pairs_impl(std::shared_ptr<Simulation> sim);
+
 public:
     virtual void initialize(std::shared_ptr<SPHParameters> param) override;
     virtual void calculation(std::shared_ptr<Simulation> sim) override;
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <vector>
 #include "modules/module.hpp"
 #include "utilities/vector_type.hpp"
+#include "utilities/external_potential.hpp"
 
 namespace sph
 {
@@ -11,11 +13,78 @@ namespace sph
     {
         bool m_is_valid;
         real m_constant;
+        bool m_dual_tree = false; // see SPHParameters::Gravity::dual_tree
+
+        // Closed-form background field; runs even when the tree walk is off
+        ExternalPotential m_external;
+
+        // Side buffers for the task-parallel split (taskParallel config
+        // key): the tree walk deposits here instead of into the particles
+        std::vector<vec_t> m_staged_acc;
+        std::vector<real> m_staged_phi;
+
+        // Multi-rate mode (gravityInterval config key): the last two full
+        // self-gravity solves, held or linearly extrapolated on the steps
+        // in between (see full_solve_due / apply_held_gravity).
+        int m_interval = 1;
+        bool m_extrapolate = true;
+        int m_steps_since_full = 0;
+        int m_slope_steps = 1; // step span between the last two full solves
+        bool m_last_valid = false;
+        bool m_prev_valid = false;
+        std::vector<vec_t> m_last_acc;
+        std::vector<vec_t> m_prev_acc;
+        std::vector<real> m_last_phi;
+
+        /// Save the self-gravity acc/phi of a completed full solve (called
+        /// before the external contributions are added on top).
+        void capture_full_solve(std::shared_ptr<Simulation> sim);
+        /// Re-apply the saved solve on an in-between step.
+        void apply_held_gravity(std::shared_ptr<Simulation> sim);
 
     public:
         void initialize(std::shared_ptr<SPHParameters> param) override;
         void calculation(std::shared_ptr<Simulation> sim) override;
         void apply_self_gravity(std::shared_ptr<Simulation> sim);     // Using BHTree
         void apply_external_gravity(std::shared_ptr<Simulation> sim); // Direct summation for point masses
+
+        /// True when calculation() runs the Barnes-Hut walk (the part worth
+        /// overlapping with the fluid force).
+        bool uses_self_gravity() const { return m_is_valid; }
+        /// The dual-tree group walk writes particles directly, so the
+        /// task-parallel split falls back to sequential when it is on.
+        bool uses_dual_tree() const { return m_dual_tree; }
+
+        /// True when this step runs the full Barnes-Hut solve: always in
+        /// single-rate mode, and in multi-rate mode when the cadence trips
+        /// or the saved solve no longer matches the particle slots.
+        bool full_solve_due(const int particle_num) const
+        {
+            if (m_interval <= 1 || !m_last_valid)
+            {
+                return true;
+            }
+            if (static_cast<int>(m_last_acc.size()) != particle_num)
+            {
+                return true; // refinement/culling/ghosts changed the slots
+            }
+            return m_steps_since_full + 1 >= m_interval;
+        }
+
+        /// The saved solves are indexed by particle slot; a reorder pass
+        /// permutes the slots, so the next step must solve in full.
+        void invalidate_history()
+        {
+            m_last_valid = false;
+            m_prev_valid = false;
+        }
+
+        // Task-parallel split of calculation(): stage_self_gravity() walks
+        // the tree into the side buffers and touches no particle state, so
+        // it can run concurrently with the fluid-force sweep (which owns
+        // acc/dene); commit_staged() then applies the buffers and the
+        // external contributions, reproducing calculation()'s result.
+        void stage_self_gravity(std::shared_ptr<Simulation> sim);
+        void commit_staged(std::shared_ptr<Simulation> sim);
     };
 }
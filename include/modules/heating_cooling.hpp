@@ -15,8 +15,15 @@ namespace sph
         void calculation(std::shared_ptr<Simulation> sim) override;
 
     private:
+        // Advance one particle's internal energy over dt with sub-cycled
+        // backward-Euler inner steps (see calculation()).
+        real integrate_subcycled(real u, const real dt) const;
+
         bool m_is_valid = false;
         real m_heating_rate = 0.0;
         real m_cooling_rate = 0.0;
+        bool m_subcycle = false;
+        real m_subcycle_tol = 0.1;
+        int m_max_subcycles = 64;
     };
 }
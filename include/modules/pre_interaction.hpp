@@ -27,10 +27,26 @@ namespace sph
         bool m_anisotropic = false;
         real m_hz;
 
+        // Warm-started smoothing-length iteration (warmStartSml): predictions
+        // become valid once a full sweep has stored every particle's h_dot.
+        bool m_warm_start;
+        bool m_warm_primed;
+
+        // Main sweep templated over the 2.5D, AV-switch and warm-start flags:
+        // all are fixed at initialize(), so the chosen instantiation carries
+        // no dead div/curl work and no per-particle effective-dimension
+        // branches in the neighbor loop (see calculation()).
+        template <bool TwoAndHalf, bool UseBalsara, bool UseTimeDependentAV, bool WarmStart>
+        void calculation_impl(std::shared_ptr<Simulation> sim);
+
+        // Resolves the AV/warm-start flags for one 2.5D instantiation.
+        template <bool TwoAndHalf>
+        void calculation_dispatch(std::shared_ptr<Simulation> sim);
+
         virtual real newton_raphson(
             const SPHParticle &p_i,
             const std::vector<SPHParticle> &particles,
-            const std::vector<int> &neighbor_list,
+            const int *neighbor_list,
             const int n_neighbor,
             const Periodic *periodic,
             const KernelFunction *kernel);
@@ -11,6 +11,25 @@ namespace sph
         real c_force; // dt_f = c_force * sqrt(h / a)
         real c_ene;
 
+        bool m_use_block; // block (hierarchical) timestep bins
+        int  m_max_bins;
+        int  m_substep;   // position inside the current bin cycle
+
+        // dt controller: growth is rate-limited against the previous step
+        // (shrink always follows the raw CFL value), and the standalone
+        // reduction is amortized — run every m_reduction_interval steps with
+        // a safety margin on the held minima in between. Steps where the
+        // force sweep published fused minima reset nothing; they are free.
+        real m_growth_limit;
+        int  m_reduction_interval;
+        real m_stale_safety;
+        real m_dt_prev;           // dt selected at the previous step
+        int  m_steps_since_full;  // standalone reductions skipped so far
+        accum_t m_held_dt_force;  // minima from the last full reduction
+        accum_t m_held_dt_ene;
+
+        void assign_bins(std::shared_ptr<Simulation> sim, const real dt);
+
     public:
         void initialize(std::shared_ptr<SPHParameters> param) override;
         void calculation(std::shared_ptr<Simulation> sim) override;
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utilities/snapshot_metadata.hpp"
+
+namespace sph
+{
+
+    /**
+     * @brief Memory-mapped reader library for the columnar snapshot formats
+     *
+     * Downstream viewers and workflow post-steps used to re-implement ad-hoc
+     * parsers for the files written by src/core/output_format.cpp. This
+     * library (static target sph_reader, no dependency on sph_lib) maps a
+     * .sphc snapshot or a .sphar container and hands out typed views
+     * straight into the mapping: reading one column touches only that
+     * column's pages, so extracting a field from a multi-gigabyte file
+     * never copies the rest. The format can evolve behind this API — tools
+     * stop depending on byte offsets.
+     *
+     * Lifetime: a SnapshotView shares ownership of its mapping, so views
+     * stay valid after the reader that produced them is destroyed.
+     */
+
+    /// One column of a mapped snapshot: a typed pointer into the file.
+    struct SnapshotColumn
+    {
+        enum DType : std::uint32_t
+        {
+            FLOAT64 = 0,
+            INT32 = 1,
+        };
+
+        std::string name;
+        DType dtype;
+        const char *data;   // first element, in the mapping
+        std::uint64_t bytes;
+    };
+
+    namespace detail
+    {
+        /// Read-only mmap of a whole file; unmapped when the last view dies.
+        class MappedSnapshotFile;
+    }
+
+    /// Immutable view of one columnar snapshot (a .sphc file or a container
+    /// frame payload — the layouts are byte-identical).
+    class SnapshotView
+    {
+    public:
+        int dimension() const { return m_dimension; }
+        int particle_count() const { return m_particle_count; }
+        double time() const { return m_time; }
+
+        double length_factor() const { return m_length_factor; }
+        double time_factor() const { return m_time_factor; }
+        double mass_factor() const { return m_mass_factor; }
+        const std::string &length_unit() const { return m_length_unit; }
+        const std::string &time_unit() const { return m_time_unit; }
+        const std::string &mass_unit() const { return m_mass_unit; }
+
+        const std::vector<SnapshotColumn> &columns() const { return m_columns; }
+        bool has_column(const std::string &name) const;
+
+        /// Typed column views; throw std::runtime_error when the column is
+        /// missing or has the other dtype. The length is particle_count().
+        const double *float64(const std::string &name) const;
+        const std::int32_t *int32(const std::string &name) const;
+
+        /// Header and column catalogue as the sidecar-JSON metadata struct.
+        SnapshotMetadata metadata() const;
+
+    private:
+        friend class SnapshotReader;
+        friend class ContainerReader;
+
+        /// Parse a columnar image at [base, base + size); keep_alive holds
+        /// the mapping the pointers lean on.
+        static SnapshotView parse(const char *base, std::uint64_t size,
+                                  std::shared_ptr<detail::MappedSnapshotFile> keep_alive,
+                                  const std::string &context);
+
+        const SnapshotColumn *find(const std::string &name) const;
+
+        int m_dimension = 0;
+        int m_particle_count = 0;
+        double m_time = 0.0;
+        double m_length_factor = 1.0;
+        double m_time_factor = 1.0;
+        double m_mass_factor = 1.0;
+        std::string m_length_unit;
+        std::string m_time_unit;
+        std::string m_mass_unit;
+        std::vector<SnapshotColumn> m_columns;
+        std::shared_ptr<detail::MappedSnapshotFile> m_map;
+    };
+
+    /// Maps one .sphc snapshot file.
+    class SnapshotReader
+    {
+    public:
+        /// Throws std::runtime_error on open, map or format errors.
+        explicit SnapshotReader(const std::string &path);
+
+        const SnapshotView &view() const { return m_view; }
+
+    private:
+        SnapshotView m_view;
+    };
+
+    /// Maps a .sphar append-store container and indexes its frames from the
+    /// self-delimiting frame headers (no sidecar needed).
+    class ContainerReader
+    {
+    public:
+        /// Throws std::runtime_error on open, map or format errors.
+        explicit ContainerReader(const std::string &path);
+
+        int frame_count() const { return static_cast<int>(m_frames.size()); }
+        double frame_time(const int frame) const { return m_frames.at(frame).time; }
+        int frame_particles(const int frame) const { return m_frames.at(frame).particles; }
+
+        /// View of one frame's columnar payload.
+        SnapshotView frame(const int frame) const;
+
+        /// Index of the frame whose time is closest to t.
+        int frame_at(const double t) const;
+
+    private:
+        struct FrameInfo
+        {
+            std::uint64_t payload_offset;
+            std::uint64_t payload_size;
+            double time;
+            int particles;
+        };
+
+        std::string m_path;
+        std::vector<FrameInfo> m_frames;
+        std::shared_ptr<detail::MappedSnapshotFile> m_map;
+    };
+
+}
@@ -7,7 +7,9 @@
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
 #include "utilities/defines.hpp"
+#include "utilities/mapped_arena.hpp"
 
 namespace sph
 {
@@ -121,5 +123,129 @@ namespace sph
             const real eps = 1e-5;
             return (get_theta(xi + eps) - get_theta(xi - eps)) / (2 * eps);
         }
+
+        // ---- Uniform spline table -------------------------------------------
+        //
+        // The CSV table above needs a bracket search per lookup and the
+        // relaxation force evaluates θ and dθ/dξ for every particle every
+        // step. build_spline_table() resamples the table onto a uniform grid
+        // in ξ and stores per-segment cubic Hermite coefficients in a binary
+        // sidecar file that is memory-mapped at startup (and reused verbatim
+        // on later runs with the same table). Lookups are then O(1):
+        // a branchless clamp, one index computation and a polynomial.
+        //
+        // Outside the tabulated range the clamped end segment is evaluated,
+        // i.e. constant-slope extrapolation at the edges rather than the CSV
+        // path's first/last-segment extrapolation.
+
+        struct SplineHeader
+        {
+            std::uint64_t magic;
+            std::int64_t segments;
+            real xi0;
+            real dx;
+        };
+        static constexpr std::uint64_t spline_magic = 0x314C454D41444E45ULL; // "ENDAMEL1"
+
+        int spline_n = 0; // number of segments; 0 = spline not built
+        real spline_xi0 = 0.0;
+        real spline_dx = 0.0;
+        real spline_inv_dx = 0.0;
+        const real *spline_c0 = nullptr; // per-segment coefficients of
+        const real *spline_c1 = nullptr; // θ(t) = c0 + t (c1 + t (c2 + t c3)),
+        const real *spline_c2 = nullptr; // t = (ξ - ξ_j) / dx in [0, 1)
+        const real *spline_c3 = nullptr;
+        MappedArena spline_arena;
+
+        void build_spline_table(const std::string &cache_file, const int segments = 1024)
+        {
+            if (!loaded || xi_table.size() < 2)
+                return;
+
+            const real xi0 = xi_table.front();
+            const real dx = (xi_table.back() - xi0) / segments;
+
+            constexpr std::size_t align = 64;
+            const std::size_t bytes =
+                sizeof(SplineHeader) + align + 4 * (segments * sizeof(real) + align);
+            spline_arena.map(cache_file, bytes);
+
+            auto *header = static_cast<SplineHeader *>(spline_arena.alloc(sizeof(SplineHeader), align));
+            real *c0 = static_cast<real *>(spline_arena.alloc(segments * sizeof(real), align));
+            real *c1 = static_cast<real *>(spline_arena.alloc(segments * sizeof(real), align));
+            real *c2 = static_cast<real *>(spline_arena.alloc(segments * sizeof(real), align));
+            real *c3 = static_cast<real *>(spline_arena.alloc(segments * sizeof(real), align));
+
+            const bool cache_hit = header->magic == spline_magic &&
+                                   header->segments == segments &&
+                                   header->xi0 == xi0 && header->dx == dx;
+            if (!cache_hit)
+            {
+                // Hermite segments: values from the CSV table, slopes from
+                // centered differences of the sampled values (one-sided at
+                // the ends), all in units of t so evaluation needs no dx.
+                std::vector<real> value(segments + 1), slope(segments + 1);
+                for (int j = 0; j <= segments; ++j)
+                {
+                    value[j] = get_theta(xi0 + j * dx);
+                }
+                slope[0] = value[1] - value[0];
+                slope[segments] = value[segments] - value[segments - 1];
+                for (int j = 1; j < segments; ++j)
+                {
+                    slope[j] = 0.5 * (value[j + 1] - value[j - 1]);
+                }
+                for (int j = 0; j < segments; ++j)
+                {
+                    const real d = value[j + 1] - value[j];
+                    c0[j] = value[j];
+                    c1[j] = slope[j];
+                    c2[j] = 3.0 * d - 2.0 * slope[j] - slope[j + 1];
+                    c3[j] = -2.0 * d + slope[j] + slope[j + 1];
+                }
+                header->magic = spline_magic;
+                header->segments = segments;
+                header->xi0 = xi0;
+                header->dx = dx;
+            }
+
+            spline_n = segments;
+            spline_xi0 = xi0;
+            spline_dx = dx;
+            spline_inv_dx = 1.0 / dx;
+            spline_c0 = c0;
+            spline_c1 = c1;
+            spline_c2 = c2;
+            spline_c3 = c3;
+            std::cout << "LaneEmdenData: uniform spline table (" << segments
+                      << " segments, " << (cache_hit ? "mapped from " : "built into ")
+                      << cache_file << ")" << std::endl;
+        }
+
+        // θ(ξ) from the spline table; falls back to the CSV path while the
+        // table is not built. min/max clamping compiles to branch-free
+        // min/max instructions, so the hot path has no data-dependent branch.
+        real get_theta_fast(const real xi) const
+        {
+            if (spline_n == 0)
+                return get_theta(xi);
+            const real s = std::min(std::max((xi - spline_xi0) * spline_inv_dx, (real)0.0),
+                                    (real)spline_n - (real)1e-9);
+            const int j = static_cast<int>(s);
+            const real t = s - j;
+            return spline_c0[j] + t * (spline_c1[j] + t * (spline_c2[j] + t * spline_c3[j]));
+        }
+
+        // dθ/dξ from the same segment (analytic derivative of the cubic).
+        real dtheta_dxi_fast(const real xi) const
+        {
+            if (spline_n == 0)
+                return dtheta_dxi(xi);
+            const real s = std::min(std::max((xi - spline_xi0) * spline_inv_dx, (real)0.0),
+                                    (real)spline_n - (real)1e-9);
+            const int j = static_cast<int>(s);
+            const real t = s - j;
+            return (spline_c1[j] + t * (2.0 * spline_c2[j] + t * 3.0 * spline_c3[j])) * spline_inv_dx;
+        }
     };
 }
@@ -15,12 +15,41 @@ namespace sph
         void load_table(const std::string &filename)
         {
             m_data.load_csv(filename);
+            // Resample onto the uniform spline grid; the binary coefficient
+            // sidecar next to the CSV is memory-mapped and reused on later
+            // runs with the same table.
+            m_data.build_spline_table(filename + ".spline.bin");
         }
 
         void add_relaxation_force(std::shared_ptr<Simulation> sim,
                                   const SPHParameters &params) override;
 
+        // The relaxation acceleration depends only on positions, which do not
+        // move between predict() and correct(); the solver invalidates the
+        // per-particle cache once per step (after the drift) and the second
+        // call reuses it.
+        void invalidate_force_cache() { m_force_cache_valid = false; }
+
+        // Residual-driven convergence control: called once per step (from
+        // predict) while the relaxation is active. Computes the relative L2
+        // residual of dens - target_rho, anneals the velocity damping with a
+        // bold-driver rule (grow the step while the residual falls, halve it
+        // on an increase), and flips to converged once the residual drops
+        // below the tolerance or max_iterations full sweeps have run.
+        void begin_iteration(std::shared_ptr<Simulation> sim, const SPHParameters &params);
+        bool converged() const { return m_converged; }
+
     private:
         vec_t compute_relaxation_force(const SPHParticle &p, const SPHParameters &params);
+        real density_residual(std::shared_ptr<Simulation> sim) const;
+
+        std::vector<vec_t> m_force_cache;
+        bool m_force_cache_valid = false;
+
+        // Convergence / annealing state (see begin_iteration)
+        int m_iteration = 0;
+        bool m_converged = false;
+        real m_damping = 0.0; // 0 = not yet seeded from params.damping_factor
+        real m_prev_residual = -1.0;
     };
 }
\ No newline at end of file
@@ -3,8 +3,10 @@
 #include <memory>
 #include <vector>
 #include <algorithm>
+#include <utility>
 #include "utilities/vector_type.hpp"
 #include "core/particle.hpp"
+#include "tree/neighbor_searcher.hpp"
 
 namespace sph
 {
@@ -15,13 +17,67 @@ namespace sph
     constexpr int NCHILD = DIM == 1 ? 2 : DIM == 2 ? 4
                                                    : 8;
 
-    class BHTree
+    // packed upper triangle of the symmetric quadrupole tensor
+    constexpr int NQUAD = DIM * (DIM + 1) / 2;
+
+    // Flattened entries of a per-particle gravity interaction list: the tree
+    // walk in tree_force() only collects accepted nodes and leaf particles
+    // here, and the actual force kernels run afterwards in tight loops over
+    // these arrays (see BHTree::tree_force).
+    struct NodeInteraction
+    {
+        vec_t d; // particle position minus node mass center
+        real mass;
+        real quad[NQUAD];
+    };
+
+    struct PointInteraction
+    {
+        vec_t r_ij;
+        real mass;
+        real sml;
+    };
+
+    // Group-walk variants: one interaction list is built per leaf cell and
+    // shared by every particle in it, so the entries keep absolute positions
+    // and the per-particle separations are formed in the evaluation loop.
+    struct GroupNodeInteraction
+    {
+        vec_t m_center; // node mass center
+        real mass;
+        real quad[NQUAD];
+    };
+
+    struct GroupPointInteraction
+    {
+        vec_t pos;
+        real mass;
+        real sml;
+    };
+
+    // Pointers into the walk cache (see BHTree::m_walk_*): the fields the
+    // distance tests and force accumulations read, copied into permutation
+    // order so a leaf's candidates are one small contiguous block instead of
+    // full-record strides across the particle array.
+    struct LeafCache
+    {
+        const vec_t *pos;
+        const real *sml;
+        const real *mass;
+        const int *id;
+    };
+
+    class BHTree : public NeighborSearcher
     {
     public:
         class BHNode
         {
         public:
-            SPHParticle *first;
+            // Leaf particles are the [begin, end) slice of the tree's
+            // permutation array (see BHTree::m_perm); interior nodes keep the
+            // covering range so a subtree build partitions its slice in place.
+            int begin;
+            int end;
             real mass;
             int num;
             BHNode *childs[NCHILD];
@@ -30,6 +86,7 @@ namespace sph
             real edge;
             int level;
             real kernel_size;
+            real quad[NQUAD]; // quadrupole moments about m_center (see set_quadrupole)
             bool is_leaf;
             // New anisotropic members:
             bool anisotropic; // if true, use anisotropic softening
@@ -39,7 +96,8 @@ namespace sph
 
             void clear()
             {
-                first = nullptr;
+                begin = 0;
+                end = 0;
                 mass = 0.0;
                 num = 0;
                 std::fill(childs, childs + NCHILD, nullptr);
@@ -48,6 +106,7 @@ namespace sph
                 edge = 0.0;
                 level = 0;
                 kernel_size = 0.0;
+                std::fill(quad, quad + NQUAD, 0.0);
                 is_leaf = false;
                 anisotropic = false;
                 hz = 0.0;
@@ -55,20 +114,25 @@ namespace sph
 
             void root_clear()
             {
-                first = nullptr;
+                begin = 0;
+                end = 0;
                 mass = 0.0;
                 num = 0;
                 m_center = 0.0;
                 kernel_size = 0.0;
+                std::fill(quad, quad + NQUAD, 0.0);
                 is_leaf = false;
                 // anisotropic remains as set
             }
 
-            void create_tree(BHNode *&nodes, int &remaind, const int max_level, const int leaf_particle_num);
-            void assign(SPHParticle *particle, BHNode *&nodes, int &remaind);
-            real set_kernel();
-            void neighbor_search(const SPHParticle &p_i, std::vector<int> &neighbor_list, int &n_neighbor, const bool is_ij, const Periodic *periodic);
-            void calc_force(SPHParticle &p_i, const real theta2, const real g_constant, const Periodic *periodic);
+            void create_tree(BHNode *&nodes, int &remaind, const int max_level, const int leaf_particle_num, const SPHParticle *particles, int *perm, int *scratch);
+            real set_kernel(const LeafCache &cache);
+            void set_quadrupole(const LeafCache &cache);
+            void neighbor_search(const SPHParticle &p_i, std::vector<std::pair<real, int>> &keyed, const int list_size, int &n_neighbor, const bool is_ij, const real margin, const Periodic *periodic, const LeafCache &cache);
+            void calc_force(SPHParticle &p_i, const real theta2, const real g_constant, const Periodic *periodic, const LeafCache &cache);
+            void collect_interactions(const SPHParticle &p_i, const real theta2, const Periodic *periodic, std::vector<NodeInteraction> &node_list, std::vector<PointInteraction> &point_list, const LeafCache &cache) const;
+            void collect_leaves(std::vector<BHNode *> &leaves);
+            void collect_group_interactions(const BHNode &leaf, const real theta2, const Periodic *periodic, std::vector<GroupNodeInteraction> &node_list, std::vector<GroupPointInteraction> &point_list, const LeafCache &cache) const;
         };
 
         int m_max_level;
@@ -79,8 +143,62 @@ namespace sph
         std::shared_ptr<Periodic> m_periodic;
         BHNode m_root;
         std::shared_ptr<BHNode> m_nodes;
-        int m_node_size;
+        int m_node_size = 0;
+
+        // Lazy pool clearing: each build records which prefix of the pool and
+        // of every subtree slice it actually consumed, and the next build
+        // resets only those nodes instead of sweeping the whole pool.
+        struct DirtyRange
+        {
+            int offset;
+            int count;
+        };
+        std::vector<DirtyRange> m_dirty;
+
+        // Spare pool for the post-build layout pass: every build is rewritten
+        // into depth-first traversal order (children adjacent, subtrees
+        // contiguous) so the iterative walks stream through memory. The two
+        // pools ping-pong between builds, each carrying its own dirty ranges.
+        std::shared_ptr<BHNode> m_nodes_alt;
+        std::vector<DirtyRange> m_dirty_alt;
+        void relayout_nodes();
+
+        // Refit mode: between full rebuilds the topology is kept and only the
+        // node mass moments are refreshed bottom-up (see try_refit).
+        bool m_refit_enabled = false;
+        int m_refit_interval = 8;
+        int m_refits_since_build = 0;
+        int m_used_nodes = 0; // pool prefix the layout pass filled, DFS order
+        SPHParticle *m_build_particles = nullptr; // storage the permutation indexes into
+        int m_build_num = 0;
+
+        // Build-time permutation: make() sorts the particle indices so every
+        // node's particles are one contiguous [begin, end) slice, and leaf
+        // iteration is a sequential stream through this array instead of
+        // chasing intrusive per-particle pointers. m_perm_scratch is the
+        // scatter target of the in-place partitioning passes.
+        std::vector<int> m_perm;
+        std::vector<int> m_perm_scratch;
+
+        // Walk cache: pos/sml/mass/id copied into permutation order, so the
+        // leaf loops of the walks stream a few packed arrays instead of
+        // gathering full SPHParticle records. pos/mass/id are refreshed by
+        // make() and try_refit(); sml is refreshed by set_kernel(), which
+        // runs whenever the h-iteration moves the smoothing lengths.
+        std::vector<vec_t> m_walk_pos;
+        std::vector<real> m_walk_sml;
+        std::vector<real> m_walk_mass;
+        std::vector<int> m_walk_id;
+        void refresh_walk_cache();
+        LeafCache leaf_cache() const
+        {
+            return {m_walk_pos.data(), m_walk_sml.data(), m_walk_mass.data(), m_walk_id.data()};
+        }
+        bool try_refit(std::vector<SPHParticle> &particles, const int particle_num);
+
+        real m_search_margin; // Verlet skin added to every neighbor search radius
 
+        bool m_use_gravity;
         real m_g_constant;
         real m_theta;
         real m_theta2;
@@ -89,12 +207,14 @@ namespace sph
         real m_hz;
 
     public:
-        void initialize(std::shared_ptr<SPHParameters> param);
-        void resize(const int particle_num, const int tree_size = 5);
-        void make(std::vector<SPHParticle> &particles, const int particle_num);
-        void set_kernel();
-        int neighbor_search(const SPHParticle &p_i, std::vector<int> &neighbor_list, const std::vector<SPHParticle> &particles, const bool is_ij = false);
-        void tree_force(SPHParticle &p_i);
+        void initialize(std::shared_ptr<SPHParameters> param) override;
+        void resize(const int particle_num, const int tree_size = 5) override;
+        void make(std::vector<SPHParticle> &particles, const int particle_num) override;
+        void set_kernel() override;
+        void set_search_margin(const real margin) override { m_search_margin = margin; }
+        int neighbor_search(const SPHParticle &p_i, std::vector<int> &neighbor_list, const std::vector<SPHParticle> &particles, const bool is_ij = false) override;
+        void tree_force(SPHParticle &p_i) override;
+        bool tree_force_group() override;
     };
 
 } // namespace sph
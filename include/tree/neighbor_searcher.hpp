@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "utilities/defines.hpp"
+#include "utilities/event_counters.hpp"
+
+namespace sph
+{
+
+    struct SPHParameters;
+    class SPHParticle;
+
+    /**
+     * @brief Common contract for the neighbor-search engines
+     *
+     * BHTree implements it with an octree (and additionally provides tree
+     * gravity); CellList implements it with a uniform linked-cell grid that
+     * is faster for near-uniform particle distributions. Simulation picks the
+     * engine from the config (useCellList), so every module keeps calling the
+     * same interface through Simulation::get_tree().
+     */
+    class NeighborSearcher
+    {
+    public:
+        virtual ~NeighborSearcher() = default;
+
+        virtual void initialize(std::shared_ptr<SPHParameters> param) = 0;
+        virtual void resize(const int particle_num, const int tree_size = 5) = 0;
+        virtual void make(std::vector<SPHParticle> &particles, const int particle_num) = 0;
+        virtual void set_kernel() = 0;
+        virtual void set_search_margin(const real margin) = 0;
+
+        /// Fill neighbor_list with candidate indices sorted by distance and
+        /// return their count. is_ij widens the radius to max(h_i, h_j) for
+        /// gather-scatter loops.
+        virtual int neighbor_search(const SPHParticle &p_i, std::vector<int> &neighbor_list, const std::vector<SPHParticle> &particles, const bool is_ij = false) = 0;
+
+        /// Overflow-safe wrapper around neighbor_search(): the walk truncates
+        /// silently once the list is full, so a full list is treated as a
+        /// possible overflow — the buffer is doubled and the search redone
+        /// until the result fits with room to spare. Growth is rare (the
+        /// callers seed the capacity from last step's neighbor count) and
+        /// shows up in the event counters.
+        int neighbor_search_adaptive(const SPHParticle &p_i, std::vector<int> &neighbor_list, const std::vector<SPHParticle> &particles, const bool is_ij = false)
+        {
+            int n_neighbor = neighbor_search(p_i, neighbor_list, particles, is_ij);
+            while (n_neighbor == static_cast<int>(neighbor_list.size()))
+            {
+                EventCounters::count(EventCounters::NEIGHBOR_LIST_GROWN);
+                neighbor_list.resize(neighbor_list.size() * 2);
+                n_neighbor = neighbor_search(p_i, neighbor_list, particles, is_ij);
+            }
+            return n_neighbor;
+        }
+
+        /// Self-gravity via tree walk; engines without gravity support throw.
+        virtual void tree_force(SPHParticle &p_i) = 0;
+
+        /// Group (dual-tree) self-gravity: walk the tree once per leaf cell,
+        /// share the interaction list between the leaf's particles, and
+        /// handle the full particle loop internally (including the
+        /// acceleration/potential reset). Returns false when the engine or
+        /// mode has no group walk, in which case the caller falls back to
+        /// per-particle tree_force().
+        virtual bool tree_force_group() { return false; }
+    };
+
+}
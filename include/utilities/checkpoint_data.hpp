@@ -21,7 +21,7 @@ namespace sph {
  * Offset | Size | Field | Description
  * -------|------|-------|-------------
  * 0      | 8    | magic | "SPHCHKPT" (magic number for file type identification)
- * 8      | 4    | version | uint32_t format version (current: 1)
+ * 8      | 4    | version | uint32_t format version (current: 3)
  * 12     | 4    | dimension | int32_t (1, 2, or 3)
  * 16     | 64   | timestamp | ISO 8601 string (YYYY-MM-DDTHH:MM:SS.sssZ)
  * 80     | 128  | simulation_name | null-terminated string
@@ -38,23 +38,196 @@ namespace sph {
  * JSON-encoded SPHParameters object
  * Size determined by params_size field in header
  * 
- * [PARTICLE DATA: N × sizeof(SPHParticle)]
+ * [PARTICLE DATA: N × sizeof(CompactCheckpointParticle)]
  * --------------------------------
- * Binary dump of particle array
- * Each particle is serialized as a fixed-size struct
- * Size = particle_count × sizeof(SPHParticle)
+ * v5: packed array of CompactCheckpointParticle records carrying only the
+ * true state (pos, vel, mass, dens, ene, sml, alpha, target_rho, id, flags).
+ * Derived quantities (pres, sound, balsara, gradh, neighbor) and the
+ * half-step scratch (vel_p/ene_p) are recomputed or reset on restore, so
+ * dumping them only inflated the file. v4 files (raw SPHParticle dump)
+ * still load.
+ * Size = particle_count × sizeof(CompactCheckpointParticle)
  * 
  * [CHECKSUM: 32 bytes]
  * --------------------------------
- * SHA-256 hash of all preceding data (header + params + particles)
- * Used for data integrity verification
+ * Chunked SHA-256 of all preceding data (header + params + particles):
+ * the data is split into fixed 8 MiB chunks, each chunk is hashed
+ * independently, and the stored value is the SHA-256 of the
+ * concatenated chunk digests. Chunks hash in parallel on both save and
+ * load, which is what bounds checkpoint latency for multi-GB files.
  * 
  * Total File Size:
- * 512 (header) + params_size + (particle_count × sizeof(SPHParticle)) + 32 (checksum)
- * 
- * Example for 10,000 particles:
- * ~512 bytes + ~2 KB + (10,000 × ~200 bytes) + 32 bytes ≈ 2 MB
+ * 512 (header) + params_size + (particle_count × sizeof(CompactCheckpointParticle)) + 32 (checksum)
+ *
+ * Example for 10,000 particles at DIM=2:
+ * ~512 bytes + ~2 KB + (10,000 × 88 bytes) + 32 bytes ≈ 0.9 MB
+ *
+ * Delta Checkpoint Format ("SPHCHKDL"):
+ * =====================================
+ * Between full keyframes the manager can write delta checkpoints that
+ * store only the per-particle fields that changed beyond a relative
+ * tolerance since the keyframe. Same 512-byte header layout with these
+ * differences:
+ *
+ * Offset | Size | Field | Description
+ * -------|------|-------|-------------
+ * 0      | 8    | magic | "SPHCHKDL"
+ * 8      | 4    | version | uint32_t delta format version (current: 1)
+ * 80     | 128  | keyframe | keyframe file name (resolved against the
+ *        |      |          | delta file's own directory on load)
+ * 304    | 8    | field_count | int64_t entries in the field table
+ * 312    | 8    | tolerance | double relative tolerance used when encoding
+ *
+ * The body holds one block per particle field, in the manager's fixed
+ * field-table order: an int64_t override count followed by that many
+ * { int32_t particle index, raw field bytes } records. No parameters
+ * section — restore takes it from the keyframe. A SHA-256 checksum over
+ * everything preceding it closes the file, as in the full format.
+ * Loading a delta transparently loads its keyframe first and replays the
+ * overrides on top of it.
+ */
+/**
+ * @brief On-disk particle record of the v5 checkpoint format
+ *
+ * Only the true state: everything else either is derived (recomputed by
+ * the pre-interaction pass on restore) or half-step scratch overwritten
+ * by the next predict. Field
+ * order keeps the struct free of padding holes for every DIM, so the
+ * packed array checksums deterministically.
+ */
+struct CompactCheckpointParticle {
+    real pos[DIM];
+    real vel[DIM];
+    real mass;
+    real dens;        ///< kept so snapshots written before the first
+                      ///< pre-interaction pass (IC cache hits) stay faithful
+    real ene;
+    real sml;
+    real alpha;       ///< time-dependent AV coefficient (true state)
+    real target_rho;  ///< density-relaxation target (not recomputable)
+    int32_t id;
+    uint8_t is_point_mass;
+    uint8_t is_wall;
+    uint8_t is_active;
+    uint8_t reserved;
+
+    void pack(const SPHParticle& p) {
+        for (int d = 0; d < DIM; ++d) {
+            pos[d] = p.pos[d];
+            vel[d] = p.vel[d];
+        }
+        mass = p.mass;
+        dens = p.dens;
+        ene = p.ene;
+        sml = p.sml;
+        alpha = p.alpha;
+        target_rho = p.target_rho;
+        id = static_cast<int32_t>(p.id);
+        is_point_mass = p.is_point_mass ? 1 : 0;
+        is_wall = p.is_wall ? 1 : 0;
+        is_active = p.is_active ? 1 : 0;
+        reserved = 0;
+    }
+
+    /// Expand onto a default-constructed particle; derived fields keep
+    /// their defaults until the pre-interaction pass recomputes them.
+    void unpack(SPHParticle& p) const {
+        for (int d = 0; d < DIM; ++d) {
+            p.pos[d] = pos[d];
+            p.vel[d] = vel[d];
+        }
+        p.mass = mass;
+        p.dens = dens;
+        p.ene = ene;
+        p.sml = sml;
+        p.alpha = alpha;
+        p.target_rho = target_rho;
+        p.id = id;
+        p.is_point_mass = is_point_mass != 0;
+        p.is_wall = is_wall != 0;
+        p.is_active = is_active != 0;
+    }
+};
+
+/**
+ * @brief Per-particle derived fields of the optional warm-restart section
+ *
+ * Everything the restore-time pre-interaction pass would recompute from the
+ * true state: EOS outputs, the AV switch, grad-h terms, the DISPH volume
+ * element and the per-particle Courant value, plus the neighbor count and
+ * the warm-start dh/dt. Field order keeps the struct padding-free.
  */
+struct DerivedParticleRecord {
+    real pres;
+    real sound;
+    real balsara;
+    real gradh;
+    real volume;
+    real q;
+    real h_per_v_sig;
+    real h_dot;
+    int32_t neighbor;
+    int32_t reserved;
+
+    void pack(const SPHParticle& p) {
+        pres = p.pres;
+        sound = p.sound;
+        balsara = p.balsara;
+        gradh = p.gradh;
+        volume = p.volume;
+        q = p.q;
+        h_per_v_sig = p.h_per_v_sig;
+        h_dot = p.h_dot;
+        neighbor = static_cast<int32_t>(p.neighbor);
+        reserved = 0;
+    }
+
+    void unpack(SPHParticle& p) const {
+        p.pres = pres;
+        p.sound = sound;
+        p.balsara = balsara;
+        p.gradh = gradh;
+        p.volume = volume;
+        p.q = q;
+        p.h_per_v_sig = h_per_v_sig;
+        p.h_dot = h_dot;
+        p.neighbor = neighbor;
+    }
+};
+
+/**
+ * @brief Optional derived-state section of a checkpoint ("SPHDERIV")
+ *
+ * Appended after the particle records — its byte size sits in the header's
+ * reserved space at offset 312, zero in older files — and covered by the
+ * trailing checksum. Carries what Solver::restore_from_checkpoint otherwise
+ * recomputes with a full tree + pre-interaction pass before the first step:
+ * the per-particle derived fields above, the global h/v_sig minimum, the
+ * neighbor-list CSR cache and the named additional scalar/vector arrays
+ * (e.g. the GSPH MUSCL gradients). A restore falls back to the recompute
+ * whenever the section is absent, version-mismatched or inconsistent with
+ * the particle count.
+ *
+ * Body layout (packed, native endianness like the rest of the format):
+ *   magic "SPHDERIV" (8) | uint32 version | uint32 flags (bit 0 =
+ *   neighbor cache present) | double h_per_v_sig | int64 particle_count |
+ *   DerivedParticleRecord[particle_count] |
+ *   [int64 offset_count, int32 offsets[], int64 index_count, int32
+ *   indices[] when bit 0] | int32 scalar_array_count, then per array
+ *   uint32 name_len, name bytes, int64 value_count, real values[] |
+ *   int32 vector_array_count, same layout with DIM reals per entry.
+ */
+struct DerivedState {
+    bool present = false;
+    real h_per_v_sig = 0.0;
+    std::vector<DerivedParticleRecord> records;
+    bool has_neighbor_cache = false;
+    std::vector<int> nb_offsets;  ///< CSR offsets, size particle_count + 1
+    std::vector<int> nb_indices;  ///< concatenated neighbor lists
+    std::vector<std::pair<std::string, std::vector<real>>> scalar_arrays;
+    std::vector<std::pair<std::string, std::vector<real>>> vector_arrays; ///< DIM reals per entry
+};
+
 struct CheckpointData {
     // Simulation state
     real time;          ///< Current simulation time
@@ -74,12 +247,35 @@ struct CheckpointData {
     std::string created_at;       ///< ISO 8601 timestamp of checkpoint creation
     
     // Version for format compatibility
-    static constexpr uint32_t FORMAT_VERSION = 1;
+    // v2: SPHParticle fields regrouped into hot/cold blocks (raw layout change)
+    // v3: SPHParticle grew h_dot (warm-started smoothing-length iteration)
+    // v4: checksum is the SHA-256 of per-chunk SHA-256 digests (parallel hashing)
+    // v5: compact particle schema (CompactCheckpointParticle); v4 still loads
+    static constexpr uint32_t FORMAT_VERSION = 5;
+    static constexpr uint32_t FORMAT_VERSION_RAW = 4;  ///< legacy raw SPHParticle dump
     static constexpr char MAGIC[9] = "SPHCHKPT";  ///< File magic number
+
+    /// Particle record layout of the file this data was loaded from
+    /// (FORMAT_VERSION for freshly created data)
+    uint32_t format_version = FORMAT_VERSION;
+
+    // Delta checkpoints (keyframe + field overrides, see format notes above)
+    static constexpr uint32_t DELTA_FORMAT_VERSION = 1;
+    static constexpr char DELTA_MAGIC[9] = "SPHCHKDL";
+
+    // Optional derived-state section for warm restarts (see DerivedState)
+    static constexpr uint32_t DERIVED_FORMAT_VERSION = 1;
+    static constexpr char DERIVED_MAGIC[9] = "SPHDERIV";
+    DerivedState derived;
+    int64_t derived_size = 0;  ///< section byte size from the header (transient)
     
     // Header size constant
     static constexpr size_t HEADER_SIZE = 512;
     static constexpr size_t CHECKSUM_SIZE = 32;  // SHA-256
+    /// Chunk size of the v4 checksum scheme; the collective multi-rank
+    /// save partitions the file image on these boundaries so its merged
+    /// per-rank digests equal the serial chunked hash bit for bit
+    static constexpr size_t HASH_CHUNK_SIZE = 8 * 1024 * 1024;
     
     /**
      * @brief Validate checkpoint data integrity and consistency
@@ -6,6 +6,7 @@
 #include "core/parameters.hpp"
 #include <string>
 #include <deque>
+#include <map>
 #include <memory>
 #include <boost/filesystem.hpp>
 #include <fstream>
@@ -34,6 +35,12 @@ public:
         int max_keep = 3;               ///< Keep last N checkpoints (delete older ones)
         bool on_interrupt = true;       ///< Save checkpoint on SIGINT/SIGTERM
         std::string directory = "checkpoints";  ///< Subdirectory for checkpoint files
+
+        // Delta mode: full keyframes every keyframe_interval checkpoints,
+        // small field-override deltas in between (see checkpoint_data.hpp)
+        bool delta_enabled = false;     ///< Write keyframe/delta chains instead of full files only
+        int keyframe_interval = 10;     ///< Every Nth checkpoint is a full keyframe
+        real delta_tolerance = 0.0;     ///< Relative change below which a field keeps its keyframe value (0 = lossless)
         
         /**
          * @brief Create default configuration (disabled)
@@ -48,7 +55,26 @@ public:
         AutoCheckpointConfig(real interval_time, int max_checkpoints = 3)
             : enabled(true), interval(interval_time), max_keep(max_checkpoints) {}
     };
-    
+
+    /**
+     * @brief One record of the per-directory checkpoint registry
+     *
+     * The registry is a small append-only text file (registry.txt) living
+     * next to the checkpoint files: every save appends a "+" record and
+     * every prune a "-" record, so rotation and resume discovery read one
+     * small file instead of scanning the directory and parsing 512-byte
+     * headers — a seconds-long stall with delta chains on parallel
+     * filesystems.
+     */
+    struct RegistryEntry {
+        std::string name;    ///< file name inside the checkpoint directory
+        int64_t step = 0;    ///< integration step from the header
+        double time = 0.0;   ///< simulation time of the checkpoint
+        uint64_t size = 0;   ///< file size in bytes
+        std::string parent;  ///< keyframe file name for deltas, empty for full files
+        std::string digest;  ///< first 8 bytes of the file checksum, hex
+    };
+
     /**
      * @brief Default constructor (auto-checkpoint disabled)
      */
@@ -73,22 +99,112 @@ public:
      * @param sim Simulation object with current state
      * @param params Simulation parameters
      * @throws std::runtime_error if save fails
+     *
+     * With delta mode enabled (AutoCheckpointConfig::delta_enabled), only
+     * every keyframe_interval-th call writes the full file above; the
+     * calls in between write a small delta holding the per-particle
+     * fields that moved beyond delta_tolerance since the keyframe.
      */
     void save_checkpoint(
         const std::string& filepath,
         const Simulation& sim,
         const SPHParameters& params
     );
-    
+
+    /**
+     * @brief Minimal-state fast flush for preemption deadlines (SIGTERM)
+     *
+     * Writes the same compact-schema file format as save_checkpoint, but
+     * trimmed to what the deadline allows: the records pack straight from
+     * the live particle array (no staging copy of the vector), the delta
+     * chain is bypassed so the file is always self-contained, and the
+     * derived warm-restart section is omitted — the restore recomputes it,
+     * which beats losing the run. The chunked parallel hashing and the
+     * mapped large-write path are shared with the regular save, so
+     * load_checkpoint reads the result unchanged.
+     *
+     * @param filepath Path to checkpoint file (will be created/overwritten)
+     * @param sim Simulation object with current state
+     * @param params Simulation parameters
+     * @throws std::runtime_error if save fails
+     */
+    void save_checkpoint_fast(
+        const std::string& filepath,
+        const Simulation& sim,
+        const SPHParameters& params
+    );
+
+    /**
+     * @brief Serialize the rank-independent prefix of a collective save
+     *
+     * Header plus parameter JSON in the fast-flush schema (no derived
+     * section), with the particle count patched to the global count. In a
+     * collective multi-rank save (core/mpi_output.hpp) every rank writes
+     * its particle-record slice directly after these bytes, so they must
+     * be identical everywhere — the header carries a timestamp, which is
+     * why rank 0 builds the preamble and broadcasts it.
+     *
+     * @param sim Simulation object with current state (time, dt)
+     * @param params Simulation parameters
+     * @param global_particle_count Particle count summed over the ranks
+     * @return The serialized header + parameters bytes
+     */
+    std::vector<char> build_collective_preamble(
+        const Simulation& sim,
+        const SPHParameters& params,
+        int64_t global_particle_count
+    );
+
+    /**
+     * @brief Append the packed particle records of one rank's slice
+     *
+     * The same compact per-particle schema save_checkpoint writes; exposed
+     * so the collective save can pack its slice without staging a full
+     * file image.
+     */
+    void append_particle_records(
+        std::vector<char>& image,
+        const std::vector<SPHParticle>& particles
+    );
+
+    /**
+     * @brief Registry bookkeeping for a collectively written checkpoint
+     *
+     * Appends the '+' record save_checkpoint would have written; called on
+     * rank 0 only, with the checksum merged from the per-rank chunk
+     * digests.
+     *
+     * @param filepath Checkpoint file that was written
+     * @param time Simulation time of the checkpoint
+     * @param file_size Total file size in bytes (including the checksum)
+     * @param checksum The 32-byte merged checksum
+     */
+    void record_collective_save(
+        const std::string& filepath,
+        double time,
+        uint64_t file_size,
+        const std::vector<uint8_t>& checksum
+    );
+
+
     /**
      * @brief Load simulation state from checkpoint file
-     * 
+     *
      * Reads and validates checkpoint file, then populates CheckpointData.
      * Performs integrity checks:
      * - Magic number verification
      * - Format version compatibility
      * - Checksum validation
-     * 
+     *
+     * On POSIX systems the file is memory-mapped: the checksum is streamed
+     * over the mapping and the particle section is copied straight into the
+     * result vector in parallel chunks, with no intermediate read buffers.
+     * Elsewhere it falls back to the buffered stream reader.
+     *
+     * Delta checkpoints are handled transparently: their keyframe is
+     * loaded first (resolved relative to the delta file's directory) and
+     * the stored field overrides are replayed on top of it.
+     *
      * @param filepath Path to existing checkpoint file
      * @return CheckpointData with loaded simulation state
      * @throws std::runtime_error if file doesn't exist, is corrupted, or invalid
@@ -175,6 +291,38 @@ public:
      */
     std::vector<std::string> get_checkpoint_files() const;
     
+    /**
+     * @brief Read the current registry of a checkpoint directory
+     *
+     * Replays the append-only index: "+" records add a checkpoint, "-"
+     * records drop one. A missing or unreadable index self-heals — the
+     * directory is scanned once, the file headers parsed, and the index
+     * rewritten — so a deleted registry.txt only costs one scan.
+     *
+     * @param directory Checkpoint directory
+     * @return Live entries in append (chronological) order
+     */
+    std::vector<RegistryEntry> read_registry(const std::string& directory);
+
+    /**
+     * @brief Rebuild the registry index from the checkpoint files on disk
+     * @param directory Checkpoint directory
+     */
+    void rebuild_registry(const std::string& directory);
+
+    /**
+     * @brief Path of the newest registered checkpoint in a directory
+     *
+     * Consults the registry (see read_registry), so discovery is O(1) in
+     * the number of files. load_checkpoint calls this when handed a
+     * directory, which lets resumeCheckpointFile point at the checkpoint
+     * directory instead of a specific file.
+     *
+     * @param directory Checkpoint directory
+     * @return Full path of the entry with the largest time, or "" if none
+     */
+    std::string find_latest_checkpoint(const std::string& directory);
+
     /**
      * @brief Get time of last checkpoint
      * 
@@ -194,38 +342,125 @@ private:
     AutoCheckpointConfig config_;      ///< Auto-checkpoint configuration
     real last_checkpoint_time_;        ///< Time of last checkpoint
     std::deque<std::string> checkpoint_files_;  ///< List of checkpoint files (FIFO)
-    
+
+    // Delta-mode chain state: the particle snapshot the deltas diff
+    // against, and which tracked delta file needs which keyframe (so
+    // cleanup never deletes a keyframe a surviving delta still references)
+    std::vector<SPHParticle> keyframe_particles_;
+    std::string keyframe_path_;
+    int checkpoints_since_keyframe_ = 0;
+    std::map<std::string, std::string> delta_keyframe_of_;
+
+    /**
+     * @brief Write a delta checkpoint against the current keyframe
+     * @param filepath Path to delta checkpoint file
+     * @param particles Current particle state (same count as the keyframe)
+     * @param sim Simulation object with current state
+     */
+    void save_delta_checkpoint(
+        const std::string& filepath,
+        const std::vector<SPHParticle>& particles,
+        const Simulation& sim
+    );
+
+    /**
+     * @brief Load a delta checkpoint: load its keyframe, replay overrides
+     * @param filepath Path to existing delta checkpoint file
+     * @return CheckpointData with the reconstructed simulation state
+     */
+    CheckpointData load_delta_checkpoint(const std::string& filepath);
+
+
     // Binary I/O helper methods
     
     /**
-     * @brief Write checkpoint header to file
-     * @param file Output file stream
+     * @brief Append the checkpoint header to the in-memory file image
+     * @param image File image being assembled
      * @param data Checkpoint data
      */
-    void write_header(std::ofstream& file, const CheckpointData& data);
-    
+    void write_header(std::vector<char>& image, const CheckpointData& data);
+
     /**
-     * @brief Write parameters section to file (JSON format)
-     * @param file Output file stream
+     * @brief Append the parameters section (JSON) and patch its size field
+     * @param image File image being assembled (header already present)
      * @param params Simulation parameters
-     * @return Size in bytes of parameters section written
+     * @return Size in bytes of parameters section appended
      */
-    size_t write_parameters(std::ofstream& file, const SPHParameters& params);
-    
+    size_t write_parameters(std::vector<char>& image, const SPHParameters& params);
+
     /**
-     * @brief Write particle data to file (binary format)
-     * @param file Output file stream
+     * @brief Append the binary particle array to the file image
+     * @param image File image being assembled
      * @param particles Vector of particles
      */
-    void write_particles(std::ofstream& file, const std::vector<SPHParticle>& particles);
-    
+    void write_particles(std::vector<char>& image, const std::vector<SPHParticle>& particles);
+
+    /**
+     * @brief Append the derived-state section and patch its size field
+     * @param image File image being assembled (header + params + particles)
+     * @param sim Simulation to snapshot the derived state from
+     * @return Size in bytes of the derived section appended
+     */
+    size_t write_derived(std::vector<char>& image, const Simulation& sim);
+
+    /**
+     * @brief Parse a derived-state section buffer (tolerant)
+     * @param cursor Pointer to the section bytes
+     * @param size Section size from the header
+     * @param data Checkpoint data to populate; derived.present stays false
+     *             on any magic/version/count mismatch so the restore falls
+     *             back to the full recompute
+     */
+    void parse_derived(const char* cursor, size_t size, CheckpointData& data);
+
     /**
      * @brief Write checksum to file
      * @param file Output file stream
      * @param data Binary data to checksum (header + params + particles)
+     * @return The 32-byte checksum that was written (feeds the registry digest)
+     */
+    std::vector<uint8_t> write_checksum(std::ofstream& file, const std::vector<char>& data);
+
+    /// Name of the append-only index file inside a checkpoint directory
+    static constexpr const char* REGISTRY_FILE = "registry.txt";
+
+    /**
+     * @brief Append one record to the registry of filepath's directory
+     * @param filepath Checkpoint file the record is about
+     * @param op '+' for a save, '-' for a prune
+     * @param entry Record fields (only name is read for '-' records)
      */
-    void write_checksum(std::ofstream& file, const std::vector<char>& data);
+    void registry_append(const std::string& filepath, char op, const RegistryEntry& entry);
     
+    /**
+     * @brief Memory-mapped load path (POSIX only)
+     * @param filepath Path to existing checkpoint file
+     * @return CheckpointData with loaded simulation state
+     */
+    CheckpointData load_checkpoint_mmap(const std::string& filepath);
+
+    /**
+     * @brief Buffered stream load path (portable fallback)
+     * @param filepath Path to existing checkpoint file
+     * @return CheckpointData with loaded simulation state
+     */
+    CheckpointData load_checkpoint_stream(const std::string& filepath);
+
+    /**
+     * @brief Parse a 512-byte header buffer
+     * @param header Pointer to HEADER_SIZE bytes
+     * @param data Checkpoint data to populate
+     */
+    void parse_header(const char* header, CheckpointData& data);
+
+    /**
+     * @brief Parse the JSON parameters section
+     * @param json Pointer to json_size bytes of JSON text
+     * @param json_size Size of the JSON text in bytes
+     * @param data Checkpoint data to populate
+     */
+    void parse_parameters(const char* json, size_t json_size, CheckpointData& data);
+
     /**
      * @brief Read checkpoint header from file
      * @param file Input file stream
@@ -257,9 +492,13 @@ private:
     bool verify_checksum(std::ifstream& file, const std::vector<char>& data);
     
     /**
-     * @brief Compute SHA-256 hash of data
+     * @brief Compute the chunked checkpoint checksum of data
+     *
+     * SHA-256 of per-chunk SHA-256 digests (8 MiB chunks); the chunks
+     * hash in parallel across OpenMP threads on both save and load.
+     *
      * @param data Binary data to hash
-     * @return 32-byte SHA-256 hash
+     * @return 32-byte hash
      */
     std::vector<uint8_t> compute_sha256(const std::vector<char>& data);
 };
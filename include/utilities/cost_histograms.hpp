@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+
+#include "utilities/defines.hpp"
+
+namespace sph
+{
+
+    class Simulation;
+
+    /**
+     * @brief Per-particle cost-model instrumentation (costInstrumentation key)
+     *
+     * When a flyby run slows down the timing CSV says which module got
+     * expensive but not why — neighbor-count inflation near the shock looks
+     * exactly like tree imbalance from the outside. With this mode on, each
+     * step collects histograms of the per-particle cost drivers: neighbor
+     * counts (from SPHParticle::neighbor), smoothing-length Newton-Raphson
+     * iteration counts, and tree-walk node visits (log2-binned), plus each
+     * thread's busy window inside the pre-interaction and fluid-force
+     * sweeps (first-iteration to last-iteration wall time, which exposes the
+     * imbalance the schedule auto-tuner and the block-timestep binning need
+     * to act on). One JSON object per step is appended to
+     * cost_histograms.jsonl in the run directory.
+     *
+     * The recording calls are per-thread increments into padded rows with an
+     * inline enabled() test, so the mode costs nothing when off and no
+     * synchronization when on; merging and the file write happen once per
+     * step.
+     */
+    class CostHistograms
+    {
+    public:
+        enum Loop
+        {
+            PRE_INTERACTION,
+            FLUID_FORCE,
+            NUM_LOOPS
+        };
+
+        static const int NR_BINS = 17;      // iterations 0..15, last bin clamps
+        static const int VISIT_BINS = 24;   // log2(node visits), last bin clamps
+        static const int NEIGHBOR_BINS = 65; // counts in bins of 8, last bin clamps
+
+        /// Open the per-step output file (once, at startup).
+        static void enable(const std::string &jsonl_path);
+        static bool enabled();
+
+        /// Newton-Raphson iterations one particle took this step.
+        static void record_nr(const int iterations);
+
+        /// Nodes one tree walk visited (leaf and internal).
+        static void record_tree_visits(const int nodes);
+
+        /// Per-iteration touch inside a hot loop: stretches the calling
+        /// thread's busy window for that loop.
+        static void touch_window(const Loop loop);
+
+        static void begin_step(const real time);
+
+        /// Merge the per-thread rows, histogram the neighbor counts from the
+        /// particle array, append the step's JSON row and reset.
+        static void end_step(Simulation *sim);
+    };
+
+}
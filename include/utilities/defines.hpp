@@ -8,7 +8,23 @@
 #error "DIM must be defined via CMake build system (use -DBUILD_DIM=X)"
 #endif
 
+// Floating-point precision is selected at configure time via BUILD_PRECISION
+// (double | single | mixed, see CMakeLists.txt). `real` is the particle-state
+// (and therefore snapshot/checkpoint) type; `accum_t` is the type of the long
+// reductions — the pair sums in FluidForce and the TimeStep minima — which
+// stays double in the mixed build so the f32 state does not feed rounding
+// error back through the sums. Checkpoints dump raw SPHParticle records, so
+// they are only readable by a build of the same precision.
+#if defined(SPH_PRECISION_SINGLE)
+typedef float real;
+typedef float accum_t;
+#elif defined(SPH_PRECISION_MIXED)
+typedef float real;
+typedef double accum_t;
+#else
 typedef double real;
+typedef double accum_t;
+#endif
 
 #ifndef M_PI
 #define M_PI 3.1415926535897932384626433832795028841971693993751
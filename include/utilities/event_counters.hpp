@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+
+#include "utilities/defines.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sph
+{
+
+    /**
+     * @brief Aggregated counters for rare events inside the hot loops
+     *
+     * Logging from inside an OpenMP loop serializes the threads and can grow
+     * the log by gigabytes in pathological runs. Instead the loops bump a
+     * per-thread counter (one cache line per thread, no synchronization) and
+     * the solver reports the per-step totals once, after the step.
+     */
+    class EventCounters
+    {
+    public:
+        enum Event
+        {
+            ENE_FLOOR_PREDICT,     // internal energy floored in predict()
+            ENE_FLOOR_CORRECT,     // internal energy floored in correct()
+            ENE_FLOOR_COOLING,     // cooling sub-cycle hit the energy floor
+            NR_NO_CONVERGENCE,     // smoothing-length Newton-Raphson gave up
+            NEIGHBOR_LIST_OVERFLOW, // neighbor list hit its capacity
+            NEIGHBOR_LIST_GROWN,    // adaptive search grew the buffer and retried
+            NUM_EVENTS
+        };
+
+        static const char *name(const Event event);
+
+        /// Bump a counter from any thread; safe inside omp parallel regions.
+        static void count(const Event event);
+
+        /// Sum a counter over all threads (does not reset).
+        static long total(const Event event);
+
+        /// Log all non-zero totals once and zero every counter.
+        static void report_and_reset();
+    };
+
+}
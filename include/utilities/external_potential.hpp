@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory>
+
+#include "utilities/defines.hpp"
+#include "utilities/vector_type.hpp"
+
+namespace sph
+{
+
+    struct SPHParameters;
+    class Simulation;
+
+    /**
+     * @brief Analytic external potential (useExternalPotential config key)
+     *
+     * The flyby intruder used to be an is_point_mass particle, which keeps
+     * the tree gravity walk on for the whole run even when disk self-gravity
+     * is negligible. This helper evaluates a closed-form background
+     * acceleration instead — a point mass, Plummer sphere or NFW halo whose
+     * center moves on a prescribed straight-line trajectory — so
+     * non-self-gravitating runs can leave useGravity off entirely and pay
+     * one multiply-add sweep per step in place of the tree walk.
+     *
+     * A point mass is the Plummer profile with zero scale radius; the NFW
+     * acceleration uses the enclosed-mass form with `mass` meaning the
+     * characteristic mass 4 pi rho_s r_s^3. The center position is always a
+     * plain coordinate difference — a moving external body has no meaningful
+     * periodic image.
+     */
+    class ExternalPotential
+    {
+        bool m_enabled = false;
+        int m_profile = 0; // ExternalPotentialType as int, switch-friendly
+        real m_constant = 1.0;
+        real m_mass = 0.0;
+        real m_scale = 0.0;
+        vec_t m_center;   // at t = 0
+        vec_t m_velocity; // prescribed drift
+
+    public:
+        void initialize(std::shared_ptr<SPHParameters> param);
+        bool enabled() const { return m_enabled; }
+
+        /// Center position at simulation time t.
+        vec_t center_at(const real t) const { return m_center + m_velocity * t; }
+
+        /// Acceleration and potential of the profile at separation r_ij from
+        /// the current center (exposed for tests; apply() batches this).
+        void evaluate(const vec_t &r_ij, vec_t &acc, real &phi) const;
+
+        /// Add the external acceleration to every active non-point-mass
+        /// particle. When self_gravity is true the tree walk reset phi this
+        /// step and the external term accumulates; otherwise phi is set.
+        void apply(std::shared_ptr<Simulation> sim, const bool self_gravity) const;
+    };
+
+}
@@ -0,0 +1,76 @@
+/* ================================
+ * gravity_softening.hpp
+ * ================================ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "utilities/defines.hpp"
+
+namespace sph
+{
+
+    // Hernquist & Katz (1989) softened point-mass kernels: the potential uses
+    // f(r, h) and the acceleration uses g(r, h) with acc = -G m r_ij g. The
+    // piecewise rationals are refactored into Horner form (every step an fma
+    // candidate) and the u < 1 / u < 2 / far branches into nested selects, so
+    // the batched variant below vectorizes as masked blends instead of
+    // serializing on the support splits. All three branch values are computed
+    // unconditionally; the far-field 1/r powers stay finite at r = 0 via the
+    // max() and are discarded by the select there.
+    inline void grav_fg(const real r, const real h, real &f_out, real &g_out)
+    {
+        const real e = 0.5 * h;
+        const real e_inv = 1.0 / e;
+        // u must come from the same division the pre-refactor code used:
+        // the piecewise forms are not continuous at u = 1, so a one-ulp
+        // difference against r * e_inv can flip the select at r = e and
+        // change f by O(1).
+        const real u = r / e;
+        const real r_inv = 1.0 / std::max(r, std::numeric_limits<real>::min());
+        const real r3_inv = r_inv * r_inv * r_inv;
+        const real e3_inv = e_inv * e_inv * e_inv;
+
+        const real f_near = e_inv * (1.4 + u * u * (-1.0 / 6.0 + u * u * (3.0 / 40.0 - u * (1.0 / 40.0))));
+        const real f_mid = -r_inv * (1.0 / 15.0) + e_inv * (1.6 + u * u * (-4.0 / 3.0 + u * (1.0 + u * (-0.3 + u * (1.0 / 30.0)))));
+        const real g_near = e3_inv * (4.0 / 3.0 + u * u * (-1.2 + 0.5 * u));
+        const real g_mid = r3_inv * (-1.0 / 15.0 + u * u * u * (8.0 / 3.0 + u * (-3.0 + u * (1.2 - u * (1.0 / 6.0)))));
+
+        f_out = u < 1.0 ? f_near : (u < 2.0 ? f_mid : r_inv);
+        g_out = u < 1.0 ? g_near : (u < 2.0 ? g_mid : r3_inv);
+    }
+
+    inline real grav_f(const real r, const real h)
+    {
+        real f, g;
+        grav_fg(r, h, f, g);
+        return f;
+    }
+
+    inline real grav_g(const real r, const real h)
+    {
+        real f, g;
+        grav_fg(r, h, f, g);
+        return g;
+    }
+
+    // Symmetrized batch over one interaction list: h_i is fixed for the
+    // walker while h_j varies per entry. out_f/out_g receive the averaged
+    // (f(r, h_i) + f(r, h_j)) / 2 form the tree walks accumulate.
+    inline void grav_fg_sym_batch(const real *r, const real h_i, const real *h_j,
+                                  real *out_f, real *out_g, const int n)
+    {
+#pragma omp simd
+        for (int k = 0; k < n; ++k)
+        {
+            real f_i, g_i, f_j, g_j;
+            grav_fg(r[k], h_i, f_i, g_i);
+            grav_fg(r[k], h_j[k], f_j, g_j);
+            out_f[k] = 0.5 * (f_i + f_j);
+            out_g[k] = 0.5 * (g_i + g_j);
+        }
+    }
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sph
+{
+
+    struct SPHParameters;
+
+    /**
+     * @brief Transparent-hugepage backing for the large long-lived arrays
+     *
+     * At 10M+ particles the particle vector, the two tree node pools and the
+     * SoA/CSR mirrors each span gigabytes of 4 KiB pages, and the pair loops
+     * lose a measurable slice of their cycles to dTLB misses walking them.
+     * With the hugePages config key the owning call sites advise the kernel
+     * (madvise(MADV_HUGEPAGE)) over every such allocation as it grows, so
+     * khugepaged collapses the ranges to 2 MiB mappings even where the
+     * system-wide THP policy is madvise-only.
+     *
+     * Collapse is asynchronous and best-effort, so advise() only records
+     * intent; log_coverage() reads the achieved AnonHugePages backing from
+     * /proc/self/smaps_rollup and logs it alongside the memory footprint
+     * report, so the coverage actually reached is visible per run.
+     */
+    class HugePages
+    {
+    public:
+        /// Read the hugePages config key (once, at startup).
+        static void initialize(std::shared_ptr<SPHParameters> param);
+
+        static bool enabled();
+
+        /// Advise the 2 MiB-aligned interior of [data, data + bytes); ranges
+        /// smaller than one hugepage are left alone. No-op when disabled.
+        static void advise(const void *data, std::size_t bytes);
+
+        /// Vector convenience: advise the whole current allocation.
+        template <class T>
+        static void advise(const std::vector<T> &v)
+        {
+            advise(v.data(), sizeof(T) * v.capacity());
+        }
+
+        /// Log achieved vs. total anonymous memory for the whole process,
+        /// tagged with the context (e.g. "startup", "snapshot 3").
+        static void log_coverage(const std::string &context);
+    };
+
+}
@@ -1,14 +1,16 @@
 #pragma once
 #include <memory>
 #include "core/particle.hpp"
+#include "core/particle_span.hpp"
 
 namespace sph
 {
     // Forward declaration of Simulation to break the cycle.
     class Simulation;
-    
+
     /// Abstract interface for initial conditions modification.
-    /// A sample-specific modifier will implement modifyParticles().
+    /// A sample-specific modifier will implement modify() (preferred) or the
+    /// legacy modifyParticles().
     class InitialConditionsModifier
     {
     public:
@@ -16,7 +18,26 @@ namespace sph
 
         /// Modify the loaded particles. This function is called immediately
         /// after initial conditions (CSV/checkpoint file) are read.
+        ///
+        /// Zero-copy hook: existing particles are edited through the span,
+        /// and new ones are constructed in place in the simulation's storage
+        /// through the appender (reserve() first; appending can reallocate,
+        /// so re-acquire the span via sim->particle_span() afterwards). The
+        /// solver calls sim->finalize_particles() when the modifier returns.
+        ///
+        /// The default implementation forwards to the legacy vector-based
+        /// modifyParticles(), so existing modifiers keep working unchanged.
+        virtual void modify(ParticleSpan particles, ParticleAppender &append,
+                            std::shared_ptr<Simulation> sim);
+
+        /// Legacy hook passing the particle vector itself. Modifiers that
+        /// replace the vector wholesale build a full copy next to the live
+        /// one; prefer modify() for anything memory-bound.
         virtual void modifyParticles(std::vector<SPHParticle> &particles,
-                                     std::shared_ptr<Simulation> sim) = 0;
+                                     std::shared_ptr<Simulation> sim)
+        {
+            (void)particles;
+            (void)sim;
+        }
     };
 }
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "utilities/defines.hpp"
+
+namespace sph
+{
+    class Simulation;
+
+    // Alternative integration routines for simulations whose fluid particles
+    // are constrained to the x-y plane (z = 0, vz = 0); gravity stays 3D.
+    void inplane_predict(std::shared_ptr<Simulation> sim);
+    void inplane_correct(std::shared_ptr<Simulation> sim);
+
+    /// Azimuthally averaged SPH surface density at one radius: the
+    /// kernel-weighted mass sum evaluated at `quadrature` sample points
+    /// around the circle. Prefer the batched overload from the relaxation
+    /// driver; a single radius can only spread its quadrature points across
+    /// the cores.
+    real inplane_surface_density(std::shared_ptr<Simulation> sim, const real radius,
+                                 const int quadrature = 64);
+
+    /// Batched form: every (radius, quadrature point) sample runs in one
+    /// parallel region, so IC construction and relaxation checks that probe
+    /// many radii keep all cores busy instead of paying a serial
+    /// O(N * quadrature) sum per call.
+    std::vector<real> inplane_surface_density(std::shared_ptr<Simulation> sim,
+                                              const std::vector<real> &radii,
+                                              const int quadrature = 64);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+#include "utilities/defines.hpp"
+
+namespace sph
+{
+
+    struct SPHParameters;
+
+    /**
+     * @brief Runtime-selectable OpenMP scheduling for the hot module loops
+     *
+     * The per-particle cost of the interaction loops varies wildly: particles
+     * at the shock front carry full neighbor lists (and Riemann solves) while
+     * vacuum-edge particles are nearly free, so the default static schedule
+     * leaves threads idling at the implicit barrier. The hot loops are
+     * declared schedule(runtime) and a Scope guard applies the configured
+     * schedule right before each one.
+     *
+     * The mode comes from the ompSchedule config key: "static", "dynamic" or
+     * "guided" (with an optional ompChunk chunk size), or "auto", which times
+     * a few invocations of each candidate schedule per loop and locks in the
+     * fastest for the rest of the run, logging the choice. Without OpenMP
+     * every call is a no-op.
+     */
+    class LoopScheduler
+    {
+    public:
+        enum Loop
+        {
+            PRE_INTERACTION,
+            FLUID_FORCE,
+            GRAVITY_FORCE,
+            SHOCK_DETECTION,
+            NUM_LOOPS
+        };
+
+        static const char *name(const Loop loop);
+
+        /// Read ompSchedule/ompChunk from the parameters (once, at startup).
+        static void initialize(std::shared_ptr<SPHParameters> param);
+
+        /// Scoped guard: applies the loop's schedule on construction, and in
+        /// auto mode times construction-to-destruction to drive the tuning.
+        class Scope
+        {
+            using clock = std::chrono::steady_clock;
+
+            Loop m_loop;
+            bool m_timed;
+            clock::time_point m_start;
+
+        public:
+            explicit Scope(const Loop loop);
+            ~Scope();
+        };
+    };
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace sph
+{
+
+    /**
+     * @brief File-backed bump allocator for the out-of-core mode
+     *
+     * map() creates (or extends) a backing file in the run's scratch
+     * directory and maps it writable with MAP_SHARED, so the kernel can write
+     * cold pages back to the file under memory pressure instead of swapping
+     * or OOM-killing the run. alloc() carves aligned blocks from the mapping
+     * in order; remapping for a new size invalidates previous carve-outs, so
+     * holders re-attach after every map() (see ParticleSoA::resize).
+     *
+     * The arrays placed here are swept in index order and the particles are
+     * Morton-ordered, so the access pattern is sequential-with-locality;
+     * the mapping is advised MADV_SEQUENTIAL to get aggressive readahead of
+     * the upcoming blocks.
+     */
+    class MappedArena
+    {
+    public:
+        ~MappedArena();
+
+        /// Map at least `bytes` of file-backed storage at `path`, growing the
+        /// file as needed. Any previous mapping (and every pointer handed out
+        /// from it) is released first.
+        void map(const std::string &path, const std::size_t bytes);
+
+        /// Bump-allocate an aligned block from the mapping; throws when the
+        /// mapping is exhausted (callers size the map() call up front).
+        void *alloc(const std::size_t bytes, const std::size_t alignment);
+
+        /// Forget all carve-outs without touching the mapping.
+        void reset() { m_offset = 0; }
+
+        bool is_mapped() const { return m_base != nullptr; }
+        std::size_t capacity() const { return m_size; }
+
+    private:
+        void unmap();
+
+        char *m_base = nullptr;
+        std::size_t m_size = 0;
+        std::size_t m_offset = 0;
+    };
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sph
+{
+
+    /**
+     * @brief Per-subsystem memory accounting with high-water marks
+     *
+     * Jobs were sized by trial-and-error because the big allocations — the
+     * particle vector, the tree node pool (particle_num * tree_size nodes),
+     * the per-thread neighbor scratch, the additional-array registry and
+     * checkpoint staging — all grow independently and nothing reported where
+     * the bytes went. Each subsystem records its current allocation here
+     * (set() at the owning call site, add() for incrementally growing
+     * buffers) and the registry keeps the peak alongside it. The solver logs
+     * the table at startup and per snapshot, and the run metadata JSON gets
+     * a "memory" section with the final peaks, so e.g. a tree pool at 2.5x
+     * the particle data is visible and tree_size can be tuned against it.
+     *
+     * Updates take a mutex: every call site is a cold path (pool growth,
+     * once-per-step accounting), never a per-particle loop.
+     */
+    class MemoryFootprint
+    {
+    public:
+        struct Entry
+        {
+            std::string name;
+            std::size_t current;
+            std::size_t peak;
+        };
+
+        /// Record a subsystem's current allocation; the peak follows.
+        static void set(const char *subsystem, std::size_t bytes);
+
+        /// Adjust a subsystem that grows piecemeal (per-thread buffers).
+        static void add(const char *subsystem, long bytes);
+
+        static std::size_t current(const char *subsystem);
+        static std::size_t peak(const char *subsystem);
+
+        /// All entries in first-report order.
+        static std::vector<Entry> entries();
+
+        /// Log one line per subsystem plus a total, tagged with the context
+        /// (e.g. "startup", "snapshot 3").
+        static void log_report(const std::string &context);
+
+        /// JSON object mapping each subsystem to its current and peak bytes,
+        /// indented for embedding in the run metadata.
+        static std::string to_json(int indent);
+
+        /// Drop all entries (the sweep orchestrator runs configs back-to-back).
+        static void reset();
+    };
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "utilities/defines.hpp"
+
+namespace sph
+{
+
+    struct SPHParameters;
+
+    /**
+     * @brief NUMA-aware placement and thread pinning for the particle arrays
+     *
+     * On multi-socket nodes the first write to a page binds it to the writing
+     * thread's memory node. Startup is serial, so the particle vector (and
+     * every SoA mirror resized from it) lands entirely on one socket and half
+     * the threads in the force loops then read across the interconnect.
+     *
+     * With the numaFirstTouch config key the solver re-places the particle
+     * vector after initialization: a fresh allocation is first-touched in
+     * parallel with the same static partition the loops use, the particles
+     * are copied over in that order, and the vectors are swapped. ParticleSoA
+     * touches its arrays the same way when they grow. The Morton reorder pass
+     * copies back into the already-placed allocation, so placement survives
+     * reordering without a second pass. numaPinThreads (default: follows
+     * numaFirstTouch) pins the OpenMP threads round-robin over the online
+     * CPUs so the partition-to-socket mapping stays fixed; it defers to any
+     * affinity already set via OMP_PROC_BIND/GOMP_CPU_AFFINITY/KMP_AFFINITY.
+     */
+    class NumaPlacement
+    {
+    public:
+        /// Read the numa config and pin threads if requested (once, at startup).
+        static void initialize(std::shared_ptr<SPHParameters> param);
+
+        static bool enabled();
+
+        /// Touch the byte range in parallel, statically partitioned like the
+        /// particle loops, so each page faults on the thread that will use it.
+        static void first_touch(void *data, const size_t bytes);
+
+        /// Re-place an existing vector: first-touch a fresh allocation in
+        /// parallel, copy the elements over in loop order, swap.
+        template <class T>
+        static void place(std::vector<T> &v)
+        {
+            const int n = static_cast<int>(v.size());
+            if (n == 0 || !enabled())
+            {
+                return;
+            }
+            std::vector<T> placed;
+            placed.reserve(v.size());
+            first_touch(placed.data(), sizeof(T) * v.size());
+            placed.resize(v.size());
+#pragma omp parallel for schedule(static)
+            for (int i = 0; i < n; ++i)
+            {
+                placed[i] = v[i];
+            }
+            v.swap(placed);
+        }
+
+        /// Resize discarding the old contents, with the new allocation
+        /// first-touched in parallel (for derived arrays refilled after the
+        /// resize, like the SoA mirrors).
+        template <class T>
+        static void touch_resize(std::vector<T> &v, const int n)
+        {
+            if (static_cast<int>(v.size()) == n)
+            {
+                return;
+            }
+            if (!enabled())
+            {
+                v.resize(n);
+                return;
+            }
+            std::vector<T> placed;
+            placed.reserve(n);
+            first_touch(placed.data(), sizeof(T) * n);
+            placed.resize(n);
+            v.swap(placed);
+        }
+
+    private:
+        static void pin_threads();
+    };
+
+}
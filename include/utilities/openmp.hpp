@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "utilities/defines.hpp"
 
@@ -8,62 +11,175 @@
 #include <omp.h>
 #endif
 
-class omp_real {
-    int                     m_threads;
-    std::unique_ptr<real[]> m_values;
+// Hierarchical per-thread reduction (min/max/sum). Each thread accumulates
+// into its own cache-line slot — one line per thread, with the 64-byte
+// alignment established manually because C++14 heap allocation does not
+// honor alignas on arrays — so the parallel accumulation phase never
+// false-shares. The old flat slot array straddled both sockets on the
+// 96-thread nodes and was walked serially at merge time; merging now runs
+// in two levels, contiguous thread groups first (in parallel, each group's
+// lines folded near where they live) and the group partials second, so each
+// remote cache line crosses the interconnect once. Templated on the value
+// type so the mixed-precision build can keep its reductions in accum_t
+// while the particle state is real (see defines.hpp).
+template <class T>
+class omp_value {
+    static_assert(sizeof(T) <= 64, "one value per cache line");
+
+    static constexpr int slot_stride = 64; // one cache line per thread
+    static constexpr int group_size = 8;   // threads per first-level merge
+
+    int                              m_threads;
+    std::unique_ptr<unsigned char[]> m_storage;
+    unsigned char *                  m_base; // first slot, 64-byte aligned
+
+    T & slot(const int i) const
+    {
+        return *reinterpret_cast<T *>(m_base + static_cast<std::size_t>(i) * slot_stride);
+    }
+
+    template <class Op>
+    T reduce(Op op) const
+    {
+        const int n_groups = (m_threads + group_size - 1) / group_size;
+        if(n_groups == 1) {
+            T v = slot(0);
+            for(int i = 1; i < m_threads; ++i) {
+                v = op(v, slot(i));
+            }
+            return v;
+        }
+        std::vector<T> partial(n_groups);
+#pragma omp parallel for schedule(static)
+        for(int g = 0; g < n_groups; ++g) {
+            const int last = std::min(m_threads, (g + 1) * group_size);
+            T v = slot(g * group_size);
+            for(int i = g * group_size + 1; i < last; ++i) {
+                v = op(v, slot(i));
+            }
+            partial[g] = v;
+        }
+        T v = partial[0];
+        for(int g = 1; g < n_groups; ++g) {
+            v = op(v, partial[g]);
+        }
+        return v;
+    }
 
 public:
-    omp_real(real const v = 0.0)
+    omp_value(T const v = 0.0)
     {
 #ifdef _OPENMP
         m_threads = omp_get_max_threads();
 #else
         m_threads = 1;
 #endif
-        m_values = std::make_unique<real[]>(m_threads);
+        m_storage = std::make_unique<unsigned char[]>(
+            static_cast<std::size_t>(m_threads + 1) * slot_stride);
+        const auto addr = reinterpret_cast<std::uintptr_t>(m_storage.get());
+        m_base = m_storage.get() + (slot_stride - addr % slot_stride) % slot_stride;
 
         for(int i = 0; i < m_threads; ++i) {
-            m_values[i] = v;
+            slot(i) = v;
         }
     }
 
-    real & get()
+    T & get()
     {
 #ifdef _OPENMP
-        return m_values[omp_get_thread_num()];
+        return slot(omp_get_thread_num());
 #else
-        return m_values[0];
+        return slot(0);
 #endif
     }
 
-    real min()
+    T min() const
     {
-        real v = m_values[0];
-        for(int i = 1; i < m_threads; ++i) {
-            if(v > m_values[i]) {
-                v = m_values[i];
-            }
-        }
-        return v;
+        return reduce([](T a, T b) { return b < a ? b : a; });
     }
 
-    real max()
+    T max() const
     {
-        real v = m_values[0];
-        for(int i = 1; i < m_threads; ++i) {
-            if(v < m_values[i]) {
-                v = m_values[i];
-            }
-        }
-        return v;
+        return reduce([](T a, T b) { return a < b ? b : a; });
     }
 
-    real sum()
+    T sum() const
     {
-        real v = 0;
-        for(int i = 0; i < m_threads; ++i) {
-            v += m_values[i];
-        }
-        return v;
+        return reduce([](T a, T b) { return a + b; });
     }
 };
+
+using omp_real = omp_value<real>;
+using omp_accum = omp_value<accum_t>;
+
+// Fixed-topology deterministic reductions.
+//
+// omp_value's per-thread slots make a sum depend on the thread count: the
+// loop partition decides which terms land in which slot, so the rounding
+// order changes between runs with different OMP_NUM_THREADS. These helpers
+// instead reduce fixed 2048-element chunks of the index range — the chunk
+// boundaries depend only on n — and combine the chunk partials with a
+// fixed-order pairwise tree, so the result is bitwise identical for any
+// thread count (and the tree keeps the summation error O(log n) instead of
+// O(n)). Floating min/max are order-independent to begin with, but routing
+// the timestep criteria through the same shape keeps every reduction the
+// diagnostics depend on reproducible by construction. The overhead is one
+// partial per 2048 elements, cheap enough to stay on unconditionally.
+template <class T, class Term>
+T deterministic_sum(const int n, Term &&term)
+{
+    constexpr int chunk = 2048;
+    const int n_chunks = (n + chunk - 1) / chunk;
+    if (n_chunks == 0) {
+        return T(0);
+    }
+    std::vector<T> partial(n_chunks);
+#pragma omp parallel for schedule(static)
+    for (int c = 0; c < n_chunks; ++c) {
+        const int last = std::min(n, (c + 1) * chunk);
+        T s = 0;
+        for (int i = c * chunk; i < last; ++i) {
+            s += term(i);
+        }
+        partial[c] = s;
+    }
+    for (int stride = 1; stride < n_chunks; stride *= 2) {
+        for (int c = 0; c + stride < n_chunks; c += 2 * stride) {
+            partial[c] += partial[c + stride];
+        }
+    }
+    return partial[0];
+}
+
+// Same shape for minima; `identity` is returned for an empty range and is
+// what terms that do not participate should evaluate to.
+template <class T, class Term>
+T deterministic_min(const int n, const T identity, Term &&term)
+{
+    constexpr int chunk = 2048;
+    const int n_chunks = (n + chunk - 1) / chunk;
+    if (n_chunks == 0) {
+        return identity;
+    }
+    std::vector<T> partial(n_chunks);
+#pragma omp parallel for schedule(static)
+    for (int c = 0; c < n_chunks; ++c) {
+        const int last = std::min(n, (c + 1) * chunk);
+        T v = identity;
+        for (int i = c * chunk; i < last; ++i) {
+            const T t = term(i);
+            if (t < v) {
+                v = t;
+            }
+        }
+        partial[c] = v;
+    }
+    for (int stride = 1; stride < n_chunks; stride *= 2) {
+        for (int c = 0; c + stride < n_chunks; c += 2 * stride) {
+            if (partial[c + stride] < partial[c]) {
+                partial[c] = partial[c + stride];
+            }
+        }
+    }
+    return partial[0];
+}
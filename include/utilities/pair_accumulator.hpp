@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+
+#include "utilities/vector_type.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sph
+{
+
+// Per-thread accumulation buffers for symmetrized pair loops.
+//
+// A pair loop that visits each i-j pair once must scatter the reaction onto
+// particle j, and with OpenMP that write races against whichever thread owns
+// j. Instead of atomics, every thread accumulates into its own acc/dene row
+// and reduce() folds the rows together afterwards: n_threads x particle_num
+// of extra memory traded for half the pair evaluations.
+class PairAccumulator
+{
+    int m_num;
+    int m_threads;
+    std::vector<vec_t> m_acc;
+    std::vector<real> m_dene;
+
+public:
+    PairAccumulator() : m_num(0), m_threads(1) {}
+
+    // Size the rows for particle_num particles and zero them.
+    void reset(const int particle_num)
+    {
+        m_num = particle_num;
+#ifdef _OPENMP
+        m_threads = omp_get_max_threads();
+#else
+        m_threads = 1;
+#endif
+        const int total = m_num * m_threads;
+        if (static_cast<int>(m_acc.size()) < total)
+        {
+            m_acc.resize(total);
+            m_dene.resize(total);
+        }
+
+#pragma omp parallel for
+        for (int i = 0; i < total; ++i)
+        {
+            m_acc[i] = 0.0;
+            m_dene[i] = 0.0;
+        }
+    }
+
+    // Row of the calling thread; call from inside the parallel region.
+    vec_t *acc()
+    {
+#ifdef _OPENMP
+        return m_acc.data() + m_num * omp_get_thread_num();
+#else
+        return m_acc.data();
+#endif
+    }
+
+    real *dene()
+    {
+#ifdef _OPENMP
+        return m_dene.data() + m_num * omp_get_thread_num();
+#else
+        return m_dene.data();
+#endif
+    }
+
+    // Fold every thread row into row 0 (read back via acc_total/dene_total).
+    void reduce()
+    {
+#pragma omp parallel for
+        for (int i = 0; i < m_num; ++i)
+        {
+            for (int t = 1; t < m_threads; ++t)
+            {
+                m_acc[i] += m_acc[i + m_num * t];
+                m_dene[i] += m_dene[i + m_num * t];
+            }
+        }
+    }
+
+    const vec_t *acc_total() const { return m_acc.data(); }
+    const real *dene_total() const { return m_dene.data(); }
+};
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+
+#include "utilities/defines.hpp"
+
+namespace sph
+{
+
+    struct SPHParameters;
+    class Simulation;
+
+    /**
+     * @brief Escaped-material culling (cullRadius config key)
+     *
+     * After the encounter a growing fraction of the gas is ejected far from
+     * the region of interest, yet still costs tree depth, neighbor searches
+     * and snapshot bytes every step. This pass removes fluid particles whose
+     * distance from the origin exceeds the configured outer radius, compacts
+     * the array, restores the id == index convention and rebuilds the tree,
+     * so BHTree::resize/make and every per-step loop see only the surviving
+     * particles. Walls and point masses are never culled.
+     *
+     * Escaped gas is unbound by construction (the radius should sit well
+     * outside the disk), so the particles are removed outright rather than
+     * integrated ballistically; the cumulative culled mass and count are
+     * logged so conservation checks can account for the loss. The pass is
+     * interval-gated like refinement — escape is slow, so scanning every
+     * step buys nothing.
+     */
+    class ParticleCulling
+    {
+        bool m_enabled = false;
+        real m_radius2 = 0.0;
+        int m_interval = 1;
+        int m_step = 0;
+        long m_culled_total = 0;
+        real m_culled_mass = 0.0;
+
+    public:
+        void initialize(std::shared_ptr<SPHParameters> param);
+        bool enabled() const { return m_enabled; }
+
+        /// Remove out-of-bounds particles if this step is due; returns true
+        /// when the array changed (the tree is rebuilt before returning).
+        bool apply(std::shared_ptr<Simulation> sim);
+    };
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "utilities/defines.hpp"
+
+namespace sph
+{
+
+    struct SPHParameters;
+    struct SPHParticle;
+    class Simulation;
+
+    /**
+     * @brief Adaptive particle splitting and merging (adaptiveRefinement key)
+     *
+     * Particle mass is fixed at IC time, so flyby runs over-resolve the
+     * quiescent outer disk just to get the shock front right. This pass
+     * moves resolution to where the flow needs it instead: particles whose
+     * `shockSensor` exceeds the split threshold are replaced by 2*DIM
+     * children placed on the coordinate axes at 0.4 h, each carrying
+     * mass/(2*DIM) and h*(2*DIM)^{-1/DIM} — mass, momentum and the center
+     * of mass are conserved exactly by the symmetric placement. In return,
+     * a quiescent particle (sensor below the merge threshold) collapses
+     * with its nearest quiescent neighbor inside half a smoothing length
+     * into their center of mass: summed mass, mass-weighted velocity, and
+     * the kinetic energy lost to the velocity average is returned to
+     * internal energy, so mass, momentum and total energy are conserved.
+     *
+     * Mass bounds keep the cascade finite: both are multiples of the median
+     * fluid mass measured on the first pass, children below the lower bound
+     * never split again and merges never exceed the upper bound. The pass
+     * runs at the end of an interval-th step, compacts the array, restores
+     * the id == index convention and rebuilds the tree, so the next step
+     * starts from a consistent state. Checkpoints store whatever particle
+     * count is current, so resume needs no special casing; MPI runs are not
+     * supported (pairs straddling a slab boundary cannot merge) and the
+     * solver disables the pass under decomposition.
+     */
+    class ParticleRefinement
+    {
+        bool m_enabled = false;
+        real m_split_threshold = 0.0;
+        real m_merge_threshold = 0.0;
+        int m_interval = 1;
+        real m_min_mass_factor = 0.0;
+        real m_max_mass_factor = 0.0;
+        real m_min_mass = 0.0; // absolute bounds, resolved from the median
+        real m_max_mass = 0.0; // fluid mass on the first pass
+        int m_neighbor_number = 32;
+        int m_step = 0;
+
+        void resolve_mass_bounds(const std::vector<SPHParticle> &particles, int num);
+
+    public:
+        void initialize(std::shared_ptr<SPHParameters> param);
+        bool enabled() const { return m_enabled; }
+
+        /// Run one split/merge pass if this step is due; returns true when
+        /// the particle array changed (the tree is rebuilt before returning).
+        bool apply(std::shared_ptr<Simulation> sim);
+    };
+
+}
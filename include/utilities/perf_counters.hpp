@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string>
+
+#include "utilities/defines.hpp"
+
+#ifdef USE_PERF_COUNTERS
+#include <fstream>
+#include <vector>
+#endif
+
+namespace sph
+{
+
+    /**
+     * @brief Hardware performance counters for the hot kernels
+     *
+     * Wall-clock timing (StepTimer) says which module is slow; it cannot say
+     * whether a FluidForce change is bandwidth- or compute-bound. When built
+     * with -DUSE_PERF_COUNTERS=ON this class scopes perf_event counters
+     * (instructions, L1D read misses, LLC misses) around the phases the
+     * solver selects and appends one CSV row per step — columns per phase,
+     * plus LLC-miss bytes per interaction pair — next to the timing log.
+     *
+     * Counters are read on the calling thread only: the OpenMP pool exists
+     * before the fds are opened, so inheritance cannot cover it. With the
+     * static loop partition the master thread's share is representative,
+     * and the per-pair and per-instruction ratios are what the analysis
+     * needs. Without the build flag every member is an empty inline and the
+     * instrumentation compiles out entirely.
+     */
+    class PerfCounters
+    {
+#ifdef USE_PERF_COUNTERS
+        struct Phase
+        {
+            std::string name;
+            long long instructions = 0;
+            long long l1d_miss = 0;
+            long long llc_miss = 0;
+        };
+
+        std::ofstream m_out;
+        bool m_enabled = false;
+        bool m_header_written = false;
+        real m_step_time = 0.0;
+        long m_pairs = 0;
+        std::vector<Phase> m_phases;
+        int m_fd[3] = {-1, -1, -1}; // instructions, L1D read miss, LLC miss
+
+        Phase &slot(const char *phase);
+        void read_now(long long value[3]) const;
+
+    public:
+        ~PerfCounters();
+
+        void enable(const std::string &csv_path);
+        bool enabled() const { return m_enabled; }
+
+        void begin_step(const real time);
+        /// Interaction pairs this step, the denominator for bytes-per-pair.
+        void set_pairs(const long pairs) { m_pairs = pairs; }
+        void record(const char *phase, const long long delta[3]);
+        void end_step();
+
+        /// Scoped guard: counts from construction to destruction.
+        class Scope
+        {
+            PerfCounters &m_counters;
+            const char *m_phase;
+            long long m_start[3];
+
+        public:
+            Scope(PerfCounters &counters, const char *phase)
+                : m_counters(counters), m_phase(phase)
+            {
+                if (m_counters.enabled())
+                {
+                    m_counters.read_now(m_start);
+                }
+            }
+            ~Scope()
+            {
+                if (m_counters.enabled())
+                {
+                    long long now[3];
+                    m_counters.read_now(now);
+                    const long long delta[3] = {now[0] - m_start[0],
+                                                now[1] - m_start[1],
+                                                now[2] - m_start[2]};
+                    m_counters.record(m_phase, delta);
+                }
+            }
+        };
+#else
+    public:
+        void enable(const std::string &) {}
+        constexpr bool enabled() const { return false; }
+        void begin_step(const real) {}
+        void set_pairs(const long) {}
+        void end_step() {}
+
+        class Scope
+        {
+        public:
+            Scope(PerfCounters &, const char *) {}
+        };
+#endif
+    };
+
+}
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <memory>
-#include <cassert>
+#include <cmath>
 
 #include "utilities/vector_type.hpp"
 #include "core/parameters.hpp"
@@ -9,65 +9,79 @@
 namespace sph
 {
 
+// Periodic boundary math. The wrap and minimum-image formulas are
+// branchless — range widths and their reciprocals are precomputed at
+// initialize() and the per-component comparisons are replaced by
+// floor/nearbyint, which the compiler lowers to round instructions — so the
+// inner loops that inline them auto-vectorize instead of branching per
+// component. Callers that run per particle hoist the enabled() test out of
+// the loop (the predict loop folds it out at compile time).
 class Periodic {
     bool m_is_valid;
+    bool m_use_ghosts; // image particles handle wrap-around; pair math stays plain
     vec_t m_max;
     vec_t m_min;
     vec_t m_range;
+    vec_t m_inv_range;
 
 public:
-    Periodic() : m_is_valid(false) {}
+    Periodic() : m_is_valid(false), m_use_ghosts(false) {}
     void initialize(std::shared_ptr<SPHParameters> param)
     {
         if(param->periodic.is_valid) {
             m_is_valid = true;
+            m_use_ghosts = param->periodic.use_ghosts;
             for(int i = 0; i < DIM; ++i) {
                 m_max[i] = param->periodic.range_max[i];
                 m_min[i] = param->periodic.range_min[i];
             }
             m_range = m_max - m_min;
+            for(int i = 0; i < DIM; ++i) {
+                m_inv_range[i] = 1.0 / m_range[i];
+            }
         } else {
             m_is_valid = false;
+            m_use_ghosts = false;
         }
     }
 
-    vec_t calc_r_ij(const vec_t & r_i, const vec_t & r_j) const
-    {
-        if(m_is_valid) {
-            const vec_t r_ij1 = r_i - r_j;
-            const vec_t r_ij2 = r_ij1 + m_range;
-            const vec_t r_ij3 = r_ij1 - m_range;
-            vec_t r_ij;
+    bool enabled() const { return m_is_valid; }
 
-            #define R_IJ(a, b, c)\
-                if(std::abs(r_ij##a[i]) <= std::abs(r_ij##b[i]) && std::abs(r_ij##a[i]) <= std::abs(r_ij##c[i])) {\
-                    r_ij[i] = r_ij##a[i];\
-                    continue;\
-                }
+    // True when pair separations need the minimum-image convention (periodic
+    // domain without ghost images). Batched distance loops hoist this test
+    // and the range out of their inner loops instead of branching per pair.
+    bool min_image() const { return m_is_valid && !m_use_ghosts; }
+    const vec_t & range() const { return m_range; }
 
+    vec_t calc_r_ij(const vec_t & r_i, const vec_t & r_j) const
+    {
+        if(m_is_valid && !m_use_ghosts) {
+            // Minimum image without comparisons: subtract the nearest whole
+            // number of periods (nearbyint lowers to a round instruction).
+            vec_t r_ij = r_i - r_j;
             for(int i = 0; i < DIM; ++i) {
-                R_IJ(1, 2, 3);
-                R_IJ(2, 3, 1);
-                R_IJ(3, 1, 2);
-                assert(false);
+                r_ij[i] -= m_range[i] * std::nearbyint(r_ij[i] * m_inv_range[i]);
             }
-
             return r_ij;
         } else {
             return r_i - r_j;
         }
     }
 
+    // Branchless canonicalization into [min, max); assumes the domain is
+    // periodic — per-particle loops hoist the enabled() test instead of
+    // paying a validity branch per call.
+    void wrap(vec_t & r) const
+    {
+        for(int i = 0; i < DIM; ++i) {
+            r[i] -= m_range[i] * std::floor((r[i] - m_min[i]) * m_inv_range[i]);
+        }
+    }
+
     void apply(vec_t & r) const
     {
         if(m_is_valid) {
-            for(int i = 0; i < DIM; ++i) {
-                if(r[i] < m_min[i]) {
-                    r[i] += m_range[i];
-                } else if(r[i] > m_max[i]) {
-                    r[i] -= m_range[i];
-                }
-            }
+            wrap(r);
         }
     }
 };
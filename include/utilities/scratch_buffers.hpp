@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "utilities/defines.hpp"
+#include "utilities/memory_footprint.hpp"
+
+namespace sph
+{
+
+// Reusable per-thread scratch storage for the neighbor lists built inside the
+// OpenMP force/pre-interaction loops. Allocating a fresh std::vector<int> for
+// every particle in every module each step generates heavy allocator traffic;
+// instead each thread keeps one buffer alive across iterations and steps and
+// only grows it when a larger capacity is requested.
+inline std::vector<int> & scratch_neighbor_buffer(const int min_size)
+{
+    static thread_local std::vector<int> buffer;
+    if(static_cast<int>(buffer.size()) < min_size) {
+        // growth is geometric and rare, so the accounting stays off the hot path
+        MemoryFootprint::add("thread_scratch", (min_size - static_cast<long>(buffer.size())) * static_cast<long>(sizeof(int)));
+        buffer.resize(min_size);
+    }
+    return buffer;
+}
+
+// Capacity seed for a particle's neighbor list: twice the count the particle
+// saw last step, floored at four times the target neighbor number (covering
+// the first step, when `neighbor` is still zero). Truncation is impossible
+// regardless of the seed because neighbor_search_adaptive() grows the buffer
+// and retries on overflow, so this replaces the globally inflated
+// m_neighbor_number * neighbor_list_size sizing in the hot loops.
+inline int seeded_neighbor_capacity(const int last_count, const int neighbor_number)
+{
+    return std::max(2 * last_count, 4 * neighbor_number);
+}
+
+// Per-thread real-valued scratch arrays for the batched kernel evaluation
+// paths: distances, masses and kernel values staged contiguously so the
+// w_batch/dhw_batch loops can vectorize. `slot` distinguishes the arrays a
+// single loop body needs alive at the same time; like the neighbor buffer,
+// each slot grows monotonically and is reused across iterations and steps.
+inline std::vector<real> & scratch_real_buffer(const int slot, const int min_size)
+{
+    static thread_local std::vector<real> buffers[6];
+    auto & buffer = buffers[slot];
+    if(static_cast<int>(buffer.size()) < min_size) {
+        MemoryFootprint::add("thread_scratch", (min_size - static_cast<long>(buffer.size())) * static_cast<long>(sizeof(real)));
+        buffer.resize(min_size);
+    }
+    return buffer;
+}
+
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <memory>
 
+#include "utilities/defines.hpp"
+
 namespace sph
 {
 
@@ -15,13 +17,23 @@ namespace sph
     /// It then estimates the Mach number based on the pressure jump and stores
     /// the result in the particle’s `shockSensor` field.
     ///
+    /// With a positive \p refresh_threshold the detection is incremental:
+    /// each particle remembers the density, pressure and neighbor count of
+    /// its last full evaluation, and is skipped (keeping its previous
+    /// `shockSensor`) while its relative density and pressure drift stay
+    /// below the threshold and the neighbor count is unchanged. Shock fronts
+    /// drive large local changes, so only the particles near them refresh.
+    ///
     /// \param sim         Shared pointer to the Simulation object.
     /// \param periodic    Raw pointer to the Periodic object from the simulation.
     /// \param gamma_val   The adiabatic index for the fluid.
     /// \param h_factor    A multiplier on the smoothing length (default is 1.0).
+    /// \param refresh_threshold  Relative drift that forces re-evaluation
+    ///                    (0 = evaluate every particle every step).
     void detect_shocks(std::shared_ptr<Simulation> sim,
                        const Periodic *periodic,
-                       double gamma_val,
-                       double h_factor = 1.0);
+                       real gamma_val,
+                       real h_factor = 1.0,
+                       real refresh_threshold = 0.0);
 
 } // namespace sph
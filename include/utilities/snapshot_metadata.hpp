@@ -24,9 +24,28 @@ namespace sph
             : name(n), unit(u), description(d) {}
     };
 
+    /**
+     * @brief Per-column streaming statistics carried in the metadata sidecar
+     *
+     * Mirrors the statistics the serialization stage gathers during the
+     * unit-conversion pass, so run triage (min/max density, total mass,
+     * "did NaNs appear?") is a small JSON read instead of a snapshot scan.
+     * The moments cover the finite entries only; NaN/Inf are counted.
+     */
+    struct ColumnStatsMetadata
+    {
+        std::string name;
+        double min = 0.0;
+        double max = 0.0;
+        double mean = 0.0;
+        double l2 = 0.0;     // L2 norm, sqrt(sum of squares)
+        long long nan_count = 0;
+        long long inf_count = 0;
+    };
+
     /**
      * @brief Snapshot metadata for CSV output files
-     * 
+     *
      * Contains all metadata for a snapshot including simulation state,
      * unit system, and column descriptions. This is serialized to JSON
      * as a sidecar file alongside the CSV output.
@@ -69,7 +88,11 @@ namespace sph
         
         // Column descriptions
         std::vector<ColumnMetadata> columns;
-        
+
+        // Per-column statistics for this snapshot (empty when the writer
+        // did not supply any, e.g. metadata synthesized by the reader)
+        std::vector<ColumnStatsMetadata> column_stats;
+
         /**
          * @brief Construct metadata from unit system
          */
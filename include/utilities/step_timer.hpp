@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utilities/defines.hpp"
+
+namespace sph
+{
+
+    /**
+     * @brief Per-module, per-step timing log
+     *
+     * Accumulates wall-clock time per named phase (tree build, each module,
+     * output, ...) over one step and appends a CSV row per step to a timing
+     * file in the run directory. Phases are columns, in the order they are
+     * first recorded; the header is written with the first row. When the
+     * timer is not enabled every call is a cheap flag check, so leaving the
+     * instrumentation compiled in costs nothing in production runs.
+     */
+    class StepTimer
+    {
+        using clock = std::chrono::steady_clock;
+
+        std::ofstream m_out;
+        bool m_enabled = false;
+        bool m_header_written = false;
+        real m_step_time = 0.0;
+        std::vector<std::pair<std::string, double>> m_phases; // name, ms
+        std::vector<std::pair<std::string, double>> m_totals; // name, ms since reset_totals()
+
+        double &slot(const char *phase);
+
+    public:
+        void enable(const std::string &csv_path);
+        bool enabled() const { return m_enabled; }
+
+        void begin_step(const real time);
+        void record(const char *phase, const double ms);
+        void end_step();
+
+        // Per-phase totals accumulated across steps, for aggregate reports
+        // (the scaling harness sums each configuration's steps this way).
+        void reset_totals() { m_totals.clear(); }
+        const std::vector<std::pair<std::string, double>> &totals() const { return m_totals; }
+
+        /// Scoped guard: times from construction to destruction.
+        class Scope
+        {
+            StepTimer &m_timer;
+            const char *m_phase;
+            clock::time_point m_start;
+
+        public:
+            Scope(StepTimer &timer, const char *phase)
+                : m_timer(timer), m_phase(phase)
+            {
+                if (m_timer.enabled())
+                {
+                    m_start = clock::now();
+                }
+            }
+            ~Scope()
+            {
+                if (m_timer.enabled())
+                {
+                    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - m_start);
+                    m_timer.record(m_phase, elapsed.count() * 1e-3);
+                }
+            }
+        };
+    };
+
+}
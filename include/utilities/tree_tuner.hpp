@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utilities/defines.hpp"
+
+namespace sph
+{
+
+    struct SPHParameters;
+
+    /**
+     * @brief Auto-tuner for the tree construction parameters (treeAutoTune)
+     *
+     * leafParticleNumber defaults to 1, which maximizes tree depth and node
+     * count — pessimal for neighbor-search-heavy runs — but the best value
+     * shifts with N, DIM and clustering, so no static default is right. With
+     * treeAutoTune on, the first steps of the run sweep a small set of leaf
+     * sizes, timing whole integration steps with each (the tree build and
+     * every walk that depends on it are all inside that window), then lock
+     * in the cheapest candidate for the rest of the run. The sweep and the
+     * choice are written to tree_tuning.json in the run directory, so the
+     * winning value can be pinned via leafParticleNumber on later runs.
+     *
+     * The cell-list engine has no tree depth to tune, so the tuner disables
+     * itself when useCellList is set.
+     */
+    class TreeTuner
+    {
+    public:
+        void initialize(std::shared_ptr<SPHParameters> param);
+        bool enabled() const { return m_enabled; }
+        bool finished() const { return m_finished; }
+
+        /// Report destination (tree_tuning.json in the run directory).
+        void set_report_path(const std::string &path) { m_report_path = path; }
+
+        /// Starts the wall clock for this step.
+        void begin_step();
+
+        /// Accounts the finished step to the current candidate. Returns true
+        /// when the tuner just changed param->tree.leaf_particle_num — the
+        /// caller then re-initializes the tree and forces a rebuild.
+        bool end_step(std::shared_ptr<SPHParameters> param);
+
+        int chosen_leaf_size() const { return m_chosen; }
+
+    private:
+        // one settle step absorbs the rebuild cost after each switch, then
+        // the measured steps accumulate
+        static constexpr int SETTLE_STEPS = 1;
+        static constexpr int MEASURE_STEPS = 3;
+
+        void write_report() const;
+
+        bool m_enabled = false;
+        bool m_finished = false;
+        std::vector<int> m_candidates;
+        std::vector<double> m_cost; // summed step seconds per candidate
+        int m_current = 0;
+        int m_settle_left = SETTLE_STEPS;
+        int m_measured = 0;
+        int m_chosen = 0;
+        double m_t0 = 0.0;
+        std::string m_report_path;
+    };
+
+}
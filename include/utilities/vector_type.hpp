@@ -2,9 +2,20 @@
 #include "utilities/defines.hpp"
 #include <cmath>
 
-class vec_t
+// SIMD lane count of the vector storage: DIM padded up to the next power of
+// two so a whole vec_t fits one aligned SIMD register (2 lanes at DIM=2 with
+// 64-bit reals, 4 at DIM=3). The pad lane at DIM=3 is zero-initialized and
+// carried through the elementwise operators, but never read back: reductions
+// (inner_product/abs2/vector_product) touch the first DIM lanes only.
+#if DIM == 3
+#define SPH_VEC_LANES 4
+#else
+#define SPH_VEC_LANES DIM
+#endif
+
+class alignas(sizeof(real) * SPH_VEC_LANES) vec_t
 {
-    real vec[DIM];
+    real vec[SPH_VEC_LANES];
 
 public:
     // Constructor
@@ -25,19 +36,24 @@ public:
         vec[0] = x;
         vec[1] = y;
         vec[2] = z;
+        vec[3] = 0;
     }
 #endif
 
     vec_t(const vec_t &a)
     {
-        for (int i = 0; i < DIM; ++i)
-            vec[i] = a[i];
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            vec[i] = a.vec[i];
     }
 
     vec_t(const real (&a)[DIM])
     {
         for (int i = 0; i < DIM; ++i)
             vec[i] = a[i];
+#if DIM != SPH_VEC_LANES
+        vec[DIM] = 0;
+#endif
     }
 
     // Operator
@@ -46,8 +62,9 @@ public:
 
     vec_t &operator=(const vec_t &a)
     {
-        for (int i = 0; i < DIM; ++i)
-            vec[i] = a[i];
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            vec[i] = a.vec[i];
         return *this;
     }
 
@@ -60,7 +77,8 @@ public:
 
     vec_t &operator=(const real a)
     {
-        for (int i = 0; i < DIM; ++i)
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
             vec[i] = a;
         return *this;
     }
@@ -69,20 +87,19 @@ public:
 
     const vec_t operator-() const
     {
-#if DIM == 1
-        return vec_t(-vec[0]);
-#elif DIM == 2
-        return vec_t(-vec[0], -vec[1]);
-#elif DIM == 3
-        return vec_t(-vec[0], -vec[1], -vec[2]);
-#endif
+        vec_t r;
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            r.vec[i] = -vec[i];
+        return r;
     }
 
     // +=
     vec_t &operator+=(const vec_t &a)
     {
-        for (int i = 0; i < DIM; ++i)
-            vec[i] += a[i];
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            vec[i] += a.vec[i];
         return *this;
     }
 
@@ -95,7 +112,8 @@ public:
 
     vec_t &operator+=(const real a)
     {
-        for (int i = 0; i < DIM; ++i)
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
             vec[i] += a;
         return *this;
     }
@@ -103,8 +121,9 @@ public:
     // -=
     vec_t &operator-=(const vec_t &a)
     {
-        for (int i = 0; i < DIM; ++i)
-            vec[i] -= a[i];
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            vec[i] -= a.vec[i];
         return *this;
     }
 
@@ -117,21 +136,24 @@ public:
 
     vec_t &operator-=(const real a)
     {
-        for (int i = 0; i < DIM; ++i)
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
             vec[i] -= a;
         return *this;
     }
 
     vec_t &operator*=(const real a)
     {
-        for (int i = 0; i < DIM; ++i)
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
             vec[i] *= a;
         return *this;
     }
 
     vec_t &operator/=(const real a)
     {
-        for (int i = 0; i < DIM; ++i)
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
             vec[i] /= a;
         return *this;
     }
@@ -139,96 +161,128 @@ public:
     // +
     vec_t operator+(const vec_t &a) const
     {
-#if DIM == 1
-        return vec_t(vec[0] + a[0]);
-#elif DIM == 2
-        return vec_t(vec[0] + a[0], vec[1] + a[1]);
-#elif DIM == 3
-        return vec_t(vec[0] + a[0], vec[1] + a[1], vec[2] + a[2]);
-#endif
+        vec_t r;
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            r.vec[i] = vec[i] + a.vec[i];
+        return r;
     }
 
     vec_t operator+(const real (&a)[DIM]) const
     {
-#if DIM == 1
-        return vec_t(vec[0] + a[0]);
-#elif DIM == 2
-        return vec_t(vec[0] + a[0], vec[1] + a[1]);
-#elif DIM == 3
-        return vec_t(vec[0] + a[0], vec[1] + a[1], vec[2] + a[2]);
-#endif
+        vec_t r(*this);
+        for (int i = 0; i < DIM; ++i)
+            r.vec[i] += a[i];
+        return r;
     }
 
     vec_t operator+(const real a) const
     {
-#if DIM == 1
-        return vec_t(vec[0] + a);
-#elif DIM == 2
-        return vec_t(vec[0] + a, vec[1] + a);
-#elif DIM == 3
-        return vec_t(vec[0] + a, vec[1] + a, vec[2] + a);
-#endif
+        vec_t r;
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            r.vec[i] = vec[i] + a;
+        return r;
     }
 
     // -
     vec_t operator-(const vec_t &a) const
     {
-#if DIM == 1
-        return vec_t(vec[0] - a[0]);
-#elif DIM == 2
-        return vec_t(vec[0] - a[0], vec[1] - a[1]);
-#elif DIM == 3
-        return vec_t(vec[0] - a[0], vec[1] - a[1], vec[2] - a[2]);
-#endif
+        vec_t r;
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            r.vec[i] = vec[i] - a.vec[i];
+        return r;
     }
 
     vec_t operator-(const real (&a)[DIM]) const
     {
-#if DIM == 1
-        return vec_t(vec[0] - a[0]);
-#elif DIM == 2
-        return vec_t(vec[0] - a[0], vec[1] - a[1]);
-#elif DIM == 3
-        return vec_t(vec[0] - a[0], vec[1] - a[1], vec[2] - a[2]);
-#endif
+        vec_t r(*this);
+        for (int i = 0; i < DIM; ++i)
+            r.vec[i] -= a[i];
+        return r;
     }
 
     vec_t operator-(const real a) const
     {
-#if DIM == 1
-        return vec_t(vec[0] - a);
-#elif DIM == 2
-        return vec_t(vec[0] - a, vec[1] - a);
-#elif DIM == 3
-        return vec_t(vec[0] - a, vec[1] - a, vec[2] - a);
-#endif
+        vec_t r;
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            r.vec[i] = vec[i] - a;
+        return r;
     }
 
     vec_t operator*(const real a) const
     {
-#if DIM == 1
-        return vec_t(vec[0] * a);
-#elif DIM == 2
-        return vec_t(vec[0] * a, vec[1] * a);
-#elif DIM == 3
-        return vec_t(vec[0] * a, vec[1] * a, vec[2] * a);
-#endif
+        vec_t r;
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            r.vec[i] = vec[i] * a;
+        return r;
     }
 
     vec_t operator/(const real a) const
     {
-#if DIM == 1
-        return vec_t(vec[0] / a);
-#elif DIM == 2
-        return vec_t(vec[0] / a, vec[1] / a);
-#elif DIM == 3
-        return vec_t(vec[0] / a, vec[1] / a, vec[2] / a);
-#endif
+        vec_t r;
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            r.vec[i] = vec[i] / a;
+        return r;
     }
 
     const real *get_array() const { return vec; }
 };
 
+// Accumulator companion of vec_t: the same component array with accum_t
+// components. In the mixed-precision build the per-particle pair sums run
+// through this type and are rounded to real once on the final store; in the
+// uniform-precision builds it is vec_t itself.
+#if defined(SPH_PRECISION_MIXED)
+class alignas(sizeof(accum_t) * SPH_VEC_LANES) acc_vec_t
+{
+    accum_t vec[SPH_VEC_LANES];
+
+public:
+    acc_vec_t(const accum_t a = 0.0)
+    {
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            vec[i] = a;
+    }
+
+    accum_t &operator[](const int i) { return vec[i]; }
+    const accum_t &operator[](const int i) const { return vec[i]; }
+
+    acc_vec_t &operator+=(const vec_t &a)
+    {
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            vec[i] += a[i];
+        return *this;
+    }
+
+    acc_vec_t &operator-=(const vec_t &a)
+    {
+#pragma omp simd
+        for (int i = 0; i < SPH_VEC_LANES; ++i)
+            vec[i] -= a[i];
+        return *this;
+    }
+
+    operator vec_t() const
+    {
+        vec_t v;
+        for (int i = 0; i < DIM; ++i)
+            v[i] = static_cast<real>(vec[i]);
+        return v;
+    }
+};
+#else
+typedef vec_t acc_vec_t;
+#endif
+
+// Reductions read the first DIM lanes only, so the DIM=3 pad lane never
+// contributes regardless of what the elementwise operators left in it.
 inline real inner_product(const vec_t &a, const vec_t &b)
 {
 #if DIM == 1
@@ -267,6 +321,15 @@ inline real abs2(const vec_t &a)
     return inner_product(a, a);
 }
 
+// y += x * a without materializing the scaled temporary (the accumulation
+// form of the force kernels).
+inline void axpy(vec_t &y, const vec_t &x, const real a)
+{
+#pragma omp simd
+    for (int i = 0; i < DIM; ++i)
+        y[i] += x[i] * a;
+}
+
 namespace std
 {
     inline ::real abs(const vec_t &a)
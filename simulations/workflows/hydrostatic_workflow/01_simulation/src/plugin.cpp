@@ -95,7 +95,7 @@ public:
             }
         }
         
-        sim->set_particles(particles);
+        sim->set_particles(std::move(particles));
         sim->set_particle_num(num);
         
         // Set simulation parameters
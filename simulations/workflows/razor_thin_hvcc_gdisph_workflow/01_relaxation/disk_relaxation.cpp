@@ -219,8 +219,8 @@ public:
             particles.push_back(pp);
         }
         
-        sim->set_particles(particles);
         sim->set_particle_num(static_cast<int>(particles.size()));
+        sim->set_particles(std::move(particles));
         
         std::cout << "Initialization Complete:\n";
         std::cout << "  Central density:   ρ_c = " << rho_c << " (code units)\n";
@@ -155,8 +155,8 @@ public:
             particles.push_back(pp);
         }
         
-        sim->set_particles(particles);
         sim->set_particle_num(static_cast<int>(particles.size()));
+        sim->set_particles(std::move(particles));
         
         // Set simulation parameters for relaxation
         param->type = SPHType::DISPH;
@@ -148,7 +148,7 @@ public:
             p_i.volume = p_i.mass / p_i.dens;
         }
         
-        sim->set_particles(p);
+        sim->set_particles(std::move(p));
         sim->set_particle_num(N);
         
         std::cout << "Created " << N << " particles" << std::endl;
@@ -4,6 +4,7 @@
 #include "core/particle.hpp"
 #include "utilities/exception.hpp"
 #include "utilities/defines.hpp"
+#include "utilities/ic_toolkit.hpp"
 #include <iostream>
 #include <cmath>
 #include <vector>
@@ -67,61 +68,43 @@ public:
         // Energy injection region (central particles)
         const real r_inject = 2.5 * dx;  // Slightly larger for 2D
         
-        std::vector<SPHParticle> p(N);
-        int idx = 0;
-        
-        // Create uniform lattice
-        for (int i = 0; i < N_1D; ++i) {
-            for (int j = 0; j < N_1D; ++j) {
-                auto &p_i = p[idx];
-                
-                // Position: uniform grid
-                p_i.pos[0] = -0.5*L + (i + 0.5) * dx;
-                p_i.pos[1] = -0.5*L + (j + 0.5) * dx;
-#if DIM == 3
-                p_i.pos[2] = 0.0;
-#endif
-                
-                // Distance from center
-                real r = std::sqrt(p_i.pos[0]*p_i.pos[0] + p_i.pos[1]*p_i.pos[1]);
-                
-                // Velocity: initially zero
-                p_i.vel[0] = 0.0;
-                p_i.vel[1] = 0.0;
-#if DIM == 3
-                p_i.vel[2] = 0.0;
-#endif
-                
-                // Density and mass: uniform
-                p_i.dens = rho0;
-                p_i.mass = mass;
-                
-                // Pressure and energy: inject energy in central region
-                if (r < r_inject) {
-                    // Number of particles in injection region (approx)
-                    real A_inject = M_PI * r_inject * r_inject;  // Circular area
-                    int N_inject = static_cast<int>(A_inject / (dx*dx));
-                    if (N_inject < 1) N_inject = 1;
-                    
-                    // Distribute energy among central particles
-                    real e_inject = E0 / (N_inject * mass);
-                    p_i.ene = e_inject;
-                    p_i.pres = (gamma - 1.0) * p_i.dens * p_i.ene;
-                } else {
-                    // Background: low energy
-                    p_i.ene = 1.0e-6;
-                    p_i.pres = (gamma - 1.0) * p_i.dens * p_i.ene;
-                }
-                
-                p_i.id = idx;
-                p_i.volume = p_i.mass / p_i.dens;
-                
-                ++idx;
-            }
+        // Uniform lattice + profile, filled in parallel (see ic_toolkit.hpp)
+        vec_t box_min, box_max;
+        for (int d = 0; d < DIM; ++d) {
+            box_min[d] = -0.5*L;
+            box_max[d] = 0.5*L;
         }
+        ic::lattice(sim, box_min, box_max, N_1D,
+                    [=](SPHParticle &p_i) {
+            // Distance from center
+            real r = std::sqrt(abs2(p_i.pos));
+
+            // Velocity: initially zero
+            p_i.vel = vec_t(0.0);
+
+            // Density and mass: uniform
+            p_i.dens = rho0;
+            p_i.mass = mass;
+
+            // Pressure and energy: inject energy in central region
+            if (r < r_inject) {
+                // Number of particles in injection region (approx)
+                real A_inject = M_PI * r_inject * r_inject;  // Circular area
+                int N_inject = static_cast<int>(A_inject / (dx*dx));
+                if (N_inject < 1) N_inject = 1;
+
+                // Distribute energy among central particles
+                real e_inject = E0 / (N_inject * mass);
+                p_i.ene = e_inject;
+                p_i.pres = (gamma - 1.0) * p_i.dens * p_i.ene;
+            } else {
+                // Background: low energy
+                p_i.ene = 1.0e-6;
+                p_i.pres = (gamma - 1.0) * p_i.dens * p_i.ene;
+            }
 
-        sim->set_particles(p);
-        sim->set_particle_num(N);
+            p_i.volume = p_i.mass / p_i.dens;
+        });
         
         // Set simulation parameters for DISPH
         param->type = SPHType::DISPH;  // Use DISPH instead of GSPH
@@ -4,6 +4,7 @@
 #include "core/particle.hpp"
 #include "utilities/exception.hpp"
 #include "utilities/defines.hpp"
+#include "utilities/ic_toolkit.hpp"
 #include <iostream>
 #include <cmath>
 #include <vector>
@@ -50,28 +51,25 @@ public:
         const real domain_length = x_max - x_min;
         const real dx = domain_length / N;
 
-        std::vector<SPHParticle> p(N);
-
         // Physical parameters
         const real gamma = param->physics.gamma;
-        
+
         // Left state (x < 0)
         const real rho_L = 1.0;
         const real P_L = 1.0;
         const real v_L = 0.0;
-        
+
         // Right state (x > 0)
         const real rho_R = 0.125;
         const real P_R = 0.1;
         const real v_R = 0.0;
 
-        // Create particles
-        for (int i = 0; i < N; ++i) {
-            auto &p_i = p[i];
-            
-            // Position: uniform spacing
-            p_i.pos[0] = x_min + (i + 0.5) * dx;
-            
+        // Uniform lattice + profile, filled in parallel (see ic_toolkit.hpp)
+        vec_t box_min, box_max;
+        box_min[0] = x_min;
+        box_max[0] = x_max;
+        ic::lattice(sim, box_min, box_max, N,
+                    [=](SPHParticle &p_i) {
             // Set state based on position (discontinuity at x=0)
             if (p_i.pos[0] < 0.0) {
                 // Left state
@@ -86,16 +84,12 @@ public:
                 p_i.vel[0] = v_R;
                 p_i.mass = rho_R * dx;  // mass = ρ * dx in 1D
             }
-            
+
             p_i.ene = p_i.pres / ((gamma - 1.0) * p_i.dens);
-            p_i.id = i;
-            
+
             // Initialize volume element for DISPH: V = m/ρ
             p_i.volume = p_i.mass / p_i.dens;
-        }
-
-        sim->set_particles(p);
-        sim->set_particle_num(N);
+        });
         
         std::cout << "Created " << N << " particles\n";
         std::cout << "  Domain: [" << x_min << ", " << x_max << "]\n";
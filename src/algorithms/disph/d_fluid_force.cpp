@@ -6,6 +6,9 @@
 #include "tree/bhtree.hpp"
 #include "kernel/kernel_function.hpp"
 
+#include "utilities/scratch_buffers.hpp"
+#include "utilities/loop_scheduler.hpp"
+
 #ifdef EXHAUSTIVE_SEARCH
 #include "tree/exhaustive_search.hpp"
 #endif
@@ -27,19 +30,45 @@ namespace sph
         // Energy: du/dt = Σ m_j (P_i/V_i² + P_j/V_j²) v_ij · ∇W
         void FluidForce::calculation(std::shared_ptr<Simulation> sim)
         {
+            if (m_symmetrize)
+            {
+                calculation_symmetric(sim);
+                return;
+            }
+
+            // Pair-list pipeline: stream the precomputed geometry
+            if (sim->get_pair_list().is_valid())
+            {
+                calculation_pairs(sim);
+                return;
+            }
+
             auto &particles = sim->get_particles();
             auto *periodic = sim->get_periodic().get();
+#ifdef EXHAUSTIVE_SEARCH
             const int num = sim->get_particle_num();
+#endif
             auto *kernel = sim->get_kernel().get();
             auto *tree = sim->get_tree().get();
 
-#pragma omp parallel for
-            for (int i = 0; i < num; ++i)
+            sim->sync_particle_soa();
+            const auto &soa = sim->get_particle_soa();
+            const auto &neighbor_cache = sim->get_neighbor_cache();
+
+            // outer loop over the SPH (fluid + wall) index range: point
+            // masses never enter the sweep
+            const auto &sph = sim->sph_ids();
+            const int n_sph = static_cast<int>(sph.size());
+
+            LoopScheduler::Scope schedule(LoopScheduler::FLUID_FORCE);
+#pragma omp parallel for schedule(runtime)
+            for (int ii = 0; ii < n_sph; ++ii)
             {
+                const int i = sph[ii];
                 auto &p_i = particles[i];
-                if (p_i.is_point_mass)
+                if (!p_i.is_active)
                 {
-                    continue;
+                    continue; // block timesteps: forces stay frozen until the bin boundary
                 }
 
                 if (p_i.is_wall)
@@ -49,13 +78,26 @@ namespace sph
                     continue;
                 }
 
-                std::vector<int> neighbor_list(m_neighbor_number * neighbor_list_size);
+                const int *neighbor_ptr = nullptr;
+                int n_neighbor = 0;
 
-                // neighbor search
+                // neighbor list: reuse the per-step cache when available
 #ifdef EXHAUSTIVE_SEARCH
-                int const n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+                auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+                neighbor_ptr = neighbor_list.data();
 #else
-                int const n_neighbor = tree->neighbor_search(p_i, neighbor_list, particles, true);
+                if (neighbor_cache.is_valid())
+                {
+                    n_neighbor = neighbor_cache.neighbor_count(i);
+                    neighbor_ptr = neighbor_cache.neighbors(i);
+                }
+                else
+                {
+                    auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                    n_neighbor = tree->neighbor_search_adaptive(p_i, neighbor_list, particles, true);
+                    neighbor_ptr = neighbor_list.data();
+                }
 #endif
 
                 // Get particle i properties  
@@ -72,33 +114,32 @@ namespace sph
 
                 for (int n = 0; n < n_neighbor; ++n)
                 {
-                    int const j = neighbor_list[n];
-                    auto &p_j = particles[j];
-                    if (p_j.is_point_mass)
+                    int const j = neighbor_ptr[n];
+                    if (soa.is_point_mass[j])
                     {
                         continue;
                     }
 
-                    const vec_t r_ij = periodic->calc_r_ij(r_i, p_j.pos);
+                    const vec_t r_ij = periodic->calc_r_ij(r_i, soa.pos[j]);
                     const real r = std::abs(r_ij);
 
-                    if (r >= std::max(h_i, p_j.sml) || r == 0.0)
+                    if (r >= std::max(h_i, soa.sml[j]) || r == 0.0)
                     {
                         continue;
                     }
 
                     // Get kernel gradient
                     const vec_t dw_i = kernel->dw(r_ij, r, h_i);
-                    const vec_t dw_j = kernel->dw(r_ij, r, p_j.sml);
+                    const vec_t dw_j = kernel->dw(r_ij, r, soa.sml[j]);
                     
                     // Get particle j properties
-                    const real u_j = p_j.ene;  // Specific internal energy
-                    const real q_j = p_j.pres / (m_gamma - 1.0);  // Internal energy density  
-                    const real U_j = p_j.mass * u_j;  // Total internal energy
-                    const real gradh_j = p_j.gradh;  // grad-h correction term
+                    const real u_j = soa.ene[j];  // Specific internal energy
+                    const real q_j = soa.pres[j] / (m_gamma - 1.0);  // Internal energy density  
+                    const real U_j = soa.mass[j] * u_j;  // Total internal energy
+                    const real gradh_j = soa.gradh[j];  // grad-h correction term
                     
                     // Velocity difference for energy
-                    const vec_t v_ij = v_i - p_j.vel;
+                    const vec_t v_ij = v_i - soa.vel[j];
                     
                     // DISPH momentum equation (38):
                     // dv_i/dt = -(γ-1) * Σ_j u_i*U_j * [gradh_i*∇W_ij(h_i)/q_i + gradh_j*∇W_ij(h_j)/q_j]
@@ -114,19 +155,125 @@ namespace sph
                     dene += ene_coef * inner_product(v_ij, dw_i);
                     
                     // Artificial viscosity (if enabled)
-                    const real pi_ij = artificial_viscosity(p_i, p_j, r_ij);
+                    const real pi_ij = artificial_viscosity(soa, i, j, r_ij);
                     if (pi_ij != 0.0)
                     {
                         const vec_t dw_ij = (dw_i + dw_j) * 0.5;
-                        acc -= dw_ij * (p_j.mass * 0.5 * pi_ij);
-                        dene += p_j.mass * 0.5 * pi_ij * inner_product(v_ij, dw_ij);
+                        acc -= dw_ij * (soa.mass[j] * 0.5 * pi_ij);
+                        dene += soa.mass[j] * 0.5 * pi_ij * inner_product(v_ij, dw_ij);
                     }
                     
                     // Artificial conductivity (if enabled)
                     if (m_use_ac)
                     {
                         const vec_t dw_ij = (dw_i + dw_j) * 0.5;
-                        const real dene_ac = artificial_conductivity(p_i, p_j, r_ij, dw_ij);
+                        const real dene_ac = artificial_conductivity(soa, i, j, r_ij, dw_ij);
+                        if (dene_ac != 0.0)
+                        {
+                            dene += dene_ac;
+                        }
+                    }
+                }
+
+                p_i.acc = acc;
+                p_i.dene = dene;
+            }
+        }
+
+        // Gather loop over the PairList stream: the physics of the plain
+        // loop above with the separation, distance and kernel gradients read
+        // from the per-step pair-geometry stage instead of recomputed.
+        void FluidForce::calculation_pairs(std::shared_ptr<Simulation> sim)
+        {
+            auto &particles = sim->get_particles();
+
+            sim->sync_particle_soa();
+            const auto &soa = sim->get_particle_soa();
+            const auto &neighbor_cache = sim->get_neighbor_cache();
+            const auto &pairs = sim->get_pair_list();
+
+            const auto &sph = sim->sph_ids();
+            const int n_sph = static_cast<int>(sph.size());
+
+            LoopScheduler::Scope schedule(LoopScheduler::FLUID_FORCE);
+#pragma omp parallel for schedule(runtime)
+            for (int ii = 0; ii < n_sph; ++ii)
+            {
+                const int i = sph[ii];
+                auto &p_i = particles[i];
+                if (!p_i.is_active)
+                {
+                    continue; // block timesteps: forces stay frozen until the bin boundary
+                }
+
+                if (p_i.is_wall)
+                {
+                    p_i.acc = 0.0;
+                    p_i.dene = 0.0;
+                    continue;
+                }
+
+                const int *neighbor_ptr = neighbor_cache.neighbors(i);
+                const int n_neighbor = neighbor_cache.neighbor_count(i);
+                const int base = neighbor_cache.first(i);
+
+                const vec_t &v_i = p_i.vel;
+                const real h_i = p_i.sml;
+                const real u_i = p_i.ene;
+                const real q_i = p_i.pres / (m_gamma - 1.0);
+                const real U_i = p_i.mass * u_i;
+                const real gradh_i = p_i.gradh;
+
+                vec_t acc(0.0);
+                real dene = 0.0;
+
+                for (int n = 0; n < n_neighbor; ++n)
+                {
+                    int const j = neighbor_ptr[n];
+                    if (soa.is_point_mass[j])
+                    {
+                        continue;
+                    }
+
+                    const int e = base + n;
+                    const real r = pairs.r(e);
+
+                    if (r >= std::max(h_i, soa.sml[j]) || r == 0.0)
+                    {
+                        continue;
+                    }
+
+                    const vec_t &r_ij = pairs.r_ij(e);
+                    const vec_t &dw_i = pairs.dw_i(e);
+                    const vec_t &dw_j = pairs.dw_j(e);
+
+                    const real u_j = soa.ene[j];
+                    const real q_j = soa.pres[j] / (m_gamma - 1.0);
+                    const real U_j = soa.mass[j] * u_j;
+                    const real gradh_j = soa.gradh[j];
+
+                    const vec_t v_ij = v_i - soa.vel[j];
+
+                    const real coef = (m_gamma - 1.0) * u_i * U_j;
+                    const real term_i = coef * gradh_i / q_i;
+                    const real term_j = coef * gradh_j / q_j;
+                    acc -= dw_i * term_i + dw_j * term_j;
+
+                    const real ene_coef = (m_gamma - 1.0) * gradh_i * U_i * U_j / (q_i * p_i.mass);
+                    dene += ene_coef * inner_product(v_ij, dw_i);
+
+                    const real pi_ij = artificial_viscosity(soa, i, j, r_ij);
+                    if (pi_ij != 0.0)
+                    {
+                        const vec_t dw_ij = (dw_i + dw_j) * 0.5;
+                        acc -= dw_ij * (soa.mass[j] * 0.5 * pi_ij);
+                        dene += soa.mass[j] * 0.5 * pi_ij * inner_product(v_ij, dw_ij);
+                    }
+
+                    if (m_use_ac)
+                    {
+                        const vec_t dw_ij = (dw_i + dw_j) * 0.5;
+                        const real dene_ac = artificial_conductivity(soa, i, j, r_ij, dw_ij);
                         if (dene_ac != 0.0)
                         {
                             dene += dene_ac;
@@ -138,5 +285,177 @@ namespace sph
                 p_i.dene = dene;
             }
         }
+
+        // Pair-once variant of the loop above: the momentum kernel
+        //   S = (γ-1) u_i u_j [gradh_i ∇W(h_i)/q_i + gradh_j ∇W(h_j)/q_j]
+        // is shared by the pair (acc_i -= m_j S, acc_j += m_i S), and the
+        // energy/viscosity mirrors follow from ∇W and v_ij flipping sign
+        // together under i<->j. Wall particles never own a pair and never
+        // receive a scatter, matching the zeroed forces of the plain loop.
+        void FluidForce::calculation_symmetric(std::shared_ptr<Simulation> sim)
+        {
+            auto &particles = sim->get_particles();
+            auto *periodic = sim->get_periodic().get();
+            const int num = sim->get_particle_num();
+            auto *kernel = sim->get_kernel().get();
+            auto *tree = sim->get_tree().get();
+
+            sim->sync_particle_soa();
+            const auto &soa = sim->get_particle_soa();
+            const auto &neighbor_cache = sim->get_neighbor_cache();
+
+            m_pair_accum.reset(num);
+
+            // the pair-once sweep is owned by fluid particles only
+            const auto &fluid = sim->fluid_ids();
+            const int n_fluid = static_cast<int>(fluid.size());
+
+            LoopScheduler::Scope schedule(LoopScheduler::FLUID_FORCE);
+#pragma omp parallel
+            {
+                vec_t *acc_buf = m_pair_accum.acc();
+                real *dene_buf = m_pair_accum.dene();
+
+#pragma omp for schedule(runtime)
+                for (int ii = 0; ii < n_fluid; ++ii)
+                {
+                    const int i = fluid[ii];
+                    auto &p_i = particles[i];
+
+                    if (!p_i.is_active)
+                    {
+                        continue; // block timesteps: forces stay frozen until the bin boundary
+                    }
+
+                    const int *neighbor_ptr = nullptr;
+                    int n_neighbor = 0;
+
+                    // neighbor list: reuse the per-step cache when available
+#ifdef EXHAUSTIVE_SEARCH
+                    auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                    n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+                    neighbor_ptr = neighbor_list.data();
+#else
+                    if (neighbor_cache.is_valid())
+                    {
+                        n_neighbor = neighbor_cache.neighbor_count(i);
+                        neighbor_ptr = neighbor_cache.neighbors(i);
+                    }
+                    else
+                    {
+                        auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                        n_neighbor = tree->neighbor_search_adaptive(p_i, neighbor_list, particles, true);
+                        neighbor_ptr = neighbor_list.data();
+                    }
+#endif
+
+                    const vec_t &r_i = p_i.pos;
+                    const vec_t &v_i = p_i.vel;
+                    const real h_i = p_i.sml;
+                    const real u_i = p_i.ene;
+                    const real q_i = p_i.pres / (m_gamma - 1.0);
+                    const real gradh_i = p_i.gradh;
+
+                    for (int n = 0; n < n_neighbor; ++n)
+                    {
+                        int const j = neighbor_ptr[n];
+                        if (soa.is_point_mass[j])
+                        {
+                            continue;
+                        }
+
+                        // each pair is visited once: an active fluid j with
+                        // j < i owns it; wall and inactive j never loop here
+                        const bool fluid_j = soa.is_active[j] && !soa.is_wall[j];
+                        if (j < i && fluid_j)
+                        {
+                            continue;
+                        }
+
+                        const vec_t r_ij = periodic->calc_r_ij(r_i, soa.pos[j]);
+                        const real r = std::abs(r_ij);
+
+                        if (r >= std::max(h_i, soa.sml[j]) || r == 0.0)
+                        {
+                            continue;
+                        }
+
+                        const vec_t dw_i = kernel->dw(r_ij, r, h_i);
+                        const vec_t dw_j = kernel->dw(r_ij, r, soa.sml[j]);
+
+                        const real u_j = soa.ene[j];
+                        const real q_j = soa.pres[j] / (m_gamma - 1.0);
+                        const real gradh_j = soa.gradh[j];
+
+                        const vec_t v_ij = v_i - soa.vel[j];
+
+                        // shared momentum kernel; the pair masses are applied
+                        // at scatter time
+                        const real coef = (m_gamma - 1.0) * u_i * u_j;
+                        const vec_t pair_grad = dw_i * (coef * gradh_i / q_i) + dw_j * (coef * gradh_j / q_j);
+                        acc_buf[i] -= pair_grad * soa.mass[j];
+
+                        dene_buf[i] += coef * soa.mass[j] * gradh_i / q_i * inner_product(v_ij, dw_i);
+
+                        const real pi_ij = artificial_viscosity(soa, i, j, r_ij);
+                        vec_t dw_ij(0.0);
+                        if (pi_ij != 0.0)
+                        {
+                            dw_ij = (dw_i + dw_j) * 0.5;
+                            acc_buf[i] -= dw_ij * (soa.mass[j] * 0.5 * pi_ij);
+                            dene_buf[i] += soa.mass[j] * 0.5 * pi_ij * inner_product(v_ij, dw_ij);
+                        }
+
+                        real dene_ac = 0.0;
+                        if (m_use_ac)
+                        {
+                            const vec_t dw_ij_ac = (dw_i + dw_j) * 0.5;
+                            dene_ac = artificial_conductivity(soa, i, j, r_ij, dw_ij_ac);
+                            dene_buf[i] += dene_ac;
+                        }
+
+                        if (fluid_j)
+                        {
+                            acc_buf[j] += pair_grad * soa.mass[i];
+                            dene_buf[j] += coef * soa.mass[i] * gradh_j / q_j * inner_product(v_ij, dw_j);
+                            if (pi_ij != 0.0)
+                            {
+                                acc_buf[j] += dw_ij * (soa.mass[i] * 0.5 * pi_ij);
+                                dene_buf[j] += soa.mass[i] * 0.5 * pi_ij * inner_product(v_ij, dw_ij);
+                            }
+                            if (dene_ac != 0.0)
+                            {
+                                dene_buf[j] -= dene_ac * soa.mass[i] / soa.mass[j];
+                            }
+                        }
+                    }
+                }
+            }
+
+            m_pair_accum.reduce();
+            const vec_t *acc_total = m_pair_accum.acc_total();
+            const real *dene_total = m_pair_accum.dene_total();
+
+            const auto &sph = sim->sph_ids();
+            const int n_sph = static_cast<int>(sph.size());
+#pragma omp parallel for
+            for (int ii = 0; ii < n_sph; ++ii)
+            {
+                const int i = sph[ii];
+                auto &p_i = particles[i];
+                if (!p_i.is_active)
+                {
+                    continue;
+                }
+                if (p_i.is_wall)
+                {
+                    p_i.acc = 0.0;
+                    p_i.dene = 0.0;
+                    continue;
+                }
+                p_i.acc = acc_total[i];
+                p_i.dene = dene_total[i];
+            }
+        }
     }
 }
\ No newline at end of file
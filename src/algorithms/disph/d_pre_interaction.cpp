@@ -3,6 +3,7 @@
  * Modified for anisotropic 3D kernel support (DISPH version)
  * ================================ */
 #include <algorithm>
+#include <limits>
 #include <cmath>
 #include "core/parameters.hpp"
 #include "algorithms/disph/d_pre_interaction.hpp"
@@ -12,6 +13,8 @@
 #include "kernel/kernel_function.hpp"
 #include "utilities/exception.hpp"
 #include "tree/bhtree.hpp"
+#include "utilities/scratch_buffers.hpp"
+#include "utilities/loop_scheduler.hpp"
 
 namespace sph
 {
@@ -21,7 +24,7 @@ namespace sph
         real PreInteraction::newton_raphson(
             const SPHParticle &p_i,
             const std::vector<SPHParticle> &particles,
-            const std::vector<int> &neighbor_list,
+            const int *neighbor_list,
             const int n_neighbor,
             const Periodic *periodic,
             const KernelFunction *kernel)
@@ -49,7 +52,7 @@ namespace sph
                         continue;
                     }
 
-                    std::vector<int> neighbor_list(m_neighbor_number * neighbor_list_size);
+                    auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
                     int effectiveDim;
                     real A_eff;
                     if (m_anisotropic)
@@ -69,7 +72,7 @@ namespace sph
                                                        neighbor_list, m_neighbor_number * neighbor_list_size,
                                                        periodic, false);
 #else
-                    int n_neighbor = sim->get_tree()->neighbor_search(p_i, neighbor_list, particles, false);
+                    int n_neighbor = sim->get_tree()->neighbor_search_adaptive(p_i, neighbor_list, particles, false);
 #endif
                     p_i.neighbor = n_neighbor;
                 }
@@ -77,137 +80,99 @@ namespace sph
             }
 
             auto &particles = sim->get_particles();
+#ifdef EXHAUSTIVE_SEARCH
             const int num = sim->get_particle_num();
+#endif
             auto *periodic = sim->get_periodic().get();
             auto *kernel = sim->get_kernel().get();
+            const auto &neighbor_cache = sim->get_neighbor_cache();
             omp_real h_per_v_sig(std::numeric_limits<real>::max());
 
-#pragma omp parallel for
-            for (int i = 0; i < num; ++i)
+            // 2.5D/anisotropic are fixed per run: hoist the effective-dimension
+            // constants out of the per-particle loop.
+            const int effectiveDim = (m_anisotropic || m_twoAndHalf) ? 2 : DIM;
+            const real A_eff = (effectiveDim == 1 ? 2.0 : (effectiveDim == 2 ? M_PI : 4.0 * M_PI / 3.0));
+
+            // point masses are out of the index range, not branched over
+            const auto &sph = sim->sph_ids();
+            const int n_sph = static_cast<int>(sph.size());
+
+            LoopScheduler::Scope schedule(LoopScheduler::PRE_INTERACTION);
+#pragma omp parallel
             {
-                auto &p_i = particles[i];
-                if (p_i.is_point_mass)
+                // per-thread running minimum of h/v_sig, published to the
+                // shared slot once per thread instead of per particle
+                real h_vs_thread = std::numeric_limits<real>::max();
+#pragma omp for schedule(runtime)
+                for (int ii = 0; ii < n_sph; ++ii)
                 {
-                    continue;
-                }
+                    const int i = sph[ii];
+                    auto &p_i = particles[i];
+                    if (!p_i.is_active)
+                    {
+                        continue; // block timesteps: forces stay frozen until the bin boundary
+                    }
 
-                // Recompute smoothing length for each particle based on its density.
-                std::vector<int> neighbor_list(m_neighbor_number * neighbor_list_size);
-                int effectiveDim;
-                real A_eff;
-                if (m_anisotropic)
-                {
-                    effectiveDim = 2;
-                    A_eff = M_PI;
-                    p_i.sml = std::pow(m_neighbor_number * p_i.mass / (p_i.dens * A_eff), 1.0 / 2.0) * m_kernel_ratio;
-                }
-                else
-                {
-                    effectiveDim = m_twoAndHalf ? 2 : DIM;
-                    A_eff = (effectiveDim == 1 ? 2.0 : (effectiveDim == 2 ? M_PI : 4.0 * M_PI / 3.0));
+                    // Recompute smoothing length for each particle based on its density.
                     p_i.sml = std::pow(m_neighbor_number * p_i.mass / (p_i.dens * A_eff), 1.0 / effectiveDim) * m_kernel_ratio;
-                }
+                    const int *neighbor_ptr = nullptr;
+                    int n_neighbor = 0;
 #ifdef EXHAUSTIVE_SEARCH
-                int n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num,
+                    auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                    n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num,
                                                    neighbor_list, m_neighbor_number * neighbor_list_size,
                                                    periodic, false);
+                    neighbor_ptr = neighbor_list.data();
 #else
-                int n_neighbor = sim->get_tree()->neighbor_search(p_i, neighbor_list, particles, false);
-#endif
-
-                // Initialize accumulators for density and pressure calculations.
-                real dens_i = 0.0;
-                real pres_i = 0.0;
-                real dh_pres_i = 0.0;
-                real n_i = 0.0;
-                real dh_n_i = 0.0;
-                real v_sig_max = p_i.sound * 2.0;
-                int valid_neighbors = 0;
-
-                // Loop over neighbors to compute density, pressure, and kernel derivatives.
-                for (int n = 0; n < n_neighbor; ++n)
-                {
-                    int j = neighbor_list[n];
-                    auto &p_j = particles[j];
-                    if (p_j.is_point_mass)
-                        continue; // Skip point masses
-
-                    vec_t r_ij = periodic->calc_r_ij(p_i.pos, p_j.pos);
-                    real r = std::abs(r_ij);
-                    bool valid = false;
-                    if (m_anisotropic)
+                    // Verlet mode: skin-inflated lists from the previous step stay valid
+                    if (neighbor_cache.is_valid())
                     {
-                        // Compute an effective anisotropic distance.
-                        real r_xy = std::sqrt(r_ij[0] * r_ij[0] + r_ij[1] * r_ij[1]);
-                        real r_aniso = std::sqrt((r_xy / p_i.sml) * (r_xy / p_i.sml) +
-                                                 (r_ij[2] / m_hz) * (r_ij[2] / m_hz));
-                        if (r_aniso < 1.0)
-                            valid = true;
+                        n_neighbor = neighbor_cache.neighbor_count(i);
+                        neighbor_ptr = neighbor_cache.neighbors(i);
                     }
                     else
                     {
-                        if (r < p_i.sml)
-                            valid = true;
-                    }
-                    if (!valid)
-                        continue;
-
-                    valid_neighbors++;
-                    const real w_ij = kernel->w(r, p_i.sml);
-                    const real dhw_ij = kernel->dhw(r, p_i.sml);
-                    dens_i += p_j.mass * w_ij;
-                    n_i += w_ij;
-                    pres_i += p_j.mass * p_j.ene * w_ij;
-                    dh_pres_i += p_j.mass * p_j.ene * dhw_ij;
-                    dh_n_i += dhw_ij;
-
-                    if (i != j)
-                    {
-                        const real v_sig = p_i.sound + p_j.sound - 3.0 * inner_product(r_ij, p_i.vel - p_j.vel) / (r + 1e-12);
-                        if (v_sig > v_sig_max)
-                        {
-                            v_sig_max = v_sig;
-                        }
+                        auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                        n_neighbor = sim->get_tree()->neighbor_search_adaptive(p_i, neighbor_list, particles, false);
+                        neighbor_ptr = neighbor_list.data();
                     }
-                }
-
-                p_i.neighbor = valid_neighbors;
-                p_i.dens = dens_i;
-                p_i.pres = (m_gamma - 1.0) * pres_i;
-                p_i.gradh = p_i.sml / (effectiveDim * n_i) * dh_pres_i / (1.0 + p_i.sml / (effectiveDim * n_i) * dh_n_i);
-                
-                // DISPH: Calculate volume element V = m/ρ
-                p_i.volume = p_i.mass / p_i.dens;
+#endif
 
-                const real h_per_v_sig_i = p_i.sml / v_sig_max;
-                if (h_per_v_sig.get() > h_per_v_sig_i)
-                {
-                    h_per_v_sig.get() = h_per_v_sig_i;
-                }
+                    // Initialize accumulators for density and pressure calculations.
+                    real dens_i = 0.0;
+                    real pres_i = 0.0;
+                    real dh_pres_i = 0.0;
+                    real n_i = 0.0;
+                    real dh_n_i = 0.0;
+                    real v_sig_max = p_i.sound * 2.0;
+                    int valid_neighbors = 0;
 
-                // Artificial viscosity.
-                if (m_use_balsara_switch && DIM != 1)
-                {
-#if DIM != 1
+                    // div(v)/curl(v) accumulators for the AV switches, filled in
+                    // the same sweep; the pressure normalization is applied after
+                    // the loop once p_i.pres is final.
+                    const bool use_balsara_i = m_use_balsara_switch && DIM != 1;
+                    const bool need_div_v = use_balsara_i || m_use_time_dependent_av;
                     real div_v = 0.0;
 #if DIM == 2
                     real rot_v = 0.0;
-#else
+#elif DIM == 3
                     vec_t rot_v = 0.0;
 #endif
-                    // Loop over neighbors to compute velocity divergence and rotation.
+
+                    // Loop over neighbors to compute density, pressure, and kernel derivatives.
                     for (int n = 0; n < n_neighbor; ++n)
                     {
-                        int j = neighbor_list[n];
+                        int j = neighbor_ptr[n];
                         auto &p_j = particles[j];
                         if (p_j.is_point_mass)
-                            continue;
+                            continue; // Skip point masses
 
                         vec_t r_ij = periodic->calc_r_ij(p_i.pos, p_j.pos);
                         real r = std::abs(r_ij);
                         bool valid = false;
                         if (m_anisotropic)
                         {
+                            // Compute an effective anisotropic distance.
                             real r_xy = std::sqrt(r_ij[0] * r_ij[0] + r_ij[1] * r_ij[1]);
                             real r_aniso = std::sqrt((r_xy / p_i.sml) * (r_xy / p_i.sml) +
                                                      (r_ij[2] / m_hz) * (r_ij[2] / m_hz));
@@ -222,66 +187,87 @@ namespace sph
                         if (!valid)
                             continue;
 
-                        const vec_t dw = kernel->dw(r_ij, r, p_i.sml);
-                        const vec_t v_ij = p_i.vel - p_j.vel;
-                        div_v -= p_j.mass * p_j.ene * inner_product(v_ij, dw);
-                        rot_v += vector_product(v_ij, dw) * (p_j.mass * p_j.ene);
+                        valid_neighbors++;
+                        const real w_ij = kernel->w(r, p_i.sml);
+                        const real dhw_ij = kernel->dhw(r, p_i.sml);
+                        dens_i += p_j.mass * w_ij;
+                        n_i += w_ij;
+                        pres_i += p_j.mass * p_j.ene * w_ij;
+                        dh_pres_i += p_j.mass * p_j.ene * dhw_ij;
+                        dh_n_i += dhw_ij;
+
+                        if (i != j)
+                        {
+                            const real v_sig = p_i.sound + p_j.sound - 3.0 * inner_product(r_ij, p_i.vel - p_j.vel) / (r + 1e-12);
+                            if (v_sig > v_sig_max)
+                            {
+                                v_sig_max = v_sig;
+                            }
+                        }
+
+                        if (need_div_v)
+                        {
+                            const vec_t dw = kernel->dw(r_ij, r, p_i.sml);
+                            const vec_t v_ij = p_i.vel - p_j.vel;
+                            div_v -= p_j.mass * p_j.ene * inner_product(v_ij, dw);
+#if DIM != 1
+                            if (use_balsara_i)
+                            {
+                                rot_v += vector_product(v_ij, dw) * (p_j.mass * p_j.ene);
+                            }
+#endif
+                        }
                     }
-                    const real p_inv = (m_gamma - 1.0) / p_i.pres;
-                    div_v *= p_inv;
-                    rot_v *= p_inv;
-                    p_i.balsara = std::abs(div_v) / (std::abs(div_v) + std::abs(rot_v) + 1e-4 * p_i.sound / p_i.sml);
 
-                    // Time-dependent viscosity parameter.
-                    if (m_use_time_dependent_av)
+                    p_i.neighbor = valid_neighbors;
+                    p_i.dens = dens_i;
+                    p_i.pres = (m_gamma - 1.0) * pres_i;
+                    p_i.gradh = p_i.sml / (effectiveDim * n_i) * dh_pres_i / (1.0 + p_i.sml / (effectiveDim * n_i) * dh_n_i);
+                    
+                    // DISPH: Calculate volume element V = m/ρ
+                    p_i.volume = p_i.mass / p_i.dens;
+
+                    const real h_per_v_sig_i = p_i.sml / v_sig_max;
+                    p_i.h_per_v_sig = h_per_v_sig_i;
+                    if (h_per_v_sig_i < h_vs_thread)
                     {
-                        const real tau_inv = m_epsilon * p_i.sound / p_i.sml;
-                        const real dalpha = (-(p_i.alpha - m_alpha_min) * tau_inv +
-                                             std::max(-div_v, (real)0.0) * (m_alpha_max - p_i.alpha)) *
-                                            dt;
-                        p_i.alpha += dalpha;
+                        h_vs_thread = h_per_v_sig_i;
                     }
-#endif
-                }
-                else if (m_use_time_dependent_av)
-                {
-                    real div_v = 0.0;
-                    for (int n = 0; n < n_neighbor; ++n)
+
+                    // Artificial viscosity.
+                    if (m_use_balsara_switch && DIM != 1)
                     {
-                        int j = neighbor_list[n];
-                        auto &p_j = particles[j];
-                        if (p_j.is_point_mass)
-                            continue;
+#if DIM != 1
+                        const real p_inv = (m_gamma - 1.0) / p_i.pres;
+                        div_v *= p_inv;
+                        rot_v *= p_inv;
+                        p_i.balsara = std::abs(div_v) / (std::abs(div_v) + std::abs(rot_v) + 1e-4 * p_i.sound / p_i.sml);
 
-                        vec_t r_ij = periodic->calc_r_ij(p_i.pos, p_j.pos);
-                        real r = std::abs(r_ij);
-                        bool valid = false;
-                        if (m_anisotropic)
+                        // Time-dependent viscosity parameter.
+                        if (m_use_time_dependent_av)
                         {
-                            real r_xy = std::sqrt(r_ij[0] * r_ij[0] + r_ij[1] * r_ij[1]);
-                            real r_aniso = std::sqrt((r_xy / p_i.sml) * (r_xy / p_i.sml) +
-                                                     (r_ij[2] / m_hz) * (r_ij[2] / m_hz));
-                            if (r_aniso < 1.0)
-                                valid = true;
-                        }
-                        else
-                        {
-                            if (r < p_i.sml)
-                                valid = true;
+                            const real tau_inv = m_epsilon * p_i.sound / p_i.sml;
+                            const real dalpha = (-(p_i.alpha - m_alpha_min) * tau_inv +
+                                                 std::max(-div_v, (real)0.0) * (m_alpha_max - p_i.alpha)) *
+                                                dt;
+                            p_i.alpha += dalpha;
                         }
-                        if (!valid)
-                            continue;
-
-                        const vec_t dw = kernel->dw(r_ij, r, p_i.sml);
-                        const vec_t v_ij = p_i.vel - p_j.vel;
-                        div_v -= p_j.mass * p_j.ene * inner_product(v_ij, dw);
+#endif
                     }
-                    const real p_inv = (m_gamma - 1.0) / p_i.pres;
-                    div_v *= p_inv;
-                    const real tau_inv = m_epsilon * p_i.sound / p_i.sml;
-                    const real s_i = std::max(-div_v, (real)0.0);
-                    p_i.alpha = (p_i.alpha + dt * tau_inv * m_alpha_min + s_i * dt * m_alpha_max) /
-                                (1.0 + dt * tau_inv + s_i * dt);
+                    else if (m_use_time_dependent_av)
+                    {
+                        const real p_inv = (m_gamma - 1.0) / p_i.pres;
+                        div_v *= p_inv;
+                        const real tau_inv = m_epsilon * p_i.sound / p_i.sml;
+                        const real s_i = std::max(-div_v, (real)0.0);
+                        p_i.alpha = (p_i.alpha + dt * tau_inv * m_alpha_min + s_i * dt * m_alpha_max) /
+                                    (1.0 + dt * tau_inv + s_i * dt);
+                    }
+                }
+
+                if (h_vs_thread < h_per_v_sig.get())
+                {
+                    h_per_v_sig.get() = h_vs_thread;
                 }
             }
 
@@ -5,6 +5,13 @@
 #include "tree/bhtree.hpp"
 #include "kernel/kernel_function.hpp"
 #include "algorithms/gdisph/gdi_fluid_force.hpp"
+#include "algorithms/hll_batch.hpp"
+
+#include "utilities/scratch_buffers.hpp"
+#include "utilities/loop_scheduler.hpp"
+#include "utilities/step_timer.hpp"
+
+#include <chrono>
 
 #ifdef EXHAUSTIVE_SEARCH
 #include "tree/exhaustive_search.hpp"
@@ -20,8 +27,8 @@ namespace sph
             sph::FluidForce::initialize(param);
             m_is_2nd_order = param->gsph.is_2nd_order;
             m_gamma = param->physics.gamma;
-
-            hll_solver();
+            m_region_switch = param->gdisph.region_switch;
+            m_shock_mach = param->gdisph.mach_threshold;
         }
 
         // van Leer (1979) limiter
@@ -38,52 +45,206 @@ namespace sph
             }
         }
 
-        // Cha & Whitworth (2003)
+        namespace
+        {
+            // Shared gather step of the three-phase pair loops below: MUSCL
+            // (or first-order) left/right state of one accepted pair, pushed
+            // into the thread's batch.
+            struct PairGather
+            {
+                const ParticleSoA &soa;
+                const vec_t *grad_d;
+                const vec_t *grad_p;
+                vec_t *const *grad_v;
+                real gamma;
+                real dt;
+                bool is_2nd_order;
+
+                void push(HLLBatch &batch, const SPHParticle &p_i, const int i, const int j,
+                          const vec_t &e_ij, const real r, const real r_inv) const
+                {
+                    const real ve_i = inner_product(p_i.vel, e_ij);
+                    const real ve_j = inner_product(soa.vel[j], e_ij);
+
+                    real right[4], left[4];
+                    if (is_2nd_order)
+                    {
+                        // Murante et al. (2011)
+
+                        const real delta_i = 0.5 * (1.0 - p_i.sound * dt * r_inv);
+                        const real delta_j = 0.5 * (1.0 - soa.sound[j] * dt * r_inv);
+
+                        // velocity
+                        const real dv_ij = ve_i - ve_j;
+                        vec_t dv_i, dv_j;
+                        for (int k = 0; k < DIM; ++k)
+                        {
+                            dv_i[k] = inner_product(grad_v[k][i], e_ij);
+                            dv_j[k] = inner_product(grad_v[k][j], e_ij);
+                        }
+                        const real dve_i = inner_product(dv_i, e_ij) * r;
+                        const real dve_j = inner_product(dv_j, e_ij) * r;
+                        right[0] = ve_i - limiter(dv_ij, dve_i) * delta_i;
+                        left[0] = ve_j + limiter(dv_ij, dve_j) * delta_j;
+
+                        // density
+                        const real dd_ij = p_i.dens - soa.dens[j];
+                        const real dd_i = inner_product(grad_d[i], e_ij) * r;
+                        const real dd_j = inner_product(grad_d[j], e_ij) * r;
+                        right[1] = p_i.dens - limiter(dd_ij, dd_i) * delta_i;
+                        left[1] = soa.dens[j] + limiter(dd_ij, dd_j) * delta_j;
+
+                        // pressure
+                        const real dp_ij = p_i.pres - soa.pres[j];
+                        const real dp_i = inner_product(grad_p[i], e_ij) * r;
+                        const real dp_j = inner_product(grad_p[j], e_ij) * r;
+                        right[2] = p_i.pres - limiter(dp_ij, dp_i) * delta_i;
+                        left[2] = soa.pres[j] + limiter(dp_ij, dp_j) * delta_j;
+
+                        // sound speed
+                        right[3] = std::sqrt(gamma * right[2] / right[1]);
+                        left[3] = std::sqrt(gamma * left[2] / left[1]);
+                    }
+                    else
+                    {
+                        right[0] = ve_i;
+                        right[1] = p_i.dens;
+                        right[2] = p_i.pres;
+                        right[3] = p_i.sound;
+                        left[0] = ve_j;
+                        left[1] = soa.dens[j];
+                        left[2] = soa.pres[j];
+                        left[3] = soa.sound[j];
+                    }
+
+                    batch.push(left, right);
+                }
+            };
+        }
+
         void FluidForce::calculation(std::shared_ptr<Simulation> sim)
+        {
+            if (m_symmetrize)
+            {
+                // the pair-once walk treats both endpoints of a pair at once,
+                // so it cannot split the work by per-particle mode
+                calculation_symmetric(sim);
+                return;
+            }
+
+            if (!m_region_switch)
+            {
+                calculation_riemann(sim, nullptr);
+                return;
+            }
+
+            // Region-partitioned execution: bucket the particles by shock
+            // mode, then run two tight loops so the Riemann machinery never
+            // enters the instruction stream of the smooth-flow majority. The
+            // per-mode times go to the timing log as separate columns.
+            partition_by_mode(sim);
+
+            using clock = std::chrono::steady_clock;
+            auto *timer = sim->get_step_timer();
+
+            const auto t0 = clock::now();
+            calculation_smooth(sim);
+            const auto t1 = clock::now();
+            calculation_riemann(sim, &m_shock_idx);
+            const auto t2 = clock::now();
+
+            if (timer && timer->enabled())
+            {
+                timer->record("fluid_force_smooth", std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() * 1e-3);
+                timer->record("fluid_force_shock", std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() * 1e-3);
+            }
+        }
+
+        // Update shockMode from the sensor detect_shocks filled at the end of
+        // the previous step (the switch therefore lags the flow by one step)
+        // and fill the two index buckets. switch_to_no_shock_region pins a
+        // particle to the smooth bucket regardless of its sensor.
+        void FluidForce::partition_by_mode(std::shared_ptr<Simulation> sim)
         {
             auto &particles = sim->get_particles();
-            auto *periodic = sim->get_periodic().get();
-            const int num = sim->get_particle_num();
-            auto *kernel = sim->get_kernel().get();
-            auto *tree = sim->get_tree().get();
-            const real dt = sim->get_dt();
+            const auto &sph = sim->sph_ids();
+            const int n_sph = static_cast<int>(sph.size());
 
-            // for MUSCL
-            auto &grad_d = sim->get_vector_array("grad_density");
-            auto &grad_p = sim->get_vector_array("grad_pressure");
-            vec_t *grad_v[DIM] = {
-                sim->get_vector_array("grad_velocity_0").data(),
-#if DIM == 2
-                sim->get_vector_array("grad_velocity_1").data(),
-#elif DIM == 3
-                sim->get_vector_array("grad_velocity_1").data(),
-                sim->get_vector_array("grad_velocity_2").data(),
-#endif
-            };
+            m_smooth_idx.clear();
+            m_shock_idx.clear();
 
-#pragma omp parallel for
-            for (int i = 0; i < num; ++i)
+            for (int ii = 0; ii < n_sph; ++ii)
             {
+                const int i = sph[ii];
                 auto &p_i = particles[i];
-                if (p_i.is_point_mass)
+                if (!p_i.is_active)
                 {
                     continue;
                 }
+                p_i.oldShockMode = p_i.shockMode;
+                p_i.shockMode = (!p_i.switch_to_no_shock_region && p_i.shockSensor >= m_shock_mach) ? 1 : 0;
+                if (p_i.shockMode)
+                {
+                    m_shock_idx.push_back(i);
+                }
+                else
+                {
+                    m_smooth_idx.push_back(i);
+                }
+            }
+        }
+
+        // Smooth-region loop: only the inviscid DISPH-like pressure force,
+        // i.e. the pstar-dependent terms of the Riemann loop dropped. No
+        // MUSCL reconstruction and no Riemann solves in the pair body.
+        void FluidForce::calculation_smooth(std::shared_ptr<Simulation> sim)
+        {
+            auto &particles = sim->get_particles();
+            auto *periodic = sim->get_periodic().get();
+            auto *kernel = sim->get_kernel().get();
+            auto *tree = sim->get_tree().get();
+#ifdef EXHAUSTIVE_SEARCH
+            const int num = sim->get_particle_num();
+#endif
+
+            sim->sync_particle_soa();
+            const auto &soa = sim->get_particle_soa();
+            const auto &neighbor_cache = sim->get_neighbor_cache();
 
-                std::vector<int> neighbor_list(m_neighbor_number * neighbor_list_size);
+            const int n_loop = static_cast<int>(m_smooth_idx.size());
 
-                // neighbor search
+            LoopScheduler::Scope schedule(LoopScheduler::FLUID_FORCE);
+#pragma omp parallel for schedule(runtime)
+            for (int ii = 0; ii < n_loop; ++ii)
+            {
+                const int i = m_smooth_idx[ii];
+                auto &p_i = particles[i];
+
+                const int *neighbor_ptr = nullptr;
+                int n_neighbor = 0;
+
+                // neighbor list: reuse the per-step cache when available
 #ifdef EXHAUSTIVE_SEARCH
-                int const n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+                auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+                neighbor_ptr = neighbor_list.data();
 #else
-                int const n_neighbor = tree->neighbor_search(p_i, neighbor_list, particles, true);
+                if (neighbor_cache.is_valid())
+                {
+                    n_neighbor = neighbor_cache.neighbor_count(i);
+                    neighbor_ptr = neighbor_cache.neighbors(i);
+                }
+                else
+                {
+                    auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                    n_neighbor = tree->neighbor_search_adaptive(p_i, neighbor_list, particles, true);
+                    neighbor_ptr = neighbor_list.data();
+                }
 #endif
 
-                // fluid force
                 const vec_t &r_i = p_i.pos;
                 const vec_t &v_i = p_i.vel;
                 const real h_i = p_i.sml;
-
                 const real rho2_inv_i = 1.0 / sqr(p_i.dens);
 
                 vec_t acc(0.0);
@@ -91,174 +252,376 @@ namespace sph
 
                 for (int n = 0; n < n_neighbor; ++n)
                 {
-                    int const j = neighbor_list[n];
-                    auto &p_j = particles[j];
-                    if (p_j.is_point_mass)
+                    int const j = neighbor_ptr[n];
+                    if (soa.is_point_mass[j])
                     {
                         continue;
                     }
-                    const real h_j = p_j.sml;
 
-                    const vec_t r_ij = periodic->calc_r_ij(r_i, p_j.pos);
+                    const vec_t r_ij = periodic->calc_r_ij(r_i, soa.pos[j]);
                     const real r = std::abs(r_ij);
 
-                    if (r >= std::max(h_i, p_j.sml) || r == 0.0)
+                    if (r >= std::max(h_i, soa.sml[j]) || r == 0.0)
                     {
                         continue;
                     }
 
-                    const real r_inv = 1.0 / r;
-                    const vec_t e_ij = r_ij * r_inv;
-                    const real ve_i = inner_product(v_i, e_ij);
-                    const real ve_j = inner_product(p_j.vel, e_ij);
-                    real vstar, pstar;
+                    const vec_t dw_i = kernel->dw(r_ij, r, h_i);
+                    const vec_t dw_j = kernel->dw(r_ij, r, soa.sml[j]);
+                    const real rho2_inv_j = 1.0 / sqr(soa.dens[j]);
+                    const vec_t v_ij = v_i - soa.vel[j];
+
+                    acc -= dw_i * (p_i.mass * (p_i.pres) * rho2_inv_i) +
+                           dw_j * (soa.mass[j] * (soa.pres[j]) * rho2_inv_j);
+                    dene += inner_product(dw_i * (p_i.mass * (p_i.pres) * rho2_inv_i), v_ij);
+                }
+
+                p_i.acc = acc;
+                p_i.dene = dene;
+            }
+        }
+
+        // Cha & Whitworth (2003)
+        //
+        // Per particle the loop runs in three phases: gather the left/right
+        // states of every accepted pair into an HLLBatch, solve all Riemann
+        // problems in one vectorized sweep, then scatter p* back into the
+        // force accumulation. Iterates the subset when given (the shock
+        // bucket under shockRegionSwitch), otherwise every particle.
+        void FluidForce::calculation_riemann(std::shared_ptr<Simulation> sim, const std::vector<int> *subset)
+        {
+            auto &particles = sim->get_particles();
+            auto *periodic = sim->get_periodic().get();
+#ifdef EXHAUSTIVE_SEARCH
+            const int num = sim->get_particle_num();
+#endif
+            auto *kernel = sim->get_kernel().get();
+            auto *tree = sim->get_tree().get();
+            const real dt = sim->get_dt();
 
-                    if (m_is_2nd_order)
+            sim->sync_particle_soa();
+            const auto &soa = sim->get_particle_soa();
+            const auto &neighbor_cache = sim->get_neighbor_cache();
+
+            // for MUSCL (handles bound on first use, no per-step name lookups)
+            m_grad_handles.resolve(*sim);
+            auto &grad_d = sim->vector_array(m_grad_handles.grad_d);
+            auto &grad_p = sim->vector_array(m_grad_handles.grad_p);
+            vec_t *grad_v[DIM] = {
+                sim->vector_array(m_grad_handles.grad_v[0]).data(),
+#if DIM == 2
+                sim->vector_array(m_grad_handles.grad_v[1]).data(),
+#elif DIM == 3
+                sim->vector_array(m_grad_handles.grad_v[1]).data(),
+                sim->vector_array(m_grad_handles.grad_v[2]).data(),
+#endif
+            };
+
+            const PairGather gather = {soa, grad_d.data(), grad_p.data(), grad_v,
+                                       m_gamma, dt, m_is_2nd_order};
+
+            // full runs iterate the SPH index range; subsets (the shock
+            // bucket) already exclude point masses via partition_by_mode
+            const auto &sph = sim->sph_ids();
+            const int n_loop = subset ? static_cast<int>(subset->size())
+                                      : static_cast<int>(sph.size());
+
+            LoopScheduler::Scope schedule(LoopScheduler::FLUID_FORCE);
+#pragma omp parallel
+            {
+                // pair staging buffers, reused across particles
+                HLLBatch batch;
+                std::vector<int> pair_j;
+                std::vector<vec_t> pair_r_ij;
+
+#pragma omp for schedule(runtime)
+                for (int ii = 0; ii < n_loop; ++ii)
+                {
+                    const int i = subset ? (*subset)[ii] : sph[ii];
+                    auto &p_i = particles[i];
+                    if (!p_i.is_active)
                     {
-                        // Murante et al. (2011)
+                        continue; // block timesteps: forces stay frozen until the bin boundary
+                    }
 
-                        real right[4], left[4];
-                        const real delta_i = 0.5 * (1.0 - p_i.sound * dt * r_inv);
-                        const real delta_j = 0.5 * (1.0 - p_j.sound * dt * r_inv);
+                    const int *neighbor_ptr = nullptr;
+                    int n_neighbor = 0;
 
-                        // velocity
-                        const real dv_ij = ve_i - ve_j;
-                        vec_t dv_i, dv_j;
-                        for (int k = 0; k < DIM; ++k)
+                    // neighbor list: reuse the per-step cache when available
+#ifdef EXHAUSTIVE_SEARCH
+                    auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                    n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+                    neighbor_ptr = neighbor_list.data();
+#else
+                    if (neighbor_cache.is_valid())
+                    {
+                        n_neighbor = neighbor_cache.neighbor_count(i);
+                        neighbor_ptr = neighbor_cache.neighbors(i);
+                    }
+                    else
+                    {
+                        auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                        n_neighbor = tree->neighbor_search_adaptive(p_i, neighbor_list, particles, true);
+                        neighbor_ptr = neighbor_list.data();
+                    }
+#endif
+
+                    // fluid force
+                    const vec_t &r_i = p_i.pos;
+                    const vec_t &v_i = p_i.vel;
+                    const real h_i = p_i.sml;
+                    const real rho2_inv_i = 1.0 / sqr(p_i.dens);
+
+                    // phase 1: gather pair states
+                    batch.clear();
+                    pair_j.clear();
+                    pair_r_ij.clear();
+
+                    for (int n = 0; n < n_neighbor; ++n)
+                    {
+                        int const j = neighbor_ptr[n];
+                        if (soa.is_point_mass[j])
                         {
-                            dv_i[k] = inner_product(grad_v[k][i], e_ij);
-                            dv_j[k] = inner_product(grad_v[k][j], e_ij);
+                            continue;
                         }
-                        const real dve_i = inner_product(dv_i, e_ij) * r;
-                        const real dve_j = inner_product(dv_j, e_ij) * r;
-                        right[0] = ve_i - limiter(dv_ij, dve_i) * delta_i;
-                        left[0] = ve_j + limiter(dv_ij, dve_j) * delta_j;
 
-                        // density
-                        const real dd_ij = p_i.dens - p_j.dens;
-                        const real dd_i = inner_product(grad_d[i], e_ij) * r;
-                        const real dd_j = inner_product(grad_d[j], e_ij) * r;
-                        right[1] = p_i.dens - limiter(dd_ij, dd_i) * delta_i;
-                        left[1] = p_j.dens + limiter(dd_ij, dd_j) * delta_j;
+                        const vec_t r_ij = periodic->calc_r_ij(r_i, soa.pos[j]);
+                        const real r = std::abs(r_ij);
 
-                        // pressure
-                        const real dp_ij = p_i.pres - p_j.pres;
-                        const real dp_i = inner_product(grad_p[i], e_ij) * r;
-                        const real dp_j = inner_product(grad_p[j], e_ij) * r;
-                        right[2] = p_i.pres - limiter(dp_ij, dp_i) * delta_i;
-                        left[2] = p_j.pres + limiter(dp_ij, dp_j) * delta_j;
+                        if (r >= std::max(h_i, soa.sml[j]) || r == 0.0)
+                        {
+                            continue;
+                        }
 
-                        // sound speed
-                        right[3] = std::sqrt(m_gamma * right[2] / right[1]);
-                        left[3] = std::sqrt(m_gamma * left[2] / left[1]);
+                        const real r_inv = 1.0 / r;
+                        gather.push(batch, p_i, i, j, r_ij * r_inv, r, r_inv);
+                        pair_j.push_back(j);
+                        pair_r_ij.push_back(r_ij);
+                    }
+
+                    // phase 2: all Riemann problems of this particle at once
+                    batch.solve();
 
-                        m_solver(left, right, pstar, vstar);
+                    // phase 3: scatter p* into the force accumulation
+                    vec_t acc(0.0);
+                    real dene = 0.0;
+
+                    const int n_pair = batch.size();
+                    for (int n = 0; n < n_pair; ++n)
+                    {
+                        int const j = pair_j[n];
+                        const vec_t &r_ij = pair_r_ij[n];
+                        const real r = std::abs(r_ij);
+                        const real h_j = soa.sml[j];
+                        const real pstar = batch.pstar(n);
+
+                        const vec_t dw_i = kernel->dw(r_ij, r, h_i);
+                        const vec_t dw_j = kernel->dw(r_ij, r, h_j);
+
+                        const real rho2_inv_j = 1.0 / sqr(soa.dens[j]);
+                        const real balsara_avg = 0.5 * (p_i.balsara + soa.balsara[j]);
+                        const vec_t v_ij = v_i - soa.vel[j];
+
+                        const vec_t f_vis = dw_i * (p_i.mass * (pstar - p_i.pres) * rho2_inv_i * p_i.gradh) + dw_j * (soa.mass[j] * (pstar - soa.pres[j]) * rho2_inv_j * soa.gradh[j]);
+                        const vec_t f_invis = dw_i * (p_i.mass * (p_i.pres) * rho2_inv_i) +
+                                              dw_j * (soa.mass[j] * (soa.pres[j]) * rho2_inv_j);
+                        acc -= f_invis + f_vis * balsara_avg;
+
+                        const vec_t ene_vis = dw_i * (p_i.mass * (pstar - p_i.pres) * rho2_inv_i);
+                        const vec_t ene_invis = dw_i * (p_i.mass * (p_i.pres) * rho2_inv_i);
+                        dene += inner_product(ene_invis, v_ij) +
+                                inner_product(ene_vis, v_ij) * balsara_avg;
                     }
-                    else
+
+                    p_i.acc = acc;
+                    p_i.dene = dene;
+                }
+            }
+        }
+
+        // Pair-once variant of the loop above. pstar is invariant under
+        // i<->j (the left/right states swap and e_ij flips), so one MUSCL
+        // reconstruction and one Riemann solve serve both particles; the
+        // force and energy mirrors follow from ∇W and v_ij flipping sign
+        // together. Contributions are scattered through per-thread rows.
+        void FluidForce::calculation_symmetric(std::shared_ptr<Simulation> sim)
+        {
+            auto &particles = sim->get_particles();
+            auto *periodic = sim->get_periodic().get();
+            const int num = sim->get_particle_num();
+            auto *kernel = sim->get_kernel().get();
+            auto *tree = sim->get_tree().get();
+            const real dt = sim->get_dt();
+
+            sim->sync_particle_soa();
+            const auto &soa = sim->get_particle_soa();
+            const auto &neighbor_cache = sim->get_neighbor_cache();
+
+            // for MUSCL (handles bound on first use, no per-step name lookups)
+            m_grad_handles.resolve(*sim);
+            auto &grad_d = sim->vector_array(m_grad_handles.grad_d);
+            auto &grad_p = sim->vector_array(m_grad_handles.grad_p);
+            vec_t *grad_v[DIM] = {
+                sim->vector_array(m_grad_handles.grad_v[0]).data(),
+#if DIM == 2
+                sim->vector_array(m_grad_handles.grad_v[1]).data(),
+#elif DIM == 3
+                sim->vector_array(m_grad_handles.grad_v[1]).data(),
+                sim->vector_array(m_grad_handles.grad_v[2]).data(),
+#endif
+            };
+
+            const PairGather gather = {soa, grad_d.data(), grad_p.data(), grad_v,
+                                       m_gamma, dt, m_is_2nd_order};
+
+            m_pair_accum.reset(num);
+
+            const auto &sph = sim->sph_ids();
+            const int n_sph = static_cast<int>(sph.size());
+
+            LoopScheduler::Scope schedule(LoopScheduler::FLUID_FORCE);
+#pragma omp parallel
+            {
+                vec_t *acc_buf = m_pair_accum.acc();
+                real *dene_buf = m_pair_accum.dene();
+
+                // pair staging buffers, reused across particles
+                HLLBatch batch;
+                std::vector<int> pair_j;
+                std::vector<vec_t> pair_r_ij;
+
+#pragma omp for schedule(runtime)
+                for (int ii = 0; ii < n_sph; ++ii)
+                {
+                    const int i = sph[ii];
+                    auto &p_i = particles[i];
+                    if (!p_i.is_active)
                     {
-                        const real right[4] = {
-                            ve_i,
-                            p_i.dens,
-                            p_i.pres,
-                            p_i.sound,
-                        };
-                        const real left[4] = {
-                            ve_j,
-                            p_j.dens,
-                            p_j.pres,
-                            p_j.sound,
-                        };
-
-                        m_solver(left, right, pstar, vstar);
+                        continue; // block timesteps: forces stay frozen until the bin boundary
                     }
 
-                    const vec_t dw_i = kernel->dw(r_ij, r, h_i);
-                    const vec_t dw_j = kernel->dw(r_ij, r, h_j);
+                    const int *neighbor_ptr = nullptr;
+                    int n_neighbor = 0;
 
-                    const real rho_j = p_j.dens;
-                    const real rho_i = p_i.dens;
-                    const real rho2_inv_j = 1.0 / sqr(rho_j);
-                    const real balsara_avg = 0.5 * (p_i.balsara + p_j.balsara);
+                    // neighbor list: reuse the per-step cache when available
+#ifdef EXHAUSTIVE_SEARCH
+                    auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                    n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+                    neighbor_ptr = neighbor_list.data();
+#else
+                    if (neighbor_cache.is_valid())
+                    {
+                        n_neighbor = neighbor_cache.neighbor_count(i);
+                        neighbor_ptr = neighbor_cache.neighbors(i);
+                    }
+                    else
+                    {
+                        auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                        n_neighbor = tree->neighbor_search_adaptive(p_i, neighbor_list, particles, true);
+                        neighbor_ptr = neighbor_list.data();
+                    }
+#endif
 
-                    // // Total force (GSPH)
-                    // const real f_total_term = p_j.mass * pstar * (rho2_inv_i + rho2_inv_j);
-                    // const vec_t f_total = dw_i * f_total_term;
+                    const vec_t &r_i = p_i.pos;
+                    const vec_t &v_i = p_i.vel;
+                    const real h_i = p_i.sml;
+                    const real rho2_inv_i = 1.0 / sqr(p_i.dens);
 
-                    // // Inviscid force (using local pressures)
-                    // const real f_invis_term = p_j.mass * (p_i.pres * rho2_inv_i + p_j.pres * rho2_inv_j);
-                    // const vec_t f_invis = dw_i * f_invis_term;
+                    // phase 1: gather pair states (each pair visited once)
+                    batch.clear();
+                    pair_j.clear();
+                    pair_r_ij.clear();
 
-                    // // Viscous force (difference)
-                    // const vec_t f_vis = f_total - f_invis;
+                    for (int n = 0; n < n_neighbor; ++n)
+                    {
+                        int const j = neighbor_ptr[n];
+                        if (soa.is_point_mass[j])
+                        {
+                            continue;
+                        }
 
-                    // // Apply Balsara switch to viscous part
-                    // acc -= f_invis + f_vis * balsara_avg;
+                        // each pair is visited once: an active j with j < i
+                        // owns it; pairs with an inactive j are always ours
+                        if (j < i && soa.is_active[j])
+                        {
+                            continue;
+                        }
 
-                    // // Energy change
-                    // const real v_ij_dot_dw = vstar * inner_product(e_ij, dw_i);
-                    // const real v_ij_dot_dw_invis = inner_product(p_i.vel - p_j.vel, dw_i);
+                        const vec_t r_ij = periodic->calc_r_ij(r_i, soa.pos[j]);
+                        const real r = std::abs(r_ij);
 
-                    // const real ene_total_term = (p_j.mass * pstar / (rho_i * rho_j)) * v_ij_dot_dw;
-                    // const real ene_invis_term = (p_j.mass * p_i.pres / (rho_i * rho_j)) * v_ij_dot_dw_invis; // Approximate with p_i.pres
-                    // const real ene_vis_term = ene_total_term - ene_invis_term;
+                        if (r >= std::max(h_i, soa.sml[j]) || r == 0.0)
+                        {
+                            continue;
+                        }
 
-                    // dene -= ene_invis_term + ene_vis_term * balsara_avg;
-                    // /////////////////////////////////////////////////////////////////////////////////////////////
-                    const vec_t v_ij = v_i - p_j.vel;
+                        const real r_inv = 1.0 / r;
+                        gather.push(batch, p_i, i, j, r_ij * r_inv, r, r_inv);
+                        pair_j.push_back(j);
+                        pair_r_ij.push_back(r_ij);
+                    }
 
-                    real pi_ij = 0;
+                    // phase 2: all Riemann problems of this particle at once
+                    batch.solve();
 
-                    vec_t f_vis = dw_i * (p_i.mass * (pstar - p_i.pres) * rho2_inv_i * p_i.gradh) + dw_j * (p_j.mass * (pstar - p_j.pres) * rho2_inv_j * p_j.gradh);
-                    vec_t f_invis = dw_i * (p_i.mass * (p_i.pres) * rho2_inv_i) +
-                                    dw_j * (p_j.mass * (p_j.pres) * rho2_inv_j);
-                    acc -= f_invis + f_vis * 0.5 * (p_i.balsara + p_j.balsara);
+                    // phase 3: scatter p* into both particles' accumulators
+                    const int n_pair = batch.size();
+                    for (int n = 0; n < n_pair; ++n)
+                    {
+                        int const j = pair_j[n];
+                        const vec_t &r_ij = pair_r_ij[n];
+                        const real r = std::abs(r_ij);
+                        const real h_j = soa.sml[j];
+                        const real pstar = batch.pstar(n);
+
+                        const vec_t dw_i = kernel->dw(r_ij, r, h_i);
+                        const vec_t dw_j = kernel->dw(r_ij, r, h_j);
+                        const real rho2_inv_j = 1.0 / sqr(soa.dens[j]);
+                        const real balsara_avg = 0.5 * (p_i.balsara + soa.balsara[j]);
+
+                        const vec_t v_ij = v_i - soa.vel[j];
+
+                        const vec_t f_vis = dw_i * (p_i.mass * (pstar - p_i.pres) * rho2_inv_i * p_i.gradh) + dw_j * (soa.mass[j] * (pstar - soa.pres[j]) * rho2_inv_j * soa.gradh[j]);
+                        const vec_t f_invis = dw_i * (p_i.mass * (p_i.pres) * rho2_inv_i) +
+                                              dw_j * (soa.mass[j] * (soa.pres[j]) * rho2_inv_j);
+                        const vec_t pair_force = f_invis + f_vis * balsara_avg;
+                        acc_buf[i] -= pair_force;
+
+                        const vec_t ene_vis_i = dw_i * (p_i.mass * (pstar - p_i.pres) * rho2_inv_i);
+                        const vec_t ene_invis_i = dw_i * (p_i.mass * (p_i.pres) * rho2_inv_i);
+                        dene_buf[i] += inner_product(ene_invis_i, v_ij) +
+                                       inner_product(ene_vis_i, v_ij) * balsara_avg;
+
+                        if (soa.is_active[j])
+                        {
+                            acc_buf[j] += pair_force;
 
-                    vec_t ene_vis = dw_i * (p_i.mass * (pstar - p_i.pres) * rho2_inv_i); // const vec_t v_ij_gsph = e_ij * vstar;
-                    const vec_t v_ij_gsph = e_ij * vstar;
-                    vec_t ene_invis = dw_i * (p_i.mass * (p_i.pres) * rho2_inv_i); // const vec_t v_ij_gsph = e_ij * vstar;
-                    dene += inner_product(
-                                ene_invis, v_ij) +
-                            inner_product(ene_vis, v_ij) * 0.5 * (p_i.balsara + p_j.balsara);
+                            const vec_t ene_vis_j = dw_j * (soa.mass[j] * (pstar - soa.pres[j]) * rho2_inv_j);
+                            const vec_t ene_invis_j = dw_j * (soa.mass[j] * (soa.pres[j]) * rho2_inv_j);
+                            dene_buf[j] += inner_product(ene_invis_j, v_ij) +
+                                           inner_product(ene_vis_j, v_ij) * balsara_avg;
+                        }
+                    }
                 }
-
-                p_i.acc = acc;
-                p_i.dene = dene;
             }
-        }
 
-        void FluidForce::hll_solver()
-        {
-            m_solver = [&](const real left[], const real right[], real &pstar, real &vstar)
+            m_pair_accum.reduce();
+            const vec_t *acc_total = m_pair_accum.acc_total();
+            const real *dene_total = m_pair_accum.dene_total();
+
+#pragma omp parallel for
+            for (int ii = 0; ii < n_sph; ++ii)
             {
-                const real u_l = left[0];
-                const real rho_l = left[1];
-                const real p_l = left[2];
-                const real c_l = left[3];
-
-                const real u_r = right[0];
-                const real rho_r = right[1];
-                const real p_r = right[2];
-                const real c_r = right[3];
-
-                const real roe_l = std::sqrt(rho_l);
-                const real roe_r = std::sqrt(rho_r);
-                const real roe_inv = 1.0 / (roe_l + roe_r);
-
-                const real u_t = (roe_l * u_l + roe_r * u_r) * roe_inv;
-                const real c_t = (roe_l * c_l + roe_r * c_r) * roe_inv;
-                const real s_l = std::min(u_l - c_l, u_t - c_t);
-                const real s_r = std::max(u_r + c_r, u_t + c_t);
-
-                const real c1 = rho_l * (s_l - u_l);
-                const real c2 = rho_r * (s_r - u_r);
-                const real c3 = 1.0 / (c1 - c2);
-                const real c4 = p_l - u_l * c1;
-                const real c5 = p_r - u_r * c2;
-
-                vstar = (c5 - c4) * c3;
-                pstar = (c1 * c5 - c2 * c4) * c3;
-            };
+                const int i = sph[ii];
+                auto &p_i = particles[i];
+                if (!p_i.is_active)
+                {
+                    continue;
+                }
+                p_i.acc = acc_total[i];
+                p_i.dene = dene_total[i];
+            }
         }
 
     }
-}
\ No newline at end of file
+}
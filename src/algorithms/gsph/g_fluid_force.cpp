@@ -5,6 +5,10 @@
 #include "tree/bhtree.hpp"
 #include "kernel/kernel_function.hpp"
 #include "algorithms/gsph/g_fluid_force.hpp"
+#include "algorithms/hll_batch.hpp"
+
+#include "utilities/scratch_buffers.hpp"
+#include "utilities/loop_scheduler.hpp"
 
 #ifdef EXHAUSTIVE_SEARCH
 #include "tree/exhaustive_search.hpp"
@@ -20,8 +24,6 @@ namespace sph
             sph::FluidForce::initialize(param);
             m_is_2nd_order = param->gsph.is_2nd_order;
             m_gamma = param->physics.gamma;
-
-            hll_solver();
         }
 
         // van Leer (1979) limiter
@@ -39,183 +41,203 @@ namespace sph
         }
 
         // Cha & Whitworth (2003)
+        //
+        // Per particle the loop runs in three phases: gather the (optionally
+        // MUSCL-reconstructed) left/right states of every accepted pair into
+        // an HLLBatch, solve all Riemann problems in one vectorized sweep,
+        // then scatter p*/v* back into the force accumulation.
         void FluidForce::calculation(std::shared_ptr<Simulation> sim)
         {
             auto &particles = sim->get_particles();
             auto *periodic = sim->get_periodic().get();
+#ifdef EXHAUSTIVE_SEARCH
             const int num = sim->get_particle_num();
+#endif
             auto *kernel = sim->get_kernel().get();
             auto *tree = sim->get_tree().get();
             const real dt = sim->get_dt();
 
-            // for MUSCL
-            auto &grad_d = sim->get_vector_array("grad_density");
-            auto &grad_p = sim->get_vector_array("grad_pressure");
+            sim->sync_particle_soa();
+            const auto &soa = sim->get_particle_soa();
+            const auto &neighbor_cache = sim->get_neighbor_cache();
+
+            // for MUSCL (handles bound on first use, no per-step name lookups)
+            m_grad_handles.resolve(*sim);
+            auto &grad_d = sim->vector_array(m_grad_handles.grad_d);
+            auto &grad_p = sim->vector_array(m_grad_handles.grad_p);
             vec_t *grad_v[DIM] = {
-                sim->get_vector_array("grad_velocity_0").data(),
+                sim->vector_array(m_grad_handles.grad_v[0]).data(),
 #if DIM == 2
-                sim->get_vector_array("grad_velocity_1").data(),
+                sim->vector_array(m_grad_handles.grad_v[1]).data(),
 #elif DIM == 3
-                sim->get_vector_array("grad_velocity_1").data(),
-                sim->get_vector_array("grad_velocity_2").data(),
+                sim->vector_array(m_grad_handles.grad_v[1]).data(),
+                sim->vector_array(m_grad_handles.grad_v[2]).data(),
 #endif
             };
 
-#pragma omp parallel for
-            for (int i = 0; i < num; ++i)
+            // outer loop over the SPH (fluid + wall) index range: point
+            // masses never enter the sweep
+            const auto &sph = sim->sph_ids();
+            const int n_sph = static_cast<int>(sph.size());
+
+            LoopScheduler::Scope schedule(LoopScheduler::FLUID_FORCE);
+#pragma omp parallel
             {
-                auto &p_i = particles[i];
-                if (p_i.is_point_mass)
+                // pair staging buffers, reused across particles
+                HLLBatch batch;
+                std::vector<int> pair_j;
+                std::vector<vec_t> pair_r_ij;
+
+#pragma omp for schedule(runtime)
+                for (int ii = 0; ii < n_sph; ++ii)
                 {
-                    continue;
-                }
-                std::vector<int> neighbor_list(m_neighbor_number * neighbor_list_size);
+                    const int i = sph[ii];
+                    auto &p_i = particles[i];
+                    if (!p_i.is_active)
+                    {
+                        continue; // block timesteps: forces stay frozen until the bin boundary
+                    }
+                    const int *neighbor_ptr = nullptr;
+                    int n_neighbor = 0;
 
-                // neighbor search
+                    // neighbor list: reuse the per-step cache when available
 #ifdef EXHAUSTIVE_SEARCH
-                int const n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+                    auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                    n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+                    neighbor_ptr = neighbor_list.data();
 #else
-                int const n_neighbor = tree->neighbor_search(p_i, neighbor_list, particles, true);
-#endif
-
-                // fluid force
-                const vec_t &r_i = p_i.pos;
-                const vec_t &v_i = p_i.vel;
-                const real h_i = p_i.sml;
-                const real rho2_inv_i = 1.0 / sqr(p_i.dens);
-
-                vec_t acc(0.0);
-                real dene = 0.0;
-
-                for (int n = 0; n < n_neighbor; ++n)
-                {
-                    int const j = neighbor_list[n];
-                    auto &p_j = particles[j];
-                    if (p_j.is_point_mass)
+                    if (neighbor_cache.is_valid())
                     {
-                        continue;
+                        n_neighbor = neighbor_cache.neighbor_count(i);
+                        neighbor_ptr = neighbor_cache.neighbors(i);
                     }
-                    const vec_t r_ij = periodic->calc_r_ij(r_i, p_j.pos);
-                    const real r = std::abs(r_ij);
-
-                    if (r >= std::max(h_i, p_j.sml) || r == 0.0)
+                    else
                     {
-                        continue;
+                        auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                        n_neighbor = tree->neighbor_search_adaptive(p_i, neighbor_list, particles, true);
+                        neighbor_ptr = neighbor_list.data();
                     }
+#endif
 
-                    const real r_inv = 1.0 / r;
-                    const vec_t e_ij = r_ij * r_inv;
-                    const real ve_i = inner_product(v_i, e_ij);
-                    const real ve_j = inner_product(p_j.vel, e_ij);
-                    real vstar, pstar;
+                    // fluid force
+                    const vec_t &r_i = p_i.pos;
+                    const vec_t &v_i = p_i.vel;
+                    const real h_i = p_i.sml;
+                    const real rho2_inv_i = 1.0 / sqr(p_i.dens);
 
-                    if (m_is_2nd_order)
+                    // phase 1: gather pair states
+                    batch.clear();
+                    pair_j.clear();
+                    pair_r_ij.clear();
+
+                    for (int n = 0; n < n_neighbor; ++n)
                     {
-                        // Murante et al. (2011)
+                        int const j = neighbor_ptr[n];
+                        if (soa.is_point_mass[j])
+                        {
+                            continue;
+                        }
+                        const vec_t r_ij = periodic->calc_r_ij(r_i, soa.pos[j]);
+                        const real r = std::abs(r_ij);
 
-                        real right[4], left[4];
-                        const real delta_i = 0.5 * (1.0 - p_i.sound * dt * r_inv);
-                        const real delta_j = 0.5 * (1.0 - p_j.sound * dt * r_inv);
+                        if (r >= std::max(h_i, soa.sml[j]) || r == 0.0)
+                        {
+                            continue;
+                        }
+
+                        const real r_inv = 1.0 / r;
+                        const vec_t e_ij = r_ij * r_inv;
+                        const real ve_i = inner_product(v_i, e_ij);
+                        const real ve_j = inner_product(soa.vel[j], e_ij);
 
-                        // velocity
-                        const real dv_ij = ve_i - ve_j;
-                        vec_t dv_i, dv_j;
-                        for (int k = 0; k < DIM; ++k)
+                        real right[4], left[4];
+                        if (m_is_2nd_order)
+                        {
+                            // Murante et al. (2011)
+
+                            const real delta_i = 0.5 * (1.0 - p_i.sound * dt * r_inv);
+                            const real delta_j = 0.5 * (1.0 - soa.sound[j] * dt * r_inv);
+
+                            // velocity
+                            const real dv_ij = ve_i - ve_j;
+                            vec_t dv_i, dv_j;
+                            for (int k = 0; k < DIM; ++k)
+                            {
+                                dv_i[k] = inner_product(grad_v[k][i], e_ij);
+                                dv_j[k] = inner_product(grad_v[k][j], e_ij);
+                            }
+                            const real dve_i = inner_product(dv_i, e_ij) * r;
+                            const real dve_j = inner_product(dv_j, e_ij) * r;
+                            right[0] = ve_i - limiter(dv_ij, dve_i) * delta_i;
+                            left[0] = ve_j + limiter(dv_ij, dve_j) * delta_j;
+
+                            // density
+                            const real dd_ij = p_i.dens - soa.dens[j];
+                            const real dd_i = inner_product(grad_d[i], e_ij) * r;
+                            const real dd_j = inner_product(grad_d[j], e_ij) * r;
+                            right[1] = p_i.dens - limiter(dd_ij, dd_i) * delta_i;
+                            left[1] = soa.dens[j] + limiter(dd_ij, dd_j) * delta_j;
+
+                            // pressure
+                            const real dp_ij = p_i.pres - soa.pres[j];
+                            const real dp_i = inner_product(grad_p[i], e_ij) * r;
+                            const real dp_j = inner_product(grad_p[j], e_ij) * r;
+                            right[2] = p_i.pres - limiter(dp_ij, dp_i) * delta_i;
+                            left[2] = soa.pres[j] + limiter(dp_ij, dp_j) * delta_j;
+
+                            // sound speed
+                            right[3] = std::sqrt(m_gamma * right[2] / right[1]);
+                            left[3] = std::sqrt(m_gamma * left[2] / left[1]);
+                        }
+                        else
                         {
-                            dv_i[k] = inner_product(grad_v[k][i], e_ij);
-                            dv_j[k] = inner_product(grad_v[k][j], e_ij);
+                            right[0] = ve_i;
+                            right[1] = p_i.dens;
+                            right[2] = p_i.pres;
+                            right[3] = p_i.sound;
+                            left[0] = ve_j;
+                            left[1] = soa.dens[j];
+                            left[2] = soa.pres[j];
+                            left[3] = soa.sound[j];
                         }
-                        const real dve_i = inner_product(dv_i, e_ij) * r;
-                        const real dve_j = inner_product(dv_j, e_ij) * r;
-                        right[0] = ve_i - limiter(dv_ij, dve_i) * delta_i;
-                        left[0] = ve_j + limiter(dv_ij, dve_j) * delta_j;
-
-                        // density
-                        const real dd_ij = p_i.dens - p_j.dens;
-                        const real dd_i = inner_product(grad_d[i], e_ij) * r;
-                        const real dd_j = inner_product(grad_d[j], e_ij) * r;
-                        right[1] = p_i.dens - limiter(dd_ij, dd_i) * delta_i;
-                        left[1] = p_j.dens + limiter(dd_ij, dd_j) * delta_j;
-
-                        // pressure
-                        const real dp_ij = p_i.pres - p_j.pres;
-                        const real dp_i = inner_product(grad_p[i], e_ij) * r;
-                        const real dp_j = inner_product(grad_p[j], e_ij) * r;
-                        right[2] = p_i.pres - limiter(dp_ij, dp_i) * delta_i;
-                        left[2] = p_j.pres + limiter(dp_ij, dp_j) * delta_j;
-
-                        // sound speed
-                        right[3] = std::sqrt(m_gamma * right[2] / right[1]);
-                        left[3] = std::sqrt(m_gamma * left[2] / left[1]);
-
-                        m_solver(left, right, pstar, vstar);
+
+                        batch.push(left, right);
+                        pair_j.push_back(j);
+                        pair_r_ij.push_back(r_ij);
                     }
-                    else
+
+                    // phase 2: all Riemann problems of this particle at once
+                    batch.solve();
+
+                    // phase 3: scatter p*/v* into the force accumulation
+                    vec_t acc(0.0);
+                    real dene = 0.0;
+
+                    const int n_pair = batch.size();
+                    for (int n = 0; n < n_pair; ++n)
                     {
-                        const real right[4] = {
-                            ve_i,
-                            p_i.dens,
-                            p_i.pres,
-                            p_i.sound,
-                        };
-                        const real left[4] = {
-                            ve_j,
-                            p_j.dens,
-                            p_j.pres,
-                            p_j.sound,
-                        };
-
-                        m_solver(left, right, pstar, vstar);
+                        int const j = pair_j[n];
+                        const vec_t &r_ij = pair_r_ij[n];
+                        const real r = std::abs(r_ij);
+                        const vec_t e_ij = r_ij * (1.0 / r);
+                        const real pstar = batch.pstar(n);
+                        const real vstar = batch.vstar(n);
+
+                        const vec_t dw_i = kernel->dw(r_ij, r, h_i);
+                        const vec_t dw_j = kernel->dw(r_ij, r, soa.sml[j]);
+                        const vec_t v_ij = e_ij * vstar;
+                        const real rho2_inv_j = 1.0 / sqr(soa.dens[j]);
+                        const vec_t f = dw_i * (soa.mass[j] * pstar * rho2_inv_i) + dw_j * (soa.mass[j] * pstar * rho2_inv_j);
+
+                        acc -= f;
+                        dene -= inner_product(f, v_ij - v_i);
                     }
 
-                    const vec_t dw_i = kernel->dw(r_ij, r, h_i);
-                    const vec_t dw_j = kernel->dw(r_ij, r, p_j.sml);
-                    const vec_t v_ij = e_ij * vstar;
-                    const real rho2_inv_j = 1.0 / sqr(p_j.dens);
-                    const vec_t f = dw_i * (p_j.mass * pstar * rho2_inv_i) + dw_j * (p_j.mass * pstar * rho2_inv_j);
-
-                    acc -= f;
-                    dene -= inner_product(f, v_ij - v_i);
+                    p_i.acc = acc;
+                    p_i.dene = dene;
                 }
-
-                p_i.acc = acc;
-                p_i.dene = dene;
             }
         }
 
-        void FluidForce::hll_solver()
-        {
-            m_solver = [&](const real left[], const real right[], real &pstar, real &vstar)
-            {
-                const real u_l = left[0];
-                const real rho_l = left[1];
-                const real p_l = left[2];
-                const real c_l = left[3];
-
-                const real u_r = right[0];
-                const real rho_r = right[1];
-                const real p_r = right[2];
-                const real c_r = right[3];
-
-                const real roe_l = std::sqrt(rho_l);
-                const real roe_r = std::sqrt(rho_r);
-                const real roe_inv = 1.0 / (roe_l + roe_r);
-
-                const real u_t = (roe_l * u_l + roe_r * u_r) * roe_inv;
-                const real c_t = (roe_l * c_l + roe_r * c_r) * roe_inv;
-                const real s_l = std::min(u_l - c_l, u_t - c_t);
-                const real s_r = std::max(u_r + c_r, u_t + c_t);
-
-                const real c1 = rho_l * (s_l - u_l);
-                const real c2 = rho_r * (s_r - u_r);
-                const real c3 = 1.0 / (c1 - c2);
-                const real c4 = p_l - u_l * c1;
-                const real c5 = p_r - u_r * c2;
-
-                vstar = (c5 - c4) * c3;
-                pstar = (c1 * c5 - c2 * c4) * c3;
-            };
-        }
-
     }
-}
\ No newline at end of file
+}
@@ -3,6 +3,7 @@
  * Modified for anisotropic kernel support (GSPH version)
  * ================================ */
 #include <algorithm>
+#include <limits>
 #include "core/parameters.hpp"
 #include "algorithms/gsph/g_pre_interaction.hpp"
 #include "core/simulation.hpp"
@@ -11,6 +12,8 @@
 #include "kernel/kernel_function.hpp"
 #include "utilities/exception.hpp"
 #include "tree/bhtree.hpp"
+#include "utilities/scratch_buffers.hpp"
+#include "utilities/loop_scheduler.hpp"
 
 #ifdef EXHAUSTIVE_SEARCH
 #include "tree/exhaustive_search.hpp"
@@ -22,7 +25,7 @@ namespace sph
         real PreInteraction::newton_raphson(
             const SPHParticle &p_i,
             const std::vector<SPHParticle> &particles,
-            const std::vector<int> &neighbor_list,
+            const int *neighbor_list,
             const int n_neighbor,
             const Periodic *periodic,
             const KernelFunction *kernel)
@@ -50,131 +53,161 @@ namespace sph
             }
             auto &particles = sim->get_particles();
             auto *periodic = sim->get_periodic().get();
+#ifdef EXHAUSTIVE_SEARCH
             const int num = sim->get_particle_num();
+#endif
             auto *kernel = sim->get_kernel().get();
             auto *tree = sim->get_tree().get();
+            const auto &neighbor_cache = sim->get_neighbor_cache();
 
             omp_real h_per_v_sig(std::numeric_limits<real>::max());
-            // for MUSCL
-            auto &grad_d = sim->get_vector_array("grad_density");
-            auto &grad_p = sim->get_vector_array("grad_pressure");
+            // for MUSCL (handles bound on first use, no per-step name lookups)
+            m_grad_handles.resolve(*sim);
+            auto &grad_d = sim->vector_array(m_grad_handles.grad_d);
+            auto &grad_p = sim->vector_array(m_grad_handles.grad_p);
             vec_t *grad_v[DIM] = {
-                sim->get_vector_array("grad_velocity_0").data(),
+                sim->vector_array(m_grad_handles.grad_v[0]).data(),
 #if DIM == 2
-                sim->get_vector_array("grad_velocity_1").data(),
+                sim->vector_array(m_grad_handles.grad_v[1]).data(),
 #elif DIM == 3
-                sim->get_vector_array("grad_velocity_1").data(),
-                sim->get_vector_array("grad_velocity_2").data(),
+                sim->vector_array(m_grad_handles.grad_v[1]).data(),
+                sim->vector_array(m_grad_handles.grad_v[2]).data(),
 #endif
             };
-#pragma omp parallel for
-            for (int i = 0; i < num; ++i)
+
+            // 2.5D/anisotropic are fixed per run: hoist the effective-dimension
+            // constants out of the per-particle loop.
+            const int effectiveDim = (m_anisotropic || m_twoAndHalf) ? 2 : DIM;
+            const real A_eff = (effectiveDim == 1 ? 2.0 : (effectiveDim == 2 ? M_PI : 4.0 * M_PI / 3.0));
+
+            // point masses are out of the index range, not branched over
+            const auto &sph = sim->sph_ids();
+            const int n_sph = static_cast<int>(sph.size());
+
+            LoopScheduler::Scope schedule(LoopScheduler::PRE_INTERACTION);
+#pragma omp parallel
             {
-                auto &p_i = particles[i];
-                if (p_i.is_point_mass)
-                {
-                    continue;
-                }
-                std::vector<int> neighbor_list(m_neighbor_number * neighbor_list_size);
-                int effectiveDim;
-                real A_eff;
-                if (m_anisotropic)
-                {
-                    effectiveDim = 2;
-                    A_eff = M_PI;
-                    p_i.sml = std::pow(m_neighbor_number * p_i.mass / (p_i.dens * A_eff), 1.0 / 2.0) * m_kernel_ratio;
-                }
-                else
+                // per-thread running minimum of h/v_sig, published to the
+                // shared slot once per thread instead of per particle
+                real h_vs_thread = std::numeric_limits<real>::max();
+#pragma omp for schedule(runtime)
+                for (int ii = 0; ii < n_sph; ++ii)
                 {
-                    effectiveDim = m_twoAndHalf ? 2 : DIM;
-                    A_eff = (effectiveDim == 1 ? 2.0 : (effectiveDim == 2 ? M_PI : 4.0 * M_PI / 3.0));
+                    const int i = sph[ii];
+                    auto &p_i = particles[i];
+                    if (!p_i.is_active)
+                    {
+                        continue; // block timesteps: forces stay frozen until the bin boundary
+                    }
                     p_i.sml = std::pow(m_neighbor_number * p_i.mass / (p_i.dens * A_eff), 1.0 / effectiveDim) * m_kernel_ratio;
-                }
+                    const int *neighbor_ptr = nullptr;
+                    int n_neighbor = 0;
 #ifdef EXHAUSTIVE_SEARCH
-                int n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num,
+                    auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                    n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num,
                                                    neighbor_list, m_neighbor_number * neighbor_list_size,
                                                    periodic, false);
+                    neighbor_ptr = neighbor_list.data();
 #else
-                int n_neighbor = sim->get_tree()->neighbor_search(p_i, neighbor_list, particles, false);
-#endif
-                int n_neighbor_tmp = 0;
-
-                // density etc.
-                real dens_i = 0.0;
-                real v_sig_max = p_i.sound * 2.0;
-                const vec_t &pos_i = p_i.pos;
-                for (int n = 0; n < n_neighbor; ++n)
-                {
-                    int j = neighbor_list[n];
-                    auto &p_j = particles[j];
-                    if (p_j.is_point_mass)
+                    // Verlet mode: skin-inflated lists from the previous step stay valid
+                    if (neighbor_cache.is_valid())
                     {
-                        continue;
-                    }
-                    vec_t r_ij = periodic->calc_r_ij(p_i.pos, p_j.pos);
-                    real r = std::abs(r_ij);
-                    if (m_anisotropic)
-                    {
-                        real r_xy = std::sqrt(r_ij[0] * r_ij[0] + r_ij[1] * r_ij[1]);
-                        real r_aniso = std::sqrt((r_xy / p_i.sml) * (r_xy / p_i.sml) +
-                                                 (r_ij[2] / m_hz) * (r_ij[2] / m_hz));
-                        if (r_aniso >= 1.0)
-                            continue;
+                        n_neighbor = neighbor_cache.neighbor_count(i);
+                        neighbor_ptr = neighbor_cache.neighbors(i);
                     }
                     else
                     {
-                        if (r >= p_i.sml)
-                            continue;
+                        auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                        n_neighbor = sim->get_tree()->neighbor_search_adaptive(p_i, neighbor_list, particles, false);
+                        neighbor_ptr = neighbor_list.data();
                     }
-                    ++n_neighbor_tmp;
-                    dens_i += p_j.mass * kernel->w(r, p_i.sml);
-                    if (i != j)
+#endif
+                    int n_neighbor_tmp = 0;
+
+                    // density etc., fused with the MUSCL gradient sums so the
+                    // neighbor list is swept only once. The MUSCL terms have no
+                    // radius or point-mass filter (dw vanishes outside the kernel
+                    // support), matching the separate pass they replace.
+                    real dens_i = 0.0;
+                    real v_sig_max = p_i.sound * 2.0;
+                    const vec_t &pos_i = p_i.pos;
+                    vec_t dd, du; // dP = (gamma - 1) * (rho * du + drho * u)
+                    vec_t dv[DIM];
+                    for (int n = 0; n < n_neighbor; ++n)
                     {
-                        real r_local = std::abs(r_ij);
-                        real v_sig = p_i.sound + p_j.sound - 3.0 * inner_product(r_ij, p_i.vel - p_j.vel) / (r_local + 1e-12);
-                        if (v_sig > v_sig_max)
+                        int j = neighbor_ptr[n];
+                        auto &p_j = particles[j];
+                        vec_t r_ij = periodic->calc_r_ij(pos_i, p_j.pos);
+                        real r = std::abs(r_ij);
+
+                        if (m_is_2nd_order)
                         {
-                            v_sig_max = v_sig;
+                            const vec_t dw_ij = kernel->dw(r_ij, r, p_i.sml);
+                            dd += dw_ij * p_j.mass;
+                            du += dw_ij * (p_j.mass * (p_j.ene - p_i.ene));
+                            for (int k = 0; k < DIM; ++k)
+                            {
+                                dv[k] += dw_ij * (p_j.mass * (p_j.vel[k] - p_i.vel[k]));
+                            }
+                        }
+
+                        if (p_j.is_point_mass)
+                        {
+                            continue;
+                        }
+                        if (m_anisotropic)
+                        {
+                            real r_xy = std::sqrt(r_ij[0] * r_ij[0] + r_ij[1] * r_ij[1]);
+                            real r_aniso = std::sqrt((r_xy / p_i.sml) * (r_xy / p_i.sml) +
+                                                     (r_ij[2] / m_hz) * (r_ij[2] / m_hz));
+                            if (r_aniso >= 1.0)
+                                continue;
+                        }
+                        else
+                        {
+                            if (r >= p_i.sml)
+                                continue;
+                        }
+                        ++n_neighbor_tmp;
+                        dens_i += p_j.mass * kernel->w(r, p_i.sml);
+                        if (i != j)
+                        {
+                            real r_local = std::abs(r_ij);
+                            real v_sig = p_i.sound + p_j.sound - 3.0 * inner_product(r_ij, p_i.vel - p_j.vel) / (r_local + 1e-12);
+                            if (v_sig > v_sig_max)
+                            {
+                                v_sig_max = v_sig;
+                            }
                         }
                     }
-                }
-                p_i.dens = dens_i;
-                p_i.pres = (m_gamma - 1.0) * dens_i * p_i.ene;
-                p_i.neighbor = n_neighbor_tmp;
-                const real h_per_v_sig_i = p_i.sml / v_sig_max;
-                if (h_per_v_sig.get() > h_per_v_sig_i)
-                {
-                    h_per_v_sig.get() = h_per_v_sig_i;
-                }
+                    p_i.dens = dens_i;
+                    p_i.pres = (m_gamma - 1.0) * dens_i * p_i.ene;
+                    p_i.neighbor = n_neighbor_tmp;
+                    const real h_per_v_sig_i = p_i.sml / v_sig_max;
+                    p_i.h_per_v_sig = h_per_v_sig_i;
+                    if (h_per_v_sig_i < h_vs_thread)
+                    {
+                        h_vs_thread = h_per_v_sig_i;
+                    }
 
-                // MUSCL法のための勾配計算
-                if (!m_is_2nd_order)
-                {
-                    continue;
-                }
+                    // MUSCL法のための勾配計算（和は上の融合ループで計算済み）
+                    if (!m_is_2nd_order)
+                    {
+                        continue;
+                    }
 
-                vec_t dd, du; // dP = (gamma - 1) * (rho * du + drho * u)
-                vec_t dv[DIM];
-                for (int n = 0; n < n_neighbor; ++n)
-                {
-                    int const j = neighbor_list[n];
-                    auto &p_j = particles[j];
-                    const vec_t r_ij = periodic->calc_r_ij(pos_i, p_j.pos);
-                    const real r = std::abs(r_ij);
-                    const vec_t dw_ij = kernel->dw(r_ij, r, p_i.sml);
-                    dd += dw_ij * p_j.mass;
-                    du += dw_ij * (p_j.mass * (p_j.ene - p_i.ene));
+                    grad_d[i] = dd;
+                    grad_p[i] = (dd * p_i.ene + du) * (m_gamma - 1.0);
+                    const real rho_inv = 1.0 / p_i.dens;
                     for (int k = 0; k < DIM; ++k)
                     {
-                        dv[k] += dw_ij * (p_j.mass * (p_j.vel[k] - p_i.vel[k]));
+                        grad_v[k][i] = dv[k] * rho_inv;
                     }
                 }
-                grad_d[i] = dd;
-                grad_p[i] = (dd * p_i.ene + du) * (m_gamma - 1.0);
-                const real rho_inv = 1.0 / p_i.dens;
-                for (int k = 0; k < DIM; ++k)
+
+                if (h_vs_thread < h_per_v_sig.get())
                 {
-                    grad_v[k][i] = dv[k] * rho_inv;
+                    h_per_v_sig.get() = h_vs_thread;
                 }
             }
 
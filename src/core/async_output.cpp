@@ -0,0 +1,113 @@
+#include "core/async_output.hpp"
+#include "core/simulation.hpp"
+#include "core/output_format.hpp"
+#include "core/logger.hpp"
+
+namespace sph
+{
+
+    AsyncOutputManager::AsyncOutputManager(const std::size_t max_pending)
+        : m_max_pending(max_pending), m_stop(false), m_busy(false)
+    {
+        m_worker = std::thread([this]
+                               { worker_loop(); });
+    }
+
+    AsyncOutputManager::~AsyncOutputManager()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv_push.notify_all();
+        if (m_worker.joinable())
+        {
+            m_worker.join();
+        }
+    }
+
+    void AsyncOutputManager::worker_loop()
+    {
+        while (true)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv_push.wait(lock, [this]
+                               { return m_stop || !m_jobs.empty(); });
+                if (m_jobs.empty())
+                {
+                    return; // stop requested and nothing left to write
+                }
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+                m_busy = true;
+            }
+
+            if (!job.writers.empty())
+            {
+                // One shared serialization pass for all formats (every
+                // writer of a run shares the same unit system)
+                SnapshotStage stage;
+                stage.build(*job.staged, job.writers.front()->units());
+                for (auto &writer : job.writers)
+                {
+                    writer->write_staged(stage);
+                }
+            }
+            job.staged.reset();
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_busy = false;
+            }
+            m_cv_pop.notify_all();
+        }
+    }
+
+    void AsyncOutputManager::enqueue(std::shared_ptr<Simulation> sim,
+                                     const std::vector<std::shared_ptr<OutputWriter>> &writers)
+    {
+        // Deep-copy the particle vector (shared pointers like the tree are
+        // shared, but the writers never touch them) so integration can keep
+        // mutating the live simulation while the worker serializes this one.
+        Job job;
+        job.staged = std::make_shared<Simulation>(*sim);
+        job.writers = writers;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_jobs.size() >= m_max_pending)
+            {
+                WRITE_LOG << "Async output: writer is behind, waiting for the queue to drain";
+            }
+            m_cv_pop.wait(lock, [this]
+                          { return m_jobs.size() < m_max_pending; });
+            m_jobs.push_back(std::move(job));
+        }
+        m_cv_push.notify_one();
+    }
+
+    void AsyncOutputManager::flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv_pop.wait(lock, [this]
+                      { return m_jobs.empty() && !m_busy; });
+    }
+
+    void AsyncOutputManager::discard_pending()
+    {
+        std::size_t dropped = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            dropped = m_jobs.size();
+            m_jobs.clear();
+        }
+        m_cv_pop.notify_all();
+        if (dropped > 0)
+        {
+            WRITE_LOG << "Async output: dropped " << dropped << " queued snapshot(s)";
+        }
+    }
+
+}
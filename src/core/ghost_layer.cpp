@@ -0,0 +1,145 @@
+#include <algorithm>
+
+#include "core/ghost_layer.hpp"
+#include "core/simulation.hpp"
+#include "core/particle.hpp"
+#include "core/parameters.hpp"
+
+namespace sph
+{
+
+    void GhostLayer::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        m_enabled = param->periodic.is_valid && param->periodic.use_ghosts;
+        if (!m_enabled)
+        {
+            return;
+        }
+        for (int i = 0; i < DIM; ++i)
+        {
+            m_min[i] = param->periodic.range_min[i];
+            m_max[i] = param->periodic.range_max[i];
+            m_range[i] = m_max[i] - m_min[i];
+        }
+        m_skin_factor = param->verlet.is_valid ? param->verlet.skin_factor : 0.0;
+    }
+
+    void GhostLayer::build(std::shared_ptr<Simulation> sim)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        auto &particles = sim->get_particles();
+        m_real_num = sim->get_particle_num();
+        particles.resize(m_real_num);
+
+        // Image margin: the current largest smoothing length with the same
+        // slack as the MPI halo width — 10% for lengths that grow during the
+        // smoothing-length iteration plus the Verlet skin.
+        real h_max = 0.0;
+        for (int i = 0; i < m_real_num; ++i)
+        {
+            h_max = std::max(h_max, particles[i].sml);
+        }
+        const real w = h_max * (1.1 + m_skin_factor);
+
+        m_source.clear();
+        m_shift.clear();
+        for (int i = 0; i < m_real_num; ++i)
+        {
+            const vec_t &pos = particles[i].pos;
+
+            // per-axis image offsets: +range near the lower face, -range
+            // near the upper one (both when the margin spans the box)
+            real offset[DIM][2];
+            int n_offset[DIM];
+            for (int d = 0; d < DIM; ++d)
+            {
+                n_offset[d] = 0;
+                if (pos[d] < m_min[d] + w)
+                {
+                    offset[d][n_offset[d]++] = m_range[d];
+                }
+                if (pos[d] > m_max[d] - w)
+                {
+                    offset[d][n_offset[d]++] = -m_range[d];
+                }
+            }
+
+            // every face/edge/corner image: the product of the per-axis
+            // choices {0} ∪ offset[d], skipping the all-zero combination
+            int combinations = 1;
+            for (int d = 0; d < DIM; ++d)
+            {
+                combinations *= n_offset[d] + 1;
+            }
+            for (int c = 1; c < combinations; ++c)
+            {
+                vec_t shift(0.0);
+                int rest = c;
+                for (int d = 0; d < DIM; ++d)
+                {
+                    const int pick = rest % (n_offset[d] + 1);
+                    rest /= n_offset[d] + 1;
+                    if (pick > 0)
+                    {
+                        shift[d] = offset[d][pick - 1];
+                    }
+                }
+                m_source.push_back(i);
+                m_shift.push_back(shift);
+            }
+        }
+
+        const int n_ghost = static_cast<int>(m_source.size());
+        particles.resize(m_real_num + n_ghost);
+
+#pragma omp parallel for
+        for (int g = 0; g < n_ghost; ++g)
+        {
+            SPHParticle &ghost = particles[m_real_num + g];
+            ghost = particles[m_source[g]];
+            ghost.pos += m_shift[g];
+            ghost.id = m_real_num + g;   // id == index, like everywhere else
+            ghost.is_active = false;     // source only: never a force target
+        }
+
+        sim->set_particle_num(m_real_num + n_ghost);
+    }
+
+    void GhostLayer::refresh(std::shared_ptr<Simulation> sim)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        auto &particles = sim->get_particles();
+        const int n_ghost = static_cast<int>(m_source.size());
+
+#pragma omp parallel for
+        for (int g = 0; g < n_ghost; ++g)
+        {
+            SPHParticle &ghost = particles[m_real_num + g];
+            ghost = particles[m_source[g]];
+            ghost.pos += m_shift[g];
+            ghost.id = m_real_num + g;
+            ghost.is_active = false;
+        }
+    }
+
+    void GhostLayer::drop(std::shared_ptr<Simulation> sim)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        auto &particles = sim->get_particles();
+        particles.resize(m_real_num);
+        sim->set_particle_num(m_real_num);
+    }
+
+}
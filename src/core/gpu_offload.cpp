@@ -0,0 +1,602 @@
+#include "core/gpu_offload.hpp"
+#include "core/parameters.hpp"
+#include "core/simulation.hpp"
+#include "core/logger.hpp"
+#include "kernel/kernel_function.hpp"
+
+#ifdef USE_GPU_OFFLOAD
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sph
+{
+
+#ifndef USE_GPU_OFFLOAD
+
+    // Built without offload: accept (and report) the config key, run nothing.
+    GpuOffload::~GpuOffload() = default;
+
+    void GpuOffload::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        if (param->gpu_offload)
+        {
+            WRITE_LOG << "gpuOffload requested but this build has no offload engine"
+                      << " (configure with -DUSE_GPU_OFFLOAD=ON); running on the host";
+        }
+    }
+
+    bool GpuOffload::density(Simulation &) { return false; }
+    bool GpuOffload::fluid_force(Simulation &) { return false; }
+
+    void GpuOffload::ensure_capacity(const int, const int) {}
+    void GpuOffload::release_device() {}
+    bool GpuOffload::upload(Simulation &) { return false; }
+
+#else
+
+    namespace
+    {
+        // Device-side cubic spline, mirroring Spline::Cubic with the
+        // normalization precomputed on the host. Only called with r < h
+        // (and r > 0 for the gradient coefficient).
+#pragma omp declare target
+        inline real powh_kd(const real h, const int kd)
+        {
+            return kd == 1 ? h : kd == 2 ? h * h
+                                         : h * h * h;
+        }
+
+        inline real cubic_w(const real r, const real h, const int kd, const real sigma)
+        {
+            const real h_ = 0.5 * h;
+            const real q = r / h_;
+            return sigma / powh_kd(h_, kd) * (0.25 * pow3(0.5 * (2.0 - q + std::abs(2.0 - q))) - pow3(0.5 * (1.0 - q + std::abs(1.0 - q))));
+        }
+
+        // scalar coefficient c with grad W = r_ij * c
+        inline real cubic_dw_c(const real r, const real h, const int kd, const real sigma)
+        {
+            const real h_ = 0.5 * h;
+            const real q = r / h_;
+            return -sigma / (powh_kd(h_, kd) * h_ * r) * (0.75 * sqr(0.5 * (2.0 - q + std::abs(2.0 - q))) - 3.0 * sqr(0.5 * (1.0 - q + std::abs(1.0 - q))));
+        }
+
+        inline real cubic_dhw(const real r, const real h, const int kd, const real sigma)
+        {
+            const real h_ = 0.5 * h;
+            const real q = r / h_;
+            return 0.5 * sigma / (powh_kd(h_, kd) * h_) * (sqr((std::abs(2.0 - q) + 2.0 - q) * 0.5) * ((3.0 + kd) * 0.25 * q - 0.5 * kd) + sqr((std::abs(1.0 - q) + 1.0 - q) * 0.5) * ((-3.0 - kd) * q + kd));
+        }
+
+        // minimum-image separation, component-wise (same three-candidate
+        // choice Periodic::calc_r_ij makes)
+        inline real min_image(const real dx, const real range)
+        {
+            const real dx_p = dx + range;
+            const real dx_m = dx - range;
+            real best = dx;
+            if (std::abs(dx_p) < std::abs(best))
+            {
+                best = dx_p;
+            }
+            if (std::abs(dx_m) < std::abs(best))
+            {
+                best = dx_m;
+            }
+            return best;
+        }
+#pragma omp end declare target
+    }
+
+    GpuOffload::~GpuOffload()
+    {
+        release_device();
+    }
+
+    void GpuOffload::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        m_active = false;
+        if (!param->gpu_offload)
+        {
+            return;
+        }
+
+        if (omp_get_num_devices() < 1)
+        {
+            WRITE_LOG << "gpuOffload requested but no offload device is available; running on the host";
+            return;
+        }
+
+        if (param->kernel != KernelType::CUBIC_SPLINE || param->anisotropic)
+        {
+            WRITE_LOG << "gpuOffload supports the (isotropic) cubic-spline kernel only; running on the host";
+            return;
+        }
+
+        m_kd = kernelDim(param->two_and_half_sim);
+        m_sigma = m_kd == 1 ? 2.0 / 3.0 : m_kd == 2 ? 10.0 / (7.0 * M_PI)
+                                                    : 1.0 / M_PI;
+        m_gamma = param->physics.gamma;
+        m_neighbor_number = param->physics.neighbor_number;
+        m_periodic = param->periodic.is_valid;
+        for (int d = 0; d < DIM; ++d)
+        {
+            m_range[d] = m_periodic ? param->periodic.range_max[d] - param->periodic.range_min[d] : 0.0;
+        }
+
+        m_active = true;
+        WRITE_LOG << "GPU offload engine enabled on device " << omp_get_default_device()
+                  << " (" << omp_get_num_devices() << " device(s) found)";
+    }
+
+    // GCC does not count a map-clause or target-update appearance as a use
+    // of the pointer variables the array sections are built from, so the
+    // transfer helpers would warn on every array they manage.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+    void GpuOffload::release_device()
+    {
+        if (m_capacity > 0)
+        {
+            real *pos = m_pos.data();
+            real *vel = m_vel.data();
+            real *mass = m_mass.data();
+            real *dens = m_dens.data();
+            real *pres = m_pres.data();
+            real *sml = m_sml.data();
+            real *sound = m_sound.data();
+            real *gradh = m_gradh.data();
+            real *alpha = m_alpha.data();
+            real *balsara = m_balsara.data();
+            unsigned char *point_mass = m_point_mass.data();
+            unsigned char *active = m_is_active.data();
+            int *offsets = m_offsets.data();
+            real *acc = m_acc.data();
+            real *dene = m_dene.data();
+            int *neighbor_count = m_neighbor_count.data();
+            const int cap = m_capacity;
+#pragma omp target exit data map(delete : pos[0 : cap * DIM], vel[0 : cap * DIM], \
+                                     mass[0 : cap], dens[0 : cap], pres[0 : cap], \
+                                     sml[0 : cap], sound[0 : cap], gradh[0 : cap], \
+                                     alpha[0 : cap], balsara[0 : cap],             \
+                                     point_mass[0 : cap], active[0 : cap],         \
+                                     offsets[0 : cap + 1], acc[0 : cap * DIM],     \
+                                     dene[0 : cap], neighbor_count[0 : cap])
+            m_capacity = 0;
+        }
+        if (m_index_capacity > 0)
+        {
+            int *indices = m_indices.data();
+            const int icap = m_index_capacity;
+#pragma omp target exit data map(delete : indices[0 : icap])
+            m_index_capacity = 0;
+        }
+    }
+
+    void GpuOffload::ensure_capacity(const int particle_num, const int index_num)
+    {
+        // Re-allocating remaps the host pointers, so grow with headroom to
+        // keep the arrays resident across normal steps.
+        if (particle_num > m_capacity || index_num > m_index_capacity)
+        {
+            release_device();
+
+            m_capacity = particle_num + particle_num / 4;
+            m_index_capacity = index_num + index_num / 4;
+            const int cap = m_capacity;
+            const int icap = m_index_capacity;
+
+            m_pos.resize(cap * DIM);
+            m_vel.resize(cap * DIM);
+            m_mass.resize(cap);
+            m_dens.resize(cap);
+            m_pres.resize(cap);
+            m_sml.resize(cap);
+            m_sound.resize(cap);
+            m_gradh.resize(cap);
+            m_alpha.resize(cap);
+            m_balsara.resize(cap);
+            m_point_mass.resize(cap);
+            m_is_active.resize(cap);
+            m_offsets.resize(cap + 1);
+            m_acc.resize(cap * DIM);
+            m_dene.resize(cap);
+            m_neighbor_count.resize(cap);
+            m_indices.resize(icap);
+
+            real *pos = m_pos.data();
+            real *vel = m_vel.data();
+            real *mass = m_mass.data();
+            real *dens = m_dens.data();
+            real *pres = m_pres.data();
+            real *sml = m_sml.data();
+            real *sound = m_sound.data();
+            real *gradh = m_gradh.data();
+            real *alpha = m_alpha.data();
+            real *balsara = m_balsara.data();
+            unsigned char *point_mass = m_point_mass.data();
+            unsigned char *active = m_is_active.data();
+            int *offsets = m_offsets.data();
+            real *acc = m_acc.data();
+            real *dene = m_dene.data();
+            int *neighbor_count = m_neighbor_count.data();
+            int *indices = m_indices.data();
+#pragma omp target enter data map(alloc : pos[0 : cap * DIM], vel[0 : cap * DIM],   \
+                                      mass[0 : cap], dens[0 : cap], pres[0 : cap],  \
+                                      sml[0 : cap], sound[0 : cap], gradh[0 : cap], \
+                                      alpha[0 : cap], balsara[0 : cap],             \
+                                      point_mass[0 : cap], active[0 : cap],         \
+                                      offsets[0 : cap + 1], acc[0 : cap * DIM],     \
+                                      dene[0 : cap], neighbor_count[0 : cap],       \
+                                      indices[0 : icap])
+        }
+    }
+
+    bool GpuOffload::upload(Simulation &sim)
+    {
+        const auto &cache = sim.get_neighbor_cache();
+        if (!cache.is_valid())
+        {
+            return false; // tree-walk searches stay on the host
+        }
+
+        sim.sync_particle_soa();
+        const auto &soa = sim.get_particle_soa();
+        const int num = soa.size();
+        if (num == 0)
+        {
+            return false;
+        }
+
+        int total = 0;
+        for (int i = 0; i < num; ++i)
+        {
+            total += cache.neighbor_count(i);
+        }
+        ensure_capacity(num, total);
+
+        m_offsets[0] = 0;
+        for (int i = 0; i < num; ++i)
+        {
+            m_offsets[i + 1] = m_offsets[i] + cache.neighbor_count(i);
+        }
+        std::copy(cache.neighbors(0), cache.neighbors(0) + total, m_indices.begin());
+
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+        {
+            for (int d = 0; d < DIM; ++d)
+            {
+                m_pos[i * DIM + d] = soa.pos[i][d];
+                m_vel[i * DIM + d] = soa.vel[i][d];
+            }
+            m_mass[i] = soa.mass[i];
+            m_dens[i] = soa.dens[i];
+            m_pres[i] = soa.pres[i];
+            m_sml[i] = soa.sml[i];
+            m_sound[i] = soa.sound[i];
+            m_gradh[i] = soa.gradh[i];
+            m_alpha[i] = soa.alpha[i];
+            m_balsara[i] = soa.balsara[i];
+            m_point_mass[i] = soa.is_point_mass[i];
+            m_is_active[i] = soa.is_active[i];
+        }
+
+        real *pos = m_pos.data();
+        real *vel = m_vel.data();
+        real *mass = m_mass.data();
+        real *dens = m_dens.data();
+        real *pres = m_pres.data();
+        real *sml = m_sml.data();
+        real *sound = m_sound.data();
+        real *gradh = m_gradh.data();
+        real *alpha = m_alpha.data();
+        real *balsara = m_balsara.data();
+        unsigned char *point_mass = m_point_mass.data();
+        unsigned char *active = m_is_active.data();
+        int *offsets = m_offsets.data();
+        int *indices = m_indices.data();
+#pragma omp target update to(pos[0 : num * DIM], vel[0 : num * DIM], mass[0 : num],   \
+                                 dens[0 : num], pres[0 : num], sml[0 : num],          \
+                                 sound[0 : num], gradh[0 : num], alpha[0 : num],      \
+                                 balsara[0 : num], point_mass[0 : num],               \
+                                 active[0 : num], offsets[0 : num + 1],               \
+                                 indices[0 : total])
+        return true;
+    }
+
+#pragma GCC diagnostic pop
+
+    bool GpuOffload::density(Simulation &sim)
+    {
+        if (!m_active || !upload(sim))
+        {
+            return false;
+        }
+
+        const int num = sim.get_particle_num();
+        const int kd = m_kd;
+        const real sigma = m_sigma;
+        const real gamma = m_gamma;
+        const real nn = static_cast<real>(m_neighbor_number);
+        const real A_eff = kd == 1 ? 2.0 : kd == 2 ? M_PI
+                                                   : 4.0 * M_PI / 3.0;
+        const bool periodic = m_periodic;
+        real range[DIM];
+        for (int d = 0; d < DIM; ++d)
+        {
+            range[d] = m_range[d];
+        }
+
+        const real *pos = m_pos.data();
+        const real *vel = m_vel.data();
+        const real *mass = m_mass.data();
+        const real *sound = m_sound.data();
+        const unsigned char *point_mass = m_point_mass.data();
+        const unsigned char *active = m_is_active.data();
+        const int *offsets = m_offsets.data();
+        const int *indices = m_indices.data();
+        real *dens = m_dens.data();
+        real *sml = m_sml.data();
+        real *gradh = m_gradh.data();
+        int *neighbor_count = m_neighbor_count.data();
+
+        real h_per_v_sig = std::numeric_limits<real>::max();
+
+#pragma omp target teams distribute parallel for reduction(min : h_per_v_sig) \
+    map(to : range[0 : DIM]) map(tofrom : h_per_v_sig)
+        for (int i = 0; i < num; ++i)
+        {
+            if (point_mass[i] || !active[i])
+            {
+                continue;
+            }
+
+            // fixed-h estimate (kernel_ratio is 1 on this path)
+            const real h_i = std::pow(nn * mass[i] / (dens[i] * A_eff), 1.0 / kd);
+
+            real dens_i = 0.0;
+            real dh_dens_i = 0.0;
+            real v_sig_max = sound[i] * 2.0;
+            int count = 0;
+
+            const int n_begin = offsets[i];
+            const int n_end = offsets[i + 1];
+            for (int n = n_begin; n < n_end; ++n)
+            {
+                const int j = indices[n];
+                if (point_mass[j])
+                {
+                    continue;
+                }
+
+                real r_ij[DIM];
+                real r2 = 0.0;
+                for (int d = 0; d < DIM; ++d)
+                {
+                    real dx = pos[i * DIM + d] - pos[j * DIM + d];
+                    if (periodic)
+                    {
+                        dx = min_image(dx, range[d]);
+                    }
+                    r_ij[d] = dx;
+                    r2 += dx * dx;
+                }
+                const real r = std::sqrt(r2);
+                if (r >= h_i)
+                {
+                    continue;
+                }
+
+                dens_i += mass[j] * cubic_w(r, h_i, kd, sigma);
+                dh_dens_i += mass[j] * cubic_dhw(r, h_i, kd, sigma);
+                ++count;
+
+                if (i != j)
+                {
+                    real vr = 0.0;
+                    for (int d = 0; d < DIM; ++d)
+                    {
+                        vr += r_ij[d] * (vel[i * DIM + d] - vel[j * DIM + d]);
+                    }
+                    const real v_sig = (sound[i] + sound[j]) - 3.0 * vr / (r + 1e-12);
+                    if (v_sig > v_sig_max)
+                    {
+                        v_sig_max = v_sig;
+                    }
+                }
+            }
+
+            dens[i] = dens_i;
+            sml[i] = h_i;
+            gradh[i] = 1.0 / (1.0 + (h_i / (kd * dens_i + 1e-12)) * dh_dens_i);
+            neighbor_count[i] = count;
+
+            const real h_vs_i = h_i / (v_sig_max + 1e-12);
+            if (h_vs_i < h_per_v_sig)
+            {
+                h_per_v_sig = h_vs_i;
+            }
+        }
+
+#pragma omp target update from(dens[0 : num], sml[0 : num], gradh[0 : num], \
+                                   neighbor_count[0 : num])
+
+        auto &particles = sim.get_particles();
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+        {
+            auto &p_i = particles[i];
+            if (p_i.is_point_mass || !p_i.is_active)
+            {
+                continue;
+            }
+            p_i.dens = m_dens[i];
+            p_i.pres = (gamma - 1.0) * m_dens[i] * p_i.ene;
+            p_i.sml = m_sml[i];
+            p_i.gradh = m_gradh[i];
+            p_i.neighbor = m_neighbor_count[i];
+        }
+
+        sim.set_h_per_v_sig(h_per_v_sig);
+        return true;
+    }
+
+    bool GpuOffload::fluid_force(Simulation &sim)
+    {
+        if (!m_active || !upload(sim))
+        {
+            return false;
+        }
+
+        const int num = sim.get_particle_num();
+        const int kd = m_kd;
+        const real sigma = m_sigma;
+        const bool periodic = m_periodic;
+        real range[DIM];
+        for (int d = 0; d < DIM; ++d)
+        {
+            range[d] = m_range[d];
+        }
+
+        const real *pos = m_pos.data();
+        const real *vel = m_vel.data();
+        const real *mass = m_mass.data();
+        const real *dens = m_dens.data();
+        const real *pres = m_pres.data();
+        const real *sml = m_sml.data();
+        const real *sound = m_sound.data();
+        const real *gradh = m_gradh.data();
+        const real *alpha = m_alpha.data();
+        const real *balsara = m_balsara.data();
+        const unsigned char *point_mass = m_point_mass.data();
+        const unsigned char *active = m_is_active.data();
+        const int *offsets = m_offsets.data();
+        const int *indices = m_indices.data();
+        real *acc = m_acc.data();
+        real *dene = m_dene.data();
+
+#pragma omp target teams distribute parallel for map(to : range[0 : DIM])
+        for (int i = 0; i < num; ++i)
+        {
+            if (point_mass[i] || !active[i])
+            {
+                continue;
+            }
+
+            const real p_per_rho2_i = pres[i] / (dens[i] * dens[i]);
+            const real h_i = sml[i];
+            const real gradh_i = gradh[i];
+
+            real acc_i[DIM];
+            for (int d = 0; d < DIM; ++d)
+            {
+                acc_i[d] = 0.0;
+            }
+            real dene_i = 0.0;
+
+            const int n_begin = offsets[i];
+            const int n_end = offsets[i + 1];
+            for (int n = n_begin; n < n_end; ++n)
+            {
+                const int j = indices[n];
+                if (point_mass[j])
+                {
+                    continue;
+                }
+
+                real r_ij[DIM];
+                real r2 = 0.0;
+                for (int d = 0; d < DIM; ++d)
+                {
+                    real dx = pos[i * DIM + d] - pos[j * DIM + d];
+                    if (periodic)
+                    {
+                        dx = min_image(dx, range[d]);
+                    }
+                    r_ij[d] = dx;
+                    r2 += dx * dx;
+                }
+                const real r = std::sqrt(r2);
+                const real h_j = sml[j];
+                if (r >= (h_i > h_j ? h_i : h_j) || r == 0.0)
+                {
+                    continue;
+                }
+
+                const real c_i = r < h_i ? cubic_dw_c(r, h_i, kd, sigma) : 0.0;
+                const real c_j = r < h_j ? cubic_dw_c(r, h_j, kd, sigma) : 0.0;
+
+                real v_ij[DIM];
+                real vr = 0.0;
+                for (int d = 0; d < DIM; ++d)
+                {
+                    v_ij[d] = vel[i * DIM + d] - vel[j * DIM + d];
+                    vr += v_ij[d] * r_ij[d];
+                }
+
+                // Monaghan (1997) artificial viscosity
+                real pi_ij = 0.0;
+                if (vr < 0.0)
+                {
+                    const real alpha_ij = 0.5 * (alpha[i] + alpha[j]);
+                    const real balsara_ij = 0.5 * (balsara[i] + balsara[j]);
+                    const real w_ij = vr / r;
+                    const real v_sig = sound[i] + sound[j] - 3.0 * w_ij;
+                    const real rho_ij_inv = 2.0 / (dens[i] + dens[j]);
+                    pi_ij = -0.5 * balsara_ij * alpha_ij * v_sig * w_ij * rho_ij_inv;
+                }
+
+                const real p_per_rho2_j = pres[j] / (dens[j] * dens[j]);
+                const real coef_i = mass[j] * (p_per_rho2_i * gradh_i + 0.5 * pi_ij);
+                const real coef_j = mass[j] * (p_per_rho2_j * gradh[j] + 0.5 * pi_ij);
+
+                real v_dw_i = 0.0;
+                real v_dw_ij = 0.0;
+                for (int d = 0; d < DIM; ++d)
+                {
+                    const real dw_i = r_ij[d] * c_i;
+                    const real dw_j = r_ij[d] * c_j;
+                    acc_i[d] -= dw_i * coef_i + dw_j * coef_j;
+                    v_dw_i += v_ij[d] * dw_i;
+                    v_dw_ij += v_ij[d] * (dw_i + dw_j) * 0.5;
+                }
+                dene_i += mass[j] * p_per_rho2_i * gradh_i * v_dw_i + 0.5 * mass[j] * pi_ij * v_dw_ij;
+            }
+
+            for (int d = 0; d < DIM; ++d)
+            {
+                acc[i * DIM + d] = acc_i[d];
+            }
+            dene[i] = dene_i;
+        }
+
+#pragma omp target update from(acc[0 : num * DIM], dene[0 : num])
+
+        auto &particles = sim.get_particles();
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+        {
+            auto &p_i = particles[i];
+            if (p_i.is_point_mass || !p_i.is_active)
+            {
+                continue;
+            }
+            for (int d = 0; d < DIM; ++d)
+            {
+                p_i.acc[d] = m_acc[i * DIM + d];
+            }
+            p_i.dene = m_dene[i];
+        }
+
+        return true;
+    }
+
+#endif // USE_GPU_OFFLOAD
+
+}
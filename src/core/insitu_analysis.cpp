@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+#include <boost/filesystem.hpp>
+
+#include "core/insitu_analysis.hpp"
+#include "core/simulation.hpp"
+#include "core/particle.hpp"
+#include "core/parameters.hpp"
+#include "core/logger.hpp"
+#include "utilities/openmp.hpp"
+
+namespace sph
+{
+
+    namespace
+    {
+
+        // Mass-weighted center of mass; shared by the profile and shock passes.
+        vec_t center_of_mass(Simulation &sim, real &total_mass)
+        {
+            auto &particles = sim.get_particles();
+            const int num = sim.get_particle_num();
+
+            // Deterministic sums: the analysis rows should be bitwise
+            // comparable between runs with different thread counts.
+            total_mass = deterministic_sum<real>(
+                num, [&](const int i)
+                { return particles[i].is_point_mass ? 0.0 : particles[i].mass; });
+            vec_t center(0.0);
+            if (total_mass > 0.0)
+            {
+                for (int d = 0; d < DIM; ++d)
+                {
+                    center[d] = deterministic_sum<real>(
+                                    num, [&](const int i)
+                                    {
+                                        const auto &p_i = particles[i];
+                                        return p_i.is_point_mass ? 0.0 : p_i.mass * p_i.pos[d];
+                                    }) /
+                                total_mass;
+                }
+            }
+            return center;
+        }
+
+    } // namespace
+
+    void InSituAnalysis::initialize(std::shared_ptr<SPHParameters> param, const std::string &run_dir)
+    {
+        m_enabled = param->insitu.enabled;
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        m_interval = param->insitu.interval;
+        m_profile_bins = param->insitu.profile_bins;
+        m_directory = run_dir + "/insitu";
+        boost::filesystem::create_directories(m_directory);
+
+        register_builtin_passes();
+        apply_selection(param->insitu.passes);
+
+        WRITE_LOG << "In-situ analysis enabled, interval = " << m_interval
+                  << " (0 = every step), directory = " << m_directory;
+    }
+
+    void InSituAnalysis::register_pass(const std::string &name, const std::string &header, PassFn fn)
+    {
+        auto pass = std::make_unique<Pass>();
+        pass->name = name;
+        pass->header = header;
+        pass->fn = std::move(fn);
+        m_passes.push_back(std::move(pass));
+    }
+
+    void InSituAnalysis::apply_selection(const std::vector<std::string> &names)
+    {
+        if (names.empty())
+        {
+            return; // default: every registered pass runs
+        }
+        for (auto &pass : m_passes)
+        {
+            pass->selected = std::find(names.begin(), names.end(), pass->name) != names.end();
+        }
+    }
+
+    void InSituAnalysis::sample(Simulation &sim)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        const real t = sim.get_time();
+        if (m_sampled_once && t < m_next_time)
+        {
+            return;
+        }
+        m_sampled_once = true;
+        m_next_time = t + m_interval;
+
+        for (auto &pass : m_passes)
+        {
+            if (!pass->selected)
+            {
+                continue;
+            }
+            if (!pass->out.is_open())
+            {
+                pass->out.open(m_directory + "/" + pass->name + ".csv");
+                pass->out << pass->header << "\n";
+                pass->out << std::scientific << std::setprecision(8);
+            }
+            pass->fn(sim, t, pass->out);
+            pass->out.flush();
+        }
+    }
+
+    void InSituAnalysis::register_builtin_passes()
+    {
+        register_pass(
+            "energies", "time,kinetic,thermal,potential,total",
+            [](Simulation &sim, const real t, std::ofstream &out)
+            {
+                auto &particles = sim.get_particles();
+                const int num = sim.get_particle_num();
+
+                // Fixed-topology sums keep the energy monitor bitwise
+                // reproducible across thread counts.
+                const real e_kin = deterministic_sum<real>(
+                    num, [&](const int i)
+                    {
+                        const auto &p_i = particles[i];
+                        return p_i.is_point_mass ? 0.0 : 0.5 * p_i.mass * abs2(p_i.vel);
+                    });
+                const real e_th = deterministic_sum<real>(
+                    num, [&](const int i)
+                    {
+                        const auto &p_i = particles[i];
+                        return p_i.is_point_mass ? 0.0 : p_i.mass * p_i.ene;
+                    });
+                const real e_pot = deterministic_sum<real>(
+                    num, [&](const int i)
+                    {
+                        const auto &p_i = particles[i];
+                        return p_i.is_point_mass ? 0.0 : 0.5 * p_i.mass * p_i.phi;
+                    });
+                out << t << ',' << e_kin << ',' << e_th << ',' << e_pot << ','
+                    << e_kin + e_th + e_pot << "\n";
+            });
+
+        register_pass(
+            "center_of_mass",
+#if DIM == 1
+            "time,mass,com_x,mom_x",
+#elif DIM == 2
+            "time,mass,com_x,com_y,mom_x,mom_y",
+#else
+            "time,mass,com_x,com_y,com_z,mom_x,mom_y,mom_z",
+#endif
+            [](Simulation &sim, const real t, std::ofstream &out)
+            {
+                auto &particles = sim.get_particles();
+                const int num = sim.get_particle_num();
+
+                real mass = 0.0;
+                const vec_t com = center_of_mass(sim, mass);
+
+                real mom[DIM];
+                for (int d = 0; d < DIM; ++d)
+                {
+                    mom[d] = deterministic_sum<real>(
+                        num, [&](const int i)
+                        {
+                            const auto &p_i = particles[i];
+                            return p_i.is_point_mass ? 0.0 : p_i.mass * p_i.vel[d];
+                        });
+                }
+
+                out << t << ',' << mass;
+                for (int d = 0; d < DIM; ++d)
+                {
+                    out << ',' << com[d];
+                }
+                for (int d = 0; d < DIM; ++d)
+                {
+                    out << ',' << mom[d];
+                }
+                out << "\n";
+            });
+
+        register_pass(
+            "radial_profile", "time,r,count,dens,pres",
+            [this](Simulation &sim, const real t, std::ofstream &out)
+            {
+                auto &particles = sim.get_particles();
+                const int num = sim.get_particle_num();
+                const int n_bins = m_profile_bins;
+
+                real mass = 0.0;
+                const vec_t com = center_of_mass(sim, mass);
+
+                omp_real r_max_t(0.0);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i)
+                {
+                    const auto &p_i = particles[i];
+                    if (p_i.is_point_mass)
+                    {
+                        continue;
+                    }
+                    const real r = std::abs(p_i.pos - com);
+                    if (r > r_max_t.get())
+                    {
+                        r_max_t.get() = r;
+                    }
+                }
+                const real r_max = r_max_t.max();
+                if (r_max <= 0.0 || n_bins < 1)
+                {
+                    return;
+                }
+
+                std::vector<long> count(n_bins, 0);
+                std::vector<real> dens_sum(n_bins, 0.0);
+                std::vector<real> pres_sum(n_bins, 0.0);
+#pragma omp parallel
+                {
+                    std::vector<long> count_t(n_bins, 0);
+                    std::vector<real> dens_t(n_bins, 0.0);
+                    std::vector<real> pres_t(n_bins, 0.0);
+#pragma omp for nowait
+                    for (int i = 0; i < num; ++i)
+                    {
+                        const auto &p_i = particles[i];
+                        if (p_i.is_point_mass)
+                        {
+                            continue;
+                        }
+                        int bin = static_cast<int>(std::abs(p_i.pos - com) / r_max * n_bins);
+                        if (bin >= n_bins)
+                        {
+                            bin = n_bins - 1;
+                        }
+                        ++count_t[bin];
+                        dens_t[bin] += p_i.dens;
+                        pres_t[bin] += p_i.pres;
+                    }
+#pragma omp critical
+                    {
+                        for (int b = 0; b < n_bins; ++b)
+                        {
+                            count[b] += count_t[b];
+                            dens_sum[b] += dens_t[b];
+                            pres_sum[b] += pres_t[b];
+                        }
+                    }
+                }
+
+                for (int b = 0; b < n_bins; ++b)
+                {
+                    const real r_center = (b + 0.5) * r_max / n_bins;
+                    const real inv_n = count[b] > 0 ? 1.0 / count[b] : 0.0;
+                    out << t << ',' << r_center << ',' << count[b] << ','
+                        << dens_sum[b] * inv_n << ',' << pres_sum[b] * inv_n << "\n";
+                }
+            });
+
+        register_pass(
+            "shock_front", "time,n_shock,r_front,max_sensor",
+            [](Simulation &sim, const real t, std::ofstream &out)
+            {
+                auto &particles = sim.get_particles();
+                const int num = sim.get_particle_num();
+
+                real mass = 0.0;
+                const vec_t com = center_of_mass(sim, mass);
+
+                omp_value<long> n_shock(0);
+                omp_real r_front(0.0);
+                omp_real max_sensor(0.0);
+#pragma omp parallel for
+                for (int i = 0; i < num; ++i)
+                {
+                    const auto &p_i = particles[i];
+                    if (p_i.is_point_mass || p_i.is_wall)
+                    {
+                        continue;
+                    }
+                    if (p_i.shockSensor > max_sensor.get())
+                    {
+                        max_sensor.get() = p_i.shockSensor;
+                    }
+                    if (p_i.shockMode != 1)
+                    {
+                        continue;
+                    }
+                    ++n_shock.get();
+                    const real r = std::abs(p_i.pos - com);
+                    if (r > r_front.get())
+                    {
+                        r_front.get() = r;
+                    }
+                }
+
+                out << t << ',' << n_shock.sum() << ',' << r_front.max() << ','
+                    << max_sensor.max() << "\n";
+            });
+    }
+
+}
@@ -1,4 +1,11 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <ctime>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #include <boost/format.hpp>
 
@@ -18,6 +25,157 @@ namespace sph
     std::ofstream Logger::log_io;
     bool Logger::open_flag = false;
 
+    namespace
+    {
+        // Bounded queue drained by a single background thread. Producers only
+        // take the mutex long enough to push an already-formatted line; the
+        // worker batches everything queued and writes outside the lock, so
+        // file latency never stalls the integration loop. Declared after the
+        // Logger statics in this translation unit so it is destroyed (and the
+        // worker joined) before log_io closes.
+        struct LogQueue
+        {
+            struct Line
+            {
+                std::string msg;
+                bool log_only;
+            };
+
+            static constexpr std::size_t max_pending = 4096;
+
+            std::mutex mutex;
+            std::condition_variable cv_push; // signals the worker
+            std::condition_variable cv_pop;  // signals blocked producers / flush
+            std::deque<Line> lines;
+            std::thread worker;
+            bool running = false;
+            bool stop = false;
+            bool busy = false; // worker is writing a dequeued batch
+
+            void start(std::ofstream &out)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (running)
+                {
+                    return;
+                }
+                running = true;
+                worker = std::thread([this, &out]() { worker_loop(out); });
+            }
+
+            void push(std::string msg, const bool log_only)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv_pop.wait(lock, [this]() { return lines.size() < max_pending; });
+                lines.push_back({std::move(msg), log_only});
+                cv_push.notify_one();
+            }
+
+            void flush()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv_pop.wait(lock, [this]() { return lines.empty() && !busy; });
+            }
+
+            void worker_loop(std::ofstream &out)
+            {
+                std::deque<Line> batch;
+                for (;;)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        cv_push.wait(lock, [this]() { return stop || !lines.empty(); });
+                        if (stop && lines.empty())
+                        {
+                            return;
+                        }
+                        batch.swap(lines);
+                        busy = true;
+                        cv_pop.notify_all();
+                    }
+                    for (const auto &line : batch)
+                    {
+                        out << line.msg << '\n';
+                        if (!line.log_only)
+                        {
+                            std::cout << line.msg << '\n';
+                        }
+                    }
+                    batch.clear();
+                    // flush once per drained batch, not per line
+                    out.flush();
+                    std::cout.flush();
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        busy = false;
+                        cv_pop.notify_all();
+                    }
+                }
+            }
+
+            ~LogQueue()
+            {
+                if (running)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        stop = true;
+                        cv_push.notify_one();
+                    }
+                    worker.join();
+                }
+            }
+        } g_log_queue;
+
+        // Per-call-site occurrence counters for sampled logging. Only
+        // consulted when a sample interval > 1 is configured, so the default
+        // path costs one relaxed atomic load per WRITE_LOG.
+        std::atomic<int> g_sample_interval{1};
+        std::mutex g_site_mutex;
+        std::unordered_map<std::uint64_t, std::uint64_t> g_site_counters;
+    }
+
+    void Logger::submit(const std::string &msg, const bool log_only)
+    {
+        if (open_flag)
+        {
+            g_log_queue.push(msg, log_only);
+            return;
+        }
+        // before open(): no worker yet, behave like a plain stdout logger
+        if (!log_only)
+        {
+            std::cout << msg << std::endl;
+        }
+    }
+
+    bool Logger::sampled_out(const char *site_file, const int site_line)
+    {
+        const int interval = g_sample_interval.load(std::memory_order_relaxed);
+        if (interval <= 1 || site_file == nullptr)
+        {
+            return false;
+        }
+        // string literals are stable, so the pointer identifies the file
+        const std::uint64_t key =
+            (static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(site_file)) << 16) ^ static_cast<std::uint64_t>(site_line);
+        std::lock_guard<std::mutex> lock(g_site_mutex);
+        return (g_site_counters[key]++ % interval) != 0;
+    }
+
+    void Logger::set_sample_interval(const int interval)
+    {
+        g_sample_interval.store(interval > 1 ? interval : 1, std::memory_order_relaxed);
+    }
+
+    void Logger::flush()
+    {
+        if (open_flag)
+        {
+            g_log_queue.flush();
+        }
+    }
+
     void Logger::open(const std::string &output_dir)
     {
         open(output_dir.c_str());
@@ -51,6 +209,7 @@ namespace sph
         }
         dir_name = output_dir;
         open_flag = true;
+        g_log_queue.start(log_io);
     }
 
-}
\ No newline at end of file
+}
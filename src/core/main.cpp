@@ -4,6 +4,7 @@
 #include "core/solver.hpp"
 #include "utilities/exception.hpp"
 #include "core/sample_registry.hpp"
+#include "core/mpi_domain.hpp"
 
 int main(int argc, char *argv[])
 {
@@ -47,7 +48,15 @@ int main(int argc, char *argv[])
             std::cout << "  numThreads   Optional: Number of OpenMP threads\n\n";
             std::cout << "Options:\n";
             std::cout << "  --list-samples, -l   List all available simulations\n";
-            std::cout << "  --help, -h           Show this help message\n\n";
+            std::cout << "  --help, -h           Show this help message\n";
+            std::cout << "  --scaling-threads=1,2,4,...   Scaling harness: run a fixed number of\n";
+            std::cout << "                                steps per thread count in one process and\n";
+            std::cout << "                                log speedup/efficiency per module\n";
+            std::cout << "  --scaling-steps=N             Steps per configuration (default 10)\n";
+            std::cout << "  --sweep=list.txt              Run every JSON config listed in the file\n";
+            std::cout << "                                back-to-back in this process (shared plugin,\n";
+            std::cout << "                                thread pool and IC cache); one line per\n";
+            std::cout << "                                config, '#' comments allowed\n\n";
             std::cout << "Examples:\n";
             std::cout << "  " << argv[0] << " shock_tube                    # Run with defaults\n";
             std::cout << "  " << argv[0] << " shock_tube config.json        # Use config file\n";
@@ -57,9 +66,11 @@ int main(int argc, char *argv[])
         }
     }
     
+    sph::DomainDecomposition::init(&argc, &argv);
     sph::exception_handler([&]()
                            {
         sph::Solver solver(argc, argv);
         solver.run(); });
+    sph::DomainDecomposition::finalize();
     return 0;
 }
\ No newline at end of file
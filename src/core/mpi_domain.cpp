@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "core/mpi_domain.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include "core/simulation.hpp"
+#include "utilities/exception.hpp"
+#include "core/logger.hpp"
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+namespace sph
+{
+
+#ifdef USE_MPI
+
+    namespace
+    {
+        // SPHParticle is trivially copyable; records go over the wire as raw
+        // bytes so the layout never needs a matching MPI datatype.
+        constexpr int particle_bytes = static_cast<int>(sizeof(SPHParticle));
+    }
+
+    void DomainDecomposition::init(int *argc, char ***argv)
+    {
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (!initialized)
+        {
+            MPI_Init(argc, argv);
+        }
+    }
+
+    void DomainDecomposition::finalize()
+    {
+        int finalized = 0;
+        MPI_Finalized(&finalized);
+        if (!finalized)
+        {
+            MPI_Finalize();
+        }
+    }
+
+    int DomainDecomposition::rank()
+    {
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (!initialized)
+        {
+            return 0;
+        }
+        int r = 0;
+        MPI_Comm_rank(MPI_COMM_WORLD, &r);
+        return r;
+    }
+
+    int DomainDecomposition::size()
+    {
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (!initialized)
+        {
+            return 1;
+        }
+        int s = 1;
+        MPI_Comm_size(MPI_COMM_WORLD, &s);
+        return s;
+    }
+
+    bool DomainDecomposition::enabled()
+    {
+        return size() > 1;
+    }
+
+    void DomainDecomposition::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        if (param->gravity.is_valid)
+        {
+            THROW_ERROR("MPI domain decomposition does not support self-gravity yet; the tree walk is rank-local.");
+        }
+
+        m_x_periodic = param->periodic.is_valid;
+        if (m_x_periodic)
+        {
+            m_domain_min = param->periodic.range_min[0];
+            m_domain_max = param->periodic.range_max[0];
+        }
+        m_skin_factor = param->verlet.is_valid ? param->verlet.skin_factor : 0.0;
+        m_local_num = 0;
+        for (int d = 0; d < 2; ++d)
+        {
+            m_sent_count[d] = 0;
+            m_recv_offset[d] = 0;
+            m_recv_count[d] = 0;
+        }
+    }
+
+    int DomainDecomposition::slab_of(const real x) const
+    {
+        const real width = (m_domain_max - m_domain_min) / size();
+        int s = static_cast<int>((x - m_domain_min) / width);
+        if (m_x_periodic)
+        {
+            s = ((s % size()) + size()) % size();
+        }
+        else
+        {
+            s = std::max(0, std::min(s, size() - 1));
+        }
+        return s;
+    }
+
+    void DomainDecomposition::decompose(std::shared_ptr<Simulation> sim)
+    {
+        auto &particles = sim->get_particles();
+        const int num = sim->get_particle_num();
+
+        if (!m_x_periodic)
+        {
+            // non-periodic runs derive the slab range from the initial
+            // conditions (every rank holds the full set here, so the
+            // extrema agree without communication)
+            real x_min = std::numeric_limits<real>::max();
+            real x_max = std::numeric_limits<real>::lowest();
+            for (int i = 0; i < num; ++i)
+            {
+                x_min = std::min(x_min, particles[i].pos[0]);
+                x_max = std::max(x_max, particles[i].pos[0]);
+            }
+            m_domain_min = x_min;
+            m_domain_max = x_max + (x_max - x_min) * 1.0e-6;
+        }
+
+        const real width = (m_domain_max - m_domain_min) / size();
+        m_slab_min = m_domain_min + width * rank();
+        m_slab_max = rank() == size() - 1 ? m_domain_max : m_slab_min + width;
+
+        std::vector<SPHParticle> local;
+        local.reserve(num / size() + 16);
+        for (int i = 0; i < num; ++i)
+        {
+            if (slab_of(particles[i].pos[0]) == rank())
+            {
+                local.push_back(particles[i]);
+            }
+        }
+
+        m_local_num = static_cast<int>(local.size());
+        sim->set_particles(std::move(local));
+        sim->set_particle_num(m_local_num);
+
+        WRITE_LOG << "MPI rank " << rank() << "/" << size()
+                  << ": slab x = [" << m_slab_min << ", " << m_slab_max
+                  << "), " << m_local_num << " particles";
+    }
+
+    real DomainDecomposition::halo_width(std::shared_ptr<Simulation> sim) const
+    {
+        const auto &particles = sim->get_particles();
+        real h_max = 0.0;
+        for (int i = 0; i < m_local_num; ++i)
+        {
+            h_max = std::max(h_max, particles[i].sml);
+        }
+        real h_global = 0.0;
+        MPI_Allreduce(&h_max, &h_global, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        // skin for Verlet mode plus slack for smoothing lengths that grow
+        // before the next exchange
+        return h_global * (1.1 + m_skin_factor);
+    }
+
+    void DomainDecomposition::exchange_halo(std::shared_ptr<Simulation> sim)
+    {
+        auto &particles = sim->get_particles();
+        particles.resize(m_local_num); // defensive: no stale ghosts
+
+        // --- migration: hand strays to their new owner -------------------
+        const int n_rank = size();
+        std::vector<std::vector<SPHParticle>> outbox(n_rank);
+        {
+            int keep = 0;
+            for (int i = 0; i < m_local_num; ++i)
+            {
+                const int dest = slab_of(particles[i].pos[0]);
+                if (dest == rank())
+                {
+                    particles[keep] = particles[i];
+                    ++keep;
+                }
+                else
+                {
+                    outbox[dest].push_back(particles[i]);
+                }
+            }
+            particles.resize(keep);
+        }
+
+        std::vector<int> send_counts(n_rank), recv_counts(n_rank);
+        for (int r = 0; r < n_rank; ++r)
+        {
+            send_counts[r] = static_cast<int>(outbox[r].size()) * particle_bytes;
+        }
+        MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+
+        std::vector<int> send_offsets(n_rank), recv_offsets(n_rank);
+        int send_total = 0, recv_total = 0;
+        for (int r = 0; r < n_rank; ++r)
+        {
+            send_offsets[r] = send_total;
+            recv_offsets[r] = recv_total;
+            send_total += send_counts[r];
+            recv_total += recv_counts[r];
+        }
+
+        std::vector<char> send_buf(send_total), recv_buf(recv_total);
+        for (int r = 0; r < n_rank; ++r)
+        {
+            if (!outbox[r].empty())
+            {
+                std::memcpy(send_buf.data() + send_offsets[r], outbox[r].data(), send_counts[r]);
+            }
+        }
+        MPI_Alltoallv(send_buf.data(), send_counts.data(), send_offsets.data(), MPI_BYTE,
+                      recv_buf.data(), recv_counts.data(), recv_offsets.data(), MPI_BYTE, MPI_COMM_WORLD);
+
+        const int n_migrated = recv_total / particle_bytes;
+        const int old_size = static_cast<int>(particles.size());
+        particles.resize(old_size + n_migrated);
+        if (n_migrated > 0)
+        {
+            std::memcpy(particles.data() + old_size, recv_buf.data(), recv_total);
+        }
+        m_local_num = static_cast<int>(particles.size());
+        sim->set_particle_num(m_local_num);
+
+        // --- halo: mirror the boundary strips to the adjacent ranks ------
+        const real w = halo_width(sim);
+
+        const int left = m_x_periodic ? (rank() + n_rank - 1) % n_rank
+                                      : (rank() > 0 ? rank() - 1 : MPI_PROC_NULL);
+        const int right = m_x_periodic ? (rank() + 1) % n_rank
+                                       : (rank() < n_rank - 1 ? rank() + 1 : MPI_PROC_NULL);
+        const int partner[2] = {left, right};
+
+        for (int d = 0; d < 2; ++d)
+        {
+            m_sent[d].clear();
+        }
+        for (int i = 0; i < m_local_num; ++i)
+        {
+            const real x = particles[i].pos[0];
+            if (x < m_slab_min + w)
+            {
+                m_sent[0].push_back(i);
+            }
+            if (x > m_slab_max - w)
+            {
+                m_sent[1].push_back(i);
+            }
+        }
+
+        for (int d = 0; d < 2; ++d)
+        {
+            m_sent_count[d] = partner[d] == MPI_PROC_NULL ? 0 : static_cast<int>(m_sent[d].size());
+
+            std::vector<SPHParticle> send(m_sent_count[d]);
+            for (int k = 0; k < m_sent_count[d]; ++k)
+            {
+                send[k] = particles[m_sent[d][k]];
+            }
+
+            // ghosts from the left arrive while we send right and vice versa
+            int n_recv = 0;
+            MPI_Sendrecv(&m_sent_count[d], 1, MPI_INT, partner[d], 100 + d,
+                         &n_recv, 1, MPI_INT, partner[1 - d], 100 + d,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+            m_recv_offset[d] = static_cast<int>(particles.size());
+            m_recv_count[d] = n_recv;
+            particles.resize(m_recv_offset[d] + n_recv);
+
+            MPI_Sendrecv(send.data(), m_sent_count[d] * particle_bytes, MPI_BYTE, partner[d], 200 + d,
+                         particles.data() + m_recv_offset[d], n_recv * particle_bytes, MPI_BYTE, partner[1 - d], 200 + d,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+
+        sim->set_particle_num(static_cast<int>(particles.size()));
+    }
+
+    void DomainDecomposition::refresh_halo(std::shared_ptr<Simulation> sim)
+    {
+        auto &particles = sim->get_particles();
+        const int n_rank = size();
+
+        const int left = m_x_periodic ? (rank() + n_rank - 1) % n_rank
+                                      : (rank() > 0 ? rank() - 1 : MPI_PROC_NULL);
+        const int right = m_x_periodic ? (rank() + 1) % n_rank
+                                       : (rank() < n_rank - 1 ? rank() + 1 : MPI_PROC_NULL);
+        const int partner[2] = {left, right};
+
+        for (int d = 0; d < 2; ++d)
+        {
+            std::vector<SPHParticle> send(m_sent_count[d]);
+            for (int k = 0; k < m_sent_count[d]; ++k)
+            {
+                send[k] = particles[m_sent[d][k]];
+            }
+
+            // same pairing and ordering as exchange_halo, so the records land
+            // back in the ghost slots they came from
+            MPI_Sendrecv(send.data(), m_sent_count[d] * particle_bytes, MPI_BYTE, partner[d], 300 + d,
+                         particles.data() + m_recv_offset[d], m_recv_count[d] * particle_bytes, MPI_BYTE, partner[1 - d], 300 + d,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+    }
+
+    void DomainDecomposition::drop_halo(std::shared_ptr<Simulation> sim)
+    {
+        auto &particles = sim->get_particles();
+        particles.resize(m_local_num);
+        sim->set_particle_num(m_local_num);
+    }
+
+    real DomainDecomposition::reduce_dt_min(const real dt) const
+    {
+        real dt_global = dt;
+        MPI_Allreduce(&dt, &dt_global, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+        return dt_global;
+    }
+
+#else // !USE_MPI: single-process build, everything is a no-op
+
+    void DomainDecomposition::init(int *, char ***) {}
+    void DomainDecomposition::finalize() {}
+    int DomainDecomposition::rank() { return 0; }
+    int DomainDecomposition::size() { return 1; }
+    bool DomainDecomposition::enabled() { return false; }
+
+    void DomainDecomposition::initialize(std::shared_ptr<SPHParameters>) {}
+    void DomainDecomposition::decompose(std::shared_ptr<Simulation>) {}
+    void DomainDecomposition::exchange_halo(std::shared_ptr<Simulation>) {}
+    void DomainDecomposition::refresh_halo(std::shared_ptr<Simulation>) {}
+    void DomainDecomposition::drop_halo(std::shared_ptr<Simulation>) {}
+    real DomainDecomposition::reduce_dt_min(const real dt) const { return dt; }
+
+#endif
+
+}
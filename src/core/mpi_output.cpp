@@ -0,0 +1,407 @@
+#include "core/mpi_output.hpp"
+#include "core/mpi_domain.hpp"
+#include "core/logger.hpp"
+#include "utilities/checkpoint_manager.hpp"
+#include "utilities/checkpoint_data.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <stdexcept>
+#include <vector>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#include <openssl/sha.h>
+#endif
+
+namespace sph
+{
+
+#ifdef USE_MPI
+
+    namespace
+    {
+
+        /// Broadcast rank 0's string (the ranks' run directories differ, so
+        /// shared paths are always rank 0's).
+        std::string bcast_string(const std::string& value)
+        {
+            int length = static_cast<int>(value.size());
+            MPI_Bcast(&length, 1, MPI_INT, 0, MPI_COMM_WORLD);
+            std::vector<char> buffer(length);
+            if (DomainDecomposition::rank() == 0)
+            {
+                std::memcpy(buffer.data(), value.data(), length);
+            }
+            MPI_Bcast(buffer.data(), length, MPI_CHAR, 0, MPI_COMM_WORLD);
+            return std::string(buffer.data(), length);
+        }
+
+        /// Exclusive prefix sum and total of the per-rank counts.
+        void row_partition(const long long local, long long& row_offset, long long& total)
+        {
+            row_offset = 0;
+            MPI_Exscan(const_cast<long long*>(&local), &row_offset, 1, MPI_LONG_LONG,
+                       MPI_SUM, MPI_COMM_WORLD);
+            if (DomainDecomposition::rank() == 0)
+            {
+                row_offset = 0; // Exscan leaves rank 0's buffer undefined
+            }
+            total = 0;
+            MPI_Allreduce(const_cast<long long*>(&local), &total, 1, MPI_LONG_LONG,
+                          MPI_SUM, MPI_COMM_WORLD);
+        }
+
+    } // anonymous namespace
+
+    // ========================================================================
+    // Collective container writer
+    // ========================================================================
+
+    bool CollectiveContainerWriter::open_collective()
+    {
+        if (m_opened)
+        {
+            return true;
+        }
+
+        m_path = bcast_string(m_directory + "/snapshots" + get_extension());
+
+        // Rank 0 probes (and header-initializes) the container; frames are
+        // self-delimiting, so appending after whatever an interrupted run
+        // left keeps the file walkable — same policy as the serial writer.
+        uint64_t existing = 0;
+        if (DomainDecomposition::rank() == 0)
+        {
+            std::ifstream probe(m_path, std::ios::binary | std::ios::ate);
+            if (probe.is_open())
+            {
+                existing = static_cast<uint64_t>(probe.tellg());
+            }
+            if (existing == 0)
+            {
+                std::vector<char> header;
+                columnar_layout::append_container_header(header, m_units);
+                std::ofstream out(m_path, std::ios::binary | std::ios::trunc);
+                if (!out.is_open())
+                {
+                    existing = ~0ull; // signal the failure to every rank
+                }
+                else
+                {
+                    out.write(header.data(), header.size());
+                    existing = header.size();
+                }
+            }
+
+            m_index_out.open(m_path + ".idx", std::ios::app);
+            if (m_index_out.is_open() && m_snapshot_count == 0)
+            {
+                m_index_out << "# frame offset size time particles\n";
+            }
+        }
+        MPI_Bcast(&existing, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+        if (existing == ~0ull)
+        {
+            return false;
+        }
+
+        m_offset = existing;
+        m_opened = true;
+        return true;
+    }
+
+    void CollectiveContainerWriter::write_staged(const SnapshotStage& stage)
+    {
+        if (!open_collective())
+        {
+            WRITE_LOG << "ERROR: Cannot open collective container output file in: " << m_directory;
+            return;
+        }
+
+        const auto columns = columnar_layout::catalogue(stage, m_columns);
+
+        long long row_offset = 0;
+        long long total = 0;
+        row_partition(stage.num, row_offset, total);
+
+        // Every rank derives the same frame layout from the global count;
+        // only rank 0 materializes the header bytes it writes below.
+        std::vector<char> head;
+        columnar_layout::append_header(head, columns, static_cast<uint64_t>(total),
+                                       stage.time, m_units);
+
+        uint64_t payload_size = head.size();
+        for (const auto& column : columns)
+        {
+            payload_size += static_cast<uint64_t>(total) * columnar_layout::elem_size(column.dtype);
+        }
+
+        std::vector<char> frame_header;
+        columnar_layout::append_frame_header(frame_header, payload_size, stage.time,
+                                             static_cast<uint64_t>(total));
+        const uint64_t frame_size = frame_header.size() + payload_size;
+
+        MPI_File file;
+        if (MPI_File_open(MPI_COMM_WORLD, m_path.c_str(), MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                          MPI_INFO_NULL, &file) != MPI_SUCCESS)
+        {
+            WRITE_LOG << "ERROR: MPI_File_open failed for container: " << m_path;
+            return;
+        }
+
+        if (DomainDecomposition::rank() == 0)
+        {
+            std::vector<char> prefix(frame_header);
+            prefix.insert(prefix.end(), head.begin(), head.end());
+            MPI_File_write_at(file, static_cast<MPI_Offset>(m_offset), prefix.data(),
+                              static_cast<int>(prefix.size()), MPI_BYTE, MPI_STATUS_IGNORE);
+        }
+
+        // Each column block holds the ranks' slices in rank order, so this
+        // rank's slice of every column sits at a precomputed offset. One
+        // collective write per column on every rank (the collective call
+        // counts must match even for an empty slice).
+        const uint64_t payload_start = m_offset + frame_header.size();
+        uint64_t column_offset = head.size();
+        for (const auto& column : columns)
+        {
+            const size_t esz = columnar_layout::elem_size(column.dtype);
+            const MPI_Offset at = static_cast<MPI_Offset>(
+                payload_start + column_offset + static_cast<uint64_t>(row_offset) * esz);
+            MPI_File_write_at_all(file, at, column.data,
+                                  static_cast<int>(stage.num * esz), MPI_BYTE,
+                                  MPI_STATUS_IGNORE);
+            column_offset += static_cast<uint64_t>(total) * esz;
+        }
+        MPI_File_close(&file);
+
+        if (DomainDecomposition::rank() == 0 && m_index_out.is_open())
+        {
+            m_index_out << m_snapshot_count << ' ' << m_offset << ' ' << frame_size << ' '
+                        << std::scientific << std::setprecision(16) << stage.time << ' '
+                        << total << '\n';
+            m_index_out.flush();
+
+            WRITE_LOG << "Collective container frame " << m_snapshot_count << " appended ("
+                      << total << " particles over " << DomainDecomposition::size()
+                      << " ranks, " << frame_size << " bytes, offset " << m_offset << ")";
+        }
+
+        m_offset += frame_size;
+        increment_count();
+    }
+
+    // ========================================================================
+    // Collective checkpoint
+    // ========================================================================
+
+    void CollectiveCheckpoint::save(CheckpointManager& manager,
+                                    const std::string& filepath,
+                                    const Simulation& sim_const,
+                                    const SPHParameters& params)
+    {
+        Simulation& sim = const_cast<Simulation&>(sim_const);
+        const std::vector<SPHParticle>& particles = sim.get_particles();
+        const size_t record_size = sizeof(CompactCheckpointParticle);
+
+        long long row_offset = 0;
+        long long total = 0;
+        row_partition(static_cast<long long>(particles.size()), row_offset, total);
+
+        // Rank 0's preamble (timestamped header + parameter JSON) is the
+        // shared prefix every rank's records follow.
+        std::vector<char> preamble;
+        if (DomainDecomposition::rank() == 0)
+        {
+            preamble = manager.build_collective_preamble(sim_const, params, total);
+        }
+        uint64_t preamble_size = preamble.size();
+        MPI_Bcast(&preamble_size, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+        preamble.resize(preamble_size);
+        MPI_Bcast(preamble.data(), static_cast<int>(preamble_size), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+        std::vector<char> records;
+        records.reserve(particles.size() * record_size);
+        manager.append_particle_records(records, particles);
+
+        const uint64_t image_size = preamble_size + static_cast<uint64_t>(total) * record_size;
+        const std::string path = bcast_string(filepath);
+
+        MPI_File file;
+        if (MPI_File_open(MPI_COMM_WORLD, path.c_str(), MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                          MPI_INFO_NULL, &file) != MPI_SUCCESS)
+        {
+            throw std::runtime_error("Cannot open collective checkpoint file for writing: " + path);
+        }
+        MPI_File_set_size(file, static_cast<MPI_Offset>(image_size + CheckpointData::CHECKSUM_SIZE));
+
+        if (DomainDecomposition::rank() == 0)
+        {
+            MPI_File_write_at(file, 0, preamble.data(), static_cast<int>(preamble_size),
+                              MPI_BYTE, MPI_STATUS_IGNORE);
+        }
+        MPI_File_write_at_all(file,
+                              static_cast<MPI_Offset>(preamble_size +
+                                                      static_cast<uint64_t>(row_offset) * record_size),
+                              records.data(), static_cast<int>(records.size()), MPI_BYTE,
+                              MPI_STATUS_IGNORE);
+
+        // Merged chunked checksum. The v4 scheme hashes fixed 8 MiB chunks
+        // of the file image and then the concatenated chunk digests; the
+        // chunk boundaries ignore the row decomposition, so the image bytes
+        // are repartitioned from rank-owned row slices onto contiguous
+        // chunk ranges first (one Alltoallv). The merged result is bit for
+        // bit what the serial save would have stored, so load_checkpoint
+        // validates the file unchanged.
+        const int rank = DomainDecomposition::rank();
+        const int size = DomainDecomposition::size();
+        const uint64_t chunk_size = CheckpointData::HASH_CHUNK_SIZE;
+        const uint64_t num_chunks = (image_size + chunk_size - 1) / chunk_size;
+
+        // Contiguous chunk ranges per rank, remainder spread from the front
+        auto chunk_begin = [&](const int r) {
+            const uint64_t per = num_chunks / size;
+            const uint64_t rem = num_chunks % size;
+            const uint64_t ur = static_cast<uint64_t>(r);
+            return ur * per + std::min(ur, rem);
+        };
+        auto byte_begin = [&](const int r) {
+            return std::min(chunk_begin(r) * chunk_size, image_size);
+        };
+
+        // This rank's contiguous byte range of the image: rank 0 owns the
+        // preamble too, so its stream is preamble + records concatenated.
+        std::vector<char> stream;
+        uint64_t stream_begin;
+        if (rank == 0)
+        {
+            stream = std::move(preamble);
+            stream.insert(stream.end(), records.begin(), records.end());
+            stream_begin = 0;
+        }
+        else
+        {
+            stream = std::move(records);
+            stream_begin = preamble_size + static_cast<uint64_t>(row_offset) * record_size;
+        }
+        const uint64_t stream_end = stream_begin + stream.size();
+
+        // Every rank knows every stream range (from the gathered counts),
+        // so both sides of the Alltoallv are computed locally.
+        std::vector<long long> counts(size);
+        const long long local = static_cast<long long>(particles.size());
+        MPI_Allgather(const_cast<long long*>(&local), 1, MPI_LONG_LONG,
+                      counts.data(), 1, MPI_LONG_LONG, MPI_COMM_WORLD);
+        std::vector<uint64_t> stream_begins(size + 1);
+        stream_begins[0] = 0;
+        uint64_t rows = 0;
+        for (int r = 0; r < size; ++r)
+        {
+            rows += static_cast<uint64_t>(counts[r]);
+            stream_begins[r + 1] = preamble_size + rows * record_size;
+        }
+
+        std::vector<int> send_counts(size, 0), send_displs(size, 0);
+        std::vector<int> recv_counts(size, 0), recv_displs(size, 0);
+        for (int r = 0; r < size; ++r)
+        {
+            // my stream bytes landing in r's chunk range
+            const uint64_t sb = std::max(stream_begin, byte_begin(r));
+            const uint64_t se = std::min(stream_end, byte_begin(r + 1));
+            if (se > sb)
+            {
+                send_counts[r] = static_cast<int>(se - sb);
+                send_displs[r] = static_cast<int>(sb - stream_begin);
+            }
+            // r's stream bytes landing in my chunk range
+            const uint64_t rb = std::max(stream_begins[r], byte_begin(rank));
+            const uint64_t re = std::min(stream_begins[r + 1], byte_begin(rank + 1));
+            if (re > rb)
+            {
+                recv_counts[r] = static_cast<int>(re - rb);
+                recv_displs[r] = static_cast<int>(rb - byte_begin(rank));
+            }
+        }
+
+        std::vector<char> chunk_bytes(byte_begin(rank + 1) - byte_begin(rank));
+        MPI_Alltoallv(stream.data(), send_counts.data(), send_displs.data(), MPI_BYTE,
+                      chunk_bytes.data(), recv_counts.data(), recv_displs.data(), MPI_BYTE,
+                      MPI_COMM_WORLD);
+
+        // Per-rank chunk digests, hashed in parallel like the serial path
+        const int64_t my_chunks = static_cast<int64_t>(chunk_begin(rank + 1) - chunk_begin(rank));
+        std::vector<uint8_t> digests(my_chunks * SHA256_DIGEST_LENGTH);
+#pragma omp parallel for
+        for (int64_t c = 0; c < my_chunks; ++c)
+        {
+            const uint64_t offset = (chunk_begin(rank) + c) * chunk_size;
+            SHA256_CTX ctx;
+            SHA256_Init(&ctx);
+            SHA256_Update(&ctx, chunk_bytes.data() + (offset - byte_begin(rank)),
+                          std::min(chunk_size, image_size - offset));
+            SHA256_Final(digests.data() + c * SHA256_DIGEST_LENGTH, &ctx);
+        }
+
+        std::vector<uint8_t> all_digests;
+        std::vector<int> digest_counts(size), digest_displs(size);
+        for (int r = 0; r < size; ++r)
+        {
+            digest_counts[r] = static_cast<int>((chunk_begin(r + 1) - chunk_begin(r)) *
+                                                SHA256_DIGEST_LENGTH);
+            digest_displs[r] = static_cast<int>(chunk_begin(r) * SHA256_DIGEST_LENGTH);
+        }
+        if (rank == 0)
+        {
+            all_digests.resize(num_chunks * SHA256_DIGEST_LENGTH);
+        }
+        MPI_Gatherv(digests.data(), static_cast<int>(digests.size()), MPI_UNSIGNED_CHAR,
+                    all_digests.data(), digest_counts.data(), digest_displs.data(),
+                    MPI_UNSIGNED_CHAR, 0, MPI_COMM_WORLD);
+
+        if (rank == 0)
+        {
+            std::vector<uint8_t> checksum(SHA256_DIGEST_LENGTH);
+            SHA256_CTX root;
+            SHA256_Init(&root);
+            SHA256_Update(&root, all_digests.data(), all_digests.size());
+            SHA256_Final(checksum.data(), &root);
+
+            MPI_File_write_at(file, static_cast<MPI_Offset>(image_size), checksum.data(),
+                              static_cast<int>(checksum.size()), MPI_UNSIGNED_CHAR,
+                              MPI_STATUS_IGNORE);
+
+            manager.record_collective_save(path, sim.get_time(),
+                                           image_size + CheckpointData::CHECKSUM_SIZE, checksum);
+            WRITE_LOG << "Collective checkpoint written: " << path << " (" << total
+                      << " particles over " << size << " ranks, "
+                      << image_size + CheckpointData::CHECKSUM_SIZE << " bytes)";
+        }
+        MPI_File_close(&file);
+    }
+
+#else // !USE_MPI: SimulationRun::create_writer never selects the collective
+      // writer, and the checkpoint falls through to the serial save
+
+    bool CollectiveContainerWriter::open_collective()
+    {
+        return false;
+    }
+
+    void CollectiveContainerWriter::write_staged(const SnapshotStage&)
+    {
+        WRITE_LOG << "ERROR: Collective container writer requires an MPI build";
+    }
+
+    void CollectiveCheckpoint::save(CheckpointManager& manager,
+                                    const std::string& filepath,
+                                    const Simulation& sim,
+                                    const SPHParameters& params)
+    {
+        manager.save_checkpoint(filepath, sim, params);
+    }
+
+#endif
+
+} // namespace sph
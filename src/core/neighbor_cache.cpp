@@ -0,0 +1,34 @@
+/* ================================
+ * neighbor_cache.cpp
+ * ================================ */
+#include <algorithm>
+
+#include "core/neighbor_cache.hpp"
+#include "utilities/hugepages.hpp"
+
+namespace sph
+{
+
+    void NeighborCache::assign(const std::vector<std::vector<int>> &lists)
+    {
+        const int num = static_cast<int>(lists.size());
+        m_offsets.resize(num + 1);
+
+        m_offsets[0] = 0;
+        for (int i = 0; i < num; ++i)
+        {
+            m_offsets[i + 1] = m_offsets[i] + static_cast<int>(lists[i].size());
+        }
+
+        m_indices.resize(m_offsets[num]);
+        HugePages::advise(m_indices);
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+        {
+            std::copy(lists[i].begin(), lists[i].end(), m_indices.begin() + m_offsets[i]);
+        }
+
+        m_valid = true;
+    }
+
+} // namespace sph
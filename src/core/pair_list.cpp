@@ -0,0 +1,77 @@
+#include "core/pair_list.hpp"
+#include "core/particle_soa.hpp"
+#include "core/neighbor_cache.hpp"
+#include "utilities/periodic.hpp"
+#include "kernel/kernel_function.hpp"
+#include "kernel/kernel_dispatch.hpp"
+#include "utilities/scratch_buffers.hpp"
+
+#include <algorithm>
+
+namespace sph
+{
+
+    void PairList::build(const ParticleSoA &soa, const NeighborCache &cache, const int particle_num,
+                         const Periodic *periodic, const KernelFunction *kernel)
+    {
+        m_valid = false;
+        if (!cache.is_valid())
+        {
+            return;
+        }
+
+        const int total = cache.first(particle_num);
+        m_r_ij.resize(total);
+        m_r.resize(total);
+        m_dw_i.resize(total);
+        m_dw_j.resize(total);
+
+        kernel_dispatch(kernel, [&](const auto &kern)
+                        {
+#pragma omp parallel for schedule(dynamic, 32)
+            for (int i = 0; i < particle_num; ++i)
+            {
+                const vec_t &r_i = soa.pos[i];
+                const real h_i = soa.sml[i];
+                const int *neighbor_ptr = cache.neighbors(i);
+                const int n_neighbor = cache.neighbor_count(i);
+                const int base = cache.first(i);
+
+                for (int n = 0; n < n_neighbor; ++n)
+                {
+                    const int j = neighbor_ptr[n];
+                    const int e = base + n;
+
+                    const vec_t r_ij = periodic->calc_r_ij(r_i, soa.pos[j]);
+                    const real r = std::abs(r_ij);
+                    m_r_ij[e] = r_ij;
+                    m_r[e] = r;
+
+                    // j-side gradients keep the scalar call: h varies per
+                    // neighbor, so there is no common h to batch over
+                    if (r < soa.sml[j] && r > 0.0)
+                    {
+                        m_dw_j[e] = kern.dw(r_ij, r, soa.sml[j]);
+                    }
+                    else
+                    {
+                        m_dw_j[e] = 0.0;
+                    }
+                }
+
+                // i-side: h is constant across the row and the distances just
+                // landed contiguously in m_r, so one batched call covers it.
+                // dw_c_batch is zero beyond the support and finite at r = 0,
+                // matching the per-pair guard above.
+                auto &c_buf = scratch_real_buffer(0, n_neighbor);
+                kern.dw_c_batch(m_r.data() + base, h_i, c_buf.data(), n_neighbor);
+                for (int n = 0; n < n_neighbor; ++n)
+                {
+                    m_dw_i[base + n] = m_r_ij[base + n] * c_buf[n];
+                }
+            } });
+
+        m_valid = true;
+    }
+
+} // namespace sph
@@ -0,0 +1,121 @@
+/* ================================
+ * particle_soa.cpp
+ * ================================ */
+#include "core/particle_soa.hpp"
+#include "core/particle.hpp"
+#include "core/logger.hpp"
+#include "utilities/numa.hpp"
+#include "utilities/hugepages.hpp"
+
+namespace sph
+{
+
+    template <typename T>
+    void ParticleSoA::Array<T>::resize(const int n)
+    {
+        // touch_resize first-touches each grown array in parallel under the
+        // NUMA placement mode (plain resize otherwise); load_from refills the
+        // contents either way.
+        NumaPlacement::touch_resize(m_heap, n);
+        HugePages::advise(m_heap);
+        m_data = m_heap.data();
+        m_size = n;
+    }
+
+    template <typename T>
+    void ParticleSoA::Array<T>::attach(T *data, const int n)
+    {
+        m_heap.clear();
+        m_heap.shrink_to_fit();
+        m_data = data;
+        m_size = n;
+    }
+
+    template class ParticleSoA::Array<vec_t>;
+    template class ParticleSoA::Array<real>;
+    template class ParticleSoA::Array<unsigned char>;
+
+    void ParticleSoA::enable_out_of_core(const std::string &backing_file)
+    {
+        m_out_of_core = true;
+        m_backing_file = backing_file;
+        WRITE_LOG << "ParticleSoA: out-of-core mode, backing file " << backing_file;
+    }
+
+    void ParticleSoA::resize(const int particle_num)
+    {
+        if (m_out_of_core)
+        {
+            // One file-backed arena holds every array; remapping invalidates
+            // the old carve-outs, so all arrays re-attach below. Alignment is
+            // a cache line so no array shares a line with its neighbor.
+            constexpr std::size_t align = 64;
+            const std::size_t n = static_cast<std::size_t>(particle_num);
+            const std::size_t bytes =
+                2 * (n * sizeof(vec_t) + align) +        // pos, vel
+                9 * (n * sizeof(real) + align) +         // the real scalars
+                3 * (n * sizeof(unsigned char) + align); // the flags
+            m_arena.map(m_backing_file, bytes);
+
+            pos.attach(static_cast<vec_t *>(m_arena.alloc(n * sizeof(vec_t), align)), particle_num);
+            vel.attach(static_cast<vec_t *>(m_arena.alloc(n * sizeof(vec_t), align)), particle_num);
+            mass.attach(static_cast<real *>(m_arena.alloc(n * sizeof(real), align)), particle_num);
+            dens.attach(static_cast<real *>(m_arena.alloc(n * sizeof(real), align)), particle_num);
+            pres.attach(static_cast<real *>(m_arena.alloc(n * sizeof(real), align)), particle_num);
+            ene.attach(static_cast<real *>(m_arena.alloc(n * sizeof(real), align)), particle_num);
+            sml.attach(static_cast<real *>(m_arena.alloc(n * sizeof(real), align)), particle_num);
+            sound.attach(static_cast<real *>(m_arena.alloc(n * sizeof(real), align)), particle_num);
+            gradh.attach(static_cast<real *>(m_arena.alloc(n * sizeof(real), align)), particle_num);
+            alpha.attach(static_cast<real *>(m_arena.alloc(n * sizeof(real), align)), particle_num);
+            balsara.attach(static_cast<real *>(m_arena.alloc(n * sizeof(real), align)), particle_num);
+            is_point_mass.attach(static_cast<unsigned char *>(m_arena.alloc(n, align)), particle_num);
+            is_wall.attach(static_cast<unsigned char *>(m_arena.alloc(n, align)), particle_num);
+            is_active.attach(static_cast<unsigned char *>(m_arena.alloc(n, align)), particle_num);
+            return;
+        }
+
+        pos.resize(particle_num);
+        vel.resize(particle_num);
+        mass.resize(particle_num);
+        dens.resize(particle_num);
+        pres.resize(particle_num);
+        ene.resize(particle_num);
+        sml.resize(particle_num);
+        sound.resize(particle_num);
+        gradh.resize(particle_num);
+        alpha.resize(particle_num);
+        balsara.resize(particle_num);
+        is_point_mass.resize(particle_num);
+        is_wall.resize(particle_num);
+        is_active.resize(particle_num);
+    }
+
+    void ParticleSoA::load_from(const std::vector<SPHParticle> &particles, const int particle_num)
+    {
+        if (size() != particle_num)
+        {
+            resize(particle_num);
+        }
+
+#pragma omp parallel for
+        for (int i = 0; i < particle_num; ++i)
+        {
+            const auto &p_i = particles[i];
+            pos[i] = p_i.pos;
+            vel[i] = p_i.vel;
+            mass[i] = p_i.mass;
+            dens[i] = p_i.dens;
+            pres[i] = p_i.pres;
+            ene[i] = p_i.ene;
+            sml[i] = p_i.sml;
+            sound[i] = p_i.sound;
+            gradh[i] = p_i.gradh;
+            alpha[i] = p_i.alpha;
+            balsara[i] = p_i.balsara;
+            is_point_mass[i] = p_i.is_point_mass ? 1 : 0;
+            is_wall[i] = p_i.is_wall ? 1 : 0;
+            is_active[i] = p_i.is_active ? 1 : 0;
+        }
+    }
+
+} // namespace sph
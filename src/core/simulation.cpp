@@ -6,8 +6,19 @@
 #include "utilities/exception.hpp"
 #include "utilities/periodic.hpp"
 #include "tree/bhtree.hpp"
+#include "tree/cell_list.hpp"
 #include "kernel/cubic_spline.hpp"
 #include "kernel/wendland_kernel.hpp"
+#include "kernel/tabulated_kernel.hpp"
+#include "utilities/scratch_buffers.hpp"
+#include "utilities/memory_footprint.hpp"
+#include "utilities/hugepages.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
 
 namespace sph
 {
@@ -30,12 +41,30 @@ namespace sph
         {
             THROW_ERROR("Unknown kernel.");
         }
+        if (param->tabulated_kernel)
+        {
+            m_kernel = std::make_shared<Tabulated>(m_kernel, is2p5);
+        }
 
-        m_tree = std::make_shared<BHTree>();
+        if (param->tree.use_cell_list)
+        {
+            m_tree = std::make_shared<CellList>();
+        }
+        else
+        {
+            m_tree = std::make_shared<BHTree>();
+        }
         m_tree->initialize(param);
 
+        m_particle_num = 0; // samples that create particles overwrite this
         m_time = param->time.start;
         m_dt = 0.0;
+        m_dt_force_min = std::numeric_limits<accum_t>::max();
+        m_dt_ene_min = std::numeric_limits<accum_t>::max();
+        m_dt_minima_valid = false;
+        m_cache_neighbor_number = param->physics.neighbor_number;
+        m_use_pair_list = param->pair_list;
+        gpu_offload.initialize(param);
     }
 
     void Simulation::update_time()
@@ -46,6 +75,198 @@ namespace sph
     void Simulation::make_tree()
     {
         m_tree->make(m_particles, m_particle_num);
+        neighbor_cache.invalidate();
+        pair_list.invalidate();
+    }
+
+    void Simulation::account_memory() const
+    {
+        // The snapshot cadence doubles as the re-advise point: the particle
+        // vector may have reallocated (refinement, culling, halo exchange)
+        // since the startup advice was given.
+        HugePages::advise(m_particles);
+
+        MemoryFootprint::set("particles", sizeof(SPHParticle) * m_particles.capacity());
+        MemoryFootprint::set("particle_soa", particle_soa.footprint_bytes());
+        MemoryFootprint::set("neighbor_cache",
+                             sizeof(int) * (neighbor_cache.offsets().capacity() + neighbor_cache.indices().capacity()));
+        MemoryFootprint::set("pair_list", pair_list.footprint_bytes());
+
+        std::size_t additional = 0;
+        for (const auto &values : additional_scalar_arrays)
+        {
+            additional += sizeof(real) * values.capacity();
+        }
+        for (const auto &values : additional_vector_arrays)
+        {
+            additional += sizeof(vec_t) * values.capacity();
+        }
+        MemoryFootprint::set("additional_arrays", additional);
+    }
+
+    void Simulation::build_pair_list()
+    {
+        if (!m_use_pair_list)
+        {
+            return;
+        }
+        sync_particle_soa();
+        pair_list.build(particle_soa, neighbor_cache, m_particle_num,
+                        m_periodic.get(), m_kernel.get());
+    }
+
+    void Simulation::build_neighbor_cache()
+    {
+        const int num = m_particle_num;
+        std::vector<std::vector<int>> lists(num);
+
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+        {
+            auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(m_particles[i].neighbor, m_cache_neighbor_number));
+            const int n_neighbor = m_tree->neighbor_search_adaptive(m_particles[i], neighbor_list, m_particles, true);
+            lists[i].assign(neighbor_list.begin(), neighbor_list.begin() + n_neighbor);
+        }
+
+        neighbor_cache.assign(lists);
+    }
+
+    namespace
+    {
+        // Spread the low `bits` bits of x so that consecutive bits land DIM
+        // positions apart (one lane per dimension of the Morton key).
+        inline std::uint64_t morton_expand(const std::uint64_t x, const int bits)
+        {
+            std::uint64_t v = 0;
+            for(int b = 0; b < bits; ++b) {
+                v |= ((x >> b) & 1ull) << (b * DIM);
+            }
+            return v;
+        }
+    }
+
+    void Simulation::reorder_particles()
+    {
+        const int num = m_particle_num;
+        if(num < 2) {
+            return;
+        }
+
+        vec_t r_min = m_particles[0].pos;
+        vec_t r_max = m_particles[0].pos;
+        for(int i = 1; i < num; ++i) {
+            const vec_t & r = m_particles[i].pos;
+            for(int d = 0; d < DIM; ++d) {
+                if(r[d] < r_min[d]) r_min[d] = r[d];
+                if(r[d] > r_max[d]) r_max[d] = r[d];
+            }
+        }
+
+        constexpr int bits = 63 / DIM;
+        constexpr std::uint64_t cells = (1ull << bits) - 1;
+        std::vector<std::pair<std::uint64_t, int>> keys(num);
+
+#pragma omp parallel for
+        for(int i = 0; i < num; ++i) {
+            const vec_t & r = m_particles[i].pos;
+            std::uint64_t key = 0;
+            for(int d = 0; d < DIM; ++d) {
+                const real edge = r_max[d] - r_min[d];
+                const real f = edge > 0.0 ? (r[d] - r_min[d]) / edge : 0.0;
+                std::uint64_t q = static_cast<std::uint64_t>(f * cells);
+                if(q > cells) q = cells;
+                key |= morton_expand(q, bits) << d;
+            }
+            keys[i] = std::make_pair(key, i);
+        }
+
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<SPHParticle> sorted(num);
+#pragma omp parallel for
+        for(int i = 0; i < num; ++i) {
+            sorted[i] = m_particles[keys[i].second];
+            sorted[i].id = i;
+        }
+#pragma omp parallel for
+        for(int i = 0; i < num; ++i) {
+            m_particles[i] = sorted[i];
+        }
+
+        // Registered per-particle arrays follow the same permutation so each
+        // slot stays attached to its particle.
+        if (has_additional_arrays())
+        {
+            std::vector<int> source(num);
+            for (int i = 0; i < num; ++i)
+            {
+                source[i] = keys[i].second;
+            }
+            gather_additional_arrays(source);
+        }
+
+        // The tree's permutation array indexes into the old ordering; the
+        // caller must rebuild it before the next search.
+        neighbor_cache.invalidate();
+        m_partition_dirty = true;
+    }
+
+    void Simulation::gather_additional_arrays(const std::vector<int> &source)
+    {
+        const int num = static_cast<int>(source.size());
+        for (auto &values : additional_scalar_arrays)
+        {
+            std::vector<real> gathered(num);
+            for (int i = 0; i < num; ++i)
+            {
+                gathered[i] = values[source[i]];
+            }
+            values.swap(gathered);
+        }
+        for (auto &values : additional_vector_arrays)
+        {
+            std::vector<vec_t> gathered(num);
+            for (int i = 0; i < num; ++i)
+            {
+                gathered[i] = values[source[i]];
+            }
+            values.swap(gathered);
+        }
+    }
+
+    // Rebuild the type-partitioned index lists. Ascending index order is kept
+    // in every list so the partitioned loops visit particles in the same
+    // order (and with the same rounding) as the flag-branching loops did.
+    void Simulation::update_type_partition()
+    {
+        if (!m_partition_dirty && m_partition_num == m_particle_num)
+        {
+            return;
+        }
+        m_sph_ids.clear();
+        m_fluid_ids.clear();
+        m_wall_ids.clear();
+        m_point_mass_ids.clear();
+        for (int i = 0; i < m_particle_num; ++i)
+        {
+            const auto &p_i = m_particles[i];
+            if (p_i.is_point_mass)
+            {
+                m_point_mass_ids.push_back(i);
+                continue;
+            }
+            m_sph_ids.push_back(i);
+            if (p_i.is_wall)
+            {
+                m_wall_ids.push_back(i);
+            }
+            else
+            {
+                m_fluid_ids.push_back(i);
+            }
+        }
+        m_partition_num = m_particle_num;
+        m_partition_dirty = false;
     }
 
     void Simulation::add_scalar_array(const std::vector<std::string> &names)
@@ -53,7 +274,13 @@ namespace sph
         const int num = m_particle_num;
         for (const auto &name : names)
         {
-            additional_scalar_array[name].resize(num);
+            auto it = additional_scalar_index.find(name);
+            if (it == additional_scalar_index.end())
+            {
+                additional_scalar_index[name] = static_cast<int>(additional_scalar_arrays.size());
+                additional_scalar_arrays.emplace_back();
+            }
+            additional_scalar_arrays[additional_scalar_index[name]].resize(num);
         }
     }
 
@@ -62,14 +289,20 @@ namespace sph
         const int num = m_particle_num;
         for (const auto &name : names)
         {
-            additional_vector_array[name].resize(num);
+            auto it = additional_vector_index.find(name);
+            if (it == additional_vector_index.end())
+            {
+                additional_vector_index[name] = static_cast<int>(additional_vector_arrays.size());
+                additional_vector_arrays.emplace_back();
+            }
+            additional_vector_arrays[additional_vector_index[name]].resize(num);
         }
     }
 
-    std::vector<real> &Simulation::get_scalar_array(const std::string &name)
+    int Simulation::get_scalar_array_handle(const std::string &name)
     {
-        auto it = additional_scalar_array.find(name);
-        if (it != additional_scalar_array.end())
+        auto it = additional_scalar_index.find(name);
+        if (it != additional_scalar_index.end())
         {
             return it->second;
         }
@@ -79,10 +312,10 @@ namespace sph
         }
     }
 
-    std::vector<vec_t> &Simulation::get_vector_array(const std::string &name)
+    int Simulation::get_vector_array_handle(const std::string &name)
     {
-        auto it = additional_vector_array.find(name);
-        if (it != additional_vector_array.end())
+        auto it = additional_vector_index.find(name);
+        if (it != additional_vector_index.end())
         {
             return it->second;
         }
@@ -92,4 +325,34 @@ namespace sph
         }
     }
 
+    std::vector<real> &Simulation::get_scalar_array(const std::string &name)
+    {
+        return additional_scalar_arrays[get_scalar_array_handle(name)];
+    }
+
+    std::vector<vec_t> &Simulation::get_vector_array(const std::string &name)
+    {
+        return additional_vector_arrays[get_vector_array_handle(name)];
+    }
+
+    std::vector<std::string> Simulation::scalar_array_names() const
+    {
+        std::vector<std::string> names(additional_scalar_arrays.size());
+        for (const auto &entry : additional_scalar_index)
+        {
+            names[entry.second] = entry.first;
+        }
+        return names;
+    }
+
+    std::vector<std::string> Simulation::vector_array_names() const
+    {
+        std::vector<std::string> names(additional_vector_arrays.size());
+        for (const auto &entry : additional_vector_index)
+        {
+            names[entry.second] = entry.first;
+        }
+        return names;
+    }
+
 }
\ No newline at end of file
@@ -3,14 +3,21 @@
 #include "core/parameters.hpp"
 #include "core/particle.hpp"
 #include "core/logger.hpp"
+#include "core/mpi_domain.hpp"
+#include "core/mpi_output.hpp"
 #include "utilities/unit_system.hpp"
+#include "utilities/memory_footprint.hpp"
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
+#include <dirent.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <pwd.h>
+#include <openssl/sha.h>
 
 #ifdef __APPLE__
 #include <sys/sysctl.h>
@@ -18,10 +25,36 @@
 
 namespace sph
 {
+    namespace
+    {
+        // Directory name of each format under outputs/; also the key the
+        // outputColumns config uses to address a writer
+        std::string format_directory_name(OutputFormat format)
+        {
+            switch (format) {
+                case OutputFormat::CSV:        return "csv";
+                case OutputFormat::BINARY:     return "binary";
+                case OutputFormat::NUMPY:      return "numpy";
+                case OutputFormat::HDF5:       return "hdf5";
+                case OutputFormat::COMPRESSED: return "compressed";
+                case OutputFormat::COLUMNAR:   return "columnar";
+                case OutputFormat::CONTAINER:  return "container";
+            }
+            return "unknown";
+        }
+    }
+
     // ========================================================================
     // SimulationRun Implementation
     // ========================================================================
 
+    SimulationRun::~SimulationRun()
+    {
+        if (m_source_thread.joinable()) {
+            m_source_thread.join();
+        }
+    }
+
     SimulationRun::SimulationRun(const Config& config)
         : m_config(config)
         , m_start_time(std::chrono::system_clock::now())
@@ -127,14 +160,7 @@ namespace sph
 
     std::string SimulationRun::get_outputs_directory(OutputFormat format) const
     {
-        std::string format_str;
-        switch (format) {
-            case OutputFormat::CSV:    format_str = "csv"; break;
-            case OutputFormat::BINARY: format_str = "binary"; break;
-            case OutputFormat::NUMPY:  format_str = "numpy"; break;
-            case OutputFormat::HDF5:   format_str = "hdf5"; break;
-        }
-        return m_run_directory + "/outputs/" + format_str;
+        return m_run_directory + "/outputs/" + format_directory_name(format);
     }
 
     std::string SimulationRun::get_visualizations_directory() const
@@ -233,61 +259,164 @@ namespace sph
         WRITE_LOG << "Metadata saved: " << filename;
     }
 
-    void SimulationRun::save_source_files()
+    namespace
     {
-        if (!m_config.save_source_code) {
-            return;
+        // Recursively collect "path|size|mtime" lines for every regular file
+        // under dir (POSIX dirent; the tree is small, the files may not be).
+        void collect_file_state(const std::string& dir, std::vector<std::string>& entries)
+        {
+            DIR* d = opendir(dir.c_str());
+            if (!d) {
+                return;
+            }
+            while (dirent* e = readdir(d)) {
+                const std::string name = e->d_name;
+                if (name == "." || name == "..") {
+                    continue;
+                }
+                const std::string path = dir + "/" + name;
+                struct stat st;
+                if (stat(path.c_str(), &st) != 0) {
+                    continue;
+                }
+                if (S_ISDIR(st.st_mode)) {
+                    collect_file_state(path, entries);
+                } else if (S_ISREG(st.st_mode)) {
+                    std::ostringstream entry;
+                    entry << path << '|' << st.st_size << '|' << st.st_mtime;
+                    entries.push_back(entry.str());
+                }
+            }
+            closedir(d);
         }
+    }
 
-        std::string source_dir = m_run_directory + "/source";
-        
-        // If specific source files are registered, save those
+    std::string SimulationRun::source_state_hash() const
+    {
+        // Names, sizes and mtimes stand in for file content: reading every
+        // source file back just to fingerprint it would pay the NFS round
+        // trips this cache exists to avoid.
+        std::vector<std::string> entries;
         if (!m_config.source_files.empty()) {
             for (const auto& source_path : m_config.source_files) {
-                std::ifstream src(source_path, std::ios::binary);
-                if (!src.is_open()) {
-                    WRITE_LOG << "WARNING: Cannot open source file: " << source_path;
-                    continue;
+                std::ostringstream entry;
+                entry << source_path;
+                struct stat st;
+                if (stat(source_path.c_str(), &st) == 0) {
+                    entry << '|' << st.st_size << '|' << st.st_mtime;
                 }
+                entries.push_back(entry.str());
+            }
+        } else {
+            collect_file_state("../src/samples", entries);
+        }
+        std::sort(entries.begin(), entries.end());
 
-                // Extract filename from path
-                size_t last_slash = source_path.find_last_of("/\\");
-                std::string filename = (last_slash != std::string::npos) 
-                    ? source_path.substr(last_slash + 1) 
-                    : source_path;
-
-                std::string dest_path = source_dir + "/" + filename;
-                std::ofstream dest(dest_path, std::ios::binary);
-                
-                if (!dest.is_open()) {
-                    WRITE_LOG << "WARNING: Cannot write source file: " << dest_path;
-                    continue;
+        std::string key;
+        for (const auto& entry : entries) {
+            key += entry;
+            key += '\n';
+        }
+
+        unsigned char digest[SHA256_DIGEST_LENGTH];
+        SHA256(reinterpret_cast<const unsigned char*>(key.data()), key.size(), digest);
+        std::ostringstream hex;
+        hex << std::hex << std::setfill('0');
+        for (int i = 0; i < 8; ++i) {
+            hex << std::setw(2) << static_cast<int>(digest[i]);
+        }
+        return hex.str();
+    }
+
+    void SimulationRun::save_source_files()
+    {
+        if (!m_config.save_source_code) {
+            return;
+        }
+
+        // Launch the capture in the background so integration starts
+        // immediately; the destructor joins the thread, so the archive is on
+        // disk before the run directory is considered complete.
+        m_source_thread = std::thread([this]() { archive_source_files(); });
+    }
+
+    void SimulationRun::archive_source_files()
+    {
+        const std::string source_dir = m_run_directory + "/source";
+        const std::string hash = source_state_hash();
+        const std::string archive_root = m_config.base_dir + "/source_archive";
+        const std::string archive_dir = archive_root + "/" + hash;
+
+        struct stat st;
+        if (stat(archive_dir.c_str(), &st) != 0) {
+            // First run with this source state: populate the archive under a
+            // temporary name, then rename it into place so concurrent runs
+            // never see a half-copied archive.
+            create_directories(archive_root);
+            const std::string staging = archive_dir + ".tmp." + std::to_string(::getpid());
+            create_directories(staging);
+
+            bool populated = false;
+            if (!m_config.source_files.empty()) {
+                for (const auto& source_path : m_config.source_files) {
+                    std::ifstream src(source_path, std::ios::binary);
+                    if (!src.is_open()) {
+                        WRITE_LOG << "WARNING: Cannot open source file: " << source_path;
+                        continue;
+                    }
+
+                    // Extract filename from path
+                    size_t last_slash = source_path.find_last_of("/\\");
+                    std::string filename = (last_slash != std::string::npos)
+                        ? source_path.substr(last_slash + 1)
+                        : source_path;
+
+                    std::string dest_path = staging + "/" + filename;
+                    std::ofstream dest(dest_path, std::ios::binary);
+
+                    if (!dest.is_open()) {
+                        WRITE_LOG << "WARNING: Cannot write source file: " << dest_path;
+                        continue;
+                    }
+
+                    dest << src.rdbuf();
+                    populated = true;
+                }
+            }
+            // Otherwise, copy the entire src/samples directory tree
+            else {
+                // The executable is typically in build/, so src/samples is
+                // ../src/samples
+                std::string samples_dir = "../src/samples";
+                std::string copy_cmd = "cp -r " + samples_dir + " " + staging + "/samples 2>/dev/null";
+                populated = system(copy_cmd.c_str()) == 0;
+                if (!populated) {
+                    WRITE_LOG << "WARNING: Could not copy samples directory from: " << samples_dir;
                 }
+            }
 
-                // Copy file
-                dest << src.rdbuf();
-                src.close();
-                dest.close();
-                
-                WRITE_LOG << "Saved source file: " << filename;
+            if (!populated) {
+                system(("rm -rf " + staging).c_str());
+                return;
             }
-        } 
-        // Otherwise, copy the entire src/samples directory tree
-        else {
-            // Try to find src/samples directory relative to executable
-            // The executable is typically in build/, so src/samples is ../src/samples
-            std::string samples_dir = "../src/samples";
-            
-            // Use system command to copy entire directory tree
-            std::string copy_cmd = "cp -r " + samples_dir + " " + source_dir + "/samples 2>/dev/null";
-            int result = system(copy_cmd.c_str());
-            
-            if (result == 0) {
-                WRITE_LOG << "Saved entire samples source tree to: " << source_dir << "/samples";
+            if (std::rename(staging.c_str(), archive_dir.c_str()) != 0) {
+                // Lost the race to a concurrent run; its archive is
+                // equivalent, so just drop the staging copy.
+                system(("rm -rf " + staging).c_str());
             } else {
-                WRITE_LOG << "WARNING: Could not copy samples directory from: " << samples_dir;
+                WRITE_LOG << "Archived source state " << hash << " to " << archive_dir;
             }
         }
+
+        // Reference the shared archive from this run via hard links; a real
+        // copy is the fallback across filesystems.
+        std::string link_cmd = "cp -al " + archive_dir + "/. " + source_dir + "/ 2>/dev/null"
+                               " || cp -r " + archive_dir + "/. " + source_dir + "/ 2>/dev/null";
+        if (system(link_cmd.c_str()) == 0) {
+            WRITE_LOG << "Source archive " << hash << " linked into " << source_dir;
+        } else {
+            WRITE_LOG << "WARNING: Could not link source archive into " << source_dir;
+        }
     }
 
     std::unique_ptr<OutputWriter> SimulationRun::create_writer(
@@ -295,7 +424,24 @@ namespace sph
         const UnitSystem& units)
     {
         std::string output_dir = get_outputs_directory(format);
-        return create_output_writer(format, output_dir, 0, units);
+        // A decomposed run writes one shared container collectively via
+        // MPI-IO instead of one per rank (see core/mpi_output.hpp); the
+        // per-snapshot formats keep their per-rank trees.
+        std::unique_ptr<OutputWriter> writer;
+        if (format == OutputFormat::CONTAINER && DomainDecomposition::enabled()) {
+            writer = std::make_unique<CollectiveContainerWriter>(output_dir, 0, units);
+        } else {
+            writer = create_output_writer(format, output_dir, 0, units);
+        }
+        if (format == OutputFormat::BINARY && m_config.binary_precision != "f64") {
+            static_cast<BinaryOutputWriter*>(writer.get())
+                ->set_reduced_precision(parse_column_precision(m_config.binary_precision));
+        }
+        const auto columns = m_config.output_columns.find(format_directory_name(format));
+        if (columns != m_config.output_columns.end()) {
+            writer->set_columns(columns->second);
+        }
+        return writer;
     }
 
     // ========================================================================
@@ -446,7 +592,9 @@ namespace sph
         json << "    \"output_interval\": " << sim_params.output_interval << ",\n";
         json << "    \"neighbor_number\": " << sim_params.neighbor_number << ",\n";
         json << "    \"use_balsara\": " << (sim_params.use_balsara ? "true" : "false") << ",\n";
-        json << "    \"use_time_dependent_av\": " << (sim_params.use_time_dependent_av ? "true" : "false") << "\n";
+        json << "    \"use_time_dependent_av\": " << (sim_params.use_time_dependent_av ? "true" : "false") << ",\n";
+        json << "    \"gravity_interval\": " << sim_params.gravity_interval << ",\n";
+        json << "    \"gravity_extrapolate\": " << (sim_params.gravity_extrapolate ? "true" : "false") << "\n";
         json << "  },\n";
 
         // Unit system
@@ -483,7 +631,11 @@ namespace sph
         json << "    \"wall_time_seconds\": " << perf_info.wall_time_seconds << ",\n";
         json << "    \"timesteps_per_second\": " << perf_info.timesteps_per_second << ",\n";
         json << "    \"particles_per_second\": " << perf_info.particles_per_second << "\n";
-        json << "  }\n";
+        json << "  },\n";
+
+        // Memory footprint (per-subsystem bytes with peaks; see
+        // utilities/memory_footprint.hpp)
+        json << "  \"memory\": " << MemoryFootprint::to_json(2) << "\n";
 
         json << "}\n";
 
@@ -5,7 +5,9 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <chrono>
+#include <thread>
 #include <cstdlib>
 #include <set>
 #include <omp.h>
@@ -15,6 +17,7 @@
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/any.hpp>
 #include <boost/filesystem.hpp>
+#include <openssl/sha.h>
 
 #include "modules/module_factory.hpp"
 #include "core/solver.hpp"
@@ -22,8 +25,15 @@
 #include "core/particle.hpp"
 #include "core/logger.hpp"
 #include "utilities/exception.hpp"
+#include "utilities/event_counters.hpp"
+#include "utilities/cost_histograms.hpp"
+#include "utilities/loop_scheduler.hpp"
+#include "utilities/numa.hpp"
+#include "utilities/hugepages.hpp"
+#include "utilities/openmp.hpp"
 #include "core/simulation_run.hpp"
 #include "core/output_format.hpp"
+#include "core/mpi_output.hpp"
 #include "core/simulation.hpp"
 #include "utilities/periodic.hpp"
 #include "tree/bhtree.hpp"
@@ -52,6 +62,7 @@
 #include "utilities/unit_system.hpp"
 #include "relaxation/density_relaxation.hpp"
 #include "utilities/shock_detection.hpp"
+#include "utilities/memory_footprint.hpp"
 
 namespace sph
 {
@@ -59,13 +70,19 @@ namespace sph
     namespace
     {
         volatile std::sig_atomic_t g_interrupt_requested = 0;
-        
+        volatile std::sig_atomic_t g_preempt_requested = 0;
+
         void signal_handler(int signal)
         {
             if (signal == SIGINT)
             {
                 g_interrupt_requested = 1;
             }
+            else if (signal == SIGTERM)
+            {
+                // preemption warning: fast-flush checkpoint and exit
+                g_preempt_requested = 1;
+            }
         }
     }
     
@@ -126,16 +143,57 @@ namespace sph
     {
         std::cout << "--------------SPH simulation-------------\n\n";
 
-        if (argc < 2)
+        // Split off the scaling-harness flags; everything else is parsed
+        // positionally as before.
+        std::vector<std::string> args;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg.rfind("--scaling-threads=", 0) == 0)
+            {
+                m_scaling_mode = true;
+                std::string list = arg.substr(std::string("--scaling-threads=").size());
+                std::stringstream ss(list);
+                std::string item;
+                while (std::getline(ss, item, ','))
+                {
+                    const int threads = std::atoi(item.c_str());
+                    if (threads >= 1)
+                    {
+                        m_scaling_threads.push_back(threads);
+                    }
+                }
+            }
+            else if (arg.rfind("--scaling-steps=", 0) == 0)
+            {
+                m_scaling_steps = std::atoi(arg.substr(std::string("--scaling-steps=").size()).c_str());
+            }
+            else if (arg.rfind("--sweep=", 0) == 0)
+            {
+                m_sweep_mode = true;
+                m_sweep_list_file = arg.substr(std::string("--sweep=").size());
+            }
+            else
+            {
+                args.push_back(arg);
+            }
+        }
+        if (m_scaling_mode && (m_scaling_threads.empty() || m_scaling_steps < 1))
+        {
+            std::cerr << "Invalid scaling options: --scaling-threads=1,2,4,... [--scaling-steps=N]\n";
+            std::exit(EXIT_FAILURE);
+        }
+
+        if (args.empty())
         {
             std::cerr << "Usage: " << argv[0] << " <sampleName> [jsonFile] [numThreads]\n";
             std::exit(EXIT_FAILURE);
         }
 
-        m_sample_name = argv[1];
-        if (argc >= 3)
+        m_sample_name = args[0];
+        if (args.size() >= 2)
         {
-            std::string arg2 = argv[2];
+            const std::string &arg2 = args[1];
             if (arg2.size() > 5 && arg2.substr(arg2.size() - 5) == ".json")
             {
                 m_json_file = arg2;
@@ -146,9 +204,9 @@ namespace sph
             }
         }
 
-        if (argc >= 4)
+        if (args.size() >= 3)
         {
-            m_num_threads = std::atoi(argv[3]);
+            m_num_threads = std::atoi(args[2].c_str());
         }
         if (m_num_threads < 1)
             m_num_threads = 1;
@@ -191,6 +249,13 @@ namespace sph
             param.gsph.force_correction = root.get<bool>("forceCorrection", false);
             WRITE_LOG << "use2ndOrderGSPH: " << param.gsph.is_2nd_order;
             WRITE_LOG << "forceCorrection: " << param.gsph.force_correction;
+            param.gdisph.region_switch = root.get<bool>("shockRegionSwitch", false);
+            param.gdisph.mach_threshold = root.get<real>("shockModeMachThreshold", real(1.1));
+            if (param.gdisph.region_switch)
+            {
+                WRITE_LOG << "shockRegionSwitch enabled, Mach threshold = "
+                          << param.gdisph.mach_threshold;
+            }
         }
         const std::unordered_map<SPHType, ParserFunc> type_specific_parsers = {
             {SPHType::SSPH, parseSSPH},
@@ -278,6 +343,31 @@ namespace sph
             std::set<std::string> visited;
             return load_json_with_extends(file_path, visited);
         }
+
+        /**
+         * @brief Hash an initial-conditions cache key to a short hex tag
+         *
+         * The key covers the canonical resolved config (after the extends
+         * merge), the sample name and DIM — anything else that changes the
+         * generated particles has to flow through one of those.
+         */
+        std::string ic_cache_hash(const std::string& config, const std::string& sample_name)
+        {
+            std::ostringstream key;
+            key << sample_name << "|" << DIM << "|" << config;
+            const std::string key_str = key.str();
+
+            unsigned char digest[SHA256_DIGEST_LENGTH];
+            SHA256(reinterpret_cast<const unsigned char*>(key_str.data()), key_str.size(), digest);
+
+            std::ostringstream hex;
+            hex << std::hex << std::setfill('0');
+            for (int i = 0; i < 8; ++i)
+            {
+                hex << std::setw(2) << static_cast<int>(digest[i]);
+            }
+            return hex.str();
+        }
     }
 
     void Solver::parseJsonOverrides()
@@ -312,6 +402,13 @@ namespace sph
         m_param->two_and_half_sim = root.get<bool>("two_and_half_sim", false);
 
         m_output_dir = root.get<std::string>("outputDirectory", m_output_dir);
+        if (DomainDecomposition::enabled())
+        {
+            // each rank keeps its own tree for logs and the per-snapshot
+            // formats; the container format and checkpoints instead write
+            // one shared file collectively (see core/mpi_output.hpp)
+            m_output_dir += "/rank_" + std::to_string(DomainDecomposition::rank());
+        }
         m_param->time.start = root.get<real>("startTime", real(0));
         WRITE_LOG << "startTime: " << m_param->time.start;
 
@@ -328,6 +425,9 @@ namespace sph
         m_param->cfl.sound = root.get<real>("cflSound", 0.3);
         m_param->cfl.force = root.get<real>("cflForce", 0.125);
         m_param->cfl.ene = root.get<real>("cflEnergy", 0.3);
+        m_param->cfl.dt_growth_limit = root.get<real>("dtGrowthLimit", 1.25);
+        m_param->cfl.dt_reduction_interval = root.get<int>("dtReductionInterval", 8);
+        m_param->cfl.dt_stale_safety = root.get<real>("dtStaleSafety", 0.9);
         m_param->av.alpha = root.get<real>("avAlpha", 1.0);
         m_param->av.use_balsara_switch = root.get<bool>("useBalsaraSwitch", true);
         m_param->av.use_time_dependent_av = root.get<bool>("useTimeDependentAV", false);
@@ -350,6 +450,22 @@ namespace sph
 
         m_param->tree.max_level = root.get<int>("maxTreeLevel", 20);
         m_param->tree.leaf_particle_num = root.get<int>("leafParticleNumber", 1);
+        m_param->tree.use_cell_list = root.get<bool>("useCellList", false);
+        if (m_param->tree.use_cell_list)
+        {
+            WRITE_LOG << "Neighbor search engine: cell-linked list";
+        }
+        m_param->tree.auto_tune = root.get<bool>("treeAutoTune", false);
+        if (m_param->tree.auto_tune)
+        {
+            WRITE_LOG << "Tree auto-tune enabled (leafParticleNumber swept over the first steps)";
+        }
+        m_param->tree.refit = root.get<bool>("treeRefit", false);
+        if (m_param->tree.refit)
+        {
+            m_param->tree.refit_interval = root.get<int>("treeRefitInterval", 8);
+            WRITE_LOG << "Tree refit enabled, full rebuild every " << m_param->tree.refit_interval << " steps";
+        }
 
         m_param->physics.neighbor_number = root.get<int>("neighborNumber", 32);
         m_param->physics.gamma = root.get<real>("gamma");
@@ -365,8 +481,320 @@ namespace sph
                 THROW_ERROR("kernel is unknown: ", kernel_name);
         }
 
+        m_param->tabulated_kernel = root.get<bool>("tabulatedKernel", false);
+        if (m_param->tabulated_kernel)
+        {
+            WRITE_LOG << "Tabulated kernel evaluation enabled";
+        }
+
         m_param->iterative_sml = root.get<bool>("iterativeSmoothingLength", true);
 
+        // Warm-started smoothing-length iteration
+        m_param->warm_start_sml = root.get<bool>("warmStartSml", false);
+        if (m_param->warm_start_sml)
+        {
+            WRITE_LOG << "Warm-started smoothing-length iteration enabled";
+        }
+
+        // Shared pair-geometry stream for the force and diagnostic loops
+        m_param->pair_list = root.get<bool>("pairList", false);
+        if (m_param->pair_list)
+        {
+            WRITE_LOG << "Pair-list pipeline enabled (precomputed pair geometry per step)";
+        }
+
+        // GPU offload engine (inert unless built with -DUSE_GPU_OFFLOAD=ON)
+        m_param->gpu_offload = root.get<bool>("gpuOffload", false);
+        if (m_param->gpu_offload)
+        {
+            WRITE_LOG << "GPU offload requested for the density and force pair loops";
+        }
+
+        // In-situ analysis stage
+        m_param->insitu.enabled = root.get<bool>("insituAnalysis", false);
+        if (m_param->insitu.enabled)
+        {
+            m_param->insitu.interval = root.get<real>("insituInterval", 0.0);
+            m_param->insitu.profile_bins = root.get<int>("insituProfileBins", 64);
+            if (const auto passes = root.get_child_optional("insituPasses"))
+            {
+                for (const auto &entry : *passes)
+                {
+                    m_param->insitu.passes.push_back(entry.second.get_value<std::string>());
+                }
+            }
+        }
+
+        // Out-of-core storage for the derived particle arrays
+        m_param->out_of_core.enabled = root.get<bool>("outOfCore", false);
+        if (m_param->out_of_core.enabled)
+        {
+            m_param->out_of_core.directory = root.get<std::string>("outOfCoreDirectory", "");
+            WRITE_LOG << "out-of-core mode: derived particle arrays are file-backed";
+        }
+
+        // NUMA placement and thread pinning
+        m_param->numa.first_touch = root.get<bool>("numaFirstTouch", false);
+        m_param->numa.pin_threads = root.get<bool>("numaPinThreads", m_param->numa.first_touch);
+        if (m_param->numa.first_touch)
+        {
+            WRITE_LOG << "NUMA first-touch placement enabled for the particle arrays";
+        }
+
+        // Transparent hugepages for the big long-lived arrays
+        m_param->huge_pages.enabled = root.get<bool>("hugePages", false);
+
+        // OpenMP schedule for the hot module loops
+        m_param->omp_schedule.kind = root.get<std::string>("ompSchedule", "static");
+        m_param->omp_schedule.chunk = root.get<int>("ompChunk", 0);
+        if (m_param->omp_schedule.kind != "static")
+        {
+            WRITE_LOG << "OpenMP schedule for the module loops: " << m_param->omp_schedule.kind
+                      << (m_param->omp_schedule.chunk > 0 ? "," + std::to_string(m_param->omp_schedule.chunk) : "");
+        }
+
+        m_param->verlet.is_valid = root.get<bool>("useVerletList", false);
+        if (m_param->verlet.is_valid)
+        {
+            m_param->verlet.skin_factor = root.get<real>("verletSkinFactor", 0.2);
+            WRITE_LOG << "Verlet neighbor-list mode enabled, skin factor = " << m_param->verlet.skin_factor;
+        }
+
+        // Morton reordering
+        const int reorder_interval = root.get<int>("reorderInterval", 0);
+        if (reorder_interval > 0)
+        {
+            m_param->reorder.is_valid = true;
+            m_param->reorder.interval = reorder_interval;
+            WRITE_LOG << "Morton particle reordering enabled, interval = " << reorder_interval;
+        }
+
+        // Block timesteps
+        m_param->block_timesteps.is_valid = root.get<bool>("useBlockTimesteps", false);
+        if (m_param->block_timesteps.is_valid)
+        {
+            m_param->block_timesteps.max_bins = root.get<int>("maxTimestepBins", 8);
+            WRITE_LOG << "Block timesteps enabled, max bins = " << m_param->block_timesteps.max_bins;
+        }
+
+        // Symmetrized pairwise fluid force
+        m_param->symmetrize_force = root.get<bool>("symmetrizeFluidForce", false);
+        if (m_param->symmetrize_force)
+        {
+            WRITE_LOG << "Symmetrized pairwise fluid force enabled";
+        }
+
+        // Async snapshot writing
+        if (root.get<bool>("asyncOutput", false))
+        {
+            if (DomainDecomposition::enabled())
+            {
+                // the collective container writer issues MPI calls from the
+                // writing thread, which MPI_Init gave no thread support for
+                WRITE_LOG << "asyncOutput ignored on a decomposed run (snapshots write collectively)";
+            }
+            else
+            {
+                m_async_output = std::make_unique<AsyncOutputManager>();
+                WRITE_LOG << "Asynchronous snapshot writing enabled";
+            }
+        }
+
+        // Per-module timing log
+        m_timing_requested = root.get<bool>("timingLog", false);
+
+        // Per-particle cost histograms (neighbor counts, NR iterations,
+        // tree-walk visits, per-thread busy windows)
+        m_cost_requested = root.get<bool>("costInstrumentation", false);
+        if (m_cost_requested)
+        {
+            WRITE_LOG << "Per-particle cost instrumentation enabled";
+        }
+
+        // Sampled logging: emit each WRITE_LOG call site only every n-th
+        // occurrence, demoting the per-step messages without touching them
+        const int log_sample_interval = root.get<int>("logSampleInterval", 1);
+        if (log_sample_interval > 1)
+        {
+            WRITE_LOG << "Log sampling enabled, interval = " << log_sample_interval;
+            Logger::set_sample_interval(log_sample_interval);
+        }
+
+        // Incremental shock detection (0 = full pass every step)
+        m_param->shock_refresh_threshold = root.get<real>("shockRefreshThreshold", real(0));
+        if (m_param->shock_refresh_threshold > 0.0)
+        {
+            WRITE_LOG << "Incremental shock detection, refresh threshold = "
+                      << m_param->shock_refresh_threshold;
+        }
+
+        // Adaptive particle refinement (split near shocks, merge elsewhere)
+        m_param->refinement.is_valid = root.get<bool>("adaptiveRefinement", false);
+        if (m_param->refinement.is_valid)
+        {
+            m_param->refinement.split_threshold = root.get<real>("refinementSplitThreshold", 1.5);
+            m_param->refinement.merge_threshold = root.get<real>("refinementMergeThreshold", 0.5);
+            m_param->refinement.interval = root.get<int>("refinementInterval", 10);
+            m_param->refinement.min_mass_factor = root.get<real>("refinementMinMass", 0.2);
+            m_param->refinement.max_mass_factor = root.get<real>("refinementMaxMass", 2.0);
+            WRITE_LOG << "Adaptive particle refinement enabled, interval = "
+                      << m_param->refinement.interval
+                      << ", split >= " << m_param->refinement.split_threshold
+                      << ", merge < " << m_param->refinement.merge_threshold;
+        }
+
+        // Escaped-material culling (off unless a positive radius is given)
+        const real cull_radius = root.get<real>("cullRadius", real(0));
+        if (cull_radius > 0.0)
+        {
+            m_param->culling.is_valid = true;
+            m_param->culling.radius = cull_radius;
+            m_param->culling.interval = root.get<int>("cullInterval", 50);
+            WRITE_LOG << "Escaped-material culling enabled, radius = " << cull_radius
+                      << ", interval = " << m_param->culling.interval;
+        }
+
+        // Compressed column-wise snapshots (gzip via Boost.Iostreams)
+        m_compressed_output = root.get<bool>("compressedOutput", false);
+        if (m_compressed_output)
+        {
+            WRITE_LOG << "Compressed snapshot output enabled";
+        }
+
+        // Columnar snapshots with an index header (seek-readable columns)
+        m_columnar_output = root.get<bool>("columnarOutput", false);
+        if (m_columnar_output)
+        {
+            WRITE_LOG << "Columnar snapshot output enabled";
+        }
+
+        // Append-store container: one file per run instead of per snapshot
+        m_container_output = root.get<bool>("containerOutput", false);
+        if (m_container_output)
+        {
+            WRITE_LOG << "Container snapshot output enabled"
+                      << (DomainDecomposition::enabled() ? " (collective MPI-IO)" : "");
+        }
+
+        // Activity-adaptive output cadence
+        m_param->adaptive_output.is_valid = root.get<bool>("adaptiveOutput", false);
+        if (m_param->adaptive_output.is_valid)
+        {
+            m_param->adaptive_output.min_interval =
+                root.get<real>("outputTimeMin", m_param->time.output / 8);
+            m_param->adaptive_output.max_interval =
+                root.get<real>("outputTimeMax", m_param->time.output * 8);
+            WRITE_LOG << "Adaptive output cadence enabled, interval in ["
+                      << m_param->adaptive_output.min_interval << ", "
+                      << m_param->adaptive_output.max_interval << "]";
+        }
+
+        // ROI / LOD snapshot selection
+        {
+            auto roi_min = root.get_child_optional("snapshotRoiMin");
+            auto roi_max = root.get_child_optional("snapshotRoiMax");
+            if (roi_min && roi_max)
+            {
+                if (roi_min->size() != DIM || roi_max->size() != DIM)
+                {
+                    THROW_ERROR("snapshotRoiMin/snapshotRoiMax != DIM");
+                }
+                int i = 0;
+                for (auto &v : *roi_min)
+                {
+                    m_param->snapshot.roi_min[i] = std::stod(v.second.data());
+                    ++i;
+                }
+                i = 0;
+                for (auto &v : *roi_max)
+                {
+                    m_param->snapshot.roi_max[i] = std::stod(v.second.data());
+                    ++i;
+                }
+                m_param->snapshot.roi_box = true;
+                WRITE_LOG << "Snapshot ROI box enabled";
+            }
+
+            auto roi_center = root.get_child_optional("snapshotRoiCenter");
+            m_param->snapshot.roi_radius = root.get<real>("snapshotRoiRadius", real(0));
+            if (roi_center && m_param->snapshot.roi_radius > 0.0)
+            {
+                if (roi_center->size() != DIM)
+                {
+                    THROW_ERROR("snapshotRoiCenter != DIM");
+                }
+                int i = 0;
+                for (auto &v : *roi_center)
+                {
+                    m_param->snapshot.roi_center[i] = std::stod(v.second.data());
+                    ++i;
+                }
+                m_param->snapshot.roi_sphere = true;
+                WRITE_LOG << "Snapshot ROI sphere enabled, radius = "
+                          << m_param->snapshot.roi_radius;
+            }
+
+            m_param->snapshot.lod_stride = root.get<int>("snapshotLodStride", 1);
+            m_param->snapshot.full_interval = root.get<int>("snapshotFullInterval", 0);
+            if (m_param->snapshot.lod_stride > 1)
+            {
+                WRITE_LOG << "Snapshot LOD stride = " << m_param->snapshot.lod_stride
+                          << (m_param->snapshot.full_interval > 0
+                                  ? ", full dump every " + std::to_string(m_param->snapshot.full_interval) + " snapshots"
+                                  : "");
+            }
+        }
+
+        // Reduced-precision binary columns (vel/acc/alpha/gradh/shockSensor);
+        // checkpoints are untouched and stay full precision
+        m_binary_precision = root.get<std::string>("binaryPrecision", "f64");
+        if (m_binary_precision != "f64")
+        {
+            WRITE_LOG << "Binary snapshot precision for visualization columns: "
+                      << m_binary_precision;
+        }
+
+        // Per-writer column selection: outputColumns maps a format name
+        // ("csv", "columnar", ...) to the columns that writer emits, e.g.
+        //   "outputColumns": { "csv": ["pos", "vel", "dens", "pres", "ene", "id"] }
+        // Formats without an entry keep the full schema.
+        m_output_columns.clear();
+        const auto output_columns = root.get_child_optional("outputColumns");
+        if (output_columns)
+        {
+            for (const auto &writer_node : *output_columns)
+            {
+                std::vector<std::string> columns;
+                for (const auto &v : writer_node.second)
+                {
+                    columns.push_back(v.second.data());
+                }
+                m_output_columns[writer_node.first] = columns;
+                WRITE_LOG << "Output columns for " << writer_node.first << ": "
+                          << columns.size() << " selected";
+            }
+        }
+
+        // Run the Barnes-Hut gravity walk concurrently with the fluid-force
+        // sweep on a split thread budget (see Solver::integrate)
+        m_task_parallel = root.get<bool>("taskParallel", false);
+        if (m_task_parallel)
+        {
+            WRITE_LOG << "Task-parallel force phase enabled";
+        }
+
+        // Per-step OpenMP team sizing (see Solver::integrate): at small N
+        // the fork/join and barrier cost of a full team exceeds the compute
+        // in each module's parallel loops, so the team shrinks with the
+        // particle count
+        m_team_auto_size = root.get<bool>("teamAutoSize", false);
+        if (m_team_auto_size)
+        {
+            m_team_particles_per_thread = root.get<int>("teamParticlesPerThread", 2000);
+            WRITE_LOG << "Per-step team sizing enabled: one thread per "
+                      << m_team_particles_per_thread << " particles";
+        }
+
         m_param->periodic.is_valid = root.get<bool>("periodic", false);
         if (m_param->periodic.is_valid)
         {
@@ -393,12 +821,19 @@ namespace sph
                 m_param->periodic.range_min[i] = std::stod(v.second.data());
                 ++i;
             }
+
+            m_param->periodic.use_ghosts = root.get<bool>("periodicGhosts", false);
+            if (m_param->periodic.use_ghosts)
+            {
+                WRITE_LOG << "Periodic ghost-image layer enabled";
+            }
         }
         m_param->density_relaxation.is_valid = root.get<bool>("useDensityRelaxation", false);
         if (m_param->density_relaxation.is_valid)
         {
             m_param->density_relaxation.max_iterations = root.get<int>("densityRelaxationMaxIter", 100);
             m_param->density_relaxation.damping_factor = root.get<real>("densityRelaxationDamping", 0.1);
+            m_param->density_relaxation.tolerance = root.get<real>("densityRelaxationTolerance", 1e-3);
             m_param->density_relaxation.velocity_threshold = root.get<real>("velocityThreshold", 1e-3);
             m_param->density_relaxation.table_file = root.get<std::string>("laneEmdenTable", "xi_theta.csv");
         }
@@ -409,6 +844,78 @@ namespace sph
             m_param->gravity.constant = root.get<real>("G", 1.0);
             WRITE_LOG << "G = " << m_param->gravity.constant;
             m_param->gravity.theta = root.get<real>("theta", 0.5);
+            m_param->gravity.dual_tree = root.get<bool>("gravityDualTree", false);
+            if (m_param->gravity.dual_tree)
+            {
+                WRITE_LOG << "gravity dual-tree (group walk) enabled";
+            }
+            m_param->gravity.interval = root.get<int>("gravityInterval", 1);
+            if (m_param->gravity.interval > 1)
+            {
+                m_param->gravity.extrapolate = root.get<bool>("gravityExtrapolate", true);
+                WRITE_LOG << "multi-rate gravity: full tree solve every "
+                          << m_param->gravity.interval << " steps, "
+                          << (m_param->gravity.extrapolate ? "linearly extrapolated" : "held")
+                          << " in between";
+            }
+        }
+
+        m_param->external_potential.is_valid = root.get<bool>("useExternalPotential", false);
+        if (m_param->external_potential.is_valid)
+        {
+            auto &ext = m_param->external_potential;
+            const std::string profile = root.get<std::string>("externalPotentialProfile", "pointMass");
+            if (profile == "pointMass")
+            {
+                ext.profile = ExternalPotentialType::POINT_MASS;
+            }
+            else if (profile == "plummer")
+            {
+                ext.profile = ExternalPotentialType::PLUMMER;
+            }
+            else if (profile == "nfw")
+            {
+                ext.profile = ExternalPotentialType::NFW;
+            }
+            else
+            {
+                THROW_ERROR("Unknown externalPotentialProfile");
+            }
+            ext.constant = root.get<real>("G", 1.0);
+            ext.mass = root.get<real>("externalPotentialMass", 1.0);
+            ext.scale = root.get<real>("externalPotentialScale", 0.0);
+            if (ext.profile == ExternalPotentialType::NFW && ext.scale <= 0.0)
+            {
+                THROW_ERROR("externalPotentialScale must be positive for the NFW profile");
+            }
+            if (const auto center = root.get_child_optional("externalPotentialCenter"))
+            {
+                if (center->size() != DIM)
+                {
+                    THROW_ERROR("externalPotentialCenter != DIM");
+                }
+                int i = 0;
+                for (const auto &v : *center)
+                {
+                    ext.center[i] = std::stod(v.second.data());
+                    ++i;
+                }
+            }
+            if (const auto velocity = root.get_child_optional("externalPotentialVelocity"))
+            {
+                if (velocity->size() != DIM)
+                {
+                    THROW_ERROR("externalPotentialVelocity != DIM");
+                }
+                int i = 0;
+                for (const auto &v : *velocity)
+                {
+                    ext.velocity[i] = std::stod(v.second.data());
+                    ++i;
+                }
+            }
+            WRITE_LOG << "External potential: " << profile << " (M = " << ext.mass
+                      << ", scale = " << ext.scale << ")";
         }
 
         std::string sph_type = root.get<std::string>("SPHType", "ssph");
@@ -443,6 +950,15 @@ namespace sph
         m_param->heating_cooling.is_valid = root.get<bool>("useHeatingCooling", false);
         m_param->heating_cooling.heating_rate = root.get<real>("heatingRate", m_param->heating_cooling.heating_rate);
         m_param->heating_cooling.cooling_rate = root.get<real>("coolingRate", m_param->heating_cooling.cooling_rate);
+        m_param->heating_cooling.subcycle = root.get<bool>("coolingSubcycle", false);
+        m_param->heating_cooling.subcycle_tol = root.get<real>("coolingSubcycleTol", m_param->heating_cooling.subcycle_tol);
+        m_param->heating_cooling.max_subcycles = root.get<int>("coolingMaxSubcycles", m_param->heating_cooling.max_subcycles);
+        if (m_param->heating_cooling.is_valid && m_param->heating_cooling.subcycle)
+        {
+            WRITE_LOG << "Heating/cooling sub-cycling enabled (tol = "
+                      << m_param->heating_cooling.subcycle_tol
+                      << ", max " << m_param->heating_cooling.max_subcycles << " inner steps)";
+        }
 
         std::string unitFile = root.get<std::string>("unitConfig", "");
         if (!unitFile.empty())
@@ -492,23 +1008,133 @@ namespace sph
             m_param->checkpointing.max_keep = root.get<int>("checkpointMaxKeep", 3);
             m_param->checkpointing.on_interrupt = root.get<bool>("checkpointOnInterrupt", true);
             m_param->checkpointing.directory = root.get<std::string>("checkpointDirectory", "checkpoints");
-            
+            m_param->checkpointing.delta = root.get<bool>("checkpointDelta", false);
+            m_param->checkpointing.keyframe_interval = root.get<int>("checkpointKeyframeInterval", 10);
+            m_param->checkpointing.delta_tolerance = root.get<real>("checkpointDeltaTolerance", 0.0);
+
             WRITE_LOG << "Auto-checkpoint enabled:";
             WRITE_LOG << "  Interval: " << m_param->checkpointing.interval;
             WRITE_LOG << "  Max keep: " << m_param->checkpointing.max_keep;
             WRITE_LOG << "  Directory: " << m_param->checkpointing.directory;
+            if (m_param->checkpointing.delta)
+            {
+                WRITE_LOG << "  Delta mode: keyframe every " << m_param->checkpointing.keyframe_interval
+                          << " checkpoints, tolerance " << m_param->checkpointing.delta_tolerance;
+            }
+        }
+
+        // Initial-conditions cache: keep the canonical resolved config (after
+        // the extends merge) so initialize() can key the cache file on it
+        m_ic_cache = root.get<bool>("icCache", false);
+        if (m_ic_cache)
+        {
+            std::ostringstream canonical;
+            pt::write_json(canonical, root);
+            m_ic_cache_config = canonical.str();
+            WRITE_LOG << "Initial-conditions cache enabled";
         }
     }
 
     void Solver::run()
     {
+        if (m_scaling_mode)
+        {
+            run_scaling();
+            return;
+        }
+        if (m_sweep_mode)
+        {
+            run_sweep();
+            return;
+        }
+
         initialize();
-        
+        run_simulation_loop();
+    }
+
+    void Solver::run_sweep()
+    {
+        // One config path per line; blank lines and '#' comments skipped.
+        std::vector<std::string> configs;
+        {
+            std::ifstream list(m_sweep_list_file);
+            if (!list.is_open())
+            {
+                THROW_ERROR("Cannot open sweep list file: ", m_sweep_list_file);
+            }
+            std::string line;
+            while (std::getline(list, line))
+            {
+                const auto first = line.find_first_not_of(" \t\r");
+                if (first == std::string::npos || line[first] == '#')
+                {
+                    continue;
+                }
+                const auto last = line.find_last_not_of(" \t\r");
+                configs.push_back(line.substr(first, last - first + 1));
+            }
+        }
+        if (configs.empty())
+        {
+            THROW_ERROR("Sweep list file has no configs: ", m_sweep_list_file);
+        }
+
+        WRITE_LOG << "Sweep mode: " << configs.size() << " configurations from "
+                  << m_sweep_list_file;
+
+        int failed = 0;
+        for (std::size_t c = 0; c < configs.size(); ++c)
+        {
+            WRITE_LOG << "---- sweep [" << (c + 1) << "/" << configs.size()
+                      << "] " << configs[c] << " ----";
+
+            // Fresh per-run state; the plugin handle, the warm OpenMP pool
+            // and the IC cache carry over between configurations.
+            m_json_file = configs[c];
+            m_param = std::make_shared<SPHParameters>();
+            m_step_count = 0;
+            m_snapshot_index = 0;
+            m_verlet_travel = 0.0;
+            m_verlet_skin = 0.0;
+            m_dt_max_seen = 0.0;
+            m_last_snapshot_ekin = -1.0;
+            if (m_energy_out.is_open())
+            {
+                m_energy_out.close();  // reopened in the next run's directory
+            }
+            m_async_output.reset();      // recreated when the config asks for it
+            m_checkpoint_manager.reset();
+            m_laneEmdenRelaxation.reset();
+            m_step_timer.reset_totals();
+
+            // A bad config should cost one run, not the remaining sweep.
+            try
+            {
+                initialize();
+                run_simulation_loop();
+            }
+            catch (const std::exception &e)
+            {
+                ++failed;
+                std::cerr << "Sweep config " << configs[c] << " failed: "
+                          << e.what() << std::endl;
+                WRITE_LOG << "Sweep config " << configs[c] << " failed: " << e.what();
+            }
+        }
+
+        WRITE_LOG << "Sweep finished: " << configs.size() - failed << " of "
+                  << configs.size() << " configurations completed";
+    }
+
+    void Solver::run_simulation_loop()
+    {
         // Register signal handler for graceful interruption with checkpoint save
         if (m_param->checkpointing.enabled && m_param->checkpointing.on_interrupt)
         {
             std::signal(SIGINT, signal_handler);
-            WRITE_LOG << "Signal handler registered (Ctrl+C will save checkpoint before exit)";
+            std::signal(SIGTERM, signal_handler);
+            WRITE_LOG << "Signal handlers registered (Ctrl+C saves a checkpoint before exit, "
+                         "SIGTERM triggers the preemption fast flush)";
         }
         
         // Handle checkpoint resume if enabled
@@ -542,6 +1168,44 @@ namespace sph
         real t = m_sim->get_time();
         while (t < t_end)
         {
+            // Preemption warning (SIGTERM): the walltime grant is about to
+            // end, so everything optional is dropped — queued snapshots are
+            // discarded and the minimal-state checkpoint goes straight from
+            // particle memory to disk (see save_checkpoint_fast).
+            if (g_preempt_requested)
+            {
+                WRITE_LOG << "\n*** Preemption signal received (SIGTERM) ***";
+
+                if (m_checkpoint_manager && m_param->checkpointing.on_interrupt)
+                {
+                    if (m_async_output)
+                    {
+                        m_async_output->discard_pending();
+                    }
+                    std::string checkpoint_path = m_checkpoint_manager->generate_checkpoint_path(
+                        m_simulation_run->get_run_directory(), t
+                    );
+
+                    WRITE_LOG << "Fast-flush checkpoint at t=" << t << " to " << checkpoint_path;
+                    if (m_domain)
+                    {
+                        // same fast-flush schema, one shared file via MPI-IO
+                        CollectiveCheckpoint::save(*m_checkpoint_manager, checkpoint_path, *m_sim, *m_param);
+                    }
+                    else
+                    {
+                        m_checkpoint_manager->save_checkpoint_fast(checkpoint_path, *m_sim, *m_param);
+                    }
+                    WRITE_LOG << "Checkpoint saved.";
+                    WRITE_LOG << "Resume with: \"resumeFromCheckpoint\": true, \"resumeCheckpointFile\": \""
+                              << checkpoint_path << "\"";
+                }
+
+                WRITE_LOG << "Exiting before the preemption deadline...";
+                Logger::flush();
+                break;
+            }
+
             // Check for interrupt signal
             if (g_interrupt_requested)
             {
@@ -554,7 +1218,14 @@ namespace sph
                     );
                     
                     WRITE_LOG << "Saving interrupt checkpoint at t=" << t << " to " << checkpoint_path;
-                    m_checkpoint_manager->save_checkpoint(checkpoint_path, *m_sim, *m_param);
+                    if (m_domain)
+                    {
+                        CollectiveCheckpoint::save(*m_checkpoint_manager, checkpoint_path, *m_sim, *m_param);
+                    }
+                    else
+                    {
+                        m_checkpoint_manager->save_checkpoint(checkpoint_path, *m_sim, *m_param);
+                    }
                     WRITE_LOG << "Checkpoint saved successfully.";
                     WRITE_LOG << "Resume with: \"resumeFromCheckpoint\": true, \"resumeCheckpointFile\": \"" 
                               << checkpoint_path << "\"";
@@ -568,9 +1239,21 @@ namespace sph
             const real dt = m_sim->get_dt();
             ++loop;
 
+            if (m_param->adaptive_output.is_valid)
+            {
+                m_dt_max_seen = std::max(m_dt_max_seen, dt);
+            }
+
             m_sim->update_time();
             t = m_sim->get_time();
 
+            // In-situ reductions on the state correct() just finalized
+            if (m_insitu.enabled())
+            {
+                StepTimer::Scope scope(m_step_timer, "insitu");
+                m_insitu.sample(*m_sim);
+            }
+
             const auto t_cout_f = std::chrono::system_clock::now();
             const real t_cout_s = std::chrono::duration_cast<std::chrono::seconds>(t_cout_f - t_cout_i).count();
             if (t_cout_s >= 1.0)
@@ -587,12 +1270,48 @@ namespace sph
 
             if (t > t_out)
             {
-                for (auto& writer : m_output_writers)
+                StepTimer::Scope scope(m_step_timer, "output");
+                auto out_sim = snapshot_view();
+                if (m_async_output)
                 {
-                    writer->write_snapshot(m_sim);
+                    m_async_output->enqueue(out_sim, m_output_writers);
                 }
-                t_out += m_param->time.output;
-            }
+                else
+                {
+                    // One shared serialization pass; with several formats
+                    // enabled the writers consume it on separate threads so
+                    // adding a format does not stack another full stall.
+                    SnapshotStage stage;
+                    stage.build(*out_sim, m_unit);
+                    if (m_output_writers.size() > 1)
+                    {
+                        std::vector<std::thread> writers;
+                        for (auto& writer : m_output_writers)
+                        {
+                            writers.emplace_back([&stage, &writer]
+                                                 { writer->write_staged(stage); });
+                        }
+                        for (auto& w : writers)
+                        {
+                            w.join();
+                        }
+                    }
+                    else
+                    {
+                        for (auto& writer : m_output_writers)
+                        {
+                            writer->write_staged(stage);
+                        }
+                    }
+                }
+                t_out += m_param->adaptive_output.is_valid ? next_output_interval()
+                                                           : m_param->time.output;
+
+                // Snapshot cadence doubles as the memory-report cadence
+                m_sim->account_memory();
+                MemoryFootprint::log_report("snapshot " + std::to_string(m_snapshot_index));
+                HugePages::log_coverage("snapshot " + std::to_string(m_snapshot_index));
+            }
             
             // Auto-checkpoint if enabled
             if (m_checkpoint_manager && m_checkpoint_manager->should_checkpoint(t))
@@ -602,16 +1321,32 @@ namespace sph
                 );
                 
                 WRITE_LOG << "Saving checkpoint at t=" << t << " to " << checkpoint_path;
-                m_checkpoint_manager->save_checkpoint(checkpoint_path, *m_sim, *m_param);
+                if (m_domain)
+                {
+                    // one shared file, slices written collectively; the
+                    // merged chunk digests keep it loadable by any rank count
+                    CollectiveCheckpoint::save(*m_checkpoint_manager, checkpoint_path, *m_sim, *m_param);
+                }
+                else
+                {
+                    m_checkpoint_manager->save_checkpoint(checkpoint_path, *m_sim, *m_param);
+                }
+                m_checkpoint_manager->record_checkpoint(checkpoint_path, t);
             }
             
             if (t > t_ene)
             {
-                // TODO: Implement energy output with new system
-                // For now, skip energy output during refactoring
+                write_conserved_quantities(t);
                 t_ene += m_param->time.energy;
             }
         }
+
+        // Make sure every staged snapshot is on disk before reporting.
+        if (m_async_output)
+        {
+            m_async_output->flush();
+        }
+
         const auto end = std::chrono::system_clock::now();
         const real calctime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
         WRITE_LOG << "\ncalculation is finished";
@@ -640,6 +1375,8 @@ namespace sph
         sim_params.neighbor_number = m_param->physics.neighbor_number;
         sim_params.use_balsara = m_param->av.use_balsara_switch;
         sim_params.use_time_dependent_av = m_param->av.use_time_dependent_av;
+        sim_params.gravity_interval = m_param->gravity.is_valid ? m_param->gravity.interval : 1;
+        sim_params.gravity_extrapolate = sim_params.gravity_interval > 1 && m_param->gravity.extrapolate;
 
         MetadataGenerator::OutputInfo output_info;
         for (auto format : m_simulation_run->get_config().output_formats)
@@ -647,6 +1384,8 @@ namespace sph
             if (format == OutputFormat::CSV) output_info.formats.push_back("csv");
             else if (format == OutputFormat::BINARY) output_info.formats.push_back("binary");
             else if (format == OutputFormat::NUMPY) output_info.formats.push_back("numpy");
+            else if (format == OutputFormat::COMPRESSED) output_info.formats.push_back("compressed");
+            else if (format == OutputFormat::COLUMNAR) output_info.formats.push_back("columnar");
         }
         output_info.snapshot_count = 0;  // TODO: Track this
         output_info.total_output_size_mb = 0.0;  // TODO: Calculate this
@@ -661,6 +1400,97 @@ namespace sph
             run_info, code_version, sim_params, m_unit, output_info, perf_info
         );
         m_simulation_run->save_metadata(metadata_json);
+
+        // drain the async log queue so the summary lines are on disk
+        Logger::flush();
+    }
+
+    void Solver::run_scaling()
+    {
+        // The report needs the per-module breakdown, so force the timing
+        // instrumentation on regardless of the config.
+        m_timing_requested = true;
+
+        // The harness owns the thread count per configuration; per-step
+        // team sizing would fight it.
+        m_team_auto_size = false;
+
+        initialize();
+
+        WRITE_LOG << "Scaling harness: " << m_scaling_steps << " steps per configuration, "
+                  << m_scaling_threads.size() << " thread counts";
+
+        // Every configuration integrates the same steps from this snapshot.
+        const auto particles0 = m_sim->get_particles();
+        const int num0 = m_sim->get_particle_num();
+        const real time0 = m_sim->get_time();
+        const real dt0 = m_sim->get_dt();
+
+        struct ScalingResult
+        {
+            int threads;
+            double seconds;
+            std::vector<std::pair<std::string, double>> phases; // ms totals
+        };
+        std::vector<ScalingResult> results;
+
+        for (const int threads : m_scaling_threads)
+        {
+#ifdef _OPENMP
+            omp_set_num_threads(threads);
+#endif
+            // restore the reference state (and the solver's per-run counters)
+            m_sim->set_particles(particles0);
+            m_sim->set_particle_num(num0);
+            m_sim->set_time(time0);
+            m_sim->set_dt(dt0);
+            m_step_count = 0;
+            m_verlet_travel = 0.0;
+            m_step_timer.reset_totals();
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int step = 0; step < m_scaling_steps; ++step)
+            {
+                integrate();
+            }
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+
+            ScalingResult result;
+            result.threads = threads;
+            result.seconds = elapsed.count() * 1e-6;
+            result.phases = m_step_timer.totals();
+            results.push_back(result);
+
+            WRITE_LOG << "  threads=" << threads << ": " << result.seconds << " s";
+        }
+
+        // --- scaling report ---
+        const double t_ref = results.front().seconds;
+        const int n_ref = results.front().threads;
+
+        WRITE_LOG << "---- scaling report (" << m_scaling_steps << " steps, "
+                  << num0 << " particles, reference: " << n_ref << " threads) ----";
+        WRITE_LOG << "threads   time[s]   speedup   efficiency";
+        for (const auto &result : results)
+        {
+            const double speedup = t_ref / result.seconds;
+            const double efficiency = speedup * n_ref / result.threads;
+            WRITE_LOG << result.threads << "   " << result.seconds << "   "
+                      << speedup << "   " << efficiency;
+        }
+
+        WRITE_LOG << "per-module breakdown (ms per step):";
+        for (const auto &result : results)
+        {
+            std::stringstream row;
+            row << "  threads=" << result.threads << ":";
+            for (const auto &phase : result.phases)
+            {
+                row << " " << phase.first << "=" << phase.second / m_scaling_steps;
+            }
+            WRITE_LOG << row.str();
+        }
     }
 
     void Solver::initialize()
@@ -679,10 +1509,24 @@ namespace sph
 
         // Create simulation first
         m_sim = std::make_shared<Simulation>(m_param);
-        
+
+        // Initial-conditions cache: a hit skips the sample's create function
+        // entirely and adopts the stored post-generation particle state below
+        std::string ic_cache_path;
+        bool ic_cache_hit = false;
+        if (m_ic_cache && m_param->initial_conditions_file.empty())
+        {
+            namespace bfs = boost::filesystem;
+            const std::string stem = bfs::path(m_sample_name).stem().string();
+            const std::string hash = ic_cache_hash(m_ic_cache_config, stem);
+            ic_cache_path = m_output_dir + "/ic_cache/" + stem + "_" + dim_str + "_" + hash + ".chk";
+            ic_cache_hit = bfs::exists(ic_cache_path);
+            WRITE_LOG << "IC cache " << (ic_cache_hit ? "hit: " : "miss: ") << ic_cache_path;
+        }
+
         // Initialize simulation loader early to get proper simulation name
         m_simulation_loader = std::make_unique<SimulationLoader>();
-        bool loaded = m_simulation_loader->load_and_initialize(m_sample_name, m_sim, m_param);
+        bool loaded = m_simulation_loader->load_and_initialize(m_sample_name, m_sim, m_param, !ic_cache_hit);
         
         if (!loaded)
         {
@@ -721,14 +1565,59 @@ namespace sph
         run_config.save_metadata = true;
         run_config.save_source_code = true;
         run_config.output_formats = {OutputFormat::CSV, OutputFormat::BINARY};  // Default to both formats
+        run_config.binary_precision = m_binary_precision;
+        run_config.output_columns = m_output_columns;
+        if (m_compressed_output)
+        {
+            run_config.output_formats.push_back(OutputFormat::COMPRESSED);
+        }
+        if (m_columnar_output)
+        {
+            run_config.output_formats.push_back(OutputFormat::COLUMNAR);
+        }
+        if (m_container_output)
+        {
+            run_config.output_formats.push_back(OutputFormat::CONTAINER);
+        }
         
         // Get source files for this sample (optional - if empty, entire src/samples tree is saved)
         // run_config.source_files = SampleRegistry::instance().get_source_files(m_sample_name);
         // Leave source_files empty to copy entire samples directory tree
 
         m_simulation_run = std::make_unique<SimulationRun>(run_config);
+
+        if (m_timing_requested)
+        {
+            m_step_timer.enable(m_simulation_run->get_run_directory() + "/timings.csv");
+            // no-op unless built with USE_PERF_COUNTERS
+            m_perf_counters.enable(m_simulation_run->get_run_directory() + "/counters.csv");
+        }
+        if (m_cost_requested)
+        {
+            CostHistograms::enable(m_simulation_run->get_run_directory() + "/cost_histograms.jsonl");
+        }
+        m_tree_tuner.initialize(m_param);
+        if (m_tree_tuner.enabled())
+        {
+            m_tree_tuner.set_report_path(m_simulation_run->get_run_directory() + "/tree_tuning.json");
+        }
+        m_insitu.initialize(m_param, m_simulation_run->get_run_directory());
+        m_sim->set_step_timer(&m_step_timer);
+
+        if (m_param->out_of_core.enabled)
+        {
+            std::string scratch_dir = m_param->out_of_core.directory;
+            if (scratch_dir.empty())
+            {
+                scratch_dir = m_simulation_run->get_run_directory() + "/scratch";
+            }
+            boost::filesystem::create_directories(scratch_dir);
+            m_sim->enable_out_of_core(scratch_dir);
+        }
         
-        // Create output writers for each format
+        // Create output writers for each format (sweep mode re-initializes,
+        // so drop the previous run's writers first)
+        m_output_writers.clear();
         for (auto format : run_config.output_formats)
         {
             m_output_writers.push_back(m_simulation_run->create_writer(format, m_unit));
@@ -754,8 +1643,10 @@ namespace sph
             WRITE_LOG << "  Time: " << data.time;
             WRITE_LOG << "  Dimension: " << data.dimension;
             
-            // Set particles in simulation
-            m_sim->set_particles(data.particles);
+            // Set particles in simulation (adopted by move; multi-GB initial
+            // conditions should not be duplicated here)
+            m_sim->set_particle_num(static_cast<int>(data.particles.size()));
+            m_sim->set_particles(std::move(data.particles));
             m_sim->set_time(data.time);
             m_sim->set_dt(data.dt);
             
@@ -764,8 +1655,12 @@ namespace sph
             if (modifier)
             {
                 WRITE_LOG << "Applying initial conditions modifier...";
-                auto& particles = m_sim->get_particles();
-                modifier->modifyParticles(particles, m_sim);
+                // Span + appender entry point: in-place edits and appends in
+                // the simulation's storage; legacy modifiers are forwarded
+                // to their vector hook by the default modify()
+                ParticleAppender appender = m_sim->particle_appender();
+                modifier->modify(m_sim->particle_span(), appender, m_sim);
+                m_sim->finalize_particles();
                 WRITE_LOG << "Modifier applied. Final particle count: " << m_sim->get_particle_num();
             }
             
@@ -776,6 +1671,18 @@ namespace sph
             // Simulation already loaded in the beginning of initialize()
             // Just save the initial state and source files
 
+            if (ic_cache_hit)
+            {
+                // Adopt the cached post-generation state instead of the
+                // create function's output (which was skipped above)
+                CheckpointManager cache_loader;
+                CheckpointData data = cache_loader.load_checkpoint(ic_cache_path);
+                WRITE_LOG << "IC cache: loaded " << data.particles.size()
+                          << " particles from " << ic_cache_path;
+                m_sim->set_particle_num(static_cast<int>(data.particles.size()));
+                m_sim->set_particles(std::move(data.particles));
+            }
+
             // Save initial conditions using new system
             const auto& particles = m_sim->get_particles();
             m_simulation_run->save_initial_conditions(particles, m_unit);
@@ -806,13 +1713,29 @@ namespace sph
                 m_laneEmdenRelaxation = std::make_unique<LaneEmdenRelaxation>();
                 // Load the table using the file name from JSON (see below)
                 m_laneEmdenRelaxation->load_table(m_param->density_relaxation.table_file);
-                // Then apply the relaxation force
-                m_laneEmdenRelaxation->add_relaxation_force(m_sim, *m_param);
-                WRITE_LOG << "Density relaxation: LaneEmden-based force applied.";
+                // Then apply the relaxation force (a cache hit already holds
+                // the post-relaxation state; the per-step forces still run)
+                if (!ic_cache_hit)
+                {
+                    m_laneEmdenRelaxation->add_relaxation_force(m_sim, *m_param);
+                    WRITE_LOG << "Density relaxation: LaneEmden-based force applied.";
+                }
                 WRITE_LOG << "Density relaxation enabled: max_iter=" << m_param->density_relaxation.max_iterations
                           << ", damping=" << m_param->density_relaxation.damping_factor
                           << ", velocity_threshold=" << m_param->density_relaxation.velocity_threshold;
             }
+
+            if (!ic_cache_path.empty() && !ic_cache_hit)
+            {
+                // Store the generated (and relaxation-seeded) state for the
+                // next run with an identical resolved config
+                namespace bfs = boost::filesystem;
+                bfs::create_directories(bfs::path(ic_cache_path).parent_path());
+                CheckpointManager cache_writer;
+                cache_writer.save_checkpoint(ic_cache_path, *m_sim, *m_param);
+                WRITE_LOG << "IC cache: stored " << m_sim->get_particle_num()
+                          << " particles to " << ic_cache_path;
+            }
         }
 
         ModuleFactory &factory = ModuleFactory::instance();
@@ -825,6 +1748,10 @@ namespace sph
             m_hcool = std::make_shared<HeatingCoolingModule>();
         }
 
+        LoopScheduler::initialize(m_param);
+        NumaPlacement::initialize(m_param);
+        HugePages::initialize(m_param);
+
         m_timestep->initialize(m_param);
         m_pre->initialize(m_param);
         m_fforce->initialize(m_param);
@@ -846,6 +1773,37 @@ namespace sph
             m_sim->add_vector_array(names);
         }
 
+        // MPI: every rank generated the full initial conditions above; from
+        // here on each one only keeps its slab plus a per-step ghost halo
+        if (DomainDecomposition::enabled())
+        {
+            m_domain = std::make_unique<DomainDecomposition>();
+            m_domain->initialize(m_param);
+            m_domain->decompose(m_sim);
+        }
+
+        m_ghost.initialize(m_param);
+        if (m_ghost.enabled() && m_domain)
+        {
+            // the slab halos already carry the wrap-around images
+            THROW_ERROR("periodicGhosts cannot be combined with MPI domain decomposition");
+        }
+
+        if (m_param->refinement.is_valid && m_domain)
+        {
+            // pairs straddling a slab boundary cannot merge consistently
+            WRITE_LOG << "Adaptive refinement is not supported with MPI decomposition; disabled";
+            m_param->refinement.is_valid = false;
+        }
+        m_refinement.initialize(m_param);
+        m_culling.initialize(m_param);
+
+        // NUMA: the particle vector was filled serially on one socket.
+        // Re-place its pages to match the static loop partition; the Morton
+        // reorder copies back into this allocation, so the placement holds.
+        NumaPlacement::place(m_sim->get_particles());
+        HugePages::advise(m_sim->get_particles());
+
         auto &p = m_sim->get_particles();
         const int num = m_sim->get_particle_num();
         const real c_sound = m_param->physics.gamma * (m_param->physics.gamma - 1.0);
@@ -860,27 +1818,52 @@ namespace sph
             p[i].sound = std::sqrt(c_sound * p[i].ene);
         }
 
+        if (m_domain)
+        {
+            m_domain->exchange_halo(m_sim);
+        }
+        m_ghost.build(m_sim);
+
 #ifndef EXHAUSTIVE_SEARCH
         auto tree = m_sim->get_tree();
-        tree->resize(num);
-        tree->make(p, num);
+        // ghosts come and go every step in MPI or image mode; leave pool slack
+        tree->resize((m_domain || m_ghost.enabled()) ? num * 2 : num);
+        tree->make(m_sim->get_particles(), m_sim->get_particle_num());
 #endif
 
         m_pre->calculation(m_sim);
+        if (m_domain)
+        {
+            m_domain->refresh_halo(m_sim);
+        }
+        m_ghost.refresh(m_sim);
+#ifndef EXHAUSTIVE_SEARCH
+        m_sim->build_neighbor_cache();
+        m_sim->build_pair_list();
+#endif
         m_fforce->calculation(m_sim);
         m_gforce->calculation(m_sim);
         if (m_hcool)
         {
             m_hcool->calculation(m_sim);
         }
+        if (m_domain)
+        {
+            m_domain->drop_halo(m_sim);
+        }
+        m_ghost.drop(m_sim);
 
         // Initialize checkpoint manager if checkpointing is enabled
         if (m_param->checkpointing.enabled)
         {
             CheckpointManager::AutoCheckpointConfig config;
+            config.enabled = true;
             config.interval = m_param->checkpointing.interval;
             config.max_keep = m_param->checkpointing.max_keep;
             config.directory = m_param->checkpointing.directory;
+            config.delta_enabled = m_param->checkpointing.delta;
+            config.keyframe_interval = m_param->checkpointing.keyframe_interval;
+            config.delta_tolerance = m_param->checkpointing.delta_tolerance;
             
             m_checkpoint_manager = std::make_unique<CheckpointManager>(config);
             WRITE_LOG << "Checkpoint manager initialized:";
@@ -890,52 +1873,539 @@ namespace sph
         }
 
         WRITE_LOG << "Initialization complete. Particle count=" << m_sim->get_particle_num();
+        m_sim->account_memory();
+        MemoryFootprint::log_report("startup");
+        HugePages::log_coverage("startup");
     }
 
-    void Solver::restore_from_checkpoint(const CheckpointData& data)
+    std::shared_ptr<Simulation> Solver::snapshot_view()
+    {
+        const auto &sel = m_param->snapshot;
+        const bool active = sel.roi_box || sel.roi_sphere || sel.lod_stride > 1;
+        if (!active)
+        {
+            return m_sim;
+        }
+
+        const int index = m_snapshot_index++;
+        if (sel.full_interval > 0 && index % sel.full_interval == 0)
+        {
+            // Periodic complete dump at the coarser cadence
+            return m_sim;
+        }
+
+        const auto &p = m_sim->get_particles();
+        const int num = m_sim->get_particle_num();
+        std::vector<SPHParticle> subset;
+        subset.reserve(sel.lod_stride > 1 ? num / sel.lod_stride + 1 : num);
+
+        // The LOD stride samples the particle array, so with the Morton
+        // reorder active (reorderInterval) every k-th particle is spatially
+        // stratified rather than clustered by creation order.
+        for (int i = 0; i < num; i += sel.lod_stride)
+        {
+            const auto &p_i = p[i];
+            if (sel.roi_box)
+            {
+                bool inside = true;
+                for (int d = 0; d < DIM; ++d)
+                {
+                    inside &= p_i.pos[d] >= sel.roi_min[d] && p_i.pos[d] <= sel.roi_max[d];
+                }
+                if (!inside)
+                {
+                    continue;
+                }
+            }
+            if (sel.roi_sphere)
+            {
+                real r2 = 0.0;
+                for (int d = 0; d < DIM; ++d)
+                {
+                    r2 += sqr(p_i.pos[d] - sel.roi_center[d]);
+                }
+                if (r2 > sqr(sel.roi_radius))
+                {
+                    continue;
+                }
+            }
+            subset.push_back(p_i);
+        }
+
+        auto view = std::make_shared<Simulation>(m_param);
+        view->set_time(m_sim->get_time());
+        view->set_dt(m_sim->get_dt());
+        view->set_particle_num(static_cast<int>(subset.size()));
+        view->set_particles(std::move(subset));
+        WRITE_LOG_ONLY << "Snapshot selection: " << view->get_particle_num()
+                       << " of " << num << " particles";
+        return view;
+    }
+
+    real Solver::next_output_interval()
+    {
+        const auto &p = m_sim->get_particles();
+        const int num = m_sim->get_particle_num();
+        const real dt = m_sim->get_dt();
+
+        // All three metrics are already produced by the step: shockSensor by
+        // the shock detection, dt by the TimeStep module, and the kinetic
+        // energy is one cheap pass over the array.
+        omp_real sensor_max(0.0);
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+        {
+            sensor_max.get() = std::max(sensor_max.get(), p[i].shockSensor);
+        }
+        const real e_kin = deterministic_sum<real>(num, [&](const int i) {
+            return p[i].is_point_mass ? 0.0 : 0.5 * p[i].mass * abs2(p[i].vel);
+        });
+
+        real activity = 0.0;
+        if (dt > 0.0)
+        {
+            // dt collapsing below its running maximum means a CFL criterion
+            // tightened somewhere — something is happening.
+            activity = std::max(activity, m_dt_max_seen / dt - real(1.0));
+        }
+        if (m_last_snapshot_ekin > 0.0)
+        {
+            activity = std::max(activity,
+                                std::abs(e_kin - m_last_snapshot_ekin) / m_last_snapshot_ekin);
+        }
+        // shockSensor is a Mach estimate; ~1 in smooth flow.
+        activity = std::max(activity, sensor_max.max() - real(1.0));
+        m_last_snapshot_ekin = e_kin;
+
+        const auto &ao = m_param->adaptive_output;
+        const real interval = m_param->time.output / (1.0 + activity);
+        const real next = std::min(std::max(interval, ao.min_interval), ao.max_interval);
+        WRITE_LOG_ONLY << "Adaptive output: activity " << activity
+                       << ", next interval " << next;
+        return next;
+    }
+
+    void Solver::write_conserved_quantities(const real t)
+    {
+        const auto &p = m_sim->get_particles();
+        const int num = m_sim->get_particle_num();
+
+        // Fixed-topology sums: the conservation series should be bitwise
+        // identical between runs with different thread counts, or a rerun
+        // cannot be diffed against its reference.
+        const real e_kin = deterministic_sum<real>(num, [&](const int i) {
+            return p[i].is_point_mass ? 0.0 : 0.5 * p[i].mass * abs2(p[i].vel);
+        });
+        const real e_th = deterministic_sum<real>(num, [&](const int i) {
+            return p[i].is_point_mass ? 0.0 : p[i].mass * p[i].ene;
+        });
+        // phi is filled by GravityForce; it stays 0 in non-self-gravitating
+        // runs, so the column reads as zero rather than being conditional.
+        const real e_pot = deterministic_sum<real>(num, [&](const int i) {
+            return p[i].is_point_mass ? 0.0 : 0.5 * p[i].mass * p[i].phi;
+        });
+
+        real mom[DIM];
+        for (int d = 0; d < DIM; ++d)
+        {
+            mom[d] = deterministic_sum<real>(num, [&](const int i) {
+                return p[i].is_point_mass ? 0.0 : p[i].mass * p[i].vel[d];
+            });
+        }
+
+#if DIM == 2
+        const real ang_z = deterministic_sum<real>(num, [&](const int i) {
+            const auto &p_i = p[i];
+            return p_i.is_point_mass
+                       ? 0.0
+                       : p_i.mass * (p_i.pos[0] * p_i.vel[1] - p_i.pos[1] * p_i.vel[0]);
+        });
+#elif DIM == 3
+        real ang[3];
+        for (int d = 0; d < 3; ++d)
+        {
+            const int a = (d + 1) % 3;
+            const int b = (d + 2) % 3;
+            ang[d] = deterministic_sum<real>(num, [&](const int i) {
+                const auto &p_i = p[i];
+                return p_i.is_point_mass
+                           ? 0.0
+                           : p_i.mass * (p_i.pos[a] * p_i.vel[b] - p_i.pos[b] * p_i.vel[a]);
+            });
+        }
+#endif
+
+        if (!m_energy_out.is_open())
+        {
+            m_energy_out.open(m_simulation_run->get_run_directory() + "/energy.dat");
+            // np.loadtxt skips '#' lines; the first five columns match what
+            // analysis/readers.py expects for EnergyHistory.
+#if DIM == 1
+            m_energy_out << "# time e_kin e_thermal e_pot e_total mom_x\n";
+#elif DIM == 2
+            m_energy_out << "# time e_kin e_thermal e_pot e_total mom_x mom_y ang_mom_z\n";
+#else
+            m_energy_out << "# time e_kin e_thermal e_pot e_total mom_x mom_y mom_z"
+                            " ang_mom_x ang_mom_y ang_mom_z\n";
+#endif
+            m_energy_out << std::scientific << std::setprecision(16);
+        }
+
+        m_energy_out << t << ' ' << e_kin << ' ' << e_th << ' ' << e_pot << ' '
+                     << e_kin + e_th + e_pot;
+        for (int d = 0; d < DIM; ++d)
+        {
+            m_energy_out << ' ' << mom[d];
+        }
+#if DIM == 2
+        m_energy_out << ' ' << ang_z;
+#elif DIM == 3
+        for (int d = 0; d < 3; ++d)
+        {
+            m_energy_out << ' ' << ang[d];
+        }
+#endif
+        m_energy_out << '\n';
+        m_energy_out.flush();
+    }
+
+    void Solver::restore_from_checkpoint(CheckpointData& data)
     {
         WRITE_LOG << "Restoring simulation from checkpoint...";
         WRITE_LOG << "  Time: " << data.time;
         WRITE_LOG << "  Timestep: " << data.dt;
         WRITE_LOG << "  Particles: " << data.particles.size();
         
-        // Restore simulation state
+        // Restore simulation state; the particle array is adopted without a
+        // copy (multi-GB checkpoints would otherwise be duplicated here)
         m_sim->set_time(data.time);
         m_sim->set_dt(data.dt);
-        m_sim->set_particles(data.particles);
+        m_sim->get_particles() = std::move(data.particles);
+        m_sim->set_particle_num(static_cast<int>(m_sim->get_particles().size()));
+        m_sim->invalidate_type_partition(); // flags may differ per index now
         
         // Rebuild spatial structures
         WRITE_LOG << "  Rebuilding tree...";
         m_sim->make_tree();
-        
-        WRITE_LOG << "  Finding neighbors...";
-        m_pre->calculation(m_sim);  // Pre-interaction finds neighbors
-        
+
+        auto &derived = data.derived;
+        const int num = m_sim->get_particle_num();
+        if (derived.present && static_cast<int>(derived.records.size()) == num)
+        {
+            // Warm restart: the checkpoint carried the derived state the
+            // pre-interaction pass would otherwise recompute here — EOS
+            // outputs, converged smoothing terms, the global h/v_sig, the
+            // neighbor-list cache and the named additional arrays — so apply
+            // it and start integrating immediately.
+            WRITE_LOG << "  Applying saved derived state (warm restart)...";
+            auto &particles = m_sim->get_particles();
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i)
+            {
+                derived.records[i].unpack(particles[i]);
+            }
+            m_sim->set_h_per_v_sig(derived.h_per_v_sig);
+#ifndef EXHAUSTIVE_SEARCH
+            // the smoothing lengths are final, so propagate them into the
+            // tree the way the pre-interaction pass would have
+            m_sim->get_tree()->set_kernel();
+            if (derived.has_neighbor_cache &&
+                static_cast<int>(derived.nb_offsets.size()) == num + 1)
+            {
+                m_sim->adopt_neighbor_cache(std::move(derived.nb_offsets),
+                                            std::move(derived.nb_indices));
+            }
+#endif
+            for (auto &entry : derived.scalar_arrays)
+            {
+                if (static_cast<int>(entry.second.size()) == num)
+                {
+                    m_sim->add_scalar_array({entry.first});
+                    m_sim->get_scalar_array(entry.first) = std::move(entry.second);
+                }
+            }
+            for (auto &entry : derived.vector_arrays)
+            {
+                if (static_cast<int>(entry.second.size()) == num * DIM)
+                {
+                    m_sim->add_vector_array({entry.first});
+                    auto &values = m_sim->get_vector_array(entry.first);
+                    for (int i = 0; i < num; ++i)
+                    {
+                        for (int d = 0; d < DIM; ++d)
+                        {
+                            values[i][d] = entry.second[i * DIM + d];
+                        }
+                    }
+                }
+            }
+        }
+        else
+        {
+            WRITE_LOG << "  Finding neighbors...";
+            m_pre->calculation(m_sim);  // Pre-interaction finds neighbors
+        }
+
         WRITE_LOG << "Checkpoint restore complete.";
     }
 
     void Solver::integrate()
     {
-        m_timestep->calculation(m_sim);
-        predict();
+        // Per-step team sizing (teamAutoSize config key): OpenMP runtimes
+        // park the team between regions, so what a small step actually pays
+        // per module loop is the wake-up and barrier latency, which scales
+        // with the team size. Matching the team to the particle count (one
+        // thread per teamParticlesPerThread particles, serial at the bottom)
+        // removes that cost for the 1D/2D regression runs without touching
+        // the module interfaces.
+        if (m_team_auto_size)
+        {
+            if (m_team_max_threads == 0)
+            {
+                m_team_max_threads = omp_get_max_threads();
+            }
+            const int wanted = std::max(1, std::min(m_team_max_threads,
+                m_sim->get_particle_num() / std::max(1, m_team_particles_per_thread)));
+            if (wanted != omp_get_max_threads())
+            {
+                omp_set_num_threads(wanted);
+            }
+        }
+
+        m_step_timer.begin_step(m_sim->get_time());
+        m_perf_counters.begin_step(m_sim->get_time());
+        CostHistograms::begin_step(m_sim->get_time());
+        m_tree_tuner.begin_step();
+        {
+            StepTimer::Scope scope(m_step_timer, "timestep");
+            m_timestep->calculation(m_sim);
+        }
+        if (m_domain)
+        {
+            // every rank must advance with the global timestep
+            m_sim->set_dt(m_domain->reduce_dt_min(m_sim->get_dt()));
+        }
+        {
+            StepTimer::Scope scope(m_step_timer, "predict");
+            predict();
+        }
 #ifndef EXHAUSTIVE_SEARCH
-        m_sim->make_tree();
+        // Periodically permute the particles into Morton order so the
+        // neighbor loops stream through nearly-contiguous memory. The tree is
+        // rebuilt right below, so the stale pointers never get used.
+        ++m_step_count;
+        const bool reordered = m_param->reorder.is_valid && m_step_count % m_param->reorder.interval == 0;
+        if (reordered)
+        {
+            StepTimer::Scope scope(m_step_timer, "reorder");
+            m_sim->reorder_particles();
+            // the multi-rate gravity history is indexed by particle slot
+            std::static_pointer_cast<GravityForce>(m_gforce)->invalidate_history();
+        }
+
+        // MPI: migrate strays and mirror the boundary strips; the particle
+        // array changes every step, so the Verlet tree reuse is off here.
+        if (m_domain)
+        {
+            StepTimer::Scope scope(m_step_timer, "halo_exchange");
+            m_domain->exchange_halo(m_sim);
+        }
+
+        // Periodic image particles: rebuilt from the wrapped real positions
+        // every step, so the Verlet tree reuse is off here as well.
+        if (m_ghost.enabled())
+        {
+            StepTimer::Scope scope(m_step_timer, "ghost_build");
+            m_ghost.build(m_sim);
+        }
+
+        // Verlet mode: keep the tree and the cached (skin-inflated) neighbor
+        // lists until the accumulated displacement exceeds half the skin.
+        if (m_domain || m_ghost.enabled() || reordered || m_tree_retune || !m_param->verlet.is_valid || m_verlet_skin <= 0.0 || 2.0 * m_verlet_travel > m_verlet_skin)
+        {
+            StepTimer::Scope scope(m_step_timer, "tree");
+            PerfCounters::Scope counters(m_perf_counters, "tree");
+            update_verlet_skin();
+            m_sim->make_tree();
+            m_verlet_travel = 0.0;
+            m_tree_retune = false;
+        }
 #endif
-        m_pre->calculation(m_sim);
-        m_fforce->calculation(m_sim);
-        m_gforce->calculation(m_sim);
+        {
+            StepTimer::Scope scope(m_step_timer, "pre_interaction");
+            PerfCounters::Scope counters(m_perf_counters, "pre_interaction");
+            m_pre->calculation(m_sim);
+        }
+        if (m_domain)
+        {
+            // ghosts need their owner-computed densities before the forces
+            StepTimer::Scope scope(m_step_timer, "halo_refresh");
+            m_domain->refresh_halo(m_sim);
+        }
+        if (m_ghost.enabled())
+        {
+            // the images need their sources' densities before the forces
+            StepTimer::Scope scope(m_step_timer, "ghost_refresh");
+            m_ghost.refresh(m_sim);
+        }
+#ifndef EXHAUSTIVE_SEARCH
+        if (!m_sim->get_neighbor_cache().is_valid())
+        {
+            StepTimer::Scope scope(m_step_timer, "neighbor_cache");
+            m_sim->build_neighbor_cache();
+        }
+        {
+            // positions move every step, so the geometry is never reusable
+            StepTimer::Scope scope(m_step_timer, "pair_list");
+            m_sim->build_pair_list();
+        }
+#endif
+        // Task-parallel split (taskParallel config key): the Barnes-Hut
+        // walk writes only gravity's side buffers, the fluid force owns
+        // acc/dene, so the two sweeps run concurrently on a split thread
+        // budget (~30/70, matching their usual share of the step). The
+        // dual-tree group walk writes particles directly, so it keeps the
+        // sequential path.
+        auto gforce = std::static_pointer_cast<GravityForce>(m_gforce);
+        if (m_task_parallel && gforce->uses_self_gravity() && !gforce->uses_dual_tree() &&
+            gforce->full_solve_due(m_sim->get_particle_num()))
+        {
+            StepTimer::Scope scope(m_step_timer, "force_tasks");
+            const int total_threads = omp_get_max_threads();
+            const int gravity_threads = std::max(1, (total_threads * 3) / 10);
+            const int fluid_threads = std::max(1, total_threads - gravity_threads);
+            std::thread gravity_task([&]() {
+                omp_set_num_threads(gravity_threads);
+                gforce->stage_self_gravity(m_sim);
+            });
+            omp_set_num_threads(fluid_threads);
+            {
+                PerfCounters::Scope counters(m_perf_counters, "fluid_force");
+                m_fforce->calculation(m_sim);
+            }
+            omp_set_num_threads(total_threads);
+            gravity_task.join();
+            gforce->commit_staged(m_sim);
+        }
+        else
+        {
+            {
+                StepTimer::Scope scope(m_step_timer, "fluid_force");
+                PerfCounters::Scope counters(m_perf_counters, "fluid_force");
+                m_fforce->calculation(m_sim);
+            }
+            {
+                StepTimer::Scope scope(m_step_timer, "gravity");
+                PerfCounters::Scope counters(m_perf_counters, "gravity");
+                m_gforce->calculation(m_sim);
+            }
+        }
         if (m_hcool)
         {
+            StepTimer::Scope scope(m_step_timer, "heating_cooling");
             m_hcool->calculation(m_sim);
         }
         // --- Run Shock Detection ---
         // Call the detect_shocks function using the periodic boundary conditions from m_sim,
         // and use the adiabatic index (gamma) from the simulation parameters.
-        sph::detect_shocks(m_sim, m_sim->get_periodic().get(), m_param->physics.gamma, 1.0);
+        {
+            StepTimer::Scope scope(m_step_timer, "shock_detection");
+            sph::detect_shocks(m_sim, m_sim->get_periodic().get(), m_param->physics.gamma, 1.0,
+                               m_param->shock_refresh_threshold);
+        }
+
+        {
+            StepTimer::Scope scope(m_step_timer, "correct");
+            correct();
+        }
+        if (m_domain)
+        {
+            m_domain->drop_halo(m_sim);
+        }
+        m_ghost.drop(m_sim);
+        if (m_refinement.enabled())
+        {
+            StepTimer::Scope scope(m_step_timer, "refinement");
+            m_refinement.apply(m_sim);
+        }
+        if (m_culling.enabled())
+        {
+            StepTimer::Scope scope(m_step_timer, "culling");
+            m_culling.apply(m_sim);
+        }
+        if (m_perf_counters.enabled())
+        {
+            // interaction pairs this step, for the bytes-per-pair column
+            const auto &p = m_sim->get_particles();
+            const int num = m_sim->get_particle_num();
+            omp_value<long> pairs(0);
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i)
+            {
+                pairs.get() += p[i].neighbor;
+            }
+            m_perf_counters.set_pairs(pairs.sum());
+            m_perf_counters.end_step();
+        }
+        m_step_timer.end_step();
+        CostHistograms::end_step(m_sim.get());
+
+        // Leaf-size sweep: when the tuner switches candidates (or locks in
+        // the winner) the tree is re-initialized with the new leaf size and
+        // the next step forces a full rebuild.
+        if (m_tree_tuner.end_step(m_param))
+        {
+            m_sim->get_tree()->initialize(m_param);
+            m_sim->get_tree()->resize(m_sim->get_particle_num());
+            m_tree_retune = true;
+        }
+
+        // Rare-event totals for this step (ene floors, NR failures, ...)
+        EventCounters::report_and_reset();
+    }
+    void Solver::update_verlet_skin()
+    {
+        if (!m_param->verlet.is_valid)
+        {
+            return;
+        }
+
+        auto &p = m_sim->get_particles();
+        const int num = m_sim->get_particle_num();
+        omp_real h_max(0.0);
+
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+        {
+            if (p[i].sml > h_max.get())
+            {
+                h_max.get() = p[i].sml;
+            }
+        }
 
-        correct();
+        m_verlet_skin = m_param->verlet.skin_factor * h_max.max();
+        m_sim->get_tree()->set_search_margin(m_verlet_skin);
     }
+
     void Solver::predict()
+    {
+        // two_and_half_sim and the periodic domain are fixed for the run;
+        // pick the instantiation once so the per-particle z-clamp and
+        // boundary-wrap branches are folded out of the loop. Open-boundary
+        // runs get a drift loop with no periodic code in it at all.
+        const bool wrap = m_sim->get_periodic()->enabled();
+        if (m_param->two_and_half_sim)
+        {
+            wrap ? predict_impl<true, true>() : predict_impl<true, false>();
+        }
+        else
+        {
+            wrap ? predict_impl<false, true>() : predict_impl<false, false>();
+        }
+    }
+
+    template <bool TwoAndHalf, bool PeriodicWrap>
+    void Solver::predict_impl()
     {
         auto &p = m_sim->get_particles();
         const int num = m_sim->get_particle_num();
@@ -945,11 +2415,15 @@ namespace sph
         const real c_sound = gamma * (gamma - 1.0);
         const real ene_min = 1e-10; // Minimum energy threshold
 
+        // walls and point masses are not time-integrated; iterate the fluid
+        // index range instead of branching on the type flags per particle
+        const auto &fluid = m_sim->fluid_ids();
+        const int n_fluid = static_cast<int>(fluid.size());
+
 #pragma omp parallel for
-        for (int i = 0; i < num; ++i)
+        for (int ii = 0; ii < n_fluid; ++ii)
         {
-            if (p[i].is_point_mass || p[i].is_wall)
-                continue;
+            const int i = fluid[ii];
 
             p[i].vel_p = p[i].vel + p[i].acc * (0.5 * dt);
             p[i].ene_p = p[i].ene + p[i].dene * (0.5 * dt);
@@ -963,42 +2437,82 @@ namespace sph
             {
                 p[i].ene = ene_min;
                 p[i].ene_floored = 1; // Mark as floored
-                WRITE_LOG << "Warning: ene floored to " << ene_min << " for particle " << i << " in predict step.";
+                EventCounters::count(EventCounters::ENE_FLOOR_PREDICT);
             }
 
             p[i].sound = std::sqrt(c_sound * p[i].ene);
 
-            periodic->apply(p[i].pos);
+            if (PeriodicWrap)
+            {
+                // branchless floor/reciprocal wrap, inlined so the whole
+                // drift body stays vectorizable
+                periodic->wrap(p[i].pos);
+            }
 
-            if (m_param->two_and_half_sim)
+            if (TwoAndHalf)
             {
                 p[i].pos[2] = 0.0;
                 p[i].vel[2] = 0.0;
             }
         }
 
-        // Density relaxation (unchanged)
+        // Track the fastest particle so the Verlet skin logic knows how far
+        // the neighbor lists have drifted since the last rebuild.
+        if (m_param->verlet.is_valid)
+        {
+            omp_real v_max(0.0);
+
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i)
+            {
+                const real v = std::abs(p[i].vel_p);
+                if (v > v_max.get())
+                {
+                    v_max.get() = v;
+                }
+            }
+
+            m_verlet_travel += v_max.max() * dt;
+        }
+
+        // Density relaxation: residual-driven — each step checks the L2
+        // density residual and anneals the damping; once converged (or past
+        // max_iterations) the full-cost relaxation sweeps stop entirely.
         if (m_param->density_relaxation.is_valid && m_laneEmdenRelaxation)
         {
-            m_laneEmdenRelaxation->add_relaxation_force(m_sim, *m_param);
-            WRITE_LOG << "Density relaxation: LaneEmden-based force (predict step).";
+            m_laneEmdenRelaxation->begin_iteration(m_sim, *m_param);
+            if (!m_laneEmdenRelaxation->converged())
+            {
+                // Positions moved above, so the cached per-particle force is
+                // stale; correct() reuses what this call computes.
+                m_laneEmdenRelaxation->invalidate_force_cache();
+                m_laneEmdenRelaxation->add_relaxation_force(m_sim, *m_param);
+                WRITE_LOG << "Density relaxation: LaneEmden-based force (predict step).";
+            }
         }
     }
 
     void Solver::correct()
+    {
+        m_param->two_and_half_sim ? correct_impl<true>() : correct_impl<false>();
+    }
+
+    template <bool TwoAndHalf>
+    void Solver::correct_impl()
     {
         auto &p = m_sim->get_particles();
-        const int num = m_sim->get_particle_num();
         const real dt = m_sim->get_dt();
         const real gamma = m_param->physics.gamma;
         const real c_sound = gamma * (gamma - 1.0);
         const real ene_min = 1e-10; // Minimum energy threshold
 
+        const auto &fluid = m_sim->fluid_ids();
+        const int n_fluid = static_cast<int>(fluid.size());
+
 #pragma omp parallel for
-        for (int i = 0; i < num; ++i)
+        for (int ii = 0; ii < n_fluid; ++ii)
         {
-            if (p[i].is_point_mass || p[i].is_wall)
-                continue;
+            const int i = fluid[ii];
 
             p[i].vel = p[i].vel_p + p[i].acc * (0.5 * dt);
             p[i].ene = p[i].ene_p + p[i].dene * (0.5 * dt);
@@ -1007,23 +2521,24 @@ namespace sph
             if (p[i].ene < ene_min)
             {
                 p[i].ene = ene_min;
-                WRITE_LOG << "Warning: ene floored to " << ene_min << " for particle " << i << " in correct step.";
+                EventCounters::count(EventCounters::ENE_FLOOR_CORRECT);
             }
 
             p[i].sound = std::sqrt(c_sound * p[i].ene);
 
-            if (m_param->two_and_half_sim)
+            if (TwoAndHalf)
             {
                 p[i].pos[2] = 0.0;
                 p[i].vel[2] = 0.0;
             }
         }
 
-        // Density relaxation (unchanged)
-        if (m_param->density_relaxation.is_valid && m_laneEmdenRelaxation)
+        // Density relaxation (skipped once the residual has converged)
+        if (m_param->density_relaxation.is_valid && m_laneEmdenRelaxation &&
+            !m_laneEmdenRelaxation->converged())
         {
             m_laneEmdenRelaxation->add_relaxation_force(m_sim, *m_param);
-            WRITE_LOG << "Density relaxation: LaneEmden-based force (predict step).";
+            WRITE_LOG << "Density relaxation: LaneEmden-based force (correct step).";
         }
     }
 } // namespace sph
@@ -5,6 +5,14 @@
 #include "core/simulation.hpp"
 #include "tree/bhtree.hpp"
 #include "kernel/kernel_function.hpp"
+#include "kernel/kernel_dispatch.hpp"
+
+#include "utilities/scratch_buffers.hpp"
+#include "utilities/loop_scheduler.hpp"
+#include "utilities/cost_histograms.hpp"
+
+#include <cmath>
+#include <limits>
 
 #ifdef EXHAUSTIVE_SEARCH
 #include "tree/exhaustive_search.hpp"
@@ -16,6 +24,9 @@ namespace sph
     void FluidForce::initialize(std::shared_ptr<SPHParameters> param)
     {
         m_neighbor_number = param->physics.neighbor_number;
+        m_symmetrize = param->symmetrize_force;
+        m_c_force = param->cfl.force;
+        m_c_ene = param->cfl.ene;
         m_use_ac = param->ac.is_valid;
         if (m_use_ac)
         {
@@ -24,79 +35,448 @@ namespace sph
         }
     }
 
+    // Timestep candidates from the same expressions TimeStep::calculation
+    // used, kept in accum_t so the fused and standalone reductions agree
+    // bitwise (min is order-independent, so per-thread slots are enough).
+    void FluidForce::reduce_dt_candidates(const SPHParticle &p_i, omp_accum &dt_force, omp_accum &dt_ene) const
+    {
+        const accum_t acc_abs = std::abs(p_i.acc);
+        if (acc_abs > 0.0)
+        {
+            const accum_t dt = m_c_force * std::sqrt(p_i.sml / acc_abs);
+            if (dt < dt_force.get())
+            {
+                dt_force.get() = dt;
+            }
+        }
+        const accum_t ene_abs = std::abs(p_i.ene);
+        const accum_t dene_abs = std::abs(p_i.dene);
+        if (dene_abs > 0.0 && ene_abs > 1e-10)
+        {
+            const accum_t dt = m_c_ene * ene_abs / dene_abs;
+            if (dt < dt_ene.get())
+            {
+                dt_ene.get() = dt;
+            }
+        }
+    }
+
     void FluidForce::calculation(std::shared_ptr<Simulation> sim)
+    {
+        // The sweeps below re-fuse the timestep reduction; until one of them
+        // finishes, the minima on the Simulation are stale.
+        sim->set_dt_minima_valid(false);
+
+        // Offload build: the plain gather loop (no conductivity, no pair-once
+        // scatter) can run as a single device kernel over the cached index.
+        if (!m_symmetrize && !m_use_ac && sim->get_gpu_offload().fluid_force(*sim))
+        {
+            return;
+        }
+
+        // Pair-list pipeline: stream the precomputed geometry instead of
+        // re-deriving it per pair (covers the gather loop only; the pair-once
+        // scatter keeps its own ownership walk).
+        if (!m_symmetrize && sim->get_pair_list().is_valid())
+        {
+            if (m_use_ac)
+            {
+                calculation_pairs_impl<true>(sim);
+            }
+            else
+            {
+                calculation_pairs_impl<false>(sim);
+            }
+            return;
+        }
+
+        kernel_dispatch(sim->get_kernel().get(), [&](const auto &kernel)
+                        {
+            if (m_symmetrize)
+            {
+                if (m_use_ac)
+                {
+                    calculation_symmetric_impl<true>(sim, kernel);
+                }
+                else
+                {
+                    calculation_symmetric_impl<false>(sim, kernel);
+                }
+            }
+            else
+            {
+                if (m_use_ac)
+                {
+                    calculation_impl<true>(sim, kernel);
+                }
+                else
+                {
+                    calculation_impl<false>(sim, kernel);
+                }
+            } });
+    }
+
+    template <bool UseAC, class Kernel>
+    void FluidForce::calculation_impl(std::shared_ptr<Simulation> sim, const Kernel &kernel)
     {
         auto &particles = sim->get_particles();
         auto *periodic = sim->get_periodic().get();
+#ifdef EXHAUSTIVE_SEARCH
         const int num = sim->get_particle_num();
-        auto *kernel = sim->get_kernel().get();
+#endif
         auto *tree = sim->get_tree().get();
 
-#pragma omp parallel for
-        for (int i = 0; i < num; ++i)
+        // Read neighbor data from the compact SoA view instead of dragging the
+        // full SPHParticle records through cache.
+        sim->sync_particle_soa();
+        const auto &soa = sim->get_particle_soa();
+        const auto &neighbor_cache = sim->get_neighbor_cache();
+
+        // outer loop over the SPH (fluid + wall) index range: the point-mass
+        // skip moves out of the sweep entirely
+        const auto &sph = sim->sph_ids();
+        const int n_sph = static_cast<int>(sph.size());
+
+        // fused timestep reduction, consumed by TimeStep at the next step
+        const accum_t dt_identity = std::numeric_limits<accum_t>::max();
+        omp_accum dt_force_min(dt_identity);
+        omp_accum dt_ene_min(dt_identity);
+
+        LoopScheduler::Scope schedule(LoopScheduler::FLUID_FORCE);
+#pragma omp parallel for schedule(runtime)
+        for (int ii = 0; ii < n_sph; ++ii)
         {
+            const int i = sph[ii];
             auto &p_i = particles[i];
-            if (p_i.is_point_mass)
+            if (CostHistograms::enabled())
+            {
+                CostHistograms::touch_window(CostHistograms::FLUID_FORCE);
+            }
+            if (!p_i.is_active)
             {
-                continue; // Skip point masses in fluid interactions
+                continue; // block timesteps: forces stay frozen until the bin boundary
             }
 
-            std::vector<int> neighbor_list(m_neighbor_number * neighbor_list_size);
+            const int *neighbor_ptr = nullptr;
+            int n_neighbor = 0;
 
-            // neighbor search
+            // neighbor list: reuse the per-step cache when available
 #ifdef EXHAUSTIVE_SEARCH
-            int const n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+            auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+            n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+            neighbor_ptr = neighbor_list.data();
 #else
-            int const n_neighbor = tree->neighbor_search(p_i, neighbor_list, particles, true);
+            if (neighbor_cache.is_valid())
+            {
+                n_neighbor = neighbor_cache.neighbor_count(i);
+                neighbor_ptr = neighbor_cache.neighbors(i);
+            }
+            else
+            {
+                auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                n_neighbor = tree->neighbor_search_adaptive(p_i, neighbor_list, particles, true);
+                neighbor_ptr = neighbor_list.data();
+            }
 #endif
 
             // fluid force
-            const vec_t &r_i = p_i.pos;
-            const vec_t &v_i = p_i.vel;
-            const real p_per_rho2_i = p_i.pres / sqr(p_i.dens);
-            const real h_i = p_i.sml;
-            const real gradh_i = p_i.gradh;
+            const vec_t &r_i = soa.pos[i];
+            const vec_t &v_i = soa.vel[i];
+            const real p_per_rho2_i = soa.pres[i] / sqr(soa.dens[i]);
+            const real h_i = soa.sml[i];
+            const real gradh_i = soa.gradh[i];
 
-            vec_t acc(0.0);
-            real dene = 0.0;
+            // pair sums run in accum_t (double in the mixed-precision build)
+            acc_vec_t acc(0.0);
+            accum_t dene = 0.0;
 
             for (int n = 0; n < n_neighbor; ++n)
             {
-                int const j = neighbor_list[n];
-                auto &p_j = particles[j];
-                if (p_j.is_point_mass)
+                int const j = neighbor_ptr[n];
+                if (soa.is_point_mass[j])
                 {
                     continue; // Skip point masses in fluid interactions
                 }
 
-                const vec_t r_ij = periodic->calc_r_ij(r_i, p_j.pos);
-                const real r = std::abs(r_ij);
+                PairGeometry geom;
+                geom.r_ij = periodic->calc_r_ij(r_i, soa.pos[j]);
+                geom.r = std::abs(geom.r_ij);
 
-                if (r >= std::max(h_i, p_j.sml) || r == 0.0)
+                if (geom.r >= std::max(h_i, soa.sml[j]) || geom.r == 0.0)
                 {
                     continue;
                 }
+                geom.r_inv = 1.0 / geom.r;
+                geom.v_ij = v_i - soa.vel[j];
+                geom.vr = inner_product(geom.v_ij, geom.r_ij);
 
-                const vec_t dw_i = kernel->dw(r_ij, r, h_i);
-                const vec_t dw_j = kernel->dw(r_ij, r, p_j.sml);
+                const vec_t dw_i = kernel.dw(geom.r_ij, geom.r, h_i);
+                const vec_t dw_j = kernel.dw(geom.r_ij, geom.r, soa.sml[j]);
                 const vec_t dw_ij = (dw_i + dw_j) * 0.5;
-                const vec_t v_ij = v_i - p_j.vel;
+                const vec_t &v_ij = geom.v_ij;
 
-                const real pi_ij = artificial_viscosity(p_i, p_j, r_ij);
-                const real dene_ac = m_use_ac ? artificial_conductivity(p_i, p_j, r_ij, dw_ij) : 0.0;
+                const real pi_ij = artificial_viscosity(soa, i, j, geom);
+                const real dene_ac = UseAC ? artificial_conductivity(soa, i, j, geom, dw_ij) : 0.0;
 
-#if 0
-            acc -= dw_ij * (p_j.mass * (p_per_rho2_i + p_j.pres / sqr(p_j.dens) + pi_ij));
-            dene += p_j.mass * (p_per_rho2_i + 0.5 * pi_ij) * inner_product(v_ij, dw_ij);
-#else
-                acc -= dw_i * (p_j.mass * (p_per_rho2_i * gradh_i + 0.5 * pi_ij)) + dw_j * (p_j.mass * (p_j.pres / sqr(p_j.dens) * p_j.gradh + 0.5 * pi_ij));
-                dene += p_j.mass * p_per_rho2_i * gradh_i * inner_product(v_ij, dw_i) + 0.5 * p_j.mass * pi_ij * inner_product(v_ij, dw_ij) + dene_ac;
-#endif
+                acc -= dw_i * (soa.mass[j] * (p_per_rho2_i * gradh_i + 0.5 * pi_ij)) + dw_j * (soa.mass[j] * (soa.pres[j] / sqr(soa.dens[j]) * soa.gradh[j] + 0.5 * pi_ij));
+                dene += soa.mass[j] * p_per_rho2_i * gradh_i * inner_product(v_ij, dw_i) + 0.5 * soa.mass[j] * pi_ij * inner_product(v_ij, dw_ij) + dene_ac;
             }
 
             p_i.acc = acc;
             p_i.dene = dene;
+            reduce_dt_candidates(p_i, dt_force_min, dt_ene_min);
         }
+
+        sim->set_dt_force_min(dt_force_min.min());
+        sim->set_dt_ene_min(dt_ene_min.min());
+        // point masses sit outside this sweep: with none present the fused
+        // minima cover every particle TimeStep used to visit
+        sim->set_dt_minima_valid(sim->point_mass_ids().empty());
+    }
+
+    // Gather loop over the PairList stream: identical physics to
+    // calculation_impl, but the separation, distance and kernel gradients
+    // come precomputed from the per-step pair-geometry stage. The stored
+    // distance keeps the usual interaction cut exact (out-of-range entries
+    // carry zeroed gradients).
+    template <bool UseAC>
+    void FluidForce::calculation_pairs_impl(std::shared_ptr<Simulation> sim)
+    {
+        auto &particles = sim->get_particles();
+
+        sim->sync_particle_soa();
+        const auto &soa = sim->get_particle_soa();
+        const auto &neighbor_cache = sim->get_neighbor_cache();
+        const auto &pairs = sim->get_pair_list();
+
+        const auto &sph = sim->sph_ids();
+        const int n_sph = static_cast<int>(sph.size());
+
+        // fused timestep reduction, consumed by TimeStep at the next step
+        const accum_t dt_identity = std::numeric_limits<accum_t>::max();
+        omp_accum dt_force_min(dt_identity);
+        omp_accum dt_ene_min(dt_identity);
+
+        LoopScheduler::Scope schedule(LoopScheduler::FLUID_FORCE);
+#pragma omp parallel for schedule(runtime)
+        for (int ii = 0; ii < n_sph; ++ii)
+        {
+            const int i = sph[ii];
+            auto &p_i = particles[i];
+            if (CostHistograms::enabled())
+            {
+                CostHistograms::touch_window(CostHistograms::FLUID_FORCE);
+            }
+            if (!p_i.is_active)
+            {
+                continue; // block timesteps: forces stay frozen until the bin boundary
+            }
+
+            const int *neighbor_ptr = neighbor_cache.neighbors(i);
+            const int n_neighbor = neighbor_cache.neighbor_count(i);
+            const int base = neighbor_cache.first(i);
+
+            const vec_t &v_i = soa.vel[i];
+            const real p_per_rho2_i = soa.pres[i] / sqr(soa.dens[i]);
+            const real h_i = soa.sml[i];
+            const real gradh_i = soa.gradh[i];
+
+            acc_vec_t acc(0.0);
+            accum_t dene = 0.0;
+
+            for (int n = 0; n < n_neighbor; ++n)
+            {
+                int const j = neighbor_ptr[n];
+                if (soa.is_point_mass[j])
+                {
+                    continue; // Skip point masses in fluid interactions
+                }
+
+                const int e = base + n;
+                const real r = pairs.r(e);
+
+                if (r >= std::max(h_i, soa.sml[j]) || r == 0.0)
+                {
+                    continue;
+                }
+
+                PairGeometry geom;
+                geom.r_ij = pairs.r_ij(e);
+                geom.r = r;
+                geom.r_inv = 1.0 / r;
+                geom.v_ij = v_i - soa.vel[j];
+                geom.vr = inner_product(geom.v_ij, geom.r_ij);
+
+                const vec_t &dw_i = pairs.dw_i(e);
+                const vec_t &dw_j = pairs.dw_j(e);
+                const vec_t dw_ij = (dw_i + dw_j) * 0.5;
+                const vec_t &v_ij = geom.v_ij;
+
+                const real pi_ij = artificial_viscosity(soa, i, j, geom);
+                const real dene_ac = UseAC ? artificial_conductivity(soa, i, j, geom, dw_ij) : 0.0;
+
+                acc -= dw_i * (soa.mass[j] * (p_per_rho2_i * gradh_i + 0.5 * pi_ij)) + dw_j * (soa.mass[j] * (soa.pres[j] / sqr(soa.dens[j]) * soa.gradh[j] + 0.5 * pi_ij));
+                dene += soa.mass[j] * p_per_rho2_i * gradh_i * inner_product(v_ij, dw_i) + 0.5 * soa.mass[j] * pi_ij * inner_product(v_ij, dw_ij) + dene_ac;
+            }
+
+            p_i.acc = acc;
+            p_i.dene = dene;
+            reduce_dt_candidates(p_i, dt_force_min, dt_ene_min);
+        }
+
+        sim->set_dt_force_min(dt_force_min.min());
+        sim->set_dt_ene_min(dt_ene_min.min());
+        sim->set_dt_minima_valid(sim->point_mass_ids().empty());
+    }
+
+    // Pair-once variant: each i-j pair is evaluated by exactly one of its two
+    // particles and the reaction is scattered to the other through the
+    // per-thread PairAccumulator rows, halving the kernel/viscosity work.
+    // Relies on the is_ij searches returning symmetric candidate lists.
+    template <bool UseAC, class Kernel>
+    void FluidForce::calculation_symmetric_impl(std::shared_ptr<Simulation> sim, const Kernel &kernel)
+    {
+        auto &particles = sim->get_particles();
+        auto *periodic = sim->get_periodic().get();
+        const int num = sim->get_particle_num();
+        auto *tree = sim->get_tree().get();
+
+        sim->sync_particle_soa();
+        const auto &soa = sim->get_particle_soa();
+        const auto &neighbor_cache = sim->get_neighbor_cache();
+
+        m_pair_accum.reset(num);
+
+        const auto &sph = sim->sph_ids();
+        const int n_sph = static_cast<int>(sph.size());
+
+        LoopScheduler::Scope schedule(LoopScheduler::FLUID_FORCE);
+#pragma omp parallel
+        {
+            vec_t *acc_buf = m_pair_accum.acc();
+            real *dene_buf = m_pair_accum.dene();
+
+#pragma omp for schedule(runtime)
+            for (int ii = 0; ii < n_sph; ++ii)
+            {
+                const int i = sph[ii];
+                auto &p_i = particles[i];
+                if (CostHistograms::enabled())
+                {
+                    CostHistograms::touch_window(CostHistograms::FLUID_FORCE);
+                }
+                if (!p_i.is_active)
+                {
+                    continue; // block timesteps: forces stay frozen until the bin boundary
+                }
+
+                const int *neighbor_ptr = nullptr;
+                int n_neighbor = 0;
+
+                // neighbor list: reuse the per-step cache when available
+#ifdef EXHAUSTIVE_SEARCH
+                auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, m_neighbor_number * neighbor_list_size, periodic, true);
+                neighbor_ptr = neighbor_list.data();
+#else
+                if (neighbor_cache.is_valid())
+                {
+                    n_neighbor = neighbor_cache.neighbor_count(i);
+                    neighbor_ptr = neighbor_cache.neighbors(i);
+                }
+                else
+                {
+                    auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                    n_neighbor = tree->neighbor_search_adaptive(p_i, neighbor_list, particles, true);
+                    neighbor_ptr = neighbor_list.data();
+                }
+#endif
+
+                const vec_t &r_i = soa.pos[i];
+                const vec_t &v_i = soa.vel[i];
+                const real p_per_rho2_i = soa.pres[i] / sqr(soa.dens[i]);
+                const real h_i = soa.sml[i];
+                const real gradh_i = soa.gradh[i];
+
+                for (int n = 0; n < n_neighbor; ++n)
+                {
+                    int const j = neighbor_ptr[n];
+                    if (soa.is_point_mass[j])
+                    {
+                        continue; // Skip point masses in fluid interactions
+                    }
+
+                    // each pair is visited once: an active j with j < i owns it;
+                    // pairs with an inactive j are always ours since j never loops
+                    if (j < i && soa.is_active[j])
+                    {
+                        continue;
+                    }
+
+                    PairGeometry geom;
+                    geom.r_ij = periodic->calc_r_ij(r_i, soa.pos[j]);
+                    geom.r = std::abs(geom.r_ij);
+
+                    if (geom.r >= std::max(h_i, soa.sml[j]) || geom.r == 0.0)
+                    {
+                        continue;
+                    }
+                    geom.r_inv = 1.0 / geom.r;
+                    geom.v_ij = v_i - soa.vel[j];
+                    geom.vr = inner_product(geom.v_ij, geom.r_ij);
+
+                    const vec_t dw_i = kernel.dw(geom.r_ij, geom.r, h_i);
+                    const vec_t dw_j = kernel.dw(geom.r_ij, geom.r, soa.sml[j]);
+                    const vec_t dw_ij = (dw_i + dw_j) * 0.5;
+                    const vec_t &v_ij = geom.v_ij;
+
+                    const real pi_ij = artificial_viscosity(soa, i, j, geom);
+                    const real dene_ac = UseAC ? artificial_conductivity(soa, i, j, geom, dw_ij) : 0.0;
+
+                    const real p_per_rho2_j = soa.pres[j] / sqr(soa.dens[j]);
+                    const vec_t grad = dw_i * (p_per_rho2_i * gradh_i + 0.5 * pi_ij) + dw_j * (p_per_rho2_j * soa.gradh[j] + 0.5 * pi_ij);
+
+                    acc_buf[i] -= grad * soa.mass[j];
+                    dene_buf[i] += soa.mass[j] * p_per_rho2_i * gradh_i * inner_product(v_ij, dw_i) + 0.5 * soa.mass[j] * pi_ij * inner_product(v_ij, dw_ij) + dene_ac;
+
+                    if (soa.is_active[j])
+                    {
+                        // mirror terms: dw and v_ij flip sign together under i<->j,
+                        // so every inner product keeps its sign; the conductivity
+                        // term changes sign and carries j's neighbor mass m_i
+                        acc_buf[j] += grad * soa.mass[i];
+                        dene_buf[j] += soa.mass[i] * p_per_rho2_j * soa.gradh[j] * inner_product(v_ij, dw_j) + 0.5 * soa.mass[i] * pi_ij * inner_product(v_ij, dw_ij) - dene_ac * soa.mass[i] / soa.mass[j];
+                    }
+                }
+            }
+        }
+
+        m_pair_accum.reduce();
+        const vec_t *acc_total = m_pair_accum.acc_total();
+        const real *dene_total = m_pair_accum.dene_total();
+
+        // fused timestep reduction, consumed by TimeStep at the next step
+        const accum_t dt_identity = std::numeric_limits<accum_t>::max();
+        omp_accum dt_force_min(dt_identity);
+        omp_accum dt_ene_min(dt_identity);
+
+#pragma omp parallel for
+        for (int ii = 0; ii < n_sph; ++ii)
+        {
+            const int i = sph[ii];
+            auto &p_i = particles[i];
+            if (!p_i.is_active)
+            {
+                continue;
+            }
+            p_i.acc = acc_total[i];
+            p_i.dene = dene_total[i];
+            reduce_dt_candidates(p_i, dt_force_min, dt_ene_min);
+        }
+
+        sim->set_dt_force_min(dt_force_min.min());
+        sim->set_dt_ene_min(dt_ene_min.min());
+        sim->set_dt_minima_valid(sim->point_mass_ids().empty());
     }
 
     // Monaghan (1997)
@@ -130,4 +510,65 @@ namespace sph
         return m_alpha_ac * p_j.mass * v_sig * (p_i.ene - p_j.ene) * inner_product(dw_ij, r_ij) / std::abs(r_ij);
     }
 
+    // Monaghan (1997), reading from the SoA view
+    real FluidForce::artificial_viscosity(const ParticleSoA &soa, const int i, const int j, const vec_t &r_ij)
+    {
+        const auto v_ij = soa.vel[i] - soa.vel[j];
+        const real vr = inner_product(v_ij, r_ij);
+
+        if (vr < 0)
+        {
+            const real alpha = 0.5 * (soa.alpha[i] + soa.alpha[j]);
+            const real balsara = 0.5 * (soa.balsara[i] + soa.balsara[j]);
+            const real w_ij = vr / std::abs(r_ij);
+            const real v_sig = soa.sound[i] + soa.sound[j] - 3.0 * w_ij;
+            const real rho_ij_inv = 2.0 / (soa.dens[i] + soa.dens[j]);
+
+            const real pi_ij = -0.5 * balsara * alpha * v_sig * w_ij * rho_ij_inv;
+            return pi_ij;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    // Wadsley et al. (2008) or Price (2008), reading from the SoA view
+    real FluidForce::artificial_conductivity(const ParticleSoA &soa, const int i, const int j, const vec_t &r_ij, const vec_t &dw_ij)
+    {
+        const real v_sig = m_use_gravity ? std::abs(inner_product(soa.vel[i] - soa.vel[j], r_ij) / std::abs(r_ij)) : std::sqrt(2.0 * std::abs(soa.pres[i] - soa.pres[j]) / (soa.dens[i] + soa.dens[j]));
+
+        return m_alpha_ac * soa.mass[j] * v_sig * (soa.ene[i] - soa.ene[j]) * inner_product(dw_ij, r_ij) / std::abs(r_ij);
+    }
+
+    // Monaghan (1997) over the cached pair geometry: the separation, its
+    // inverse length and v_ij . r_ij come from the loop body, so the term
+    // adds no sqrt of its own
+    real FluidForce::artificial_viscosity(const ParticleSoA &soa, const int i, const int j, const PairGeometry &geom)
+    {
+        if (geom.vr < 0)
+        {
+            const real alpha = 0.5 * (soa.alpha[i] + soa.alpha[j]);
+            const real balsara = 0.5 * (soa.balsara[i] + soa.balsara[j]);
+            const real w_ij = geom.vr * geom.r_inv;
+            const real v_sig = soa.sound[i] + soa.sound[j] - 3.0 * w_ij;
+            const real rho_ij_inv = 2.0 / (soa.dens[i] + soa.dens[j]);
+
+            const real pi_ij = -0.5 * balsara * alpha * v_sig * w_ij * rho_ij_inv;
+            return pi_ij;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    // Wadsley et al. (2008) or Price (2008) over the cached pair geometry
+    real FluidForce::artificial_conductivity(const ParticleSoA &soa, const int i, const int j, const PairGeometry &geom, const vec_t &dw_ij)
+    {
+        const real v_sig = m_use_gravity ? std::abs(geom.vr * geom.r_inv) : std::sqrt(2.0 * std::abs(soa.pres[i] - soa.pres[j]) / (soa.dens[i] + soa.dens[j]));
+
+        return m_alpha_ac * soa.mass[j] * v_sig * (soa.ene[i] - soa.ene[j]) * inner_product(dw_ij, geom.r_ij) * geom.r_inv;
+    }
+
 }
\ No newline at end of file
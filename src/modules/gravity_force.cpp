@@ -1,87 +1,212 @@
 #include "utilities/defines.hpp"
 #include "modules/gravity_force.hpp"
 #include "core/particle.hpp"
+#include "utilities/gravity_softening.hpp"
 #include "utilities/periodic.hpp"
 #include "core/simulation.hpp"
 #include "tree/bhtree.hpp"
+#include "utilities/loop_scheduler.hpp"
 
 namespace sph
 {
 
-    // Softening functions (assuming these are already defined in your code)
-    inline real f(const real r, const real h)
+    void GravityForce::initialize(std::shared_ptr<SPHParameters> param)
     {
-        const real e = h * 0.5;
-        const real u = r / e;
-        if (u < 1.0)
+        m_is_valid = param->gravity.is_valid;
+        if (m_is_valid)
         {
-            return (-0.5 * u * u * (1.0 / 3.0 - 3.0 / 20 * u * u + u * u * u / 20) + 1.4) / e;
+            m_constant = param->gravity.constant;
+            m_dual_tree = param->gravity.dual_tree;
+            m_interval = param->gravity.interval;
+            m_extrapolate = param->gravity.extrapolate;
         }
-        else if (u < 2.0)
+        m_steps_since_full = 0;
+        m_slope_steps = 1;
+        m_last_valid = false;
+        m_prev_valid = false;
+        m_external.initialize(param);
+    }
+
+    void GravityForce::calculation(std::shared_ptr<Simulation> sim)
+    {
+
+        if (!m_is_valid && !m_external.enabled())
         {
-            return -1.0 / (15 * r) + (-u * u * (4.0 / 3.0 - u + 0.3 * u * u - u * u * u / 30) + 1.6) / e;
+            return;
         }
-        else
+        WRITE_LOG << "Calculating gravity...";
+
+        // acc changes below, so the timestep minima fused into the fluid
+        // force sweep no longer match it; TimeStep falls back to its own pass
+        sim->set_dt_minima_valid(false);
+
+        if (m_is_valid)
+        {
+            if (full_solve_due(sim->get_particle_num()))
+            {
+                apply_self_gravity(sim); // Compute self-gravity with BHTree
+                capture_full_solve(sim);
+            }
+            else
+            {
+                // Multi-rate mode: the field evolves on orbital timescales,
+                // so reuse the saved solve instead of walking the tree.
+                apply_held_gravity(sim);
+            }
+            apply_external_gravity(sim); // Add external gravity from point masses
+        }
+        if (m_external.enabled())
         {
-            return 1 / r;
+            // Analytic background field: no tree walk, one sweep
+            m_external.apply(sim, m_is_valid);
         }
     }
 
-    inline real g(const real r, const real h)
+    void GravityForce::apply_self_gravity(std::shared_ptr<Simulation> sim)
     {
-        const real e = h * 0.5;
-        const real u = r / e;
-        if (u < 1.0)
+        auto &particles = sim->get_particles();
+        const int num = sim->get_particle_num();
+        auto *tree = sim->get_tree().get();
+
+        if (m_dual_tree && tree->tree_force_group())
         {
-            return (4.0 / 3.0 - 1.2 * u * u + 0.5 * u * u * u) / (e * e * e);
+            // Group walk handled the full loop (including acc/phi reset).
+            return;
         }
-        else if (u < 2.0)
+
+        // Parallel computation of self-gravity using the Barnes-Hut tree;
+        // the tree-walk depth varies per particle, so the schedule matters.
+        LoopScheduler::Scope schedule(LoopScheduler::GRAVITY_FORCE);
+#pragma omp parallel for schedule(runtime)
+        for (int i = 0; i < num; ++i)
         {
-            return (-1.0 / 15 + 8.0 / 3 * u * u * u - 3 * u * u * u * u + 1.2 * u * u * u * u * u - u * u * u * u * u * u / 6.0) / (r * r * r);
+            auto &p_i = particles[i];
+            if (!p_i.is_active)
+            {
+                continue; // block timesteps: keep the frozen acceleration
+            }
+            // Reset acceleration and potential for self-gravity
+            p_i.acc = vec_t(0.0);
+            p_i.phi = 0.0;
+            tree->tree_force(p_i); // Compute self-gravity force using BHTree
         }
-        else
+    }
+
+    void GravityForce::stage_self_gravity(std::shared_ptr<Simulation> sim)
+    {
+        const auto &particles = sim->get_particles();
+        const int num = sim->get_particle_num();
+        auto *tree = sim->get_tree().get();
+
+        m_staged_acc.resize(num);
+        m_staged_phi.resize(num);
+
+        // Same walk as apply_self_gravity, but against a local stand-in
+        // particle so nothing in the shared array is read or written while
+        // the fluid force is updating acc/dene on the other team.
+        LoopScheduler::Scope schedule(LoopScheduler::GRAVITY_FORCE);
+#pragma omp parallel for schedule(runtime)
+        for (int i = 0; i < num; ++i)
         {
-            return 1 / (r * r * r);
+            const auto &p_i = particles[i];
+            if (!p_i.is_active)
+            {
+                continue; // block timesteps: keep the frozen acceleration
+            }
+            SPHParticle walker;
+            walker.pos = p_i.pos;
+            walker.sml = p_i.sml;
+            walker.id = p_i.id;
+            walker.acc = vec_t(0.0);
+            walker.phi = 0.0;
+            tree->tree_force(walker);
+            m_staged_acc[i] = walker.acc;
+            m_staged_phi[i] = walker.phi;
         }
     }
 
-    void GravityForce::initialize(std::shared_ptr<SPHParameters> param)
+    void GravityForce::commit_staged(std::shared_ptr<Simulation> sim)
     {
-        m_is_valid = param->gravity.is_valid;
-        if (m_is_valid)
+        WRITE_LOG << "Calculating gravity...";
+        sim->set_dt_minima_valid(false);
+
+        auto &particles = sim->get_particles();
+        const int num = sim->get_particle_num();
+
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
         {
-            m_constant = param->gravity.constant;
+            auto &p_i = particles[i];
+            if (!p_i.is_active)
+            {
+                continue;
+            }
+            p_i.acc = m_staged_acc[i];
+            p_i.phi = m_staged_phi[i];
+        }
+
+        capture_full_solve(sim);
+        apply_external_gravity(sim);
+        if (m_external.enabled())
+        {
+            m_external.apply(sim, m_is_valid);
         }
     }
 
-    void GravityForce::calculation(std::shared_ptr<Simulation> sim)
+    // Save the self-gravity field of a completed full solve: acc/phi hold
+    // only the tree-walk contribution at this point (the walk reset them and
+    // the external terms are added afterwards). The previous solve is kept
+    // so the held steps can extrapolate along the per-step slope.
+    void GravityForce::capture_full_solve(std::shared_ptr<Simulation> sim)
     {
-
-        if (!m_is_valid)
+        if (m_interval <= 1)
         {
             return;
         }
-        WRITE_LOG << "Calculating gravity...";
+        const auto &particles = sim->get_particles();
+        const int num = sim->get_particle_num();
 
-        apply_self_gravity(sim);     // Compute self-gravity with BHTree
-        apply_external_gravity(sim); // Add external gravity from point masses
+        m_slope_steps = m_steps_since_full + 1;
+        m_prev_valid = m_last_valid && static_cast<int>(m_last_acc.size()) == num;
+        m_prev_acc.swap(m_last_acc);
+        m_last_acc.resize(num);
+        m_last_phi.resize(num);
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+        {
+            m_last_acc[i] = particles[i].acc;
+            m_last_phi[i] = particles[i].phi;
+        }
+        m_last_valid = true;
+        m_steps_since_full = 0;
     }
 
-    void GravityForce::apply_self_gravity(std::shared_ptr<Simulation> sim)
+    void GravityForce::apply_held_gravity(std::shared_ptr<Simulation> sim)
     {
         auto &particles = sim->get_particles();
         const int num = sim->get_particle_num();
-        auto *tree = sim->get_tree().get();
 
-// Parallel computation of self-gravity using the Barnes-Hut tree
+        ++m_steps_since_full;
+        const bool extrapolate = m_extrapolate && m_prev_valid;
+        const real fraction = extrapolate
+                                  ? static_cast<real>(m_steps_since_full) / static_cast<real>(m_slope_steps)
+                                  : 0.0;
+
 #pragma omp parallel for
         for (int i = 0; i < num; ++i)
         {
             auto &p_i = particles[i];
-            // Reset acceleration and potential for self-gravity
-            p_i.acc = vec_t(0.0);
-            p_i.phi = 0.0;
-            tree->tree_force(p_i); // Compute self-gravity force using BHTree
+            if (!p_i.is_active)
+            {
+                continue; // block timesteps: keep the frozen acceleration
+            }
+            vec_t g = m_last_acc[i];
+            if (extrapolate)
+            {
+                g += (m_last_acc[i] - m_prev_acc[i]) * fraction;
+            }
+            p_i.acc = g;
+            p_i.phi = m_last_phi[i];
         }
     }
 
@@ -98,6 +223,8 @@ namespace sph
             auto &p_i = particles[i];
             if (p_i.is_point_mass)
                 continue; // Point masses don’t feel external gravity
+            if (!p_i.is_active)
+                continue; // block timesteps: keep the frozen acceleration
 
             vec_t force(0.0);
             const vec_t &r_i = p_i.pos;
@@ -114,7 +241,7 @@ namespace sph
                     continue; // Avoid division by zero
 
                 // Add gravitational force from point mass p_j to p_i
-                force -= r_ij * (m_constant * p_j.mass * (g(r, p_i.sml) + g(r, p_j.sml)) * 0.5);
+                force -= r_ij * (m_constant * p_j.mass * (grav_g(r, p_i.sml) + grav_g(r, p_j.sml)) * 0.5);
                 // WRITE_LOG << "Calculating force..." << force[0];
             }
 
@@ -2,6 +2,10 @@
 #include "core/parameters.hpp"
 #include "core/simulation.hpp"
 #include "core/particle.hpp"
+#include "utilities/event_counters.hpp"
+
+#include <algorithm>
+#include <cmath>
 
 namespace sph
 {
@@ -11,6 +15,49 @@ namespace sph
         m_is_valid = param->heating_cooling.is_valid;
         m_heating_rate = param->heating_cooling.heating_rate;
         m_cooling_rate = param->heating_cooling.cooling_rate;
+        m_subcycle = param->heating_cooling.subcycle;
+        m_subcycle_tol = param->heating_cooling.subcycle_tol;
+        m_max_subcycles = param->heating_cooling.max_subcycles;
+    }
+
+    real HeatingCoolingModule::integrate_subcycled(real u, const real dt) const
+    {
+        // The source term is integrated with its own inner steps, decoupled
+        // from the CFL dt: each backward-Euler sub-step is capped so the
+        // relative energy change stays below the tolerance. With the current
+        // linear rate law the implicit update is closed-form; the driver is
+        // what keeps the scheme stable when the cooling time is much shorter
+        // than the hydro step.
+        const real ene_min = 1e-10; // same floor as predict()/correct()
+        const real rate = m_heating_rate - m_cooling_rate;
+        real remaining = dt;
+        for (int cycle = 0; cycle < m_max_subcycles && remaining > 0.0; ++cycle)
+        {
+            real dt_sub = remaining;
+            const real rate_abs = std::abs(rate);
+            if (rate_abs > 0.0)
+            {
+                const real dt_tol = m_subcycle_tol * std::max(u, ene_min) / rate_abs;
+                dt_sub = std::min(dt_sub, dt_tol);
+            }
+            u += dt_sub * rate;
+            if (u < ene_min)
+            {
+                // Cooling exhausted the thermal reservoir inside the step;
+                // floor and stop rather than going negative.
+                u = ene_min;
+                EventCounters::count(EventCounters::ENE_FLOOR_COOLING);
+                return u;
+            }
+            remaining -= dt_sub;
+        }
+        if (remaining > 0.0)
+        {
+            // Sub-cycle cap hit: apply the rest in one (still closed-form)
+            // implicit step instead of silently dropping source time.
+            u = std::max(u + remaining * rate, ene_min);
+        }
+        return u;
     }
 
     void HeatingCoolingModule::calculation(std::shared_ptr<Simulation> sim)
@@ -18,10 +65,23 @@ namespace sph
         if (!m_is_valid)
             return;
 
+        // ene changes below, so the fused timestep minima are stale
+        sim->set_dt_minima_valid(false);
+
         auto &particles = sim->get_particles();
         const int num = sim->get_particle_num();
         const real dt = sim->get_dt();
 
+        if (m_subcycle)
+        {
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i)
+            {
+                particles[i].ene = integrate_subcycled(particles[i].ene, dt);
+            }
+            return;
+        }
+
 #pragma omp parallel for
         for (int i = 0; i < num; ++i)
         {
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <limits>
 #include "modules/pre_interaction.hpp"
 #include "core/simulation.hpp"
 #include "core/parameters.hpp"
@@ -7,14 +8,18 @@
 #include "utilities/openmp.hpp"
 #include "kernel/kernel_function.hpp"
 #include "utilities/exception.hpp"
+#include "utilities/event_counters.hpp"
+#include "utilities/cost_histograms.hpp"
 #include "tree/bhtree.hpp"
+#include "utilities/scratch_buffers.hpp"
+#include "utilities/loop_scheduler.hpp"
 
 namespace sph
 {
     real PreInteraction::newton_raphson(
         const SPHParticle &p_i,
         const std::vector<SPHParticle> &particles,
-        const std::vector<int> &neighbor_list,
+        const int *neighbor_list,
         const int n_neighbor,
         const Periodic *periodic,
         const KernelFunction *kernel)
@@ -31,26 +36,61 @@ namespace sph
         constexpr real epsilon = 1e-4;
         constexpr int max_iter = 10;
         const auto &r_i = p_i.pos;
+
+        // Gather distances and masses once: r_ij does not change while h is
+        // iterated, so each iteration only touches the in-support prefix of
+        // these contiguous arrays and can evaluate the kernel in batches.
+        auto &r_buf = scratch_real_buffer(0, n_neighbor);
+        auto &mass_buf = scratch_real_buffer(1, n_neighbor);
+        for (int n = 0; n < n_neighbor; ++n)
+        {
+            const auto &p_j = particles[neighbor_list[n]];
+            r_buf[n] = std::abs(periodic->calc_r_ij(r_i, p_j.pos));
+            mass_buf[n] = p_j.mass;
+        }
+
+        // The prefix search below needs r_buf partitioned by the current
+        // distances. A fresh neighbor search delivers the list sorted, but
+        // on Verlet reuse steps the row is ordered by the distances of the
+        // step that built it, and predict() has moved the particles since.
+        // Insertion sort restores the order in O(n + inversions): a plain
+        // scan on sorted input, near-linear on the slightly stale rows.
+        for (int n = 1; n < n_neighbor; ++n)
+        {
+            const real r_n = r_buf[n];
+            const real m_n = mass_buf[n];
+            int k = n - 1;
+            while (k >= 0 && r_buf[k] > r_n)
+            {
+                r_buf[k + 1] = r_buf[k];
+                mass_buf[k + 1] = mass_buf[k];
+                --k;
+            }
+            r_buf[k + 1] = r_n;
+            mass_buf[k + 1] = m_n;
+        }
+        auto &w_buf = scratch_real_buffer(2, n_neighbor);
+        auto &dhw_buf = scratch_real_buffer(3, n_neighbor);
+
         for (int i = 0; i < max_iter; ++i)
         {
             const real h_b = h_i;
 
+            // The distances are sorted, so the in-support prefix ends at the
+            // first entry >= h.
+            const int n_in = static_cast<int>(
+                std::lower_bound(r_buf.data(), r_buf.data() + n_neighbor, h_i) - r_buf.data());
+
+            kernel->w_batch(r_buf.data(), h_i, w_buf.data(), n_in);
+            kernel->dhw_batch(r_buf.data(), h_i, dhw_buf.data(), n_in);
+
             real dens = 0.0;
             real ddens = 0.0;
-            for (int n = 0; n < n_neighbor; ++n)
+#pragma omp simd reduction(+ : dens, ddens)
+            for (int n = 0; n < n_in; ++n)
             {
-                int const j = neighbor_list[n];
-                auto &p_j = particles[j];
-                const vec_t r_ij = periodic->calc_r_ij(r_i, p_j.pos);
-                const real r = std::abs(r_ij);
-
-                if (r >= h_i)
-                {
-                    break;
-                }
-
-                dens += p_j.mass * kernel->w(r, h_i);
-                ddens += p_j.mass * kernel->dhw(r, h_i);
+                dens += mass_buf[n] * w_buf[n];
+                ddens += mass_buf[n] * dhw_buf[n];
             }
 
             const real f = dens * powh_dim(h_i, kd) - b;
@@ -60,13 +100,18 @@ namespace sph
 
             if (std::abs(h_i - h_b) < (h_i + h_b) * epsilon)
             {
+                if (CostHistograms::enabled())
+                {
+                    CostHistograms::record_nr(i + 1);
+                }
                 return h_i;
             }
         }
 
-#pragma omp critical
+        EventCounters::count(EventCounters::NR_NO_CONVERGENCE);
+        if (CostHistograms::enabled())
         {
-            WRITE_LOG << "Particle id " << p_i.id << " is not convergence";
+            CostHistograms::record_nr(max_iter);
         }
 
         return p_i.sml / m_kernel_ratio;
@@ -88,6 +133,8 @@ namespace sph
         m_gamma = param->physics.gamma;
         m_neighbor_number = param->physics.neighbor_number;
         m_iteration = param->iterative_sml;
+        m_warm_start = param->warm_start_sml;
+        m_warm_primed = false;
         if (m_iteration)
         {
             m_kernel_ratio = 1.2;
@@ -112,14 +159,14 @@ namespace sph
         for (int i = 0; i < num; ++i)
         {
             auto &p_i = particles[i];
-            std::vector<int> neighbor_list(neighbor_number * neighbor_list_size);
+            auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, neighbor_number));
             int effectiveDim = twoAndHalf ? 2 : DIM;
             real A_eff = (effectiveDim == 1 ? 2.0 : (effectiveDim == 2 ? M_PI : 4.0 * M_PI / 3.0));
             p_i.sml = std::pow(neighbor_number * p_i.mass / (p_i.dens * A_eff), 1.0 / effectiveDim) * kernel_ratio;
 #ifdef EXHAUSTIVE_SEARCH
             int n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num, neighbor_list, neighbor_number * neighbor_list_size, periodic, false);
 #else
-            int n_neighbor = tree->neighbor_search(p_i, neighbor_list, particles, false);
+            int n_neighbor = tree->neighbor_search_adaptive(p_i, neighbor_list, particles, false);
 #endif
 
             real dens_i = 0.0;
@@ -152,202 +199,354 @@ namespace sph
             m_first = false;
         }
 
+        // Offload build: the plain fixed-h sweep (no Newton-Raphson, no AV
+        // switches) can run as a single device kernel over the cached index.
+        if (!m_iteration && !m_use_balsara_switch && !m_use_time_dependent_av && !m_warm_start)
+        {
+            if (sim->get_gpu_offload().density(*sim))
+            {
+#ifndef EXHAUSTIVE_SEARCH
+                sim->get_tree()->set_kernel();
+#endif
+                return;
+            }
+        }
+
+        // All feature flags are fixed for the run; pick the matching
+        // instantiation once so the neighbor sweep has no dead branches.
+        m_twoAndHalf ? calculation_dispatch<true>(sim)
+                     : calculation_dispatch<false>(sim);
+
+        // every particle now carries a fresh h_dot, predictions are valid
+        if (m_warm_start)
+        {
+            m_warm_primed = true;
+        }
+    }
+
+    template <bool TwoAndHalf>
+    void PreInteraction::calculation_dispatch(std::shared_ptr<Simulation> sim)
+    {
+        if (m_use_balsara_switch)
+        {
+            if (m_use_time_dependent_av)
+            {
+                m_warm_start ? calculation_impl<TwoAndHalf, true, true, true>(sim)
+                             : calculation_impl<TwoAndHalf, true, true, false>(sim);
+            }
+            else
+            {
+                m_warm_start ? calculation_impl<TwoAndHalf, true, false, true>(sim)
+                             : calculation_impl<TwoAndHalf, true, false, false>(sim);
+            }
+        }
+        else
+        {
+            if (m_use_time_dependent_av)
+            {
+                m_warm_start ? calculation_impl<TwoAndHalf, false, true, true>(sim)
+                             : calculation_impl<TwoAndHalf, false, true, false>(sim);
+            }
+            else
+            {
+                m_warm_start ? calculation_impl<TwoAndHalf, false, false, true>(sim)
+                             : calculation_impl<TwoAndHalf, false, false, false>(sim);
+            }
+        }
+    }
+
+    template <bool TwoAndHalf, bool UseBalsara, bool UseTimeDependentAV, bool WarmStart>
+    void PreInteraction::calculation_impl(std::shared_ptr<Simulation> sim)
+    {
         auto &particles = sim->get_particles();
-        int num = sim->get_particle_num();
+#ifdef EXHAUSTIVE_SEARCH
+        const int num = sim->get_particle_num();
+#endif
         auto *periodic = sim->get_periodic().get();
         auto *kernel = sim->get_kernel().get();
         auto *tree = sim->get_tree().get();
 
+        // Neighbor reads below go through the compact SoA view
+        sim->sync_particle_soa();
+        const auto &soa = sim->get_particle_soa();
+        const auto &neighbor_cache = sim->get_neighbor_cache();
+
         const real dt = sim->get_dt();
         // We want the global minimum h/v_sig
         omp_real h_per_v_sig(std::numeric_limits<real>::max());
 
-#pragma omp parallel for
-        for (int i = 0; i < num; ++i)
-        {
-            auto &p_i = particles[i];
-            // Skip point-mass (e.g. boundary) particles
-            if (p_i.is_point_mass)
-                continue;
-
-            // Pick effective dimension if 'twoAndHalf' is on
-            int effectiveDim = m_twoAndHalf ? 2 : DIM;
-            real A_eff = (effectiveDim == 1 ? 2.0
-                                            : (effectiveDim == 2 ? M_PI
-                                                                 : 4.0 * M_PI / 3.0));
-
-            // 1) Estimate smoothing length (initial guess)
-            p_i.sml = std::pow(m_neighbor_number * p_i.mass / (p_i.dens * A_eff),
-                               1.0 / effectiveDim) *
-                      m_kernel_ratio;
-
-            // 2) Get neighbor list
-            std::vector<int> neighbor_list(m_neighbor_number * neighbor_list_size);
-#ifdef EXHAUSTIVE_SEARCH
-            int n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num,
-                                               neighbor_list,
-                                               m_neighbor_number * neighbor_list_size,
-                                               periodic, false);
-#else
-            int n_neighbor = tree->neighbor_search(p_i, neighbor_list,
-                                                   particles, false);
-#endif
-
-            // 3) If iterative smoothing is requested, refine h via Newton-Raphson
-            if (m_iteration)
-            {
-                p_i.sml = newton_raphson(p_i, particles, neighbor_list,
-                                         n_neighbor, periodic, kernel);
-            }
-
-            // 4) Compute density, derivative of density, and track v_sig
-            real dens_i = 0.0;
-            real dh_dens_i = 0.0;
-            real v_sig_max = p_i.sound * 2.0;
-            int neighborCount = 0;
+        // point masses are out of the index range, not branched over
+        const auto &sph = sim->sph_ids();
+        const int n_sph = static_cast<int>(sph.size());
 
-            for (int n = 0; n < n_neighbor; ++n)
+        LoopScheduler::Scope schedule(LoopScheduler::PRE_INTERACTION);
+#pragma omp parallel
+        {
+            // per-thread running minimum of h/v_sig, published to the shared
+            // slot once per thread instead of on every improving particle
+            real h_vs_thread = std::numeric_limits<real>::max();
+#pragma omp for schedule(runtime)
+            for (int ii = 0; ii < n_sph; ++ii)
             {
-                int j = neighbor_list[n];
-                auto &p_j = particles[j];
-                if (p_j.is_point_mass)
-                    continue; // Exclude point masses from SPH density
-
-                // Distance
-                vec_t r_ij = periodic->calc_r_ij(p_i.pos, p_j.pos);
-                real r = std::abs(r_ij);
-                if (r >= p_i.sml)
-                    continue;
+                const int i = sph[ii];
+                auto &p_i = particles[i];
+                if (CostHistograms::enabled())
+                {
+                    CostHistograms::touch_window(CostHistograms::PRE_INTERACTION);
+                }
+                if (!p_i.is_active)
+                    continue; // block timesteps: forces stay frozen until the bin boundary
 
-                // Accumulate density & its derivative
-                dens_i += p_j.mass * kernel->w(r, p_i.sml);
-                dh_dens_i += p_j.mass * kernel->dhw(r, p_i.sml);
-                neighborCount++;
+                // Effective dimension (2 in 2.5D runs), baked at compile time
+                constexpr int effectiveDim = TwoAndHalf ? 2 : DIM;
+                constexpr real A_eff = (effectiveDim == 1 ? 2.0
+                                                          : (effectiveDim == 2 ? M_PI
+                                                                               : 4.0 * M_PI / 3.0));
 
-                // Track maximum velocity signal (v_sig)
-                if (i != j)
+                // 1) Estimate smoothing length (initial guess)
+                bool skip_iteration = false;
+#if DIM != 1
+                if (WarmStart && m_warm_primed)
                 {
-                    real v_sig = (p_i.sound + p_j.sound) - 3.0 * inner_product(r_ij, (p_i.vel - p_j.vel)) / (r + 1e-12);
-                    if (v_sig > v_sig_max)
+                    // Predict h from the persisted dh/dt and check how far the
+                    // last converged state has drifted from the neighbor-mass
+                    // target: while both stay small, the prediction is already
+                    // within the Newton-Raphson tolerance and the loop is skipped.
+                    constexpr real drift_tol = 1e-3;  // per-step |dh|/h
+                    constexpr real resid_tol = 1e-2;  // accumulated density residual
+                    const real dh = p_i.h_dot * dt;
+                    const real resid = std::abs(
+                        p_i.dens * A_eff * std::pow(p_i.sml, (real)effectiveDim) / (m_neighbor_number * p_i.mass) - 1.0);
+                    const real h_pred = p_i.sml + dh;
+                    if (h_pred > 0.0)
                     {
-                        v_sig_max = v_sig;
+                        if (std::abs(dh) < drift_tol * p_i.sml && resid < resid_tol)
+                        {
+                            p_i.sml = h_pred;
+                            skip_iteration = true;
+                        }
+                        else
+                        {
+                            // warm-start the iteration from the prediction
+                            p_i.sml = h_pred * m_kernel_ratio;
+                        }
+                    }
+                    else
+                    {
+                        p_i.sml = std::pow(m_neighbor_number * p_i.mass / (p_i.dens * A_eff),
+                                           1.0 / effectiveDim) *
+                                  m_kernel_ratio;
                     }
                 }
-            }
+                else
+#endif
+                {
+                    p_i.sml = std::pow(m_neighbor_number * p_i.mass / (p_i.dens * A_eff),
+                                       1.0 / effectiveDim) *
+                              m_kernel_ratio;
+                }
 
-            // 5) Update particle’s density, pressure, gradient correction
-            p_i.dens = dens_i;
-            p_i.pres = (m_gamma - 1.0) * dens_i * p_i.ene;
-            p_i.gradh = 1.0 / (1.0 + (p_i.sml / (effectiveDim * dens_i + 1e-12)) * dh_dens_i);
-            p_i.neighbor = neighborCount;
+                // 2) Get neighbor list
+                const int *neighbor_ptr = nullptr;
+                int n_neighbor = 0;
+#ifdef EXHAUSTIVE_SEARCH
+                auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num,
+                                               neighbor_list, m_neighbor_number * neighbor_list_size,
+                                               periodic, false);
+                neighbor_ptr = neighbor_list.data();
+#else
+                // Verlet mode: skin-inflated lists from the previous step stay valid
+                if (neighbor_cache.is_valid())
+                {
+                    n_neighbor = neighbor_cache.neighbor_count(i);
+                    neighbor_ptr = neighbor_cache.neighbors(i);
+                }
+                else
+                {
+                    auto & neighbor_list = scratch_neighbor_buffer(seeded_neighbor_capacity(p_i.neighbor, m_neighbor_number));
+                    n_neighbor = tree->neighbor_search_adaptive(p_i, neighbor_list, particles, false);
+                    neighbor_ptr = neighbor_list.data();
+                }
+#endif
 
-            // 6) Update global minimum of (h / v_sig)
-            real h_vs_i = p_i.sml / (v_sig_max + 1e-12);
-            if (h_vs_i < h_per_v_sig.get())
-            {
-                h_per_v_sig.get() = h_vs_i;
-            }
+                // 3) If iterative smoothing is requested, refine h via Newton-Raphson
+                if (m_iteration && !skip_iteration)
+                {
+                    p_i.sml = newton_raphson(p_i, particles, neighbor_ptr,
+                                             n_neighbor, periodic, kernel);
+                }
+
+                // 4) One fused neighbor sweep: v_sig, (when needed) div(v)/curl(v)
+                //    for the AV switches, and staging of the accepted neighbors'
+                //    distances and masses into contiguous scratch arrays. Density
+                //    and its h-derivative are then evaluated over the staged
+                //    arrays with the batched kernel API, which vectorizes where
+                //    the per-neighbor virtual calls could not. The div/curl
+                //    normalization by the density happens after the loop, so
+                //    nothing here depends on the not-yet-final dens_i.
+                real dens_i = 0.0;
+                real dh_dens_i = 0.0;
+                real v_sig_max = p_i.sound * 2.0;
+                int neighborCount = 0;
+                auto &r_buf = scratch_real_buffer(0, n_neighbor);
+                auto &mass_buf = scratch_real_buffer(1, n_neighbor);
 
-            // 7) Artificial viscosity (Balsara switch / time-dependent α)
 #if DIM != 1
-            // Only do Balsara in 2D or 3D
-            if (m_use_balsara_switch && effectiveDim != 1)
-            {
+                // effectiveDim is never 1 here (twoAndHalf maps to 2)
+                constexpr bool use_balsara = UseBalsara;
+                constexpr bool need_div_v = UseBalsara || UseTimeDependentAV || WarmStart;
                 real div_v = 0.0;
 #if DIM == 2
                 real rot_v = 0.0; // 2D “z-component” of curl
 #else
                 vec_t rot_v(0.0); // 3D vector for curl
 #endif
-                // Re-loop neighbors to compute div(v) and curl(v)
+#endif
+
                 for (int n = 0; n < n_neighbor; ++n)
                 {
-                    int j = neighbor_list[n];
-                    auto &p_j = particles[j];
-                    if (p_j.is_point_mass)
-                        continue;
+                    int j = neighbor_ptr[n];
+                    if (soa.is_point_mass[j])
+                        continue; // Exclude point masses from SPH density
 
-                    vec_t r_ij = periodic->calc_r_ij(p_i.pos, p_j.pos);
+                    // Distance
+                    vec_t r_ij = periodic->calc_r_ij(p_i.pos, soa.pos[j]);
                     real r = std::abs(r_ij);
                     if (r >= p_i.sml)
                         continue;
 
-                    vec_t v_ij = p_i.vel - p_j.vel;
-                    vec_t dw = kernel->dw(r_ij, r, p_i.sml);
+                    // Stage for the batched density pass below
+                    r_buf[neighborCount] = r;
+                    mass_buf[neighborCount] = soa.mass[j];
+                    neighborCount++;
 
-                    div_v -= p_j.mass * inner_product(v_ij, dw);
+                    // Track maximum velocity signal (v_sig)
+                    if (i != j)
+                    {
+                        real v_sig = (p_i.sound + soa.sound[j]) - 3.0 * inner_product(r_ij, (p_i.vel - soa.vel[j])) / (r + 1e-12);
+                        if (v_sig > v_sig_max)
+                        {
+                            v_sig_max = v_sig;
+                        }
+                    }
+
+#if DIM != 1
+                    if (need_div_v)
+                    {
+                        vec_t v_ij = p_i.vel - soa.vel[j];
+                        vec_t dw = kernel->dw(r_ij, r, p_i.sml);
+
+                        div_v -= soa.mass[j] * inner_product(v_ij, dw);
+                        if (use_balsara)
+                        {
 #if DIM == 2
-                    rot_v += p_j.mass * (v_ij[0] * dw[1] - v_ij[1] * dw[0]);
+                            rot_v += soa.mass[j] * (v_ij[0] * dw[1] - v_ij[1] * dw[0]);
 #else
-                    rot_v += vector_product(v_ij, dw) * p_j.mass * p_j.mass;
+                            rot_v += vector_product(v_ij, dw) * soa.mass[j] * soa.mass[j];
+#endif
+                        }
+                    }
 #endif
                 }
-                div_v /= (p_i.dens + 1e-12);
+
+                // Batched density pass over the staged arrays
+                {
+                    auto &w_buf = scratch_real_buffer(2, neighborCount);
+                    auto &dhw_buf = scratch_real_buffer(3, neighborCount);
+                    kernel->w_batch(r_buf.data(), p_i.sml, w_buf.data(), neighborCount);
+                    kernel->dhw_batch(r_buf.data(), p_i.sml, dhw_buf.data(), neighborCount);
+#pragma omp simd reduction(+ : dens_i, dh_dens_i)
+                    for (int n = 0; n < neighborCount; ++n)
+                    {
+                        dens_i += mass_buf[n] * w_buf[n];
+                        dh_dens_i += mass_buf[n] * dhw_buf[n];
+                    }
+                }
+
+                // 5) Update particle’s density, pressure, gradient correction
+                p_i.dens = dens_i;
+                p_i.pres = (m_gamma - 1.0) * dens_i * p_i.ene;
+                p_i.gradh = 1.0 / (1.0 + (p_i.sml / (effectiveDim * dens_i + 1e-12)) * dh_dens_i);
+                p_i.neighbor = neighborCount;
+
+#if DIM != 1
+                // persist dh/dt for the next step's warm start: rho h^d = const
+                // gives dh/dt = (h / d) div(v), with div_v still un-normalized here
+                if (WarmStart)
+                {
+                    p_i.h_dot = p_i.sml * (div_v / (dens_i + 1e-12)) / effectiveDim;
+                }
+#endif
+
+                // 6) Per-particle Courant value and thread-local minimum
+                const real h_vs_i = p_i.sml / (v_sig_max + 1e-12);
+                p_i.h_per_v_sig = h_vs_i;
+                if (h_vs_i < h_vs_thread)
+                {
+                    h_vs_thread = h_vs_i;
+                }
+
+                // 7) Artificial viscosity (Balsara switch / time-dependent α),
+                //    using the div/curl sums accumulated in the fused sweep
+#if DIM != 1
+                // Only do Balsara in 2D or 3D
+                if (use_balsara)
+                {
+                    div_v /= (p_i.dens + 1e-12);
 
 #if DIM == 2
-                rot_v /= (p_i.dens + 1e-12);
-                real abs_rot_v = std::abs(rot_v);
+                    rot_v /= (p_i.dens + 1e-12);
+                    real abs_rot_v = std::abs(rot_v);
 #else
-                real abs_rot_v = std::abs(rot_v) / (p_i.dens + 1e-12);
+                    real abs_rot_v = std::abs(rot_v) / (p_i.dens + 1e-12);
 #endif
 
-                // Balsara switch: alpha *= |divV| / (|divV| + |curlV| + small)
-                p_i.balsara = std::abs(div_v) / (std::abs(div_v) + abs_rot_v + 1e-4 * p_i.sound / (p_i.sml + 1e-12));
+                    // Balsara switch: alpha *= |divV| / (|divV| + |curlV| + small)
+                    p_i.balsara = std::abs(div_v) / (std::abs(div_v) + abs_rot_v + 1e-4 * p_i.sound / (p_i.sml + 1e-12));
 
-                // (Optional) Time-dependent α
-                if (m_use_time_dependent_av)
+                    // (Optional) Time-dependent α
+                    if (UseTimeDependentAV)
+                    {
+                        real tau_inv = m_epsilon * p_i.sound / (p_i.sml + 1e-12);
+                        real s_i = std::max(-div_v, (real)0.0); // compress only
+
+                        // dα/dt = –(α–α_min)*τ⁻¹ + max(-divV, 0)*(α_max – α)
+                        real alpha_old = p_i.alpha;
+                        real dalpha = (-(alpha_old - m_alpha_min) * tau_inv + s_i * (m_alpha_max - alpha_old)) * dt;
+
+                        p_i.alpha = alpha_old + dalpha;
+                        // Optionally clamp
+                        if (p_i.alpha < m_alpha_min)
+                            p_i.alpha = m_alpha_min;
+                        if (p_i.alpha > m_alpha_max)
+                            p_i.alpha = m_alpha_max;
+                    }
+                }
+                else if (UseTimeDependentAV)
                 {
-                    real tau_inv = m_epsilon * p_i.sound / (p_i.sml + 1e-12);
-                    real s_i = std::max(-div_v, (real)0.0); // compress only
+                    // No Balsara switch path: only div(v) is needed
+                    div_v /= (p_i.dens + 1e-12);
 
-                    // dα/dt = –(α–α_min)*τ⁻¹ + max(-divV, 0)*(α_max – α)
+                    real tau_inv = m_epsilon * p_i.sound / (p_i.sml + 1e-12);
+                    real s_i = std::max(-div_v, (real)0.0);
                     real alpha_old = p_i.alpha;
                     real dalpha = (-(alpha_old - m_alpha_min) * tau_inv + s_i * (m_alpha_max - alpha_old)) * dt;
 
                     p_i.alpha = alpha_old + dalpha;
-                    // Optionally clamp
                     if (p_i.alpha < m_alpha_min)
                         p_i.alpha = m_alpha_min;
                     if (p_i.alpha > m_alpha_max)
                         p_i.alpha = m_alpha_max;
                 }
-            }
-            else if (m_use_time_dependent_av)
-            {
-                // No Balsara switch path
-                // Need div(v) only
-                real div_v = 0.0;
-                for (int n = 0; n < n_neighbor; ++n)
-                {
-                    int j = neighbor_list[n];
-                    auto &p_j = particles[j];
-                    if (p_j.is_point_mass)
-                        continue;
-
-                    vec_t r_ij = periodic->calc_r_ij(p_i.pos, p_j.pos);
-                    real r = std::abs(r_ij);
-                    if (r >= p_i.sml)
-                        continue;
+#endif // DIM != 1
+            } // end of parallel loop
 
-                    vec_t v_ij = p_i.vel - p_j.vel;
-                    vec_t dw = kernel->dw(r_ij, r, p_i.sml);
-                    div_v -= p_j.mass * inner_product(v_ij, dw);
-                }
-                div_v /= (p_i.dens + 1e-12);
-
-                real tau_inv = m_epsilon * p_i.sound / (p_i.sml + 1e-12);
-                real s_i = std::max(-div_v, (real)0.0);
-                real alpha_old = p_i.alpha;
-                real dalpha = (-(alpha_old - m_alpha_min) * tau_inv + s_i * (m_alpha_max - alpha_old)) * dt;
-
-                p_i.alpha = alpha_old + dalpha;
-                if (p_i.alpha < m_alpha_min)
-                    p_i.alpha = m_alpha_min;
-                if (p_i.alpha > m_alpha_max)
-                    p_i.alpha = m_alpha_max;
+            if (h_vs_thread < h_per_v_sig.get())
+            {
+                h_per_v_sig.get() = h_vs_thread;
             }
-#endif // DIM != 1
-        } // end of parallel loop
+        }
 
         // Update global h_per_v_sig
         sim->set_h_per_v_sig(h_per_v_sig.min());
@@ -16,6 +16,18 @@ namespace sph
         c_sound = param->cfl.sound;
         c_force = param->cfl.force;
         c_ene = param->cfl.ene;
+
+        m_use_block = param->block_timesteps.is_valid;
+        m_max_bins = param->block_timesteps.max_bins;
+        m_substep = 0;
+
+        m_growth_limit = param->cfl.dt_growth_limit;
+        m_reduction_interval = param->cfl.dt_reduction_interval;
+        m_stale_safety = param->cfl.dt_stale_safety;
+        m_dt_prev = 0.0;
+        m_steps_since_full = m_reduction_interval; // full reduction on the first step
+        m_held_dt_force = std::numeric_limits<accum_t>::max();
+        m_held_dt_ene = std::numeric_limits<accum_t>::max();
     }
 
     void TimeStep::calculation(std::shared_ptr<Simulation> sim)
@@ -23,54 +35,95 @@ namespace sph
         auto &particles = sim->get_particles();
         const int num = sim->get_particle_num();
 
-        // Variables to find the minimum timesteps across particles
-        omp_real dt_min_force(std::numeric_limits<real>::max());
-        omp_real dt_min_ene(std::numeric_limits<real>::max());
+        // Minimum timesteps across particles, evaluated in accum_t (double in
+        // the mixed build) and reduced with the fixed-topology helpers so the
+        // selected dt is bitwise identical for any thread count.
+        const accum_t dt_identity = std::numeric_limits<accum_t>::max();
 
-        // Parallel loop to compute force and energy timesteps
-#pragma omp parallel for
-        for (int i = 0; i < num; ++i)
+        accum_t dt_min_force;
+        accum_t dt_min_ene;
+        if (!m_use_block && sim->get_dt_minima_valid())
+        {
+            // FluidForce already reduced both criteria in the tail of its
+            // sweep, so the standalone pass over N particles — pure memory
+            // traffic — is skipped. The flag is cleared by any module that
+            // rewrites acc afterwards (gravity) or ene (heating/cooling);
+            // block timesteps fall back because frozen particles skip the
+            // sweep. Note the energy criterion (reference only, dt_global
+            // ignores it) then reads ene as of the force sweep, before the
+            // corrector updated it.
+            dt_min_force = sim->get_dt_force_min();
+            dt_min_ene = sim->get_dt_ene_min();
+            m_held_dt_force = dt_min_force;
+            m_held_dt_ene = dt_min_ene;
+            m_steps_since_full = 0;
+        }
+        else if (m_steps_since_full < m_reduction_interval)
+        {
+            // Amortized recomputation: reuse the minima from the last full
+            // reduction with a safety margin instead of re-walking every
+            // particle; the margin covers the drift the criteria can
+            // accumulate before the next full pass.
+            ++m_steps_since_full;
+            dt_min_force = m_held_dt_force * m_stale_safety;
+            dt_min_ene = m_held_dt_ene;
+        }
+        else
         {
             // Force criterion
-            const real acc_abs = std::abs(particles[i].acc);
-            if (acc_abs > 0.0)
-            {
-                const real dt_force_i = c_force * std::sqrt(particles[i].sml / acc_abs);
-                if (dt_force_i < dt_min_force.get())
+            dt_min_force = deterministic_min<accum_t>(
+                num, dt_identity,
+                [&](const int i) -> accum_t
                 {
-                    dt_min_force.get() = dt_force_i;
-                }
-            }
+                    const accum_t acc_abs = std::abs(particles[i].acc);
+                    return acc_abs > 0.0 ? c_force * std::sqrt(particles[i].sml / acc_abs)
+                                         : dt_identity;
+                });
 
             // Energy criterion
-            const real ene_abs = std::abs(particles[i].ene);
-            const real dene_abs = std::abs(particles[i].dene);
-            if (dene_abs > 0.0 && ene_abs > 1e-10)
-            {
-                const real dt_ene_i = c_ene * ene_abs / dene_abs;
-                if (dt_ene_i < dt_min_ene.get())
+            dt_min_ene = deterministic_min<accum_t>(
+                num, dt_identity,
+                [&](const int i) -> accum_t
                 {
-                    dt_min_ene.get() = dt_ene_i;
-                }
-            }
+                    const accum_t ene_abs = std::abs(particles[i].ene);
+                    const accum_t dene_abs = std::abs(particles[i].dene);
+                    return (dene_abs > 0.0 && ene_abs > 1e-10) ? c_ene * ene_abs / dene_abs
+                                                               : dt_identity;
+                });
+
+            m_held_dt_force = dt_min_force;
+            m_held_dt_ene = dt_min_ene;
+            m_steps_since_full = 0;
         }
 
         // Compute the sound timestep
         const real dt_sound_i = c_sound * sim->get_h_per_v_sig();
-        const real dt_force = dt_min_force.min();
-        const real dt_ene = dt_min_ene.min();
+        const real dt_force = dt_min_force;
+        const real dt_ene = dt_min_ene;
 
         // Set the global timestep as the smallest of dt_sound_i and dt_force
         real dt_global = std::min({dt_sound_i, dt_force});
 
-        // Apply the condition: if dt_global < 1e-3, multiply by 5
+        // Rate-limit growth against the previous step so a transient
+        // relaxation of the criteria cannot balloon dt and immediately
+        // force a shrink (the old "multiply by 5 below 1e-5" boost caused
+        // exactly that shrink/boost thrashing in shock runs). Shrinking
+        // always follows the raw value: the CFL bound is hard.
+        if (m_dt_prev > 0.0)
+        {
+            const real dt_capped = m_dt_prev * m_growth_limit;
+            if (dt_global > dt_capped)
+            {
+                dt_global = dt_capped;
+            }
+        }
+        m_dt_prev = dt_global;
+
         const real dt_threshold = 1e-5;
         if (dt_global < dt_threshold)
         {
-            real dt_original = dt_global; // Store original for logging
-            dt_global *= 5;               // Multiply by 5
-            WRITE_LOG << "Warning: dt_global adjusted from " << dt_original
-                      << " to " << dt_global << " (multiplied by 5) at t = " << sim->get_time();
+            WRITE_LOG << "Warning: dt_global = " << dt_global
+                      << " below " << dt_threshold << " at t = " << sim->get_time();
         }
 
         // Set the adjusted timestep in the simulation
@@ -86,6 +139,10 @@ namespace sph
         {
             limiting_criterion = "force";
         }
+        else
+        {
+            limiting_criterion = "growth limit";
+        }
 
         // Log the timestep values and the limiting criterion
         WRITE_LOG << "Timestep criteria at t = " << sim->get_time() << ": "
@@ -93,5 +150,86 @@ namespace sph
                   << "dt_force = " << dt_force << ", "
                   << "dt_ene = " << dt_ene << ". "
                   << "Limiting criterion(ene is only for reference): " << limiting_criterion;
+
+        if (m_use_block)
+        {
+            assign_bins(sim, dt_global);
+        }
+    }
+
+    // Block timesteps: each particle sits in a power-of-two bin of the global
+    // dt and is "active" (gets new forces) only when the substep counter hits
+    // its bin boundary. Inactive particles keep their frozen acc/dene, so the
+    // force modules can simply skip them. A particle may drop to a smaller bin
+    // at any boundary of its own, but may only grow into a larger bin when
+    // that bin is aligned with the current substep.
+    void TimeStep::assign_bins(std::shared_ptr<Simulation> sim, const real dt)
+    {
+        auto &particles = sim->get_particles();
+
+        // walls and point masses never bin; handle them in their own small
+        // loops and keep the binning sweep branch-free over the fluid range
+        const auto &wall = sim->wall_ids();
+        const auto &point_mass = sim->point_mass_ids();
+        const int n_wall = static_cast<int>(wall.size());
+        const int n_point_mass = static_cast<int>(point_mass.size());
+#pragma omp parallel for
+        for (int ii = 0; ii < n_wall; ++ii)
+        {
+            particles[wall[ii]].is_active = true;
+        }
+#pragma omp parallel for
+        for (int ii = 0; ii < n_point_mass; ++ii)
+        {
+            particles[point_mass[ii]].is_active = true;
+        }
+
+        const auto &fluid = sim->fluid_ids();
+        const int n_fluid = static_cast<int>(fluid.size());
+
+#pragma omp parallel for
+        for (int ii = 0; ii < n_fluid; ++ii)
+        {
+            auto &p_i = particles[fluid[ii]];
+
+            if (m_substep % (1 << p_i.dt_bin) != 0)
+            {
+                p_i.is_active = false;
+                continue;
+            }
+            p_i.is_active = true;
+
+            // per-particle dt from the same CFL criteria as the global one.
+            // The signal-velocity Courant value from the density sweep keeps
+            // the velocity-dependent terms that h / c_s drops, so a shocked
+            // particle (v_sig >> c_s) cannot be promoted past its CFL limit;
+            // the plain sound criterion stays as the fallback for particles
+            // that have not been through a sweep yet.
+            real dt_i = std::numeric_limits<real>::max();
+            if (p_i.h_per_v_sig > 0.0)
+            {
+                dt_i = std::min(dt_i, c_sound * p_i.h_per_v_sig);
+            }
+            else if (p_i.sound > 0.0)
+            {
+                dt_i = std::min(dt_i, c_sound * p_i.sml / p_i.sound);
+            }
+            const real acc_abs = std::abs(p_i.acc);
+            if (acc_abs > 0.0)
+            {
+                dt_i = std::min(dt_i, c_force * std::sqrt(p_i.sml / acc_abs));
+            }
+
+            int bin = 0;
+            while (bin + 1 < m_max_bins &&
+                   dt * (1 << (bin + 1)) <= dt_i &&
+                   m_substep % (1 << (bin + 1)) == 0)
+            {
+                ++bin;
+            }
+            p_i.dt_bin = bin;
+        }
+
+        m_substep = (m_substep + 1) & ((1 << (m_max_bins - 1)) - 1);
     }
 }
\ No newline at end of file
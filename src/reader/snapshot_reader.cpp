@@ -0,0 +1,335 @@
+#include "reader/snapshot_reader.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sph
+{
+
+    namespace detail
+    {
+
+        class MappedSnapshotFile
+        {
+        public:
+            explicit MappedSnapshotFile(const std::string &path)
+            {
+#ifndef _WIN32
+                const int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                {
+                    throw std::runtime_error("Cannot open snapshot file: " + path);
+                }
+                struct stat st;
+                if (fstat(fd, &st) != 0)
+                {
+                    close(fd);
+                    throw std::runtime_error("Cannot stat snapshot file: " + path);
+                }
+                m_size = static_cast<std::uint64_t>(st.st_size);
+                if (m_size == 0)
+                {
+                    close(fd);
+                    throw std::runtime_error("Snapshot file is empty: " + path);
+                }
+                void *addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                close(fd); // mapping keeps its own reference
+                if (addr == MAP_FAILED)
+                {
+                    throw std::runtime_error("Cannot memory-map snapshot file: " + path);
+                }
+                m_base = static_cast<const char *>(addr);
+#ifdef MADV_RANDOM
+                // Column extraction jumps between blocks; no readahead
+                madvise(addr, m_size, MADV_RANDOM);
+#endif
+#else
+                throw std::runtime_error("snapshot reader requires POSIX mmap: " + path);
+#endif
+            }
+
+            ~MappedSnapshotFile()
+            {
+#ifndef _WIN32
+                if (m_base)
+                {
+                    munmap(const_cast<char *>(m_base), m_size);
+                }
+#endif
+            }
+
+            MappedSnapshotFile(const MappedSnapshotFile &) = delete;
+            MappedSnapshotFile &operator=(const MappedSnapshotFile &) = delete;
+
+            const char *base() const { return m_base; }
+            std::uint64_t size() const { return m_size; }
+
+        private:
+            const char *m_base = nullptr;
+            std::uint64_t m_size = 0;
+        };
+
+    } // namespace detail
+
+    namespace
+    {
+
+        constexpr std::uint32_t COLUMNAR_MAGIC = 0x53504803;  // "SPH\x03"
+        constexpr std::uint32_t CONTAINER_MAGIC = 0x53504804; // "SPH\x04"
+        constexpr std::uint32_t FRAME_MAGIC = 0x53464d31;     // "SFM1"
+
+        /// Bounds-checked little cursor over a mapped byte range.
+        struct Cursor
+        {
+            const char *p;
+            std::uint64_t left;
+            const std::string &context;
+
+            template <class T>
+            T get()
+            {
+                if (left < sizeof(T))
+                {
+                    throw std::runtime_error("Truncated snapshot data: " + context);
+                }
+                T v;
+                std::memcpy(&v, p, sizeof(T));
+                p += sizeof(T);
+                left -= sizeof(T);
+                return v;
+            }
+
+            std::string get_name16()
+            {
+                if (left < 16)
+                {
+                    throw std::runtime_error("Truncated snapshot data: " + context);
+                }
+                char buf[17];
+                std::memcpy(buf, p, 16);
+                buf[16] = '\0';
+                p += 16;
+                left -= 16;
+                return std::string(buf);
+            }
+        };
+
+    } // anonymous namespace
+
+    SnapshotView SnapshotView::parse(const char *base, std::uint64_t size,
+                                     std::shared_ptr<detail::MappedSnapshotFile> keep_alive,
+                                     const std::string &context)
+    {
+        SnapshotView view;
+        view.m_map = std::move(keep_alive);
+
+        Cursor c{base, size, context};
+        const auto magic = c.get<std::uint32_t>();
+        if (magic != COLUMNAR_MAGIC)
+        {
+            throw std::runtime_error("Not a columnar snapshot (bad magic): " + context);
+        }
+        const auto version = c.get<std::uint32_t>();
+        if (version != 1)
+        {
+            throw std::runtime_error("Unsupported columnar snapshot version " +
+                                     std::to_string(version) + ": " + context);
+        }
+        view.m_dimension = static_cast<int>(c.get<std::uint32_t>());
+        view.m_particle_count = static_cast<int>(c.get<std::uint32_t>());
+        view.m_time = c.get<double>();
+        view.m_length_factor = c.get<double>();
+        view.m_time_factor = c.get<double>();
+        view.m_mass_factor = c.get<double>();
+        view.m_length_unit = c.get_name16();
+        view.m_time_unit = c.get_name16();
+        view.m_mass_unit = c.get_name16();
+
+        const auto column_count = c.get<std::uint32_t>();
+        view.m_columns.reserve(column_count);
+        for (std::uint32_t i = 0; i < column_count; ++i)
+        {
+            SnapshotColumn column;
+            column.name = c.get_name16();
+            const auto dtype = c.get<std::uint32_t>();
+            if (dtype > SnapshotColumn::INT32)
+            {
+                throw std::runtime_error("Unknown column dtype in " + context +
+                                         ": " + column.name);
+            }
+            column.dtype = static_cast<SnapshotColumn::DType>(dtype);
+            const auto offset = c.get<std::uint64_t>();
+            column.bytes = c.get<std::uint64_t>();
+            if (offset > size || column.bytes > size - offset)
+            {
+                throw std::runtime_error("Column block out of bounds in " + context +
+                                         ": " + column.name);
+            }
+            column.data = base + offset;
+            view.m_columns.push_back(std::move(column));
+        }
+        return view;
+    }
+
+    const SnapshotColumn *SnapshotView::find(const std::string &name) const
+    {
+        for (const auto &column : m_columns)
+        {
+            if (column.name == name)
+            {
+                return &column;
+            }
+        }
+        return nullptr;
+    }
+
+    bool SnapshotView::has_column(const std::string &name) const
+    {
+        return find(name) != nullptr;
+    }
+
+    const double *SnapshotView::float64(const std::string &name) const
+    {
+        const auto *column = find(name);
+        if (!column)
+        {
+            throw std::runtime_error("Snapshot has no column: " + name);
+        }
+        if (column->dtype != SnapshotColumn::FLOAT64)
+        {
+            throw std::runtime_error("Column is not float64: " + name);
+        }
+        return reinterpret_cast<const double *>(column->data);
+    }
+
+    const std::int32_t *SnapshotView::int32(const std::string &name) const
+    {
+        const auto *column = find(name);
+        if (!column)
+        {
+            throw std::runtime_error("Snapshot has no column: " + name);
+        }
+        if (column->dtype != SnapshotColumn::INT32)
+        {
+            throw std::runtime_error("Column is not int32: " + name);
+        }
+        return reinterpret_cast<const std::int32_t *>(column->data);
+    }
+
+    SnapshotMetadata SnapshotView::metadata() const
+    {
+        SnapshotMetadata meta;
+        meta.simulation.time = m_time;
+        meta.simulation.dimension = m_dimension;
+        meta.simulation.particle_count = m_particle_count;
+        meta.units.length = m_length_unit;
+        meta.units.time = m_time_unit;
+        meta.units.mass = m_mass_unit;
+        meta.conversion_factors.length_factor = m_length_factor;
+        meta.conversion_factors.time_factor = m_time_factor;
+        meta.conversion_factors.mass_factor = m_mass_factor;
+        for (const auto &column : m_columns)
+        {
+            meta.columns.emplace_back(
+                column.name, "",
+                column.dtype == SnapshotColumn::FLOAT64 ? "float64" : "int32");
+        }
+        return meta;
+    }
+
+    SnapshotReader::SnapshotReader(const std::string &path)
+    {
+        auto map = std::make_shared<detail::MappedSnapshotFile>(path);
+        const char *base = map->base();
+        const std::uint64_t size = map->size();
+        m_view = SnapshotView::parse(base, size, std::move(map), path);
+    }
+
+    ContainerReader::ContainerReader(const std::string &path)
+        : m_path(path)
+    {
+        m_map = std::make_shared<detail::MappedSnapshotFile>(path);
+
+        Cursor c{m_map->base(), m_map->size(), m_path};
+        const auto magic = c.get<std::uint32_t>();
+        if (magic != CONTAINER_MAGIC)
+        {
+            throw std::runtime_error("Not a snapshot container (bad magic): " + path);
+        }
+        const auto version = c.get<std::uint32_t>();
+        if (version != 1)
+        {
+            throw std::runtime_error("Unsupported container version " +
+                                     std::to_string(version) + ": " + path);
+        }
+        c.get<std::uint32_t>(); // dimension (repeated per frame)
+        c.get<double>();        // length factor
+        c.get<double>();        // time factor
+        c.get<double>();        // mass factor
+        c.get_name16();         // length unit
+        c.get_name16();         // time unit
+        c.get_name16();         // mass unit
+
+        // Frames are self-delimiting: header-hop through the file. Only the
+        // header pages fault in, so indexing a huge container stays cheap.
+        while (c.left > 0)
+        {
+            const auto frame_magic = c.get<std::uint32_t>();
+            if (frame_magic != FRAME_MAGIC)
+            {
+                throw std::runtime_error("Corrupt container frame header: " + path);
+            }
+            FrameInfo info;
+            info.payload_size = c.get<std::uint64_t>();
+            info.time = c.get<double>();
+            info.particles = static_cast<int>(c.get<std::uint32_t>());
+            if (c.left < info.payload_size)
+            {
+                throw std::runtime_error("Truncated container frame: " + path);
+            }
+            info.payload_offset = static_cast<std::uint64_t>(c.p - m_map->base());
+            c.p += info.payload_size;
+            c.left -= info.payload_size;
+            m_frames.push_back(info);
+        }
+    }
+
+    SnapshotView ContainerReader::frame(const int frame) const
+    {
+        const auto &info = m_frames.at(frame);
+        return SnapshotView::parse(m_map->base() + info.payload_offset,
+                                   info.payload_size, m_map,
+                                   m_path + " frame " + std::to_string(frame));
+    }
+
+    int ContainerReader::frame_at(const double t) const
+    {
+        if (m_frames.empty())
+        {
+            throw std::runtime_error("Container has no frames: " + m_path);
+        }
+        int best = 0;
+        double best_dist = std::numeric_limits<double>::max();
+        for (int f = 0; f < frame_count(); ++f)
+        {
+            const double dist = std::abs(m_frames[f].time - t);
+            if (dist < best_dist)
+            {
+                best = f;
+                best_dist = dist;
+            }
+        }
+        return best;
+    }
+
+}
@@ -1,9 +1,12 @@
 #include "relaxation/lane_emden_relaxation.hpp"
 #include <omp.h>
 #include <algorithm>
+#include <cmath>
 #include "core/logger.hpp"
+#include "core/simulation.hpp"
 #include "utilities/exception.hpp"
 #include "utilities/defines.hpp"
+#include "utilities/openmp.hpp"
 
 namespace sph
 {
@@ -27,9 +30,9 @@ namespace sph
         // Dimensionless coordinate (use xi = 0 on the z-axis)
         real xi = (r_cyl > eps) ? r_cyl / alpha : 0.0;
 
-        // Get θ(ξ) and its derivative using LaneEmdenData
-        real theta_val = m_data.get_theta(xi);
-        real dtheta = (r_cyl > eps) ? m_data.dtheta_dxi(xi) : 0.0; // Radial force is zero at r_cyl = 0
+        // Get θ(ξ) and its derivative from the uniform spline table
+        real theta_val = m_data.get_theta_fast(xi);
+        real dtheta = (r_cyl > eps) ? m_data.dtheta_dxi_fast(xi) : 0.0; // Radial force is zero at r_cyl = 0
 
         // Check for valid theta_val (assuming theta should be non-negative)
         if (theta_val < 0.0)
@@ -76,6 +79,16 @@ namespace sph
         auto &particles = sim->get_particles();
         int num_p = sim->get_particle_num();
 
+        // Not yet seeded when the solver applies the force before the first
+        // begin_iteration (e.g. the IC-construction path)
+        const real damping = m_damping > 0.0 ? m_damping : params.density_relaxation.damping_factor;
+
+        const bool reuse = m_force_cache_valid && (int)m_force_cache.size() == num_p;
+        if (!reuse)
+        {
+            m_force_cache.resize(num_p);
+        }
+
         // Parallel loop over all particles
 #pragma omp parallel for
         for (int i = 0; i < num_p; i++)
@@ -83,8 +96,14 @@ namespace sph
             if (particles[i].is_wall)
                 continue; // Skip wall particles
 
-            // Compute relaxation acceleration for the particle
-            vec_t relax_acc = compute_relaxation_force(particles[i], params);
+            // Relaxation acceleration: computed once per step from the
+            // positions, reused from the cache on the second call
+            vec_t relax_acc = reuse ? m_force_cache[i]
+                                    : compute_relaxation_force(particles[i], params);
+            if (!reuse)
+            {
+                m_force_cache[i] = relax_acc;
+            }
 
             // Subtract relaxation acceleration from current acceleration
             for (int d = 0; d < 3; d++)
@@ -92,16 +111,105 @@ namespace sph
                 particles[i].acc[d] -= relax_acc[d];
             }
 
-            // Zero the particle's velocity for relaxation
+            // Damp the particle's velocity for relaxation. The annealed
+            // damping (see begin_iteration) replaces the old hard zeroing,
+            // which is the damping = 1 limit.
             for (int d = 0; d < 3; d++)
             {
-                particles[i].vel[d] = 0.0;
+                particles[i].vel[d] *= 1.0 - damping;
             }
         }
+        m_force_cache_valid = true;
 
         // Log the operation
         WRITE_LOG << "[LaneEmdenRelaxation] Applied radial and vertical Lane–Emden acceleration to "
                   << num_p << " particles.";
     }
 
+    real LaneEmdenRelaxation::density_residual(std::shared_ptr<Simulation> sim) const
+    {
+        const auto &particles = sim->get_particles();
+        const int num = sim->get_particle_num();
+
+        // Fixed-topology sums so the early-exit decision is bitwise
+        // reproducible across thread counts, like the conservation series.
+        const real err2 = deterministic_sum<real>(num, [&](const int i) {
+            const auto &p_i = particles[i];
+            if (p_i.is_wall || p_i.is_point_mass || p_i.target_rho <= 0.0)
+            {
+                return real(0.0);
+            }
+            const real diff = p_i.dens - p_i.target_rho;
+            return diff * diff;
+        });
+        const real ref2 = deterministic_sum<real>(num, [&](const int i) {
+            const auto &p_i = particles[i];
+            if (p_i.is_wall || p_i.is_point_mass || p_i.target_rho <= 0.0)
+            {
+                return real(0.0);
+            }
+            return p_i.target_rho * p_i.target_rho;
+        });
+
+        return ref2 > 0.0 ? std::sqrt(err2 / ref2) : 0.0;
+    }
+
+    void LaneEmdenRelaxation::begin_iteration(std::shared_ptr<Simulation> sim,
+                                              const SPHParameters &params)
+    {
+        if (m_converged)
+        {
+            return;
+        }
+
+        // Seed the annealed damping from the configured factor on the first
+        // iteration; the bold-driver rule then adapts it per step.
+        if (m_damping <= 0.0)
+        {
+            m_damping = params.density_relaxation.damping_factor;
+        }
+
+        const real residual = density_residual(sim);
+        ++m_iteration;
+
+        if (residual < params.density_relaxation.tolerance)
+        {
+            m_converged = true;
+            WRITE_LOG << "[LaneEmdenRelaxation] Converged after " << m_iteration
+                      << " iterations (residual " << residual << " < tolerance "
+                      << params.density_relaxation.tolerance << "); relaxation sweeps stop.";
+            return;
+        }
+        if (m_iteration >= params.density_relaxation.max_iterations)
+        {
+            m_converged = true;
+            WRITE_LOG << "[LaneEmdenRelaxation] Stopping after max_iterations = "
+                      << params.density_relaxation.max_iterations
+                      << " with residual " << residual << " (tolerance "
+                      << params.density_relaxation.tolerance << " not reached).";
+            return;
+        }
+
+        // Bold-driver annealing: a shrinking residual earns a modestly larger
+        // step, a growing one halves it. This reaches the monotone regime far
+        // sooner than any fixed damping_factor, which must be chosen for the
+        // worst (initial) iterate and then wastes the easy late iterations.
+        if (m_prev_residual > 0.0)
+        {
+            if (residual < m_prev_residual)
+            {
+                m_damping = std::min(m_damping * 1.1, 1.0);
+            }
+            else
+            {
+                m_damping = std::max(m_damping * 0.5,
+                                     0.01 * params.density_relaxation.damping_factor);
+            }
+        }
+        m_prev_residual = residual;
+
+        WRITE_LOG << "[LaneEmdenRelaxation] Iteration " << m_iteration
+                  << ": residual " << residual << ", damping " << m_damping;
+    }
+
 } // namespace sph
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "core/parameters.hpp"
+#include "tree/cell_list.hpp"
+#include "core/particle.hpp"
+#include "utilities/openmp.hpp"
+#include "utilities/exception.hpp"
+#include "utilities/event_counters.hpp"
+#include "utilities/periodic.hpp"
+
+namespace sph
+{
+
+    void CellList::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        m_is_periodic = param->periodic.is_valid;
+        if (m_is_periodic)
+        {
+            m_range_max = param->periodic.range_max;
+            m_range_min = param->periodic.range_min;
+        }
+
+        m_periodic = std::make_shared<Periodic>();
+        m_periodic->initialize(param);
+        m_search_margin = 0.0;
+        m_max_sml = 0.0;
+        m_particles = nullptr;
+        m_particle_num = 0;
+
+        if (param->gravity.is_valid)
+        {
+            THROW_ERROR("useCellList does not support self-gravity; use the BHTree engine for gravity runs.");
+        }
+    }
+
+    void CellList::resize(const int particle_num, const int tree_size)
+    {
+        m_next.resize(particle_num);
+    }
+
+    int CellList::cell_of(const vec_t &pos) const
+    {
+        int index = 0;
+        for (int d = 0; d < DIM; ++d)
+        {
+            int c = static_cast<int>((pos[d] - m_range_min[d]) / m_cell_edge[d]);
+            if (c < 0)
+            {
+                c = 0;
+            }
+            else if (c >= m_cells[d])
+            {
+                c = m_cells[d] - 1;
+            }
+            index = index * m_cells[d] + c;
+        }
+        return index;
+    }
+
+    void CellList::build_grid()
+    {
+        auto &particles = *m_particles;
+        const int num = m_particle_num;
+
+        // Largest search radius decides the cell edge, so the neighbors of
+        // any particle are contained in the 3^DIM cells around it.
+        omp_real sml_max(0.0);
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+        {
+            if (particles[i].sml > sml_max.get())
+            {
+                sml_max.get() = particles[i].sml;
+            }
+        }
+        m_max_sml = sml_max.max();
+
+        if (!m_is_periodic)
+        {
+            omp_real r_min[DIM];
+            omp_real r_max[DIM];
+            for (int d = 0; d < DIM; ++d)
+            {
+                r_min[d].get() = std::numeric_limits<real>::max();
+                r_max[d].get() = std::numeric_limits<real>::lowest();
+            }
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i)
+            {
+                for (int d = 0; d < DIM; ++d)
+                {
+                    if (particles[i].pos[d] < r_min[d].get())
+                    {
+                        r_min[d].get() = particles[i].pos[d];
+                    }
+                    if (particles[i].pos[d] > r_max[d].get())
+                    {
+                        r_max[d].get() = particles[i].pos[d];
+                    }
+                }
+            }
+            for (int d = 0; d < DIM; ++d)
+            {
+                m_range_min[d] = r_min[d].min();
+                m_range_max[d] = r_max[d].max();
+            }
+        }
+
+        const real target = m_max_sml + m_search_margin;
+        int n_cell = 1;
+        for (int d = 0; d < DIM; ++d)
+        {
+            const real range = m_range_max[d] - m_range_min[d];
+            m_cells[d] = std::max(1, static_cast<int>(range / std::max(target, (real)1e-30)));
+            m_cell_edge[d] = range > 0.0 ? range / m_cells[d] : std::max(target, (real)1e-30);
+            n_cell *= m_cells[d];
+        }
+
+        m_head.assign(n_cell, -1);
+        if (static_cast<int>(m_next.size()) < num)
+        {
+            m_next.resize(num);
+        }
+        for (int i = 0; i < num; ++i)
+        {
+            const int c = cell_of(particles[i].pos);
+            m_next[i] = m_head[c];
+            m_head[c] = i;
+        }
+    }
+
+    void CellList::make(std::vector<SPHParticle> &particles, const int particle_num)
+    {
+        m_particles = &particles;
+        m_particle_num = particle_num;
+        build_grid();
+    }
+
+    // PreInteraction updates the smoothing lengths and then calls this; the
+    // grid is rebuilt so the cell edge covers the new largest radius.
+    void CellList::set_kernel()
+    {
+        if (m_particles)
+        {
+            build_grid();
+        }
+    }
+
+    int CellList::neighbor_search(const SPHParticle &p_i, std::vector<int> &neighbor_list, const std::vector<SPHParticle> &particles, const bool is_ij)
+    {
+        const real h = (is_ij ? std::max(p_i.sml, m_max_sml) : p_i.sml) + m_search_margin;
+        const real h2 = h * h;
+        const auto &pos_i = p_i.pos;
+
+        // Cells to scan per dimension: the h-ball around p_i, capped at the
+        // grid size so periodic wrapping never visits a cell twice.
+        int base[DIM];
+        int span[DIM];
+        for (int d = 0; d < DIM; ++d)
+        {
+            const int width = static_cast<int>(h / m_cell_edge[d]) + 1;
+            base[d] = static_cast<int>((pos_i[d] - m_range_min[d]) / m_cell_edge[d]) - width;
+            span[d] = std::min(2 * width + 1, m_cells[d]);
+            if (!m_is_periodic)
+            {
+                // keep the scan window on the grid when the ball pokes out
+                base[d] = std::max(0, std::min(base[d], m_cells[d] - span[d]));
+            }
+        }
+
+        int n_neighbor = 0;
+        const int list_size = static_cast<int>(neighbor_list.size());
+
+        // Distance ordering is part of the neighbor_search contract; keep
+        // the r^2 from each acceptance test as the sort key so the ordering
+        // costs no second pass over the periodic separations.
+        static thread_local std::vector<std::pair<real, int>> keyed;
+        keyed.resize(list_size);
+
+        int offset[DIM] = {0};
+        while (true)
+        {
+            // map the offset cell into the grid (wrap when periodic)
+            int index = 0;
+            bool inside = true;
+            for (int d = 0; d < DIM; ++d)
+            {
+                int c = base[d] + offset[d];
+                if (m_is_periodic)
+                {
+                    c = ((c % m_cells[d]) + m_cells[d]) % m_cells[d];
+                }
+                else if (c < 0 || c >= m_cells[d])
+                {
+                    inside = false;
+                    break;
+                }
+                index = index * m_cells[d] + c;
+            }
+
+            if (inside)
+            {
+                for (int j = m_head[index]; j != -1; j = m_next[j])
+                {
+                    const vec_t r_ij = m_periodic->calc_r_ij(pos_i, particles[j].pos);
+                    const real r2 = abs2(r_ij);
+                    if (r2 < h2)
+                    {
+                        if (n_neighbor < list_size)
+                        {
+                            keyed[n_neighbor] = std::make_pair(r2, j);
+                            ++n_neighbor;
+                        }
+                        else
+                        {
+                            EventCounters::count(EventCounters::NEIGHBOR_LIST_OVERFLOW);
+                        }
+                    }
+                }
+            }
+
+            // advance the DIM-dimensional offset counter
+            int d = DIM - 1;
+            while (d >= 0 && offset[d] == span[d] - 1)
+            {
+                offset[d] = 0;
+                --d;
+            }
+            if (d < 0)
+            {
+                break;
+            }
+            ++offset[d];
+        }
+
+        std::sort(keyed.begin(), keyed.begin() + n_neighbor);
+        for (int n = 0; n < n_neighbor; ++n)
+        {
+            neighbor_list[n] = keyed[n].second;
+        }
+        return n_neighbor;
+    }
+
+    void CellList::tree_force(SPHParticle &p_i)
+    {
+        THROW_ERROR("CellList::tree_force: the cell-list engine has no tree gravity.");
+    }
+
+}
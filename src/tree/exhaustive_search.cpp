@@ -1,8 +1,10 @@
 ﻿#include <algorithm>
+#include <cmath>
 
 #include "utilities/vector_type.hpp"
 #include "core/particle.hpp"
 #include "utilities/periodic.hpp"
+#include "utilities/event_counters.hpp"
 #include "tree/exhaustive_search.hpp"
 
 namespace sph {
@@ -20,23 +22,84 @@ int exhaustive_search(
 {
     const real kernel_size_i2 = kernel_size * kernel_size;
     const vec_t & pos_i = p_i.pos;
-    int count = 0;
-    for(int j = 0; j < num; ++j) {
-        const auto & p_j = particles[j];
-        const vec_t r_ij = periodic->calc_r_ij(pos_i, p_j.pos);
-        const real r2 = abs2(r_ij);
-        const real kernel_size2 = is_ij ? std::max(kernel_size_i2, p_j.sml * p_j.sml) : kernel_size_i2;
-        if(r2 < kernel_size2) {
-            neighbor_list[count] = j;
-            ++count;
+
+    // Blocked SIMD scan: positions are staged into contiguous per-dimension
+    // buffers, the squared distances come out of one branch-free simd loop
+    // (minimum image via round instead of the three-way compare in
+    // calc_r_ij), and a scalar compress keeps the accepted candidates in
+    // ascending index order, so results stay deterministic.
+    const bool min_image = periodic->min_image();
+    vec_t range(0.0), inv_range(0.0);
+    if(min_image) {
+        range = periodic->range();
+        for(int d = 0; d < DIM; ++d) {
+            inv_range[d] = 1.0 / range[d];
+        }
+    }
+
+    constexpr int block_size = 256;
+    real pos_buf[DIM][block_size];
+    real sml2_buf[block_size];
+    real r2_buf[block_size];
+
+    // The scan already derives r^2 per candidate; keep it alongside the index
+    // so the distance sort does not recompute the periodic separation.
+    static thread_local std::vector<std::pair<real, int>> keyed;
+    keyed.clear();
+    for(int j0 = 0; j0 < num; j0 += block_size) {
+        const int n = std::min(block_size, num - j0);
+        for(int k = 0; k < n; ++k) {
+            const auto & p_j = particles[j0 + k];
+            for(int d = 0; d < DIM; ++d) {
+                pos_buf[d][k] = p_j.pos[d];
+            }
+            if(is_ij) {
+                sml2_buf[k] = p_j.sml * p_j.sml;
+            }
+        }
+
+        if(min_image) {
+#pragma omp simd
+            for(int k = 0; k < n; ++k) {
+                real r2 = 0.0;
+                for(int d = 0; d < DIM; ++d) {
+                    real dx = pos_i[d] - pos_buf[d][k];
+                    dx -= range[d] * std::round(dx * inv_range[d]);
+                    r2 += dx * dx;
+                }
+                r2_buf[k] = r2;
+            }
+        } else {
+#pragma omp simd
+            for(int k = 0; k < n; ++k) {
+                real r2 = 0.0;
+                for(int d = 0; d < DIM; ++d) {
+                    const real dx = pos_i[d] - pos_buf[d][k];
+                    r2 += dx * dx;
+                }
+                r2_buf[k] = r2;
+            }
+        }
+
+        for(int k = 0; k < n; ++k) {
+            const real kernel_size2 = is_ij ? std::max(kernel_size_i2, sml2_buf[k]) : kernel_size_i2;
+            if(r2_buf[k] < kernel_size2) {
+                keyed.emplace_back(r2_buf[k], j0 + k);
+            }
         }
     }
 
-    std::sort(neighbor_list.begin(), neighbor_list.begin() + count, [&](const int a, const int b) {
-        const vec_t r_ia = periodic->calc_r_ij(pos_i, particles[a].pos);
-        const vec_t r_ib = periodic->calc_r_ij(pos_i, particles[b].pos);
-        return abs2(r_ia) < abs2(r_ib);
-    });
+    const int count = static_cast<int>(keyed.size());
+    // grow the caller's list instead of writing past the end
+    if(count > static_cast<int>(neighbor_list.size())) {
+        EventCounters::count(EventCounters::NEIGHBOR_LIST_GROWN);
+        neighbor_list.resize(count);
+    }
+
+    std::sort(keyed.begin(), keyed.end());
+    for(int n = 0; n < count; ++n) {
+        neighbor_list[n] = keyed[n].second;
+    }
 
     return count;
 }
@@ -6,6 +6,8 @@ namespace sph {
 
 // Initialize static constants
 constexpr char CheckpointData::MAGIC[9];
+constexpr char CheckpointData::DELTA_MAGIC[9];
+constexpr char CheckpointData::DERIVED_MAGIC[9];
 
 bool CheckpointData::is_valid() const {
     // Check basic validity
@@ -70,7 +72,7 @@ size_t CheckpointData::get_total_size() const {
     size += 3000;  // Conservative estimate
     
     // Particle data
-    size += particles.size() * sizeof(SPHParticle);
+    size += particles.size() * sizeof(CompactCheckpointParticle);
     
     // Checksum
     size += CHECKSUM_SIZE;  // 32 bytes SHA-256
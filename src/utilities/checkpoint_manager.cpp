@@ -1,4 +1,9 @@
 #include "utilities/checkpoint_manager.hpp"
+#include "utilities/mapped_file_writer.hpp"
+#include "utilities/memory_footprint.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstring>
 #include <chrono>
 #include <iomanip>
@@ -7,10 +12,138 @@
 #include <boost/filesystem.hpp>
 #include <openssl/sha.h>
 
+#ifndef _WIN32
+#define SPH_CHECKPOINT_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace fs = boost::filesystem;
 
 namespace sph {
 
+namespace {
+
+/// ISO 8601 timestamp with millisecond precision (checkpoint headers)
+std::string iso8601_now() {
+    auto now = std::chrono::system_clock::now();
+    auto time_t_now = std::chrono::system_clock::to_time_t(now);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()
+    ) % 1000;
+
+    std::ostringstream oss;
+    oss << std::put_time(std::gmtime(&time_t_now), "%Y-%m-%dT%H:%M:%S")
+        << '.' << std::setfill('0') << std::setw(3) << ms.count() << 'Z';
+    return oss.str();
+}
+
+/// Chunk size the checkpoint checksum is computed over (see checkpoint_data.hpp)
+constexpr size_t kHashChunkSize = CheckpointData::HASH_CHUNK_SIZE;
+
+/// Chunked SHA-256: hash fixed-size chunks in parallel, then hash the
+/// concatenated chunk digests. This is the v4 checkpoint checksum; a
+/// single serial SHA-256 pass dominated save/load latency for multi-GB
+/// checkpoints.
+std::vector<uint8_t> chunked_sha256(const char* data, size_t size) {
+    const int64_t num_chunks =
+        static_cast<int64_t>((size + kHashChunkSize - 1) / kHashChunkSize);
+    std::vector<uint8_t> digests(num_chunks * SHA256_DIGEST_LENGTH);
+
+#pragma omp parallel for
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        const size_t offset = static_cast<size_t>(c) * kHashChunkSize;
+        SHA256_CTX ctx;
+        SHA256_Init(&ctx);
+        SHA256_Update(&ctx, data + offset, std::min(kHashChunkSize, size - offset));
+        SHA256_Final(digests.data() + c * SHA256_DIGEST_LENGTH, &ctx);
+    }
+
+    std::vector<uint8_t> hash(SHA256_DIGEST_LENGTH);
+    SHA256_CTX root;
+    SHA256_Init(&root);
+    SHA256_Update(&root, digests.data(), digests.size());
+    SHA256_Final(hash.data(), &root);
+    return hash;
+}
+
+/// First 8 bytes of a checksum as lower-case hex (registry digest column)
+std::string digest_hex(const std::vector<uint8_t>& hash) {
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0');
+    for (size_t i = 0; i < 8 && i < hash.size(); ++i) {
+        oss << std::setw(2) << static_cast<int>(hash[i]);
+    }
+    return oss.str();
+}
+
+/// One diffable SPHParticle field (or vector component) for delta encoding
+struct DeltaField {
+    size_t offset;   ///< byte offset inside SPHParticle
+    uint32_t size;   ///< byte size of the field
+    bool is_real;    ///< compared with the relative tolerance (exact bytes otherwise)
+};
+
+/// Fixed field table the delta format is written and replayed in. Every
+/// persistent SPHParticle field appears here.
+const std::vector<DeltaField>& delta_field_table() {
+    static const std::vector<DeltaField> table = [] {
+        std::vector<DeltaField> f;
+        auto add_real = [&f](size_t offset) {
+            f.push_back({offset, sizeof(real), true});
+        };
+        auto add_vec = [&f, &add_real](size_t offset) {
+            for (int d = 0; d < DIM; ++d) {
+                add_real(offset + d * sizeof(real));
+            }
+        };
+        auto add_raw = [&f](size_t offset, uint32_t size) {
+            f.push_back({offset, size, false});
+        };
+
+        add_vec(offsetof(SPHParticle, pos));
+        add_vec(offsetof(SPHParticle, vel));
+        add_real(offsetof(SPHParticle, mass));
+        add_real(offsetof(SPHParticle, dens));
+        add_real(offsetof(SPHParticle, pres));
+        add_real(offsetof(SPHParticle, ene));
+        add_real(offsetof(SPHParticle, sml));
+        add_real(offsetof(SPHParticle, sound));
+        add_real(offsetof(SPHParticle, balsara));
+        add_real(offsetof(SPHParticle, alpha));
+        add_real(offsetof(SPHParticle, gradh));
+        add_real(offsetof(SPHParticle, volume));
+        add_real(offsetof(SPHParticle, q));
+        add_raw(offsetof(SPHParticle, is_point_mass), sizeof(bool));
+        add_raw(offsetof(SPHParticle, is_wall), sizeof(bool));
+        add_raw(offsetof(SPHParticle, is_active), sizeof(bool));
+        add_vec(offsetof(SPHParticle, vel_p));
+        add_vec(offsetof(SPHParticle, acc));
+        add_real(offsetof(SPHParticle, ene_p));
+        add_real(offsetof(SPHParticle, dene));
+        add_real(offsetof(SPHParticle, h_dot));
+        add_raw(offsetof(SPHParticle, id), sizeof(int));
+        add_raw(offsetof(SPHParticle, neighbor), sizeof(int));
+        add_raw(offsetof(SPHParticle, dt_bin), sizeof(int));
+        add_real(offsetof(SPHParticle, phi));
+        add_raw(offsetof(SPHParticle, ene_floored), sizeof(int));
+        add_real(offsetof(SPHParticle, shockSensor));
+        add_raw(offsetof(SPHParticle, shockMode), sizeof(int));
+        add_raw(offsetof(SPHParticle, oldShockMode), sizeof(int));
+        add_real(offsetof(SPHParticle, shock_ref_dens));
+        add_real(offsetof(SPHParticle, shock_ref_pres));
+        add_raw(offsetof(SPHParticle, shock_ref_neighbor), sizeof(int));
+        add_raw(offsetof(SPHParticle, switch_to_no_shock_region), sizeof(bool));
+        add_real(offsetof(SPHParticle, target_rho));
+        return f;
+    }();
+    return table;
+}
+
+} // anonymous namespace
+
 CheckpointManager::CheckpointManager()
     : last_checkpoint_time_(0.0) {
     config_.enabled = false;
@@ -27,7 +160,19 @@ void CheckpointManager::save_checkpoint(
 ) {
     // Workaround for const-correctness: Simulation getters return non-const references
     Simulation& sim = const_cast<Simulation&>(sim_const);
-    
+
+    // Delta mode: diff against the keyframe while the chain is short enough
+    // and the particle count still matches (a full keyframe otherwise)
+    if (config_.delta_enabled &&
+        !keyframe_particles_.empty() &&
+        keyframe_particles_.size() == sim.get_particles().size() &&
+        checkpoints_since_keyframe_ < config_.keyframe_interval - 1) {
+        save_delta_checkpoint(filepath, sim.get_particles(), sim_const);
+        ++checkpoints_since_keyframe_;
+        delta_keyframe_of_[filepath] = keyframe_path_;
+        return;
+    }
+
     // Create checkpoint data
     CheckpointData data;
     data.time = sim.get_time();
@@ -50,53 +195,273 @@ void CheckpointManager::save_checkpoint(
     data.dimension = DIM;
     
     // Generate timestamp (ISO 8601)
-    auto now = std::chrono::system_clock::now();
-    auto time_t_now = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()
-    ) % 1000;
-    
-    std::ostringstream oss;
-    oss << std::put_time(std::gmtime(&time_t_now), "%Y-%m-%dT%H:%M:%S")
-        << '.' << std::setfill('0') << std::setw(3) << ms.count() << 'Z';
-    data.created_at = oss.str();
-    
-    // Open file for binary writing
+    data.created_at = iso8601_now();
+
+    // Assemble the file image in memory: the checksum chunks hash in
+    // parallel straight from the image, with no read-back pass over the
+    // file that the serial implementation needed
+    std::vector<char> file_image;
+    file_image.reserve(data.get_total_size());
+    write_header(file_image, data);
+    (void)write_parameters(file_image, params);
+    write_particles(file_image, data.particles);
+    (void)write_derived(file_image, sim_const);
+    MemoryFootprint::set("checkpoint_staging", file_image.capacity());
+
+    // Mapped large-write path: the image and checksum go straight into the
+    // ftruncated mapping and the pages are dropped afterwards, so a multi-GB
+    // checkpoint does not evict the particle working set (see
+    // mapped_file_writer.hpp).
+    const auto checksum = compute_sha256(file_image);
+    if (!write_file_mapped(filepath,
+                           {{file_image.data(), file_image.size()},
+                            {checksum.data(), checksum.size()}})) {
+        throw std::runtime_error("Cannot open checkpoint file for writing: " + filepath);
+    }
+
+    RegistryEntry entry;
+    entry.name = fs::path(filepath).filename().string();
+    entry.step = data.step;
+    entry.time = data.time;
+    entry.size = file_image.size() + CheckpointData::CHECKSUM_SIZE;
+    entry.digest = digest_hex(checksum);
+    registry_append(filepath, '+', entry);
+
+    // This full file becomes the keyframe the next deltas diff against
+    if (config_.delta_enabled) {
+        keyframe_particles_ = data.particles;
+        keyframe_path_ = filepath;
+        checkpoints_since_keyframe_ = 0;
+    }
+}
+
+void CheckpointManager::save_checkpoint_fast(
+    const std::string& filepath,
+    const Simulation& sim_const,
+    const SPHParameters& params
+) {
+    Simulation& sim = const_cast<Simulation&>(sim_const);
+    const std::vector<SPHParticle>& particles = sim.get_particles();
+
+    // Header metadata only; the particle vector is never copied — the
+    // compact records pack straight from the live array below
+    CheckpointData data;
+    data.time = sim.get_time();
+    data.dt = sim.get_dt();
+    data.step = 0;
+    data.params = std::make_shared<SPHParameters>(params);
+    data.simulation_name = "simulation";
+    switch (params.type) {
+        case SPHType::SSPH: data.sph_type = "SSPH"; break;
+        case SPHType::DISPH: data.sph_type = "DISPH"; break;
+        case SPHType::GSPH: data.sph_type = "GSPH"; break;
+        case SPHType::GDISPH: data.sph_type = "GDISPH"; break;
+        default: data.sph_type = "UNKNOWN"; break;
+    }
+    data.dimension = DIM;
+    data.created_at = iso8601_now();
+
+    std::vector<char> file_image;
+    file_image.reserve(CheckpointData::HEADER_SIZE + 4096 +
+                       particles.size() * sizeof(CompactCheckpointParticle));
+    write_header(file_image, data);
+    // write_header saw the empty staging vector; patch the particle count
+    // in place (same fixed-offset convention as the params_size patch)
+    const int64_t particle_count = static_cast<int64_t>(particles.size());
+    std::memcpy(file_image.data() + 296, &particle_count, sizeof(particle_count));
+    (void)write_parameters(file_image, params);
+    write_particles(file_image, particles);
+    // No derived section: its size field in the reserved header space stays
+    // zero and the restore falls back to the full recompute
+
+    const auto checksum = compute_sha256(file_image);
+    if (!write_file_mapped(filepath,
+                           {{file_image.data(), file_image.size()},
+                            {checksum.data(), checksum.size()}})) {
+        throw std::runtime_error("Cannot open checkpoint file for writing: " + filepath);
+    }
+
+    RegistryEntry entry;
+    entry.name = fs::path(filepath).filename().string();
+    entry.step = data.step;
+    entry.time = data.time;
+    entry.size = file_image.size() + CheckpointData::CHECKSUM_SIZE;
+    entry.digest = digest_hex(checksum);
+    registry_append(filepath, '+', entry);
+}
+
+std::vector<char> CheckpointManager::build_collective_preamble(
+    const Simulation& sim_const,
+    const SPHParameters& params,
+    const int64_t global_particle_count
+) {
+    Simulation& sim = const_cast<Simulation&>(sim_const);
+
+    // Header metadata in the fast-flush schema: no staged particle copy,
+    // no derived section (the restore recomputes it)
+    CheckpointData data;
+    data.time = sim.get_time();
+    data.dt = sim.get_dt();
+    data.step = 0;
+    data.params = std::make_shared<SPHParameters>(params);
+    data.simulation_name = "simulation";
+    switch (params.type) {
+        case SPHType::SSPH: data.sph_type = "SSPH"; break;
+        case SPHType::DISPH: data.sph_type = "DISPH"; break;
+        case SPHType::GSPH: data.sph_type = "GSPH"; break;
+        case SPHType::GDISPH: data.sph_type = "GDISPH"; break;
+        default: data.sph_type = "UNKNOWN"; break;
+    }
+    data.dimension = DIM;
+    data.created_at = iso8601_now();
+
+    std::vector<char> preamble;
+    write_header(preamble, data);
+    // write_header saw the empty staging vector; patch the global particle
+    // count in place (same fixed-offset convention as the params_size patch)
+    std::memcpy(preamble.data() + 296, &global_particle_count, sizeof(global_particle_count));
+    (void)write_parameters(preamble, params);
+    return preamble;
+}
+
+void CheckpointManager::append_particle_records(
+    std::vector<char>& image,
+    const std::vector<SPHParticle>& particles
+) {
+    write_particles(image, particles);
+}
+
+void CheckpointManager::record_collective_save(
+    const std::string& filepath,
+    const double time,
+    const uint64_t file_size,
+    const std::vector<uint8_t>& checksum
+) {
+    RegistryEntry entry;
+    entry.name = fs::path(filepath).filename().string();
+    entry.step = 0;
+    entry.time = time;
+    entry.size = file_size;
+    entry.digest = digest_hex(checksum);
+    registry_append(filepath, '+', entry);
+}
+
+void CheckpointManager::save_delta_checkpoint(
+    const std::string& filepath,
+    const std::vector<SPHParticle>& particles,
+    const Simulation& sim_const
+) {
+    Simulation& sim = const_cast<Simulation&>(sim_const);
+    const int64_t num = static_cast<int64_t>(particles.size());
+    const auto& fields = delta_field_table();
+    const real tolerance = config_.delta_tolerance;
+
+    // Encode one override block per field, in parallel: particles whose
+    // field drifted beyond the relative tolerance since the keyframe
+    std::vector<std::vector<char>> blocks(fields.size());
+#pragma omp parallel for
+    for (int64_t f = 0; f < static_cast<int64_t>(fields.size()); ++f) {
+        const DeltaField& field = fields[f];
+        std::vector<char>& block = blocks[f];
+        block.resize(sizeof(int64_t));  // override count, patched below
+        int64_t count = 0;
+
+        for (int64_t i = 0; i < num; ++i) {
+            const char* current = reinterpret_cast<const char*>(&particles[i]) + field.offset;
+            const char* keyframe = reinterpret_cast<const char*>(&keyframe_particles_[i]) + field.offset;
+
+            bool changed;
+            if (field.is_real) {
+                real v, k;
+                std::memcpy(&v, current, sizeof(real));
+                std::memcpy(&k, keyframe, sizeof(real));
+                changed = std::abs(v - k) > tolerance * std::max(std::abs(v), std::abs(k));
+            } else {
+                changed = std::memcmp(current, keyframe, field.size) != 0;
+            }
+
+            if (changed) {
+                const int32_t index = static_cast<int32_t>(i);
+                block.insert(block.end(),
+                             reinterpret_cast<const char*>(&index),
+                             reinterpret_cast<const char*>(&index) + sizeof(index));
+                block.insert(block.end(), current, current + field.size);
+                ++count;
+            }
+        }
+        std::memcpy(block.data(), &count, sizeof(count));
+    }
+
+    // Header (layout documented in checkpoint_data.hpp)
+    std::vector<char> file_data(CheckpointData::HEADER_SIZE, 0);
+    char* header = file_data.data();
+    size_t offset = 0;
+
+    std::memcpy(header + offset, CheckpointData::DELTA_MAGIC, 8);
+    offset += 8;
+
+    const uint32_t version = CheckpointData::DELTA_FORMAT_VERSION;
+    std::memcpy(header + offset, &version, sizeof(version));
+    offset += 4;
+
+    const int32_t dim = DIM;
+    std::memcpy(header + offset, &dim, sizeof(dim));
+    offset += 4;
+
+    std::strncpy(header + offset, iso8601_now().c_str(), 63);
+    offset += 64;
+
+    // Keyframe file name, resolved against the delta's directory on load
+    const std::string keyframe_name = fs::path(keyframe_path_).filename().string();
+    std::strncpy(header + offset, keyframe_name.c_str(), 127);
+    offset += 128;
+
+    offset += 64;  // sph_type slot: restore takes it from the keyframe
+
+    const double time = sim.get_time();
+    std::memcpy(header + offset, &time, sizeof(time));
+    offset += 8;
+
+    const double dt = sim.get_dt();
+    std::memcpy(header + offset, &dt, sizeof(dt));
+    offset += 8;
+
+    const int64_t step = 0;
+    std::memcpy(header + offset, &step, sizeof(step));
+    offset += 8;
+
+    std::memcpy(header + offset, &num, sizeof(num));
+    offset += 8;
+
+    const int64_t field_count = static_cast<int64_t>(fields.size());
+    std::memcpy(header + offset, &field_count, sizeof(field_count));
+    offset += 8;
+
+    const double tol = tolerance;
+    std::memcpy(header + offset, &tol, sizeof(tol));
+
+    for (const auto& block : blocks) {
+        file_data.insert(file_data.end(), block.begin(), block.end());
+    }
+
     std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
     if (!file.is_open()) {
         throw std::runtime_error("Cannot open checkpoint file for writing: " + filepath);
     }
-    
-    // Collect all data for checksum calculation
-    std::vector<char> all_data;
-    
-    // Write header
-    write_header(file, data);
-    
-    // Write parameters (unused variable warning fixed by using void cast)
-    (void)write_parameters(file, params);
-    
-    // Write particles
-    write_particles(file, data.particles);
-    
-    // Read back all data for checksum
+    file.write(file_data.data(), file_data.size());
+    const auto checksum = write_checksum(file, file_data);
     file.close();
-    std::ifstream read_file(filepath, std::ios::binary);
-    read_file.seekg(0, std::ios::end);
-    size_t file_size = read_file.tellg();
-    read_file.seekg(0, std::ios::beg);
-    
-    all_data.resize(file_size);
-    read_file.read(all_data.data(), file_size);
-    read_file.close();
-    
-    // Write checksum
-    std::ofstream append_file(filepath, std::ios::binary | std::ios::app);
-    write_checksum(append_file, all_data);
-    append_file.close();
+
+    RegistryEntry entry;
+    entry.name = fs::path(filepath).filename().string();
+    entry.time = time;
+    entry.size = file_data.size() + CheckpointData::CHECKSUM_SIZE;
+    entry.parent = keyframe_name;
+    entry.digest = digest_hex(checksum);
+    registry_append(filepath, '+', entry);
 }
 
-void CheckpointManager::write_header(std::ofstream& file, const CheckpointData& data) {
+void CheckpointManager::write_header(std::vector<char>& image, const CheckpointData& data) {
     // Create 512-byte header buffer (initialized to zeros)
     char header[CheckpointData::HEADER_SIZE] = {0};
     
@@ -154,12 +519,12 @@ void CheckpointManager::write_header(std::ofstream& file, const CheckpointData&
     offset += 8;
     
     // Reserved space (200 bytes) - already zeroed
-    
-    // Write header to file
-    file.write(header, CheckpointData::HEADER_SIZE);
+
+    // Append header to the file image
+    image.insert(image.end(), header, header + CheckpointData::HEADER_SIZE);
 }
 
-size_t CheckpointManager::write_parameters(std::ofstream& file, const SPHParameters& params) {
+size_t CheckpointManager::write_parameters(std::vector<char>& image, const SPHParameters& params) {
     // Serialize parameters to JSON
     // For now, write a simple JSON representation
     // TODO: Use proper JSON library (nlohmann/json) in production
@@ -181,59 +546,389 @@ size_t CheckpointManager::write_parameters(std::ofstream& file, const SPHParamet
     json << "}\n";
     
     std::string json_str = json.str();
-    
-    // Write JSON size
+
+    // Append JSON size and data
     int64_t json_size = static_cast<int64_t>(json_str.size());
-    file.write(reinterpret_cast<const char*>(&json_size), sizeof(json_size));
-    
-    // Write JSON data
-    file.write(json_str.c_str(), json_str.size());
-    
-    // Update header with actual params size
-    // Go back and update the params_size field in header
-    auto current_pos = file.tellp();
-    file.seekp(304);  // Offset to params_size field
-    file.write(reinterpret_cast<const char*>(&json_size), sizeof(json_size));
-    file.seekp(current_pos);  // Return to current position
-    
+    image.insert(image.end(),
+                 reinterpret_cast<const char*>(&json_size),
+                 reinterpret_cast<const char*>(&json_size) + sizeof(json_size));
+    image.insert(image.end(), json_str.begin(), json_str.end());
+
+    // Patch the params_size field of the header at the front of the image
+    std::memcpy(image.data() + 304, &json_size, sizeof(json_size));
+
     return sizeof(json_size) + json_str.size();
 }
 
-void CheckpointManager::write_particles(std::ofstream& file, const std::vector<SPHParticle>& particles) {
-    // Write particle data as binary array
-    if (!particles.empty()) {
-        file.write(
-            reinterpret_cast<const char*>(particles.data()),
-            particles.size() * sizeof(SPHParticle)
-        );
+void CheckpointManager::write_particles(std::vector<char>& image, const std::vector<SPHParticle>& particles) {
+    // Append the v5 compact records: only the true state goes to disk, the
+    // derived fields are recomputed on restore (see checkpoint_data.hpp)
+    if (particles.empty()) {
+        return;
+    }
+    const size_t base = image.size();
+    const int64_t num = static_cast<int64_t>(particles.size());
+    image.resize(base + num * sizeof(CompactCheckpointParticle));
+    CompactCheckpointParticle* records =
+        reinterpret_cast<CompactCheckpointParticle*>(image.data() + base);
+#pragma omp parallel for
+    for (int64_t i = 0; i < num; ++i) {
+        records[i].pack(particles[i]);
     }
 }
 
-void CheckpointManager::write_checksum(std::ofstream& file, const std::vector<char>& data) {
+size_t CheckpointManager::write_derived(std::vector<char>& image, const Simulation& sim_const) {
+    // Warm-restart section (see DerivedState in checkpoint_data.hpp): the
+    // derived fields the restore would otherwise recompute, packed after the
+    // particle records. Its size goes into the header's reserved space at
+    // offset 312, so files written before this section existed read as zero
+    // and older readers see it as trailing particle bytes they never reach
+    // (they trust the compact-record stride, not the section size).
+    Simulation& sim = const_cast<Simulation&>(sim_const);
+    const size_t base = image.size();
+
+    const auto append = [&image](const void* src, size_t bytes) {
+        const char* p = static_cast<const char*>(src);
+        image.insert(image.end(), p, p + bytes);
+    };
+
+    append(CheckpointData::DERIVED_MAGIC, 8);
+    const uint32_t version = CheckpointData::DERIVED_FORMAT_VERSION;
+    append(&version, sizeof(version));
+
+    const NeighborCache& cache = sim.get_neighbor_cache();
+    const uint32_t flags = cache.is_valid() ? 1u : 0u;
+    append(&flags, sizeof(flags));
+
+    const double h_per_v_sig = sim.get_h_per_v_sig();
+    append(&h_per_v_sig, sizeof(h_per_v_sig));
+
+    const auto& particles = sim.get_particles();
+    const int64_t num = static_cast<int64_t>(particles.size());
+    append(&num, sizeof(num));
+
+    // Per-particle derived records, packed in parallel like the particles
+    {
+        const size_t records_base = image.size();
+        image.resize(records_base + num * sizeof(DerivedParticleRecord));
+        DerivedParticleRecord* records =
+            reinterpret_cast<DerivedParticleRecord*>(image.data() + records_base);
+#pragma omp parallel for
+        for (int64_t i = 0; i < num; ++i) {
+            records[i].pack(particles[i]);
+        }
+    }
+
+    // Neighbor-list CSR cache (int32 values, like the delta override indices)
+    if (flags & 1u) {
+        const int64_t offset_count = static_cast<int64_t>(cache.offsets().size());
+        append(&offset_count, sizeof(offset_count));
+        append(cache.offsets().data(), offset_count * sizeof(int));
+        const int64_t index_count = static_cast<int64_t>(cache.indices().size());
+        append(&index_count, sizeof(index_count));
+        append(cache.indices().data(), index_count * sizeof(int));
+    }
+
+    // Named additional arrays (e.g. the GSPH MUSCL gradients), in handle
+    // order; vectors are flattened to DIM reals per entry
+    const auto append_name = [&](const std::string& name) {
+        const uint32_t name_len = static_cast<uint32_t>(name.size());
+        append(&name_len, sizeof(name_len));
+        append(name.data(), name_len);
+    };
+
+    const auto scalar_names = sim.scalar_array_names();
+    const int32_t scalar_count = static_cast<int32_t>(scalar_names.size());
+    append(&scalar_count, sizeof(scalar_count));
+    for (const auto& name : scalar_names) {
+        append_name(name);
+        const auto& values = sim.get_scalar_array(name);
+        const int64_t value_count = static_cast<int64_t>(values.size());
+        append(&value_count, sizeof(value_count));
+        append(values.data(), value_count * sizeof(real));
+    }
+
+    const auto vector_names = sim.vector_array_names();
+    const int32_t vector_count = static_cast<int32_t>(vector_names.size());
+    append(&vector_count, sizeof(vector_count));
+    for (const auto& name : vector_names) {
+        append_name(name);
+        const auto& values = sim.get_vector_array(name);
+        const int64_t value_count = static_cast<int64_t>(values.size());
+        append(&value_count, sizeof(value_count));
+        for (int64_t i = 0; i < value_count; ++i) {
+            for (int d = 0; d < DIM; ++d) {
+                const real component = values[i][d];
+                append(&component, sizeof(component));
+            }
+        }
+    }
+
+    // Patch the derived_size field of the header at the front of the image
+    const int64_t derived_size = static_cast<int64_t>(image.size() - base);
+    std::memcpy(image.data() + 312, &derived_size, sizeof(derived_size));
+
+    return static_cast<size_t>(derived_size);
+}
+
+std::vector<uint8_t> CheckpointManager::write_checksum(std::ofstream& file, const std::vector<char>& data) {
     // Compute SHA-256 hash
     auto hash = compute_sha256(data);
-    
+
     // Write hash to file
     file.write(reinterpret_cast<const char*>(hash.data()), hash.size());
+    return hash;
 }
 
 std::vector<uint8_t> CheckpointManager::compute_sha256(const std::vector<char>& data) {
-    std::vector<uint8_t> hash(SHA256_DIGEST_LENGTH);
-    
-    SHA256_CTX sha256;
-    SHA256_Init(&sha256);
-    SHA256_Update(&sha256, data.data(), data.size());
-    SHA256_Final(hash.data(), &sha256);
-    
-    return hash;
+    return chunked_sha256(data.data(), data.size());
 }
 
 CheckpointData CheckpointManager::load_checkpoint(const std::string& filepath) {
+    // A directory means "the newest checkpoint registered in it"
+    if (fs::is_directory(filepath)) {
+        const std::string latest = find_latest_checkpoint(filepath);
+        if (latest.empty()) {
+            throw std::runtime_error("No checkpoints registered in directory: " + filepath);
+        }
+        return load_checkpoint(latest);
+    }
+
     // Check file exists
     if (!fs::exists(filepath)) {
         throw std::runtime_error("Checkpoint file does not exist: " + filepath);
     }
-    
+
+    // Sniff the magic: delta checkpoints replay their keyframe first
+    {
+        std::ifstream file(filepath, std::ios::binary);
+        char magic[8] = {0};
+        file.read(magic, 8);
+        if (file.good() && std::memcmp(magic, CheckpointData::DELTA_MAGIC, 8) == 0) {
+            return load_delta_checkpoint(filepath);
+        }
+    }
+
+#ifdef SPH_CHECKPOINT_USE_MMAP
+    return load_checkpoint_mmap(filepath);
+#else
+    return load_checkpoint_stream(filepath);
+#endif
+}
+
+CheckpointData CheckpointManager::load_delta_checkpoint(const std::string& filepath) {
+    // Deltas are small; read the whole file and verify before parsing
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open checkpoint file for reading: " + filepath);
+    }
+    file.seekg(0, std::ios::end);
+    const size_t file_size = static_cast<size_t>(file.tellg());
+    if (file_size < CheckpointData::HEADER_SIZE + CheckpointData::CHECKSUM_SIZE) {
+        throw std::runtime_error("Checkpoint file too small - appears to be truncated: " + filepath);
+    }
+    file.seekg(0, std::ios::beg);
+    std::vector<char> file_data(file_size - CheckpointData::CHECKSUM_SIZE);
+    file.read(file_data.data(), file_data.size());
+    if (!verify_checksum(file, file_data)) {
+        throw std::runtime_error("Checkpoint file checksum verification failed: " + filepath);
+    }
+    file.close();
+
+    // Parse the delta header (layout in checkpoint_data.hpp)
+    const char* header = file_data.data();
+    uint32_t version;
+    std::memcpy(&version, header + 8, sizeof(version));
+    if (version != CheckpointData::DELTA_FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported delta checkpoint format version: " + std::to_string(version));
+    }
+    int32_t dim;
+    std::memcpy(&dim, header + 12, sizeof(dim));
+    if (dim != DIM) {
+        throw std::runtime_error("Delta checkpoint dimension mismatch: " + std::to_string(dim));
+    }
+
+    char timestamp[64];
+    std::strncpy(timestamp, header + 16, 64);
+    timestamp[63] = '\0';
+
+    char keyframe_name[128];
+    std::strncpy(keyframe_name, header + 80, 128);
+    keyframe_name[127] = '\0';
+
+    double time, dt, tolerance;
+    int64_t step, particle_count, field_count;
+    std::memcpy(&time, header + 272, sizeof(time));
+    std::memcpy(&dt, header + 280, sizeof(dt));
+    std::memcpy(&step, header + 288, sizeof(step));
+    std::memcpy(&particle_count, header + 296, sizeof(particle_count));
+    std::memcpy(&field_count, header + 304, sizeof(field_count));
+    std::memcpy(&tolerance, header + 312, sizeof(tolerance));
+    (void)tolerance;
+
+    const auto& fields = delta_field_table();
+    if (field_count != static_cast<int64_t>(fields.size())) {
+        throw std::runtime_error("Delta checkpoint field table mismatch - file written by an incompatible build");
+    }
+
+    // Load the keyframe and replay the overrides on top of it
+    const std::string keyframe_path =
+        (fs::path(filepath).parent_path() / keyframe_name).string();
+    CheckpointData data = load_checkpoint(keyframe_path);
+    if (static_cast<int64_t>(data.particles.size()) != particle_count) {
+        throw std::runtime_error("Delta checkpoint particle count does not match its keyframe");
+    }
+
+    const char* cursor = file_data.data() + CheckpointData::HEADER_SIZE;
+    const char* const end = file_data.data() + file_data.size();
+    for (const DeltaField& field : fields) {
+        if (cursor + sizeof(int64_t) > end) {
+            throw std::runtime_error("Delta checkpoint body truncated");
+        }
+        int64_t count;
+        std::memcpy(&count, cursor, sizeof(count));
+        cursor += sizeof(count);
+        for (int64_t k = 0; k < count; ++k) {
+            if (cursor + sizeof(int32_t) + field.size > end) {
+                throw std::runtime_error("Delta checkpoint body truncated");
+            }
+            int32_t index;
+            std::memcpy(&index, cursor, sizeof(index));
+            cursor += sizeof(index);
+            if (index < 0 || index >= particle_count) {
+                throw std::runtime_error("Delta checkpoint override index out of range");
+            }
+            char* dst = reinterpret_cast<char*>(&data.particles[index]) + field.offset;
+            std::memcpy(dst, cursor, field.size);
+            cursor += field.size;
+        }
+    }
+
+    // Metadata comes from the delta; parameters stay those of the keyframe
+    data.time = time;
+    data.dt = dt;
+    data.step = step;
+    data.created_at = std::string(timestamp);
+    return data;
+}
+
+#ifdef SPH_CHECKPOINT_USE_MMAP
+namespace {
+
+/// Unmaps a checkpoint mapping on scope exit (including throws).
+struct MappedFile {
+    const char* base = nullptr;
+    size_t size = 0;
+
+    ~MappedFile() {
+        if (base) {
+            munmap(const_cast<char*>(base), size);
+        }
+    }
+};
+
+} // anonymous namespace
+
+CheckpointData CheckpointManager::load_checkpoint_mmap(const std::string& filepath) {
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open checkpoint file for reading: " + filepath);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot stat checkpoint file: " + filepath);
+    }
+
+    MappedFile map;
+    map.size = static_cast<size_t>(st.st_size);
+    if (map.size < CheckpointData::HEADER_SIZE + CheckpointData::CHECKSUM_SIZE) {
+        close(fd);
+        throw std::runtime_error("Checkpoint file too small - appears to be truncated: " + filepath);
+    }
+
+    void* addr = mmap(nullptr, map.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // mapping keeps its own reference
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("Cannot memory-map checkpoint file: " + filepath);
+    }
+    map.base = static_cast<const char*>(addr);
+#ifdef MADV_SEQUENTIAL
+    madvise(addr, map.size, MADV_SEQUENTIAL);
+#endif
+
+    // Verify the checksum before trusting any section sizes beyond the
+    // fixed-size header. The v4 chunked checksum hashes straight from the
+    // mapping with every chunk on its own thread.
+    const size_t data_size = map.size - CheckpointData::CHECKSUM_SIZE;
+    const uint8_t* stored = reinterpret_cast<const uint8_t*>(map.base + data_size);
+    {
+        const std::vector<uint8_t> computed = chunked_sha256(map.base, data_size);
+        if (std::memcmp(computed.data(), stored, SHA256_DIGEST_LENGTH) != 0) {
+            throw std::runtime_error("Checkpoint file checksum verification failed: " + filepath);
+        }
+    }
+
+    CheckpointData data;
+    parse_header(map.base, data);
+
+    // Parameters section: int64 size prefix followed by the JSON text
+    const char* cursor = map.base + CheckpointData::HEADER_SIZE;
+    int64_t json_size;
+    std::memcpy(&json_size, cursor, sizeof(json_size));
+    if (json_size <= 0 || json_size > 1000000 ||
+        CheckpointData::HEADER_SIZE + sizeof(json_size) + static_cast<size_t>(json_size) > data_size) {
+        throw std::runtime_error("Invalid parameters size in checkpoint");
+    }
+    cursor += sizeof(json_size);
+    parse_parameters(cursor, static_cast<size_t>(json_size), data);
+    cursor += json_size;
+
+    // Particle section runs from here to the checksum, minus the optional
+    // derived-state section; expand (v5) or copy (legacy v4) straight from
+    // the mapping in parallel.
+    const size_t section_bytes = data_size - (cursor - map.base);
+    const size_t derived_bytes = static_cast<size_t>(data.derived_size);
+    if (derived_bytes > section_bytes) {
+        throw std::runtime_error("Invalid derived-state size in checkpoint");
+    }
+    const size_t particle_bytes = section_bytes - derived_bytes;
+    if (data.format_version == CheckpointData::FORMAT_VERSION) {
+        const int64_t num_particles =
+            static_cast<int64_t>(particle_bytes / sizeof(CompactCheckpointParticle));
+        data.particles.resize(num_particles);
+        const CompactCheckpointParticle* records =
+            reinterpret_cast<const CompactCheckpointParticle*>(cursor);
+#pragma omp parallel for
+        for (int64_t i = 0; i < num_particles; ++i) {
+            records[i].unpack(data.particles[i]);
+        }
+    } else {
+        const size_t num_particles = particle_bytes / sizeof(SPHParticle);
+        data.particles.resize(num_particles);
+        if (num_particles > 0) {
+            char* dst = reinterpret_cast<char*>(data.particles.data());
+            const size_t copy_bytes = num_particles * sizeof(SPHParticle);
+            constexpr size_t chunk = 8 * 1024 * 1024;
+            const int64_t num_chunks = static_cast<int64_t>((copy_bytes + chunk - 1) / chunk);
+#pragma omp parallel for
+            for (int64_t c = 0; c < num_chunks; ++c) {
+                const size_t off = static_cast<size_t>(c) * chunk;
+                std::memcpy(dst + off, cursor + off, std::min(chunk, copy_bytes - off));
+            }
+        }
+    }
+
+    if (derived_bytes > 0) {
+        parse_derived(cursor + particle_bytes, derived_bytes, data);
+    }
+
+    return data;
+}
+#endif // SPH_CHECKPOINT_USE_MMAP
+
+CheckpointData CheckpointManager::load_checkpoint_stream(const std::string& filepath) {
     // Open file for binary reading
     std::ifstream file(filepath, std::ios::binary);
     if (!file.is_open()) {
@@ -297,21 +992,26 @@ CheckpointValidation CheckpointManager::validate_checkpoint(const std::string& f
     
     CheckpointValidation result = CheckpointValidation::valid();
     
-    // Verify magic number
+    // Verify magic number (full or delta checkpoint)
     char magic[8];
     file.read(magic, 8);
-    if (std::memcmp(magic, CheckpointData::MAGIC, 8) != 0) {
+    const bool is_delta = std::memcmp(magic, CheckpointData::DELTA_MAGIC, 8) == 0;
+    if (!is_delta && std::memcmp(magic, CheckpointData::MAGIC, 8) != 0) {
         result.is_valid = false;
         result.magic_ok = false;
         result.error_message = "Invalid magic number - not a valid checkpoint file";
         return result;
     }
     result.magic_ok = true;
-    
+
     // Verify version
     uint32_t version;
     file.read(reinterpret_cast<char*>(&version), sizeof(version));
-    if (version != CheckpointData::FORMAT_VERSION) {
+    const bool version_supported =
+        is_delta ? version == CheckpointData::DELTA_FORMAT_VERSION
+                 : version == CheckpointData::FORMAT_VERSION ||
+                   version == CheckpointData::FORMAT_VERSION_RAW;
+    if (!version_supported) {
         result.is_valid = false;
         result.version_ok = false;
         result.error_message = "Unsupported checkpoint format version: " + std::to_string(version);
@@ -376,21 +1076,59 @@ std::string CheckpointManager::generate_checkpoint_path(
 
 void CheckpointManager::cleanup_old_checkpoints() {
     while (checkpoint_files_.size() > static_cast<size_t>(config_.max_keep)) {
-        // Remove oldest checkpoint
-        auto oldest = checkpoint_files_.front();
-        checkpoint_files_.pop_front();
-        
+        // Remove the oldest checkpoint that is not the keyframe of a
+        // surviving delta (the deltas are useless without it)
+        auto oldest = checkpoint_files_.end();
+        for (auto it = checkpoint_files_.begin(); it != checkpoint_files_.end(); ++it) {
+            bool referenced = false;
+            for (const auto& entry : delta_keyframe_of_) {
+                if (entry.second == *it) {
+                    referenced = true;
+                    break;
+                }
+            }
+            if (!referenced) {
+                oldest = it;
+                break;
+            }
+        }
+        if (oldest == checkpoint_files_.end()) {
+            break;  // everything left is a pinned keyframe
+        }
+
+        const std::string path = *oldest;
+        checkpoint_files_.erase(oldest);
+        delta_keyframe_of_.erase(path);
+
         // Delete file if it exists
-        if (fs::exists(oldest)) {
-            fs::remove(oldest);
+        if (fs::exists(path)) {
+            fs::remove(path);
         }
+        registry_append(path, '-', RegistryEntry());
     }
 }
 
 void CheckpointManager::record_checkpoint(const std::string& filepath, real time) {
+    // On the first record of a (possibly resumed) run, seed the rotation
+    // list from the registry so max_keep keeps counting checkpoints that
+    // an earlier process of the same run wrote.
+    if (checkpoint_files_.empty()) {
+        const std::string dir = fs::path(filepath).parent_path().string();
+        for (const auto& entry : read_registry(dir)) {
+            const std::string path = (fs::path(dir) / entry.name).string();
+            if (path == filepath) {
+                continue;  // appended by save_checkpoint just before this call
+            }
+            checkpoint_files_.push_back(path);
+            if (!entry.parent.empty()) {
+                delta_keyframe_of_[path] = (fs::path(dir) / entry.parent).string();
+            }
+        }
+    }
+
     last_checkpoint_time_ = time;
     checkpoint_files_.push_back(filepath);
-    
+
     // Cleanup if needed
     if (config_.enabled && config_.max_keep > 0) {
         cleanup_old_checkpoints();
@@ -401,6 +1139,147 @@ std::vector<std::string> CheckpointManager::get_checkpoint_files() const {
     return std::vector<std::string>(checkpoint_files_.begin(), checkpoint_files_.end());
 }
 
+void CheckpointManager::registry_append(const std::string& filepath, char op, const RegistryEntry& entry) {
+    const fs::path path(filepath);
+    const std::string registry = (path.parent_path() / REGISTRY_FILE).string();
+    std::ofstream out(registry, std::ios::app);
+    if (!out.is_open()) {
+        return;  // the registry is an accelerator; a lost record only costs a rebuild
+    }
+
+    if (op == '-') {
+        out << "- " << path.filename().string() << "\n";
+        return;
+    }
+    out << "+ " << path.filename().string()
+        << " " << entry.step
+        << " " << std::setprecision(17) << entry.time
+        << " " << entry.size
+        << " " << (entry.parent.empty() ? "-" : entry.parent)
+        << " " << (entry.digest.empty() ? "-" : entry.digest) << "\n";
+}
+
+std::vector<CheckpointManager::RegistryEntry> CheckpointManager::read_registry(const std::string& directory) {
+    const std::string registry = (fs::path(directory) / REGISTRY_FILE).string();
+    if (!fs::exists(registry)) {
+        rebuild_registry(directory);
+    }
+
+    std::vector<RegistryEntry> entries;
+    std::ifstream in(registry);
+    if (!in.is_open()) {
+        return entries;
+    }
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        std::string op, name;
+        if (!(iss >> op >> name)) {
+            continue;
+        }
+        if (op == "-") {
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (it->name == name) {
+                    entries.erase(it);
+                    break;
+                }
+            }
+            continue;
+        }
+        if (op != "+") {
+            continue;  // unknown record type; skip rather than fail
+        }
+
+        RegistryEntry entry;
+        entry.name = name;
+        iss >> entry.step >> entry.time >> entry.size >> entry.parent >> entry.digest;
+        if (entry.parent == "-") entry.parent.clear();
+        if (entry.digest == "-") entry.digest.clear();
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+void CheckpointManager::rebuild_registry(const std::string& directory) {
+    if (!fs::is_directory(directory)) {
+        return;
+    }
+
+    // One directory scan and one header read per file: this is exactly the
+    // cost the registry exists to avoid, paid only when the index is gone.
+    std::vector<RegistryEntry> entries;
+    for (fs::directory_iterator it(directory), end; it != end; ++it) {
+        if (!fs::is_regular_file(it->status()) || it->path().extension() != ".chk") {
+            continue;
+        }
+
+        std::ifstream file(it->path().string(), std::ios::binary);
+        char header[CheckpointData::HEADER_SIZE] = {0};
+        file.read(header, CheckpointData::HEADER_SIZE);
+        if (!file.good()) {
+            continue;
+        }
+
+        const bool is_delta = std::memcmp(header, CheckpointData::DELTA_MAGIC, 8) == 0;
+        if (!is_delta && std::memcmp(header, CheckpointData::MAGIC, 8) != 0) {
+            continue;  // not a checkpoint file
+        }
+
+        RegistryEntry entry;
+        entry.name = it->path().filename().string();
+        entry.size = static_cast<uint64_t>(fs::file_size(it->path()));
+
+        // Full and delta headers share the time/dt/step offsets; deltas
+        // keep their keyframe file name in the simulation-name slot.
+        double time;
+        std::memcpy(&time, header + 272, sizeof(time));
+        entry.time = time;
+        int64_t step;
+        std::memcpy(&step, header + 288, sizeof(step));
+        entry.step = step;
+        if (is_delta) {
+            char parent[128];
+            std::strncpy(parent, header + 80, 128);
+            parent[127] = '\0';
+            entry.parent = parent;
+        }
+
+        // Digest from the stored trailing checksum — no re-hash
+        if (entry.size >= CheckpointData::HEADER_SIZE + CheckpointData::CHECKSUM_SIZE) {
+            file.seekg(entry.size - CheckpointData::CHECKSUM_SIZE, std::ios::beg);
+            std::vector<uint8_t> checksum(CheckpointData::CHECKSUM_SIZE);
+            file.read(reinterpret_cast<char*>(checksum.data()), checksum.size());
+            if (file.good()) {
+                entry.digest = digest_hex(checksum);
+            }
+        }
+        entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const RegistryEntry& a, const RegistryEntry& b) {
+                  return a.time != b.time ? a.time < b.time : a.name < b.name;
+              });
+
+    const std::string registry = (fs::path(directory) / REGISTRY_FILE).string();
+    std::ofstream(registry, std::ios::trunc).close();
+    for (const auto& entry : entries) {
+        registry_append((fs::path(directory) / entry.name).string(), '+', entry);
+    }
+}
+
+std::string CheckpointManager::find_latest_checkpoint(const std::string& directory) {
+    const auto entries = read_registry(directory);
+    const RegistryEntry* latest = nullptr;
+    for (const auto& entry : entries) {
+        if (!latest || entry.time > latest->time) {
+            latest = &entry;
+        }
+    }
+    return latest ? (fs::path(directory) / latest->name).string() : std::string();
+}
+
 void CheckpointManager::read_header(std::ifstream& file, CheckpointData& data) {
     // Read 512-byte header
     char header[CheckpointData::HEADER_SIZE];
@@ -410,6 +1289,10 @@ void CheckpointManager::read_header(std::ifstream& file, CheckpointData& data) {
         throw std::runtime_error("Failed to read checkpoint header");
     }
     
+    parse_header(header, data);
+}
+
+void CheckpointManager::parse_header(const char* header, CheckpointData& data) {
     size_t offset = 0;
     
     // Verify magic number
@@ -418,12 +1301,14 @@ void CheckpointManager::read_header(std::ifstream& file, CheckpointData& data) {
     }
     offset += 8;
     
-    // Verify version
+    // Verify version (v4 raw dumps remain loadable next to the v5 schema)
     uint32_t version;
     std::memcpy(&version, header + offset, sizeof(version));
-    if (version != CheckpointData::FORMAT_VERSION) {
+    if (version != CheckpointData::FORMAT_VERSION &&
+        version != CheckpointData::FORMAT_VERSION_RAW) {
         throw std::runtime_error("Unsupported checkpoint format version: " + std::to_string(version));
     }
+    data.format_version = version;
     offset += 4;
     
     // Read dimension
@@ -475,8 +1360,16 @@ void CheckpointManager::read_header(std::ifstream& file, CheckpointData& data) {
     int64_t particle_count;
     std::memcpy(&particle_count, header + offset, sizeof(particle_count));
     // offset += 8;
-    
+
     // Parameters size is read separately as needed
+
+    // Derived-state section size, from the formerly reserved space at offset
+    // 312: zero in files written before the warm-restart section existed,
+    // and v4 raw dumps never carry one
+    int64_t derived_size = 0;
+    std::memcpy(&derived_size, header + 312, sizeof(derived_size));
+    data.derived_size =
+        (version == CheckpointData::FORMAT_VERSION && derived_size > 0) ? derived_size : 0;
 }
 
 void CheckpointManager::read_parameters(std::ifstream& file, CheckpointData& data, size_t params_size) {
@@ -489,17 +1382,20 @@ void CheckpointManager::read_parameters(std::ifstream& file, CheckpointData& dat
     }
     
     // Read JSON string
-    std::vector<char> json_buffer(json_size + 1);
+    std::vector<char> json_buffer(json_size);
     file.read(json_buffer.data(), json_size);
-    json_buffer[json_size] = '\0';
     
+    parse_parameters(json_buffer.data(), static_cast<size_t>(json_size), data);
+}
+
+void CheckpointManager::parse_parameters(const char* json, size_t json_size, CheckpointData& data) {
     // Parse JSON and populate parameters
     // For now, create a basic parameters object
     // TODO: Implement full JSON parsing (use nlohmann/json or similar)
     auto params = std::make_shared<SPHParameters>();
     
     // Simple parsing for now (just extract a few values)
-    std::string json_str(json_buffer.data());
+    std::string json_str(json, json_size);
     
     // This is a placeholder - in production, use proper JSON library
     // Extract gamma value (look for "gamma": X.XXX pattern)
@@ -528,28 +1424,156 @@ void CheckpointManager::read_particles(std::ifstream& file, CheckpointData& data
     auto current_pos = file.tellg();
     file.seekg(0, std::ios::end);
     auto end_pos = file.tellg();
-    
+
     // Calculate particle data size (total - current position - checksum)
     size_t particle_data_size = end_pos - current_pos - CheckpointData::CHECKSUM_SIZE;
-    size_t num_particles = particle_data_size / sizeof(SPHParticle);
-    
+
+    // The optional derived-state section sits between the particles and the
+    // checksum; its size came from the header
+    const size_t derived_bytes = static_cast<size_t>(data.derived_size);
+    if (derived_bytes > particle_data_size) {
+        throw std::runtime_error("Invalid derived-state size in checkpoint");
+    }
+    particle_data_size -= derived_bytes;
+
     // Return to particle data start
     file.seekg(current_pos);
-    
-    // Read particles
+
+    if (data.format_version == CheckpointData::FORMAT_VERSION) {
+        // v5 compact records: read the packed array, expand onto
+        // default-constructed particles
+        const size_t num_particles = particle_data_size / sizeof(CompactCheckpointParticle);
+        std::vector<CompactCheckpointParticle> records(num_particles);
+        data.particles.resize(num_particles);
+        if (num_particles > 0) {
+            file.read(
+                reinterpret_cast<char*>(records.data()),
+                num_particles * sizeof(CompactCheckpointParticle)
+            );
+            if (!file.good()) {
+                throw std::runtime_error("Failed to read particle data from checkpoint");
+            }
+            for (size_t i = 0; i < num_particles; ++i) {
+                records[i].unpack(data.particles[i]);
+            }
+        }
+        if (derived_bytes > 0) {
+            std::vector<char> derived_buffer(derived_bytes);
+            file.read(derived_buffer.data(), derived_bytes);
+            if (file.good()) {
+                parse_derived(derived_buffer.data(), derived_bytes, data);
+            }
+        }
+        return;
+    }
+
+    // Legacy v4 raw SPHParticle dump
+    size_t num_particles = particle_data_size / sizeof(SPHParticle);
     data.particles.resize(num_particles);
     if (num_particles > 0) {
         file.read(
             reinterpret_cast<char*>(data.particles.data()),
             num_particles * sizeof(SPHParticle)
         );
-        
+
         if (!file.good()) {
             throw std::runtime_error("Failed to read particle data from checkpoint");
         }
     }
 }
 
+void CheckpointManager::parse_derived(const char* cursor, size_t size, CheckpointData& data) {
+    // The checksum already vouched for the bytes, so a malformed section
+    // here means version skew rather than corruption: leave derived.present
+    // false and let the restore fall back to the full recompute instead of
+    // failing a checkpoint whose true state is perfectly loadable.
+    DerivedState derived;
+    const char* const end = cursor + size;
+
+    const auto read = [&cursor, end](void* dst, size_t bytes) -> bool {
+        if (cursor + bytes > end) {
+            return false;
+        }
+        std::memcpy(dst, cursor, bytes);
+        cursor += bytes;
+        return true;
+    };
+
+    char magic[8];
+    uint32_t version, flags;
+    double h_per_v_sig;
+    int64_t num;
+    if (!read(magic, 8) ||
+        std::memcmp(magic, CheckpointData::DERIVED_MAGIC, 8) != 0 ||
+        !read(&version, sizeof(version)) ||
+        version != CheckpointData::DERIVED_FORMAT_VERSION ||
+        !read(&flags, sizeof(flags)) ||
+        !read(&h_per_v_sig, sizeof(h_per_v_sig)) ||
+        !read(&num, sizeof(num)) ||
+        num != static_cast<int64_t>(data.particles.size())) {
+        return;
+    }
+    derived.h_per_v_sig = h_per_v_sig;
+
+    derived.records.resize(num);
+    if (!read(derived.records.data(), num * sizeof(DerivedParticleRecord))) {
+        return;
+    }
+
+    if (flags & 1u) {
+        int64_t offset_count, index_count;
+        if (!read(&offset_count, sizeof(offset_count)) || offset_count != num + 1) {
+            return;
+        }
+        derived.nb_offsets.resize(offset_count);
+        if (!read(derived.nb_offsets.data(), offset_count * sizeof(int)) ||
+            !read(&index_count, sizeof(index_count)) || index_count < 0) {
+            return;
+        }
+        derived.nb_indices.resize(index_count);
+        if (!read(derived.nb_indices.data(), index_count * sizeof(int))) {
+            return;
+        }
+        derived.has_neighbor_cache = true;
+    }
+
+    const auto read_name = [&](std::string& name) -> bool {
+        uint32_t name_len;
+        if (!read(&name_len, sizeof(name_len)) || cursor + name_len > end) {
+            return false;
+        }
+        name.assign(cursor, name_len);
+        cursor += name_len;
+        return true;
+    };
+
+    // Named arrays: scalars hold one real per particle, vectors DIM
+    for (int pass = 0; pass < 2; ++pass) {
+        auto& arrays = pass == 0 ? derived.scalar_arrays : derived.vector_arrays;
+        const int64_t reals_per_entry = pass == 0 ? 1 : DIM;
+        int32_t array_count;
+        if (!read(&array_count, sizeof(array_count)) || array_count < 0) {
+            return;
+        }
+        for (int32_t a = 0; a < array_count; ++a) {
+            std::string name;
+            int64_t value_count;
+            if (!read_name(name) ||
+                !read(&value_count, sizeof(value_count)) || value_count != num) {
+                return;
+            }
+            std::vector<real> values(value_count * reals_per_entry);
+            if (!read(values.data(), values.size() * sizeof(real))) {
+                return;
+            }
+            arrays.emplace_back(std::move(name), std::move(values));
+        }
+    }
+
+    derived.present = true;
+    data.derived = std::move(derived);
+}
+
 bool CheckpointManager::verify_checksum(std::ifstream& file, const std::vector<char>& data) {
     // Read stored checksum from file
     std::vector<uint8_t> stored_checksum(CheckpointData::CHECKSUM_SIZE);
@@ -0,0 +1,210 @@
+#include "utilities/cost_histograms.hpp"
+#include "core/simulation.hpp"
+#include "core/particle.hpp"
+#include "core/logger.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#include <chrono>
+#endif
+
+namespace sph
+{
+
+    namespace
+    {
+
+        bool s_enabled = false;
+        std::ofstream s_out;
+        real s_time = 0.0;
+        int s_threads = 1;
+
+        // One padded row per thread; counters are plain longs because each
+        // row is only ever touched by its own thread.
+        constexpr int row_pad = 16; // 128 bytes of separation at 8-byte counters
+        std::vector<long> s_nr;     // s_threads rows of NR_BINS
+        std::vector<long> s_visits; // s_threads rows of VISIT_BINS
+
+        struct ThreadWindow
+        {
+            double first = -1.0;
+            double last = -1.0;
+            char pad[48];
+        };
+        std::vector<ThreadWindow> s_windows; // NUM_LOOPS rows of s_threads
+
+        inline int thread_id()
+        {
+#ifdef _OPENMP
+            return omp_get_thread_num();
+#else
+            return 0;
+#endif
+        }
+
+        inline double wall_now()
+        {
+#ifdef _OPENMP
+            return omp_get_wtime();
+#else
+            return std::chrono::duration<double>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+#endif
+        }
+
+        inline int nr_row() { return CostHistograms::NR_BINS + row_pad; }
+        inline int visit_row() { return CostHistograms::VISIT_BINS + row_pad; }
+
+        void reset_rows()
+        {
+            std::fill(s_nr.begin(), s_nr.end(), 0);
+            std::fill(s_visits.begin(), s_visits.end(), 0);
+            std::fill(s_windows.begin(), s_windows.end(), ThreadWindow());
+        }
+
+        void append_histogram(std::ostringstream &row, const char *name,
+                              const std::vector<long> &rows, const int bins, const int stride)
+        {
+            row << "\"" << name << "\": [";
+            for (int b = 0; b < bins; ++b)
+            {
+                long total = 0;
+                for (int t = 0; t < s_threads; ++t)
+                {
+                    total += rows[t * stride + b];
+                }
+                row << total << (b + 1 < bins ? "," : "");
+            }
+            row << "]";
+        }
+
+    } // anonymous namespace
+
+    void CostHistograms::enable(const std::string &jsonl_path)
+    {
+#ifdef _OPENMP
+        s_threads = omp_get_max_threads();
+#else
+        s_threads = 1;
+#endif
+        s_nr.assign(static_cast<size_t>(s_threads) * nr_row(), 0);
+        s_visits.assign(static_cast<size_t>(s_threads) * visit_row(), 0);
+        s_windows.assign(static_cast<size_t>(NUM_LOOPS) * s_threads, ThreadWindow());
+
+        s_out.open(jsonl_path, std::ios::trunc);
+        if (!s_out.is_open())
+        {
+            WRITE_LOG << "Cost instrumentation: cannot open " << jsonl_path << "; disabled";
+            return;
+        }
+        s_enabled = true;
+    }
+
+    bool CostHistograms::enabled() { return s_enabled; }
+
+    void CostHistograms::record_nr(const int iterations)
+    {
+        if (!s_enabled)
+        {
+            return;
+        }
+        const int bin = std::min(iterations, NR_BINS - 1);
+        ++s_nr[static_cast<size_t>(thread_id()) * nr_row() + bin];
+    }
+
+    void CostHistograms::record_tree_visits(const int nodes)
+    {
+        if (!s_enabled)
+        {
+            return;
+        }
+        int bin = 0;
+        while ((1 << (bin + 1)) <= nodes && bin < VISIT_BINS - 1)
+        {
+            ++bin;
+        }
+        ++s_visits[static_cast<size_t>(thread_id()) * visit_row() + bin];
+    }
+
+    void CostHistograms::touch_window(const Loop loop)
+    {
+        auto &w = s_windows[static_cast<size_t>(loop) * s_threads + thread_id()];
+        const double now = wall_now();
+        if (w.first < 0.0)
+        {
+            w.first = now;
+        }
+        w.last = now;
+    }
+
+    void CostHistograms::begin_step(const real time)
+    {
+        if (!s_enabled)
+        {
+            return;
+        }
+        s_time = time;
+        reset_rows();
+    }
+
+    void CostHistograms::end_step(Simulation *sim)
+    {
+        if (!s_enabled)
+        {
+            return;
+        }
+
+        // Neighbor counts straight from the particle array, once per step,
+        // instead of a hook in every algorithm's density loop.
+        std::vector<long> neighbor(NEIGHBOR_BINS, 0);
+        const auto &particles = sim->get_particles();
+        const int num = sim->get_particle_num();
+        for (int i = 0; i < num; ++i)
+        {
+            if (particles[i].is_point_mass)
+            {
+                continue;
+            }
+            ++neighbor[std::min(particles[i].neighbor / 8, NEIGHBOR_BINS - 1)];
+        }
+
+        std::ostringstream row;
+        row << "{\"time\": " << s_time << ", ";
+        row << "\"neighbor_bin8\": [";
+        for (int b = 0; b < NEIGHBOR_BINS; ++b)
+        {
+            row << neighbor[b] << (b + 1 < NEIGHBOR_BINS ? "," : "");
+        }
+        row << "], ";
+        append_histogram(row, "nr_iterations", s_nr, NR_BINS, nr_row());
+        row << ", ";
+        append_histogram(row, "tree_visits_log2", s_visits, VISIT_BINS, visit_row());
+
+        // Per-thread busy windows (ms) inside the hot sweeps; the spread
+        // across threads is the load imbalance.
+        row << ", \"thread_window_ms\": {";
+        const char *names[NUM_LOOPS] = {"pre_interaction", "fluid_force"};
+        for (int l = 0; l < NUM_LOOPS; ++l)
+        {
+            row << "\"" << names[l] << "\": [";
+            for (int t = 0; t < s_threads; ++t)
+            {
+                const auto &w = s_windows[static_cast<size_t>(l) * s_threads + t];
+                const double ms = w.first < 0.0 ? 0.0 : (w.last - w.first) * 1e3;
+                row << ms << (t + 1 < s_threads ? "," : "");
+            }
+            row << "]" << (l + 1 < NUM_LOOPS ? ", " : "");
+        }
+        row << "}}";
+
+        // Flushed per step so the file tracks a run that dies mid-step.
+        s_out << row.str() << '\n' << std::flush;
+    }
+
+}
@@ -0,0 +1,94 @@
+#include "utilities/event_counters.hpp"
+#include "core/logger.hpp"
+
+#include <vector>
+
+namespace sph
+{
+
+    namespace
+    {
+        // one cache line per thread so counting never bounces lines around
+        struct alignas(64) CounterSlot
+        {
+            long counts[EventCounters::NUM_EVENTS] = {};
+        };
+
+        std::vector<CounterSlot> &slots()
+        {
+            static std::vector<CounterSlot> s_slots(
+#ifdef _OPENMP
+                omp_get_max_threads()
+#else
+                1
+#endif
+            );
+            return s_slots;
+        }
+
+        inline int thread_id()
+        {
+#ifdef _OPENMP
+            return omp_get_thread_num();
+#else
+            return 0;
+#endif
+        }
+    }
+
+    const char *EventCounters::name(const Event event)
+    {
+        switch (event)
+        {
+        case ENE_FLOOR_PREDICT:
+            return "ene floored (predict)";
+        case ENE_FLOOR_CORRECT:
+            return "ene floored (correct)";
+        case ENE_FLOOR_COOLING:
+            return "ene floored (cooling sub-cycle)";
+        case NR_NO_CONVERGENCE:
+            return "sml Newton-Raphson not converged";
+        case NEIGHBOR_LIST_OVERFLOW:
+            return "neighbor list overflow";
+        case NEIGHBOR_LIST_GROWN:
+            return "neighbor list grown";
+        default:
+            return "unknown";
+        }
+    }
+
+    void EventCounters::count(const Event event)
+    {
+        ++slots()[thread_id()].counts[event];
+    }
+
+    long EventCounters::total(const Event event)
+    {
+        long sum = 0;
+        for (const auto &slot : slots())
+        {
+            sum += slot.counts[event];
+        }
+        return sum;
+    }
+
+    void EventCounters::report_and_reset()
+    {
+        for (int e = 0; e < NUM_EVENTS; ++e)
+        {
+            const long sum = total(static_cast<Event>(e));
+            if (sum > 0)
+            {
+                WRITE_LOG << "Event count: " << name(static_cast<Event>(e)) << " x " << sum;
+            }
+        }
+        for (auto &slot : slots())
+        {
+            for (int e = 0; e < NUM_EVENTS; ++e)
+            {
+                slot.counts[e] = 0;
+            }
+        }
+    }
+
+}
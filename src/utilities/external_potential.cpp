@@ -0,0 +1,94 @@
+#include <cmath>
+
+#include "utilities/external_potential.hpp"
+#include "core/simulation.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include "core/logger.hpp"
+
+namespace sph
+{
+
+    void ExternalPotential::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        m_enabled = param->external_potential.is_valid;
+        if (!m_enabled)
+        {
+            return;
+        }
+        m_profile = static_cast<int>(param->external_potential.profile);
+        m_constant = param->external_potential.constant;
+        m_mass = param->external_potential.mass;
+        m_scale = param->external_potential.scale;
+        m_center = vec_t(param->external_potential.center);
+        m_velocity = vec_t(param->external_potential.velocity);
+    }
+
+    void ExternalPotential::evaluate(const vec_t &r_ij, vec_t &acc, real &phi) const
+    {
+        const real r2 = abs2(r_ij);
+
+        if (m_profile == static_cast<int>(ExternalPotentialType::NFW))
+        {
+            const real r = std::sqrt(r2);
+            if (r < 1e-12)
+            {
+                acc = vec_t(0.0);
+                phi = -m_constant * m_mass / m_scale;
+                return;
+            }
+            const real x = r / m_scale;
+            const real m_enc = std::log(1.0 + x) - x / (1.0 + x);
+            acc = r_ij * (-m_constant * m_mass * m_enc / (r2 * r));
+            phi = -m_constant * m_mass * std::log(1.0 + x) / r;
+            return;
+        }
+
+        // Point mass is the Plummer profile with zero scale radius.
+        const real s2 = r2 + m_scale * m_scale;
+        if (s2 < 1e-24)
+        {
+            acc = vec_t(0.0);
+            phi = 0.0;
+            return;
+        }
+        const real inv_s = 1.0 / std::sqrt(s2);
+        acc = r_ij * (-m_constant * m_mass * inv_s * inv_s * inv_s);
+        phi = -m_constant * m_mass * inv_s;
+    }
+
+    void ExternalPotential::apply(std::shared_ptr<Simulation> sim, const bool self_gravity) const
+    {
+        auto &particles = sim->get_particles();
+        const int num = sim->get_particle_num();
+        const vec_t center = center_at(sim->get_time());
+
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i)
+        {
+            auto &p_i = particles[i];
+            if (p_i.is_point_mass)
+            {
+                continue; // a live point mass keeps its own trajectory
+            }
+            if (!p_i.is_active)
+            {
+                continue; // block timesteps: keep the frozen acceleration
+            }
+
+            vec_t acc;
+            real phi;
+            evaluate(p_i.pos - center, acc, phi);
+            p_i.acc += acc;
+            if (self_gravity)
+            {
+                p_i.phi += phi; // the tree walk reset phi this step
+            }
+            else
+            {
+                p_i.phi = phi; // external term is the whole potential
+            }
+        }
+    }
+
+}
@@ -0,0 +1,113 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "utilities/hugepages.hpp"
+#include "core/parameters.hpp"
+#include "core/logger.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace sph
+{
+
+    namespace
+    {
+        bool hugepages_enabled = false;
+
+        constexpr std::uintptr_t huge_size = 2ull << 20; // x86-64 THP granularity
+
+#if defined(__linux__)
+        // "AnonHugePages:   123456 kB" -> bytes; 0 when the key is missing.
+        std::size_t read_rollup_bytes(const char *key)
+        {
+            std::ifstream rollup("/proc/self/smaps_rollup");
+            std::string line;
+            const std::size_t key_len = std::strlen(key);
+            while (std::getline(rollup, line))
+            {
+                if (line.compare(0, key_len, key) == 0)
+                {
+                    std::istringstream fields(line.substr(key_len));
+                    std::size_t kb = 0;
+                    fields >> kb;
+                    return kb * 1024;
+                }
+            }
+            return 0;
+        }
+
+        std::string format_mib(const std::size_t bytes)
+        {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(1) << bytes / double(1ull << 20) << " MiB";
+            return out.str();
+        }
+#endif
+    }
+
+    void HugePages::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        hugepages_enabled = param->huge_pages.enabled;
+#if !defined(__linux__)
+        if (hugepages_enabled)
+        {
+            WRITE_LOG << "hugepages: madvise(MADV_HUGEPAGE) not supported on this platform";
+            hugepages_enabled = false;
+        }
+#endif
+        if (hugepages_enabled)
+        {
+            WRITE_LOG << "hugepages: particle and tree arrays advised to 2 MiB pages";
+        }
+    }
+
+    bool HugePages::enabled()
+    {
+        return hugepages_enabled;
+    }
+
+    void HugePages::advise(const void *data, const std::size_t bytes)
+    {
+        if (!hugepages_enabled || data == nullptr)
+        {
+            return;
+        }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        // madvise wants page alignment and the collapse works per 2 MiB
+        // chunk, so round the range inward; the unaligned head and tail stay
+        // on base pages either way.
+        const auto addr = reinterpret_cast<std::uintptr_t>(data);
+        const std::uintptr_t begin = (addr + huge_size - 1) & ~(huge_size - 1);
+        const std::uintptr_t end = (addr + bytes) & ~(huge_size - 1);
+        if (end > begin)
+        {
+            madvise(reinterpret_cast<void *>(begin), end - begin, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+    void HugePages::log_coverage(const std::string &context)
+    {
+        if (!hugepages_enabled)
+        {
+            return;
+        }
+#if defined(__linux__)
+        const std::size_t anon = read_rollup_bytes("Anonymous:");
+        const std::size_t huge = read_rollup_bytes("AnonHugePages:");
+        if (anon > 0)
+        {
+            WRITE_LOG << "hugepages [" << context << "]: " << format_mib(huge)
+                      << " of " << format_mib(anon) << " anonymous memory THP-backed ("
+                      << std::lround(100.0 * huge / anon) << "%)";
+        }
+#endif
+    }
+
+}
@@ -0,0 +1,17 @@
+#include "utilities/initial_conditions_modifier.hpp"
+#include "core/simulation.hpp"
+
+namespace sph
+{
+
+    // Out of line because the forwarding needs the Simulation definition,
+    // which the header cannot include (simulation.hpp includes this header).
+    void InitialConditionsModifier::modify(ParticleSpan particles, ParticleAppender &append,
+                                           std::shared_ptr<Simulation> sim)
+    {
+        (void)particles;
+        (void)append;
+        modifyParticles(sim->get_particles(), sim);
+    }
+
+}
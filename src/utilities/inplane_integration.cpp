@@ -3,7 +3,9 @@
 #include "core/simulation.hpp"
 #include "core/parameters.hpp"
 #include "core/particle.hpp"
+#include "kernel/kernel_function.hpp"
 #include "utilities/defines.hpp"
+#include "utilities/inplane_integration.hpp"
 
 // This file provides alternative integration routines for a simulation
 // in which fluid particles are constrained to remain in the x-y plane
@@ -77,4 +79,66 @@ namespace sph
         }
     }
 
+    real inplane_surface_density(std::shared_ptr<Simulation> sim, const real radius,
+                                 const int quadrature)
+    {
+        return inplane_surface_density(sim, std::vector<real>{radius}, quadrature)[0];
+    }
+
+    /// Batched surface-density integration: the samples of every requested
+    /// radius are flattened into a single parallel loop, each one summing the
+    /// kernel-weighted particle masses at its point on the circle. In the
+    /// 2.5D runs the 2D kernel sum over in-plane positions is the surface
+    /// density directly.
+    std::vector<real> inplane_surface_density(std::shared_ptr<Simulation> sim,
+                                              const std::vector<real> &radii,
+                                              const int quadrature)
+    {
+        const auto &particles = sim->get_particles();
+        const int num = sim->get_particle_num();
+        const auto kernel = sim->get_kernel();
+
+        const int n_radii = static_cast<int>(radii.size());
+        const int n_samples = n_radii * quadrature;
+        std::vector<real> samples(n_samples);
+        const real dphi = 2.0 * M_PI / quadrature;
+
+        // dynamic schedule: samples near the disk edge see far fewer
+        // particles inside the kernel support than samples near the center
+#pragma omp parallel for schedule(dynamic)
+        for (int s = 0; s < n_samples; ++s)
+        {
+            const real r_k = radii[s / quadrature];
+            const real phi = (s % quadrature) * dphi;
+            const real x = r_k * std::cos(phi);
+            const real y = r_k * std::sin(phi);
+
+            real sigma = 0.0;
+            for (int i = 0; i < num; ++i)
+            {
+                const auto &p_i = particles[i];
+                if (p_i.is_wall || p_i.is_point_mass)
+                    continue;
+                const real dx = p_i.pos[0] - x;
+                const real dy = p_i.pos[1] - y;
+                const real r = std::sqrt(dx * dx + dy * dy);
+                sigma += p_i.mass * kernel->w(r, p_i.sml);
+            }
+            samples[s] = sigma;
+        }
+
+        // Azimuthal average per radius (uniform trapezoid on the circle)
+        std::vector<real> sigma(n_radii);
+        for (int k = 0; k < n_radii; ++k)
+        {
+            real sum = 0.0;
+            for (int j = 0; j < quadrature; ++j)
+            {
+                sum += samples[k * quadrature + j];
+            }
+            sigma[k] = sum / quadrature;
+        }
+        return sigma;
+    }
+
 } // namespace sph
\ No newline at end of file
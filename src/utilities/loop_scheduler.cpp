@@ -0,0 +1,208 @@
+#include <limits>
+
+#include "utilities/loop_scheduler.hpp"
+#include "core/parameters.hpp"
+#include "core/logger.hpp"
+#include "utilities/exception.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sph
+{
+
+#ifdef _OPENMP
+
+    namespace
+    {
+
+        // Candidate schedules tried per loop in auto mode. The dynamic chunk
+        // sizes bracket the useful range: small enough to balance a skewed
+        // cost profile, large enough to keep the scheduling overhead down.
+        struct Candidate
+        {
+            omp_sched_t kind;
+            int chunk;
+            const char *label;
+        };
+
+        const Candidate candidates[] = {
+            {omp_sched_static, 0, "static"},
+            {omp_sched_dynamic, 16, "dynamic,16"},
+            {omp_sched_dynamic, 64, "dynamic,64"},
+            {omp_sched_dynamic, 256, "dynamic,256"},
+            {omp_sched_guided, 0, "guided"},
+        };
+        constexpr int num_candidates = sizeof(candidates) / sizeof(candidates[0]);
+
+        // Invocations timed per candidate before moving to the next; the
+        // first one of each is discarded as warm-up (cold caches after the
+        // schedule change would otherwise bias the comparison).
+        constexpr int trials_per_candidate = 4;
+
+        enum Mode
+        {
+            FIXED,
+            AUTO,
+        };
+
+        Mode mode = FIXED;
+        omp_sched_t fixed_kind = omp_sched_static;
+        int fixed_chunk = 0;
+
+        // Per-loop tuning state, touched only from the master thread (the
+        // Scope guards live outside the parallel regions).
+        struct LoopState
+        {
+            bool tuned = false;
+            int candidate = 0;
+            int trial = 0;
+            double sum_ms[num_candidates] = {};
+            int chosen = 0;
+        };
+
+        LoopState states[LoopScheduler::NUM_LOOPS];
+
+    } // namespace
+
+    const char *LoopScheduler::name(const Loop loop)
+    {
+        switch (loop)
+        {
+        case PRE_INTERACTION:
+            return "pre_interaction";
+        case FLUID_FORCE:
+            return "fluid_force";
+        case GRAVITY_FORCE:
+            return "gravity_force";
+        case SHOCK_DETECTION:
+            return "shock_detection";
+        default:
+            return "unknown";
+        }
+    }
+
+    void LoopScheduler::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        const auto &kind = param->omp_schedule.kind;
+        fixed_chunk = param->omp_schedule.chunk;
+
+        if (kind == "static")
+        {
+            mode = FIXED;
+            fixed_kind = omp_sched_static;
+        }
+        else if (kind == "dynamic")
+        {
+            mode = FIXED;
+            fixed_kind = omp_sched_dynamic;
+        }
+        else if (kind == "guided")
+        {
+            mode = FIXED;
+            fixed_kind = omp_sched_guided;
+        }
+        else if (kind == "auto")
+        {
+            mode = AUTO;
+        }
+        else
+        {
+            THROW_ERROR("unknown ompSchedule: ", kind);
+        }
+
+        for (auto &state : states)
+        {
+            state = LoopState();
+        }
+
+        // schedule(runtime) falls back to this until a Scope applies a
+        // specific choice (or while auto mode is still sampling).
+        omp_set_schedule(mode == FIXED ? fixed_kind : omp_sched_static, fixed_chunk);
+    }
+
+    LoopScheduler::Scope::Scope(const Loop loop)
+        : m_loop(loop), m_timed(false)
+    {
+        if (mode == FIXED)
+        {
+            omp_set_schedule(fixed_kind, fixed_chunk);
+            return;
+        }
+
+        auto &state = states[m_loop];
+        const auto &c = candidates[state.tuned ? state.chosen : state.candidate];
+        omp_set_schedule(c.kind, c.chunk);
+        if (!state.tuned)
+        {
+            m_timed = true;
+            m_start = clock::now();
+        }
+    }
+
+    LoopScheduler::Scope::~Scope()
+    {
+        if (!m_timed)
+        {
+            return;
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - m_start);
+        auto &state = states[m_loop];
+        if (state.trial > 0) // first trial per candidate is warm-up
+        {
+            state.sum_ms[state.candidate] += elapsed.count() * 1e-3;
+        }
+
+        if (++state.trial < trials_per_candidate)
+        {
+            return;
+        }
+        state.trial = 0;
+        if (++state.candidate < num_candidates)
+        {
+            return;
+        }
+
+        // Every candidate has been sampled: lock in the fastest.
+        double best = std::numeric_limits<double>::max();
+        for (int c = 0; c < num_candidates; ++c)
+        {
+            if (state.sum_ms[c] < best)
+            {
+                best = state.sum_ms[c];
+                state.chosen = c;
+            }
+        }
+        state.tuned = true;
+        WRITE_LOG << "ompSchedule auto: " << name(m_loop) << " -> "
+                  << candidates[state.chosen].label << " ("
+                  << best / (trials_per_candidate - 1) << " ms/step)";
+    }
+
+#else
+
+    const char *LoopScheduler::name(const Loop loop)
+    {
+        static_cast<void>(loop);
+        return "unknown";
+    }
+
+    void LoopScheduler::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        static_cast<void>(param);
+    }
+
+    LoopScheduler::Scope::Scope(const Loop loop)
+        : m_loop(loop), m_timed(false)
+    {
+    }
+
+    LoopScheduler::Scope::~Scope()
+    {
+    }
+
+#endif
+
+}
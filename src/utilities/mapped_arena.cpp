@@ -0,0 +1,74 @@
+#include "utilities/mapped_arena.hpp"
+#include "utilities/exception.hpp"
+#include "core/logger.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace sph
+{
+
+    MappedArena::~MappedArena()
+    {
+        unmap();
+    }
+
+    void MappedArena::unmap()
+    {
+        if (m_base)
+        {
+            munmap(m_base, m_size);
+            m_base = nullptr;
+            m_size = 0;
+            m_offset = 0;
+        }
+    }
+
+    void MappedArena::map(const std::string &path, const std::size_t bytes)
+    {
+        unmap();
+
+        const int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+        {
+            THROW_ERROR("MappedArena: cannot open backing file ", path);
+        }
+
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+        {
+            close(fd);
+            THROW_ERROR("MappedArena: cannot size backing file ", path, " to ", bytes, " bytes");
+        }
+
+        void *addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd); // mapping keeps its own reference
+        if (addr == MAP_FAILED)
+        {
+            THROW_ERROR("MappedArena: cannot memory-map backing file ", path);
+        }
+
+#ifdef MADV_SEQUENTIAL
+        madvise(addr, bytes, MADV_SEQUENTIAL);
+#endif
+
+        m_base = static_cast<char *>(addr);
+        m_size = bytes;
+        m_offset = 0;
+
+        WRITE_LOG << "MappedArena: " << bytes / (1024.0 * 1024.0) << " MiB backed by " << path;
+    }
+
+    void *MappedArena::alloc(const std::size_t bytes, const std::size_t alignment)
+    {
+        std::size_t offset = (m_offset + alignment - 1) & ~(alignment - 1);
+        if (offset + bytes > m_size)
+        {
+            THROW_ERROR("MappedArena: mapping exhausted (", m_size, " bytes)");
+        }
+        void *p = m_base + offset;
+        m_offset = offset + bytes;
+        return p;
+    }
+
+}
@@ -0,0 +1,106 @@
+#include "utilities/mapped_file_writer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#define SPH_MAPPED_WRITE
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace sph
+{
+
+    namespace
+    {
+
+        /// Portable fallback: one buffered write per span.
+        bool write_file_buffered(const std::string &path,
+                                 const std::vector<std::pair<const void *, std::size_t>> &spans)
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+            {
+                return false;
+            }
+            for (const auto &span : spans)
+            {
+                out.write(static_cast<const char *>(span.first),
+                          static_cast<std::streamsize>(span.second));
+            }
+            return out.good();
+        }
+
+    } // anonymous namespace
+
+    bool write_file_mapped(const std::string &path,
+                           const std::vector<std::pair<const void *, std::size_t>> &spans)
+    {
+#ifdef SPH_MAPPED_WRITE
+        std::size_t total = 0;
+        for (const auto &span : spans)
+        {
+            total += span.second;
+        }
+
+        const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            return false;
+        }
+        if (total == 0)
+        {
+            close(fd);
+            return true;
+        }
+        if (ftruncate(fd, static_cast<off_t>(total)) != 0)
+        {
+            close(fd);
+            return write_file_buffered(path, spans);
+        }
+
+        void *addr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            close(fd);
+            return write_file_buffered(path, spans);
+        }
+
+        // Copy each span into the mapping in parallel chunks, like the
+        // checkpoint load path; the pieces are large and contiguous.
+        char *dst = static_cast<char *>(addr);
+        std::size_t offset = 0;
+        for (const auto &span : spans)
+        {
+            const char *src = static_cast<const char *>(span.first);
+            const std::size_t bytes = span.second;
+            constexpr std::size_t chunk = 8 * 1024 * 1024;
+            const long num_chunks = static_cast<long>((bytes + chunk - 1) / chunk);
+#pragma omp parallel for
+            for (long c = 0; c < num_chunks; ++c)
+            {
+                const std::size_t off = static_cast<std::size_t>(c) * chunk;
+                std::memcpy(dst + offset + off, src + off, std::min(chunk, bytes - off));
+            }
+            offset += bytes;
+        }
+
+        // Queue the writeback without waiting for it, then drop the cached
+        // pages: the data ends up on disk with the same durability as a
+        // buffered write, but without displacing the particle working set.
+        msync(addr, total, MS_ASYNC);
+        munmap(addr, total);
+#ifdef POSIX_FADV_DONTNEED
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+        close(fd);
+        return true;
+#else
+        return write_file_buffered(path, spans);
+#endif
+    }
+
+}
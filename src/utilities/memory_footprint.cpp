@@ -0,0 +1,144 @@
+#include "utilities/memory_footprint.hpp"
+#include "core/logger.hpp"
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+namespace sph
+{
+
+    namespace
+    {
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<MemoryFootprint::Entry> entries;
+
+            MemoryFootprint::Entry &slot(const char *name)
+            {
+                for (auto &entry : entries)
+                {
+                    if (entry.name == name)
+                    {
+                        return entry;
+                    }
+                }
+                entries.push_back({name, 0, 0});
+                return entries.back();
+            }
+        };
+
+        Registry &registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        std::string format_bytes(const std::size_t bytes)
+        {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(1);
+            if (bytes >= (1ull << 30))
+            {
+                out << bytes / double(1ull << 30) << " GiB";
+            }
+            else if (bytes >= (1ull << 20))
+            {
+                out << bytes / double(1ull << 20) << " MiB";
+            }
+            else
+            {
+                out << bytes / 1024.0 << " KiB";
+            }
+            return out.str();
+        }
+
+    } // anonymous namespace
+
+    void MemoryFootprint::set(const char *subsystem, std::size_t bytes)
+    {
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        auto &entry = reg.slot(subsystem);
+        entry.current = bytes;
+        if (bytes > entry.peak)
+        {
+            entry.peak = bytes;
+        }
+    }
+
+    void MemoryFootprint::add(const char *subsystem, long bytes)
+    {
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        auto &entry = reg.slot(subsystem);
+        const long next = static_cast<long>(entry.current) + bytes;
+        entry.current = next > 0 ? static_cast<std::size_t>(next) : 0;
+        if (entry.current > entry.peak)
+        {
+            entry.peak = entry.current;
+        }
+    }
+
+    std::size_t MemoryFootprint::current(const char *subsystem)
+    {
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        return reg.slot(subsystem).current;
+    }
+
+    std::size_t MemoryFootprint::peak(const char *subsystem)
+    {
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        return reg.slot(subsystem).peak;
+    }
+
+    std::vector<MemoryFootprint::Entry> MemoryFootprint::entries()
+    {
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        return reg.entries;
+    }
+
+    void MemoryFootprint::log_report(const std::string &context)
+    {
+        std::size_t total_current = 0;
+        std::size_t total_peak = 0;
+        for (const auto &entry : entries())
+        {
+            WRITE_LOG << "memory [" << context << "] " << entry.name << ": "
+                      << format_bytes(entry.current) << " (peak " << format_bytes(entry.peak) << ")";
+            total_current += entry.current;
+            total_peak += entry.peak;
+        }
+        WRITE_LOG << "memory [" << context << "] total: " << format_bytes(total_current)
+                  << " (peak " << format_bytes(total_peak) << ")";
+    }
+
+    std::string MemoryFootprint::to_json(int indent)
+    {
+        const std::string pad(indent, ' ');
+        std::ostringstream json;
+        json << "{\n";
+        const auto all = entries();
+        for (size_t i = 0; i < all.size(); ++i)
+        {
+            json << pad << "  \"" << all[i].name << "\": {"
+                 << "\"current_bytes\": " << all[i].current
+                 << ", \"peak_bytes\": " << all[i].peak << "}";
+            json << (i + 1 < all.size() ? ",\n" : "\n");
+        }
+        json << pad << "}";
+        return json.str();
+    }
+
+    void MemoryFootprint::reset()
+    {
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.entries.clear();
+    }
+
+}
@@ -0,0 +1,84 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "utilities/numa.hpp"
+#include "core/parameters.hpp"
+#include "core/logger.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace sph
+{
+
+    namespace
+    {
+        bool first_touch_enabled = false;
+    }
+
+    void NumaPlacement::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        first_touch_enabled = param->numa.first_touch;
+        if (param->numa.pin_threads)
+        {
+            pin_threads();
+        }
+    }
+
+    bool NumaPlacement::enabled()
+    {
+        return first_touch_enabled;
+    }
+
+    void NumaPlacement::first_touch(void *data, const size_t bytes)
+    {
+        auto *raw = static_cast<char *>(data);
+        const long n = static_cast<long>(bytes);
+        // Zero in page-sized strides under the same static partition the
+        // particle loops use, so each page faults on its future reader.
+#pragma omp parallel for schedule(static)
+        for (long offset = 0; offset < n; offset += 4096)
+        {
+            const long len = n - offset < 4096 ? n - offset : 4096;
+            std::memset(raw + offset, 0, len);
+        }
+    }
+
+    void NumaPlacement::pin_threads()
+    {
+#if defined(_OPENMP) && defined(__linux__)
+        if (std::getenv("OMP_PROC_BIND") || std::getenv("OMP_PLACES") ||
+            std::getenv("GOMP_CPU_AFFINITY") || std::getenv("KMP_AFFINITY"))
+        {
+            WRITE_LOG << "numa: thread affinity already set by the environment, not pinning";
+            return;
+        }
+
+        const long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        if (n_cpus < 1)
+        {
+            return;
+        }
+
+#pragma omp parallel
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(omp_get_thread_num() % n_cpus, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+        WRITE_LOG << "numa: pinned " << omp_get_max_threads()
+                  << " threads round-robin over " << n_cpus << " CPUs";
+#else
+        WRITE_LOG << "numa: thread pinning not supported on this platform";
+#endif
+    }
+
+}
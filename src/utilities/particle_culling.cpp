@@ -0,0 +1,98 @@
+#include "utilities/particle_culling.hpp"
+#include "core/simulation.hpp"
+#include "core/particle.hpp"
+#include "core/parameters.hpp"
+#include "core/logger.hpp"
+#include "utilities/vector_type.hpp"
+#include <algorithm>
+
+namespace sph
+{
+
+    void ParticleCulling::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        m_enabled = param->culling.is_valid;
+        if (!m_enabled)
+        {
+            return;
+        }
+        m_radius2 = param->culling.radius * param->culling.radius;
+        m_interval = std::max(1, param->culling.interval);
+        m_step = 0;
+        m_culled_total = 0;
+        m_culled_mass = 0.0;
+    }
+
+    bool ParticleCulling::apply(std::shared_ptr<Simulation> sim)
+    {
+        if (!m_enabled)
+        {
+            return false;
+        }
+        ++m_step;
+        if (m_step % m_interval != 0)
+        {
+            return false;
+        }
+
+        auto &particles = sim->get_particles();
+        const int num = sim->get_particle_num();
+
+        // Compact in place: keep walls, point masses and in-bounds fluid.
+        // The survivors' old indices drive the same compaction of the
+        // registered per-particle arrays below.
+        std::vector<int> kept;
+        if (sim->has_additional_arrays())
+        {
+            kept.reserve(num);
+        }
+        int write = 0;
+        int n_culled = 0;
+        real culled_mass = 0.0;
+        for (int i = 0; i < num; ++i)
+        {
+            const SPHParticle &p_i = particles[i];
+            if (!p_i.is_wall && !p_i.is_point_mass && abs2(p_i.pos) > m_radius2)
+            {
+                ++n_culled;
+                culled_mass += p_i.mass;
+                continue;
+            }
+            if (write != i)
+            {
+                particles[write] = particles[i];
+            }
+            if (sim->has_additional_arrays())
+            {
+                kept.push_back(i);
+            }
+            ++write;
+        }
+        if (n_culled == 0)
+        {
+            return false;
+        }
+
+        particles.resize(write);
+        if (sim->has_additional_arrays())
+        {
+            sim->gather_additional_arrays(kept);
+        }
+        for (int i = 0; i < write; ++i)
+        {
+            particles[i].id = i;
+        }
+        sim->finalize_particles();
+#ifndef EXHAUSTIVE_SEARCH
+        sim->make_tree();
+#endif
+
+        m_culled_total += n_culled;
+        m_culled_mass += culled_mass;
+        WRITE_LOG << "Culled " << n_culled << " escaped particles (mass " << culled_mass
+                  << "); cumulative " << m_culled_total << " (mass " << m_culled_mass
+                  << "), " << write << " remain";
+        return true;
+    }
+
+}
@@ -0,0 +1,279 @@
+#include "utilities/particle_refinement.hpp"
+#include "core/simulation.hpp"
+#include "core/particle.hpp"
+#include "core/parameters.hpp"
+#include "utilities/periodic.hpp"
+#include "utilities/defines.hpp"
+#include "core/logger.hpp"
+#ifdef EXHAUSTIVE_SEARCH
+#include "tree/exhaustive_search.hpp"
+#else
+#include "tree/neighbor_searcher.hpp"
+#endif
+#include <algorithm>
+#include <cmath>
+
+namespace sph
+{
+
+    void ParticleRefinement::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        m_enabled = param->refinement.is_valid;
+        if (!m_enabled)
+        {
+            return;
+        }
+        m_split_threshold = param->refinement.split_threshold;
+        m_merge_threshold = param->refinement.merge_threshold;
+        m_interval = std::max(1, param->refinement.interval);
+        m_min_mass_factor = param->refinement.min_mass_factor;
+        m_max_mass_factor = param->refinement.max_mass_factor;
+        m_neighbor_number = param->physics.neighbor_number;
+        m_min_mass = 0.0;
+        m_max_mass = 0.0;
+        m_step = 0;
+    }
+
+    // Resolve the configured mass-bound factors against the median fluid
+    // mass. Done on the first pass rather than at initialization so restarts
+    // and modifier-generated ICs measure the mass distribution they actually
+    // run with.
+    void ParticleRefinement::resolve_mass_bounds(const std::vector<SPHParticle> &particles, int num)
+    {
+        std::vector<real> masses;
+        masses.reserve(num);
+        for (int i = 0; i < num; ++i)
+        {
+            if (!particles[i].is_wall && !particles[i].is_point_mass)
+            {
+                masses.push_back(particles[i].mass);
+            }
+        }
+        if (masses.empty())
+        {
+            m_enabled = false;
+            return;
+        }
+        std::nth_element(masses.begin(), masses.begin() + masses.size() / 2, masses.end());
+        const real median = masses[masses.size() / 2];
+        m_min_mass = m_min_mass_factor * median;
+        m_max_mass = m_max_mass_factor * median;
+        WRITE_LOG << "Refinement mass bounds resolved: median = " << median
+                  << ", min = " << m_min_mass << ", max = " << m_max_mass;
+    }
+
+    bool ParticleRefinement::apply(std::shared_ptr<Simulation> sim)
+    {
+        if (!m_enabled)
+        {
+            return false;
+        }
+        ++m_step;
+        if (m_step % m_interval != 0)
+        {
+            return false;
+        }
+
+        auto &particles = sim->get_particles();
+        const int num = sim->get_particle_num();
+        auto *periodic = sim->get_periodic().get();
+
+        if (m_max_mass <= 0.0)
+        {
+            resolve_mass_bounds(particles, num);
+            if (!m_enabled)
+            {
+                return false;
+            }
+        }
+
+        // --- Merge pass -------------------------------------------------
+        // Greedy over the array: each quiescent particle pairs with its
+        // nearest unclaimed quiescent neighbor within half the smoothing
+        // length. Serial on purpose — claiming partners races under OpenMP,
+        // and the pass is interval-gated so it is off the hot path.
+        std::vector<char> dead(num, 0);
+        std::vector<char> claimed(num, 0);
+        std::vector<int> neighbor_list(m_neighbor_number * neighbor_list_size);
+        int n_merged = 0;
+
+        for (int i = 0; i < num; ++i)
+        {
+            SPHParticle &p_i = particles[i];
+            if (p_i.is_wall || p_i.is_point_mass || dead[i] || claimed[i])
+            {
+                continue;
+            }
+            if (p_i.shockSensor >= m_merge_threshold || p_i.mass >= m_max_mass)
+            {
+                continue;
+            }
+
+#ifdef EXHAUSTIVE_SEARCH
+            const int n_neighbor = exhaustive_search(p_i, p_i.sml, particles, num,
+                                                     neighbor_list, m_neighbor_number * neighbor_list_size,
+                                                     periodic, false);
+#else
+            const int n_neighbor = sim->get_tree()->neighbor_search_adaptive(p_i, neighbor_list, particles, false);
+#endif
+
+            int best = -1;
+            real best_r2 = 0.0;
+            for (int n = 0; n < n_neighbor; ++n)
+            {
+                const int j = neighbor_list[n];
+                if (j == i || j >= num || dead[j] || claimed[j])
+                {
+                    continue;
+                }
+                const SPHParticle &p_j = particles[j];
+                if (p_j.is_wall || p_j.is_point_mass)
+                {
+                    continue;
+                }
+                if (p_j.shockSensor >= m_merge_threshold || p_i.mass + p_j.mass > m_max_mass)
+                {
+                    continue;
+                }
+                const vec_t r_ij = periodic->calc_r_ij(p_i.pos, p_j.pos);
+                const real r2 = abs2(r_ij);
+                const real r_max = 0.5 * std::min(p_i.sml, p_j.sml);
+                if (r2 < r_max * r_max && (best < 0 || r2 < best_r2))
+                {
+                    best = j;
+                    best_r2 = r2;
+                }
+            }
+            if (best < 0)
+            {
+                continue;
+            }
+
+            // Collapse j into i at the center of mass. Momentum is conserved
+            // by the mass-weighted velocity; the kinetic energy the average
+            // loses (0.5 mu |dv|^2 with the reduced mass mu) goes to internal
+            // energy, so total energy is conserved too.
+            SPHParticle &p_j = particles[best];
+            const real m_i = p_i.mass;
+            const real m_j = p_j.mass;
+            const real m_tot = m_i + m_j;
+            const vec_t r_ij = periodic->calc_r_ij(p_i.pos, p_j.pos);
+            const vec_t dv = p_i.vel - p_j.vel;
+
+            p_i.pos = p_i.pos - r_ij * (m_j / m_tot);
+            p_i.vel = (p_i.vel * m_i + p_j.vel * m_j) / m_tot;
+            p_i.ene = (p_i.ene * m_i + p_j.ene * m_j + 0.5 * (m_i * m_j / m_tot) * abs2(dv)) / m_tot;
+            p_i.alpha = (p_i.alpha * m_i + p_j.alpha * m_j) / m_tot;
+            p_i.dens = (p_i.dens * m_i + p_j.dens * m_j) / m_tot;
+            p_i.sml = std::pow(std::pow(p_i.sml, (real)DIM) + std::pow(p_j.sml, (real)DIM), 1.0 / DIM);
+            p_i.mass = m_tot;
+            p_i.shockSensor = std::max(p_i.shockSensor, p_j.shockSensor);
+            p_i.dt_bin = std::min(p_i.dt_bin, p_j.dt_bin);
+            periodic->apply(p_i.pos);
+
+            dead[best] = 1;
+            claimed[i] = 1;
+            ++n_merged;
+        }
+
+        // --- Split pass -------------------------------------------------
+        // 2*DIM children on the coordinate axes at 0.4 h: symmetric, so
+        // mass, momentum and the center of mass are conserved exactly. The
+        // parent slot becomes the first child; the rest are appended.
+        constexpr int n_children = 2 * DIM;
+        const real h_scale = std::pow((real)n_children, -1.0 / DIM);
+        std::vector<SPHParticle> children;
+        std::vector<int> child_parents; // parent's pre-compaction index per appended child
+        int n_split = 0;
+
+        for (int i = 0; i < num; ++i)
+        {
+            SPHParticle &p_i = particles[i];
+            if (p_i.is_wall || p_i.is_point_mass || dead[i] || claimed[i])
+            {
+                continue;
+            }
+            if (p_i.shockSensor < m_split_threshold || p_i.mass < m_min_mass * n_children)
+            {
+                continue;
+            }
+
+            SPHParticle parent = p_i;
+            const real offset = 0.4 * parent.sml;
+            for (int c = 0; c < n_children; ++c)
+            {
+                SPHParticle child = parent;
+                child.mass = parent.mass / n_children;
+                child.sml = parent.sml * h_scale;
+                child.volume = child.mass / child.dens;
+                child.pos[c / 2] += (c % 2 == 0 ? offset : -offset);
+                periodic->apply(child.pos);
+                if (c == 0)
+                {
+                    p_i = child;
+                }
+                else
+                {
+                    children.push_back(child);
+                    child_parents.push_back(i);
+                }
+            }
+            ++n_split;
+        }
+
+        if (n_merged == 0 && n_split == 0)
+        {
+            return false;
+        }
+
+        // Compact the merge victims out of the original range, append the
+        // children, then restore the id == index convention (as
+        // reorder_particles does) and rebuild the stale structures. The
+        // registered per-particle arrays follow the same layout: survivors
+        // keep their slot, children inherit the parent's (the merge victim's
+        // values are dropped with it, like its other fields).
+        std::vector<int> source;
+        if (sim->has_additional_arrays())
+        {
+            source.reserve(num + static_cast<int>(children.size()));
+        }
+        int write = 0;
+        for (int i = 0; i < num; ++i)
+        {
+            if (dead[i])
+            {
+                continue;
+            }
+            if (write != i)
+            {
+                particles[write] = particles[i];
+            }
+            if (sim->has_additional_arrays())
+            {
+                source.push_back(i);
+            }
+            ++write;
+        }
+        particles.resize(write);
+        particles.insert(particles.end(), children.begin(), children.end());
+        const int new_num = static_cast<int>(particles.size());
+        if (sim->has_additional_arrays())
+        {
+            source.insert(source.end(), child_parents.begin(), child_parents.end());
+            sim->gather_additional_arrays(source);
+        }
+        for (int i = 0; i < new_num; ++i)
+        {
+            particles[i].id = i;
+        }
+        sim->finalize_particles();
+#ifndef EXHAUSTIVE_SEARCH
+        sim->make_tree();
+#endif
+
+        WRITE_LOG << "Refinement pass: " << n_split << " splits, " << n_merged
+                  << " merges, " << num << " -> " << new_num << " particles";
+        return true;
+    }
+
+}
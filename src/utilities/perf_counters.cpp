@@ -0,0 +1,180 @@
+#include "utilities/perf_counters.hpp"
+
+#ifdef USE_PERF_COUNTERS
+
+#include <cstring>
+#include <iomanip>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "core/logger.hpp"
+
+namespace sph
+{
+
+    namespace
+    {
+
+        int open_counter(const uint32_t type, const uint64_t config)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            return static_cast<int>(
+                syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        constexpr uint64_t cache_read_miss(const uint64_t cache)
+        {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+
+        constexpr double cache_line_bytes = 64.0;
+
+    } // namespace
+
+    PerfCounters::~PerfCounters()
+    {
+        for (int fd : m_fd)
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+    }
+
+    void PerfCounters::enable(const std::string &csv_path)
+    {
+        m_fd[0] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        m_fd[1] = open_counter(PERF_TYPE_HW_CACHE,
+                               cache_read_miss(PERF_COUNT_HW_CACHE_L1D));
+        m_fd[2] = open_counter(PERF_TYPE_HW_CACHE,
+                               cache_read_miss(PERF_COUNT_HW_CACHE_LL));
+        if (m_fd[0] < 0 || m_fd[1] < 0 || m_fd[2] < 0)
+        {
+            // Typical on locked-down machines (perf_event_paranoid); the run
+            // continues without counters rather than failing.
+            WRITE_LOG << "WARNING: perf counters unavailable "
+                      << "(perf_event_open failed); counter log disabled";
+            for (int &fd : m_fd)
+            {
+                if (fd >= 0)
+                {
+                    close(fd);
+                }
+                fd = -1;
+            }
+            return;
+        }
+
+        m_out.open(csv_path);
+        if (!m_out.is_open())
+        {
+            WRITE_LOG << "WARNING: Cannot open counter log: " << csv_path;
+            return;
+        }
+        m_enabled = true;
+        WRITE_LOG << "Counter log: " << csv_path;
+    }
+
+    PerfCounters::Phase &PerfCounters::slot(const char *phase)
+    {
+        for (auto &entry : m_phases)
+        {
+            if (entry.name == phase)
+            {
+                return entry;
+            }
+        }
+        m_phases.emplace_back();
+        m_phases.back().name = phase;
+        return m_phases.back();
+    }
+
+    void PerfCounters::read_now(long long value[3]) const
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            uint64_t count = 0;
+            if (read(m_fd[c], &count, sizeof(count)) != sizeof(count))
+            {
+                count = 0;
+            }
+            value[c] = static_cast<long long>(count);
+        }
+    }
+
+    void PerfCounters::begin_step(const real time)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+        m_step_time = time;
+        m_pairs = 0;
+    }
+
+    void PerfCounters::record(const char *phase, const long long delta[3])
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+        auto &entry = slot(phase);
+        entry.instructions += delta[0];
+        entry.l1d_miss += delta[1];
+        entry.llc_miss += delta[2];
+    }
+
+    void PerfCounters::end_step()
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        // Stable phase set after the first step, as in StepTimer.
+        if (!m_header_written)
+        {
+            m_out << "time";
+            for (const auto &entry : m_phases)
+            {
+                m_out << ',' << entry.name << "_instr"
+                      << ',' << entry.name << "_l1d_miss"
+                      << ',' << entry.name << "_llc_miss"
+                      << ',' << entry.name << "_bytes_per_pair";
+            }
+            m_out << ",pairs\n";
+            m_header_written = true;
+        }
+
+        m_out << std::scientific << std::setprecision(6) << m_step_time;
+        for (auto &entry : m_phases)
+        {
+            const double bytes_per_pair =
+                m_pairs > 0 ? entry.llc_miss * cache_line_bytes / m_pairs : 0.0;
+            m_out << ',' << entry.instructions
+                  << ',' << entry.l1d_miss
+                  << ',' << entry.llc_miss
+                  << ',' << std::fixed << std::setprecision(2) << bytes_per_pair
+                  << std::scientific << std::setprecision(6);
+            entry.instructions = 0;
+            entry.l1d_miss = 0;
+            entry.llc_miss = 0;
+        }
+        m_out << ',' << m_pairs << '\n';
+        m_out.flush();
+    }
+
+}
+
+#endif // USE_PERF_COUNTERS
@@ -5,6 +5,7 @@
 #include "utilities/periodic.hpp"
 #include "kernel/kernel_function.hpp"
 #include "utilities/defines.hpp"
+#include "utilities/loop_scheduler.hpp"
 #include "cmath"
 #include <omp.h>
 #include <algorithm>
@@ -42,33 +43,76 @@ namespace sph
     void detect_shocks(std::shared_ptr<Simulation> sim,
                        const Periodic *periodic,
                        real gamma_val,
-                       real h_factor /* typically 1.0 */)
+                       real h_factor /* typically 1.0 */,
+                       real refresh_threshold /* 0 = always full */)
     {
         auto &particles = sim->get_particles();
         int N = sim->get_particle_num();
 
-#pragma omp parallel for
+        // Reuse the per-step neighbor cache when the solver has built it;
+        // otherwise fall back to the all-pairs sweep. With the pair-list
+        // pipeline the separations and kernel gradients come precomputed;
+        // the stored gradients are taken at p_i.sml, so they only apply for
+        // the default h_factor.
+        const auto &neighbor_cache = sim->get_neighbor_cache();
+        const bool use_cache = neighbor_cache.is_valid();
+        const auto &pairs = sim->get_pair_list();
+        const bool use_pairs = use_cache && pairs.is_valid();
+        const bool use_pair_grad = use_pairs && h_factor == 1.0;
+
+        LoopScheduler::Scope schedule(LoopScheduler::SHOCK_DETECTION);
+#pragma omp parallel for schedule(runtime)
         for (int i = 0; i < N; ++i)
         {
             SPHParticle &pi = particles[i];
             if (pi.is_wall)
                 continue;
 
+            // Incremental mode: keep the previous sensor while the particle
+            // has barely drifted from its last fully evaluated state.
+            if (refresh_threshold > 0.0 && pi.shock_ref_neighbor == pi.neighbor)
+            {
+                const real d_dens = std::abs(pi.dens - pi.shock_ref_dens) /
+                                    std::max(pi.shock_ref_dens, real(1e-30));
+                const real d_pres = std::abs(pi.pres - pi.shock_ref_pres) /
+                                    std::max(pi.shock_ref_pres, real(1e-30));
+                if (d_dens < refresh_threshold && d_pres < refresh_threshold)
+                {
+                    continue;
+                }
+            }
+            pi.shock_ref_dens = pi.dens;
+            pi.shock_ref_pres = pi.pres;
+            pi.shock_ref_neighbor = pi.neighbor;
+
             // Use an effective smoothing length.
             real h_i = pi.sml * h_factor;
 
             // --- Step 1: Compute Pressure Gradient ---
             // gradP_i = (1/ρ_i) * Σ_j m_j (P_j - P_i) ∇W(|r_i - r_j|, h_i)
             vec_t gradP = 0.0;
-            for (int j = 0; j < N; ++j)
+            const int n_loop_grad = use_cache ? neighbor_cache.neighbor_count(i) : N;
+            const int base = use_pairs ? neighbor_cache.first(i) : 0;
+            for (int n = 0; n < n_loop_grad; ++n)
             {
+                const int j = use_cache ? neighbor_cache.neighbors(i)[n] : n;
                 if (i == j)
                     continue;
                 SPHParticle &pj = particles[j];
-                vec_t r_ij = periodic->calc_r_ij(pi.pos, pj.pos);
-                real r = std::abs(r_ij);
-                // Here we use the kernel gradient from the simulation's kernel.
-                vec_t gradW = sim->get_kernel()->dw(r_ij, r, h_i);
+                vec_t gradW;
+                if (use_pair_grad)
+                {
+                    // ∇W(r, p_i.sml) from the stream (zero beyond the cut,
+                    // matching the kernel's compact support)
+                    gradW = pairs.dw_i(base + n);
+                }
+                else
+                {
+                    vec_t r_ij = use_pairs ? pairs.r_ij(base + n) : periodic->calc_r_ij(pi.pos, pj.pos);
+                    real r = use_pairs ? pairs.r(base + n) : std::abs(r_ij);
+                    // Here we use the kernel gradient from the simulation's kernel.
+                    gradW = sim->get_kernel()->dw(r_ij, r, h_i);
+                }
                 gradP += gradW * (pj.pres - pi.pres) * pj.mass;
             }
             gradP /= pi.dens;
@@ -89,12 +133,14 @@ namespace sph
             real dens_up = 0.0, dens_down = 0.0;
             real v_up = 0.0, v_down = 0.0;
 
-            for (int j = 0; j < N; ++j)
+            const int n_loop = use_cache ? neighbor_cache.neighbor_count(i) : N;
+            for (int k = 0; k < n_loop; ++k)
             {
+                const int j = use_cache ? neighbor_cache.neighbors(i)[k] : k;
                 if (i == j)
                     continue;
                 SPHParticle &pj = particles[j];
-                vec_t r_ij = periodic->calc_r_ij(pi.pos, pj.pos);
+                vec_t r_ij = use_pairs ? pairs.r_ij(base + k) : periodic->calc_r_ij(pi.pos, pj.pos);
                 // Projection along the shock normal:
                 real s_ij = inner_product(r_ij, n);
                 // Perpendicular distance:
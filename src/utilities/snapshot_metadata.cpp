@@ -70,9 +70,32 @@ namespace sph
             if (i < columns.size() - 1) json << ",";
             json << "\n";
         }
-        json << "  ]\n";
-        json << "}\n";
-        
+        json << "  ]";
+
+        // Per-column statistics (scientific notation: the magnitudes range
+        // from accelerations to total masses)
+        if (!column_stats.empty())
+        {
+            json << ",\n  \"column_stats\": {\n";
+            json << std::scientific << std::setprecision(16);
+            for (size_t i = 0; i < column_stats.size(); ++i)
+            {
+                const auto& s = column_stats[i];
+                json << "    \"" << s.name << "\": {";
+                json << "\"min\": " << s.min << ", ";
+                json << "\"max\": " << s.max << ", ";
+                json << "\"mean\": " << s.mean << ", ";
+                json << "\"l2\": " << s.l2 << ", ";
+                json << "\"nan_count\": " << s.nan_count << ", ";
+                json << "\"inf_count\": " << s.inf_count << "}";
+                if (i < column_stats.size() - 1) json << ",";
+                json << "\n";
+            }
+            json << "  }";
+        }
+
+        json << "\n}\n";
+
         return json.str();
     }
 
@@ -0,0 +1,106 @@
+#include "utilities/step_timer.hpp"
+#include "core/logger.hpp"
+
+#include <iomanip>
+
+namespace sph
+{
+
+    void StepTimer::enable(const std::string &csv_path)
+    {
+        m_out.open(csv_path);
+        if (!m_out.is_open())
+        {
+            WRITE_LOG << "WARNING: Cannot open timing log: " << csv_path;
+            return;
+        }
+        m_enabled = true;
+        WRITE_LOG << "Timing log: " << csv_path;
+    }
+
+    double &StepTimer::slot(const char *phase)
+    {
+        for (auto &entry : m_phases)
+        {
+            if (entry.first == phase)
+            {
+                return entry.second;
+            }
+        }
+        m_phases.emplace_back(phase, 0.0);
+        return m_phases.back().second;
+    }
+
+    void StepTimer::begin_step(const real time)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+        m_step_time = time;
+    }
+
+    void StepTimer::record(const char *phase, const double ms)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+        slot(phase) += ms;
+    }
+
+    void StepTimer::end_step()
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        // The phase set is stable after the first step, so the header written
+        // with the first row matches every later row.
+        if (!m_header_written)
+        {
+            m_out << "time";
+            for (const auto &entry : m_phases)
+            {
+                m_out << "," << entry.first;
+            }
+            m_out << ",total_ms\n";
+            m_header_written = true;
+        }
+
+        double total = 0.0;
+        m_out << std::scientific << std::setprecision(6) << m_step_time;
+        m_out << std::fixed << std::setprecision(3);
+        for (const auto &entry : m_phases)
+        {
+            m_out << "," << entry.second;
+            total += entry.second;
+        }
+        m_out << "," << total << "\n";
+        m_out.flush();
+
+        // Reset here rather than in begin_step so work done between steps
+        // (snapshot output) is charged to the following row instead of lost.
+        for (auto &entry : m_phases)
+        {
+            // fold the step into the running totals before zeroing
+            bool found = false;
+            for (auto &total : m_totals)
+            {
+                if (total.first == entry.first)
+                {
+                    total.second += entry.second;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+            {
+                m_totals.emplace_back(entry.first, entry.second);
+            }
+            entry.second = 0.0;
+        }
+    }
+
+}
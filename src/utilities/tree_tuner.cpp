@@ -0,0 +1,141 @@
+#include "utilities/tree_tuner.hpp"
+#include "core/parameters.hpp"
+#include "core/logger.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#include <chrono>
+#endif
+
+namespace sph
+{
+
+    namespace
+    {
+        double wall_time()
+        {
+#ifdef _OPENMP
+            return omp_get_wtime();
+#else
+            return std::chrono::duration<double>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+#endif
+        }
+    }
+
+    void TreeTuner::initialize(std::shared_ptr<SPHParameters> param)
+    {
+        m_enabled = param->tree.auto_tune && !param->tree.use_cell_list;
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        // The configured value goes first, so the baseline is measured under
+        // the same conditions as every challenger.
+        m_candidates.clear();
+        for (const int leaf : {param->tree.leaf_particle_num, 1, 2, 4, 8, 16, 32})
+        {
+            if (std::find(m_candidates.begin(), m_candidates.end(), leaf) == m_candidates.end())
+            {
+                m_candidates.push_back(leaf);
+            }
+        }
+        m_cost.assign(m_candidates.size(), 0.0);
+        m_current = 0;
+        m_settle_left = SETTLE_STEPS;
+        m_measured = 0;
+        m_finished = false;
+        m_chosen = param->tree.leaf_particle_num;
+
+        WRITE_LOG << "Tree auto-tune: sweeping leafParticleNumber over "
+                  << m_candidates.size() << " candidates ("
+                  << (SETTLE_STEPS + MEASURE_STEPS) << " steps each)";
+    }
+
+    void TreeTuner::begin_step()
+    {
+        if (!m_enabled || m_finished)
+        {
+            return;
+        }
+        m_t0 = wall_time();
+    }
+
+    bool TreeTuner::end_step(std::shared_ptr<SPHParameters> param)
+    {
+        if (!m_enabled || m_finished)
+        {
+            return false;
+        }
+
+        const double elapsed = wall_time() - m_t0;
+        if (m_settle_left > 0)
+        {
+            // the step right after a switch pays the full rebuild; skip it
+            --m_settle_left;
+            return false;
+        }
+
+        m_cost[m_current] += elapsed;
+        if (++m_measured < MEASURE_STEPS)
+        {
+            return false;
+        }
+
+        m_measured = 0;
+        m_settle_left = SETTLE_STEPS;
+        ++m_current;
+        if (m_current < static_cast<int>(m_candidates.size()))
+        {
+            param->tree.leaf_particle_num = m_candidates[m_current];
+            return true;
+        }
+
+        // Sweep done: lock in the cheapest candidate.
+        const int best = static_cast<int>(
+            std::min_element(m_cost.begin(), m_cost.end()) - m_cost.begin());
+        m_chosen = m_candidates[best];
+        param->tree.leaf_particle_num = m_chosen;
+        m_finished = true;
+        WRITE_LOG << "Tree auto-tune locked leafParticleNumber = " << m_chosen
+                  << " (" << m_cost[best] / MEASURE_STEPS << " s/step)";
+        write_report();
+        return true;
+    }
+
+    void TreeTuner::write_report() const
+    {
+        if (m_report_path.empty())
+        {
+            return;
+        }
+        std::ofstream out(m_report_path);
+        if (!out.is_open())
+        {
+            WRITE_LOG << "WARNING: Cannot write tree tuning report: " << m_report_path;
+            return;
+        }
+        out << "{\n";
+        out << "  \"parameter\": \"leafParticleNumber\",\n";
+        out << "  \"chosen\": " << m_chosen << ",\n";
+        out << "  \"steps_per_candidate\": " << MEASURE_STEPS << ",\n";
+        out << "  \"candidates\": [\n";
+        for (size_t i = 0; i < m_candidates.size(); ++i)
+        {
+            out << "    { \"leaf\": " << m_candidates[i]
+                << ", \"mean_step_seconds\": " << std::scientific << std::setprecision(6)
+                << m_cost[i] / MEASURE_STEPS << " }"
+                << (i + 1 < m_candidates.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n";
+        out << "}\n";
+        WRITE_LOG << "Tree tuning report written: " << m_report_path;
+    }
+
+}
@@ -0,0 +1,335 @@
+// Microbenchmark driver for the hot paths: tree construction, neighbor
+// search, PreInteraction, each SPH-type FluidForce and checkpoint writing.
+//
+// Runs every phase over reproducible synthetic particle distributions
+// (seeded Mersenne Twister) at several N and prints ns/particle per phase
+// so regressions can be tracked across releases:
+//
+//     ./sph_bench [N ...]        (default: 4096 16384 65536)
+//
+// Build with -DBUILD_BENCHMARKS=ON; the binary links sph_lib directly and
+// instantiates the concrete modules, so no sample/plugin machinery runs.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include "core/simulation.hpp"
+#include "modules/pre_interaction.hpp"
+#include "modules/fluid_force.hpp"
+#include "algorithms/disph/d_pre_interaction.hpp"
+#include "algorithms/disph/d_fluid_force.hpp"
+#include "algorithms/gsph/g_pre_interaction.hpp"
+#include "algorithms/gsph/g_fluid_force.hpp"
+#include "algorithms/gdisph/gdi_pre_interaction.hpp"
+#include "algorithms/gdisph/gdi_fluid_force.hpp"
+#include "tree/neighbor_searcher.hpp"
+#include "utilities/checkpoint_manager.hpp"
+#include "utilities/scratch_buffers.hpp"
+
+namespace
+{
+
+    using namespace sph;
+
+    constexpr unsigned int bench_seed = 20240531u; // fixed: runs must be comparable
+    constexpr real bench_gamma = 5.0 / 3.0;
+
+    // Parameters equivalent to a plain adiabatic run with the solver's JSON
+    // defaults (cubic spline, 32 neighbors, iterative smoothing lengths).
+    std::shared_ptr<SPHParameters> make_bench_parameters()
+    {
+        auto param = std::make_shared<SPHParameters>();
+        param->type = SPHType::SSPH;
+        param->time.start = 0.0;
+        param->time.end = 1.0;
+        param->time.output = 1.0;
+        param->time.energy = 1.0;
+        param->cfl.sound = 0.3;
+        param->cfl.force = 0.25;
+        param->cfl.ene = 0.3;
+        param->av.alpha = 1.0;
+        param->av.use_balsara_switch = false;
+        param->av.use_time_dependent_av = false;
+        param->ac.is_valid = false;
+        param->tree.max_level = 20;
+        param->tree.leaf_particle_num = 1;
+        param->physics.neighbor_number = 32;
+        param->physics.gamma = bench_gamma;
+        param->kernel = KernelType::CUBIC_SPLINE;
+        param->iterative_sml = true;
+        param->periodic.is_valid = false;
+        param->gravity.is_valid = false;
+        param->gsph.is_2nd_order = false;
+        param->gsph.force_correction = false;
+        return param;
+    }
+
+    void finish_particle(SPHParticle &p, const int id, const real mass, const real dens)
+    {
+        p.id = id;
+        p.mass = mass;
+        p.dens = dens;
+        p.pres = (bench_gamma - 1.0) * dens; // u = 1 -> p = (gamma-1) rho
+        p.ene = 1.0;
+        p.sound = std::sqrt(bench_gamma * (bench_gamma - 1.0) * p.ene);
+        p.alpha = 1.0;
+        p.balsara = 1.0;
+    }
+
+    // Jittered unit lattice: the near-uniform glass-like case every sample
+    // starts from.
+    std::vector<SPHParticle> make_uniform(const int num, std::mt19937 &engine)
+    {
+        const int side = static_cast<int>(std::ceil(std::pow(static_cast<real>(num), 1.0 / DIM)));
+        const real dx = 1.0 / side;
+        std::uniform_real_distribution<real> jitter(-0.05 * dx, 0.05 * dx);
+
+        std::vector<SPHParticle> particles(num);
+        for (int i = 0; i < num; ++i)
+        {
+            int rest = i;
+            for (int d = 0; d < DIM; ++d)
+            {
+                particles[i].pos[d] = (rest % side + 0.5) * dx + jitter(engine);
+                rest /= side;
+            }
+            finish_particle(particles[i], i, 1.0 / num, static_cast<real>(num));
+        }
+        return particles;
+    }
+
+    // Gaussian blobs: strongly varying local density, the worst case for the
+    // tree and for smoothing-length iteration.
+    std::vector<SPHParticle> make_clustered(const int num, std::mt19937 &engine)
+    {
+        constexpr int n_blob = 8;
+        constexpr real sigma = 0.04;
+        std::uniform_real_distribution<real> center(0.2, 0.8);
+        std::normal_distribution<real> offset(0.0, sigma);
+
+        vec_t centers[n_blob];
+        for (int b = 0; b < n_blob; ++b)
+        {
+            for (int d = 0; d < DIM; ++d)
+            {
+                centers[b][d] = center(engine);
+            }
+        }
+
+        const real blob_volume = std::pow(2.0 * M_PI * sigma * sigma, 0.5 * DIM);
+        std::vector<SPHParticle> particles(num);
+        for (int i = 0; i < num; ++i)
+        {
+            const vec_t &c = centers[i % n_blob];
+            for (int d = 0; d < DIM; ++d)
+            {
+                particles[i].pos[d] = c[d] + offset(engine);
+            }
+            finish_particle(particles[i], i, 1.0 / num,
+                            static_cast<real>(num) / (n_blob * blob_volume));
+        }
+        return particles;
+    }
+
+    // Exponential disk matching the razor_thin_hvcc setup: surface density
+    // ~ exp(-r / R_d) in the x-y plane, thin Gaussian vertical structure in 3D.
+    std::vector<SPHParticle> make_disk(const int num, std::mt19937 &engine)
+    {
+        constexpr real r_disk = 0.25;
+        constexpr real h_z = 0.01;
+        std::uniform_real_distribution<real> uniform01(0.0, 1.0);
+        std::normal_distribution<real> vertical(0.0, h_z);
+
+        std::vector<SPHParticle> particles(num);
+        for (int i = 0; i < num; ++i)
+        {
+            auto &p = particles[i];
+#if DIM == 1
+            p.pos[0] = -r_disk * std::log(1.0 - uniform01(engine));
+            const real dens = num * std::exp(-p.pos[0] / r_disk) / r_disk;
+#else
+            // inverse-transform sample of the exponential surface density,
+            // capped at 5 scale radii to keep the root cell bounded
+            real r;
+            do
+            {
+                r = -r_disk * std::log(1.0 - uniform01(engine));
+            } while (r > 5.0 * r_disk);
+            const real phi = 2.0 * M_PI * uniform01(engine);
+            p.pos[0] = r * std::cos(phi);
+            p.pos[1] = r * std::sin(phi);
+            real dens = num * std::exp(-r / r_disk) / (2.0 * M_PI * r_disk * r_disk);
+#if DIM == 3
+            p.pos[2] = vertical(engine);
+            dens *= std::exp(-0.5 * sqr(p.pos[2] / h_z)) / (std::sqrt(2.0 * M_PI) * h_z);
+#endif
+#endif
+            finish_particle(p, i, 1.0 / num, dens);
+        }
+        return particles;
+    }
+
+    double elapsed_ms(const std::chrono::steady_clock::time_point &start)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start);
+        return ns.count() * 1e-6;
+    }
+
+    // Run fn() `reps` times and report the best pass in ns per particle.
+    // Best-of suppresses scheduler noise without needing long runs.
+    template <class Func>
+    void report(const char *dist, const int num, const char *phase, const int reps, Func fn)
+    {
+        double best_ms = 0.0;
+        for (int rep = 0; rep < reps; ++rep)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            const double ms = elapsed_ms(start);
+            if (rep == 0 || ms < best_ms)
+            {
+                best_ms = ms;
+            }
+        }
+        std::printf("%-10s %8d  %-24s %10.3f ms %10.1f ns/particle\n",
+                    dist, num, phase, best_ms, best_ms * 1e6 / num);
+    }
+
+    void bench_distribution(const char *dist, std::vector<SPHParticle> particles)
+    {
+        const int num = static_cast<int>(particles.size());
+        const int reps = std::max(2, static_cast<int>(200000 / num) + 1);
+
+        auto param = make_bench_parameters();
+        auto sim = std::make_shared<Simulation>(param);
+        sim->set_particles(std::move(particles));
+        sim->set_particle_num(num);
+        sim->set_time(0.0);
+        sim->set_dt(0.0);
+        sim->set_h_per_v_sig(1.0);
+
+        auto tree = sim->get_tree();
+        tree->resize(num);
+        sim->make_tree();
+
+        report(dist, num, "BHTree::make", reps, [&]()
+               { sim->make_tree(); });
+
+        // converge the smoothing lengths once so the timed searches see
+        // realistic neighbor counts
+        {
+            PreInteraction pre;
+            pre.initialize(param);
+            pre.calculation(sim);
+            sim->make_tree();
+        }
+
+        auto &p = sim->get_particles();
+        report(dist, num, "neighbor_search", reps, [&]()
+               {
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i)
+            {
+                auto &neighbor_list = scratch_neighbor_buffer(param->physics.neighbor_number * neighbor_list_size);
+                tree->neighbor_search(p[i], neighbor_list, p, true);
+            } });
+
+        // one (pre, force) pair per SPH type: the PreInteraction fills the
+        // per-type state (volume, q, gradients) its FluidForce reads
+        struct TypedModules
+        {
+            const char *pre_phase;
+            const char *force_phase;
+            SPHType type;
+            std::shared_ptr<PreInteraction> pre;
+            std::shared_ptr<FluidForce> force;
+        };
+        const TypedModules typed[] = {
+            {"PreInteraction[SSPH]", "FluidForce[SSPH]", SPHType::SSPH,
+             std::make_shared<PreInteraction>(), std::make_shared<FluidForce>()},
+            {"PreInteraction[DISPH]", "FluidForce[DISPH]", SPHType::DISPH,
+             std::make_shared<disph::PreInteraction>(), std::make_shared<disph::FluidForce>()},
+            {"PreInteraction[GSPH]", "FluidForce[GSPH]", SPHType::GSPH,
+             std::make_shared<gsph::PreInteraction>(), std::make_shared<gsph::FluidForce>()},
+            {"PreInteraction[GDISPH]", "FluidForce[GDISPH]", SPHType::GDISPH,
+             std::make_shared<gdisph::PreInteraction>(), std::make_shared<gdisph::FluidForce>()},
+        };
+
+        // gradient arrays for the Godunov variants (see Solver::initialize)
+        std::vector<std::string> names = {"grad_density", "grad_pressure", "grad_velocity_0"};
+#if DIM >= 2
+        names.push_back("grad_velocity_1");
+#endif
+#if DIM == 3
+        names.push_back("grad_velocity_2");
+#endif
+        sim->add_vector_array(names);
+
+        for (const auto &mod : typed)
+        {
+            param->type = mod.type;
+            mod.pre->initialize(param);
+            mod.force->initialize(param);
+            report(dist, num, mod.pre_phase, reps, [&]()
+                   { mod.pre->calculation(sim); });
+            sim->build_neighbor_cache();
+            report(dist, num, mod.force_phase, reps, [&]()
+                   { mod.force->calculation(sim); });
+        }
+        param->type = SPHType::SSPH;
+
+        const std::string checkpoint_file =
+            (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("sph_bench_%%%%.chk")).string();
+        CheckpointManager manager;
+        report(dist, num, "save_checkpoint", reps, [&]()
+               { manager.save_checkpoint(checkpoint_file, *sim, *param); });
+        boost::filesystem::remove(checkpoint_file);
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; ++i)
+    {
+        const int n = std::atoi(argv[i]);
+        if (n <= 0)
+        {
+            std::fprintf(stderr, "usage: %s [N ...]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        sizes.push_back(n);
+    }
+    if (sizes.empty())
+    {
+        sizes = {4096, 16384, 65536};
+    }
+
+    std::printf("sph_bench (DIM=%d, seed=%u): best-of pass per phase\n", DIM, bench_seed);
+    for (const int num : sizes)
+    {
+        // one engine per distribution so adding an N never changes the
+        // samples drawn for another
+        std::mt19937 uniform_engine(bench_seed);
+        std::mt19937 clustered_engine(bench_seed + 1);
+        std::mt19937 disk_engine(bench_seed + 2);
+
+        bench_distribution("uniform", make_uniform(num, uniform_engine));
+        bench_distribution("clustered", make_clustered(num, clustered_engine));
+        bench_distribution("disk", make_disk(num, disk_engine));
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,291 @@
+// Performance regression gate for the per-module step times.
+//
+// Runs a fixed-seed mid-size problem (jittered lattice, 16384 particles)
+// through N pseudo-steps per SPH type — tree build, PreInteraction,
+// neighbor cache, FluidForce — timed with the same StepTimer
+// instrumentation the solver uses, and compares each phase total against
+// a budget file:
+//
+//     ./sph_perf_test <baseline-file> [tolerance]
+//
+// When the baseline file does not exist the measured totals are recorded
+// to it and the run passes; afterwards every phase must stay within
+// budget × tolerance (default 1.5) or the test fails, listing the
+// regressed phases. Budgets are machine-specific, so the baseline lives
+// in the build tree, not the repository; delete it to re-record after an
+// intentional change. Wired into CTest (test name: perf_regression) so
+// it runs with the rest of the suite before a build rolls out.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include "core/simulation.hpp"
+#include "modules/pre_interaction.hpp"
+#include "modules/fluid_force.hpp"
+#include "algorithms/disph/d_pre_interaction.hpp"
+#include "algorithms/disph/d_fluid_force.hpp"
+#include "algorithms/gsph/g_pre_interaction.hpp"
+#include "algorithms/gsph/g_fluid_force.hpp"
+#include "algorithms/gdisph/gdi_pre_interaction.hpp"
+#include "algorithms/gdisph/gdi_fluid_force.hpp"
+#include "tree/neighbor_searcher.hpp"
+#include "utilities/step_timer.hpp"
+
+namespace
+{
+
+    using namespace sph;
+
+    constexpr unsigned int perf_seed = 20240531u; // fixed: runs must be comparable
+    constexpr real perf_gamma = 5.0 / 3.0;
+    constexpr int perf_num = 16384;
+    constexpr int perf_steps = 5;
+    constexpr double default_tolerance = 1.5;
+    // Sub-noise phases (a few ms) jitter far beyond any tolerance factor;
+    // a regression must also clear this many ms over budget to count.
+    constexpr double noise_floor_ms = 25.0;
+
+    std::shared_ptr<SPHParameters> make_parameters()
+    {
+        auto param = std::make_shared<SPHParameters>();
+        param->type = SPHType::SSPH;
+        param->time.start = 0.0;
+        param->time.end = 1.0;
+        param->time.output = 1.0;
+        param->time.energy = 1.0;
+        param->cfl.sound = 0.3;
+        param->cfl.force = 0.25;
+        param->cfl.ene = 0.3;
+        param->av.alpha = 1.0;
+        param->av.use_balsara_switch = false;
+        param->av.use_time_dependent_av = false;
+        param->ac.is_valid = false;
+        param->tree.max_level = 20;
+        param->tree.leaf_particle_num = 1;
+        param->physics.neighbor_number = 32;
+        param->physics.gamma = perf_gamma;
+        param->kernel = KernelType::CUBIC_SPLINE;
+        param->iterative_sml = true;
+        param->periodic.is_valid = false;
+        param->gravity.is_valid = false;
+        param->gsph.is_2nd_order = false;
+        param->gsph.force_correction = false;
+        return param;
+    }
+
+    // Jittered unit lattice at a fixed seed, as in test/benchmark.
+    std::vector<SPHParticle> make_uniform(const int num)
+    {
+        std::mt19937 engine(perf_seed);
+        const int side = static_cast<int>(std::ceil(std::pow(static_cast<real>(num), 1.0 / DIM)));
+        const real dx = 1.0 / side;
+        std::uniform_real_distribution<real> jitter(-0.05 * dx, 0.05 * dx);
+
+        std::vector<SPHParticle> particles(num);
+        for (int i = 0; i < num; ++i)
+        {
+            auto &p = particles[i];
+            int rest = i;
+            for (int d = 0; d < DIM; ++d)
+            {
+                p.pos[d] = (rest % side + 0.5) * dx + jitter(engine);
+                rest /= side;
+            }
+            p.id = i;
+            p.mass = 1.0 / num;
+            p.dens = static_cast<real>(num);
+            p.pres = (perf_gamma - 1.0) * p.dens;
+            p.ene = 1.0;
+            p.sound = std::sqrt(perf_gamma * (perf_gamma - 1.0) * p.ene);
+            p.alpha = 1.0;
+            p.balsara = 1.0;
+        }
+        return particles;
+    }
+
+    struct TypedModules
+    {
+        const char *name;
+        SPHType type;
+        std::shared_ptr<PreInteraction> pre;
+        std::shared_ptr<FluidForce> force;
+        // stable storage for the per-type phase labels StepTimer points at
+        std::string tree_phase, pre_phase, cache_phase, force_phase;
+    };
+
+    // Time perf_steps (tree, pre, cache, force) rounds for one SPH type,
+    // folding each phase into the shared timer's running totals.
+    void run_type(StepTimer &timer, TypedModules &mod,
+                  std::shared_ptr<SPHParameters> param, std::shared_ptr<Simulation> sim)
+    {
+        param->type = mod.type;
+        mod.pre->initialize(param);
+        mod.force->initialize(param);
+
+        mod.tree_phase = std::string(mod.name) + "/tree";
+        mod.pre_phase = std::string(mod.name) + "/pre_interaction";
+        mod.cache_phase = std::string(mod.name) + "/neighbor_cache";
+        mod.force_phase = std::string(mod.name) + "/fluid_force";
+
+        for (int step = 0; step < perf_steps; ++step)
+        {
+            timer.begin_step(static_cast<real>(step));
+            {
+                StepTimer::Scope scope(timer, mod.tree_phase.c_str());
+                sim->make_tree();
+            }
+            {
+                StepTimer::Scope scope(timer, mod.pre_phase.c_str());
+                mod.pre->calculation(sim);
+            }
+            {
+                StepTimer::Scope scope(timer, mod.cache_phase.c_str());
+                sim->build_neighbor_cache();
+            }
+            {
+                StepTimer::Scope scope(timer, mod.force_phase.c_str());
+                mod.force->calculation(sim);
+            }
+            timer.end_step();
+        }
+    }
+
+    std::map<std::string, double> read_baseline(const std::string &path)
+    {
+        std::map<std::string, double> budgets;
+        std::ifstream in(path);
+        std::string name;
+        double ms;
+        while (in >> name >> ms)
+        {
+            budgets[name] = ms;
+        }
+        return budgets;
+    }
+
+    void write_baseline(const std::string &path,
+                        const std::vector<std::pair<std::string, double>> &totals)
+    {
+        std::ofstream out(path);
+        for (const auto &entry : totals)
+        {
+            out << entry.first << ' ' << entry.second << '\n';
+        }
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s <baseline-file> [tolerance]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const std::string baseline_file = argv[1];
+    const double tolerance = argc > 2 ? std::atof(argv[2]) : default_tolerance;
+
+    auto param = make_parameters();
+    auto sim = std::make_shared<Simulation>(param);
+    sim->set_particles(make_uniform(perf_num));
+    sim->set_particle_num(perf_num);
+    sim->set_time(0.0);
+    sim->set_dt(0.0);
+    sim->set_h_per_v_sig(1.0);
+    sim->get_tree()->resize(perf_num);
+    sim->make_tree();
+
+    // converge the smoothing lengths once so the timed phases see
+    // realistic neighbor counts (matches test/benchmark)
+    {
+        PreInteraction pre;
+        pre.initialize(param);
+        pre.calculation(sim);
+        sim->make_tree();
+    }
+
+    // gradient arrays for the Godunov variants (see Solver::initialize)
+    std::vector<std::string> names = {"grad_density", "grad_pressure", "grad_velocity_0"};
+#if DIM >= 2
+    names.push_back("grad_velocity_1");
+#endif
+#if DIM == 3
+    names.push_back("grad_velocity_2");
+#endif
+    sim->add_vector_array(names);
+
+    StepTimer timer;
+    timer.enable(baseline_file + ".steps.csv");
+
+    TypedModules typed[] = {
+        {"SSPH", SPHType::SSPH,
+         std::make_shared<PreInteraction>(), std::make_shared<FluidForce>()},
+        {"DISPH", SPHType::DISPH,
+         std::make_shared<disph::PreInteraction>(), std::make_shared<disph::FluidForce>()},
+        {"GSPH", SPHType::GSPH,
+         std::make_shared<gsph::PreInteraction>(), std::make_shared<gsph::FluidForce>()},
+        {"GDISPH", SPHType::GDISPH,
+         std::make_shared<gdisph::PreInteraction>(), std::make_shared<gdisph::FluidForce>()},
+    };
+    for (auto &mod : typed)
+    {
+        run_type(timer, mod, param, sim);
+    }
+
+    const auto &totals = timer.totals();
+
+    std::ifstream existing(baseline_file);
+    if (!existing.is_open())
+    {
+        write_baseline(baseline_file, totals);
+        std::printf("perf_regression: no baseline at %s — recorded %zu phase budgets\n",
+                    baseline_file.c_str(), totals.size());
+        std::printf("(subsequent runs fail when a phase exceeds budget x %.2f)\n", tolerance);
+        return EXIT_SUCCESS;
+    }
+    existing.close();
+
+    const auto budgets = read_baseline(baseline_file);
+    int failures = 0;
+    std::printf("perf_regression: %d particles, %d steps/type, tolerance x %.2f\n",
+                perf_num, perf_steps, tolerance);
+    for (const auto &entry : totals)
+    {
+        const auto it = budgets.find(entry.first);
+        if (it == budgets.end())
+        {
+            std::printf("  %-28s %9.2f ms  (no budget — re-record the baseline)\n",
+                        entry.first.c_str(), entry.second);
+            continue;
+        }
+        const double budget_ms = std::max(it->second * tolerance,
+                                          it->second + noise_floor_ms);
+        const bool ok = entry.second <= budget_ms;
+        std::printf("  %-28s %9.2f ms  budget %9.2f ms  %s\n",
+                    entry.first.c_str(), entry.second, budget_ms, ok ? "ok" : "REGRESSED");
+        if (!ok)
+        {
+            ++failures;
+        }
+    }
+
+    if (failures > 0)
+    {
+        std::fprintf(stderr,
+                     "perf_regression: %d phase(s) over budget; if intentional, delete %s "
+                     "to re-record\n",
+                     failures, baseline_file.c_str());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -88,6 +88,58 @@ TEST_F(CheckpointBasicTest, CheckpointManagerCreation) {
     EXPECT_TRUE(manager.should_checkpoint(0.5));
 }
 
+TEST_F(CheckpointBasicTest, RegistryIndexAndRebuild) {
+    CheckpointManager manager;
+
+    Simulation sim(params_);
+    std::vector<SPHParticle> particles(4);
+    for (int i = 0; i < 4; ++i) {
+        particles[i].id = i;
+        particles[i].mass = 1.0;
+        particles[i].dens = 1.0;
+        particles[i].sml = 0.1;
+    }
+    sim.set_particle_num(static_cast<int>(particles.size()));
+    sim.set_particles(std::move(particles));
+    sim.set_dt(0.001);
+
+    sim.set_time(0.25);
+    manager.save_checkpoint(test_dir_ + "/checkpoint_t0.250.chk", sim, *params_);
+    sim.set_time(0.5);
+    manager.save_checkpoint(test_dir_ + "/checkpoint_t0.500.chk", sim, *params_);
+
+    // Saves append to the index
+    auto entries = manager.read_registry(test_dir_);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].name, "checkpoint_t0.250.chk");
+    EXPECT_GT(entries[0].size, 0u);
+    EXPECT_FALSE(entries[1].digest.empty());
+    EXPECT_DOUBLE_EQ(entries[1].time, 0.5);
+
+    // Discovery consults the index, not the directory
+    EXPECT_EQ(manager.find_latest_checkpoint(test_dir_),
+              test_dir_ + "/checkpoint_t0.500.chk");
+
+    // A deleted index self-heals from the file headers
+    fs::remove(test_dir_ + "/registry.txt");
+    entries = manager.read_registry(test_dir_);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_DOUBLE_EQ(entries[0].time, 0.25);
+    EXPECT_FALSE(entries[0].digest.empty());
+
+    // Rotation seeds from the index and appends removal records
+    CheckpointManager::AutoCheckpointConfig config;
+    config.enabled = true;
+    config.max_keep = 1;
+    manager.configure_auto_checkpoint(config);
+    manager.record_checkpoint(test_dir_ + "/checkpoint_t0.500.chk", 0.5);
+
+    entries = manager.read_registry(test_dir_);
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].name, "checkpoint_t0.500.chk");
+    EXPECT_FALSE(fs::exists(test_dir_ + "/checkpoint_t0.250.chk"));
+}
+
 TEST_F(CheckpointBasicTest, DISABLED_BasicSaveLoad) {
     // This test is disabled until we implement load_checkpoint()
     // For now, just test that we can create a checkpoint manager
@@ -130,10 +130,10 @@ TEST_F(CheckpointDataTest, GetTotalSize) {
     // Should include:
     // - 512 bytes header
     // - ~3000 bytes params estimate
-    // - 100 * sizeof(SPHParticle) bytes particles
+    // - 100 * sizeof(CompactCheckpointParticle) bytes particles
     // - 32 bytes checksum
-    
-    size_t expected_min = 512 + 100 * sizeof(SPHParticle) + 32;
+
+    size_t expected_min = 512 + 100 * sizeof(CompactCheckpointParticle) + 32;
     EXPECT_GE(total_size, expected_min) << "Total size should be at least header + particles + checksum";
     
     // Should be reasonable (not gigabytes for 100 particles)
@@ -200,8 +200,9 @@ TEST_F(CheckpointDataTest, LargeParticleCount) {
     
     size_t total_size = data.get_total_size();
     
-    // For 10K particles, should be several MB
-    EXPECT_GT(total_size, 1000000) << "10K particles should take >1MB";
+    // For 10K particles the compact v5 records dominate the file
+    EXPECT_GT(total_size, 10000 * sizeof(CompactCheckpointParticle))
+        << "10K particles should dominate the estimated size";
 }
 
 } // namespace sph
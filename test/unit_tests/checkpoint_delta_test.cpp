@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include "utilities/checkpoint_manager.hpp"
+#include "utilities/checkpoint_data.hpp"
+#include "core/simulation.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include <boost/filesystem.hpp>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace fs = boost::filesystem;
+
+namespace sph {
+
+/**
+ * @brief Tests for the keyframe + delta checkpoint chain
+ *
+ * Delta mode writes full keyframes every keyframe_interval checkpoints
+ * and small field-override deltas in between; loading a delta replays
+ * its keyframe transparently (see checkpoint_data.hpp for the format).
+ */
+class CheckpointDeltaTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = "test_checkpoint_delta";
+        if (!fs::exists(test_dir_)) {
+            fs::create_directory(test_dir_);
+        }
+
+        params_ = std::make_shared<SPHParameters>();
+        params_->type = SPHType::SSPH;
+        params_->physics.gamma = 5.0/3.0;
+        params_->physics.neighbor_number = 50;
+        params_->time.start = 0.0;
+        params_->time.end = 1.0;
+        params_->cfl.sound = 0.25;
+        params_->cfl.force = 0.25;
+        params_->kernel = KernelType::CUBIC_SPLINE;
+
+        sim_ = std::make_shared<Simulation>(params_);
+        std::vector<SPHParticle> particles(kNumParticles);
+        for (int i = 0; i < kNumParticles; ++i) {
+            SPHParticle& p = particles[i];
+            for (int d = 0; d < DIM; ++d) {
+                p.pos[d] = static_cast<real>(i) / kNumParticles + 0.01 * d;
+                p.vel[d] = 0.1 * std::sin(2.0 * M_PI * i / kNumParticles);
+            }
+            p.mass = 1.0 / kNumParticles;
+            p.dens = 1.0 + 0.2 * std::cos(2.0 * M_PI * i / kNumParticles);
+            p.pres = 1.0 + 0.3 * i / kNumParticles;
+            p.ene = 1.5;
+            p.sml = 0.1;
+            p.id = i;
+            p.neighbor = 50;
+        }
+        sim_->set_particle_num(kNumParticles);
+        sim_->set_particles(std::move(particles));
+        sim_->set_time(0.1);
+        sim_->set_dt(0.001);
+    }
+
+    void TearDown() override {
+        if (fs::exists(test_dir_)) {
+            fs::remove_all(test_dir_);
+        }
+    }
+
+    /**
+     * @brief Build a manager with delta mode enabled
+     */
+    CheckpointManager make_delta_manager(int keyframe_interval, real tolerance) {
+        CheckpointManager::AutoCheckpointConfig config;
+        config.enabled = true;
+        config.interval = 0.1;
+        config.max_keep = 100;
+        config.delta_enabled = true;
+        config.keyframe_interval = keyframe_interval;
+        config.delta_tolerance = tolerance;
+        return CheckpointManager(config);
+    }
+
+    /**
+     * @brief Read the 8-byte magic of a checkpoint file
+     */
+    std::string read_magic(const std::string& filepath) {
+        std::ifstream file(filepath, std::ios::binary);
+        char magic[9] = {0};
+        file.read(magic, 8);
+        return std::string(magic);
+    }
+
+    static constexpr int kNumParticles = 500;
+
+    std::string test_dir_;
+    std::shared_ptr<SPHParameters> params_;
+    std::shared_ptr<Simulation> sim_;
+};
+
+constexpr int CheckpointDeltaTest::kNumParticles;
+
+TEST_F(CheckpointDeltaTest, SecondSaveIsDelta) {
+    CheckpointManager manager = make_delta_manager(10, 0.0);
+
+    const std::string keyframe = test_dir_ + "/keyframe.chk";
+    const std::string delta = test_dir_ + "/delta.chk";
+
+    manager.save_checkpoint(keyframe, *sim_, *params_);
+    manager.save_checkpoint(delta, *sim_, *params_);
+
+    EXPECT_EQ(read_magic(keyframe), "SPHCHKPT");
+    EXPECT_EQ(read_magic(delta), "SPHCHKDL");
+
+    // Nothing changed between the saves: the delta is header + empty
+    // field blocks + checksum, a tiny fraction of the full file
+    EXPECT_LT(fs::file_size(delta), fs::file_size(keyframe) / 10);
+}
+
+TEST_F(CheckpointDeltaTest, DeltaRoundtripRestoresChangedFields) {
+    CheckpointManager manager = make_delta_manager(10, 0.0);
+
+    const std::string keyframe = test_dir_ + "/keyframe.chk";
+    const std::string delta = test_dir_ + "/delta.chk";
+
+    manager.save_checkpoint(keyframe, *sim_, *params_);
+
+    // Move a few particles and change the simulation clock
+    auto& particles = sim_->get_particles();
+    particles[3].dens = 42.0;
+    particles[3].pos[0] += 0.5;
+    particles[250].ene = 7.5;
+    particles[250].neighbor = 12;
+    sim_->set_time(0.2);
+    sim_->set_dt(0.002);
+
+    manager.save_checkpoint(delta, *sim_, *params_);
+    ASSERT_EQ(read_magic(delta), "SPHCHKDL");
+
+    CheckpointData loaded = manager.load_checkpoint(delta);
+    ASSERT_EQ(loaded.particles.size(), static_cast<size_t>(kNumParticles));
+
+    EXPECT_DOUBLE_EQ(loaded.time, 0.2);
+    EXPECT_DOUBLE_EQ(loaded.dt, 0.002);
+    EXPECT_DOUBLE_EQ(loaded.particles[3].dens, 42.0);
+    EXPECT_DOUBLE_EQ(loaded.particles[3].pos[0], particles[3].pos[0]);
+    EXPECT_DOUBLE_EQ(loaded.particles[250].ene, 7.5);
+    EXPECT_EQ(loaded.particles[250].neighbor, 12);
+
+    // Untouched particles come back from the keyframe exactly
+    EXPECT_DOUBLE_EQ(loaded.particles[100].dens, particles[100].dens);
+    EXPECT_DOUBLE_EQ(loaded.particles[100].pos[0], particles[100].pos[0]);
+    EXPECT_EQ(loaded.particles[100].id, 100);
+}
+
+TEST_F(CheckpointDeltaTest, ToleranceKeepsKeyframeValues) {
+    CheckpointManager manager = make_delta_manager(10, 1.0e-3);
+
+    const std::string keyframe = test_dir_ + "/keyframe.chk";
+    const std::string delta = test_dir_ + "/delta.chk";
+
+    manager.save_checkpoint(keyframe, *sim_, *params_);
+
+    auto& particles = sim_->get_particles();
+    const real dens_before = particles[7].dens;
+    particles[7].dens *= 1.0 + 1.0e-6;  // below tolerance: not stored
+    particles[8].dens *= 2.0;           // above tolerance: stored
+
+    manager.save_checkpoint(delta, *sim_, *params_);
+    CheckpointData loaded = manager.load_checkpoint(delta);
+
+    EXPECT_DOUBLE_EQ(loaded.particles[7].dens, dens_before);
+    EXPECT_DOUBLE_EQ(loaded.particles[8].dens, particles[8].dens);
+}
+
+TEST_F(CheckpointDeltaTest, KeyframeWrittenEveryInterval) {
+    CheckpointManager manager = make_delta_manager(3, 0.0);
+
+    std::vector<std::string> expected_magic = {
+        "SPHCHKPT", "SPHCHKDL", "SPHCHKDL", "SPHCHKPT", "SPHCHKDL"
+    };
+    for (size_t i = 0; i < expected_magic.size(); ++i) {
+        const std::string path = test_dir_ + "/chk_" + std::to_string(i) + ".chk";
+        manager.save_checkpoint(path, *sim_, *params_);
+        EXPECT_EQ(read_magic(path), expected_magic[i]) << "checkpoint " << i;
+    }
+}
+
+TEST_F(CheckpointDeltaTest, DeltaValidates) {
+    CheckpointManager manager = make_delta_manager(10, 0.0);
+
+    const std::string keyframe = test_dir_ + "/keyframe.chk";
+    const std::string delta = test_dir_ + "/delta.chk";
+    manager.save_checkpoint(keyframe, *sim_, *params_);
+    manager.save_checkpoint(delta, *sim_, *params_);
+
+    CheckpointValidation result = manager.validate_checkpoint(delta);
+    EXPECT_TRUE(result.is_valid) << result.error_message;
+    EXPECT_TRUE(result.magic_ok);
+    EXPECT_TRUE(result.version_ok);
+    EXPECT_TRUE(result.checksum_ok);
+}
+
+TEST_F(CheckpointDeltaTest, CleanupKeepsReferencedKeyframe) {
+    CheckpointManager::AutoCheckpointConfig config;
+    config.enabled = true;
+    config.interval = 0.1;
+    config.max_keep = 1;
+    config.delta_enabled = true;
+    config.keyframe_interval = 10;
+    config.delta_tolerance = 0.0;
+    CheckpointManager manager(config);
+
+    const std::string keyframe = test_dir_ + "/keyframe.chk";
+    const std::string delta = test_dir_ + "/delta.chk";
+
+    manager.save_checkpoint(keyframe, *sim_, *params_);
+    manager.record_checkpoint(keyframe, 0.1);
+    manager.save_checkpoint(delta, *sim_, *params_);
+    manager.record_checkpoint(delta, 0.2);
+
+    // max_keep = 1: the delta (useless alone) is dropped, never the
+    // keyframe it still references
+    EXPECT_TRUE(fs::exists(keyframe));
+    EXPECT_FALSE(fs::exists(delta));
+    EXPECT_EQ(manager.get_checkpoint_files().size(), 1u);
+}
+
+} // namespace sph
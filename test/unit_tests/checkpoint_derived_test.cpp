@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "utilities/checkpoint_manager.hpp"
+#include "utilities/checkpoint_data.hpp"
+#include "core/simulation.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include <boost/filesystem.hpp>
+#include <cmath>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace sph {
+
+/**
+ * @brief Tests for the warm-restart derived-state checkpoint section
+ *
+ * Full checkpoints append an optional "SPHDERIV" section after the particle
+ * records carrying what the restore-time pre-interaction pass would
+ * recompute: per-particle derived fields, the global h/v_sig minimum, the
+ * neighbor-list CSR cache and the named additional arrays (see
+ * DerivedState in checkpoint_data.hpp).
+ */
+class CheckpointDerivedTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = "test_checkpoint_derived";
+        if (!fs::exists(test_dir_)) {
+            fs::create_directory(test_dir_);
+        }
+
+        params_ = std::make_shared<SPHParameters>();
+        params_->type = SPHType::SSPH;
+        params_->physics.gamma = 5.0/3.0;
+        params_->physics.neighbor_number = 50;
+        params_->time.start = 0.0;
+        params_->time.end = 1.0;
+        params_->cfl.sound = 0.25;
+        params_->cfl.force = 0.25;
+        params_->kernel = KernelType::CUBIC_SPLINE;
+
+        sim_ = std::make_shared<Simulation>(params_);
+        std::vector<SPHParticle> particles(kNumParticles);
+        for (int i = 0; i < kNumParticles; ++i) {
+            SPHParticle& p = particles[i];
+            for (int d = 0; d < DIM; ++d) {
+                p.pos[d] = static_cast<real>(i) / kNumParticles + 0.01 * d;
+            }
+            p.mass = 1.0 / kNumParticles;
+            p.dens = 1.0 + 0.2 * std::cos(2.0 * M_PI * i / kNumParticles);
+            p.ene = 1.5;
+            p.sml = 0.1;
+            p.id = i;
+
+            // Derived fields the section should round-trip
+            p.pres = 1.0 + 0.3 * i / kNumParticles;
+            p.sound = std::sqrt(params_->physics.gamma * p.pres / p.dens);
+            p.balsara = 0.5 + 0.001 * i;
+            p.gradh = 1.0 - 0.0005 * i;
+            p.volume = p.mass / p.dens;
+            p.q = p.dens * p.ene;
+            p.h_per_v_sig = p.sml / (p.sound + 0.1);
+            p.h_dot = -0.001 * i;
+            p.neighbor = 40 + i % 10;
+        }
+        sim_->set_particle_num(kNumParticles);
+        sim_->set_particles(std::move(particles));
+        sim_->set_time(0.1);
+        sim_->set_dt(0.001);
+        sim_->set_h_per_v_sig(0.05);
+    }
+
+    void TearDown() override {
+        if (fs::exists(test_dir_)) {
+            fs::remove_all(test_dir_);
+        }
+    }
+
+    /**
+     * @brief Give the simulation a small synthetic neighbor-cache CSR
+     */
+    void adopt_test_cache() {
+        std::vector<int> offsets(kNumParticles + 1);
+        std::vector<int> indices;
+        for (int i = 0; i < kNumParticles; ++i) {
+            offsets[i] = static_cast<int>(indices.size());
+            indices.push_back((i + 1) % kNumParticles);
+            indices.push_back((i + 2) % kNumParticles);
+        }
+        offsets[kNumParticles] = static_cast<int>(indices.size());
+        sim_->adopt_neighbor_cache(std::move(offsets), std::move(indices));
+    }
+
+    static constexpr int kNumParticles = 200;
+
+    std::string test_dir_;
+    std::shared_ptr<SPHParameters> params_;
+    std::shared_ptr<Simulation> sim_;
+};
+
+constexpr int CheckpointDerivedTest::kNumParticles;
+
+TEST_F(CheckpointDerivedTest, DerivedStateRoundtrips) {
+    adopt_test_cache();
+
+    // Named additional arrays, like the GSPH MUSCL gradients
+    sim_->add_scalar_array({"test_scalar"});
+    sim_->add_vector_array({"test_vector"});
+    auto& scalar = sim_->get_scalar_array("test_scalar");
+    auto& vector = sim_->get_vector_array("test_vector");
+    for (int i = 0; i < kNumParticles; ++i) {
+        scalar[i] = 0.5 * i;
+        for (int d = 0; d < DIM; ++d) {
+            vector[i][d] = 0.1 * i + d;
+        }
+    }
+
+    CheckpointManager manager;
+    const std::string filepath = test_dir_ + "/derived.chk";
+    manager.save_checkpoint(filepath, *sim_, *params_);
+
+    CheckpointData loaded = manager.load_checkpoint(filepath);
+    ASSERT_TRUE(loaded.derived.present);
+    ASSERT_EQ(loaded.derived.records.size(), static_cast<size_t>(kNumParticles));
+    EXPECT_DOUBLE_EQ(loaded.derived.h_per_v_sig, 0.05);
+
+    const auto& particles = sim_->get_particles();
+    for (int i = 0; i < kNumParticles; i += 37) {
+        const DerivedParticleRecord& rec = loaded.derived.records[i];
+        EXPECT_DOUBLE_EQ(rec.pres, particles[i].pres);
+        EXPECT_DOUBLE_EQ(rec.sound, particles[i].sound);
+        EXPECT_DOUBLE_EQ(rec.balsara, particles[i].balsara);
+        EXPECT_DOUBLE_EQ(rec.gradh, particles[i].gradh);
+        EXPECT_DOUBLE_EQ(rec.volume, particles[i].volume);
+        EXPECT_DOUBLE_EQ(rec.h_per_v_sig, particles[i].h_per_v_sig);
+        EXPECT_DOUBLE_EQ(rec.h_dot, particles[i].h_dot);
+        EXPECT_EQ(rec.neighbor, particles[i].neighbor);
+    }
+
+    // Neighbor-list CSR cache
+    ASSERT_TRUE(loaded.derived.has_neighbor_cache);
+    const auto& cache = sim_->get_neighbor_cache();
+    EXPECT_EQ(loaded.derived.nb_offsets, cache.offsets());
+    EXPECT_EQ(loaded.derived.nb_indices, cache.indices());
+
+    // Named arrays, vectors flattened to DIM reals per entry
+    ASSERT_EQ(loaded.derived.scalar_arrays.size(), 1u);
+    EXPECT_EQ(loaded.derived.scalar_arrays[0].first, "test_scalar");
+    EXPECT_DOUBLE_EQ(loaded.derived.scalar_arrays[0].second[100], 50.0);
+    ASSERT_EQ(loaded.derived.vector_arrays.size(), 1u);
+    EXPECT_EQ(loaded.derived.vector_arrays[0].first, "test_vector");
+    EXPECT_DOUBLE_EQ(loaded.derived.vector_arrays[0].second[100 * DIM], 10.0);
+}
+
+TEST_F(CheckpointDerivedTest, SectionWithoutCacheOmitsCsr) {
+    // No cache adopted: the section still carries the per-particle records
+    // but flags the CSR as absent
+    CheckpointManager manager;
+    const std::string filepath = test_dir_ + "/no_cache.chk";
+    manager.save_checkpoint(filepath, *sim_, *params_);
+
+    CheckpointData loaded = manager.load_checkpoint(filepath);
+    ASSERT_TRUE(loaded.derived.present);
+    EXPECT_FALSE(loaded.derived.has_neighbor_cache);
+    EXPECT_TRUE(loaded.derived.nb_offsets.empty());
+    EXPECT_EQ(loaded.derived.records.size(), static_cast<size_t>(kNumParticles));
+}
+
+TEST_F(CheckpointDerivedTest, ParticleStateUnaffectedBySection) {
+    // The section must not shift the particle records: true state loads
+    // exactly as before it existed
+    adopt_test_cache();
+    CheckpointManager manager;
+    const std::string filepath = test_dir_ + "/particles.chk";
+    manager.save_checkpoint(filepath, *sim_, *params_);
+
+    CheckpointData loaded = manager.load_checkpoint(filepath);
+    ASSERT_EQ(loaded.particles.size(), static_cast<size_t>(kNumParticles));
+    const auto& particles = sim_->get_particles();
+    for (int i = 0; i < kNumParticles; i += 41) {
+        EXPECT_DOUBLE_EQ(loaded.particles[i].pos[0], particles[i].pos[0]);
+        EXPECT_DOUBLE_EQ(loaded.particles[i].dens, particles[i].dens);
+        EXPECT_DOUBLE_EQ(loaded.particles[i].ene, particles[i].ene);
+        EXPECT_EQ(loaded.particles[i].id, particles[i].id);
+    }
+}
+
+} // namespace sph
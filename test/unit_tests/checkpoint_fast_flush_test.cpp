@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "utilities/checkpoint_manager.hpp"
+#include "utilities/checkpoint_data.hpp"
+#include "core/simulation.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include <boost/filesystem.hpp>
+#include <cmath>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace sph {
+
+/**
+ * @brief Tests for the preemption fast-flush checkpoint path
+ *
+ * save_checkpoint_fast() is the SIGTERM path: a self-contained
+ * compact-schema checkpoint packed straight from the live particle array,
+ * with the delta chain bypassed and the derived warm-restart section
+ * omitted. The file has to load through the regular path unchanged.
+ */
+class CheckpointFastFlushTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = "test_checkpoint_fast_flush";
+        if (!fs::exists(test_dir_)) {
+            fs::create_directory(test_dir_);
+        }
+
+        params_ = std::make_shared<SPHParameters>();
+        params_->type = SPHType::SSPH;
+        params_->physics.gamma = 5.0/3.0;
+        params_->physics.neighbor_number = 32;
+        params_->time.start = 0.0;
+        params_->time.end = 1.0;
+        params_->cfl.sound = 0.25;
+        params_->cfl.force = 0.25;
+        params_->kernel = KernelType::CUBIC_SPLINE;
+
+        sim_ = std::make_shared<Simulation>(params_);
+        std::vector<SPHParticle> particles(kNumParticles);
+        for (int i = 0; i < kNumParticles; ++i) {
+            SPHParticle& p = particles[i];
+            for (int d = 0; d < DIM; ++d) {
+                p.pos[d] = static_cast<real>(i) / kNumParticles + 0.01 * d;
+                p.vel[d] = 0.1 * i - 0.02 * d;
+            }
+            p.mass = 1.0 / kNumParticles;
+            p.dens = 1.0 + 0.2 * std::sin(2.0 * M_PI * i / kNumParticles);
+            p.ene = 1.5 + 0.001 * i;
+            p.sml = 0.1;
+            p.alpha = 1.0;
+            p.id = i;
+        }
+        sim_->set_particle_num(kNumParticles);
+        sim_->set_particles(std::move(particles));
+        sim_->set_time(0.25);
+        sim_->set_dt(0.002);
+    }
+
+    void TearDown() override {
+        if (fs::exists(test_dir_)) {
+            fs::remove_all(test_dir_);
+        }
+    }
+
+    static constexpr int kNumParticles = 300;
+
+    std::string test_dir_;
+    std::shared_ptr<SPHParameters> params_;
+    std::shared_ptr<Simulation> sim_;
+};
+
+constexpr int CheckpointFastFlushTest::kNumParticles;
+
+TEST_F(CheckpointFastFlushTest, LoadsThroughTheRegularPath) {
+    CheckpointManager manager;
+    const std::string filepath = test_dir_ + "/fast.chk";
+    manager.save_checkpoint_fast(filepath, *sim_, *params_);
+
+    CheckpointData loaded = manager.load_checkpoint(filepath);
+    EXPECT_DOUBLE_EQ(loaded.time, 0.25);
+    EXPECT_DOUBLE_EQ(loaded.dt, 0.002);
+    EXPECT_EQ(loaded.sph_type, "SSPH");
+    ASSERT_EQ(loaded.particles.size(), static_cast<size_t>(kNumParticles));
+
+    const auto& particles = sim_->get_particles();
+    for (int i = 0; i < kNumParticles; i += 29) {
+        for (int d = 0; d < DIM; ++d) {
+            EXPECT_DOUBLE_EQ(loaded.particles[i].pos[d], particles[i].pos[d]);
+            EXPECT_DOUBLE_EQ(loaded.particles[i].vel[d], particles[i].vel[d]);
+        }
+        EXPECT_DOUBLE_EQ(loaded.particles[i].dens, particles[i].dens);
+        EXPECT_DOUBLE_EQ(loaded.particles[i].ene, particles[i].ene);
+        EXPECT_EQ(loaded.particles[i].id, particles[i].id);
+    }
+}
+
+TEST_F(CheckpointFastFlushTest, MatchesTheRegularSaveStateForState) {
+    CheckpointManager manager;
+    manager.save_checkpoint(test_dir_ + "/full.chk", *sim_, *params_);
+    manager.save_checkpoint_fast(test_dir_ + "/fast.chk", *sim_, *params_);
+
+    CheckpointData full = manager.load_checkpoint(test_dir_ + "/full.chk");
+    CheckpointData fast = manager.load_checkpoint(test_dir_ + "/fast.chk");
+    ASSERT_EQ(full.particles.size(), fast.particles.size());
+    for (size_t i = 0; i < full.particles.size(); ++i) {
+        for (int d = 0; d < DIM; ++d) {
+            EXPECT_DOUBLE_EQ(full.particles[i].pos[d], fast.particles[i].pos[d]);
+            EXPECT_DOUBLE_EQ(full.particles[i].vel[d], fast.particles[i].vel[d]);
+        }
+        EXPECT_DOUBLE_EQ(full.particles[i].mass, fast.particles[i].mass);
+        EXPECT_DOUBLE_EQ(full.particles[i].ene, fast.particles[i].ene);
+    }
+
+    // The minimal flush has no warm-restart section; the restore recomputes
+    EXPECT_TRUE(full.derived.present);
+    EXPECT_FALSE(fast.derived.present);
+}
+
+TEST_F(CheckpointFastFlushTest, BypassesTheDeltaChain) {
+    // Delta mode would write a keyframe-dependent file; the preemption path
+    // must always produce a self-contained one
+    CheckpointManager::AutoCheckpointConfig config(0.1, 5);
+    config.delta_enabled = true;
+    config.keyframe_interval = 10;
+    CheckpointManager manager(config);
+
+    // First regular save captures the keyframe, so a second regular save
+    // would be a delta — the fast flush must not be
+    manager.save_checkpoint(test_dir_ + "/keyframe.chk", *sim_, *params_);
+    manager.save_checkpoint_fast(test_dir_ + "/fast.chk", *sim_, *params_);
+
+    fs::remove(test_dir_ + "/keyframe.chk");
+    CheckpointData loaded = manager.load_checkpoint(test_dir_ + "/fast.chk");
+    ASSERT_EQ(loaded.particles.size(), static_cast<size_t>(kNumParticles));
+    EXPECT_DOUBLE_EQ(loaded.particles[150].dens, sim_->get_particles()[150].dens);
+}
+
+TEST_F(CheckpointFastFlushTest, PassesValidation) {
+    CheckpointManager manager;
+    const std::string filepath = test_dir_ + "/fast.chk";
+    manager.save_checkpoint_fast(filepath, *sim_, *params_);
+
+    CheckpointValidation validation = manager.validate_checkpoint(filepath);
+    EXPECT_TRUE(validation.is_valid) << validation.error_message;
+    EXPECT_TRUE(validation.checksum_ok);
+}
+
+} // namespace sph
@@ -180,11 +180,15 @@ protected:
         file.write(reinterpret_cast<const char*>(&json_size), sizeof(json_size));
         file.seekp(0, std::ios::end);
         
-        // Write particles
+        // Write particles (compact v5 records)
         if (!data.particles.empty()) {
+            std::vector<CompactCheckpointParticle> records(data.particles.size());
+            for (size_t i = 0; i < data.particles.size(); ++i) {
+                records[i].pack(data.particles[i]);
+            }
             file.write(
-                reinterpret_cast<const char*>(data.particles.data()),
-                data.particles.size() * sizeof(SPHParticle)
+                reinterpret_cast<const char*>(records.data()),
+                records.size() * sizeof(CompactCheckpointParticle)
             );
         }
         
@@ -282,8 +286,8 @@ TEST_F(CheckpointIntegrationTest, DataStructureSize) {
     EXPECT_LT(estimated_size, 10000000);
     
     // Should include all components
-    size_t min_size = CheckpointData::HEADER_SIZE + 
-                      1000 * sizeof(SPHParticle) + 
+    size_t min_size = CheckpointData::HEADER_SIZE +
+                      1000 * sizeof(CompactCheckpointParticle) +
                       CheckpointData::CHECKSUM_SIZE;
     EXPECT_GE(estimated_size, min_size);
 }
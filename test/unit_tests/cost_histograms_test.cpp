@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "utilities/cost_histograms.hpp"
+#include "core/simulation.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sph {
+
+/**
+ * @brief Tests for the per-particle cost instrumentation
+ *
+ * CostHistograms (see utilities/cost_histograms.hpp) is a process-wide
+ * singleton, so these tests share one enabled instance and check the JSONL
+ * rows it appends: recorded Newton-Raphson iterations and tree visits land
+ * in the right bins, and the neighbor histogram is rebuilt from the
+ * particle array at end_step.
+ */
+class CostHistogramsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        params_ = std::make_shared<SPHParameters>();
+        params_->type = SPHType::SSPH;
+        params_->physics.gamma = 5.0/3.0;
+        params_->physics.neighbor_number = 32;
+        params_->cfl.sound = 0.25;
+        params_->cfl.force = 0.25;
+        params_->kernel = KernelType::CUBIC_SPLINE;
+        params_->tree.max_level = 20;
+        params_->tree.leaf_particle_num = 1;
+
+        sim_ = std::make_shared<Simulation>(params_);
+        std::vector<SPHParticle> particles(kNum);
+        for (int i = 0; i < kNum; ++i) {
+            particles[i].id = i;
+            particles[i].mass = 1.0;
+            particles[i].neighbor = 8 * i; // one particle per width-8 bin
+        }
+        sim_->set_particle_num(kNum);
+        sim_->set_particles(std::move(particles));
+
+        if (!CostHistograms::enabled()) {
+            CostHistograms::enable(path());
+        }
+    }
+
+    static std::string path() {
+        return ::testing::TempDir() + "cost_histograms_test.jsonl";
+    }
+
+    /// Last line of the output file (one JSON object per step).
+    static std::string last_row() {
+        std::ifstream in(path());
+        std::string line, last;
+        while (std::getline(in, line)) {
+            if (!line.empty()) {
+                last = line;
+            }
+        }
+        return last;
+    }
+
+    static constexpr int kNum = 8;
+
+    std::shared_ptr<SPHParameters> params_;
+    std::shared_ptr<Simulation> sim_;
+};
+
+constexpr int CostHistogramsTest::kNum;
+
+TEST_F(CostHistogramsTest, RowHasEverySection) {
+    CostHistograms::begin_step(0.25);
+    CostHistograms::record_nr(3);
+    CostHistograms::record_tree_visits(100);
+    CostHistograms::touch_window(CostHistograms::PRE_INTERACTION);
+    CostHistograms::touch_window(CostHistograms::FLUID_FORCE);
+    CostHistograms::end_step(sim_.get());
+
+    const std::string row = last_row();
+    EXPECT_NE(row.find("\"time\": 0.25"), std::string::npos);
+    EXPECT_NE(row.find("\"neighbor_bin8\""), std::string::npos);
+    EXPECT_NE(row.find("\"nr_iterations\""), std::string::npos);
+    EXPECT_NE(row.find("\"tree_visits_log2\""), std::string::npos);
+    EXPECT_NE(row.find("\"pre_interaction\""), std::string::npos);
+    EXPECT_NE(row.find("\"fluid_force\""), std::string::npos);
+}
+
+TEST_F(CostHistogramsTest, NeighborHistogramCountsEveryParticle) {
+    CostHistograms::begin_step(0.0);
+    CostHistograms::end_step(sim_.get());
+
+    // neighbor counts 0,8,...,56 in width-8 bins: one particle per bin 0..7
+    const std::string row = last_row();
+    const auto start = row.find("\"neighbor_bin8\": [");
+    ASSERT_NE(start, std::string::npos);
+    const auto end = row.find(']', start);
+    const std::string bins = row.substr(start, end - start);
+    EXPECT_NE(bins.find("[1,1,1,1,1,1,1,1,0"), std::string::npos) << bins;
+}
+
+TEST_F(CostHistogramsTest, StepResetsBetweenRows) {
+    CostHistograms::begin_step(1.0);
+    CostHistograms::record_nr(2);
+    CostHistograms::end_step(sim_.get());
+    CostHistograms::begin_step(2.0);
+    CostHistograms::end_step(sim_.get());
+
+    // second row must not inherit the first row's NR count
+    const std::string row = last_row();
+    const auto start = row.find("\"nr_iterations\": [");
+    ASSERT_NE(start, std::string::npos);
+    const auto end = row.find(']', start);
+    const std::string bins = row.substr(start, end - start + 1);
+    EXPECT_EQ(bins.find('1'), std::string::npos) << bins;
+}
+
+}
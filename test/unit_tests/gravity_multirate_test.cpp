@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include "core/simulation.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include "modules/gravity_force.hpp"
+#include "tree/neighbor_searcher.hpp"
+#include "utilities/ic_toolkit.hpp"
+#include <cmath>
+#include <vector>
+
+namespace sph {
+
+/**
+ * @brief Multi-rate gravity (gravityInterval config key)
+ *
+ * With a solve interval k the full Barnes-Hut walk runs every k-th step
+ * and the steps in between reuse the saved field — held, or linearly
+ * extrapolated from the last two solves. These tests pin that the held
+ * steps really skip the walk (the field stays the saved one even after
+ * the particles move), that the extrapolated field follows the per-step
+ * slope between the solves, and that a particle-count change forces a
+ * full solve.
+ */
+class GravityMultirateTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        params_ = std::make_shared<SPHParameters>();
+        params_->type = SPHType::SSPH;
+        params_->physics.gamma = 5.0/3.0;
+        params_->physics.neighbor_number = 32;
+        params_->kernel = KernelType::CUBIC_SPLINE;
+        params_->tree.max_level = 20;
+        params_->tree.leaf_particle_num = 4;
+        params_->gravity.is_valid = true;
+        params_->gravity.constant = 1.0;
+        params_->gravity.theta = 0.5;
+    }
+
+    /// Jittered kSide^DIM lattice on [0,1]^DIM.
+    void make_cloud() {
+        sim_ = std::make_shared<Simulation>(params_);
+        vec_t box_min, box_max;
+        for (int d = 0; d < DIM; ++d) {
+            box_min[d] = 0.0;
+            box_max[d] = 1.0;
+        }
+        const real dx = 1.0 / kSide;
+        ic::lattice(sim_, box_min, box_max, kSide, [dx](SPHParticle &p_i) {
+            p_i.mass = 1.0;
+            p_i.dens = 1.0;
+            p_i.sml = 3.0 * dx;
+        });
+        ic::jitter(sim_, 0.3 * dx, 3);
+        sim_->get_tree()->resize(sim_->get_particle_num());
+        sim_->make_tree();
+    }
+
+    /// Displace every particle by a smooth non-uniform shift and rebuild.
+    void move_cloud(const real amplitude) {
+        auto &particles = sim_->get_particles();
+        const int num = sim_->get_particle_num();
+        for (int i = 0; i < num; ++i) {
+            for (int d = 0; d < DIM; ++d) {
+                particles[i].pos[d] += amplitude * std::sin(1.0 + i * 0.7 + d);
+            }
+        }
+        sim_->make_tree();
+    }
+
+    std::vector<vec_t> accelerations() const {
+        const auto &particles = sim_->get_particles();
+        std::vector<vec_t> acc(sim_->get_particle_num());
+        for (int i = 0; i < sim_->get_particle_num(); ++i) {
+            acc[i] = particles[i].acc;
+        }
+        return acc;
+    }
+
+    /// Reference field at the current positions: a single-rate solve.
+    std::vector<vec_t> reference_solve() {
+        GravityForce reference;
+        auto single_rate = std::make_shared<SPHParameters>(*params_);
+        single_rate->gravity.interval = 1;
+        reference.initialize(single_rate);
+        reference.calculation(sim_);
+        return accelerations();
+    }
+
+    static constexpr int kSide = 8;
+
+    std::shared_ptr<SPHParameters> params_;
+    std::shared_ptr<Simulation> sim_;
+};
+
+constexpr int GravityMultirateTest::kSide;
+
+TEST_F(GravityMultirateTest, HoldsTheFieldBetweenFullSolves) {
+    params_->gravity.interval = 4;
+    params_->gravity.extrapolate = false;
+    make_cloud();
+
+    GravityForce gforce;
+    gforce.initialize(params_);
+    gforce.calculation(sim_);
+    const auto full = accelerations();
+
+    // The particles move, but the next two steps are inside the interval:
+    // the field must stay the saved one, bit for bit.
+    move_cloud(0.05);
+    gforce.calculation(sim_);
+    const auto held = accelerations();
+    ASSERT_EQ(held.size(), full.size());
+    for (size_t i = 0; i < full.size(); ++i) {
+        for (int d = 0; d < DIM; ++d) {
+            EXPECT_EQ(held[i][d], full[i][d]) << "particle " << i;
+        }
+    }
+
+    // Sanity: a real solve at the moved positions gives a different field.
+    const auto moved = reference_solve();
+    real max_diff = 0.0;
+    for (size_t i = 0; i < full.size(); ++i) {
+        for (int d = 0; d < DIM; ++d) {
+            max_diff = std::max(max_diff, std::abs(moved[i][d] - full[i][d]));
+        }
+    }
+    EXPECT_GT(max_diff, 0.0);
+}
+
+TEST_F(GravityMultirateTest, ExtrapolatesAlongTheSolveSlope) {
+    params_->gravity.interval = 2;
+    params_->gravity.extrapolate = true;
+    make_cloud();
+
+    GravityForce gforce;
+    gforce.initialize(params_);
+
+    gforce.calculation(sim_); // full solve: field A
+    const auto field_a = accelerations();
+
+    move_cloud(0.02);
+    gforce.calculation(sim_); // held (no previous solve to take a slope from)
+
+    move_cloud(0.02);
+    gforce.calculation(sim_); // full solve: field B, slope spans 2 steps
+    const auto field_b = accelerations();
+
+    gforce.calculation(sim_); // extrapolated: B + (B - A) / 2
+    const auto extrapolated = accelerations();
+    for (size_t i = 0; i < field_b.size(); ++i) {
+        for (int d = 0; d < DIM; ++d) {
+            const real expected = field_b[i][d] + (field_b[i][d] - field_a[i][d]) * 0.5;
+            EXPECT_NEAR(extrapolated[i][d], expected, 1e-12) << "particle " << i;
+        }
+    }
+}
+
+TEST_F(GravityMultirateTest, ParticleCountChangeForcesAFullSolve) {
+    params_->gravity.interval = 4;
+    make_cloud();
+
+    GravityForce gforce;
+    gforce.initialize(params_);
+    EXPECT_TRUE(gforce.full_solve_due(sim_->get_particle_num()));
+    gforce.calculation(sim_);
+    EXPECT_FALSE(gforce.full_solve_due(sim_->get_particle_num()));
+    EXPECT_TRUE(gforce.full_solve_due(sim_->get_particle_num() + 1));
+}
+
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "utilities/memory_footprint.hpp"
+
+namespace sph {
+
+/**
+ * @brief Tests for the per-subsystem memory accounting registry
+ *
+ * Subsystems report their current allocation with set()/add() and the
+ * registry tracks the high-water mark alongside (see
+ * utilities/memory_footprint.hpp). Tests reset the registry because other
+ * tests in this binary allocate through instrumented code paths.
+ */
+class MemoryFootprintTest : public ::testing::Test {
+protected:
+    void SetUp() override { MemoryFootprint::reset(); }
+    void TearDown() override { MemoryFootprint::reset(); }
+};
+
+TEST_F(MemoryFootprintTest, SetTracksCurrentAndPeak) {
+    MemoryFootprint::set("pool", 1024);
+    MemoryFootprint::set("pool", 4096);
+    MemoryFootprint::set("pool", 512);
+    EXPECT_EQ(MemoryFootprint::current("pool"), 512u);
+    EXPECT_EQ(MemoryFootprint::peak("pool"), 4096u);
+}
+
+TEST_F(MemoryFootprintTest, AddAdjustsIncrementally) {
+    MemoryFootprint::add("scratch", 100);
+    MemoryFootprint::add("scratch", 200);
+    EXPECT_EQ(MemoryFootprint::current("scratch"), 300u);
+    MemoryFootprint::add("scratch", -250);
+    EXPECT_EQ(MemoryFootprint::current("scratch"), 50u);
+    EXPECT_EQ(MemoryFootprint::peak("scratch"), 300u);
+}
+
+TEST_F(MemoryFootprintTest, EntriesKeepFirstReportOrder) {
+    MemoryFootprint::set("b", 1);
+    MemoryFootprint::set("a", 2);
+    MemoryFootprint::set("b", 3);
+    const auto entries = MemoryFootprint::entries();
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].name, "b");
+    EXPECT_EQ(entries[1].name, "a");
+}
+
+TEST_F(MemoryFootprintTest, JsonListsEverySubsystem) {
+    MemoryFootprint::set("particles", 128);
+    MemoryFootprint::set("tree_pool", 320);
+    MemoryFootprint::set("tree_pool", 64);
+    const std::string json = MemoryFootprint::to_json(0);
+    EXPECT_NE(json.find("\"particles\": {\"current_bytes\": 128, \"peak_bytes\": 128}"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"tree_pool\": {\"current_bytes\": 64, \"peak_bytes\": 320}"),
+              std::string::npos);
+}
+
+}
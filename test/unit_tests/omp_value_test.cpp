@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "utilities/openmp.hpp"
+#include <cstdint>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @brief Tests for the hierarchical per-thread reduction helper
+ *
+ * omp_value keeps one cache-line-padded slot per thread and merges them in
+ * two levels (see utilities/openmp.hpp); the reductions must match their
+ * serial equivalents and the slots must actually land on distinct,
+ * 64-byte-aligned cache lines.
+ */
+
+TEST(OmpValueTest, SumMatchesSerial) {
+    const int n = 100000;
+    omp_value<double> total(0.0);
+#pragma omp parallel for
+    for (int i = 0; i < n; ++i) {
+        total.get() += static_cast<double>(i);
+    }
+    EXPECT_DOUBLE_EQ(total.sum(), 0.5 * n * (n - 1));
+}
+
+TEST(OmpValueTest, MinAndMaxMatchSerial) {
+    const int n = 10000;
+    omp_value<double> low(1e30);
+    omp_value<double> high(-1e30);
+#pragma omp parallel for
+    for (int i = 0; i < n; ++i) {
+        const double v = (i * 7919) % n - 0.5 * n; // scrambled, mixed-sign
+        if (v < low.get()) low.get() = v;
+        if (v > high.get()) high.get() = v;
+    }
+    double expect_low = 1e30, expect_high = -1e30;
+    for (int i = 0; i < n; ++i) {
+        const double v = (i * 7919) % n - 0.5 * n;
+        if (v < expect_low) expect_low = v;
+        if (v > expect_high) expect_high = v;
+    }
+    EXPECT_DOUBLE_EQ(low.min(), expect_low);
+    EXPECT_DOUBLE_EQ(high.max(), expect_high);
+}
+
+TEST(OmpValueTest, SlotsAreCacheLineAlignedAndDistinct) {
+#ifdef _OPENMP
+    const int threads = omp_get_max_threads();
+#else
+    const int threads = 1;
+#endif
+    omp_value<double> value(0.0);
+    std::vector<std::uintptr_t> addresses(threads, 0);
+#pragma omp parallel
+    {
+#ifdef _OPENMP
+        const int tid = omp_get_thread_num();
+#else
+        const int tid = 0;
+#endif
+        addresses[tid] = reinterpret_cast<std::uintptr_t>(&value.get());
+    }
+    for (int i = 0; i < threads; ++i) {
+        if (addresses[i] == 0) {
+            continue; // thread not scheduled
+        }
+        EXPECT_EQ(addresses[i] % 64, 0u) << "slot " << i;
+        for (int j = i + 1; j < threads; ++j) {
+            if (addresses[j] != 0) {
+                EXPECT_GE(addresses[i] > addresses[j] ? addresses[i] - addresses[j]
+                                                      : addresses[j] - addresses[i],
+                          64u)
+                    << "slots " << i << " and " << j << " share a cache line";
+            }
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "utilities/particle_culling.hpp"
+#include "core/simulation.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include "tree/neighbor_searcher.hpp"
+#include <cmath>
+#include <vector>
+
+namespace sph {
+
+/**
+ * @brief Tests for escaped-material culling
+ *
+ * The culling pass (see utilities/particle_culling.hpp) removes fluid
+ * particles beyond the configured radius, compacts the array and restores
+ * the id == index convention; walls and point masses are exempt.
+ */
+class ParticleCullingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        params_ = std::make_shared<SPHParameters>();
+        params_->type = SPHType::SSPH;
+        params_->physics.gamma = 5.0/3.0;
+        params_->physics.neighbor_number = 32;
+        params_->time.start = 0.0;
+        params_->time.end = 1.0;
+        params_->cfl.sound = 0.25;
+        params_->cfl.force = 0.25;
+        params_->kernel = KernelType::CUBIC_SPLINE;
+        params_->tree.max_level = 20;
+        params_->tree.leaf_particle_num = 1;
+        params_->periodic.is_valid = false;
+        params_->gravity.is_valid = false;
+        params_->culling.is_valid = true;
+        params_->culling.radius = 1.0;
+        params_->culling.interval = 1;
+    }
+
+    /// Ring of particles: kInside inside the unit radius, kOutside beyond
+    /// it, plus one wall and one point mass outside (which must survive).
+    void make_ring() {
+        sim_ = std::make_shared<Simulation>(params_);
+        std::vector<SPHParticle> particles;
+        for (int i = 0; i < kInside; ++i) {
+            particles.push_back(make_particle(0.5, i, kInside));
+        }
+        for (int i = 0; i < kOutside; ++i) {
+            particles.push_back(make_particle(2.0, i, kOutside));
+        }
+        SPHParticle wall = make_particle(3.0, 0, 1);
+        wall.is_wall = true;
+        particles.push_back(wall);
+        SPHParticle point_mass = make_particle(4.0, 0, 1);
+        point_mass.is_point_mass = true;
+        particles.push_back(point_mass);
+        for (size_t i = 0; i < particles.size(); ++i) {
+            particles[i].id = static_cast<int>(i);
+        }
+        sim_->set_particle_num(static_cast<int>(particles.size()));
+        sim_->set_particles(std::move(particles));
+        sim_->get_tree()->resize(sim_->get_particle_num());
+        sim_->make_tree();
+    }
+
+    static SPHParticle make_particle(real radius, int i, int n) {
+        SPHParticle p;
+        const real angle = 2.0 * M_PI * i / n;
+        p.pos[0] = radius * std::cos(angle);
+        p.pos[1] = radius * std::sin(angle);
+        p.mass = 1.0;
+        p.dens = 1.0;
+        p.ene = 1.0;
+        p.sml = 0.3;
+        return p;
+    }
+
+    static constexpr int kInside = 50;
+    static constexpr int kOutside = 20;
+
+    std::shared_ptr<SPHParameters> params_;
+    std::shared_ptr<Simulation> sim_;
+};
+
+constexpr int ParticleCullingTest::kInside;
+constexpr int ParticleCullingTest::kOutside;
+
+TEST_F(ParticleCullingTest, RemovesEscapedFluidOnly) {
+    make_ring();
+    ParticleCulling culling;
+    culling.initialize(params_);
+    EXPECT_TRUE(culling.apply(sim_));
+
+    // inside fluid + the exempt wall and point mass remain
+    EXPECT_EQ(sim_->get_particle_num(), kInside + 2);
+    int walls = 0, point_masses = 0;
+    for (int i = 0; i < sim_->get_particle_num(); ++i) {
+        const auto& p = sim_->get_particles()[i];
+        EXPECT_EQ(p.id, i);
+        if (p.is_wall) ++walls;
+        else if (p.is_point_mass) ++point_masses;
+        else EXPECT_LT(abs2(p.pos), 1.0);
+    }
+    EXPECT_EQ(walls, 1);
+    EXPECT_EQ(point_masses, 1);
+}
+
+TEST_F(ParticleCullingTest, NoopWhenEverythingIsInside) {
+    params_->culling.radius = 10.0;
+    make_ring();
+    ParticleCulling culling;
+    culling.initialize(params_);
+    EXPECT_FALSE(culling.apply(sim_));
+    EXPECT_EQ(sim_->get_particle_num(), kInside + kOutside + 2);
+}
+
+TEST_F(ParticleCullingTest, RegisteredArraysAreCompactedAlongside) {
+    make_ring();
+    sim_->add_scalar_array({"tag"});
+    sim_->add_vector_array({"vtag"});
+    {
+        auto& tag = sim_->get_scalar_array("tag");
+        auto& vtag = sim_->get_vector_array("vtag");
+        const auto& particles = sim_->get_particles();
+        for (int i = 0; i < sim_->get_particle_num(); ++i) {
+            tag[i] = particles[i].pos[0];
+            vtag[i] = particles[i].pos;
+        }
+    }
+
+    ParticleCulling culling;
+    culling.initialize(params_);
+    EXPECT_TRUE(culling.apply(sim_));
+
+    // Positions are untouched by the pass, so each survivor's array slot
+    // must still mirror its own coordinates.
+    const auto& tag = sim_->get_scalar_array("tag");
+    const auto& vtag = sim_->get_vector_array("vtag");
+    const auto& particles = sim_->get_particles();
+    ASSERT_EQ(static_cast<int>(tag.size()), sim_->get_particle_num());
+    ASSERT_EQ(static_cast<int>(vtag.size()), sim_->get_particle_num());
+    for (int i = 0; i < sim_->get_particle_num(); ++i) {
+        EXPECT_DOUBLE_EQ(tag[i], particles[i].pos[0]);
+        for (int d = 0; d < DIM; ++d) {
+            EXPECT_DOUBLE_EQ(vtag[i][d], particles[i].pos[d]);
+        }
+    }
+}
+
+TEST_F(ParticleCullingTest, IntervalGatesThePass) {
+    params_->culling.interval = 2;
+    make_ring();
+    ParticleCulling culling;
+    culling.initialize(params_);
+    EXPECT_FALSE(culling.apply(sim_));
+    EXPECT_TRUE(culling.apply(sim_)); // second call is due
+}
+
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "utilities/particle_refinement.hpp"
+#include "core/simulation.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include "tree/neighbor_searcher.hpp"
+#include <cmath>
+#include <vector>
+
+namespace sph {
+
+/**
+ * @brief Tests for adaptive particle splitting and merging
+ *
+ * The refinement pass (see utilities/particle_refinement.hpp) replaces
+ * shock-flagged particles with 2*DIM mass-conserving children and merges
+ * quiescent neighbor pairs. These tests check the conservation properties
+ * the scheme promises — mass and momentum under splits, mass, momentum and
+ * total energy under merges — plus the interval gating and the mass bounds
+ * that stop the split/merge cascade.
+ */
+class ParticleRefinementTest : public ::testing::Test {
+protected:
+    static constexpr int kSide = 20;
+    static constexpr int kNum = kSide * kSide;
+
+    void SetUp() override {
+        params_ = std::make_shared<SPHParameters>();
+        params_->type = SPHType::SSPH;
+        params_->physics.gamma = 5.0/3.0;
+        params_->physics.neighbor_number = 32;
+        params_->time.start = 0.0;
+        params_->time.end = 1.0;
+        params_->cfl.sound = 0.25;
+        params_->cfl.force = 0.25;
+        params_->kernel = KernelType::CUBIC_SPLINE;
+        params_->tree.max_level = 20;
+        params_->tree.leaf_particle_num = 1;
+        params_->periodic.is_valid = false;
+        params_->gravity.is_valid = false;
+        params_->refinement.is_valid = true;
+        params_->refinement.interval = 1;
+    }
+
+    /// Uniform lattice with a smooth velocity field; every particle starts
+    /// below any reasonable split threshold (shockSensor = 0).
+    void make_lattice() {
+        sim_ = std::make_shared<Simulation>(params_);
+        std::vector<SPHParticle> particles(kNum);
+        const real spacing = 1.0 / kSide;
+        for (int i = 0; i < kNum; ++i) {
+            SPHParticle& p = particles[i];
+            p.pos[0] = (i % kSide + 0.5) * spacing;
+            p.pos[1] = (i / kSide + 0.5) * spacing;
+            p.vel[0] = 0.1 * p.pos[1];
+            p.vel[1] = -0.05 * p.pos[0];
+            p.mass = 1.0 / kNum;
+            p.dens = 1.0;
+            p.ene = 1.5;
+            p.sml = 3.0 * spacing;
+            p.shockSensor = 0.0;
+            p.id = i;
+        }
+        sim_->set_particle_num(kNum);
+        sim_->set_particles(std::move(particles));
+        sim_->get_tree()->resize(kNum);
+        sim_->make_tree();
+    }
+
+    real total_mass() const {
+        real m = 0.0;
+        for (const auto& p : sim_->get_particles()) m += p.mass;
+        return m;
+    }
+
+    vec_t total_momentum() const {
+        vec_t mom(0.0);
+        for (const auto& p : sim_->get_particles()) mom += p.vel * p.mass;
+        return mom;
+    }
+
+    real total_energy() const {
+        real e = 0.0;
+        for (const auto& p : sim_->get_particles()) {
+            e += p.mass * (p.ene + 0.5 * abs2(p.vel));
+        }
+        return e;
+    }
+
+    std::shared_ptr<SPHParameters> params_;
+    std::shared_ptr<Simulation> sim_;
+};
+
+constexpr int ParticleRefinementTest::kSide;
+constexpr int ParticleRefinementTest::kNum;
+
+TEST_F(ParticleRefinementTest, SplitConservesMassAndMomentum) {
+    params_->refinement.merge_threshold = 0.0; // shockSensor >= 0 never merges
+    make_lattice();
+    auto& particles = sim_->get_particles();
+    particles[kNum / 2].shockSensor = 2.0;
+    const real mass_before = total_mass();
+    const vec_t mom_before = total_momentum();
+
+    ParticleRefinement refinement;
+    refinement.initialize(params_);
+    EXPECT_TRUE(refinement.apply(sim_));
+
+    EXPECT_EQ(sim_->get_particle_num(), kNum + 2 * DIM - 1);
+    EXPECT_NEAR(total_mass(), mass_before, 1e-12);
+    for (int d = 0; d < DIM; ++d) {
+        EXPECT_NEAR(total_momentum()[d], mom_before[d], 1e-12);
+    }
+    // id == index convention restored after the compaction
+    for (int i = 0; i < sim_->get_particle_num(); ++i) {
+        EXPECT_EQ(sim_->get_particles()[i].id, i);
+    }
+}
+
+TEST_F(ParticleRefinementTest, RegisteredArraysFollowSplitsAndCompaction) {
+    params_->refinement.merge_threshold = 0.0; // shockSensor >= 0 never merges
+    make_lattice();
+    sim_->add_scalar_array({"tag"});
+    {
+        auto& tag = sim_->get_scalar_array("tag");
+        for (int i = 0; i < kNum; ++i) tag[i] = 10.0 + i;
+    }
+    const int split = kNum / 2;
+    sim_->get_particles()[split].shockSensor = 2.0;
+
+    ParticleRefinement refinement;
+    refinement.initialize(params_);
+    EXPECT_TRUE(refinement.apply(sim_));
+
+    // No merges, so the original indices survive in place; the appended
+    // children inherit the split parent's slot value.
+    const int new_num = sim_->get_particle_num();
+    const auto& tag = sim_->get_scalar_array("tag");
+    ASSERT_EQ(static_cast<int>(tag.size()), new_num);
+    for (int i = 0; i < kNum; ++i) {
+        EXPECT_DOUBLE_EQ(tag[i], 10.0 + i);
+    }
+    for (int i = kNum; i < new_num; ++i) {
+        EXPECT_DOUBLE_EQ(tag[i], 10.0 + split);
+    }
+}
+
+TEST_F(ParticleRefinementTest, MergeConservesMassMomentumAndEnergy) {
+    params_->refinement.merge_threshold = 0.5;
+    params_->refinement.split_threshold = 1e30; // no splits this test
+    make_lattice();
+    const real mass_before = total_mass();
+    const vec_t mom_before = total_momentum();
+    const real energy_before = total_energy();
+
+    ParticleRefinement refinement;
+    refinement.initialize(params_);
+    EXPECT_TRUE(refinement.apply(sim_));
+
+    EXPECT_LT(sim_->get_particle_num(), kNum);
+    EXPECT_NEAR(total_mass(), mass_before, 1e-12);
+    for (int d = 0; d < DIM; ++d) {
+        EXPECT_NEAR(total_momentum()[d], mom_before[d], 1e-12);
+    }
+    EXPECT_NEAR(total_energy(), energy_before, 1e-12);
+
+    // The doubled-mass survivors are at the upper bound and must not merge
+    // again on a second pass.
+    const int num_after_first = sim_->get_particle_num();
+    EXPECT_TRUE(refinement.apply(sim_) || sim_->get_particle_num() == num_after_first);
+    EXPECT_NEAR(total_mass(), mass_before, 1e-12);
+}
+
+TEST_F(ParticleRefinementTest, IntervalGatesThePass) {
+    params_->refinement.interval = 3;
+    params_->refinement.merge_threshold = 0.0;
+    make_lattice();
+    sim_->get_particles()[0].shockSensor = 2.0;
+
+    ParticleRefinement refinement;
+    refinement.initialize(params_);
+    EXPECT_FALSE(refinement.apply(sim_));
+    EXPECT_FALSE(refinement.apply(sim_));
+    EXPECT_TRUE(refinement.apply(sim_)); // third call is due
+}
+
+TEST_F(ParticleRefinementTest, MassFloorStopsSplitCascade) {
+    params_->refinement.merge_threshold = 0.0;
+    params_->refinement.min_mass_factor = 0.5; // floor * 2*DIM > median mass
+    make_lattice();
+    sim_->get_particles()[0].shockSensor = 2.0;
+
+    ParticleRefinement refinement;
+    refinement.initialize(params_);
+    EXPECT_FALSE(refinement.apply(sim_));
+    EXPECT_EQ(sim_->get_particle_num(), kNum);
+}
+
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "utilities/periodic.hpp"
+#include "core/parameters.hpp"
+#include <memory>
+
+namespace sph {
+
+/**
+ * @brief Tests for the branchless periodic boundary math
+ *
+ * wrap() canonicalizes positions into [min, max) via precomputed reciprocal
+ * ranges and floor, calc_r_ij() applies the minimum-image convention via
+ * nearbyint (see utilities/periodic.hpp); both must agree with the obvious
+ * comparison-based formulation.
+ */
+class PeriodicTest : public ::testing::Test {
+protected:
+    std::shared_ptr<SPHParameters> make_params(bool valid) {
+        auto params = std::make_shared<SPHParameters>();
+        params->periodic.is_valid = valid;
+        for (int d = 0; d < DIM; ++d) {
+            params->periodic.range_min[d] = -1.0;
+            params->periodic.range_max[d] = 1.0;
+        }
+        return params;
+    }
+};
+
+TEST_F(PeriodicTest, WrapCanonicalizesIntoRange) {
+    Periodic periodic;
+    periodic.initialize(make_params(true));
+
+    vec_t just_outside;
+    vec_t far_outside;
+    for (int d = 0; d < DIM; ++d) {
+        just_outside[d] = 1.25;
+        far_outside[d] = -7.5; // more than one period out
+    }
+    periodic.apply(just_outside);
+    periodic.apply(far_outside);
+    for (int d = 0; d < DIM; ++d) {
+        EXPECT_NEAR(just_outside[d], -0.75, 1e-12);
+        EXPECT_NEAR(far_outside[d], 0.5, 1e-12);
+        EXPECT_GE(just_outside[d], -1.0);
+        EXPECT_LT(just_outside[d], 1.0);
+    }
+
+    vec_t inside;
+    for (int d = 0; d < DIM; ++d) inside[d] = 0.25;
+    periodic.apply(inside);
+    for (int d = 0; d < DIM; ++d) EXPECT_NEAR(inside[d], 0.25, 1e-12);
+}
+
+TEST_F(PeriodicTest, MinimumImageSeparation) {
+    Periodic periodic;
+    periodic.initialize(make_params(true));
+
+    // Particles near opposite faces: the short way round crosses the seam.
+    vec_t r_i, r_j;
+    for (int d = 0; d < DIM; ++d) {
+        r_i[d] = 0.9;
+        r_j[d] = -0.9;
+    }
+    const vec_t r_ij = periodic.calc_r_ij(r_i, r_j);
+    for (int d = 0; d < DIM; ++d) {
+        EXPECT_NEAR(r_ij[d], -0.2, 1e-12);
+    }
+
+    // Nearby pair: plain difference must come through unchanged.
+    for (int d = 0; d < DIM; ++d) r_j[d] = 0.6;
+    const vec_t near = periodic.calc_r_ij(r_i, r_j);
+    for (int d = 0; d < DIM; ++d) {
+        EXPECT_NEAR(near[d], 0.3, 1e-12);
+    }
+}
+
+TEST_F(PeriodicTest, NonPeriodicIsPassthrough) {
+    Periodic periodic;
+    periodic.initialize(make_params(false));
+    EXPECT_FALSE(periodic.enabled());
+
+    vec_t r;
+    for (int d = 0; d < DIM; ++d) r[d] = 42.0;
+    periodic.apply(r);
+    for (int d = 0; d < DIM; ++d) EXPECT_EQ(r[d], 42.0);
+
+    vec_t r_i, r_j;
+    for (int d = 0; d < DIM; ++d) { r_i[d] = 5.0; r_j[d] = -3.0; }
+    const vec_t r_ij = periodic.calc_r_ij(r_i, r_j);
+    for (int d = 0; d < DIM; ++d) EXPECT_EQ(r_ij[d], 8.0);
+}
+
+}
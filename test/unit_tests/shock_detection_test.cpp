@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "utilities/shock_detection.hpp"
+#include "utilities/periodic.hpp"
+#include "core/simulation.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace sph {
+
+/**
+ * @brief Tests for the shock-sensor Mach estimate
+ *
+ * detect_shocks (see utilities/shock_detection.hpp) forms a unit shock
+ * normal from the pressure gradient and classifies neighbors into the
+ * upstream/downstream half-spaces along it. On a single row of particles
+ * along x with a pressure jump the normal is exactly +x and both weighted
+ * averages are exact — every neighbor on a side shares its pressure — so
+ * the sensor must equal the jump relation
+ *     M = sqrt(1 + (P_down/P_up - 1) (gamma+1) / (2 gamma))
+ * independently of the kernel weights. This pins the normal projection
+ * itself, which no other test covers.
+ */
+class ShockDetectionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        params_ = std::make_shared<SPHParameters>();
+        params_->type = SPHType::SSPH;
+        params_->physics.gamma = kGamma;
+        params_->physics.neighbor_number = 32;
+        params_->kernel = KernelType::CUBIC_SPLINE;
+        params_->periodic.is_valid = false;
+        params_->gravity.is_valid = false;
+    }
+
+    /// Row of kSide particles along x (spacing kSpacing, centered on the
+    /// origin, transverse coordinates zero) with pressure p_low at x <= 0
+    /// and p_high at x > 0. Returns the index of the origin particle: its
+    /// pressure gradient points exactly along +x, so the half-space
+    /// classification of every neighbor is exact.
+    int make_jump_row(real p_low, real p_high) {
+        sim_ = std::make_shared<Simulation>(params_);
+
+        std::vector<SPHParticle> particles(kSide);
+        for (int idx = 0; idx < kSide; ++idx) {
+            auto& p = particles[idx];
+            for (int d = 0; d < DIM; ++d) {
+                p.pos[d] = 0.0;
+                p.vel[d] = 0.0;
+            }
+            p.pos[0] = kSpacing * (idx - kSide / 2);
+            p.mass = 1.0;
+            p.dens = 1.0;
+            p.pres = p.pos[0] > 0.0 ? p_high : p_low;
+            p.ene = 1.0;
+            p.sml = 2.5 * kSpacing;
+            p.id = idx;
+        }
+        sim_->set_particle_num(kSide);
+        sim_->set_particles(std::move(particles));
+        return kSide / 2;
+    }
+
+    static constexpr real kGamma = 5.0 / 3.0;
+    static constexpr real kSpacing = 0.1;
+    static constexpr int kSide = 11;
+    std::shared_ptr<SPHParameters> params_;
+    std::shared_ptr<Simulation> sim_;
+};
+
+constexpr real ShockDetectionTest::kGamma;
+constexpr real ShockDetectionTest::kSpacing;
+constexpr int ShockDetectionTest::kSide;
+
+TEST_F(ShockDetectionTest, PressureJumpGivesTheAnalyticMachEstimate) {
+    const real p_low = 1.0;
+    const real p_high = 4.0;
+    const int origin = make_jump_row(p_low, p_high);
+    ASSERT_GE(origin, 0);
+
+    detect_shocks(sim_, sim_->get_periodic().get(), kGamma);
+
+    // The normal points up the gradient (+x), so the upstream half-space
+    // holds the high-pressure side and the ratio is p_low / p_high.
+    const real ratio = p_low / p_high;
+    const real expected =
+        std::sqrt(1.0 + (ratio - 1.0) * (kGamma + 1.0) / (2.0 * kGamma));
+    EXPECT_NEAR(sim_->get_particles()[origin].shockSensor, expected, 1e-12);
+}
+
+TEST_F(ShockDetectionTest, UniformPressureLeavesTheSensorZero) {
+    const int origin = make_jump_row(2.0, 2.0);
+
+    detect_shocks(sim_, sim_->get_periodic().get(), kGamma);
+
+    EXPECT_DOUBLE_EQ(sim_->get_particles()[origin].shockSensor, 0.0);
+}
+
+}
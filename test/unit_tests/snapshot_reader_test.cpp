@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include "reader/snapshot_reader.hpp"
+#include "core/output_format.hpp"
+#include "utilities/unit_system.hpp"
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace fs = boost::filesystem;
+
+namespace sph {
+
+/**
+ * @brief Round trips through the memory-mapped snapshot reader
+ *
+ * Writes snapshots with the ColumnarOutputWriter / ContainerOutputWriter
+ * and reads them back through SnapshotReader / ContainerReader, so the
+ * reader library is pinned to the writers' byte layout rather than to its
+ * own expectations.
+ */
+class SnapshotReaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir_ = "test_snapshot_reader";
+        fs::remove_all(test_dir_);
+        fs::create_directory(test_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir_);
+    }
+
+    /// Stage with per-column recognizable values: column c, particle i
+    /// holds 100*c + i (ints just i + a per-column offset).
+    SnapshotStage make_stage(const int num, const double time) const {
+        SnapshotStage stage;
+        stage.num = num;
+        stage.time = time;
+        int c = 0;
+        auto fill = [&](std::vector<double> &column) {
+            column.resize(num);
+            for (int i = 0; i < num; ++i) {
+                column[i] = 100.0 * c + i;
+            }
+            ++c;
+        };
+        for (int d = 0; d < DIM; ++d) fill(stage.pos[d]);
+        for (int d = 0; d < DIM; ++d) fill(stage.vel[d]);
+        for (int d = 0; d < DIM; ++d) fill(stage.acc[d]);
+        fill(stage.mass);
+        fill(stage.dens);
+        fill(stage.pres);
+        fill(stage.ene);
+        fill(stage.sml);
+        fill(stage.alpha);
+        fill(stage.gradh);
+        fill(stage.shockSensor);
+        auto fill_int = [&](std::vector<int32_t> &column) {
+            column.resize(num);
+            for (int i = 0; i < num; ++i) {
+                column[i] = 1000 * c + i;
+            }
+            ++c;
+        };
+        fill_int(stage.id);
+        fill_int(stage.neighbor);
+        fill_int(stage.ene_floored);
+        return stage;
+    }
+
+    std::string test_dir_;
+    UnitSystem units_;
+};
+
+TEST_F(SnapshotReaderTest, ColumnarRoundTrip) {
+    const int num = 17;
+    ColumnarOutputWriter writer(test_dir_, 0, units_);
+    writer.write_staged(make_stage(num, 2.5));
+
+    SnapshotReader reader(test_dir_ + "/00000.sphc");
+    const auto &view = reader.view();
+    EXPECT_EQ(view.dimension(), DIM);
+    EXPECT_EQ(view.particle_count(), num);
+    EXPECT_DOUBLE_EQ(view.time(), 2.5);
+    EXPECT_DOUBLE_EQ(view.length_factor(), 1.0);
+    EXPECT_EQ(view.length_unit(), "m");
+    EXPECT_EQ(view.time_unit(), "s");
+    EXPECT_EQ(view.mass_unit(), "kg");
+    EXPECT_EQ(static_cast<int>(view.columns().size()), 3 * DIM + 11);
+
+    // A partial read touches only the requested column
+    const double *dens = view.float64("dens");
+    const int dens_index = 3 * DIM + 1;
+    for (int i = 0; i < num; ++i) {
+        EXPECT_DOUBLE_EQ(dens[i], 100.0 * dens_index + i);
+    }
+    const std::int32_t *id = view.int32("id");
+    const int id_index = 3 * DIM + 8;
+    for (int i = 0; i < num; ++i) {
+        EXPECT_EQ(id[i], 1000 * id_index + i);
+    }
+}
+
+TEST_F(SnapshotReaderTest, TypedAccessorsRejectMismatches) {
+    ColumnarOutputWriter writer(test_dir_, 0, units_);
+    writer.write_staged(make_stage(3, 0.0));
+
+    SnapshotReader reader(test_dir_ + "/00000.sphc");
+    const auto &view = reader.view();
+    EXPECT_TRUE(view.has_column("pres"));
+    EXPECT_FALSE(view.has_column("no_such_column"));
+    EXPECT_THROW(view.float64("no_such_column"), std::runtime_error);
+    EXPECT_THROW(view.float64("id"), std::runtime_error);   // int32 column
+    EXPECT_THROW(view.int32("mass"), std::runtime_error);   // float64 column
+}
+
+TEST_F(SnapshotReaderTest, MetadataMirrorsTheHeader) {
+    ColumnarOutputWriter writer(test_dir_, 0, units_);
+    writer.write_staged(make_stage(5, 1.25));
+
+    SnapshotReader reader(test_dir_ + "/00000.sphc");
+    const auto meta = reader.view().metadata();
+    EXPECT_DOUBLE_EQ(meta.simulation.time, 1.25);
+    EXPECT_EQ(meta.simulation.dimension, DIM);
+    EXPECT_EQ(meta.simulation.particle_count, 5);
+    EXPECT_EQ(meta.units.length, "m");
+    EXPECT_DOUBLE_EQ(meta.conversion_factors.mass_factor, 1.0);
+    ASSERT_EQ(meta.columns.size(), reader.view().columns().size());
+    EXPECT_EQ(meta.columns[0].name, "pos_x");
+    EXPECT_EQ(meta.columns[0].description, "float64");
+    EXPECT_EQ(meta.columns.back().name, "ene_floored");
+    EXPECT_EQ(meta.columns.back().description, "int32");
+}
+
+TEST_F(SnapshotReaderTest, RejectsForeignFiles) {
+    const std::string path = test_dir_ + "/not_a_snapshot.sphc";
+    std::ofstream(path) << "plain text, long enough to read a header from............";
+    EXPECT_THROW(SnapshotReader reader(path), std::runtime_error);
+    EXPECT_THROW(SnapshotReader reader(test_dir_ + "/missing.sphc"), std::runtime_error);
+}
+
+TEST_F(SnapshotReaderTest, ContainerFramesIndexAndRead) {
+    ContainerOutputWriter writer(test_dir_, 0, units_);
+    writer.write_staged(make_stage(4, 0.0));
+    writer.write_staged(make_stage(6, 1.0));
+    writer.write_staged(make_stage(8, 2.0));
+
+    ContainerReader container(test_dir_ + "/snapshots.sphar");
+    ASSERT_EQ(container.frame_count(), 3);
+    EXPECT_DOUBLE_EQ(container.frame_time(1), 1.0);
+    EXPECT_EQ(container.frame_particles(2), 8);
+    EXPECT_EQ(container.frame_at(0.9), 1);
+    EXPECT_EQ(container.frame_at(100.0), 2);
+
+    const auto view = container.frame(1);
+    EXPECT_EQ(view.particle_count(), 6);
+    EXPECT_DOUBLE_EQ(view.time(), 1.0);
+    const double *mass = view.float64("mass");
+    EXPECT_DOUBLE_EQ(mass[5], 100.0 * (3 * DIM) + 5);
+}
+
+TEST_F(SnapshotReaderTest, ViewsOutliveTheirReader) {
+    ColumnarOutputWriter writer(test_dir_, 0, units_);
+    writer.write_staged(make_stage(9, 0.5));
+
+    SnapshotView view = SnapshotReader(test_dir_ + "/00000.sphc").view();
+    const double *sml = view.float64("sml");
+    const int sml_index = 3 * DIM + 4;
+    for (int i = 0; i < 9; ++i) {
+        EXPECT_DOUBLE_EQ(sml[i], 100.0 * sml_index + i);
+    }
+}
+
+}
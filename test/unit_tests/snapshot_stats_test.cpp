@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include "core/output_format.hpp"
+#include "core/simulation.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include "utilities/unit_system.hpp"
+#include <boost/filesystem.hpp>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace sph {
+
+/**
+ * @brief Tests for the streaming per-column snapshot statistics
+ *
+ * SnapshotStage::build() gathers min/max/mean/L2 and NaN/Inf counts per
+ * column right after the unit-conversion pass, and the CSV writer mirrors
+ * them into a per-snapshot metadata sidecar so run triage does not need to
+ * open the snapshot itself.
+ */
+class SnapshotStatsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        params_ = std::make_shared<SPHParameters>();
+        test_dir_ = "test_snapshot_stats";
+        fs::remove_all(test_dir_);
+        fs::create_directory(test_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir_);
+    }
+
+    /// kNum particles with dens = 1..kNum and the other fields constant
+    std::shared_ptr<Simulation> make_sim() {
+        auto sim = std::make_shared<Simulation>(params_);
+        std::vector<SPHParticle> particles(kNum);
+        for (int i = 0; i < kNum; ++i) {
+            auto& p = particles[i];
+            for (int d = 0; d < DIM; ++d) {
+                p.pos[d] = 0.1 * i;
+                p.vel[d] = 0.0;
+                p.acc[d] = 0.0;
+            }
+            p.mass = 2.0;
+            p.dens = static_cast<real>(i + 1);
+            p.pres = 3.0;
+            p.ene = 4.0;
+            p.sml = 0.5;
+            p.alpha = 1.0;
+            p.gradh = 1.0;
+            p.shockSensor = 0.0;
+            p.id = i;
+            p.neighbor = 32;
+            p.ene_floored = false;
+        }
+        sim->set_particle_num(kNum);
+        sim->set_particles(std::move(particles));
+        return sim;
+    }
+
+    static const ColumnStats& find_stats(const SnapshotStage& stage,
+                                         const std::string& name) {
+        for (const auto& entry : stage.stats) {
+            if (entry.first == name) return entry.second;
+        }
+        ADD_FAILURE() << "no stats entry for column " << name;
+        static const ColumnStats empty;
+        return empty;
+    }
+
+    static constexpr int kNum = 8;
+    std::shared_ptr<SPHParameters> params_;
+    std::string test_dir_;
+    UnitSystem units_;
+};
+
+constexpr int SnapshotStatsTest::kNum;
+
+TEST_F(SnapshotStatsTest, BuildGathersPerColumnMoments) {
+    auto sim = make_sim();
+    SnapshotStage stage;
+    stage.build(*sim, units_);
+
+    const auto& dens = find_stats(stage, "dens");
+    EXPECT_DOUBLE_EQ(dens.min, 1.0);
+    EXPECT_DOUBLE_EQ(dens.max, static_cast<double>(kNum));
+    EXPECT_DOUBLE_EQ(dens.mean, (kNum + 1) / 2.0);
+    double sumsq = 0.0;
+    for (int i = 1; i <= kNum; ++i) sumsq += static_cast<double>(i) * i;
+    EXPECT_DOUBLE_EQ(dens.l2, std::sqrt(sumsq));
+    EXPECT_EQ(dens.nan_count, 0);
+    EXPECT_EQ(dens.inf_count, 0);
+
+    const auto& mass = find_stats(stage, "mass");
+    EXPECT_DOUBLE_EQ(mass.min, 2.0);
+    EXPECT_DOUBLE_EQ(mass.max, 2.0);
+    EXPECT_DOUBLE_EQ(mass.mean, 2.0);
+
+    // The int columns are covered too: neighbor min/max is a routine
+    // triage question
+    const auto& neighbor = find_stats(stage, "neighbor");
+    EXPECT_DOUBLE_EQ(neighbor.min, 32.0);
+    EXPECT_DOUBLE_EQ(neighbor.max, 32.0);
+}
+
+TEST_F(SnapshotStatsTest, NonFiniteValuesAreCountedNotAccumulated) {
+    auto sim = make_sim();
+    auto& particles = sim->get_particles();
+    particles[2].dens = std::numeric_limits<real>::quiet_NaN();
+    particles[5].pres = std::numeric_limits<real>::infinity();
+
+    SnapshotStage stage;
+    stage.build(*sim, units_);
+
+    const auto& dens = find_stats(stage, "dens");
+    EXPECT_EQ(dens.nan_count, 1);
+    EXPECT_EQ(dens.inf_count, 0);
+    // moments cover the finite entries only: 1..kNum without 3
+    EXPECT_DOUBLE_EQ(dens.min, 1.0);
+    EXPECT_DOUBLE_EQ(dens.max, static_cast<double>(kNum));
+    const double sum = kNum * (kNum + 1) / 2.0 - 3.0;
+    EXPECT_DOUBLE_EQ(dens.mean, sum / (kNum - 1));
+
+    const auto& pres = find_stats(stage, "pres");
+    EXPECT_EQ(pres.nan_count, 0);
+    EXPECT_EQ(pres.inf_count, 1);
+    EXPECT_DOUBLE_EQ(pres.max, 3.0);
+}
+
+TEST_F(SnapshotStatsTest, MetadataSidecarCarriesColumnStats) {
+    auto sim = make_sim();
+    sim->get_particles()[0].dens = std::numeric_limits<real>::quiet_NaN();
+
+    CSVOutputWriter writer(test_dir_, 0, units_);
+    writer.write_snapshot(sim);
+
+    std::ifstream in(test_dir_ + "/00000.meta.json");
+    ASSERT_TRUE(in.is_open());
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string json = buffer.str();
+
+    EXPECT_NE(json.find("\"column_stats\""), std::string::npos);
+    const size_t dens_at = json.find("\"dens\": {");
+    ASSERT_NE(dens_at, std::string::npos);
+    EXPECT_NE(json.find("\"nan_count\": 1", dens_at), std::string::npos);
+    EXPECT_NE(json.find("\"min\": 2.", dens_at), std::string::npos);
+}
+
+TEST_F(SnapshotStatsTest, StatsFollowTheColumnSelection) {
+    auto sim = make_sim();
+    CSVOutputWriter writer(test_dir_, 0, units_);
+    writer.set_columns({"pos", "dens"});
+    writer.write_snapshot(sim);
+
+    std::ifstream in(test_dir_ + "/00000.meta.json");
+    ASSERT_TRUE(in.is_open());
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string json = buffer.str();
+
+    EXPECT_NE(json.find("\"pos_x\": {"), std::string::npos);
+    EXPECT_NE(json.find("\"dens\": {"), std::string::npos);
+    EXPECT_EQ(json.find("\"pres\": {"), std::string::npos);
+    EXPECT_EQ(json.find("\"alpha\": {"), std::string::npos);
+}
+
+}
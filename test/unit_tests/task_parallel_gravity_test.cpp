@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "core/simulation.hpp"
+#include "core/parameters.hpp"
+#include "core/particle.hpp"
+#include "modules/gravity_force.hpp"
+#include "tree/neighbor_searcher.hpp"
+#include "utilities/ic_toolkit.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace sph {
+
+/**
+ * @brief Staged gravity walk used by the task-parallel force phase
+ *
+ * stage_self_gravity() + commit_staged() must reproduce calculation()
+ * exactly: the staged walk runs against local stand-in particles while
+ * the fluid force owns acc/dene, and the commit overwrites acc/phi the
+ * same way the sequential path does.
+ */
+class TaskParallelGravityTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        params_ = std::make_shared<SPHParameters>();
+        params_->type = SPHType::SSPH;
+        params_->physics.gamma = 5.0/3.0;
+        params_->physics.neighbor_number = 32;
+        params_->cfl.sound = 0.25;
+        params_->cfl.force = 0.25;
+        params_->kernel = KernelType::CUBIC_SPLINE;
+        params_->tree.max_level = 20;
+        params_->tree.leaf_particle_num = 1;
+        params_->gravity.is_valid = true;
+        params_->gravity.constant = 1.0;
+        params_->gravity.theta = 0.5;
+    }
+
+    void make_cloud() {
+        sim_ = std::make_shared<Simulation>(params_);
+        vec_t box_min, box_max;
+        for (int d = 0; d < DIM; ++d) {
+            box_min[d] = 0.0;
+            box_max[d] = 1.0;
+        }
+        const real dx = 1.0 / kSide;
+        ic::lattice(sim_, box_min, box_max, kSide, [dx](SPHParticle &p_i) {
+            p_i.mass = 1.0;
+            p_i.dens = 1.0;
+            p_i.sml = 2.0 * dx;
+            p_i.is_active = true;
+        });
+        ic::jitter(sim_, 0.2 * dx, 11);
+        sim_->get_tree()->resize(sim_->get_particle_num());
+        sim_->make_tree();
+    }
+
+    static constexpr int kSide = 8;
+
+    std::shared_ptr<SPHParameters> params_;
+    std::shared_ptr<Simulation> sim_;
+};
+
+constexpr int TaskParallelGravityTest::kSide;
+
+TEST_F(TaskParallelGravityTest, StagedWalkMatchesTheSequentialPath) {
+    make_cloud();
+
+    GravityForce gravity;
+    gravity.initialize(params_);
+    ASSERT_TRUE(gravity.uses_self_gravity());
+    ASSERT_FALSE(gravity.uses_dual_tree());
+
+    gravity.calculation(sim_);
+    const int num = sim_->get_particle_num();
+    std::vector<vec_t> acc_ref(num);
+    std::vector<real> phi_ref(num);
+    {
+        const auto &particles = sim_->get_particles();
+        for (int i = 0; i < num; ++i) {
+            acc_ref[i] = particles[i].acc;
+            phi_ref[i] = particles[i].phi;
+        }
+    }
+
+    // Scribble over the result so the commit has to restore everything
+    {
+        auto &particles = sim_->get_particles();
+        for (int i = 0; i < num; ++i) {
+            for (int d = 0; d < DIM; ++d) {
+                particles[i].acc[d] = 123.0;
+            }
+            particles[i].phi = -123.0;
+        }
+    }
+
+    gravity.stage_self_gravity(sim_);
+    gravity.commit_staged(sim_);
+
+    const auto &particles = sim_->get_particles();
+    for (int i = 0; i < num; ++i) {
+        for (int d = 0; d < DIM; ++d) {
+            EXPECT_DOUBLE_EQ(particles[i].acc[d], acc_ref[i][d]) << "particle " << i;
+        }
+        EXPECT_DOUBLE_EQ(particles[i].phi, phi_ref[i]) << "particle " << i;
+    }
+}
+
+TEST_F(TaskParallelGravityTest, StagingTouchesNoParticleState) {
+    make_cloud();
+
+    GravityForce gravity;
+    gravity.initialize(params_);
+
+    auto &particles = sim_->get_particles();
+    const int num = sim_->get_particle_num();
+    for (int i = 0; i < num; ++i) {
+        for (int d = 0; d < DIM; ++d) {
+            particles[i].acc[d] = 7.0;
+        }
+        particles[i].phi = 7.0;
+        particles[i].dene = 7.0;
+    }
+
+    gravity.stage_self_gravity(sim_);
+
+    for (int i = 0; i < num; ++i) {
+        for (int d = 0; d < DIM; ++d) {
+            EXPECT_DOUBLE_EQ(particles[i].acc[d], 7.0);
+        }
+        EXPECT_DOUBLE_EQ(particles[i].phi, 7.0);
+        EXPECT_DOUBLE_EQ(particles[i].dene, 7.0);
+    }
+}
+
+TEST_F(TaskParallelGravityTest, FrozenParticlesKeepTheirAcceleration) {
+    make_cloud();
+
+    GravityForce gravity;
+    gravity.initialize(params_);
+
+    auto &particles = sim_->get_particles();
+    particles[3].is_active = false;
+    for (int d = 0; d < DIM; ++d) {
+        particles[3].acc[d] = 42.0;
+    }
+    particles[3].phi = 42.0;
+
+    gravity.stage_self_gravity(sim_);
+    gravity.commit_staged(sim_);
+
+    for (int d = 0; d < DIM; ++d) {
+        EXPECT_DOUBLE_EQ(particles[3].acc[d], 42.0);
+    }
+    EXPECT_DOUBLE_EQ(particles[3].phi, 42.0);
+}
+
+}
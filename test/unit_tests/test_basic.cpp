@@ -7,6 +7,10 @@
 #include "utilities/vector_type.hpp"
 #include "utilities/defines.hpp"
 #include "core/particle.hpp"
+#include "kernel/cubic_spline.hpp"
+#include "kernel/wendland_kernel.hpp"
+#include "kernel/tabulated_kernel.hpp"
+#include "utilities/gravity_softening.hpp"
 
 namespace sph {
 namespace test {
@@ -181,5 +185,108 @@ TEST_F(BasicSPHTest, ParticleInitialization) {
     EXPECT_EQ(p.mass, 2.0);
 }
 
+
+// Tabulated kernel lookups must reproduce the exact polynomials to within
+// the interpolation-table resolution over the whole support, for both
+// kernels and at several smoothing lengths.
+TEST_F(BasicSPHTest, TabulatedKernelMatchesExact) {
+    const std::shared_ptr<KernelFunction> exact_kernels[] = {
+        std::make_shared<Spline::Cubic>(false),
+        std::make_shared<Wendland::C4Kernel>(false),
+    };
+    const real smoothing_lengths[] = {0.1, 1.0, 3.7};
+
+    for (const auto& exact : exact_kernels) {
+        const Tabulated tabulated(exact, false);
+        for (const real h : smoothing_lengths) {
+            const real w0 = exact->w(0.0, h);
+            for (int i = 0; i <= 50; ++i) {
+                const real r = 1.02 * h * i / 50;  // slightly past the support
+                EXPECT_NEAR(tabulated.w(r, h), exact->w(r, h), 1e-4 * w0)
+                    << "w mismatch at r=" << r << " h=" << h;
+                EXPECT_NEAR(tabulated.dhw(r, h), exact->dhw(r, h), 1e-3 * w0 / h)
+                    << "dhw mismatch at r=" << r << " h=" << h;
+                if (r > 0.0) {
+                    vec_t rij(0.0);
+                    rij[0] = r;
+                    EXPECT_NEAR(tabulated.dw(rij, r, h)[0], exact->dw(rij, r, h)[0],
+                                1e-3 * w0 / h)
+                        << "dw mismatch at r=" << r << " h=" << h;
+                }
+            }
+        }
+    }
+}
+
+namespace {
+
+// Literal Hernquist & Katz (1989) piecewise forms, as they stood before the
+// Horner/select refactor in gravity_softening.hpp.
+real reference_f(const real r, const real h) {
+    const real e = h * 0.5;
+    const real u = r / e;
+    if (u < 1.0) {
+        return (-0.5 * u * u * (1.0 / 3.0 - 3.0 / 20 * u * u + u * u * u / 20) + 1.4) / e;
+    } else if (u < 2.0) {
+        return -1.0 / (15 * r) + (-u * u * (4.0 / 3.0 - u + 0.3 * u * u - u * u * u / 30) + 1.6) / e;
+    }
+    return 1 / r;
+}
+
+real reference_g(const real r, const real h) {
+    const real e = h * 0.5;
+    const real u = r / e;
+    if (u < 1.0) {
+        return (4.0 / 3.0 - 1.2 * u * u + 0.5 * u * u * u) / (e * e * e);
+    } else if (u < 2.0) {
+        return (-1.0 / 15 + 8.0 / 3 * u * u * u - 3 * u * u * u * u + 1.2 * u * u * u * u * u - u * u * u * u * u * u / 6.0) / (r * r * r);
+    }
+    return 1 / (r * r * r);
+}
+
+} // namespace
+
+// The branch-reduced softening functions must reproduce the reference
+// piecewise rationals across all three branches, including the branch
+// boundaries, and stay finite at r = 0.
+TEST_F(BasicSPHTest, GravitySofteningMatchesReference) {
+    const real smoothing_lengths[] = {0.1, 1.0, 3.7};
+    for (const real h : smoothing_lengths) {
+        const real e = 0.5 * h;
+        for (int i = 1; i <= 120; ++i) {
+            const real r = 3.0 * e * i / 120;  // u up to 3: covers all branches
+            const real tol_f = 1e-12 * std::abs(reference_f(r, h));
+            const real tol_g = 1e-12 * std::abs(reference_g(r, h));
+            EXPECT_NEAR(grav_f(r, h), reference_f(r, h), tol_f)
+                << "f mismatch at r=" << r << " h=" << h;
+            EXPECT_NEAR(grav_g(r, h), reference_g(r, h), tol_g)
+                << "g mismatch at r=" << r << " h=" << h;
+        }
+        // exact branch boundaries and the softened center
+        for (const real r : {0.0, e, 2.0 * e}) {
+            EXPECT_TRUE(std::isfinite(grav_f(r, h)));
+            EXPECT_TRUE(std::isfinite(grav_g(r, h)));
+        }
+        EXPECT_NEAR(grav_f(0.0, h), 1.4 / e, 1e-12 / e);
+        EXPECT_NEAR(grav_g(0.0, h), 4.0 / (3.0 * e * e * e), 1e-12 / (e * e * e));
+    }
+}
+
+// The symmetrized batch must agree with the scalar calls element by element.
+TEST_F(BasicSPHTest, GravitySofteningBatchMatchesScalar) {
+    const real h_i = 0.8;
+    constexpr int n = 64;
+    real r[n], h_j[n], f_out[n], g_out[n];
+    for (int k = 0; k < n; ++k) {
+        r[k] = 1.5 * (k + 1) / n;
+        h_j[k] = 0.3 + 0.02 * k;
+    }
+    grav_fg_sym_batch(r, h_i, h_j, f_out, g_out, n);
+    for (int k = 0; k < n; ++k) {
+        EXPECT_DOUBLE_EQ(f_out[k], 0.5 * (grav_f(r[k], h_i) + grav_f(r[k], h_j[k])));
+        EXPECT_DOUBLE_EQ(g_out[k], 0.5 * (grav_g(r[k], h_i) + grav_g(r[k], h_j[k])));
+    }
+}
+
 } // namespace test
 } // namespace sph
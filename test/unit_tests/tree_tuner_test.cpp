@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "core/parameters.hpp"
+#include "utilities/tree_tuner.hpp"
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+
+namespace fs = boost::filesystem;
+
+namespace sph {
+
+/**
+ * @brief Sequencing of the leaf-size auto-tuner (treeAutoTune)
+ *
+ * The tuner is driven purely through begin_step()/end_step(), so the
+ * tests step it like the solver would and check the candidate schedule,
+ * the lock-in, and the report — with no live simulation needed.
+ */
+class TreeTunerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        params_ = std::make_shared<SPHParameters>();
+        params_->tree.max_level = 20;
+        params_->tree.leaf_particle_num = 1;
+        params_->tree.auto_tune = true;
+    }
+
+    // Runs one settle step plus the measured steps for the current candidate
+    // and returns whether the last end_step reported a switch.
+    bool run_candidate(TreeTuner &tuner) {
+        bool switched = false;
+        // 1 settle + 3 measured (see TreeTuner::SETTLE_STEPS/MEASURE_STEPS)
+        for (int s = 0; s < 4; ++s) {
+            tuner.begin_step();
+            switched = tuner.end_step(params_);
+        }
+        return switched;
+    }
+
+    std::shared_ptr<SPHParameters> params_;
+};
+
+TEST_F(TreeTunerTest, SweepsEveryCandidateThenLocksIn) {
+    TreeTuner tuner;
+    tuner.initialize(params_);
+    ASSERT_TRUE(tuner.enabled());
+    ASSERT_FALSE(tuner.finished());
+
+    std::set<int> visited;
+    visited.insert(params_->tree.leaf_particle_num);
+    while (!tuner.finished()) {
+        EXPECT_TRUE(run_candidate(tuner));
+        visited.insert(params_->tree.leaf_particle_num);
+    }
+
+    // default start is 1, so the sweep covers {1, 2, 4, 8, 16, 32}
+    EXPECT_EQ(visited.size(), 6u);
+    EXPECT_EQ(params_->tree.leaf_particle_num, tuner.chosen_leaf_size());
+    EXPECT_TRUE(visited.count(tuner.chosen_leaf_size()) > 0);
+
+    // once locked in, further steps are free and change nothing
+    const int locked = params_->tree.leaf_particle_num;
+    tuner.begin_step();
+    EXPECT_FALSE(tuner.end_step(params_));
+    EXPECT_EQ(params_->tree.leaf_particle_num, locked);
+}
+
+TEST_F(TreeTunerTest, ConfiguredLeafSizeIsMeasuredFirst) {
+    params_->tree.leaf_particle_num = 8;
+    TreeTuner tuner;
+    tuner.initialize(params_);
+
+    // The first switch leaves the configured value for the next candidate,
+    // so the baseline got the opening measurement window.
+    EXPECT_EQ(params_->tree.leaf_particle_num, 8);
+    EXPECT_TRUE(run_candidate(tuner));
+    EXPECT_NE(params_->tree.leaf_particle_num, 8);
+}
+
+TEST_F(TreeTunerTest, DisabledUnderTheCellList) {
+    params_->tree.use_cell_list = true;
+    TreeTuner tuner;
+    tuner.initialize(params_);
+    EXPECT_FALSE(tuner.enabled());
+
+    tuner.begin_step();
+    EXPECT_FALSE(tuner.end_step(params_));
+    EXPECT_EQ(params_->tree.leaf_particle_num, 1);
+}
+
+TEST_F(TreeTunerTest, WritesTheTuningReport) {
+    const std::string dir = "test_tree_tuner";
+    fs::create_directories(dir);
+
+    TreeTuner tuner;
+    tuner.initialize(params_);
+    tuner.set_report_path(dir + "/tree_tuning.json");
+    while (!tuner.finished()) {
+        run_candidate(tuner);
+    }
+
+    std::ifstream in(dir + "/tree_tuning.json");
+    ASSERT_TRUE(in.is_open());
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string report = buffer.str();
+    EXPECT_NE(report.find("\"parameter\": \"leafParticleNumber\""), std::string::npos);
+    EXPECT_NE(report.find("\"chosen\": " + std::to_string(tuner.chosen_leaf_size())),
+              std::string::npos);
+    EXPECT_NE(report.find("\"mean_step_seconds\""), std::string::npos);
+
+    in.close();
+    fs::remove_all(dir);
+}
+
+}